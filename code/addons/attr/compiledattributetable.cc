@@ -0,0 +1,445 @@
+//------------------------------------------------------------------------------
+//  compiledattributetable.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "compiledattributetable.h"
+#include "io/ioserver.h"
+#include "io/filestream.h"
+
+namespace Attr
+{
+__ImplementClass(Attr::CompiledAttributeTable, 'CATT', Core::RefCounted);
+
+using namespace Util;
+
+//------------------------------------------------------------------------------
+/**
+*/
+CompiledAttributeTable::CompiledAttributeTable() :
+    data(nullptr),
+    memoryMapped(false),
+    numRows(0),
+    stringOffsets(nullptr),
+    stringData(nullptr),
+    numStrings(0),
+    blobData(nullptr)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+CompiledAttributeTable::~CompiledAttributeTable()
+{
+    if (this->IsOpen())
+    {
+        this->Close();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    File streams are memory mapped, so only the pages which are actually
+    read are loaded. Other streams (e.g. from archives) are read into
+    memory in one go, which is still no parsing.
+*/
+bool
+CompiledAttributeTable::Open(const IO::URI& uri)
+{
+    n_assert(!this->IsOpen());
+    this->stream = IO::IoServer::Instance()->CreateStream(uri);
+    this->stream->SetAccessMode(IO::Stream::ReadAccess);
+    if (!this->stream->Open())
+    {
+        n_warning("CompiledAttributeTable: could not open '%s'\n", uri.AsString().AsCharPtr());
+        this->stream = nullptr;
+        return false;
+    }
+
+    const IO::Stream::Size size = this->stream->GetSize();
+    if (size < (IO::Stream::Size)sizeof(CompiledTableHeader) || !this->stream->CanBeMapped())
+    {
+        n_warning("CompiledAttributeTable: '%s' is not a compiled table\n", uri.AsString().AsCharPtr());
+        this->stream->Close();
+        this->stream = nullptr;
+        return false;
+    }
+
+    this->memoryMapped = this->stream->IsA(IO::FileStream::RTTI);
+    const ubyte* ptr = (const ubyte*)(this->memoryMapped ? this->stream->MemoryMap() : this->stream->Map());
+    if (nullptr == ptr || !this->Setup(uri, ptr, size))
+    {
+        if (nullptr != ptr)
+        {
+            if (this->memoryMapped) this->stream->MemoryUnmap();
+            else                    this->stream->Unmap();
+        }
+        this->stream->Close();
+        this->stream = nullptr;
+        this->columns.Clear();
+        this->indexMap.Clear();
+        return false;
+    }
+    this->data = ptr;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+CompiledAttributeTable::Close()
+{
+    n_assert(this->IsOpen());
+    if (this->memoryMapped)
+    {
+        this->stream->MemoryUnmap();
+    }
+    else
+    {
+        this->stream->Unmap();
+    }
+    this->stream->Close();
+    this->stream = nullptr;
+    this->data = nullptr;
+    this->numRows = 0;
+    this->columns.Clear();
+    this->indexMap.Clear();
+    this->stringOffsets = nullptr;
+    this->stringData = nullptr;
+    this->numStrings = 0;
+    this->blobData = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Checks that everything the header and the column descriptions point
+    to is inside the file, that the string dictionary and the cells used
+    as indices are consistent, and resolves the column names to attribute ids.
+    Columns which aren't known as attributes are registered as dynamic
+    attributes, like the database does for unknown columns.
+*/
+bool
+CompiledAttributeTable::Setup(const IO::URI& uri, const ubyte* ptr, IO::Stream::Size size)
+{
+    const CompiledTableHeader* header = (const CompiledTableHeader*)ptr;
+    if (header->magic != CompiledTableHeader::Magic || header->version != CompiledTableHeader::Version)
+    {
+        n_warning("CompiledAttributeTable: '%s' is not a compiled table or has an old version\n", uri.AsString().AsCharPtr());
+        return false;
+    }
+
+    const uint64_t fileSize = (uint64_t)size;
+    const uint64_t columnsEnd = sizeof(CompiledTableHeader) + (uint64_t)header->numColumns * sizeof(CompiledTableColumn);
+    if (columnsEnd > fileSize
+        || header->stringOffsets + (uint64_t)header->numStrings * sizeof(uint) > fileSize
+        || header->stringData > fileSize
+        || header->blobData > fileSize)
+    {
+        n_warning("CompiledAttributeTable: '%s' is truncated\n", uri.AsString().AsCharPtr());
+        return false;
+    }
+
+    // the string data ends where the blob data starts, its last byte has to
+    // terminate the last string so no string can run past it
+    const uint64_t stringDataSize = header->blobData - header->stringData;
+    if (header->blobData < header->stringData
+        || (header->numStrings > 0 && (0 == stringDataSize || 0 != ptr[header->blobData - 1])))
+    {
+        n_warning("CompiledAttributeTable: string data of '%s' is invalid\n", uri.AsString().AsCharPtr());
+        return false;
+    }
+    const uint* offsets = (const uint*)(ptr + header->stringOffsets);
+    uint stringIndex;
+    for (stringIndex = 0; stringIndex < header->numStrings; stringIndex++)
+    {
+        if (offsets[stringIndex] >= stringDataSize)
+        {
+            n_warning("CompiledAttributeTable: string %d of '%s' is outside of the string data\n", stringIndex, uri.AsString().AsCharPtr());
+            return false;
+        }
+    }
+
+    this->numRows = header->numRows;
+    this->numStrings = header->numStrings;
+    this->stringOffsets = (const uint*)(ptr + header->stringOffsets);
+    this->stringData = (const char*)(ptr + header->stringData);
+    this->blobData = ptr + header->blobData;
+
+    const CompiledTableColumn* descs = (const CompiledTableColumn*)(ptr + sizeof(CompiledTableHeader));
+    this->columns.Reserve(header->numColumns);
+    this->indexMap.BeginBulkAdd();
+    uint i;
+    for (i = 0; i < header->numColumns; i++)
+    {
+        const CompiledTableColumn& desc = descs[i];
+        const ValueType type = (ValueType)desc.valueType;
+        const SizeT valueSize = GetValueTypeSize(type);
+        if (0 == valueSize
+            || desc.name >= header->numStrings
+            || desc.values + (uint64_t)header->numRows * valueSize > fileSize
+            || (0 != desc.buckets && (desc.numBuckets <= header->numRows || 0 != (desc.numBuckets & (desc.numBuckets - 1))))
+            || (0 != desc.buckets && desc.buckets + (uint64_t)desc.numBuckets * sizeof(uint) > fileSize)
+            || !this->ValidateColumnData(desc, ptr, fileSize - header->blobData))
+        {
+            n_warning("CompiledAttributeTable: column %d of '%s' is invalid\n", i, uri.AsString().AsCharPtr());
+            this->indexMap.EndBulkAdd();
+            return false;
+        }
+
+        const String name = this->GetDictionaryString(desc.name);
+        if (!AttrId::IsValidName(name))
+        {
+            AttributeDefinitionBase::RegisterDynamicAttribute(name, Attribute::ValueTypeToString(type), FourCC(), type, ReadOnly);
+        }
+        AttrId attrId(name);
+        if (attrId.GetValueType() != type)
+        {
+            n_warning("CompiledAttributeTable: column '%s' of '%s' has type '%s', but the attribute is '%s'\n",
+                name.AsCharPtr(), uri.AsString().AsCharPtr(),
+                Attribute::ValueTypeToString(type).AsCharPtr(), Attribute::ValueTypeToString(attrId.GetValueType()).AsCharPtr());
+            this->indexMap.EndBulkAdd();
+            return false;
+        }
+
+        ColumnInfo column;
+        column.attrId = attrId;
+        column.values = ptr + desc.values;
+        column.valueSize = valueSize;
+        column.buckets = (0 != desc.buckets) ? (const uint*)(ptr + desc.buckets) : nullptr;
+        column.bucketMask = desc.numBuckets - 1;
+        this->columns.Append(column);
+        this->indexMap.Add(attrId, i);
+    }
+    this->indexMap.EndBulkAdd();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Checks the cells which are used as indices, so a corrupt file can't
+    make a lookup read outside of the mapping: buckets have to point to
+    existing rows, string cells to dictionary entries and blob cells into
+    the blob data. Expects numRows, numStrings and the column bounds to be
+    validated already.
+*/
+bool
+CompiledAttributeTable::ValidateColumnData(const CompiledTableColumn& desc, const ubyte* ptr, uint64_t blobDataSize) const
+{
+    IndexT i;
+    if (0 != desc.buckets)
+    {
+        const uint* buckets = (const uint*)(ptr + desc.buckets);
+        for (i = 0; i < (IndexT)desc.numBuckets; i++)
+        {
+            if (buckets[i] > (uint)this->numRows)
+            {
+                return false;
+            }
+        }
+    }
+
+    const ubyte* values = ptr + desc.values;
+    switch ((ValueType)desc.valueType)
+    {
+    case StringType:
+        for (i = 0; i < this->numRows; i++)
+        {
+            if (((const uint*)values)[i] >= (uint)this->numStrings)
+            {
+                return false;
+            }
+        }
+        break;
+    case BlobType:
+        for (i = 0; i < this->numRows; i++)
+        {
+            const CompiledTableBlob& blob = ((const CompiledTableBlob*)values)[i];
+            if (blob.offset > blobDataSize || blob.size > blobDataSize - blob.offset)
+            {
+                return false;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+CompiledAttributeTable::GetValueTypeSize(ValueType type)
+{
+    switch (type)
+    {
+    case IntType:       return sizeof(int);
+    case UIntType:      return sizeof(uint);
+    case Int64Type:     return sizeof(int64_t);
+    case BoolType:      return sizeof(ubyte);
+    case FloatType:     return sizeof(float);
+    case Vec4Type:      return sizeof(float) * 4;
+    case Mat4Type:      return sizeof(float) * 16;
+    case StringType:    return sizeof(uint);
+    case GuidType:      return 16;
+    case BlobType:      return sizeof(CompiledTableBlob);
+    default:            return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+IndexT
+CompiledAttributeTable::FindRowIndexByInt(const IntAttrId& colAttrId, int key) const
+{
+    const IndexT colIndex = this->indexMap[colAttrId];
+    return this->FindRowIndex(colIndex, CompiledTableHash((uint64_t)(uint)key), [this, colIndex, key](IndexT rowIndex)
+    {
+        return this->GetInt(colIndex, rowIndex) == key;
+    });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+IndexT
+CompiledAttributeTable::FindRowIndexByString(const StringAttrId& colAttrId, const char* key) const
+{
+    n_assert(nullptr != key);
+    const IndexT colIndex = this->indexMap[colAttrId];
+    return this->FindRowIndex(colIndex, CompiledTableHash(key, (SizeT)strlen(key)), [this, colIndex, key](IndexT rowIndex)
+    {
+        return 0 == strcmp(this->GetString(colIndex, rowIndex), key);
+    });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+IndexT
+CompiledAttributeTable::FindRowIndexByGuid(const GuidAttrId& colAttrId, const Guid& key) const
+{
+    const IndexT colIndex = this->indexMap[colAttrId];
+    const unsigned char* bytes = nullptr;
+    const SizeT numBytes = key.AsBinary(bytes);
+    n_assert(16 == numBytes);
+    return this->FindRowIndex(colIndex, CompiledTableHash(bytes, numBytes), [this, colIndex, bytes](IndexT rowIndex)
+    {
+        return 0 == memcmp(this->GetValuePtr(colIndex, rowIndex), bytes, 16);
+    });
+}
+
+//------------------------------------------------------------------------------
+/**
+    Generic version of the typed finders, also works on non-key columns
+    of any type by scanning them.
+*/
+IndexT
+CompiledAttributeTable::FindRowIndexByAttr(const Attribute& attr) const
+{
+    const IndexT colIndex = this->GetColumnIndex(attr.GetAttrId());
+    if (InvalidIndex == colIndex)
+    {
+        return InvalidIndex;
+    }
+
+    switch (attr.GetValueType())
+    {
+    case IntType:
+        return this->FindRowIndexByInt(attr.GetAttrId(), attr.GetInt());
+    case StringType:
+        return this->FindRowIndexByString(attr.GetAttrId(), attr.GetString().AsCharPtr());
+    case GuidType:
+        return this->FindRowIndexByGuid(attr.GetAttrId(), attr.GetGuid());
+    case UIntType:
+        {
+            const uint key = attr.GetUInt();
+            return this->FindRowIndex(colIndex, CompiledTableHash((uint64_t)key), [this, colIndex, key](IndexT rowIndex)
+            {
+                return this->GetUInt(colIndex, rowIndex) == key;
+            });
+        }
+    case Int64Type:
+        {
+            const int64_t key = attr.GetInt64();
+            return this->FindRowIndex(colIndex, CompiledTableHash((uint64_t)key), [this, colIndex, key](IndexT rowIndex)
+            {
+                return this->GetInt64(colIndex, rowIndex) == key;
+            });
+        }
+    case FloatType:
+        {
+            const float key = attr.GetFloat();
+            return this->FindRowIndex(colIndex, 0, [this, colIndex, key](IndexT rowIndex)
+            {
+                return this->GetFloat(colIndex, rowIndex) == key;
+            });
+        }
+    case BoolType:
+        {
+            const bool key = attr.GetBool();
+            return this->FindRowIndex(colIndex, 0, [this, colIndex, key](IndexT rowIndex)
+            {
+                return this->GetBool(colIndex, rowIndex) == key;
+            });
+        }
+    case Vec4Type:
+        {
+            const Math::vec4 key = attr.GetVec4();
+            return this->FindRowIndex(colIndex, 0, [this, colIndex, &key](IndexT rowIndex)
+            {
+                return this->GetVec4(colIndex, rowIndex) == key;
+            });
+        }
+    case BlobType:
+        {
+            const Blob& key = attr.GetBlob();
+            return this->FindRowIndex(colIndex, 0, [this, colIndex, &key](IndexT rowIndex)
+            {
+                SizeT size;
+                const void* ptr = this->GetBlob(colIndex, rowIndex, size);
+                return (size_t)size == key.Size() && (0 == size || 0 == memcmp(ptr, key.GetPtr(), size));
+            });
+        }
+    default:
+        n_error("CompiledAttributeTable::FindRowIndexByAttr(): unsupported value type!");
+        return InvalidIndex;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Attribute
+CompiledAttributeTable::GetAttr(IndexT rowIndex, IndexT colIndex) const
+{
+    const AttrId& attrId = this->GetColumnId(colIndex);
+    switch (attrId.GetValueType())
+    {
+    case IntType:       return Attribute(attrId, this->GetInt(colIndex, rowIndex));
+    case UIntType:      return Attribute(attrId, this->GetUInt(colIndex, rowIndex));
+    case Int64Type:     return Attribute(attrId, this->GetInt64(colIndex, rowIndex));
+    case FloatType:     return Attribute(attrId, this->GetFloat(colIndex, rowIndex));
+    case BoolType:      return Attribute(attrId, this->GetBool(colIndex, rowIndex));
+    case Vec4Type:      return Attribute(attrId, this->GetVec4(colIndex, rowIndex));
+    case StringType:    return Attribute(attrId, String(this->GetString(colIndex, rowIndex)));
+    case Mat4Type:      return Attribute(attrId, this->GetMat4(colIndex, rowIndex));
+    case GuidType:      return Attribute(attrId, this->GetGuid(colIndex, rowIndex));
+    case BlobType:
+        {
+            SizeT size;
+            const void* ptr = this->GetBlob(colIndex, rowIndex, size);
+            return Attribute(attrId, Blob(ptr, size));
+        }
+    default:
+        n_error("Invalid value type!");
+        return Attribute();
+    }
+}
+
+} // namespace Attr
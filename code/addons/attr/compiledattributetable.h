@@ -0,0 +1,574 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Attr::CompiledAttributeTable
+
+    A read-only attribute table in the compiled binary format written by
+    ToolkitUtil::CompiledTableWriter. The file is memory mapped and never
+    parsed: every column is a contiguous array of its values, so GetInt(),
+    GetFloat() and friends read straight from the mapped file.
+
+    String columns are dictionary encoded, each cell holds an index into
+    a table of zero terminated strings which are shared by all columns,
+    so GetString() returns a pointer into the file instead of a Util::String.
+    Key columns carry a hash index, which makes looking up a row by its
+    key O(1). Looking up a value in any other column scans the column.
+
+    Supported column types are Int, UInt, Int64, Float, Bool, Vec4, Mat4,
+    String, Guid and Blob, key columns can be Int, UInt, Int64, String or
+    Guid and have unique values.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "core/refcounted.h"
+#include "attribute.h"
+#include "io/stream.h"
+#include "io/uri.h"
+
+//------------------------------------------------------------------------------
+namespace Attr
+{
+
+/// file header, the column descriptions directly follow it
+struct CompiledTableHeader
+{
+    static const uint Magic = 'NCAT';
+    static const uint Version = 1;
+
+    uint magic;
+    uint version;
+    uint numRows;
+    uint numColumns;
+    uint numStrings;            // number of entries in the string dictionary
+    uint pad;
+    uint64_t stringOffsets;     // file offset of one uint per string, relative to stringData
+    uint64_t stringData;        // file offset of the zero terminated strings
+    uint64_t blobData;          // file offset of the blob data
+};
+
+/// description of a column
+struct CompiledTableColumn
+{
+    uint name;                  // string index of the attribute name
+    uint valueType;             // Attr::ValueType
+    uint64_t values;            // file offset of the column values, 16 byte aligned
+    uint64_t buckets;           // file offset of the hash index, 0 if this is not a key column
+    uint numBuckets;            // power of two, each bucket holds a row index + 1 or 0 if empty
+    uint pad;
+};
+
+/// cell of a blob column
+struct CompiledTableBlob
+{
+    uint64_t offset;            // relative to blobData
+    uint64_t size;
+};
+
+//------------------------------------------------------------------------------
+/**
+    FNV-1a, used for string and guid keys.
+*/
+inline uint
+CompiledTableHash(const void* data, SizeT size)
+{
+    const ubyte* ptr = (const ubyte*)data;
+    uint hash = 2166136261u;
+    IndexT i;
+    for (i = 0; i < size; i++)
+    {
+        hash ^= ptr[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Integer finalizer from murmur3, used for integer keys.
+*/
+inline uint
+CompiledTableHash(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return (uint)value;
+}
+
+class CompiledAttributeTable : public Core::RefCounted
+{
+    __DeclareClass(CompiledAttributeTable);
+public:
+    /// constructor
+    CompiledAttributeTable();
+    /// destructor
+    virtual ~CompiledAttributeTable();
+
+    /// map a compiled table file
+    bool Open(const IO::URI& uri);
+    /// unmap the file
+    void Close();
+    /// return true if a file is mapped
+    bool IsOpen() const;
+
+    /// get number of rows
+    SizeT GetNumRows() const;
+    /// get number of columns
+    SizeT GetNumColumns() const;
+    /// return true if a column exists
+    bool HasColumn(const AttrId& id) const;
+    /// return index of column by id
+    IndexT GetColumnIndex(const AttrId& id) const;
+    /// get column attribute id at index
+    const AttrId& GetColumnId(IndexT colIndex) const;
+    /// get a column's value type
+    ValueType GetColumnValueType(IndexT colIndex) const;
+    /// return true if the column has a key index
+    bool IsKeyColumn(IndexT colIndex) const;
+    /// get pointer to the values of a column, GetNumRows() values of the column type, string columns hold string indices
+    const void* GetColumnValues(IndexT colIndex) const;
+
+    /// find row by value, O(1) on key columns, returns InvalidIndex if not found
+    IndexT FindRowIndexByAttr(const Attribute& attr) const;
+    /// find row by int key
+    IndexT FindRowIndexByInt(const IntAttrId& colAttrId, int key) const;
+    /// find row by string key
+    IndexT FindRowIndexByString(const StringAttrId& colAttrId, const char* key) const;
+    /// find row by guid key
+    IndexT FindRowIndexByGuid(const GuidAttrId& colAttrId, const Util::Guid& key) const;
+
+    /// get bool value
+    bool GetBool(const BoolAttrId& colAttrId, IndexT rowIndex) const;
+    /// get float value
+    float GetFloat(const FloatAttrId& colAttrId, IndexT rowIndex) const;
+    /// get int value
+    int GetInt(const IntAttrId& colAttrId, IndexT rowIndex) const;
+    /// get uint value
+    uint GetUInt(const UIntAttrId& colAttrId, IndexT rowIndex) const;
+    /// get int64 value
+    int64_t GetInt64(const Int64AttrId& colAttrId, IndexT rowIndex) const;
+    /// get string value
+    const char* GetString(const StringAttrId& colAttrId, IndexT rowIndex) const;
+    /// get float4 value
+    Math::vec4 GetVec4(const Vec4AttrId& colAttrId, IndexT rowIndex) const;
+    /// get mat4 value
+    Math::mat4 GetMat4(const Mat4AttrId& colAttrId, IndexT rowIndex) const;
+    /// get guid value
+    Util::Guid GetGuid(const GuidAttrId& colAttrId, IndexT rowIndex) const;
+    /// get blob value, returns pointer into the file
+    const void* GetBlob(const BlobAttrId& colAttrId, IndexT rowIndex, SizeT& outSize) const;
+
+    /// get bool value by column index
+    bool GetBool(IndexT colIndex, IndexT rowIndex) const;
+    /// get float value by column index
+    float GetFloat(IndexT colIndex, IndexT rowIndex) const;
+    /// get int value by column index
+    int GetInt(IndexT colIndex, IndexT rowIndex) const;
+    /// get uint value by column index
+    uint GetUInt(IndexT colIndex, IndexT rowIndex) const;
+    /// get int64 value by column index
+    int64_t GetInt64(IndexT colIndex, IndexT rowIndex) const;
+    /// get string value by column index
+    const char* GetString(IndexT colIndex, IndexT rowIndex) const;
+    /// get string index by column index, equal strings have equal indices
+    uint GetStringIndex(IndexT colIndex, IndexT rowIndex) const;
+    /// get float4 value by column index
+    Math::vec4 GetVec4(IndexT colIndex, IndexT rowIndex) const;
+    /// get mat4 value by column index
+    Math::mat4 GetMat4(IndexT colIndex, IndexT rowIndex) const;
+    /// get guid value by column index
+    Util::Guid GetGuid(IndexT colIndex, IndexT rowIndex) const;
+    /// get blob value by column index, returns pointer into the file
+    const void* GetBlob(IndexT colIndex, IndexT rowIndex, SizeT& outSize) const;
+
+    /// get a generic attribute (slow!)
+    Attribute GetAttr(IndexT rowIndex, IndexT colIndex) const;
+    /// get string from the string dictionary
+    const char* GetDictionaryString(uint stringIndex) const;
+
+    /// returns the byte size of a value of the given type in a compiled table, 0 if the type is not supported
+    static SizeT GetValueTypeSize(ValueType type);
+
+private:
+    /// validate the mapped file and set up the columns
+    bool Setup(const IO::URI& uri, const ubyte* ptr, IO::Stream::Size size);
+    /// check the hash index, string and blob cells of a column
+    bool ValidateColumnData(const CompiledTableColumn& desc, const ubyte* ptr, uint64_t blobDataSize) const;
+    /// returns pointer to a value's memory location
+    const void* GetValuePtr(IndexT colIndex, IndexT rowIndex) const;
+    /// probe the hash index of a key column or scan any other column, compare returns true if the row has the key
+    template <typename COMPARE> IndexT FindRowIndex(IndexT colIndex, uint hash, const COMPARE& compare) const;
+
+    struct ColumnInfo
+    {
+        AttrId attrId;
+        const ubyte* values;
+        SizeT valueSize;
+        const uint* buckets;    // nullptr if not a key column
+        uint bucketMask;
+    };
+
+    Ptr<IO::Stream> stream;
+    const ubyte* data;
+    bool memoryMapped;
+    SizeT numRows;
+    Util::Array<ColumnInfo> columns;
+    Util::Dictionary<AttrId, IndexT> indexMap;
+    const uint* stringOffsets;
+    const char* stringData;
+    SizeT numStrings;
+    const ubyte* blobData;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+CompiledAttributeTable::IsOpen() const
+{
+    return nullptr != this->data;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+CompiledAttributeTable::GetNumRows() const
+{
+    return this->numRows;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+CompiledAttributeTable::GetNumColumns() const
+{
+    return this->columns.Size();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+CompiledAttributeTable::HasColumn(const AttrId& id) const
+{
+    return this->indexMap.Contains(id);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline IndexT
+CompiledAttributeTable::GetColumnIndex(const AttrId& id) const
+{
+    IndexT index = this->indexMap.FindIndex(id);
+    if (InvalidIndex == index)
+    {
+        return InvalidIndex;
+    }
+    return this->indexMap.ValueAtIndex(index);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const AttrId&
+CompiledAttributeTable::GetColumnId(IndexT colIndex) const
+{
+    return this->columns[colIndex].attrId;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline ValueType
+CompiledAttributeTable::GetColumnValueType(IndexT colIndex) const
+{
+    return this->columns[colIndex].attrId.GetValueType();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+CompiledAttributeTable::IsKeyColumn(IndexT colIndex) const
+{
+    return nullptr != this->columns[colIndex].buckets;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const void*
+CompiledAttributeTable::GetColumnValues(IndexT colIndex) const
+{
+    return this->columns[colIndex].values;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const void*
+CompiledAttributeTable::GetValuePtr(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert((rowIndex >= 0) && (rowIndex < this->numRows));
+    const ColumnInfo& column = this->columns[colIndex];
+    return column.values + rowIndex * column.valueSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const char*
+CompiledAttributeTable::GetDictionaryString(uint stringIndex) const
+{
+    n_assert(stringIndex < (uint)this->numStrings);
+    return this->stringData + this->stringOffsets[stringIndex];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+CompiledAttributeTable::GetBool(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == BoolType);
+    return 0 != *(const ubyte*)this->GetValuePtr(colIndex, rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline float
+CompiledAttributeTable::GetFloat(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == FloatType);
+    return *(const float*)this->GetValuePtr(colIndex, rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline int
+CompiledAttributeTable::GetInt(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == IntType);
+    return *(const int*)this->GetValuePtr(colIndex, rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint
+CompiledAttributeTable::GetUInt(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == UIntType);
+    return *(const uint*)this->GetValuePtr(colIndex, rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline int64_t
+CompiledAttributeTable::GetInt64(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == Int64Type);
+    return *(const int64_t*)this->GetValuePtr(colIndex, rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint
+CompiledAttributeTable::GetStringIndex(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == StringType);
+    return *(const uint*)this->GetValuePtr(colIndex, rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const char*
+CompiledAttributeTable::GetString(IndexT colIndex, IndexT rowIndex) const
+{
+    return this->GetDictionaryString(this->GetStringIndex(colIndex, rowIndex));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Math::vec4
+CompiledAttributeTable::GetVec4(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == Vec4Type);
+    Math::vec4 val;
+    val.loadu((const Math::scalar*)this->GetValuePtr(colIndex, rowIndex));
+    return val;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Math::mat4
+CompiledAttributeTable::GetMat4(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == Mat4Type);
+    Math::mat4 val;
+    val.loadu((const Math::scalar*)this->GetValuePtr(colIndex, rowIndex));
+    return val;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Util::Guid
+CompiledAttributeTable::GetGuid(IndexT colIndex, IndexT rowIndex) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == GuidType);
+    return Util::Guid((const unsigned char*)this->GetValuePtr(colIndex, rowIndex), 16);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const void*
+CompiledAttributeTable::GetBlob(IndexT colIndex, IndexT rowIndex, SizeT& outSize) const
+{
+    n_assert(this->GetColumnValueType(colIndex) == BlobType);
+    const CompiledTableBlob* blob = (const CompiledTableBlob*)this->GetValuePtr(colIndex, rowIndex);
+    outSize = (SizeT)blob->size;
+    return this->blobData + blob->offset;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+CompiledAttributeTable::GetBool(const BoolAttrId& colAttrId, IndexT rowIndex) const
+{
+    return this->GetBool(this->indexMap[colAttrId], rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline float
+CompiledAttributeTable::GetFloat(const FloatAttrId& colAttrId, IndexT rowIndex) const
+{
+    return this->GetFloat(this->indexMap[colAttrId], rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline int
+CompiledAttributeTable::GetInt(const IntAttrId& colAttrId, IndexT rowIndex) const
+{
+    return this->GetInt(this->indexMap[colAttrId], rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint
+CompiledAttributeTable::GetUInt(const UIntAttrId& colAttrId, IndexT rowIndex) const
+{
+    return this->GetUInt(this->indexMap[colAttrId], rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline int64_t
+CompiledAttributeTable::GetInt64(const Int64AttrId& colAttrId, IndexT rowIndex) const
+{
+    return this->GetInt64(this->indexMap[colAttrId], rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const char*
+CompiledAttributeTable::GetString(const StringAttrId& colAttrId, IndexT rowIndex) const
+{
+    return this->GetString(this->indexMap[colAttrId], rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Math::vec4
+CompiledAttributeTable::GetVec4(const Vec4AttrId& colAttrId, IndexT rowIndex) const
+{
+    return this->GetVec4(this->indexMap[colAttrId], rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Math::mat4
+CompiledAttributeTable::GetMat4(const Mat4AttrId& colAttrId, IndexT rowIndex) const
+{
+    return this->GetMat4(this->indexMap[colAttrId], rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Util::Guid
+CompiledAttributeTable::GetGuid(const GuidAttrId& colAttrId, IndexT rowIndex) const
+{
+    return this->GetGuid(this->indexMap[colAttrId], rowIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const void*
+CompiledAttributeTable::GetBlob(const BlobAttrId& colAttrId, IndexT rowIndex, SizeT& outSize) const
+{
+    return this->GetBlob(this->indexMap[colAttrId], rowIndex, outSize);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename COMPARE>
+inline IndexT
+CompiledAttributeTable::FindRowIndex(IndexT colIndex, uint hash, const COMPARE& compare) const
+{
+    const ColumnInfo& column = this->columns[colIndex];
+    if (nullptr == column.buckets)
+    {
+        IndexT rowIndex;
+        for (rowIndex = 0; rowIndex < this->numRows; rowIndex++)
+        {
+            if (compare(rowIndex))
+            {
+                return rowIndex;
+            }
+        }
+        return InvalidIndex;
+    }
+
+    // the index is at most half full, so there always is an empty bucket
+    uint bucket = hash & column.bucketMask;
+    while (0 != column.buckets[bucket])
+    {
+        IndexT rowIndex = column.buckets[bucket] - 1;
+        if (compare(rowIndex))
+        {
+            return rowIndex;
+        }
+        bucket = (bucket + 1) & column.bucketMask;
+    }
+    return InvalidIndex;
+}
+
+} // namespace Attr
+//------------------------------------------------------------------------------
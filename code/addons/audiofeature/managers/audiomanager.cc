@@ -58,7 +58,12 @@ AudioManager::InitAudioEmitter(Game::World* world, Game::Entity entity, AudioEmi
 {
     Ptr<Audio::AudioDevice> audioDevice = Audio::AudioDevice::Instance();
     emitter->clipId = audioDevice->LoadClip(emitter->clipResource).id;
-    if (emitter->autoplay)
+    if (emitter->autoplay && audioDevice->GetClipState(emitter->clipId) == Resources::Resource::Pending)
+    {
+        // the clip is still loading, the play event handlers wait for it
+        world->AddComponent<PlayAudioEvent>(entity);
+    }
+    else if (emitter->autoplay)
     {
         if (world->HasComponent<SpatialAudioEmission>(entity))
         {
@@ -74,7 +79,8 @@ AudioManager::InitAudioEmitter(Game::World* world, Game::Entity entity, AudioEmi
                 spatial.minDistance,
                 spatial.maxDistance,
                 emitter->loop,
-                emitter->clock
+                emitter->clock,
+                emitter->priority
             );
             ClipInstance* instance = world->AddComponent<ClipInstance>(entity);
             instance->id = clipInstanceId.id;
@@ -82,7 +88,7 @@ AudioManager::InitAudioEmitter(Game::World* world, Game::Entity entity, AudioEmi
         else
         {
             Audio::ClipInstanceId clipInstanceId =
-                audioDevice->Play(emitter->clipId, emitter->volume, emitter->pan, emitter->loop, emitter->clock);
+                audioDevice->Play(emitter->clipId, emitter->volume, emitter->pan, emitter->loop, emitter->clock, emitter->priority);
             ClipInstance* instance = world->AddComponent<ClipInstance>(entity);
             instance->id = clipInstanceId.id;
         }
@@ -137,10 +143,19 @@ void
 HandlePlayAudioEvent(Game::World* world, Game::Entity const& entity, AudioEmitter const& emitter)
 {
     Ptr<Audio::AudioDevice> audioDevice = Audio::AudioDevice::Instance();
-    Audio::ClipInstanceId clipInstanceId =
-        audioDevice->Play(emitter.clipId, emitter.volume, emitter.pan, emitter.loop, emitter.clock);
-    ClipInstance* instance = world->AddComponent<ClipInstance>(entity);
-    instance->id = clipInstanceId.id;
+    Resources::Resource::State const state = audioDevice->GetClipState(emitter.clipId);
+    if (state == Resources::Resource::Pending)
+    {
+        // keep the event until the clip is loaded
+        return;
+    }
+    if (state == Resources::Resource::Loaded)
+    {
+        Audio::ClipInstanceId clipInstanceId =
+            audioDevice->Play(emitter.clipId, emitter.volume, emitter.pan, emitter.loop, emitter.clock, emitter.priority);
+        ClipInstance* instance = world->AddComponent<ClipInstance>(entity);
+        instance->id = clipInstanceId.id;
+    }
     world->RemoveComponent<PlayAudioEvent>(entity);
 }
 
@@ -157,10 +172,21 @@ HandlePlaySpatialAudioEvent(
 )
 {
     Ptr<Audio::AudioDevice> audioDevice = Audio::AudioDevice::Instance();
-    Math::vec3 velocity = Math::vec3(0);
-    Audio::ClipInstanceId clipInstanceId = audioDevice->PlaySpatial(
-        emitter.clipId, emitter.volume, position, velocity, spatial.minDistance, spatial.maxDistance, emitter.loop, emitter.clock
-    );
+    Resources::Resource::State const state = audioDevice->GetClipState(emitter.clipId);
+    if (state == Resources::Resource::Pending)
+    {
+        // keep the event until the clip is loaded
+        return;
+    }
+    if (state == Resources::Resource::Loaded)
+    {
+        Math::vec3 velocity = Math::vec3(0);
+        Audio::ClipInstanceId clipInstanceId = audioDevice->PlaySpatial(
+            emitter.clipId, emitter.volume, position, velocity, spatial.minDistance, spatial.maxDistance, emitter.loop, emitter.clock, emitter.priority
+        );
+        ClipInstance* instance = world->AddComponent<ClipInstance>(entity);
+        instance->id = clipInstanceId.id;
+    }
     world->RemoveComponent<PlayAudioEvent>(entity);
 }
 
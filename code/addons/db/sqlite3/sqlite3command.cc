@@ -35,14 +35,15 @@ Sqlite3Command::~Sqlite3Command()
 
 //------------------------------------------------------------------------------
 /**
-    Clears the currently compiled command.
+    Clears the currently compiled command, the compiled statement goes
+    back into the statement cache of the database.
 */
 void
 Sqlite3Command::Clear()
 {
     if (0 != this->sqliteStatement)
     {
-        sqlite3_finalize(this->sqliteStatement);
+        this->database.downcast<Sqlite3Database>()->ReleaseStatement(this->sqlCommand, this->sqliteStatement);
         this->sqliteStatement = 0;
     }
     this->valueTable = nullptr;
@@ -82,29 +83,16 @@ Sqlite3Command::Compile(const Ptr<Database>& db, const Util::String& sqlCommand,
     // then call parent class which initializes members
     Command::Compile(db, sqlCommand, resultTable);
 
-    // get database handle from our database
     Ptr<Sqlite3Database> sqliteDatabase = db.downcast<Sqlite3Database>();
     n_assert(db->IsA(Sqlite3Database::RTTI));
-    sqlite3* sqliteHandle = sqliteDatabase->GetSqliteHandle();
 
-    // let SQLite compile the SQL command
-    const char* cmdTail = 0;
-    int err = sqlite3_prepare_v2(sqliteHandle, this->sqlCommand.AsCharPtr(), -1, &this->sqliteStatement, &cmdTail);
-    if (err != SQLITE_OK)
+    // get the compiled statement from the database's cache, or let SQLite compile it
+    this->sqliteStatement = sqliteDatabase->AcquireStatement(this->sqlCommand);
+    if (0 == this->sqliteStatement)
     {
         this->SetSqliteError();
         return false;
     }
-    n_assert(0 != this->sqliteStatement);
-
-    // check if more then one SQL statement was in the string, we don't support that
-    n_assert(0 != cmdTail);
-    if (cmdTail[0] != 0)
-    {
-        n_error("Sqlite3Command::Compile(): Only one SQL statement allowed (cmd: %s)\n", this->sqlCommand.AsCharPtr());
-        this->Clear();
-        return false;
-    }
 
     // create an index map to map value table indices to sqlite result indices
     if (this->valueTable.isvalid())
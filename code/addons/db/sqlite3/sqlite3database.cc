@@ -9,6 +9,7 @@
 #include "db/sqlite3/sqlite3command.h"
 #include "db/sqlite3/sqlite3table.h"
 #include "db/sqlite3/sqlite3factory.h"
+#include "db/sqlite3/sqlite3writerthread.h"
 #include "io/ioserver.h"
 #include "attr/attributedefinitionbase.h"
 
@@ -39,9 +40,13 @@ using namespace Util;
 Sqlite3Database::Sqlite3Database() :
     cacheNumPages(2000),
     tempStore(Memory),
-    syncMode(false),
+    syncLevel(SyncOff),
+    journalMode(RollbackJournal),
     busyTimeout(100),
-    sqliteHandle(0)
+    writeBehind(false),
+    sqliteHandle(0),
+    statementCacheSize(64),
+    statementUseCount(0)
 {
     // empty
 }
@@ -151,10 +156,17 @@ Sqlite3Database::Open()
 
         cmd->CompileAndExecute(this, sql);
 
-        if (this->syncMode) sql = "PRAGMA synchronous=ON";
-        else sql = "PRAGMA synchronous=OFF";
+        static const char* syncLevels[] = { "OFF", "NORMAL", "FULL" };
+        sql.Format("PRAGMA synchronous=%s", syncLevels[this->syncLevel]);
         cmd->CompileAndExecute(this, sql);
 
+        // write-ahead logging lets readers continue while a write is in progress,
+        // and with synchronous=NORMAL only checkpoints wait for the disk
+        if (WriteAheadLog == this->journalMode && !this->memoryDatabase && ReadOnly != this->accessMode)
+        {
+            cmd->CompileAndExecute(this, "PRAGMA journal_mode=WAL");
+        }
+
         if (Memory == this->tempStore) sql = "PRAGMA temp_store=MEMORY";
         else sql = "PRAGMA temp_store=FILE";
         cmd->CompileAndExecute(this, sql);
@@ -193,6 +205,24 @@ Sqlite3Database::Open()
         // read existing database tables        
         this->ReadTableLayouts();
 
+        // the writer thread needs its own connection to the database file
+        if (this->writeBehind)
+        {
+            if (this->memoryDatabase || this->exclusiveMode || ReadOnly == this->accessMode)
+            {
+                n_warning("Sqlite3Database::Open(): write-behind needs a writable, non-exclusive database on disk, writing directly to '%s'\n", this->uri.AsString().AsCharPtr());
+                this->writeBehind = false;
+            }
+            else
+            {
+                this->writerThread = Sqlite3WriterThread::Create();
+                this->writerThread->SetDatabasePath(nativePath);
+                this->writerThread->SetSynchronous(syncLevels[this->syncLevel]);
+                this->writerThread->SetBusyTimeout(this->busyTimeout);
+                this->writerThread->Start();
+            }
+        }
+
         return true;
     }
     return false;
@@ -211,9 +241,17 @@ Sqlite3Database::Close()
     // first, call parent class this will disconnect all tables
     Database::Close();
 
+    // write everything still queued and close the writer's connection
+    if (this->writerThread.isvalid())
+    {
+        this->writerThread->Stop();
+        this->writerThread = nullptr;
+    }
+
     // release the transaction commands
     this->beginTransactionCmd = nullptr;
     this->endTransactionCmd = nullptr;
+    this->ClearStatementCache();
 
     // then close Sqlite database
     int err = sqlite3_close(this->sqliteHandle);
@@ -226,6 +264,134 @@ Sqlite3Database::Close()
     this->sqliteHandle = 0;
 }
 
+//------------------------------------------------------------------------------
+/**
+    Returns a compiled statement for the SQL text. A cached statement is
+    removed from the cache while it's in use, so two commands with the same
+    SQL never share one. Returns nullptr if compiling fails, the error is
+    left in the SQLite handle.
+*/
+sqlite3_stmt*
+Sqlite3Database::AcquireStatement(const String& sql)
+{
+    n_assert(0 != this->sqliteHandle);
+    IndexT index = this->statementCache.FindIndex(sql);
+    if (InvalidIndex != index)
+    {
+        sqlite3_stmt* stmt = this->statementCache.ValueAtIndex(index).stmt;
+        this->statementCache.EraseAtIndex(index);
+        return stmt;
+    }
+
+    sqlite3_stmt* stmt = 0;
+    const char* cmdTail = 0;
+    int err = sqlite3_prepare_v2(this->sqliteHandle, sql.AsCharPtr(), -1, &stmt, &cmdTail);
+    if (err != SQLITE_OK)
+    {
+        return 0;
+    }
+    n_assert(0 != stmt);
+
+    // check if more then one SQL statement was in the string, we don't support that
+    n_assert(0 != cmdTail);
+    if (cmdTail[0] != 0)
+    {
+        n_error("Sqlite3Database::AcquireStatement(): Only one SQL statement allowed (cmd: %s)\n", sql.AsCharPtr());
+        sqlite3_finalize(stmt);
+        return 0;
+    }
+    return stmt;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Resets the statement and puts it back into the cache. If the cache is
+    full the least recently used statement is finalized.
+*/
+void
+Sqlite3Database::ReleaseStatement(const String& sql, sqlite3_stmt* stmt)
+{
+    n_assert(0 != stmt);
+    if (0 == this->sqliteHandle || 0 == this->statementCacheSize || this->statementCache.Contains(sql))
+    {
+        sqlite3_finalize(stmt);
+        return;
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    if (this->statementCache.Size() >= this->statementCacheSize)
+    {
+        IndexT oldest = 0;
+        IndexT i;
+        for (i = 1; i < this->statementCache.Size(); i++)
+        {
+            if (this->statementCache.ValueAtIndex(i).lastUse < this->statementCache.ValueAtIndex(oldest).lastUse)
+            {
+                oldest = i;
+            }
+        }
+        sqlite3_finalize(this->statementCache.ValueAtIndex(oldest).stmt);
+        this->statementCache.EraseAtIndex(oldest);
+    }
+    this->statementCache.Add(sql, { stmt, this->statementUseCount++ });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Sqlite3Database::ClearStatementCache()
+{
+    IndexT i;
+    for (i = 0; i < this->statementCache.Size(); i++)
+    {
+        sqlite3_finalize(this->statementCache.ValueAtIndex(i).stmt);
+    }
+    this->statementCache.Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+Sqlite3Database::GetMaxNumParameters() const
+{
+    n_assert(0 != this->sqliteHandle);
+    return sqlite3_limit(this->sqliteHandle, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Sqlite3Database::EnqueueWrite(Sqlite3WriteBatch* batch)
+{
+    n_assert(this->writerThread.isvalid());
+    this->writerThread->Enqueue(batch);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+Sqlite3Database::HasPendingWrites() const
+{
+    return this->writerThread.isvalid() && this->writerThread->HasPendingWrites();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Sqlite3Database::Flush()
+{
+    if (this->writerThread.isvalid())
+    {
+        this->writerThread->Flush();
+    }
+}
+
 //------------------------------------------------------------------------------
 /**
     Begin a database transaction.
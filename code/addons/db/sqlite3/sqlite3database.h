@@ -7,6 +7,15 @@
     
     SQLite3 implementation of Db::Database.
 
+    Compiled statements are kept in a cache keyed by their SQL text, so
+    commands which are compiled over and over again (dataset queries,
+    table commits) only pay for the SQLite compiler once.
+
+    With write-behind enabled, table commits are handed to a
+    Sqlite3WriterThread instead of being written right away. Queries
+    through a dataset wait for pending writes first, anything else which
+    reads back written data should call Flush() before.
+
     @copyright
     (C) 2006 Radon Labs GmbH
     (C) 2013-2016 Individual contributors, see AUTHORS file
@@ -14,6 +23,7 @@
 #include "core/config.h"
 #include "attr/attribute.h"
 #include "db/database.h"
+#include "util/dictionary.h"
 #include "sqlite3.h"
 
 //------------------------------------------------------------------------------
@@ -34,6 +44,9 @@ namespace Attr
 //------------------------------------------------------------------------------
 namespace Db
 {
+class Sqlite3WriterThread;
+struct Sqlite3WriteBatch;
+
 class Sqlite3Database : public Database
 {
     __DeclareClass(Sqlite3Database);
@@ -45,6 +58,21 @@ public:
         Memory,
     };
 
+    /// journal mode
+    enum JournalMode
+    {
+        RollbackJournal,
+        WriteAheadLog,
+    };
+
+    /// synchronous level, how often SQLite waits for data to reach the disk
+    enum SyncLevel
+    {
+        SyncOff,
+        SyncNormal,
+        SyncFull,
+    };
+
     /// constructor
     Sqlite3Database();
     /// destructor
@@ -62,6 +90,22 @@ public:
     void SetSynchronousMode(bool b);
     /// get synchronous mode
     bool GetSynchronousMode() const;
+    /// set synchronous level
+    void SetSynchronousLevel(SyncLevel l);
+    /// get synchronous level
+    SyncLevel GetSynchronousLevel() const;
+    /// set journal mode, write-ahead log is ignored for in-memory databases
+    void SetJournalMode(JournalMode m);
+    /// get journal mode
+    JournalMode GetJournalMode() const;
+    /// set max number of cached statements (default is 64, 0 disables the cache)
+    void SetStatementCacheSize(SizeT num);
+    /// get max number of cached statements
+    SizeT GetStatementCacheSize() const;
+    /// enable writing table changes on a separate thread
+    void SetWriteBehind(bool b);
+    /// return true if table changes are written on a separate thread
+    bool IsWriteBehind() const;
     /// set busy timeout in milliseconds (default is 100, 0 disabled busy handling)
     void SetBusyTimeout(int ms);
     /// get busy timeout in milliseconds
@@ -83,6 +127,19 @@ public:
 
     /// get the SQLite database handle
     sqlite3* GetSqliteHandle() const;
+    /// get a compiled statement from the cache or compile it, returns nullptr on error
+    sqlite3_stmt* AcquireStatement(const Util::String& sql);
+    /// give a statement back to the cache
+    void ReleaseStatement(const Util::String& sql, sqlite3_stmt* stmt);
+    /// get the max number of placeholders in a single statement
+    SizeT GetMaxNumParameters() const;
+
+    /// queue a batch of writes on the writer thread, takes ownership
+    void EnqueueWrite(Sqlite3WriteBatch* batch);
+    /// return true if the writer thread has unwritten batches
+    bool HasPendingWrites() const;
+    /// block until all queued writes are in the database
+    void Flush();
     
     /// copy in memory database to file
     virtual void CopyInMemoryDatabaseToFile(const IO::URI& fileUri);
@@ -92,14 +149,28 @@ private:
     void ReadTableLayouts();
     /// dynamically register attributes from special _Attributes db table
     void RegisterAttributes(Ptr<Table>& attrTable);
+    /// finalize all cached statements
+    void ClearStatementCache();
+
+    struct CachedStatement
+    {
+        sqlite3_stmt* stmt;
+        uint64_t lastUse;
+    };
 
     SizeT cacheNumPages;
     TempStore tempStore;
-    bool syncMode;
+    SyncLevel syncLevel;
+    JournalMode journalMode;
     int busyTimeout;
+    bool writeBehind;
     sqlite3* sqliteHandle;
     Ptr<Command> beginTransactionCmd;
     Ptr<Command> endTransactionCmd;
+    Util::Dictionary<Util::String, CachedStatement> statementCache;
+    SizeT statementCacheSize;
+    uint64_t statementUseCount;
+    Ptr<Sqlite3WriterThread> writerThread;
 };
 
 //------------------------------------------------------------------------------
@@ -156,7 +227,7 @@ Sqlite3Database::GetTempStore() const
 inline void
 Sqlite3Database::SetSynchronousMode(bool b)
 {
-    this->syncMode = b;
+    this->syncLevel = b ? SyncNormal : SyncOff;
 }
 
 //------------------------------------------------------------------------------
@@ -165,7 +236,81 @@ Sqlite3Database::SetSynchronousMode(bool b)
 inline bool
 Sqlite3Database::GetSynchronousMode() const
 {
-    return this->syncMode;
+    return this->syncLevel != SyncOff;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Sqlite3Database::SetSynchronousLevel(SyncLevel l)
+{
+    this->syncLevel = l;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Sqlite3Database::SyncLevel
+Sqlite3Database::GetSynchronousLevel() const
+{
+    return this->syncLevel;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Sqlite3Database::SetJournalMode(JournalMode m)
+{
+    n_assert(!this->IsOpen());
+    this->journalMode = m;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Sqlite3Database::JournalMode
+Sqlite3Database::GetJournalMode() const
+{
+    return this->journalMode;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Sqlite3Database::SetStatementCacheSize(SizeT num)
+{
+    this->statementCacheSize = num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+Sqlite3Database::GetStatementCacheSize() const
+{
+    return this->statementCacheSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Sqlite3Database::SetWriteBehind(bool b)
+{
+    n_assert(!this->IsOpen());
+    this->writeBehind = b;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+Sqlite3Database::IsWriteBehind() const
+{
+    return this->writeBehind;
 }
 
 //------------------------------------------------------------------------------
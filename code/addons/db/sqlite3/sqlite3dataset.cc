@@ -5,6 +5,7 @@
 //------------------------------------------------------------------------------
 #include "foundation/stdneb.h"
 #include "db/sqlite3/sqlite3dataset.h"
+#include "db/sqlite3/sqlite3database.h"
 #include "db/command.h"
 #include "db/dbfactory.h"
 #include "db/database.h"
@@ -92,6 +93,9 @@ Sqlite3Dataset::PerformQuery(bool appendResult)
     // connect to the database table
     this->Connect();
 
+    // read back what has been written behind
+    this->table->GetDatabase().downcast<Sqlite3Database>()->Flush();
+
     // if not appending, clear all rows from the value table,
     // otherwise the new query will just be added to the value table
     if (!appendResult)
@@ -160,14 +164,16 @@ Sqlite3Dataset::PerformQuery(bool appendResult)
 
 //------------------------------------------------------------------------------
 /**
-    Commits any changes in the value table into the database.
+    Commits any changes in the value table into the database. The value
+    table belongs to this dataset, so its modified state is reset, otherwise
+    every following commit would write the same rows again.
 */
 void
-Sqlite3Dataset::CommitChanges(bool newRowsAsUpdate)
+Sqlite3Dataset::CommitChanges(bool /*newRowsAsUpdate*/)
 {
     n_assert(!this->IsConnected());
     this->Connect();
-    this->table->CommitChanges(newRowsAsUpdate);
+    this->table->CommitChanges(true, true);
     this->Disconnect();
 }
 
@@ -8,6 +8,7 @@
 #include "db/sqlite3/sqlite3database.h"
 #include "db/command.h"
 #include "db/sqlite3/sqlite3factory.h"
+#include "db/sqlite3/sqlite3writerthread.h"
 #include "attr/valuetype.h"
 #include "attr/attrid.h"
 
@@ -32,6 +33,10 @@ const Util::String Sqlite3Table::TextFrag(" TEXT");
 const Util::String Sqlite3Table::BlobFrag(" BLOB");
 const Util::String Sqlite3Table::WhereFrag(" WHERE ");
 const Util::String Sqlite3Table::DeleteFromFrag("DELETE FROM ");
+const Util::String Sqlite3Table::NextRowFrag("),(");
+const Util::String Sqlite3Table::OnConflictFrag(") ON CONFLICT(");
+const Util::String Sqlite3Table::DoUpdateSetFrag(") DO UPDATE SET ");
+const Util::String Sqlite3Table::AssignExcludedFrag("=excluded.");
 
 using namespace Util;
 
@@ -70,6 +75,9 @@ Sqlite3Table::SetName(const Util::String& newName)
 {
     if (this->IsConnected())
     {
+        // queued writes still use the old name
+        this->database.downcast<Sqlite3Database>()->Flush();
+
         // create an SQL command which performs the rename
         String sql;
         sql.Format("ALTER TABLE '%s' RENAME TO '%s'", this->name.AsCharPtr(), newName.AsCharPtr());
@@ -108,6 +116,9 @@ Sqlite3Table::DropTable()
     n_assert(this->database.isvalid());
     n_assert(this->name.IsValid());
 
+    // don't drop the table under queued writes
+    this->database.downcast<Sqlite3Database>()->Flush();
+
     String sql;
     sql.Format("DROP TABLE '%s'", this->name.AsCharPtr());
     Ptr<Command> cmd = Sqlite3Factory::Instance()->CreateCommand();
@@ -354,6 +365,8 @@ Sqlite3Table::Connect(const Ptr<Database>& db, ConnectMode connectMode, bool ign
     this->insertCommand = DbFactory::Instance()->CreateCommand();
     this->updateCommand = DbFactory::Instance()->CreateCommand();
     this->deleteCommand = DbFactory::Instance()->CreateCommand();
+    this->batchInsertCommand = DbFactory::Instance()->CreateCommand();
+    this->batchUpdateCommand = DbFactory::Instance()->CreateCommand();
 }
 
 //------------------------------------------------------------------------------
@@ -374,6 +387,8 @@ Sqlite3Table::Disconnect(bool dropTable)
     this->insertCommand = nullptr;
     this->updateCommand = nullptr;
     this->deleteCommand = nullptr;
+    this->batchInsertCommand = nullptr;
+    this->batchUpdateCommand = nullptr;
     Table::Disconnect(dropTable);
 }
 
@@ -388,6 +403,8 @@ Sqlite3Table::BindValueTable(const Ptr<ValueTable>& valTable)
         this->insertCommand->Clear();
         this->updateCommand->Clear();
         this->deleteCommand->Clear();
+        this->batchInsertCommand->Clear();
+        this->batchUpdateCommand->Clear();
     }
     Table::BindValueTable(valTable);
 }
@@ -404,6 +421,8 @@ Sqlite3Table::UnbindValueTable()
         this->insertCommand->Clear();
         this->updateCommand->Clear();
         this->deleteCommand->Clear();
+        this->batchInsertCommand->Clear();
+        this->batchUpdateCommand->Clear();
     }
 }
 
@@ -433,6 +452,17 @@ Sqlite3Table::CommitChanges(bool resetModifiedState, bool useTransaction)
         this->CommitUncommittedColumns();
     }
 
+    // with write-behind, copy the changes and let the writer thread do the rest
+    if (this->valueTable.isvalid() && this->database.downcast<Sqlite3Database>()->IsWriteBehind())
+    {
+        this->QueueChanges(false);
+        if (resetModifiedState)
+        {
+            this->valueTable->ResetModifiedState();
+        }
+        return;
+    }
+
     // commit any changes to tables values
     if (this->valueTable.isvalid())
     {
@@ -562,6 +592,12 @@ Sqlite3Table::CommitDeletedRows()
 {
     n_assert(this->database.isvalid());
     n_assert(this->name.IsValid());
+    if (this->valueTable.isvalid() && this->database.downcast<Sqlite3Database>()->IsWriteBehind())
+    {
+        this->QueueChanges(true);
+        this->valueTable->ClearDeletedRowsFlags();
+        return;
+    }
     if (this->valueTable.isvalid())
     {
         if (this->HasPrimaryColumn())
@@ -588,16 +624,16 @@ Sqlite3Table::CommitDeletedRows()
 
 //------------------------------------------------------------------------------
 /**
-    Recompiles the insert command which will write a complete new
-    row back into the database. The current implementation will
-    only update main table rows!
+    Builds an INSERT statement which writes numRows complete rows. For an
+    insert we need to write ALL columns, not just the read/write columns.
+    With updateExisting, rows whose primary key already exists are updated
+    instead, which lets a single statement update many rows.
 */
-void
-Sqlite3Table::CompileInsertCommand()
+String
+Sqlite3Table::BuildInsertSql(SizeT numRows, bool updateExisting)
 {
-    n_assert(this->database.isvalid());
-    n_assert(this->insertCommand.isvalid());
     n_assert(this->valueTable.isvalid());
+    n_assert(numRows > 0);
 
     String sql;
     sql.Reserve(4096);
@@ -605,8 +641,6 @@ Sqlite3Table::CompileInsertCommand()
     sql.Append(this->GetName());
     sql.Append(OpenBracketFrag);
 
-    // for an insert command we need to write ALL columns
-    // not just the read/write columns
     IndexT colIndex;
     const SizeT numColumns = this->valueTable->GetNumColumns();
     for (colIndex = 0; colIndex < numColumns; colIndex++)
@@ -620,19 +654,110 @@ Sqlite3Table::CompileInsertCommand()
         }
     }
     sql.Append(ValuesFrag);
-    for (colIndex = 0; colIndex < numColumns; colIndex++)
+    IndexT rowIndex;
+    for (rowIndex = 0; rowIndex < numRows; rowIndex++)
     {
-        // note: we're writing place holders here!
-        sql.Append(WildcardFrag);
-        if (colIndex < (numColumns - 1))
+        if (rowIndex > 0)
         {
-            sql.Append(CommaFrag);
+            sql.Append(NextRowFrag);
+        }
+        for (colIndex = 0; colIndex < numColumns; colIndex++)
+        {
+            // note: we're writing place holders here!
+            sql.Append(WildcardFrag);
+            if (colIndex < (numColumns - 1))
+            {
+                sql.Append(CommaFrag);
+            }
         }
     }
-    sql.Append(CloseBracketFrag);
+
+    if (updateExisting)
+    {
+        n_assert(this->HasPrimaryColumn());
+        const Attr::AttrId& primaryAttrId = this->GetPrimaryColumn().GetAttrId();
+        sql.Append(OnConflictFrag);
+        sql.Append(TickFrag);
+        sql.Append(this->GetPrimaryColumn().GetName());
+        sql.Append(TickFrag);
+        sql.Append(DoUpdateSetFrag);
+        bool first = true;
+        for (colIndex = 0; colIndex < numColumns; colIndex++)
+        {
+            if (this->valueTable->GetColumnId(colIndex) != primaryAttrId)
+            {
+                const Util::String& columnName = this->valueTable->GetColumnName(colIndex);
+                if (!first)
+                {
+                    sql.Append(CommaFrag);
+                }
+                first = false;
+                sql.Append(TickFrag);
+                sql.Append(columnName);
+                sql.Append(TickFrag);
+                sql.Append(AssignExcludedFrag);
+                sql.Append(TickFrag);
+                sql.Append(columnName);
+                sql.Append(TickFrag);
+            }
+        }
+    }
+    else
+    {
+        sql.Append(CloseBracketFrag);
+    }
+    return sql;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Builds the DELETE statement which deletes a row by its primary key.
+*/
+String
+Sqlite3Table::BuildDeleteSql()
+{
+    n_assert(this->HasPrimaryColumn());
+    String sql;
+    sql.Reserve(1024);
+    sql.Append(DeleteFromFrag);
+    sql.Append(this->GetName());
+    sql.Append(WhereFrag);
+    sql.Append(TickFrag);
+    sql.Append(this->GetPrimaryColumn().GetName());
+    sql.Append(TickFrag);
+    sql.Append(AssignWildcardFrag);
+    return sql;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Returns how many rows a batched statement writes. This is limited
+    by the number of placeholders SQLite accepts in a single statement.
+*/
+SizeT
+Sqlite3Table::GetBatchNumRows() const
+{
+    n_assert(this->valueTable.isvalid());
+    const SizeT maxParams = this->database.downcast<Sqlite3Database>()->GetMaxNumParameters();
+    const SizeT numColumns = Math::max(this->valueTable->GetNumColumns(), 1);
+    return Math::max(Math::min(maxParams / numColumns, (SizeT)MaxBatchNumRows), 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Recompiles the insert command which will write a complete new
+    row back into the database. The current implementation will
+    only update main table rows!
+*/
+void
+Sqlite3Table::CompileInsertCommand()
+{
+    n_assert(this->database.isvalid());
+    n_assert(this->insertCommand.isvalid());
+    n_assert(this->valueTable.isvalid());
 
     // compile the command
-    bool compiled = this->insertCommand->Compile(this->database, sql, valueTable);
+    bool compiled = this->insertCommand->Compile(this->database, this->BuildInsertSql(1, false), valueTable);
     if (!compiled)
     {
         n_error("Sqlite3Table::CompileInsertCommand: error compiling SQL statement:\n%s\nWith error:\n%s\n", 
@@ -717,18 +842,8 @@ Sqlite3Table::CompileDeleteCommand()
     n_assert(this->database.isvalid());
     n_assert(this->deleteCommand.isvalid());
 
-    // build an SQL string
-    String sql;
-    sql.Reserve(1024);
-    sql.Append(DeleteFromFrag);
-    sql.Append(this->GetName());
-    sql.Append(WhereFrag);
-    sql.Append(TickFrag);
-    sql.Append(this->GetPrimaryColumn().GetName());
-    sql.Append(TickFrag);
-    sql.Append(AssignWildcardFrag);
-
     // compile the command
+    const String sql = this->BuildDeleteSql();
     bool compiled = this->deleteCommand->Compile(this->database, sql);
     if (!compiled)
     {
@@ -793,6 +908,59 @@ Sqlite3Table::BindValueToCommand(const Ptr<Command>& cmd, IndexT wildCardIndex,
     }
 }
 
+//------------------------------------------------------------------------------
+/**
+    Writes as many rows as fit into full batches with a single multi-row
+    INSERT per batch. The remaining rows are left to the caller's
+    single-row command. Returns the number of rows written.
+*/
+SizeT
+Sqlite3Table::ExecuteBatchedInsert(Ptr<Command>& batchCommand, bool updateExisting, const Util::Array<IndexT>& rowIndices)
+{
+    n_assert(this->valueTable.isvalid());
+    const SizeT batchNumRows = this->GetBatchNumRows();
+    if (batchNumRows < 2 || rowIndices.Size() < batchNumRows)
+    {
+        return 0;
+    }
+
+    if (!batchCommand->IsValid())
+    {
+        bool compiled = batchCommand->Compile(this->database, this->BuildInsertSql(batchNumRows, updateExisting));
+        if (!compiled)
+        {
+            n_error("Sqlite3Table::ExecuteBatchedInsert: error compiling SQL statement:\n%s\nWith error:\n%s\n", 
+                batchCommand->GetSqlCommand().AsCharPtr(), batchCommand->GetError().AsCharPtr());
+            return 0;
+        }
+    }
+
+    const SizeT numValueTableColumns = this->valueTable->GetNumColumns();
+    IndexT i;
+    for (i = 0; i + batchNumRows <= rowIndices.Size(); i += batchNumRows)
+    {
+        IndexT wildCardIndex = 0;
+        IndexT batchRowIndex;
+        for (batchRowIndex = 0; batchRowIndex < batchNumRows; batchRowIndex++)
+        {
+            IndexT valueTableColIndex;
+            for (valueTableColIndex = 0; valueTableColIndex < numValueTableColumns; valueTableColIndex++)
+            {
+                this->BindValueToCommand(batchCommand, wildCardIndex++, valueTableColIndex, rowIndices[i + batchRowIndex]);
+            }
+        }
+
+        bool executed = batchCommand->Execute();
+        if (!executed)
+        {
+            n_error("Sqlite3Table::ExecuteBatchedInsert(): error in rows '%d' to '%d' for command '%s' with '%s'", 
+                rowIndices[i], rowIndices[i + batchNumRows - 1], batchCommand->GetSqlCommand().AsCharPtr(), 
+                batchCommand->GetError().AsCharPtr());
+        }
+    }
+    return i;
+}
+
 //------------------------------------------------------------------------------
 /**
     This executes the pre-compiled insert command for each new row. Ignores
@@ -804,32 +972,40 @@ Sqlite3Table::ExecuteInsertCommand()
     n_assert(this->insertCommand.isvalid() && this->insertCommand->GetSqlCommand().IsValid());
     n_assert(this->valueTable);
 
-    // for each new row...
+    // collect new rows which haven't been deleted again
     const Util::Array<IndexT> newRowIndices = this->valueTable->GetNewRowIndices();
+    Util::Array<IndexT> rowIndices;
+    rowIndices.Reserve(newRowIndices.Size());
     IndexT i;
-    SizeT num = newRowIndices.Size();
-    for (i = 0; i < num; i++)
+    for (i = 0; i < newRowIndices.Size(); i++)
+    {
+        if (!this->valueTable->IsRowDeleted(newRowIndices[i]))
+        {
+            rowIndices.Append(newRowIndices[i]);
+        }
+    }
+
+    // write full batches first, then the rest row by row
+    SizeT numWritten = this->ExecuteBatchedInsert(this->batchInsertCommand, false, rowIndices);
+    for (i = numWritten; i < rowIndices.Size(); i++)
     {
         // bind values to command 
-        IndexT valueTableRowIndex = newRowIndices[i];
-        if (!this->valueTable->IsRowDeleted(valueTableRowIndex))
+        IndexT valueTableRowIndex = rowIndices[i];
+        IndexT valueTableColIndex;
+        SizeT numValueTableColumns = this->valueTable->GetNumColumns();
+        for (valueTableColIndex = 0; valueTableColIndex < numValueTableColumns; valueTableColIndex++)
         {
-            IndexT valueTableColIndex;
-            SizeT numValueTableColumns = this->valueTable->GetNumColumns();
-            for (valueTableColIndex = 0; valueTableColIndex < numValueTableColumns; valueTableColIndex++)
-            {
-                IndexT wildCardIndex = valueTableColIndex;
-                this->BindValueToCommand(this->insertCommand, wildCardIndex, valueTableColIndex, valueTableRowIndex);
-            }
+            IndexT wildCardIndex = valueTableColIndex;
+            this->BindValueToCommand(this->insertCommand, wildCardIndex, valueTableColIndex, valueTableRowIndex);
+        }
 
-            // execute command
-            bool executed = this->insertCommand->Execute();
-            if (!executed)
-            {
-                n_error("Sqlite3Table::ExecuteInsertCommand(): error in row '%d' for command '%s' with '%s'", 
-                    valueTableRowIndex, this->insertCommand->GetSqlCommand().AsCharPtr(), 
-                    this->insertCommand->GetError().AsCharPtr());
-            }
+        // execute command
+        bool executed = this->insertCommand->Execute();
+        if (!executed)
+        {
+            n_error("Sqlite3Table::ExecuteInsertCommand(): error in row '%d' for command '%s' with '%s'", 
+                valueTableRowIndex, this->insertCommand->GetSqlCommand().AsCharPtr(), 
+                this->insertCommand->GetError().AsCharPtr());
         }
     }
 }
@@ -861,8 +1037,10 @@ Sqlite3Table::ExecuteUpdateCommand()
     IndexT valueTablePrimaryColIndex = this->valueTable->GetColumnIndex(this->GetPrimaryColumn().GetAttrId());
     n_assert(InvalidIndex != valueTablePrimaryColIndex);
 
+    // write full batches first, then the rest row by row
     IndexT i;
-    for (i = 0; i < modRowIndices.Size(); i++)
+    SizeT numWritten = this->ExecuteBatchedInsert(this->batchUpdateCommand, true, modRowIndices);
+    for (i = numWritten; i < modRowIndices.Size(); i++)
     {
         IndexT valueTableRowIndex = modRowIndices[i];
         IndexT wildCardIndex = 0;
@@ -926,6 +1104,125 @@ Sqlite3Table::ExecuteDeleteCommand()
     }
 }
 
+//------------------------------------------------------------------------------
+/**
+    Copies the changes of the value table into a write batch and hands it
+    to the database's writer thread. New and modified rows are written
+    with the same batched statements as a direct commit.
+*/
+void
+Sqlite3Table::QueueChanges(bool deletedRowsOnly)
+{
+    n_assert(this->valueTable.isvalid());
+    Sqlite3WriteBatch* batch = new Sqlite3WriteBatch;
+
+    if (!deletedRowsOnly)
+    {
+        if (this->valueTable->HasNewRows())
+        {
+            const Util::Array<IndexT> newRowIndices = this->valueTable->GetNewRowIndices();
+            Util::Array<IndexT> rowIndices;
+            rowIndices.Reserve(newRowIndices.Size());
+            IndexT i;
+            for (i = 0; i < newRowIndices.Size(); i++)
+            {
+                if (!this->valueTable->IsRowDeleted(newRowIndices[i]))
+                {
+                    rowIndices.Append(newRowIndices[i]);
+                }
+            }
+            this->QueueRows(batch, rowIndices, false);
+        }
+
+        // updating only works for tables with primary column
+        if (this->HasPrimaryColumn() && this->valueTable->HasModifiedRows() && this->valueTable->GetNumColumns() > 1)
+        {
+            n_assert(this->valueTable->HasColumn(this->GetPrimaryColumn().GetAttrId()));
+            this->QueueRows(batch, this->valueTable->GetModifiedRowsExcludeNewAndDeletedRows(), true);
+        }
+    }
+
+    if (this->HasPrimaryColumn() && this->valueTable->HasDeletedRows())
+    {
+        IndexT valueTablePrimaryColIndex = this->valueTable->GetColumnIndex(this->GetPrimaryColumn().GetAttrId());
+        n_assert(InvalidIndex != valueTablePrimaryColIndex);
+        const Util::Array<IndexT>& deletedRowIndices = this->valueTable->GetDeletedRowIndices();
+        batch->statements.Append({ this->BuildDeleteSql(), 1, deletedRowIndices.Size() });
+        IndexT i;
+        for (i = 0; i < deletedRowIndices.Size(); i++)
+        {
+            batch->values.Append(this->GetValueAsVariant(valueTablePrimaryColIndex, deletedRowIndices[i]));
+        }
+    }
+
+    if (batch->statements.IsEmpty())
+    {
+        delete batch;
+        return;
+    }
+    this->database.downcast<Sqlite3Database>()->EnqueueWrite(batch);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Sqlite3Table::QueueRows(Sqlite3WriteBatch* batch, const Util::Array<IndexT>& rowIndices, bool updateExisting)
+{
+    if (rowIndices.IsEmpty())
+    {
+        return;
+    }
+
+    const SizeT numColumns = this->valueTable->GetNumColumns();
+    const SizeT batchNumRows = this->GetBatchNumRows();
+    const SizeT numBatches = rowIndices.Size() / batchNumRows;
+    const SizeT numRemaining = rowIndices.Size() % batchNumRows;
+    if (numBatches > 0)
+    {
+        batch->statements.Append({ this->BuildInsertSql(batchNumRows, updateExisting), batchNumRows * numColumns, numBatches });
+    }
+    if (numRemaining > 0)
+    {
+        batch->statements.Append({ this->BuildInsertSql(1, updateExisting), numColumns, numRemaining });
+    }
+
+    batch->values.Reserve(batch->values.Size() + rowIndices.Size() * numColumns);
+    IndexT i;
+    for (i = 0; i < rowIndices.Size(); i++)
+    {
+        IndexT colIndex;
+        for (colIndex = 0; colIndex < numColumns; colIndex++)
+        {
+            batch->values.Append(this->GetValueAsVariant(colIndex, rowIndices[i]));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Util::Variant
+Sqlite3Table::GetValueAsVariant(IndexT valueTableColIndex, IndexT valueTableRowIndex) const
+{
+    switch (this->valueTable->GetColumnValueType(valueTableColIndex))
+    {
+        case Attr::IntType:     return Util::Variant(this->valueTable->GetInt(valueTableColIndex, valueTableRowIndex));
+        case Attr::Int64Type:   return Util::Variant(this->valueTable->GetInt64(valueTableColIndex, valueTableRowIndex));
+        case Attr::UIntType:    return Util::Variant(this->valueTable->GetUInt(valueTableColIndex, valueTableRowIndex));
+        case Attr::FloatType:   return Util::Variant(this->valueTable->GetFloat(valueTableColIndex, valueTableRowIndex));
+        case Attr::BoolType:    return Util::Variant(this->valueTable->GetBool(valueTableColIndex, valueTableRowIndex));
+        case Attr::Vec4Type:    return Util::Variant(this->valueTable->GetVec4(valueTableColIndex, valueTableRowIndex));
+        case Attr::StringType:  return Util::Variant(this->valueTable->GetString(valueTableColIndex, valueTableRowIndex));
+        case Attr::Mat4Type:    return Util::Variant(this->valueTable->GetMat4(valueTableColIndex, valueTableRowIndex));
+        case Attr::BlobType:    return Util::Variant(this->valueTable->GetBlob(valueTableColIndex, valueTableRowIndex));
+        case Attr::GuidType:    return Util::Variant(this->valueTable->GetGuid(valueTableColIndex, valueTableRowIndex));
+        default:
+            n_error("Sqlite3Table::GetValueAsVariant(): invalid attribute value type!");
+            return Util::Variant();
+    }
+}
+
 //------------------------------------------------------------------------------
 /**
     This method creates a multicolumn index on the table. The table must
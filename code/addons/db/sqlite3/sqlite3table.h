@@ -4,17 +4,27 @@
 //------------------------------------------------------------------------------
 /**
     @class Db::Sqlite3Table
+
+    New and modified rows are written with multi-row statements, up to
+    MaxBatchNumRows rows per statement. Modified rows are written as an
+    INSERT which updates the existing row on a primary key conflict, so
+    they share the placeholder layout of the insert.
+
+    If the database has write-behind enabled, commits copy the changed
+    values into a Sqlite3WriteBatch and return right away.
     
     @copyright
     (C) 2006 Radon Labs GmbH
     (C) 2013-2016 Individual contributors, see AUTHORS file
 */
 #include "db/table.h"
+#include "util/variant.h"
 
 //------------------------------------------------------------------------------
 namespace Db
 {
 class Command;
+struct Sqlite3WriteBatch;
 
 class Sqlite3Table : public Table
 {
@@ -58,6 +68,12 @@ private:
     void ReadTableLayout(bool ignoreUnknownColumns);
     /// build a column definition SQL fragment
     Util::String BuildColumnDef(const Column& column);
+    /// build an INSERT statement for a number of rows, optionally updating rows which exist
+    Util::String BuildInsertSql(SizeT numRows, bool updateExisting);
+    /// build the DELETE statement
+    Util::String BuildDeleteSql();
+    /// get number of rows written by a single batched statement
+    SizeT GetBatchNumRows() const;
     /// (re)compile the INSERT SQL command
     void CompileInsertCommand();
     /// (re)compile the UPDATE SQL command
@@ -70,12 +86,26 @@ private:
     void ExecuteUpdateCommand();
     /// execute the pre-compiled DELETE command for each deleted row
     void ExecuteDeleteCommand();
+    /// write rows in full batches with a multi-row INSERT, returns the number of rows written
+    SizeT ExecuteBatchedInsert(Ptr<Command>& batchCommand, bool updateExisting, const Util::Array<IndexT>& rowIndices);
     /// bind a value from the value table to a wildcard of a compiled command
     void BindValueToCommand(const Ptr<Command>& cmd, IndexT wildcardIndex, IndexT valueTableColIndex, IndexT valueTableRowIndex);
 
+    /// queue changed rows on the database's writer thread
+    void QueueChanges(bool deletedRowsOnly);
+    /// add batched INSERT statements and the values of rows to a write batch
+    void QueueRows(Sqlite3WriteBatch* batch, const Util::Array<IndexT>& rowIndices, bool updateExisting);
+    /// copy a value from the value table
+    Util::Variant GetValueAsVariant(IndexT valueTableColIndex, IndexT valueTableRowIndex) const;
+
+    /// max number of rows written by one statement
+    static const SizeT MaxBatchNumRows = 64;
+
     Ptr<Command> insertCommand;
     Ptr<Command> updateCommand;
     Ptr<Command> deleteCommand;
+    Ptr<Command> batchInsertCommand;
+    Ptr<Command> batchUpdateCommand;
 
     // static string fragments for string construction (prevents excessive string object construction)
     static const Util::String InsertIntoFrag;
@@ -94,6 +124,10 @@ private:
     static const Util::String BlobFrag;
     static const Util::String WhereFrag;
     static const Util::String DeleteFromFrag;
+    static const Util::String NextRowFrag;
+    static const Util::String OnConflictFrag;
+    static const Util::String DoUpdateSetFrag;
+    static const Util::String AssignExcludedFrag;
 };    
 
 } // namespace Db
@@ -0,0 +1,275 @@
+//------------------------------------------------------------------------------
+//  sqlite3writerthread.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "db/sqlite3/sqlite3writerthread.h"
+#include "system/byteorder.h"
+#include "profiling/profiling.h"
+
+namespace Db
+{
+__ImplementClass(Db::Sqlite3WriterThread, 'S3WT', Threading::Thread);
+
+using namespace Util;
+
+//------------------------------------------------------------------------------
+/**
+*/
+Sqlite3WriterThread::Sqlite3WriterThread() :
+    synchronous("NORMAL"),
+    busyTimeout(100),
+    sqliteHandle(nullptr),
+    numPending(0)
+{
+    this->SetName("Sqlite3 Writer Thread");
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Sqlite3WriterThread::~Sqlite3WriterThread()
+{
+    if (this->IsRunning())
+    {
+        this->Stop();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Sqlite3WriterThread::Enqueue(Sqlite3WriteBatch* batch)
+{
+    n_assert(this->IsRunning());
+    Threading::Interlocked::Increment(&this->numPending);
+    this->queue.Enqueue(batch);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Batches are written in order, so once an empty batch with a signal
+    went through, everything queued before it is on disk.
+*/
+void
+Sqlite3WriterThread::Flush()
+{
+    if (!this->HasPendingWrites())
+    {
+        return;
+    }
+    Threading::Event flushed;
+    Sqlite3WriteBatch* batch = new Sqlite3WriteBatch;
+    batch->signal = &flushed;
+    this->Enqueue(batch);
+    flushed.Wait();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Sqlite3WriterThread::EmitWakeupSignal()
+{
+    this->queue.Signal();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Sqlite3WriterThread::DoWork()
+{
+    Profiling::ProfilingRegisterThread();
+
+    int err = sqlite3_open_v2(this->path.AsCharPtr(), &this->sqliteHandle, SQLITE_OPEN_READWRITE, nullptr);
+    if (err != SQLITE_OK)
+    {
+        n_error("Sqlite3WriterThread: failed to open '%s' with error '%s'\n", this->path.AsCharPtr(), sqlite3_errmsg(this->sqliteHandle));
+        return;
+    }
+    sqlite3_busy_timeout(this->sqliteHandle, this->busyTimeout);
+    String sql;
+    sql.Format("PRAGMA synchronous=%s", this->synchronous.AsCharPtr());
+    sqlite3_exec(this->sqliteHandle, sql.AsCharPtr(), nullptr, nullptr, nullptr);
+
+    Array<Sqlite3WriteBatch*> batches;
+    while (!this->ThreadStopRequested())
+    {
+        this->queue.DequeueAll(batches);
+        if (!batches.IsEmpty())
+        {
+            this->Write(batches);
+        }
+        this->queue.Wait();
+    }
+
+    // write whatever was queued before the stop request
+    this->queue.DequeueAll(batches);
+    if (!batches.IsEmpty())
+    {
+        this->Write(batches);
+    }
+
+    IndexT i;
+    for (i = 0; i < this->statements.Size(); i++)
+    {
+        sqlite3_finalize(this->statements.ValueAtIndex(i));
+    }
+    this->statements.Clear();
+    sqlite3_close(this->sqliteHandle);
+    this->sqliteHandle = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Sqlite3WriterThread::Write(Array<Sqlite3WriteBatch*>& batches)
+{
+    N_SCOPE(Sqlite3WriteBehind, Db);
+    sqlite3_exec(this->sqliteHandle, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr);
+
+    IndexT batchIndex;
+    for (batchIndex = 0; batchIndex < batches.Size(); batchIndex++)
+    {
+        const Sqlite3WriteBatch* batch = batches[batchIndex];
+        IndexT valueIndex = 0;
+        IndexT statementIndex;
+        for (statementIndex = 0; statementIndex < batch->statements.Size(); statementIndex++)
+        {
+            const Sqlite3WriteBatch::Statement& statement = batch->statements[statementIndex];
+            sqlite3_stmt* stmt = this->GetStatement(statement.sql);
+            if (nullptr == stmt)
+            {
+                valueIndex += statement.numParams * statement.numExecutions;
+                continue;
+            }
+
+            IndexT execution;
+            for (execution = 0; execution < statement.numExecutions; execution++)
+            {
+                IndexT param;
+                for (param = 0; param < statement.numParams; param++)
+                {
+                    BindValue(stmt, param + 1, batch->values[valueIndex++]);
+                }
+
+                int result = sqlite3_step(stmt);
+                while (SQLITE_BUSY == result)
+                {
+                    n_sleep(0.0001);
+                    result = sqlite3_step(stmt);
+                }
+                if (SQLITE_DONE != result && SQLITE_ROW != result)
+                {
+                    n_warning("Sqlite3WriterThread: error '%s' in '%s'\n", sqlite3_errmsg(this->sqliteHandle), statement.sql.AsCharPtr());
+                }
+                sqlite3_reset(stmt);
+            }
+        }
+    }
+    sqlite3_exec(this->sqliteHandle, "COMMIT", nullptr, nullptr, nullptr);
+
+    for (batchIndex = 0; batchIndex < batches.Size(); batchIndex++)
+    {
+        Sqlite3WriteBatch* batch = batches[batchIndex];
+        if (nullptr != batch->signal)
+        {
+            batch->signal->Signal();
+        }
+        delete batch;
+        Threading::Interlocked::Decrement(&this->numPending);
+    }
+    batches.Reset();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+sqlite3_stmt*
+Sqlite3WriterThread::GetStatement(const String& sql)
+{
+    IndexT index = this->statements.FindIndex(sql);
+    if (InvalidIndex != index)
+    {
+        return this->statements.ValueAtIndex(index);
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    int err = sqlite3_prepare_v2(this->sqliteHandle, sql.AsCharPtr(), -1, &stmt, nullptr);
+    if (err != SQLITE_OK)
+    {
+        n_warning("Sqlite3WriterThread: failed to compile '%s' with error '%s'\n", sql.AsCharPtr(), sqlite3_errmsg(this->sqliteHandle));
+        return nullptr;
+    }
+    this->statements.Add(sql, stmt);
+    return stmt;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Binds values the same way Sqlite3Command does, so rows written behind
+    read back exactly like rows written directly.
+*/
+bool
+Sqlite3WriterThread::BindValue(sqlite3_stmt* stmt, int index, const Variant& value)
+{
+    int err = SQLITE_OK;
+    switch (value.GetType())
+    {
+        case Variant::Int:
+            err = sqlite3_bind_int(stmt, index, value.GetInt());
+            break;
+        case Variant::UInt:
+            err = sqlite3_bind_int64(stmt, index, value.GetUInt());
+            break;
+        case Variant::Int64:
+            err = sqlite3_bind_int64(stmt, index, value.GetInt64());
+            break;
+        case Variant::Float:
+            err = sqlite3_bind_double(stmt, index, (double)value.GetFloat());
+            break;
+        case Variant::Bool:
+            err = sqlite3_bind_int(stmt, index, value.GetBool() ? 1 : 0);
+            break;
+        case Variant::Vec4:
+            {
+                System::ByteOrder byteOrder(System::ByteOrder::LittleEndian, System::ByteOrder::Host);
+                Math::vec4 converted = value.GetVec4();
+                byteOrder.ConvertInPlace<Math::vec4>(converted);
+                err = sqlite3_bind_blob(stmt, index, &converted, sizeof(converted), SQLITE_TRANSIENT);
+            }
+            break;
+        case Variant::Mat4:
+            err = sqlite3_bind_blob(stmt, index, &value.GetMat4(), sizeof(Math::mat4), SQLITE_TRANSIENT);
+            break;
+        case Variant::String:
+            err = sqlite3_bind_text(stmt, index, value.GetString().AsCharPtr(), -1, SQLITE_TRANSIENT);
+            break;
+        case Variant::Blob:
+            if (value.GetBlob().IsValid())
+            {
+                err = sqlite3_bind_blob(stmt, index, value.GetBlob().GetPtr(), (int)value.GetBlob().Size(), SQLITE_TRANSIENT);
+            }
+            else
+            {
+                err = sqlite3_bind_null(stmt, index);
+            }
+            break;
+        case Variant::Guid:
+            {
+                const unsigned char* ptr = nullptr;
+                SizeT size = value.GetGuid().AsBinary(ptr);
+                err = sqlite3_bind_blob(stmt, index, ptr, size, SQLITE_TRANSIENT);
+            }
+            break;
+        default:
+            n_error("Sqlite3WriterThread::BindValue(): invalid value type!");
+            break;
+    }
+    return SQLITE_OK == err;
+}
+
+} // namespace Db
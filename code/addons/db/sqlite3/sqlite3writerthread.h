@@ -0,0 +1,133 @@
+#pragma once
+#ifndef DB_SQLITE3WRITERTHREAD_H
+#define DB_SQLITE3WRITERTHREAD_H
+//------------------------------------------------------------------------------
+/**
+    @class Db::Sqlite3WriterThread
+
+    Write-behind thread of a Sqlite3Database. Tables hand over their changes
+    as batches of SQL statements with the values already copied out of the
+    value table, the thread writes them through its own connection to the
+    database file. Everything which is queued when the thread wakes up is
+    written in a single transaction, so frequent small commits only cost
+    one sync to disk.
+
+    The thread has its own connection, so it only works for databases
+    on disk, and the database should use WAL journaling so the main
+    connection can keep reading while the thread writes.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "threading/thread.h"
+#include "threading/safequeue.h"
+#include "threading/event.h"
+#include "threading/interlocked.h"
+#include "util/variant.h"
+#include "util/dictionary.h"
+#include "sqlite3.h"
+
+//------------------------------------------------------------------------------
+namespace Db
+{
+
+/// a batch of statements to write, with the values of every execution
+struct Sqlite3WriteBatch
+{
+    struct Statement
+    {
+        Util::String sql;
+        SizeT numParams;        // values bound per execution
+        SizeT numExecutions;
+    };
+    Util::Array<Statement> statements;
+    Util::Array<Util::Variant> values;
+    Threading::Event* signal = nullptr;
+};
+
+class Sqlite3WriterThread : public Threading::Thread
+{
+    __DeclareClass(Sqlite3WriterThread);
+public:
+    /// constructor
+    Sqlite3WriterThread();
+    /// destructor
+    virtual ~Sqlite3WriterThread();
+
+    /// set native path of the database file, call before Start()
+    void SetDatabasePath(const Util::String& path);
+    /// set synchronous pragma value for the connection, call before Start()
+    void SetSynchronous(const Util::String& level);
+    /// set busy timeout in milliseconds, call before Start()
+    void SetBusyTimeout(int ms);
+
+    /// queue a batch for writing, the thread takes ownership
+    void Enqueue(Sqlite3WriteBatch* batch);
+    /// block until everything queued so far is written
+    void Flush();
+    /// return true if there are batches which haven't been written yet
+    bool HasPendingWrites() const;
+
+private:
+    /// perform work
+    void DoWork() override;
+    /// emit wakeup signal
+    void EmitWakeupSignal() override;
+    /// write batches in one transaction and free them
+    void Write(Util::Array<Sqlite3WriteBatch*>& batches);
+    /// get a prepared statement for an SQL string
+    sqlite3_stmt* GetStatement(const Util::String& sql);
+    /// bind a value to a statement
+    static bool BindValue(sqlite3_stmt* stmt, int index, const Util::Variant& value);
+
+    Util::String path;
+    Util::String synchronous;
+    int busyTimeout;
+    sqlite3* sqliteHandle;
+    Util::Dictionary<Util::String, sqlite3_stmt*> statements;
+    Threading::SafeQueue<Sqlite3WriteBatch*> queue;
+    Threading::AtomicCounter numPending;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Sqlite3WriterThread::SetDatabasePath(const Util::String& p)
+{
+    n_assert(!this->IsRunning());
+    this->path = p;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Sqlite3WriterThread::SetSynchronous(const Util::String& level)
+{
+    n_assert(!this->IsRunning());
+    this->synchronous = level;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Sqlite3WriterThread::SetBusyTimeout(int ms)
+{
+    n_assert(!this->IsRunning());
+    this->busyTimeout = ms;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+Sqlite3WriterThread::HasPendingWrites() const
+{
+    return Threading::Interlocked::CompareExchange(const_cast<Threading::AtomicCounter*>(&this->numPending), 0, 0) != 0;
+}
+
+} // namespace Db
+//------------------------------------------------------------------------------
+#endif
@@ -55,6 +55,7 @@ RegisterModelEntity(
     Resources::ResourceName const skeleton,
     uint const stage,
     bool const raytracing,
+    bool const isStatic,
     Math::mat4 const& t
 )
 {
@@ -63,7 +64,7 @@ RegisterModelEntity(
         gid,
         res,
         "NONE",
-        [gid, anim, skeleton, raytracing, t]()
+        [gid, anim, skeleton, raytracing, isStatic, t]()
         {
             if (!Graphics::GraphicsServer::Instance()->IsValidGraphicsEntity(gid))
                 return;
@@ -73,7 +74,7 @@ RegisterModelEntity(
             if (raytracing && CoreGraphics::RayTracingSupported)
             {
                 Raytracing::RaytracingContext::RegisterEntity(gid);
-                Raytracing::RaytracingContext::SetupModel(gid, CoreGraphics::BlasInstanceFlags::NoFlags, 0xFF);
+                Raytracing::RaytracingContext::SetupModel(gid, CoreGraphics::BlasInstanceFlags::NoFlags, 0xFF, isStatic ? Raytracing::UpdateType::Static : Raytracing::UpdateType::Dynamic);
             }
             if (anim.IsValid() && skeleton.IsValid())
             {
@@ -570,7 +571,7 @@ GraphicsManager::InitModel(Game::World* world, Game::Entity entity, Model* model
     Game::Scale scale = world->GetComponent<Game::Scale>(entity);
     Math::mat4 worldTransform = Math::trs(pos, orient, scale);
     RegisterModelEntity(
-        model->graphicsEntityId, model->resource, model->anim, model->skeleton, model->stages.GetBits(0), model->raytracing, worldTransform
+        model->graphicsEntityId, model->resource, model->anim, model->skeleton, model->stages.GetBits(0), model->raytracing, world->HasComponent<Game::Static>(entity), worldTransform
     );
 }
 
@@ -14,7 +14,7 @@
 #include "util/fixedarray.h"
 #include "util/string.h"
 #include "util/stringatom.h"
-#include "util/hashtable.h"
+#include "util/flathashtable.h"
 #include "attributeid.h"
 #include "tablesignature.h"
 #include "util/bitfield.h"
@@ -179,7 +179,7 @@ private:
     /// all attributes that this table has
     Util::Array<AttributeId> attributes;
     /// maps attr id -> index in columns array
-    Util::HashTable<AttributeId, IndexT, 32, 1> columnRegistry;
+    Util::FlatHashTable<AttributeId, IndexT> columnRegistry;
 };
 
 //------------------------------------------------------------------------------
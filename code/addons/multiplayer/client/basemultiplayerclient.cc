@@ -7,8 +7,6 @@
 #include "basegamefeature/managers/timemanager.h"
 #include "components/multiplayer.h"
 #include "core/debug.h"
-#include "GameNetworkingSockets/steam/steamnetworkingsockets.h"
-#include "GameNetworkingSockets/steam/isteamnetworkingutils.h"
 #include "game/api.h"
 #include "game/world.h"
 #include "imgui.h"
@@ -18,31 +16,22 @@
 #include "flat/addons/multiplayer/standardprotocol.h"
 #include "multiplayer/multiplayerfeatureunit.h"
 #include "net/socket/ipaddress.h"
-#include "steam/steamnetworkingtypes.h"
-#include "components/multiplayer.h"
+#include "multiplayer/transport/steamtransport.h"
 
 namespace Multiplayer
 {
 
 using namespace Util;
 
-//--------------------------------------------------------------------------
-/**
-*/
-// HACK: should probably be a singleton
-static BaseMultiplayerClient* callbackInstance = nullptr;
-static void
-SteamNetConnectionStatusChangedCallback(SteamNetConnectionStatusChangedCallback_t* info)
-{
-    callbackInstance->OnNetConnectionStatusChanged(info);
-}
-
 //------------------------------------------------------------------------------
 /**
 */
 BaseMultiplayerClient::BaseMultiplayerClient()
     : hostIp(N_IP_ADDR(127, 0, 0, 1)),
-    isOpen(false)
+    ping(0.0),
+    isOpen(false),
+    transport(nullptr),
+    ownsTransport(false)
 {
     // empty
 }
@@ -53,6 +42,21 @@ BaseMultiplayerClient::BaseMultiplayerClient()
 BaseMultiplayerClient::~BaseMultiplayerClient()
 {
     n_assert(!this->IsOpen());
+    if (this->ownsTransport)
+        delete this->transport;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BaseMultiplayerClient::SetTransport(Transport* transport)
+{
+    n_assert(!this->isOpen);
+    if (this->ownsTransport)
+        delete this->transport;
+    this->transport = transport;
+    this->ownsTransport = false;
 }
 
 //------------------------------------------------------------------------------
@@ -62,10 +66,13 @@ bool
 BaseMultiplayerClient::Open()
 {
     n_assert(!this->isOpen);
-    this->netInterface = SteamNetworkingSockets();
-    if (this->netInterface == nullptr)
+    if (this->transport == nullptr)
+    {
+        this->transport = new SteamTransport();
+        this->ownsTransport = true;
+    }
+    if (!this->transport->Open())
     {
-        n_error("Failed to initialize SteamNetworkingSockets!\n");
         return false;
     }
     this->isOpen = true;
@@ -81,14 +88,20 @@ BaseMultiplayerClient::Close()
 {
     n_assert(this->isOpen);
 
-    ShutdownClientProcessors();
     const char* reason = nullptr;
 #if NEBULA_DEBUG
     reason = "Client closed the connection willingly.";
 #endif
 
     n_printf("Closing!\n");
-    this->netInterface->CloseConnection(this->connectionId, 0, reason, true);
+    if (this->connectionId != InvalidConnectionId)
+    {
+        this->transport->CloseConnection(this->connectionId, 0, reason, true);
+        this->connectionId = InvalidConnectionId;
+    }
+    this->transport->Flush();
+    this->transport->Close();
+    this->connectionStatus = ConnectionStatus::Disconnected;
     this->isOpen = false;
 }
 
@@ -98,17 +111,8 @@ BaseMultiplayerClient::Close()
 void
 BaseMultiplayerClient::Send(void* buf, int size)
 {
-    ISteamNetworkingMessage** netMsgs = new ISteamNetworkingMessage*[1];
-    netMsgs[0] = SteamNetworkingUtils()->AllocateMessage(size);
-        
-    // TODO: Can we construct this inplace in the steamnetworkingmessage?
-    Memory::Copy(buf, netMsgs[0]->m_pData, size);
-
-    netMsgs[0]->m_conn = this->connectionId;
-    netMsgs[0]->m_nFlags = 0; 
-    
-    int64* outMessageNumberOrResult = nullptr;
-    this->netInterface->SendMessages(1, netMsgs, outMessageNumberOrResult);
+    this->transport->Send(this->connectionId, buf, size, false);
+    this->transport->Flush();
 }
 
 //--------------------------------------------------------------------------
@@ -131,23 +135,11 @@ BaseMultiplayerClient::TryConnect()
     
     const int NEBULA_DEFAULT_PORT = 61111;
 
-    SteamNetworkingIPAddr serverAddr;
-    serverAddr.Clear();
     // TODO: Implement support for casting ip to uint32_t address and uint16_t port
     //Net::IpAddress ipAddress = Net::IpAddress();
-    serverAddr.SetIPv4(this->hostIp, NEBULA_DEFAULT_PORT);
-
-    // Start connecting
-    char address[SteamNetworkingIPAddr::k_cchMaxString];
-    serverAddr.ToString(address, sizeof(address), true);
-    n_printf("Trying to connect to server at %s...\n", address);
+    this->connectionId = this->transport->Connect(this->hostIp, NEBULA_DEFAULT_PORT);
     
-    SteamNetworkingConfigValue_t opt;
-    opt.SetPtr(k_ESteamNetworkingConfig_Callback_ConnectionStatusChanged, (void*)SteamNetConnectionStatusChangedCallback);
-
-    this->connectionId = this->netInterface->ConnectByIPAddress(serverAddr, 1, &opt);
-    
-    if (this->connectionId == k_HSteamNetConnection_Invalid)
+    if (this->connectionId == InvalidConnectionId)
     {
         n_printf("Failed to connect by IP. (Invalid ip address or port?)\n");
         this->timeoutTimer.Reset();
@@ -193,7 +185,7 @@ BaseMultiplayerClient::OnDisconnected()
 /**
 */
 void
-BaseMultiplayerClient::OnMessageReceived(SteamNetworkingMessage_t* msg)
+BaseMultiplayerClient::OnMessageReceived(Timing::Time recvTime, byte* data, size_t size)
 {
     // Override in subclass
 }
@@ -211,33 +203,33 @@ BaseMultiplayerClient::GetConnectionStatus() const
 /**
 */
 void
-BaseMultiplayerClient::OnNetConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info)
+BaseMultiplayerClient::OnNetConnectionStatusChanged(TransportStatusChange const& info)
 {
     // What's the state of the connection?
-    switch ( info->m_info.m_eState )
+    switch (info.state)
     {
-        case k_ESteamNetworkingConnectionState_None:
+        case TransportConnectionState::None:
             // NOTE: We will get callbacks here when we destroy connections. We can ignore these for now.
             break;
 
-        case k_ESteamNetworkingConnectionState_ClosedByPeer:
-        case k_ESteamNetworkingConnectionState_ProblemDetectedLocally:
+        case TransportConnectionState::ClosedByPeer:
+        case TransportConnectionState::ProblemDetectedLocally:
         {
             // Print an appropriate message
-            if ( info->m_eOldState == k_ESteamNetworkingConnectionState_Connecting )
+            if (info.oldState == TransportConnectionState::Connecting)
             {
                 // Note: we could distinguish between a timeout, a rejected connection,
                 // or some other transport problem.
-                n_printf("%s\n", info->m_info.m_szEndDebug);
+                n_printf("%s\n", info.endDebug.AsCharPtr());
             }
-            else if (info->m_info.m_eState == k_ESteamNetworkingConnectionState_ProblemDetectedLocally)
+            else if (info.state == TransportConnectionState::ProblemDetectedLocally)
             {
-                n_printf("Lost connection with server (%s)\n", info->m_info.m_szEndDebug);
+                n_printf("Lost connection with server (%s)\n", info.endDebug.AsCharPtr());
             }
             else
             {
                 // NOTE: We could check the reason code for a normal disconnection
-                n_printf("Disconnected by host (%s)", info->m_info.m_szEndDebug);
+                n_printf("Disconnected by host (%s)", info.endDebug.AsCharPtr());
             }
 
             this->OnDisconnected();
@@ -248,10 +240,10 @@ BaseMultiplayerClient::OnNetConnectionStatusChanged(SteamNetConnectionStatusChan
             // to finish up.  The reason information do not matter in this case,
             // and we cannot linger because it's already closed on the other end,
             // so we just pass 0's.
-            this->netInterface->CloseConnection(info->m_hConn, 0, nullptr, false);
-            if (this->connectionId == info->m_hConn)
+            this->transport->CloseConnection(info.connection, 0, nullptr, false);
+            if (this->connectionId == info.connection)
             {
-                this->connectionId = k_HSteamNetConnection_Invalid;
+                this->connectionId = InvalidConnectionId;
                 this->connectionStatus = ConnectionStatus::Disconnected;
                 this->timeoutTimer.Reset();
                 if (!this->timeoutTimer.Running())
@@ -262,14 +254,14 @@ BaseMultiplayerClient::OnNetConnectionStatusChanged(SteamNetConnectionStatusChan
             break;
         }
 
-        case k_ESteamNetworkingConnectionState_Connecting:
+        case TransportConnectionState::Connecting:
             // We will get this callback when we start connecting.
             this->connectionStatus = ConnectionStatus::TryingToConnect;
-            this->connectionId = info->m_hConn;
+            this->connectionId = info.connection;
             this->OnIsConnecting();
             break;
 
-        case k_ESteamNetworkingConnectionState_Connected:
+        case TransportConnectionState::Connected:
             this->connectionStatus = ConnectionStatus::Connected;
             this->OnConnected();
             n_printf("Connected to server successfully!\n");
@@ -291,15 +283,14 @@ BaseMultiplayerClient::SyncAll()
     if (this->connectionStatus != ConnectionStatus::Connected)
         return;
 
-    SteamNetConnectionRealTimeStatus_t status;
-    EResult res = this->netInterface->GetConnectionRealTimeStatus(this->connectionId, &status, 0, nullptr);
-    if (res == k_EResultNoConnection)
+    TransportConnectionStats stats;
+    if (!this->transport->GetConnectionStats(this->connectionId, stats))
     {
         this->ping = 0.0;
     }
     else
     {
-        this->ping = (double)status.m_nPing / 1000.0;
+        this->ping = (double)stats.pingMs / 1000.0;
     }
 
     this->PollIncomingMessages();
@@ -314,25 +305,24 @@ BaseMultiplayerClient::DrawNetworkDebugInfo()
 {
     ImGui::Text("Client");
     ImGui::Text("Status: %i", (int)this->connectionStatus);
-    if (this->connectionStatus != ConnectionStatus::Connected || this->connectionId == k_HSteamNetConnection_Invalid)
+    if (this->connectionStatus != ConnectionStatus::Connected || this->connectionId == InvalidConnectionId)
         return;
 
-    SteamNetConnectionRealTimeStatus_t status;
-    EResult res = this->netInterface->GetConnectionRealTimeStatus(this->connectionId, &status, 0, nullptr);
-    if (res != k_EResultOK)
+    TransportConnectionStats stats;
+    if (!this->transport->GetConnectionStats(this->connectionId, stats))
     {
-        ImGui::Text("Connection status unavailable: %i", (int)res);
+        ImGui::Text("Connection status unavailable");
         return;
     }
 
-    ImGui::Text("Ping: %i ms", status.m_nPing);
-    ImGui::Text("Out: %.1f KB/s (%.1f pkt/s)", status.m_flOutBytesPerSec / 1024.0f, status.m_flOutPacketsPerSec);
-    ImGui::Text("In:  %.1f KB/s (%.1f pkt/s)", status.m_flInBytesPerSec / 1024.0f, status.m_flInPacketsPerSec);
-    ImGui::Text("Send capacity: %.1f KB/s", (float)status.m_nSendRateBytesPerSecond / 1024.0f);
-    ImGui::Text("Pending: reliable=%i B unreliable=%i B", status.m_cbPendingReliable, status.m_cbPendingUnreliable);
-    ImGui::Text("Unacked reliable: %i B", status.m_cbSentUnackedReliable);
-    ImGui::Text("Queue time: %.2f ms", (double)status.m_usecQueueTime / 1000.0);
-    ImGui::Text("Quality: local=%.2f remote=%.2f", status.m_flConnectionQualityLocal, status.m_flConnectionQualityRemote);
+    ImGui::Text("Ping: %i ms", stats.pingMs);
+    ImGui::Text("Out: %.1f KB/s (%.1f pkt/s)", stats.outBytesPerSec / 1024.0f, stats.outPacketsPerSec);
+    ImGui::Text("In:  %.1f KB/s (%.1f pkt/s)", stats.inBytesPerSec / 1024.0f, stats.inPacketsPerSec);
+    ImGui::Text("Send capacity: %.1f KB/s", (float)stats.sendRateBytesPerSec / 1024.0f);
+    ImGui::Text("Pending: reliable=%i B unreliable=%i B", stats.pendingReliable, stats.pendingUnreliable);
+    ImGui::Text("Unacked reliable: %i B", stats.sentUnackedReliable);
+    ImGui::Text("Queue time: %.2f ms", stats.queueTime * 1000.0);
+    ImGui::Text("Quality: local=%.2f remote=%.2f", stats.qualityLocal, stats.qualityRemote);
 }
 
 //--------------------------------------------------------------------------
@@ -341,8 +331,8 @@ BaseMultiplayerClient::DrawNetworkDebugInfo()
 void
 BaseMultiplayerClient::PollIncomingMessages()
 {
-    ISteamNetworkingMessage* incomingMsg[MaxMessagesPerFrame];
-    int numMsgs = this->netInterface->ReceiveMessagesOnConnection(this->connectionId, incomingMsg, MaxMessagesPerFrame);
+    this->incomingMessages.Resize(MaxMessagesPerFrame);
+    int numMsgs = this->transport->ReceiveMessagesOnConnection(this->connectionId, this->incomingMessages.Begin(), MaxMessagesPerFrame);
     if (numMsgs == 0)
     {
         return;
@@ -355,17 +345,13 @@ BaseMultiplayerClient::PollIncomingMessages()
     n_assert(numMsgs <= MaxMessagesPerFrame);
     for (int i = 0; i < numMsgs; i++)
     {
-        n_assert(incomingMsg[i] != nullptr);
-        void* data = incomingMsg[i]->m_pData;
-        int bytes = incomingMsg[i]->m_cbSize;
-        double recvTime = incomingMsg[i]->m_usecTimeReceived;
-        if (data != nullptr && bytes > 0)
+        TransportMessage const& msg = this->incomingMessages[i];
+        if (msg.data != nullptr && msg.size > 0)
         {
-            this->OnMessageReceived(incomingMsg[i]);
-            incomingMsg[i]->Release();
-            incomingMsg[i] = nullptr;
+            this->OnMessageReceived(msg.receiveTime, (byte*)msg.data, msg.size);
         }
     }
+    this->transport->ReleaseMessages(this->incomingMessages.Begin(), numMsgs);
 }
 
 //--------------------------------------------------------------------------
@@ -374,8 +360,10 @@ BaseMultiplayerClient::PollIncomingMessages()
 void
 BaseMultiplayerClient::PollConnectionChanges()
 {
-    callbackInstance = this;
-    this->netInterface->RunCallbacks();
+    this->transport->RunCallbacks([this](TransportStatusChange const& info)
+    {
+        this->OnNetConnectionStatusChanged(info);
+    });
 }
 
 //--------------------------------------------------------------------------
@@ -6,10 +6,9 @@
     @copyright
     (C) 2025 Individual contributors, see AUTHORS file
 */
-#include "GameNetworkingSockets/steam/steamnetworkingtypes.h"
 #include "timing/timer.h"
-
-class ISteamNetworkingSockets;
+#include "util/array.h"
+#include "multiplayer/transport/transport.h"
 
 //------------------------------------------------------------------------------
 namespace Multiplayer
@@ -35,6 +34,10 @@ public:
     virtual void Close();
     /// return true if client is open
     bool IsOpen() const;
+    /// set the transport before opening the client, a GameNetworkingSockets transport is used if none is set
+    void SetTransport(Transport* transport);
+    /// get the transport
+    Transport* GetTransport() const;
     ///
     void Send(void* buf, int size);
 
@@ -45,7 +48,7 @@ public:
     virtual void OnIsConnecting();
     virtual void OnConnected();
     virtual void OnDisconnected();
-    virtual void OnMessageReceived(SteamNetworkingMessage_t* msg);
+    virtual void OnMessageReceived(Timing::Time recvTime, byte* data, size_t size);
 
     /// Gets the estimated current packet roundtrip time (client->server->client).
     Timing::Time GetCurrentPing() const;
@@ -57,7 +60,7 @@ public:
 
     void SyncAll();
 
-    void OnNetConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info);
+    void OnNetConnectionStatusChanged(TransportStatusChange const& info);
     
     constexpr static SizeT MaxMessagesPerFrame = 1024;
 
@@ -75,8 +78,10 @@ protected:
     Timing::Timer timeoutTimer;
 
     ConnectionStatus connectionStatus = ConnectionStatus::Disconnected;
-    HSteamNetConnection connectionId = k_HSteamNetConnection_Invalid;
-	ISteamNetworkingSockets* netInterface;
+    ConnectionId connectionId = InvalidConnectionId;
+    Transport* transport;
+    bool ownsTransport;
+    Util::Array<TransportMessage> incomingMessages;
 };
 
 //------------------------------------------------------------------------------
@@ -88,6 +93,15 @@ BaseMultiplayerClient::IsOpen() const
     return this->isOpen;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline Transport*
+BaseMultiplayerClient::GetTransport() const
+{
+    return this->transport;
+}
+
 //--------------------------------------------------------------------------
 /**
 */
@@ -14,9 +14,6 @@
 #include "nflatbuffer/nebula_flat.h"
 #include "nflatbuffer/flatbufferinterface.h"
 #include "flat/addons/multiplayer/standardprotocol.h"
-#include "steam/isteamnetworkingutils.h"
-#include "steam/steamnetworkingtypes.h"
-#include "steam/isteamnetworkingsockets.h"
 
 namespace Multiplayer
 {
@@ -56,7 +53,8 @@ StandardMultiplayerClient::OnIsConnecting()
 void
 StandardMultiplayerClient::OnConnected()
 {
-
+    // the server starts over with full snapshots for a new connection
+    this->snapshotReceiver.Reset();
 }
 
 //--------------------------------------------------------------------------
@@ -107,11 +105,8 @@ UnpackEntity(Game::World* world, Util::Blob const& data)
 /**
 */
 void
-StandardMultiplayerClient::OnMessageReceived(SteamNetworkingMessage_t* msg)
+StandardMultiplayerClient::OnMessageReceived(Timing::Time recvTime, byte* data, size_t size)
 {
-    void const* data = msg->GetData();
-    size_t size = msg->GetSize();
-    
     Game::World* world = Game::GetWorld(WORLD_DEFAULT);
     Game::TimeSource const* const timeSource = Game::Time::GetTimeSource(TIMESOURCE_GAMEPLAY);
 
@@ -139,6 +134,11 @@ StandardMultiplayerClient::OnMessageReceived(SteamNetworkingMessage_t* msg)
             world->SetComponent<NetworkTransform>(entity, netTransform);
             break;
         }
+        case StandardProtocol::MessageData::MessageData_Snapshot:
+        {
+            this->OnSnapshotReceived(protocolMessage->data_as_Snapshot());
+            break;
+        }
         case StandardProtocol::MessageData::MessageData_ReplicateObject:
         {
             n_printf("Got message: ReplicateObject\n");
@@ -158,4 +158,61 @@ StandardMultiplayerClient::OnMessageReceived(SteamNetworkingMessage_t* msg)
     }
 }
 
+//--------------------------------------------------------------------------
+/**
+    Entity states are applied as soon as their fragment arrives. The snapshot
+    is acknowledged once it is complete, so the server can use it as the
+    baseline for the next delta.
+
+    Removal records mean the entity left the client's interest (or was
+    destroyed), the entity is kept and simply stops receiving updates until
+    it becomes relevant again.
+*/
+void
+StandardMultiplayerClient::OnSnapshotReceived(StandardProtocol::MsgSnapshot const* msg)
+{
+    Game::World* world = Game::GetWorld(WORLD_DEFAULT);
+    Game::TimeSource const* const timeSource = Game::Time::GetTimeSource(TIMESOURCE_GAMEPLAY);
+
+    this->changedEntities.Clear();
+    this->removedEntities.Clear();
+    SnapshotReceiver::Result result = this->snapshotReceiver.ReceiveFragment(
+        msg->sequence(),
+        msg->baseline(),
+        msg->fragment(),
+        msg->num_fragments(),
+        msg->payload()->data(),
+        msg->payload()->size(),
+        this->changedEntities,
+        this->removedEntities
+    );
+    if (result == SnapshotReceiver::Rejected)
+        return;
+
+    for (SnapshotEntity const& state : this->changedEntities)
+    {
+        IndexT hashIndex = this->networkEntities.FindIndex(state.networkId);
+        if (hashIndex == InvalidIndex)
+            continue;
+
+        Game::Entity entity = this->networkEntities.ValueAtIndex(state.networkId, hashIndex);
+        NetworkTransform netTransform = world->GetComponent<NetworkTransform>(entity);
+        if (msg->sequence() > netTransform.tickNumber)
+        {
+            netTransform.tickNumber = msg->sequence();
+            netTransform.positionExtrapolator.AddSample(timeSource->time - (this->GetCurrentPing() / 2.0), timeSource->time, state.GetPosition(), state.GetVelocity());
+            world->SetComponent<NetworkTransform>(entity, netTransform);
+        }
+    }
+
+    if (result == SnapshotReceiver::Complete)
+    {
+        flatbuffers::FlatBufferBuilder builder(64);
+        auto ack = StandardProtocol::CreateMsgSnapshotAck(builder, msg->sequence());
+        auto message = StandardProtocol::CreateMessage(builder, StandardProtocol::MessageData_SnapshotAck, ack.Union());
+        builder.Finish(message);
+        this->Send(builder.GetBufferPointer(), builder.GetSize());
+    }
+}
+
 } // namespace Multiplayer
\ No newline at end of file
@@ -9,10 +9,12 @@
 //------------------------------------------------------------------------------
 #include "multiplayer/client/basemultiplayerclient.h"
 #include "game/entity.h"
+#include "multiplayer/snapshot.h"
 
 
 namespace Multiplayer
 {
+namespace StandardProtocol { struct MsgSnapshot; }
 
 class StandardMultiplayerClient : public BaseMultiplayerClient
 {
@@ -25,10 +27,16 @@ public:
     void OnIsConnecting() override;
     void OnConnected() override;
     void OnDisconnected() override;
-    void OnMessageReceived(SteamNetworkingMessage_t* msg) override;
+    void OnMessageReceived(Timing::Time recvTime, byte* data, size_t size) override;
 
 private:
+    /// apply a received snapshot fragment to the network entities
+    void OnSnapshotReceived(StandardProtocol::MsgSnapshot const* msg);
+
     Util::HashTable<uint, Game::Entity> networkEntities;
+    SnapshotReceiver snapshotReceiver;
+    Util::Array<SnapshotEntity> changedEntities;
+    Util::Array<uint32_t> removedEntities;
 };
     
 } // namespace Multiplayer
\ No newline at end of file
@@ -6,7 +6,6 @@
 #include "basemultiplayerserver.h"
 #include "components/multiplayer.h"
 #include "core/debug.h"
-#include "GameNetworkingSockets/steam/steamnetworkingsockets.h"
 #include "game/api.h"
 #include "game/filter.h"
 #include "game/world.h"
@@ -17,8 +16,8 @@
 #include "flatbuffers/buffer.h"
 #include "flatbuffers/flatbuffer_builder.h"
 #include "imgui.h"
-#include "steam/isteamnetworkingutils.h"
 #include "multiplayer/multiplayerfeatureunit.h"
+#include "multiplayer/transport/steamtransport.h"
 #include "serverprocessors.h"
 
 namespace Multiplayer
@@ -26,26 +25,18 @@ namespace Multiplayer
 
 using namespace Util;
 
-//--------------------------------------------------------------------------
-/**
-*/
-// HACK: MP server should probably be a singleton
-static BaseMultiplayerServer* callbackServerInstance = nullptr;
-static void
-SvSteamNetConnectionStatusChangedCallback(SteamNetConnectionStatusChangedCallback_t* info)
-{
-    callbackServerInstance->OnNetConnectionStatusChanged(info);
-}
-
 //------------------------------------------------------------------------------
 /**
 */
 BaseMultiplayerServer::BaseMultiplayerServer()
     : isOpen(false),
+    transport(nullptr),
+    ownsTransport(false),
     tickInterval(NEBULA_DEFAULT_TICK_RATE)
 {
     for (int i = 0; i < (int)ClientGroup::NumClientGroups; i++)
     {
+        this->pollGroups[i] = InvalidPollGroupId;
         this->pollGroupIntervals[i] = 1.0/60.0;
         this->pollGroupTimers[i].Start();
     }
@@ -57,6 +48,31 @@ BaseMultiplayerServer::BaseMultiplayerServer()
 BaseMultiplayerServer::~BaseMultiplayerServer()
 {
     n_assert(!this->IsOpen());
+    if (this->ownsTransport)
+        delete this->transport;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BaseMultiplayerServer::SetTransport(Transport* transport)
+{
+    n_assert(!this->isOpen);
+    if (this->ownsTransport)
+        delete this->transport;
+    this->transport = transport;
+    this->ownsTransport = false;
+}
+
+//--------------------------------------------------------------------------
+/**
+*/
+void
+BaseMultiplayerServer::SetClientGroupPollInterval(ClientGroup group, Timing::Time interval)
+{
+    n_assert(group < ClientGroup::NumClientGroups);
+    this->pollGroupIntervals[(int)group] = interval;
 }
 
 //------------------------------------------------------------------------------
@@ -69,39 +85,34 @@ BaseMultiplayerServer::Open()
     n_assert(this->clientConnections.IsEmpty());
 
     const int NEBULA_DEFAULT_PORT = 61111;
-    this->netInterface = SteamNetworkingSockets();
+    if (this->transport == nullptr)
+    {
+        this->transport = new SteamTransport();
+        this->ownsTransport = true;
+    }
 
-    if (this->netInterface == nullptr)
+    if (!this->transport->Open())
     {
-        n_error("Failed to initialize SteamNetworkingSockets!\n");
         return false;
     }
 
-    SteamNetworkingIPAddr serverLocalAddr;
-    serverLocalAddr.Clear();
-    serverLocalAddr.m_port = NEBULA_DEFAULT_PORT;
-    
-    SteamNetworkingConfigValue_t opt;
-    // setup callback for changes in connections
-    opt.SetPtr(k_ESteamNetworkingConfig_Callback_ConnectionStatusChanged, (void*)SvSteamNetConnectionStatusChangedCallback);
-    
-    this->listenSock = this->netInterface->CreateListenSocketIP(serverLocalAddr, 1, &opt);
-    if (this->listenSock == k_HSteamListenSocket_Invalid)
+    if (!this->transport->Listen(NEBULA_DEFAULT_PORT))
     {
-        n_error("Failed to listen on port %d\n", serverLocalAddr.m_port);
+        n_error("Failed to listen on port %d\n", NEBULA_DEFAULT_PORT);
+        this->transport->Close();
         return false;
     }
 
     for (int i = 0; i < (int)ClientGroup::NumClientGroups; i++)
     {
-        this->pollGroups[i] = this->netInterface->CreatePollGroup();
-        if (this->pollGroups[i] == k_HSteamNetPollGroup_Invalid)
+        this->pollGroups[i] = this->transport->CreatePollGroup();
+        if (this->pollGroups[i] == InvalidPollGroupId)
         {
-            n_error("Failed to listen on port %d\n", serverLocalAddr.m_port);
+            n_error("Failed to create poll group %d\n", i);
             return false;
         }
     }   
-    n_printf("MultiplayerServer listening on port %d\n", serverLocalAddr.m_port);
+    n_printf("MultiplayerServer listening on port %d\n", NEBULA_DEFAULT_PORT);
     
     this->tickTimer.Start();
     this->isOpen = true;
@@ -116,22 +127,30 @@ BaseMultiplayerServer::Close()
 {
     n_assert(this->isOpen);
     // disconnect client connections
-    IndexT clientIndex;
-    for (clientIndex = 0; clientIndex < this->clientConnections.Size(); clientIndex++)
+    auto it = this->clientConnections.Begin();
+    while (it != this->clientConnections.End())
+    {
+        (*(it.val))->Shutdown();
+        it++;
+    }
+    it = this->clientConnections.Begin();
+    while (it != this->clientConnections.End())
     {
-        ClientConnection* curConnection = this->clientConnections[clientIndex];
-        curConnection->Shutdown();
+        delete *(it.val);
+        it++;
     }
     this->clientConnections.Clear();
 
-    this->netInterface->CloseListenSocket(this->listenSock);
-    this->listenSock = k_HSteamListenSocket_Invalid;
+    // hand the goodbyes to the network before the transport goes away
+    this->transport->Flush();
+    this->transport->StopListening();
 
     for (int i = 0; i < (int)ClientGroup::NumClientGroups; i++)
     {
-        this->netInterface->DestroyPollGroup(this->pollGroups[i]);
-        this->pollGroups[i] = k_HSteamNetPollGroup_Invalid;
+        this->transport->DestroyPollGroup(this->pollGroups[i]);
+        this->pollGroups[i] = InvalidPollGroupId;
     }
+    this->transport->Close();
     this->isOpen = false;
 }
 
@@ -151,33 +170,201 @@ BaseMultiplayerServer::AddClientConnection(ClientConnection* conn)
 void
 BaseMultiplayerServer::Broadcast(void* buf, int size)
 {
-    const int numClients = this->clientConnections.Size();
-    if (numClients == 0)
+    if (this->clientConnections.IsEmpty())
         return;
 
-    ISteamNetworkingMessage** netMsgs = new ISteamNetworkingMessage*[numClients];
-    int i;
-    for (i = 0; i < numClients; i++)
+    auto it = this->clientConnections.Begin();
+    while (it != this->clientConnections.End())
     {
-        netMsgs[i] = SteamNetworkingUtils()->AllocateMessage(size);
+        // HACK: Unreliable for now
+        this->transport->Send((*(it.val))->GetConnectionId(), buf, size, false);
+        it++;
     }
-        
+    this->transport->Flush();
+}
+
+//--------------------------------------------------------------------------
+/**
+*/
+void
+BaseMultiplayerServer::BeginSnapshot()
+{
+    this->currentSnapshot.sequence = ++this->snapshotSequence;
+    this->currentSnapshot.entities.Clear();
+    this->snapshotPending = true;
+}
+
+//--------------------------------------------------------------------------
+/**
+*/
+void
+BaseMultiplayerServer::AddSnapshotEntity(uint32_t networkId, Math::vec3 const& pos, Math::vec3 const& vel)
+{
+    n_assert(this->snapshotPending);
+    this->currentSnapshot.entities.Append(SnapshotEntity::Quantize(networkId, pos, vel));
+}
+
+//--------------------------------------------------------------------------
+/**
+    Every client gets its own snapshot, built from the entities near it (see
+    BuildClientSnapshot) and delta encoded against the last snapshot it
+    acknowledged. The cost therefore scales with the entities around each
+    client, not with the world. All fragments for all clients are handed to
+    the transport in a single flush.
+*/
+void
+BaseMultiplayerServer::SendSnapshot()
+{
+    if (!this->snapshotPending)
+        return;
+    this->snapshotPending = false;
+
+    if (this->clientConnections.IsEmpty())
+        return;
+
+    this->currentSnapshot.Sort();
+    this->interestGrid.Build(this->currentSnapshot.entities);
+
+    flatbuffers::FlatBufferBuilder builder(SnapshotMaxFragmentSize + 128);
     auto it = this->clientConnections.Begin();
-    i = 0;
     while (it != this->clientConnections.End())
     {
-        // TODO: Can we construct this inplace in the steamnetworkingmessage?
-        Memory::Copy(buf, netMsgs[i]->m_pData, size);
-
-        netMsgs[i]->m_conn = (*(it.val))->GetConnectionId();
-        // HACK: Unreliable for now
-        netMsgs[i]->m_nFlags = 0; 
-        i++;
+        ClientConnection* connection = *(it.val);
         it++;
+
+        // the baseline is gone if the client hasn't acknowledged anything for a while, start over with a full snapshot
+        Snapshot const* baseline = connection->snapshotHistory.Find(connection->GetAckedSnapshot());
+        uint32_t const baselineSequence = baseline != nullptr ? baseline->sequence : SnapshotInvalidSequence;
+
+        this->BuildClientSnapshot(connection, baseline, this->clientSnapshot);
+        connection->snapshotHistory.Store(this->clientSnapshot);
+        // the store may have evicted the baseline if the client lags behind a whole history
+        baseline = connection->snapshotHistory.Find(baselineSequence);
+
+        SnapshotEncodeDelta(this->clientSnapshot, baseline, this->snapshotFragments);
+        connection->lastSnapshotBytes = this->snapshotFragments.data.Size();
+
+        SizeT const numFragments = this->snapshotFragments.offsets.Size();
+        for (IndexT f = 0; f < numFragments; f++)
+        {
+            builder.Clear();
+            auto payload = builder.CreateVector(this->snapshotFragments.data.Begin() + this->snapshotFragments.offsets[f], this->snapshotFragments.sizes[f]);
+            auto msgSnapshot = StandardProtocol::CreateMsgSnapshot(builder, this->clientSnapshot.sequence, baseline != nullptr ? baselineSequence : SnapshotInvalidSequence, (uint16_t)f, (uint16_t)numFragments, payload);
+            auto message = StandardProtocol::CreateMessage(builder, StandardProtocol::MessageData_Snapshot, msgSnapshot.Union());
+            builder.Finish(message);
+
+            this->transport->Send(connection->GetConnectionId(), builder.GetBufferPointer(), builder.GetSize(), false);
+        }
+    }
+
+    this->transport->Flush();
+}
+
+//--------------------------------------------------------------------------
+/**
+    Entities within the client's interest radius are relevant. Relevant
+    entities that didn't change since the baseline cost nothing and are
+    always included. The others accumulate priority every tick, more the
+    closer they are, and are sent in order of priority until the client's
+    bandwidth budget is used up. Sent entities start over at zero, the rest
+    keep their baseline state in the snapshot and carry their priority over,
+    so distant entities still get their turn.
+*/
+void
+BaseMultiplayerServer::BuildClientSnapshot(ClientConnection* connection, Snapshot const* baseline, Snapshot& outSnapshot)
+{
+    Util::Array<SnapshotEntity> const& entities = this->currentSnapshot.entities;
+    outSnapshot.sequence = this->currentSnapshot.sequence;
+    outSnapshot.entities.Clear();
+
+    this->relevantEntities.Clear();
+    float const radius = connection->interestRadius;
+    if (radius > 0.0f)
+    {
+        this->interestGrid.Query(connection->interestPosition, radius, this->relevantEntities);
+    }
+    else
+    {
+        this->relevantEntities.Reserve(entities.Size());
+        for (IndexT i = 0; i < entities.Size(); i++)
+            this->relevantEntities.Append(i);
+    }
+    connection->numRelevantEntities = this->relevantEntities.Size();
+
+    Util::FlatHashTable<uint32_t, float> const& lastPriorities = connection->priorities[connection->currentPriorities];
+    connection->currentPriorities ^= 1;
+    Util::FlatHashTable<uint32_t, float>& nextPriorities = connection->priorities[connection->currentPriorities];
+    nextPriorities.Clear();
+
+    this->candidates.Clear();
+    for (IndexT i : this->relevantEntities)
+    {
+        SnapshotEntity const& entity = entities[i];
+        SnapshotEntity const* base = baseline != nullptr ? baseline->Find(entity.networkId) : nullptr;
+        if (base != nullptr && *base == entity)
+        {
+            outSnapshot.entities.Append(entity);
+            continue;
+        }
+
+        float weight = 1.0f;
+        if (radius > 0.0f)
+            weight = 1.0f - 0.9f * Math::length(entity.GetPosition() - connection->interestPosition) / radius;
+
+        IndexT const priorityIndex = lastPriorities.FindIndex(entity.networkId);
+        float const priority = (priorityIndex != InvalidIndex ? lastPriorities.ValueAtIndex(entity.networkId, priorityIndex) : 0.0f) + weight;
+        this->candidates.Append({ priority, i, base });
+    }
+
+    SizeT numSent = 0;
+    if (connection->bandwidthBudget == 0)
+    {
+        for (Candidate const& candidate : this->candidates)
+            outSnapshot.entities.Append(entities[candidate.entity]);
+        numSent = this->candidates.Size();
+    }
+    else if (!this->candidates.IsEmpty())
+    {
+        this->candidates.SortWithFunc([](Candidate const& lhs, Candidate const& rhs)
+        {
+            return lhs.priority > rhs.priority;
+        });
+
+        SizeT budget = connection->bandwidthBudget;
+        for (Candidate const& candidate : this->candidates)
+        {
+            SnapshotEntity const& entity = entities[candidate.entity];
+            SizeT const cost = SnapshotEstimateRecordSize(entity, candidate.base);
+            if (cost <= budget)
+            {
+                budget -= cost;
+                outSnapshot.entities.Append(entity);
+                numSent++;
+            }
+            else
+            {
+                // keep what the client already has, so the delta skips it
+                if (candidate.base != nullptr)
+                    outSnapshot.entities.Append(*candidate.base);
+                nextPriorities.Add(entity.networkId, candidate.priority);
+            }
+        }
+    }
+    connection->numSentEntities = numSent;
+    outSnapshot.Sort();
+}
+
+//--------------------------------------------------------------------------
+/**
+*/
+void
+BaseMultiplayerServer::AcknowledgeSnapshot(ClientConnection* connection, uint32_t sequence)
+{
+    // ignore acknowledgements for snapshots that were never sent
+    if (sequence <= this->snapshotSequence)
+    {
+        connection->AckSnapshot(sequence);
     }
-    
-    int64* outMessageNumberOrResult = nullptr;
-    this->netInterface->SendMessages(numClients, netMsgs, outMessageNumberOrResult);
 }
 
 //------------------------------------------------------------------------------
@@ -242,32 +429,32 @@ BaseMultiplayerServer::OnMessageReceived(ClientConnection* connection, Timing::T
 /**
 */
 void
-BaseMultiplayerServer::OnNetConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info)
+BaseMultiplayerServer::OnNetConnectionStatusChanged(TransportStatusChange const& info)
 {
-    switch (info->m_info.m_eState)
+    switch (info.state)
     {
-        case k_ESteamNetworkingConnectionState_None:
+        case TransportConnectionState::None:
             // NOTE: We will get callbacks here when we destroy connections. We can ignore these.
             break;
 
-        case k_ESteamNetworkingConnectionState_ClosedByPeer:
-        case k_ESteamNetworkingConnectionState_ProblemDetectedLocally:
+        case TransportConnectionState::ClosedByPeer:
+        case TransportConnectionState::ProblemDetectedLocally:
         {
             // Ignore if they were not previously connected. (If they disconnected
             // before we accepted the connection.)
-            if (info->m_eOldState == k_ESteamNetworkingConnectionState_Connected)
+            if (info.oldState == TransportConnectionState::Connected)
             {
                 // Locate the client.  Note that it should have been found, because this
                 // is the only codepath where we remove clients (except on shutdown),
                 // and connection change callbacks are dispatched in queue order.
-                IndexT clientIndex = this->clientConnections.FindIndex(info->m_hConn);
+                IndexT clientIndex = this->clientConnections.FindIndex(info.connection);
                 n_assert(clientIndex != InvalidIndex);
 
-                ClientConnection* connection = this->clientConnections.ValueAtIndex(info->m_hConn, clientIndex);
+                ClientConnection* connection = this->clientConnections.ValueAtIndex(info.connection, clientIndex);
 
                 // Select appropriate log messages
                 const char* pszDebugLogAction;
-                if (info->m_info.m_eState == k_ESteamNetworkingConnectionState_ProblemDetectedLocally)
+                if (info.state == TransportConnectionState::ProblemDetectedLocally)
                 {
                     pszDebugLogAction = "problem detected locally";
                 }
@@ -283,22 +470,23 @@ BaseMultiplayerServer::OnNetConnectionStatusChanged(SteamNetConnectionStatusChan
                 // transport-specific data (e.g. their IP address)
                 n_printf(
                     "Connection %s %s, reason %d: %s\n",
-                    info->m_info.m_szConnectionDescription,
+                    info.description.AsCharPtr(),
                     pszDebugLogAction,
-                    info->m_info.m_eEndReason,
-                    info->m_info.m_szEndDebug
+                    info.endReason,
+                    info.endDebug.AsCharPtr()
                 );
 
-                this->OnClientDisconnected(this->clientConnections[info->m_hConn]);
+                this->OnClientDisconnected(connection);
                 
-                this->clientConnections.EraseIndex(info->m_hConn, clientIndex);
+                this->clientConnections.EraseIndex(info.connection, clientIndex);
+                delete connection;
 
                 // Send a message so everybody else knows what happened?
                 //Broadcast(temp);
             }
             else
             {
-                n_assert(info->m_eOldState == k_ESteamNetworkingConnectionState_Connecting);
+                n_assert(info.oldState == TransportConnectionState::Connecting);
             }
 
             // Clean up the connection.  This is important!
@@ -307,62 +495,67 @@ BaseMultiplayerServer::OnNetConnectionStatusChanged(SteamNetConnectionStatusChan
             // to finish up.  The reason information do not matter in this case,
             // and we cannot linger because it's already closed on the other end,
             // so we just pass 0's.
-            this->netInterface->CloseConnection(info->m_hConn, 0, nullptr, false);
+            this->transport->CloseConnection(info.connection, 0, nullptr, false);
             break;
         }
 
-        case k_ESteamNetworkingConnectionState_Connecting:
+        case TransportConnectionState::Connecting:
         {
             // This must be a new connection
-            n_assert(this->clientConnections.FindIndex(info->m_hConn) == InvalidIndex);
+            n_assert(this->clientConnections.FindIndex(info.connection) == InvalidIndex);
 
-            n_printf("Connection request from %s.", info->m_info.m_szConnectionDescription);
+            n_printf("Connection request from %s.", info.description.AsCharPtr());
 
             // A client is attempting to connect
             // Try to accept the connection.
-            if (this->netInterface->AcceptConnection(info->m_hConn) != k_EResultOK)
+            if (!this->transport->AcceptConnection(info.connection))
             {
                 // This could fail.  If the remote host tried to connect, but then
                 // disconnected, the connection may already be half closed.  Just
                 // destroy whatever we have on our side.
-                this->netInterface->CloseConnection(info->m_hConn, 0, nullptr, false);
+                this->transport->CloseConnection(info.connection, 0, nullptr, false);
                 n_printf("Can't accept connection. (It was already closed?)\n");
                 break;
             }
 
             
             ClientConnection* connection = new ClientConnection();
-            connection->Initialize(this, info->m_hConn);
+            connection->Initialize(this, info.connection);
             
             bool accepted = this->OnClientIsConnecting(connection);
 
             if (!accepted)
             {
-                n_printf("Connection %s denied by protocol.\n", info->m_info.m_szConnectionDescription);
+                n_printf("Connection %s denied by protocol.\n", info.description.AsCharPtr());
+                this->transport->CloseConnection(info.connection, 0, nullptr, false);
                 delete connection;
                 break;
             }
 
             // Assign the poll group
-            if (!this->netInterface->SetConnectionPollGroup(info->m_hConn, this->pollGroups[(int)connection->GetClientGroup()]))
+            if (!this->transport->SetConnectionPollGroup(info.connection, this->pollGroups[(int)connection->GetClientGroup()]))
             {
-                this->netInterface->CloseConnection(info->m_hConn, 0, nullptr, false);
+                this->transport->CloseConnection(info.connection, 0, nullptr, false);
                 delete connection;
                 n_printf("Failed to set poll group?\n");
                 break;
             }
 
             this->AddClientConnection(connection);
-            n_printf("Accepted connection from %s.\n", info->m_info.m_szConnectionDescription);
+            n_printf("Accepted connection from %s.\n", info.description.AsCharPtr());
 
             // Let everybody else know there's a new player in game?
-            //Broadcast(temp, info->m_hConn);
+            //Broadcast(temp, info.connection);
             break;
         }
 
-        case k_ESteamNetworkingConnectionState_Connected:
-            this->OnClientConnected(this->clientConnections[info->m_hConn]);
+        case TransportConnectionState::Connected:
+        {
+            IndexT clientIndex = this->clientConnections.FindIndex(info.connection);
+            if (clientIndex != InvalidIndex)
+                this->OnClientConnected(this->clientConnections.ValueAtIndex(info.connection, clientIndex));
             break;
+        }
 
         default:
             // Silences -Wswitch
@@ -420,6 +613,7 @@ BaseMultiplayerServer::SyncAll()
 void
 BaseMultiplayerServer::PollIncomingMessages()
 {
+    this->incomingMessages.Resize(this->maxMessagesPerFrame);
     for (int i = 0; i < (int)ClientGroup::NumClientGroups; i++)
     {
         if (this->pollGroupTimers[i].GetTime() < this->pollGroupIntervals[i])
@@ -429,34 +623,29 @@ BaseMultiplayerServer::PollIncomingMessages()
 
         this->pollGroupTimers[i].Reset();
 
-        // TODO: Don't allocate this per frame, just reuse the old buffer.
-        ISteamNetworkingMessage** incomingMsg = new ISteamNetworkingMessage*[this->maxMessagesPerFrame];
-        int numMsgs = this->netInterface->ReceiveMessagesOnPollGroup(this->pollGroups[i], incomingMsg, this->maxMessagesPerFrame);
+        int numMsgs = this->transport->ReceiveMessagesOnPollGroup(this->pollGroups[i], this->incomingMessages.Begin(), this->maxMessagesPerFrame);
         if (numMsgs == 0)
         {
-            return;
+            continue;
         }
         if (numMsgs < 0)
         {
             n_error("Error checking for messages");
         }
 
-        n_assert(numMsgs <= this->maxMessagesPerFrame && incomingMsg);
-        for (int i = 0; i < numMsgs; i++)
+        n_assert(numMsgs <= this->maxMessagesPerFrame);
+        for (int m = 0; m < numMsgs; m++)
         {   
-            IndexT clientIndex = this->clientConnections.FindIndex(incomingMsg[i]->m_conn);
+            TransportMessage const& msg = this->incomingMessages[m];
+            IndexT clientIndex = this->clientConnections.FindIndex(msg.connection);
             n_assert(clientIndex != InvalidIndex);
-            void* data = incomingMsg[i]->m_pData;
-            int bytes = incomingMsg[i]->m_cbSize;
-            double recvTime = incomingMsg[i]->m_usecTimeReceived;
 
-            if (data != nullptr && bytes > 0)
+            if (msg.data != nullptr && msg.size > 0)
             {
-                this->OnMessageReceived(this->clientConnections[incomingMsg[i]->m_conn], recvTime, (byte*)data, bytes);
-                incomingMsg[i]->Release();
+                this->OnMessageReceived(this->clientConnections.ValueAtIndex(msg.connection, clientIndex), msg.receiveTime, (byte*)msg.data, msg.size);
             }
         }
-        delete[] incomingMsg;
+        this->transport->ReleaseMessages(this->incomingMessages.Begin(), numMsgs);
     }
 }
 
@@ -466,8 +655,10 @@ BaseMultiplayerServer::PollIncomingMessages()
 void
 BaseMultiplayerServer::PollConnectionChanges()
 {
-    callbackServerInstance = this;
-    this->netInterface->RunCallbacks();
+    this->transport->RunCallbacks([this](TransportStatusChange const& info)
+    {
+        this->OnNetConnectionStatusChanged(info);
+    });
 }
 
 } // namespace Multiplayer
@@ -8,10 +8,11 @@
 */
 #include "core/refcounted.h"
 #include "clientconnection.h"
-#include "GameNetworkingSockets/steam/steamnetworkingtypes.h"
 #include "timing/timer.h"
-
-class ISteamNetworkingSockets;
+#include "util/flathashtable.h"
+#include "multiplayer/snapshot.h"
+#include "interestgrid.h"
+#include "multiplayer/transport/transport.h"
 
 //------------------------------------------------------------------------------
 namespace Multiplayer
@@ -29,11 +30,26 @@ public:
     virtual void Close();
     /// return true if server is open
     bool IsOpen() const;
+    /// set the transport before opening the server, a GameNetworkingSockets transport is used if none is set
+    void SetTransport(Transport* transport);
+    /// get the transport
+    Transport* GetTransport() const;
     /// draw imgui network debug information
     void DrawNetworkDebugInfo();
     /// broadcast message to all clients
     void Broadcast(void* buf, int size);
 
+    /// start collecting the snapshot of a new tick
+    void BeginSnapshot();
+    /// add the state of a replicated entity to the current snapshot
+    void AddSnapshotEntity(uint32_t networkId, Math::vec3 const& pos, Math::vec3 const& vel);
+    /// build each client's snapshot by interest, delta encode it against the client's acknowledged one and send it
+    void SendSnapshot();
+    /// set cell size of the interest grid, should be in the order of the clients' interest radius
+    void SetInterestCellSize(float size);
+    /// called when a client has received all fragments of a snapshot
+    void AcknowledgeSnapshot(ClientConnection* connection, uint32_t sequence);
+
     /// Called when client is trying to connect. Override and return true if the connection should be accepted.
     virtual bool OnClientIsConnecting(ClientConnection* connection);
     /// Called when client has successfully connected to the server.
@@ -53,14 +69,14 @@ public:
     /// Sets the interval (seconds) between ticks
     void SetTickInterval(Timing::Time interval);
 
-    ///
-    void SetClientGroupPollInterval(ClientGroup group, Timing::Time msBetweenTicks);
+    /// set the interval (seconds) between polls of a client group
+    void SetClientGroupPollInterval(ClientGroup group, Timing::Time interval);
 
     /// Checks for connection changes, polls messages and calls OnFrame/OnTick.
     void SyncAll();
 
-    /// Used internally by GameNetworkingSockets at connection status changes.
-    void OnNetConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info);
+    /// Called by the transport at connection status changes.
+    void OnNetConnectionStatusChanged(TransportStatusChange const& info);
     
     SizeT maxMessagesPerFrame = 1024;
     
@@ -71,18 +87,36 @@ protected:
     
     void PollIncomingMessages();
     void PollConnectionChanges();
+    /// select the entities of the current snapshot a client gets this tick
+    void BuildClientSnapshot(ClientConnection* connection, Snapshot const* baseline, Snapshot& outSnapshot);
     
     bool isOpen;
-    Util::HashTable<HSteamNetConnection, ClientConnection*, 128> clientConnections;
+    Util::FlatHashTable<ConnectionId, ClientConnection*> clientConnections;
     
-	ISteamNetworkingSockets* netInterface;
-    HSteamListenSocket listenSock;
-	HSteamNetPollGroup pollGroups[(int)ClientGroup::NumClientGroups];
+    Transport* transport;
+    bool ownsTransport;
+    PollGroupId pollGroups[(int)ClientGroup::NumClientGroups];
+    Util::Array<TransportMessage> incomingMessages;
     Timing::Timer pollGroupTimers[(int)ClientGroup::NumClientGroups];
     Timing::Time pollGroupIntervals[(int)ClientGroup::NumClientGroups];
     
     Timing::Timer tickTimer;
     Timing::Time tickInterval;
+
+    Snapshot currentSnapshot;
+    Snapshot clientSnapshot;
+    SnapshotFragments snapshotFragments;
+    InterestGrid interestGrid;
+    Util::Array<IndexT> relevantEntities;
+    struct Candidate
+    {
+        float priority;
+        IndexT entity;
+        SnapshotEntity const* base;
+    };
+    Util::Array<Candidate> candidates;
+    uint32_t snapshotSequence = SnapshotInvalidSequence;
+    bool snapshotPending = false;
 };
 
 //------------------------------------------------------------------------------
@@ -94,6 +128,15 @@ BaseMultiplayerServer::IsOpen() const
     return this->isOpen;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline Transport*
+BaseMultiplayerServer::GetTransport() const
+{
+    return this->transport;
+}
+
 //--------------------------------------------------------------------------
 /**
 */
@@ -112,5 +155,14 @@ BaseMultiplayerServer::SetTickInterval(Timing::Time interval)
     this->tickInterval = interval;
 }
 
+//--------------------------------------------------------------------------
+/**
+*/
+inline void
+BaseMultiplayerServer::SetInterestCellSize(float size)
+{
+    this->interestGrid.SetCellSize(size);
+}
+
 } // namespace Multiplayer
 //------------------------------------------------------------------------------
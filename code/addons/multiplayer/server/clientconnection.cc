@@ -5,8 +5,6 @@
 #include "foundation/stdneb.h"
 #include "clientconnection.h"
 #include "basemultiplayerserver.h"
-#include "GameNetworkingSockets/steam/steamnetworkingsockets.h"
-#include "steam/isteamnetworkingutils.h"
 #include "imgui.h"
 
 namespace Multiplayer
@@ -32,12 +30,10 @@ ClientConnection::~ClientConnection()
 /**
 */
 void
-ClientConnection::Initialize(BaseMultiplayerServer* server, HSteamNetConnection connectionId)
+ClientConnection::Initialize(BaseMultiplayerServer* server, ConnectionId connectionId)
 {
     this->server = server;
     this->connectionId = connectionId;
-    SteamNetworkingUtils()->SetConnectionConfigValueInt32(this->connectionId, k_ESteamNetworkingConfig_SendBufferSize, 1_MB );
-    SteamNetworkingUtils()->SetConnectionConfigValueInt32(this->connectionId, k_ESteamNetworkingConfig_RecvBufferSize, 1_MB );
 }
 
 //--------------------------------------------------------------------------
@@ -46,7 +42,7 @@ ClientConnection::Initialize(BaseMultiplayerServer* server, HSteamNetConnection
 bool
 ClientConnection::IsConnected() const
 {
-    return this->connectionId != k_HSteamNetConnection_Invalid;
+    return this->connectionId != InvalidConnectionId;
 }
 
 //--------------------------------------------------------------------------
@@ -55,8 +51,8 @@ ClientConnection::IsConnected() const
 void
 ClientConnection::Shutdown()
 {
-    this->server->netInterface->CloseConnection(this->connectionId, 0, "Disconnected from server", true);
-    this->connectionId = k_HSteamNetConnection_Invalid;
+    this->server->transport->CloseConnection(this->connectionId, 0, "Disconnected from server", true);
+    this->connectionId = InvalidConnectionId;
 }
 
 //--------------------------------------------------------------------------
@@ -74,14 +70,13 @@ ClientConnection::SetClientGroup(ClientGroup group)
 Timing::Time
 ClientConnection::GetCurrentPing() const
 {
-    SteamNetConnectionRealTimeStatus_t status;
-    EResult res = this->server->netInterface->GetConnectionRealTimeStatus(this->connectionId, &status, 0, nullptr);
-    if (res == k_EResultNoConnection)
+    TransportConnectionStats stats;
+    if (!this->server->transport->GetConnectionStats(this->connectionId, stats))
     {
         return 0.0f;
     }
     
-    return (double)status.m_nPing / 1000.0;
+    return (double)stats.pingMs / 1000.0;
 }
 
 //------------------------------------------------------------------------------
@@ -92,22 +87,22 @@ ClientConnection::DrawNetworkDebugInfo()
 {
     ImGui::Text("Connection %u", (uint32_t)this->connectionId);
 
-    SteamNetConnectionRealTimeStatus_t status;
-    EResult res = this->server->netInterface->GetConnectionRealTimeStatus(this->connectionId, &status, 0, nullptr);
-    if (res != k_EResultOK)
+    TransportConnectionStats stats;
+    if (!this->server->transport->GetConnectionStats(this->connectionId, stats))
     {
-        ImGui::Text("Connection status unavailable: %i", (int)res);
+        ImGui::Text("Connection status unavailable");
         return;
     }
 
-    ImGui::Text("Ping: %i ms", status.m_nPing);
-    ImGui::Text("Out: %.1f KB/s (%.1f pkt/s)", status.m_flOutBytesPerSec / 1024.0f, status.m_flOutPacketsPerSec);
-    ImGui::Text("In:  %.1f KB/s (%.1f pkt/s)", status.m_flInBytesPerSec / 1024.0f, status.m_flInPacketsPerSec);
-    ImGui::Text("Send capacity: %.1f KB/s", (float)status.m_nSendRateBytesPerSecond / 1024.0f);
-    ImGui::Text("Pending: reliable=%i B unreliable=%i B", status.m_cbPendingReliable, status.m_cbPendingUnreliable);
-    ImGui::Text("Unacked reliable: %i B", status.m_cbSentUnackedReliable);
-    ImGui::Text("Queue time: %.2f ms", (double)status.m_usecQueueTime / 1000.0);
-    ImGui::Text("Quality: local=%.2f remote=%.2f", status.m_flConnectionQualityLocal, status.m_flConnectionQualityRemote);
+    ImGui::Text("Ping: %i ms", stats.pingMs);
+    ImGui::Text("Out: %.1f KB/s (%.1f pkt/s)", stats.outBytesPerSec / 1024.0f, stats.outPacketsPerSec);
+    ImGui::Text("In:  %.1f KB/s (%.1f pkt/s)", stats.inBytesPerSec / 1024.0f, stats.inPacketsPerSec);
+    ImGui::Text("Send capacity: %.1f KB/s", (float)stats.sendRateBytesPerSec / 1024.0f);
+    ImGui::Text("Pending: reliable=%i B unreliable=%i B", stats.pendingReliable, stats.pendingUnreliable);
+    ImGui::Text("Unacked reliable: %i B", stats.sentUnackedReliable);
+    ImGui::Text("Queue time: %.2f ms", stats.queueTime * 1000.0);
+    ImGui::Text("Quality: local=%.2f remote=%.2f", stats.qualityLocal, stats.qualityRemote);
+    ImGui::Text("Entities: %i relevant, %i sent, %i B last snapshot", this->numRelevantEntities, this->numSentEntities, this->lastSnapshotBytes);
 }
 
 } // namespace Multiplayer
@@ -7,8 +7,11 @@
     (C) 2025 Individual contributors, see AUTHORS file
 */
 //------------------------------------------------------------------------------
-#include "GameNetworkingSockets/steam/steamnetworkingtypes.h"
 #include "timing/time.h"
+#include "math/vec3.h"
+#include "util/flathashtable.h"
+#include "multiplayer/snapshot.h"
+#include "multiplayer/transport/transport.h"
 
 namespace Multiplayer
 {
@@ -50,7 +53,7 @@ public:
     /// destructor
     virtual ~ClientConnection();
     ///// connect using provided socket
-    void Initialize(BaseMultiplayerServer* server, HSteamNetConnection connectionId);
+    void Initialize(BaseMultiplayerServer* server, ConnectionId connectionId);
 
     /// get the connection status
     bool IsConnected() const;
@@ -72,11 +75,37 @@ public:
     uint64_t GetUserData() const;
 
     void SetUserData(uint64_t);
+
+    /// sequence of the newest snapshot the client has received completely
+    uint32_t GetAckedSnapshot() const;
+    /// set acknowledged snapshot, older acknowledgements are ignored
+    void AckSnapshot(uint32_t sequence);
+
+    /// set the point of view of the client, only entities within radius are replicated. A radius of 0 replicates everything.
+    void SetInterest(Math::vec3 const& position, float radius);
+    /// set the maximum number of entity bytes sent per tick, 0 is unlimited
+    void SetBandwidthBudget(SizeT bytesPerTick);
 protected:
+    friend BaseMultiplayerServer;
+
     BaseMultiplayerServer* server;
     ClientGroup group = ClientGroup::DontCare;
-    HSteamNetConnection connectionId = k_HSteamNetConnection_Invalid;
+    ConnectionId connectionId = InvalidConnectionId;
     uint64_t userData;
+    uint32_t ackedSnapshot = 0;
+
+    Math::vec3 interestPosition = Math::vec3(0);
+    float interestRadius = 0.0f;
+    SizeT bandwidthBudget = 0;
+
+    /// snapshots sent to this client, used as delta baselines
+    SnapshotHistory snapshotHistory;
+    /// accumulated priority of relevant entities that were not sent, swapped every tick
+    Util::FlatHashTable<uint32_t, float> priorities[2];
+    IndexT currentPriorities = 0;
+    SizeT numRelevantEntities = 0;
+    SizeT numSentEntities = 0;
+    SizeT lastSnapshotBytes = 0;
 };
 
 //--------------------------------------------------------------------------
@@ -112,4 +141,45 @@ ClientConnection::SetUserData(uint64_t data)
     this->userData = data;
 }
 
+//--------------------------------------------------------------------------
+/**
+*/
+inline uint32_t
+ClientConnection::GetAckedSnapshot() const
+{
+    return this->ackedSnapshot;
+}
+
+//--------------------------------------------------------------------------
+/**
+*/
+inline void
+ClientConnection::AckSnapshot(uint32_t sequence)
+{
+    if (sequence > this->ackedSnapshot)
+    {
+        this->ackedSnapshot = sequence;
+    }
+}
+
+//--------------------------------------------------------------------------
+/**
+*/
+inline void
+ClientConnection::SetInterest(Math::vec3 const& position, float radius)
+{
+    n_assert(radius >= 0.0f);
+    this->interestPosition = position;
+    this->interestRadius = radius;
+}
+
+//--------------------------------------------------------------------------
+/**
+*/
+inline void
+ClientConnection::SetBandwidthBudget(SizeT bytesPerTick)
+{
+    this->bandwidthBudget = bytesPerTick;
+}
+
 } // namespace Multiplayer
@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------
+//  @file interestgrid.cc
+//  @copyright (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "interestgrid.h"
+#include "math/scalar.h"
+
+namespace Multiplayer
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+InterestGrid::InterestGrid() :
+    cellSize(64.0f),
+    bucketMask(0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InterestGrid::Build(Util::Array<SnapshotEntity> const& entities)
+{
+    SizeT const numEntities = entities.Size();
+    SizeT const numBuckets = Math::max(64u, Math::roundtopow2((unsigned int)numEntities * 2));
+    this->bucketMask = numBuckets - 1;
+
+    this->positions.Resize(numEntities);
+    this->cellX.Resize(numEntities);
+    this->cellZ.Resize(numEntities);
+    this->bucketEntities.Resize(numEntities);
+    this->bucketStart.Clear();
+    this->bucketStart.Fill(0, numBuckets + 1, 0);
+
+    float const invCellSize = 1.0f / this->cellSize;
+    for (IndexT i = 0; i < numEntities; i++)
+    {
+        Math::vec3 const pos = entities[i].GetPosition();
+        this->positions[i] = pos;
+        this->cellX[i] = (int32_t)Math::floor(pos.x * invCellSize);
+        this->cellZ[i] = (int32_t)Math::floor(pos.z * invCellSize);
+        this->bucketStart[this->Bucket(this->cellX[i], this->cellZ[i]) + 1]++;
+    }
+
+    // prefix sum, then scatter
+    for (IndexT b = 0; b < numBuckets; b++)
+        this->bucketStart[b + 1] += this->bucketStart[b];
+
+    Util::Array<uint32_t> cursor = this->bucketStart;
+    for (IndexT i = 0; i < numEntities; i++)
+    {
+        uint32_t const bucket = this->Bucket(this->cellX[i], this->cellZ[i]);
+        this->bucketEntities[cursor[bucket]++] = i;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Buckets are shared by all cells hashing to them, so every entry is checked
+    against the cell it was inserted for to avoid duplicates. If the radius
+    covers more cells than there are entities, all entities are tested
+    directly instead.
+*/
+void
+InterestGrid::Query(Math::vec3 const& center, float radius, Util::Array<IndexT>& outIndices) const
+{
+    float const invCellSize = 1.0f / this->cellSize;
+    int32_t const minX = (int32_t)Math::floor((center.x - radius) * invCellSize);
+    int32_t const maxX = (int32_t)Math::floor((center.x + radius) * invCellSize);
+    int32_t const minZ = (int32_t)Math::floor((center.z - radius) * invCellSize);
+    int32_t const maxZ = (int32_t)Math::floor((center.z + radius) * invCellSize);
+    float const radiusSq = radius * radius;
+
+    int64_t const numCells = (int64_t)(maxX - minX + 1) * (int64_t)(maxZ - minZ + 1);
+    if (numCells > this->positions.Size())
+    {
+        for (IndexT i = 0; i < this->positions.Size(); i++)
+        {
+            if (Math::lengthsq(this->positions[i] - center) <= radiusSq)
+                outIndices.Append(i);
+        }
+        return;
+    }
+
+    for (int32_t z = minZ; z <= maxZ; z++)
+    {
+        for (int32_t x = minX; x <= maxX; x++)
+        {
+            uint32_t const bucket = this->Bucket(x, z);
+            for (uint32_t j = this->bucketStart[bucket]; j < this->bucketStart[bucket + 1]; j++)
+            {
+                IndexT const i = this->bucketEntities[j];
+                if (this->cellX[i] != x || this->cellZ[i] != z)
+                    continue;
+                if (Math::lengthsq(this->positions[i] - center) <= radiusSq)
+                    outIndices.Append(i);
+            }
+        }
+    }
+}
+
+} // namespace Multiplayer
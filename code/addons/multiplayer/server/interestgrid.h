@@ -0,0 +1,72 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Multiplayer::InterestGrid
+
+    Spatial hash over the entities of a snapshot, used to find the entities
+    relevant to a client.
+
+    Entities are bucketed by their cell on the XZ plane. The grid is rebuilt
+    from scratch every tick, which is a counting sort over the entities and
+    cheaper than keeping a tree up to date for entities that all move. The
+    number of buckets follows the number of entities, not the world size, so
+    a query only touches the cells overlapping the query radius.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "util/array.h"
+#include "math/vec3.h"
+#include "multiplayer/snapshot.h"
+
+namespace Multiplayer
+{
+
+class InterestGrid
+{
+public:
+    /// constructor
+    InterestGrid();
+
+    /// set edge length of a cell, should be in the order of the typical interest radius
+    void SetCellSize(float size);
+    /// rebuild the grid from the entities of a snapshot
+    void Build(Util::Array<SnapshotEntity> const& entities);
+    /// append the indices of all entities within radius of center
+    void Query(Math::vec3 const& center, float radius, Util::Array<IndexT>& outIndices) const;
+
+private:
+    /// get the bucket of a cell
+    uint32_t Bucket(int32_t x, int32_t z) const;
+
+    float cellSize;
+    uint32_t bucketMask;
+    Util::Array<Math::vec3> positions;
+    Util::Array<int32_t> cellX;
+    Util::Array<int32_t> cellZ;
+    /// bucket b holds the entities bucketEntities[bucketStart[b] .. bucketStart[b + 1]]
+    Util::Array<uint32_t> bucketStart;
+    Util::Array<IndexT> bucketEntities;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+InterestGrid::SetCellSize(float size)
+{
+    n_assert(size > 0.0f);
+    this->cellSize = size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint32_t
+InterestGrid::Bucket(int32_t x, int32_t z) const
+{
+    return (((uint32_t)x * 73856093u) ^ ((uint32_t)z * 19349663u)) & this->bucketMask;
+}
+
+} // namespace Multiplayer
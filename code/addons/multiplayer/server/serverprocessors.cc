@@ -9,9 +9,6 @@
 #include "game/world.h"
 #include "multiplayer/server/basemultiplayerserver.h"
 #include "serverprocessors.h"
-#include "nflatbuffer/nebula_flat.h"
-#include "nflatbuffer/flatbufferinterface.h"
-#include "flat/addons/multiplayer/standardprotocol.h"
 
 namespace Multiplayer
 {
@@ -21,7 +18,6 @@ struct ServerProcessorContext
     BaseMultiplayerServer* server;
     Util::Array<Game::Processor*> processors;
     Game::TimeSource const* timeSource;
-    flatbuffers::FlatBufferBuilder builder = flatbuffers::FlatBufferBuilder(4_KB);
 };
 
 static ServerProcessorContext* context;
@@ -29,6 +25,9 @@ static Util::StringAtom frameEvent;
 
 //--------------------------------------------------------------------------
 /**
+    Adds the entity to the snapshot of the current tick. The snapshot is
+    delta encoded and sent to all clients at once by the server, see
+    BaseMultiplayerServer::SendSnapshot.
 */
 void
 SyncPositions(Game::World* world,
@@ -36,24 +35,12 @@ SyncPositions(Game::World* world,
               NetworkTransform& netTransform,
               Game::Position& pos)
 {
-    context->builder.Clear();
-    flatbuffers::Offset<StandardProtocol::MsgSyncPosition> msgPos;
-    flatbuffers::Offset<StandardProtocol::Message> message;
-    
     netTransform.tickNumber++;
     // Reusing position extrapolators last packet pos, to save some memory.
     Math::vec3 instantVelocity = (pos - netTransform.positionExtrapolator.lastPacketPos) * (1.0f / context->server->GetTickInterval());
     netTransform.positionExtrapolator.lastPacketPos = pos;
 
-    msgPos = StandardProtocol::CreateMsgSyncPosition(context->builder, netId.identifier, (Flat::Vec3*)&pos, (Flat::Vec3*)&instantVelocity, netTransform.tickNumber);
-    message = StandardProtocol::CreateMessage(context->builder, StandardProtocol::MessageData_SyncPosition, msgPos.Union());
-    
-    context->builder.Finish(message);
-    
-    uint8_t* buf = context->builder.GetBufferPointer();
-    int size = context->builder.GetSize();
-
-    context->server->Broadcast(buf, size);
+    context->server->AddSnapshotEntity(netId.identifier, pos, instantVelocity);
 }
 
 //--------------------------------------------------------------------------
@@ -13,9 +13,6 @@
 #include "nflatbuffer/nebula_flat.h"
 #include "nflatbuffer/flatbufferinterface.h"
 #include "flat/addons/multiplayer/standardprotocol.h"
-#include "steam/isteamnetworkingutils.h"
-#include "steam/steamnetworkingtypes.h"
-#include "steam/isteamnetworkingsockets.h"
 
 namespace Multiplayer
 {
@@ -65,55 +62,31 @@ StandardMultiplayerServer::OnClientConnected(ClientConnection* client)
         .Build();
     Game::Dataset data = world->Query(filter);
 
-    int numMsgs = 0;
     for (int v = 0; v < data.numViews; v++)
     {
-        numMsgs += data.views[v].numInstances;
-    }
+        Game::Dataset::View const& view = data.views[v];
+        Game::Entity const* const entities = (Game::Entity*)view.buffers[0];
+        
+        MemDb::Table const& table = world->GetDatabase()->GetTable(view.tableId);
+        
+        for (IndexT i = 0; i < view.numInstances; ++i)
+        {
+            builder.Clear();
 
-    if (numMsgs > 0)
-    {
-        ISteamNetworkingMessage** outgoingMsgs = new ISteamNetworkingMessage*[numMsgs];
+            Game::EntityMapping const& mapping = world->GetEntityMapping(entities[i]);
+            Util::Blob blob = table.SerializeInstance(mapping.instance);
 
-        for (int v = 0; v < data.numViews; v++)
-        {
-            Game::Dataset::View const& view = data.views[v];
-            Game::Entity const* const entities = (Game::Entity*)view.buffers[0];
-            NetworkId const* const netIds = (NetworkId*)view.buffers[1];
-            
-            MemDb::Table const& table = world->GetDatabase()->GetTable(view.tableId);
+            flatbuffers::Offset<StandardProtocol::MsgReplicateObject> msgRep;
+            flatbuffers::Offset<StandardProtocol::Message> message;
+            auto vector_bytes = builder.CreateVector((ubyte*)blob.GetPtr(), blob.Size());
+            msgRep = StandardProtocol::CreateMsgReplicateObject(builder, vector_bytes);
+            message = StandardProtocol::CreateMessage(builder, StandardProtocol::MessageData_ReplicateObject, msgRep.Union());
             
-            for (IndexT i = 0; i < view.numInstances; ++i)
-            {
-                builder.Clear();
-
-                Game::EntityMapping const& mapping = world->GetEntityMapping(entities[0]);
-                Util::Blob blob = table.SerializeInstance(mapping.instance);
-
-                flatbuffers::Offset<StandardProtocol::MsgReplicateObject> msgRep;
-                flatbuffers::Offset<StandardProtocol::Message> message;
-                auto vector_bytes = builder.CreateVector((ubyte*)blob.GetPtr(), blob.Size());
-                msgRep = StandardProtocol::CreateMsgReplicateObject(builder, vector_bytes);
-                message = StandardProtocol::CreateMessage(builder, StandardProtocol::MessageData_ReplicateObject, msgRep.Union());
-                
-                builder.Finish(message);
-                
-                uint8_t* buf = builder.GetBufferPointer();
-                int size = builder.GetSize();
-    
-                outgoingMsgs[i] = SteamNetworkingUtils()->AllocateMessage(size);
-                
-                // TODO: Can we construct this inplace in the steamnetworkingmessage?
-                Memory::Copy(buf, outgoingMsgs[i]->m_pData, size);
-                
-                outgoingMsgs[i]->m_conn = client->GetConnectionId();
-                outgoingMsgs[i]->m_nFlags = k_nSteamNetworkingSend_Reliable;
-            }
+            builder.Finish(message);
+            this->transport->Send(client->GetConnectionId(), builder.GetBufferPointer(), builder.GetSize(), true);
         }
-        int64* outMessageNumberOrResult = nullptr;
-        this->netInterface->SendMessages(numMsgs, outgoingMsgs, outMessageNumberOrResult);
-        delete[] outgoingMsgs;
     }
+    this->transport->Flush();
     Game::DestroyFilter(filter);
 }
 
@@ -132,6 +105,18 @@ StandardMultiplayerServer::OnClientDisconnected(ClientConnection* connection)
 void 
 StandardMultiplayerServer::OnMessageReceived(ClientConnection* connection, Timing::Time recvTime, byte* data, size_t size)
 {
+    StandardProtocol::Message const* protocolMessage = StandardProtocol::GetMessage(data);
+    switch (protocolMessage->data_type())
+    {
+        case StandardProtocol::MessageData::MessageData_SnapshotAck:
+        {
+            this->AcknowledgeSnapshot(connection, protocolMessage->data_as_SnapshotAck()->sequence());
+            break;
+        }
+        default:
+            break;
+    }
+
     //StandardProtocol::Message const* protocolMessage = StandardProtocol::GetMessage(data);
     //switch (protocolMessage->data_type())
     //{
@@ -158,6 +143,8 @@ StandardMultiplayerServer::OnMessageReceived(ClientConnection* connection, Timin
 void
 StandardMultiplayerServer::OnFrame()
 {
+    // the processors have filled the snapshot during the frame after the tick
+    this->SendSnapshot();
     SetServerProcessorsActive(false);
 }
 
@@ -167,6 +154,7 @@ StandardMultiplayerServer::OnFrame()
 void
 StandardMultiplayerServer::OnTick()
 {
+    this->BeginSnapshot();
     SetServerProcessorsActive(true);
 }
 
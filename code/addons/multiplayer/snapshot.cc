@@ -0,0 +1,467 @@
+//------------------------------------------------------------------------------
+//  @file snapshot.cc
+//  @copyright (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "snapshot.h"
+#include "math/scalar.h"
+
+namespace Multiplayer
+{
+
+enum SnapshotRecordBits : ubyte
+{
+    PositionX = 1 << 0,
+    PositionY = 1 << 1,
+    PositionZ = 1 << 2,
+    VelocityX = 1 << 3,
+    VelocityY = 1 << 4,
+    VelocityZ = 1 << 5,
+    Removed = 1 << 7
+};
+
+/// largest possible record, id varint + mask + six component varints
+static const SizeT MaxRecordSize = 5 + 1 + 6 * 5;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static SizeT
+WriteVarint(ubyte* buf, uint32_t value)
+{
+    SizeT num = 0;
+    while (value >= 0x80)
+    {
+        buf[num++] = (ubyte)(value | 0x80);
+        value >>= 7;
+    }
+    buf[num++] = (ubyte)value;
+    return num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static bool
+ReadVarint(ubyte const*& ptr, ubyte const* end, uint32_t& value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7)
+    {
+        if (ptr == end)
+            return false;
+        ubyte b = *ptr++;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Differences are computed with wrapping unsigned arithmetic, the zigzag
+    mapping keeps small negative differences small.
+*/
+static uint32_t
+ZigZagDelta(int32_t value, int32_t base)
+{
+    int32_t delta = (int32_t)((uint32_t)value - (uint32_t)base);
+    return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static int32_t
+ZigZagApply(uint32_t zigzag, int32_t base)
+{
+    int32_t delta = (int32_t)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    return (int32_t)((uint32_t)base + (uint32_t)delta);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static SizeT
+WriteRecord(ubyte* buf, uint32_t idDelta, SnapshotEntity const& entity, SnapshotEntity const& base, bool forceWrite)
+{
+    ubyte mask = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        if (entity.pos[i] != base.pos[i])
+            mask |= (ubyte)(PositionX << i);
+        if (entity.vel[i] != base.vel[i])
+            mask |= (ubyte)(VelocityX << i);
+    }
+    if (mask == 0 && !forceWrite)
+        return 0;
+
+    SizeT num = WriteVarint(buf, idDelta);
+    buf[num++] = mask;
+    for (int i = 0; i < 3; i++)
+    {
+        if (mask & (PositionX << i))
+            num += WriteVarint(buf + num, ZigZagDelta(entity.pos[i], base.pos[i]));
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        if (mask & (VelocityX << i))
+            num += WriteVarint(buf + num, ZigZagDelta(entity.vel[i], base.vel[i]));
+    }
+    return num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SnapshotEntity
+SnapshotEntity::Quantize(uint32_t networkId, Math::vec3 const& pos, Math::vec3 const& vel)
+{
+    SnapshotEntity entity;
+    entity.networkId = networkId;
+    entity.pos[0] = (int32_t)Math::round(pos.x / SnapshotPositionPrecision);
+    entity.pos[1] = (int32_t)Math::round(pos.y / SnapshotPositionPrecision);
+    entity.pos[2] = (int32_t)Math::round(pos.z / SnapshotPositionPrecision);
+    entity.vel[0] = (int32_t)Math::round(vel.x / SnapshotVelocityPrecision);
+    entity.vel[1] = (int32_t)Math::round(vel.y / SnapshotVelocityPrecision);
+    entity.vel[2] = (int32_t)Math::round(vel.z / SnapshotVelocityPrecision);
+    return entity;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Math::vec3
+SnapshotEntity::GetPosition() const
+{
+    return Math::vec3(this->pos[0] * SnapshotPositionPrecision, this->pos[1] * SnapshotPositionPrecision, this->pos[2] * SnapshotPositionPrecision);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Math::vec3
+SnapshotEntity::GetVelocity() const
+{
+    return Math::vec3(this->vel[0] * SnapshotVelocityPrecision, this->vel[1] * SnapshotVelocityPrecision, this->vel[2] * SnapshotVelocityPrecision);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Snapshot::Sort()
+{
+    if (this->entities.IsEmpty())
+        return;
+    this->entities.SortWithFunc([](SnapshotEntity const& lhs, SnapshotEntity const& rhs)
+    {
+        return lhs.networkId < rhs.networkId;
+    });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SnapshotEntity const*
+Snapshot::Find(uint32_t networkId) const
+{
+    IndexT lo = 0;
+    IndexT hi = this->entities.Size() - 1;
+    while (lo <= hi)
+    {
+        IndexT mid = (lo + hi) / 2;
+        uint32_t id = this->entities[mid].networkId;
+        if (id == networkId)
+            return &this->entities[mid];
+        else if (id < networkId)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SnapshotHistory::Store(Snapshot const& snapshot)
+{
+    n_assert(snapshot.sequence != SnapshotInvalidSequence);
+    this->snapshots[snapshot.sequence % SnapshotHistorySize] = snapshot;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Snapshot const*
+SnapshotHistory::Find(uint32_t sequence) const
+{
+    if (sequence == SnapshotInvalidSequence)
+        return nullptr;
+    Snapshot const& snapshot = this->snapshots[sequence % SnapshotHistorySize];
+    return snapshot.sequence == sequence ? &snapshot : nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SnapshotHistory::Clear()
+{
+    for (IndexT i = 0; i < SnapshotHistorySize; i++)
+    {
+        this->snapshots[i].sequence = SnapshotInvalidSequence;
+        this->snapshots[i].entities.Clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Walks the sorted entity lists of the snapshot and the baseline side by
+    side. A fragment is closed as soon as the next record might not fit, and
+    every fragment restarts the network id delta chain so it can be decoded
+    without its siblings.
+*/
+void
+SnapshotEncodeDelta(Snapshot const& snapshot, Snapshot const* baseline, SnapshotFragments& outFragments)
+{
+    outFragments.data.Clear();
+    outFragments.offsets.Clear();
+    outFragments.sizes.Clear();
+
+    static const SnapshotEntity Zero = { 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    static const Util::Array<SnapshotEntity> EmptyBaseline;
+    Util::Array<SnapshotEntity> const& baseEntities = baseline != nullptr ? baseline->entities : EmptyBaseline;
+
+    ubyte record[MaxRecordSize];
+    uint32_t fragmentStart = 0;
+    uint32_t prevId = 0;
+    IndexT i = 0, j = 0;
+    while (i < snapshot.entities.Size() || j < baseEntities.Size())
+    {
+        SnapshotEntity const* entity = nullptr;
+        SnapshotEntity const* base = nullptr;
+        if (j == baseEntities.Size() || (i < snapshot.entities.Size() && snapshot.entities[i].networkId < baseEntities[j].networkId))
+        {
+            // spawned since the baseline, written against zero
+            entity = &snapshot.entities[i++];
+        }
+        else if (i == snapshot.entities.Size() || baseEntities[j].networkId < snapshot.entities[i].networkId)
+        {
+            // despawned since the baseline
+            base = &baseEntities[j++];
+        }
+        else
+        {
+            entity = &snapshot.entities[i++];
+            base = &baseEntities[j++];
+        }
+
+        uint32_t const id = entity != nullptr ? entity->networkId : base->networkId;
+        auto writeRecord = [&](uint32_t idDelta) -> SizeT
+        {
+            if (entity == nullptr)
+            {
+                SizeT num = WriteVarint(record, idDelta);
+                record[num++] = Removed;
+                return num;
+            }
+            return WriteRecord(record, idDelta, *entity, base != nullptr ? *base : Zero, base == nullptr);
+        };
+
+        SizeT recordSize = writeRecord(id - prevId);
+        if (recordSize == 0)
+            continue;
+
+        if (outFragments.data.Size() - fragmentStart + recordSize > SnapshotMaxFragmentSize)
+        {
+            outFragments.offsets.Append(fragmentStart);
+            outFragments.sizes.Append(outFragments.data.Size() - fragmentStart);
+            fragmentStart = outFragments.data.Size();
+
+            // restart the id chain in the new fragment
+            recordSize = writeRecord(id);
+        }
+        outFragments.data.AppendArray(record, recordSize);
+        prevId = id;
+    }
+
+    // always emit the last fragment, even an empty one, so the client can acknowledge
+    outFragments.offsets.Append(fragmentStart);
+    outFragments.sizes.Append(outFragments.data.Size() - fragmentStart);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Records are sorted by network id, so the id delta to the previous record
+    is assumed to fit in two bytes.
+*/
+SizeT
+SnapshotEstimateRecordSize(SnapshotEntity const& entity, SnapshotEntity const* base)
+{
+    static const SnapshotEntity Zero = { 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    ubyte record[MaxRecordSize];
+    return WriteRecord(record, 0x80, entity, base != nullptr ? *base : Zero, base == nullptr);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+SnapshotDecodeFragment(ubyte const* data, SizeT size, Snapshot const* baseline, Util::Array<SnapshotEntity>& outChanged, Util::Array<uint32_t>& outRemoved)
+{
+    static const SnapshotEntity Zero = { 0, { 0, 0, 0 }, { 0, 0, 0 } };
+
+    ubyte const* ptr = data;
+    ubyte const* end = data + size;
+    uint32_t prevId = 0;
+    while (ptr < end)
+    {
+        uint32_t idDelta;
+        if (!ReadVarint(ptr, end, idDelta) || ptr == end)
+            return false;
+        uint32_t id = prevId + idDelta;
+        prevId = id;
+
+        ubyte mask = *ptr++;
+        if (mask & Removed)
+        {
+            outRemoved.Append(id);
+            continue;
+        }
+
+        SnapshotEntity const* base = baseline != nullptr ? baseline->Find(id) : nullptr;
+        SnapshotEntity entity = base != nullptr ? *base : Zero;
+        entity.networkId = id;
+        for (int i = 0; i < 3; i++)
+        {
+            if (mask & (PositionX << i))
+            {
+                uint32_t zigzag;
+                if (!ReadVarint(ptr, end, zigzag))
+                    return false;
+                entity.pos[i] = ZigZagApply(zigzag, entity.pos[i]);
+            }
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            if (mask & (VelocityX << i))
+            {
+                uint32_t zigzag;
+                if (!ReadVarint(ptr, end, zigzag))
+                    return false;
+                entity.vel[i] = ZigZagApply(zigzag, entity.vel[i]);
+            }
+        }
+        outChanged.Append(entity);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Fragments of a newer snapshot discard an incomplete older one. Once all
+    fragments arrived, the full snapshot is rebuilt from the baseline and the
+    collected changes and stored as a baseline for future deltas.
+*/
+SnapshotReceiver::Result
+SnapshotReceiver::ReceiveFragment(uint32_t sequence, uint32_t baseline, uint16_t fragment, uint16_t numFragments, ubyte const* data, SizeT size, Util::Array<SnapshotEntity>& outChanged, Util::Array<uint32_t>& outRemoved)
+{
+    if (sequence <= this->lastCompleteSequence || sequence < this->pendingSequence || fragment >= numFragments)
+        return Rejected;
+
+    Snapshot const* baselineSnapshot = this->history.Find(baseline);
+    if (baseline != SnapshotInvalidSequence && baselineSnapshot == nullptr)
+        return Rejected;
+
+    if (sequence != this->pendingSequence)
+    {
+        this->pendingSequence = sequence;
+        this->pendingBaseline = baseline;
+        this->numPendingFragments = numFragments;
+        this->receivedFragments.Clear();
+        this->receivedFragments.Fill(0, numFragments, false);
+        this->pendingChanged.Clear();
+        this->pendingRemoved.Clear();
+    }
+    else if (numFragments != this->numPendingFragments || baseline != this->pendingBaseline || this->receivedFragments[fragment])
+    {
+        return Rejected;
+    }
+
+    IndexT firstChanged = this->pendingChanged.Size();
+    IndexT firstRemoved = this->pendingRemoved.Size();
+    if (!SnapshotDecodeFragment(data, size, baselineSnapshot, this->pendingChanged, this->pendingRemoved))
+    {
+        this->pendingChanged.Resize(firstChanged);
+        this->pendingRemoved.Resize(firstRemoved);
+        return Rejected;
+    }
+    outChanged.AppendArray(this->pendingChanged.Begin() + firstChanged, this->pendingChanged.Size() - firstChanged);
+    outRemoved.AppendArray(this->pendingRemoved.Begin() + firstRemoved, this->pendingRemoved.Size() - firstRemoved);
+
+    this->receivedFragments[fragment] = true;
+    for (IndexT i = 0; i < this->numPendingFragments; i++)
+    {
+        if (!this->receivedFragments[i])
+            return Partial;
+    }
+
+    // merge baseline, changes and removals, all sorted by network id
+    Snapshot complete;
+    complete.sequence = sequence;
+    Snapshot changes;
+    changes.entities = std::move(this->pendingChanged);
+    changes.Sort();
+    if (!this->pendingRemoved.IsEmpty())
+        this->pendingRemoved.Sort();
+
+    static const Util::Array<SnapshotEntity> EmptyBaseline;
+    Util::Array<SnapshotEntity> const& baseEntities = baselineSnapshot != nullptr ? baselineSnapshot->entities : EmptyBaseline;
+    IndexT i = 0, j = 0, k = 0;
+    while (i < baseEntities.Size() || j < changes.entities.Size())
+    {
+        SnapshotEntity const* next;
+        if (j == changes.entities.Size() || (i < baseEntities.Size() && baseEntities[i].networkId < changes.entities[j].networkId))
+        {
+            next = &baseEntities[i++];
+        }
+        else
+        {
+            if (i < baseEntities.Size() && baseEntities[i].networkId == changes.entities[j].networkId)
+                i++;
+            next = &changes.entities[j++];
+        }
+
+        while (k < this->pendingRemoved.Size() && this->pendingRemoved[k] < next->networkId)
+            k++;
+        if (k < this->pendingRemoved.Size() && this->pendingRemoved[k] == next->networkId)
+            continue;
+        complete.entities.Append(*next);
+    }
+    this->history.Store(complete);
+
+    this->lastCompleteSequence = sequence;
+    this->pendingSequence = SnapshotInvalidSequence;
+    this->pendingChanged.Clear();
+    this->pendingRemoved.Clear();
+    return Complete;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SnapshotReceiver::Reset()
+{
+    this->history.Clear();
+    this->lastCompleteSequence = SnapshotInvalidSequence;
+    this->pendingSequence = SnapshotInvalidSequence;
+    this->pendingChanged.Clear();
+    this->pendingRemoved.Clear();
+}
+
+} // namespace Multiplayer
@@ -0,0 +1,173 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file snapshot.h
+
+    Snapshot replication of networked entities.
+
+    Every tick the server collects the state of all replicated entities into
+    one Snapshot, and derives the snapshot each client gets from it by
+    interest management (see BaseMultiplayerServer::SendSnapshot). Positions
+    and velocities are quantized to fixed point, and a client's snapshot is
+    delta encoded against the last one it has acknowledged: entities that did
+    not change are skipped, changed components are written as zigzag varint
+    differences, new entities are written in full and entities that despawned
+    or left the client's interest as removal records. The encoded stream is split into
+    fragments below the MTU at record boundaries, so every fragment can be
+    decoded on its own and a lost fragment only delays the entities it
+    carries.
+
+    The client acknowledges a snapshot once all of its fragments arrived, only
+    complete snapshots are used as a baseline.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/types.h"
+#include "util/array.h"
+#include "math/vec3.h"
+
+namespace Multiplayer
+{
+
+/// world units per quantization step of positions
+constexpr float SnapshotPositionPrecision = 1.0f / 1024.0f;
+/// world units per second per quantization step of velocities
+constexpr float SnapshotVelocityPrecision = 1.0f / 256.0f;
+/// maximum number of payload bytes in one snapshot fragment
+constexpr SizeT SnapshotMaxFragmentSize = 1024;
+/// number of snapshots kept around as possible delta baselines
+constexpr SizeT SnapshotHistorySize = 32;
+/// sequence numbers start at 1, 0 means 'no snapshot'
+constexpr uint32_t SnapshotInvalidSequence = 0;
+
+//------------------------------------------------------------------------------
+/**
+    Quantized state of a single entity.
+*/
+struct SnapshotEntity
+{
+    uint32_t networkId;
+    int32_t pos[3];
+    int32_t vel[3];
+
+    /// quantize a position and velocity
+    static SnapshotEntity Quantize(uint32_t networkId, Math::vec3 const& pos, Math::vec3 const& vel);
+    /// get dequantized position
+    Math::vec3 GetPosition() const;
+    /// get dequantized velocity
+    Math::vec3 GetVelocity() const;
+    /// compare quantized state
+    bool operator==(SnapshotEntity const& rhs) const;
+};
+
+//------------------------------------------------------------------------------
+/**
+    All entity states of one tick, sorted by network id.
+*/
+struct Snapshot
+{
+    uint32_t sequence = SnapshotInvalidSequence;
+    Util::Array<SnapshotEntity> entities;
+
+    /// sort entities by network id, call after adding entities
+    void Sort();
+    /// find an entity by network id, returns nullptr if not in snapshot
+    SnapshotEntity const* Find(uint32_t networkId) const;
+};
+
+//------------------------------------------------------------------------------
+/**
+    Ring buffer of the last SnapshotHistorySize snapshots.
+*/
+class SnapshotHistory
+{
+public:
+    /// store a copy of a snapshot, replaces the oldest one
+    void Store(Snapshot const& snapshot);
+    /// find a snapshot by sequence, returns nullptr if it is not (or no longer) stored
+    Snapshot const* Find(uint32_t sequence) const;
+    /// forget all snapshots
+    void Clear();
+
+private:
+    Snapshot snapshots[SnapshotHistorySize];
+};
+
+//------------------------------------------------------------------------------
+/**
+    Output of the delta encoder, fragment payloads are stored back to back in
+    one buffer.
+*/
+struct SnapshotFragments
+{
+    Util::Array<ubyte> data;
+    Util::Array<uint32_t> offsets;
+    Util::Array<uint32_t> sizes;
+};
+
+/// delta encode a snapshot against a baseline (may be nullptr), always produces at least one fragment
+void SnapshotEncodeDelta(Snapshot const& snapshot, Snapshot const* baseline, SnapshotFragments& outFragments);
+/// encoded size of an entity against its baseline state (nullptr if it is new to the client), 0 if unchanged
+SizeT SnapshotEstimateRecordSize(SnapshotEntity const& entity, SnapshotEntity const* base);
+/// decode one fragment against the baseline it was encoded with, returns false if the payload is malformed
+bool SnapshotDecodeFragment(ubyte const* data, SizeT size, Snapshot const* baseline, Util::Array<SnapshotEntity>& outChanged, Util::Array<uint32_t>& outRemoved);
+
+//------------------------------------------------------------------------------
+/**
+    Client side reassembly of snapshot fragments.
+*/
+class SnapshotReceiver
+{
+public:
+    enum Result
+    {
+        /// fragment was stale, duplicate, malformed or its baseline is unknown
+        Rejected,
+        /// fragment was decoded, the snapshot is still incomplete
+        Partial,
+        /// fragment was decoded and completed the snapshot, it should be acknowledged
+        Complete
+    };
+
+    /// decode a received fragment, the decoded entity states are appended to the output arrays
+    Result ReceiveFragment(uint32_t sequence, uint32_t baseline, uint16_t fragment, uint16_t numFragments, ubyte const* data, SizeT size, Util::Array<SnapshotEntity>& outChanged, Util::Array<uint32_t>& outRemoved);
+    /// sequence of the newest complete snapshot
+    uint32_t GetLastCompleteSequence() const;
+    /// forget all received snapshots, for example after reconnecting
+    void Reset();
+
+private:
+    SnapshotHistory history;
+    uint32_t lastCompleteSequence = SnapshotInvalidSequence;
+
+    uint32_t pendingSequence = SnapshotInvalidSequence;
+    uint32_t pendingBaseline = SnapshotInvalidSequence;
+    SizeT numPendingFragments = 0;
+    Util::Array<bool> receivedFragments;
+    Util::Array<SnapshotEntity> pendingChanged;
+    Util::Array<uint32_t> pendingRemoved;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+SnapshotEntity::operator==(SnapshotEntity const& rhs) const
+{
+    return this->networkId == rhs.networkId
+        && this->pos[0] == rhs.pos[0] && this->pos[1] == rhs.pos[1] && this->pos[2] == rhs.pos[2]
+        && this->vel[0] == rhs.vel[0] && this->vel[1] == rhs.vel[1] && this->vel[2] == rhs.vel[2];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint32_t
+SnapshotReceiver::GetLastCompleteSequence() const
+{
+    return this->lastCompleteSequence;
+}
+
+} // namespace Multiplayer
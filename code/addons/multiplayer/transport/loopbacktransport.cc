@@ -0,0 +1,591 @@
+//------------------------------------------------------------------------------
+//  @file loopbacktransport.cc
+//  @copyright (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "loopbacktransport.h"
+#include "math/scalar.h"
+
+namespace Multiplayer
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+LoopbackNetwork::LoopbackNetwork() :
+    time(0.0),
+    randomState(0x9E3779B9),
+    numMessagesSent(0),
+    numBytesSent(0),
+    numMessagesDropped(0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+LoopbackNetwork::~LoopbackNetwork()
+{
+    n_assert(this->listeners.IsEmpty());
+    for (IndexT i = 0; i < this->endpoints.Size(); i++)
+    {
+        n_assert(this->endpoints[i].transport == nullptr);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackNetwork::SetSettings(Settings const& settings)
+{
+    n_assert(settings.loss >= 0.0f && settings.loss <= 1.0f);
+    n_assert(settings.latency >= 0.0 && settings.jitter >= 0.0);
+    this->settings = settings;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackNetwork::SetTime(Timing::Time time)
+{
+    n_assert(time >= this->time);
+    this->time = time;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackNetwork::Advance(Timing::Time delta)
+{
+    n_assert(delta >= 0.0);
+    this->time += delta;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackNetwork::ResetCounters()
+{
+    this->numMessagesSent = 0;
+    this->numBytesSent = 0;
+    this->numMessagesDropped = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+ConnectionId
+LoopbackNetwork::AllocateEndpoint(LoopbackTransport* transport)
+{
+    ConnectionId connection;
+    if (!this->freeEndpoints.IsEmpty())
+    {
+        connection = this->freeEndpoints.Back();
+        this->freeEndpoints.EraseBack();
+    }
+    else
+    {
+        this->endpoints.Append(Endpoint());
+        connection = (ConnectionId)this->endpoints.Size();
+    }
+
+    Endpoint& endpoint = this->endpoints[connection - 1];
+    endpoint.transport = transport;
+    endpoint.connectTime = this->time;
+    endpoint.linkFreeTime = this->time;
+    endpoint.lastReliableDelivery = this->time;
+    return connection;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackNetwork::FreeEndpoint(ConnectionId connection)
+{
+    Endpoint& endpoint = this->GetEndpoint(connection);
+    for (Packet const& packet : endpoint.incoming)
+    {
+        Memory::Free(Memory::NetworkHeap, packet.data);
+    }
+    endpoint.incoming.Clear();
+
+    // keep the packet array so its memory is reused by the next connection
+    Util::Array<Packet> incoming = std::move(endpoint.incoming);
+    endpoint = Endpoint();
+    endpoint.incoming = std::move(incoming);
+    this->freeEndpoints.Append(connection);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+LoopbackNetwork::Endpoint&
+LoopbackNetwork::GetEndpoint(ConnectionId connection)
+{
+    n_assert(this->IsValidEndpoint(connection));
+    return this->endpoints[connection - 1];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+LoopbackNetwork::IsValidEndpoint(ConnectionId connection) const
+{
+    return connection != InvalidConnectionId
+        && connection <= (ConnectionId)this->endpoints.Size()
+        && this->endpoints[connection - 1].transport != nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Each direction of a connection is a link with the configured bandwidth. A
+    message occupies the link until it is serialized, then arrives after the
+    latency plus a random jitter. Unreliable messages can therefore overtake
+    each other, reliable ones are held back until every earlier reliable
+    message has arrived.
+*/
+void
+LoopbackNetwork::Deliver(ConnectionId from, ubyte* data, SizeT size, bool reliable)
+{
+    this->numMessagesSent++;
+    this->numBytesSent += size;
+
+    Endpoint& source = this->GetEndpoint(from);
+    if (source.state != TransportConnectionState::Connected || !this->IsValidEndpoint(source.peer))
+    {
+        this->numMessagesDropped++;
+        Memory::Free(Memory::NetworkHeap, data);
+        return;
+    }
+
+    if (!reliable && this->settings.loss > 0.0f && this->Random() < this->settings.loss)
+    {
+        this->numMessagesDropped++;
+        Memory::Free(Memory::NetworkHeap, data);
+        return;
+    }
+
+    Timing::Time sendTime = Math::max(this->time, source.linkFreeTime);
+    if (this->settings.bandwidth > 0)
+    {
+        // a congested link drops unreliable traffic instead of queueing it forever
+        if (!reliable && sendTime - this->time > this->settings.maxSendQueueTime)
+        {
+            this->numMessagesDropped++;
+            Memory::Free(Memory::NetworkHeap, data);
+            return;
+        }
+        sendTime += (Timing::Time)size / (Timing::Time)this->settings.bandwidth;
+        source.linkFreeTime = sendTime;
+    }
+
+    Timing::Time deliveryTime = sendTime + this->settings.latency;
+    if (this->settings.jitter > 0.0)
+        deliveryTime += this->settings.jitter * this->Random();
+    if (reliable)
+    {
+        deliveryTime = Math::max(deliveryTime, source.lastReliableDelivery);
+        source.lastReliableDelivery = deliveryTime;
+    }
+
+    source.bytesOut += size;
+    source.packetsOut++;
+
+    Endpoint& target = this->GetEndpoint(source.peer);
+    Packet packet = { deliveryTime, data, size };
+    // most packets arrive in send order, search for the insertion point from the back
+    IndexT index = target.incoming.Size();
+    while (index > 0 && target.incoming[index - 1].deliveryTime > deliveryTime)
+        index--;
+    target.incoming.Insert(index, packet);
+}
+
+//------------------------------------------------------------------------------
+/**
+    xorshift32, deterministic for a given sequence of sends.
+*/
+float
+LoopbackNetwork::Random()
+{
+    uint32_t x = this->randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    this->randomState = x;
+    return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+LoopbackTransport::LoopbackTransport(LoopbackNetwork* network) :
+    network(network),
+    isOpen(false),
+    listenPort(0),
+    nextPollGroup(1)
+{
+    n_assert(network != nullptr);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+LoopbackTransport::~LoopbackTransport()
+{
+    n_assert(!this->isOpen);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+LoopbackTransport::Open()
+{
+    n_assert(!this->isOpen);
+    this->isOpen = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackTransport::Close()
+{
+    n_assert(this->isOpen);
+    if (this->listenPort != 0)
+        this->StopListening();
+
+    while (!this->connections.IsEmpty())
+        this->CloseConnection(this->connections.Back(), 0, nullptr, false);
+
+    for (OutgoingMessage const& msg : this->outgoingMessages)
+        Memory::Free(Memory::NetworkHeap, msg.data);
+    this->outgoingMessages.Clear();
+    this->statusChanges.Clear();
+    this->isOpen = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+LoopbackTransport::Listen(uint16_t port)
+{
+    n_assert(port != 0);
+    if (this->network->listeners.Contains(port))
+        return false;
+    this->network->listeners.Add(port, this);
+    this->listenPort = port;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackTransport::StopListening()
+{
+    n_assert(this->listenPort != 0);
+    this->network->listeners.Erase(this->listenPort);
+    this->listenPort = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+LoopbackTransport::AcceptConnection(ConnectionId connection)
+{
+    if (!this->network->IsValidEndpoint(connection))
+        return false;
+
+    LoopbackNetwork::Endpoint& endpoint = this->network->GetEndpoint(connection);
+    if (endpoint.transport != this || endpoint.state != TransportConnectionState::Connecting || !this->network->IsValidEndpoint(endpoint.peer))
+        return false;
+
+    ConnectionId const peer = endpoint.peer;
+    LoopbackTransport* peerTransport = this->network->GetEndpoint(peer).transport;
+    this->ChangeState(connection, TransportConnectionState::Connected, nullptr);
+    peerTransport->ChangeState(peer, TransportConnectionState::Connected, nullptr);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+PollGroupId
+LoopbackTransport::CreatePollGroup()
+{
+    return this->nextPollGroup++;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackTransport::DestroyPollGroup(PollGroupId group)
+{
+    for (ConnectionId connection : this->connections)
+    {
+        LoopbackNetwork::Endpoint& endpoint = this->network->GetEndpoint(connection);
+        if (endpoint.pollGroup == group)
+            endpoint.pollGroup = InvalidPollGroupId;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+LoopbackTransport::SetConnectionPollGroup(ConnectionId connection, PollGroupId group)
+{
+    if (!this->network->IsValidEndpoint(connection))
+        return false;
+    LoopbackNetwork::Endpoint& endpoint = this->network->GetEndpoint(connection);
+    if (endpoint.transport != this)
+        return false;
+    endpoint.pollGroup = group;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Like a real connection attempt this always returns a connection, a missing
+    listener is reported through RunCallbacks.
+*/
+ConnectionId
+LoopbackTransport::Connect(uint32_t ip, uint16_t port)
+{
+    n_assert(this->isOpen);
+    ConnectionId const connection = this->network->AllocateEndpoint(this);
+    this->connections.Append(connection);
+    this->ChangeState(connection, TransportConnectionState::Connecting, nullptr);
+
+    IndexT const listenerIndex = this->network->listeners.FindIndex(port);
+    if (listenerIndex == InvalidIndex)
+    {
+        this->ChangeState(connection, TransportConnectionState::ProblemDetectedLocally, "No server listening on port");
+        return connection;
+    }
+
+    LoopbackTransport* server = this->network->listeners.ValueAtIndex(listenerIndex);
+    ConnectionId const serverConnection = this->network->AllocateEndpoint(server);
+    server->connections.Append(serverConnection);
+    this->network->GetEndpoint(connection).peer = serverConnection;
+    this->network->GetEndpoint(serverConnection).peer = connection;
+    server->ChangeState(serverConnection, TransportConnectionState::Connecting, nullptr);
+    return connection;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Messages which are already in flight to the peer still arrive, the peer
+    is told about the close right away.
+*/
+void
+LoopbackTransport::CloseConnection(ConnectionId connection, int reason, char const* debug, bool linger)
+{
+    IndexT const index = this->connections.FindIndex(connection);
+    if (index == InvalidIndex)
+        return;
+    this->connections.EraseIndexSwap(index);
+
+    ConnectionId const peer = this->network->GetEndpoint(connection).peer;
+    if (this->network->IsValidEndpoint(peer))
+    {
+        LoopbackNetwork::Endpoint& peerEndpoint = this->network->GetEndpoint(peer);
+        peerEndpoint.peer = InvalidConnectionId;
+        if (peerEndpoint.state == TransportConnectionState::Connecting || peerEndpoint.state == TransportConnectionState::Connected)
+        {
+            peerEndpoint.transport->ChangeState(peer, TransportConnectionState::ClosedByPeer, debug != nullptr ? debug : "Closed by peer");
+            peerEndpoint.transport->statusChanges.Back().endReason = reason;
+        }
+    }
+    this->network->FreeEndpoint(connection);
+
+    // state changes of a connection that no longer exists are not reported
+    for (IndexT i = this->statusChanges.Size() - 1; i >= 0; i--)
+    {
+        if (this->statusChanges[i].connection == connection)
+            this->statusChanges.EraseIndex(i);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackTransport::Send(ConnectionId connection, void const* data, SizeT size, bool reliable)
+{
+    ubyte* copy = (ubyte*)Memory::Alloc(Memory::NetworkHeap, size);
+    Memory::Copy(data, copy, size);
+    this->outgoingMessages.Append({ connection, copy, size, reliable });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackTransport::Flush()
+{
+    for (OutgoingMessage const& msg : this->outgoingMessages)
+    {
+        if (this->network->IsValidEndpoint(msg.connection) && this->network->GetEndpoint(msg.connection).transport == this)
+        {
+            this->network->Deliver(msg.connection, msg.data, msg.size, msg.reliable);
+        }
+        else
+        {
+            Memory::Free(Memory::NetworkHeap, msg.data);
+        }
+    }
+    this->outgoingMessages.Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+LoopbackTransport::ReceiveReady(ConnectionId connection, TransportMessage* outMessages, SizeT maxMessages)
+{
+    LoopbackNetwork::Endpoint& endpoint = this->network->GetEndpoint(connection);
+    Timing::Time const now = this->network->time;
+
+    SizeT numReady = 0;
+    while (numReady < endpoint.incoming.Size() && numReady < maxMessages && endpoint.incoming[numReady].deliveryTime <= now)
+    {
+        LoopbackNetwork::Packet const& packet = endpoint.incoming[numReady];
+        TransportMessage& msg = outMessages[numReady];
+        msg.connection = connection;
+        msg.data = packet.data;
+        msg.size = packet.size;
+        msg.receiveTime = packet.deliveryTime;
+        msg.handle = packet.data;
+        endpoint.bytesIn += packet.size;
+        endpoint.packetsIn++;
+        numReady++;
+    }
+    if (numReady > 0)
+        endpoint.incoming.EraseRange(0, numReady);
+    return numReady;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+LoopbackTransport::ReceiveMessagesOnPollGroup(PollGroupId group, TransportMessage* outMessages, SizeT maxMessages)
+{
+    if (group == InvalidPollGroupId)
+        return -1;
+
+    SizeT numMessages = 0;
+    for (ConnectionId connection : this->connections)
+    {
+        if (numMessages == maxMessages)
+            break;
+        if (this->network->GetEndpoint(connection).pollGroup == group)
+            numMessages += this->ReceiveReady(connection, outMessages + numMessages, maxMessages - numMessages);
+    }
+    return numMessages;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+LoopbackTransport::ReceiveMessagesOnConnection(ConnectionId connection, TransportMessage* outMessages, SizeT maxMessages)
+{
+    if (!this->network->IsValidEndpoint(connection) || this->network->GetEndpoint(connection).transport != this)
+        return -1;
+    return this->ReceiveReady(connection, outMessages, maxMessages);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackTransport::ReleaseMessages(TransportMessage* messages, SizeT numMessages)
+{
+    for (IndexT i = 0; i < numMessages; i++)
+    {
+        Memory::Free(Memory::NetworkHeap, messages[i].handle);
+        messages[i].handle = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Rates are averages over the lifetime of the connection.
+*/
+bool
+LoopbackTransport::GetConnectionStats(ConnectionId connection, TransportConnectionStats& outStats)
+{
+    if (!this->network->IsValidEndpoint(connection))
+        return false;
+
+    LoopbackNetwork::Endpoint const& endpoint = this->network->GetEndpoint(connection);
+    if (endpoint.transport != this)
+        return false;
+
+    LoopbackNetwork::Settings const& settings = this->network->settings;
+    Timing::Time const now = this->network->time;
+    float const invElapsed = now > endpoint.connectTime ? (float)(1.0 / (now - endpoint.connectTime)) : 0.0f;
+
+    outStats = TransportConnectionStats();
+    outStats.pingMs = (int)((2.0 * settings.latency + settings.jitter) * 1000.0);
+    outStats.outBytesPerSec = (float)endpoint.bytesOut * invElapsed;
+    outStats.outPacketsPerSec = (float)endpoint.packetsOut * invElapsed;
+    outStats.inBytesPerSec = (float)endpoint.bytesIn * invElapsed;
+    outStats.inPacketsPerSec = (float)endpoint.packetsIn * invElapsed;
+    outStats.sendRateBytesPerSec = settings.bandwidth;
+    outStats.queueTime = Math::max(0.0, endpoint.linkFreeTime - now);
+    outStats.qualityLocal = 1.0f - settings.loss;
+    outStats.qualityRemote = 1.0f - settings.loss;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackTransport::ChangeState(ConnectionId connection, TransportConnectionState state, char const* debug)
+{
+    LoopbackNetwork::Endpoint& endpoint = this->network->GetEndpoint(connection);
+
+    TransportStatusChange change;
+    change.connection = connection;
+    change.oldState = endpoint.state;
+    change.state = state;
+    change.description.Format("loopback #%u", connection);
+    change.endReason = 0;
+    if (debug != nullptr)
+        change.endDebug = debug;
+    endpoint.state = state;
+    this->statusChanges.Append(change);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoopbackTransport::RunCallbacks(StatusChangedFunc const& func)
+{
+    // callbacks may close connections and queue new changes, those are reported on the next call
+    Util::Array<TransportStatusChange> changes = std::move(this->statusChanges);
+    this->statusChanges.Clear();
+    for (TransportStatusChange const& change : changes)
+    {
+        func(change);
+    }
+}
+
+} // namespace Multiplayer
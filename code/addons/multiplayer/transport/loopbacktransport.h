@@ -0,0 +1,231 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Multiplayer::LoopbackTransport
+
+    In-process transport. All loopback transports created on the same
+    LoopbackNetwork can connect to each other, a client connects to the
+    transport listening on the port it connects to, the ip is ignored.
+
+    The network simulates a one way latency with random jitter, loss of
+    unreliable messages and a per direction bandwidth limit. Reliable
+    messages are never lost and arrive in order. Time only advances when the
+    owner of the network calls Advance or SetTime, so a simulation can run
+    faster than real time and still be deterministic.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "transport.h"
+#include "util/array.h"
+#include "util/dictionary.h"
+
+namespace Multiplayer
+{
+
+class LoopbackTransport;
+
+//------------------------------------------------------------------------------
+/**
+*/
+class LoopbackNetwork
+{
+public:
+    struct Settings
+    {
+        /// one way latency in seconds
+        Timing::Time latency = 0.0;
+        /// maximum random one way delay added on top of the latency, in seconds
+        Timing::Time jitter = 0.0;
+        /// probability [0..1] that an unreliable message is lost
+        float loss = 0.0f;
+        /// bytes per second per connection and direction, 0 is unlimited
+        SizeT bandwidth = 0;
+        /// unreliable messages waiting longer than this for bandwidth are dropped
+        Timing::Time maxSendQueueTime = 1.0;
+    };
+
+    /// constructor
+    LoopbackNetwork();
+    /// destructor
+    ~LoopbackNetwork();
+
+    /// set simulation settings
+    void SetSettings(Settings const& settings);
+    /// get simulation settings
+    Settings const& GetSettings() const;
+    /// set the network time
+    void SetTime(Timing::Time time);
+    /// advance the network time
+    void Advance(Timing::Time delta);
+    /// get the network time
+    Timing::Time GetTime() const;
+
+    /// number of messages handed to the network
+    uint64_t GetNumMessagesSent() const;
+    /// number of bytes handed to the network
+    uint64_t GetNumBytesSent() const;
+    /// number of messages lost or dropped
+    uint64_t GetNumMessagesDropped() const;
+    /// reset message counters
+    void ResetCounters();
+
+private:
+    friend LoopbackTransport;
+
+    struct Packet
+    {
+        Timing::Time deliveryTime;
+        ubyte* data;
+        SizeT size;
+    };
+
+    struct Endpoint
+    {
+        LoopbackTransport* transport = nullptr;
+        ConnectionId peer = InvalidConnectionId;
+        TransportConnectionState state = TransportConnectionState::None;
+        PollGroupId pollGroup = InvalidPollGroupId;
+        /// time at which the outgoing link has sent everything queued so far
+        Timing::Time linkFreeTime = 0.0;
+        Timing::Time lastReliableDelivery = 0.0;
+        Timing::Time connectTime = 0.0;
+        uint64_t bytesOut = 0;
+        uint64_t bytesIn = 0;
+        uint64_t packetsOut = 0;
+        uint64_t packetsIn = 0;
+        /// sorted by delivery time
+        Util::Array<Packet> incoming;
+    };
+
+    /// allocate an endpoint owned by a transport
+    ConnectionId AllocateEndpoint(LoopbackTransport* transport);
+    /// free an endpoint and all packets queued for it
+    void FreeEndpoint(ConnectionId connection);
+    /// get an endpoint
+    Endpoint& GetEndpoint(ConnectionId connection);
+    /// return true if the connection is a live endpoint
+    bool IsValidEndpoint(ConnectionId connection) const;
+    /// send a message from an endpoint to its peer, takes ownership of data
+    void Deliver(ConnectionId from, ubyte* data, SizeT size, bool reliable);
+    /// random number in [0..1)
+    float Random();
+
+    Settings settings;
+    Timing::Time time;
+    uint32_t randomState;
+    Util::Array<Endpoint> endpoints;
+    Util::Array<ConnectionId> freeEndpoints;
+    Util::Dictionary<uint16_t, LoopbackTransport*> listeners;
+
+    uint64_t numMessagesSent;
+    uint64_t numBytesSent;
+    uint64_t numMessagesDropped;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+class LoopbackTransport : public Transport
+{
+public:
+    /// constructor
+    LoopbackTransport(LoopbackNetwork* network);
+    /// destructor
+    ~LoopbackTransport() override;
+
+    bool Open() override;
+    void Close() override;
+
+    bool Listen(uint16_t port) override;
+    void StopListening() override;
+    bool AcceptConnection(ConnectionId connection) override;
+    PollGroupId CreatePollGroup() override;
+    void DestroyPollGroup(PollGroupId group) override;
+    bool SetConnectionPollGroup(ConnectionId connection, PollGroupId group) override;
+
+    ConnectionId Connect(uint32_t ip, uint16_t port) override;
+    void CloseConnection(ConnectionId connection, int reason, char const* debug, bool linger) override;
+
+    void Send(ConnectionId connection, void const* data, SizeT size, bool reliable) override;
+    void Flush() override;
+
+    int ReceiveMessagesOnPollGroup(PollGroupId group, TransportMessage* outMessages, SizeT maxMessages) override;
+    int ReceiveMessagesOnConnection(ConnectionId connection, TransportMessage* outMessages, SizeT maxMessages) override;
+    void ReleaseMessages(TransportMessage* messages, SizeT numMessages) override;
+
+    bool GetConnectionStats(ConnectionId connection, TransportConnectionStats& outStats) override;
+    void RunCallbacks(StatusChangedFunc const& func) override;
+
+private:
+    friend LoopbackNetwork;
+
+    struct OutgoingMessage
+    {
+        ConnectionId connection;
+        ubyte* data;
+        SizeT size;
+        bool reliable;
+    };
+
+    /// queue a state change of one of our connections for RunCallbacks
+    void ChangeState(ConnectionId connection, TransportConnectionState state, char const* debug);
+    /// move ready packets of a connection into the output
+    SizeT ReceiveReady(ConnectionId connection, TransportMessage* outMessages, SizeT maxMessages);
+
+    LoopbackNetwork* network;
+    bool isOpen;
+    uint16_t listenPort;
+    PollGroupId nextPollGroup;
+    Util::Array<ConnectionId> connections;
+    Util::Array<OutgoingMessage> outgoingMessages;
+    Util::Array<TransportStatusChange> statusChanges;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline LoopbackNetwork::Settings const&
+LoopbackNetwork::GetSettings() const
+{
+    return this->settings;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Timing::Time
+LoopbackNetwork::GetTime() const
+{
+    return this->time;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+LoopbackNetwork::GetNumMessagesSent() const
+{
+    return this->numMessagesSent;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+LoopbackNetwork::GetNumBytesSent() const
+{
+    return this->numBytesSent;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+LoopbackNetwork::GetNumMessagesDropped() const
+{
+    return this->numMessagesDropped;
+}
+
+} // namespace Multiplayer
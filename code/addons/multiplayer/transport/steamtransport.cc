@@ -0,0 +1,316 @@
+//------------------------------------------------------------------------------
+//  @file steamtransport.cc
+//  @copyright (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "steamtransport.h"
+#include "GameNetworkingSockets/steam/steamnetworkingsockets.h"
+#include "GameNetworkingSockets/steam/isteamnetworkingutils.h"
+
+namespace Multiplayer
+{
+
+// HACK: GameNetworkingSockets callbacks carry no user pointer, only one transport runs its callbacks at a time
+static Transport::StatusChangedFunc const* statusChangedFunc = nullptr;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static TransportConnectionState
+ConvertState(ESteamNetworkingConnectionState state)
+{
+    switch (state)
+    {
+        case k_ESteamNetworkingConnectionState_Connecting:
+        case k_ESteamNetworkingConnectionState_FindingRoute:
+            return TransportConnectionState::Connecting;
+        case k_ESteamNetworkingConnectionState_Connected:
+            return TransportConnectionState::Connected;
+        case k_ESteamNetworkingConnectionState_ClosedByPeer:
+            return TransportConnectionState::ClosedByPeer;
+        case k_ESteamNetworkingConnectionState_ProblemDetectedLocally:
+            return TransportConnectionState::ProblemDetectedLocally;
+        default:
+            return TransportConnectionState::None;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SteamTransport::SteamTransport() :
+    netInterface(nullptr),
+    listenSock(k_HSteamListenSocket_Invalid)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SteamTransport::~SteamTransport()
+{
+    n_assert(this->netInterface == nullptr);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+SteamTransport::Open()
+{
+    n_assert(this->netInterface == nullptr);
+    this->netInterface = SteamNetworkingSockets();
+    if (this->netInterface == nullptr)
+    {
+        n_error("Failed to initialize SteamNetworkingSockets!\n");
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SteamTransport::Close()
+{
+    n_assert(this->netInterface != nullptr);
+    for (SteamNetworkingMessage_t* msg : this->outgoingMessages)
+        msg->Release();
+    this->outgoingMessages.Clear();
+    this->netInterface = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+SteamTransport::Listen(uint16_t port)
+{
+    SteamNetworkingIPAddr localAddr;
+    localAddr.Clear();
+    localAddr.m_port = port;
+
+    SteamNetworkingConfigValue_t opt;
+    // setup callback for changes in connections
+    opt.SetPtr(k_ESteamNetworkingConfig_Callback_ConnectionStatusChanged, (void*)OnConnectionStatusChanged);
+
+    this->listenSock = this->netInterface->CreateListenSocketIP(localAddr, 1, &opt);
+    return this->listenSock != k_HSteamListenSocket_Invalid;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SteamTransport::StopListening()
+{
+    this->netInterface->CloseListenSocket(this->listenSock);
+    this->listenSock = k_HSteamListenSocket_Invalid;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+SteamTransport::AcceptConnection(ConnectionId connection)
+{
+    if (this->netInterface->AcceptConnection(connection) != k_EResultOK)
+        return false;
+    SteamNetworkingUtils()->SetConnectionConfigValueInt32(connection, k_ESteamNetworkingConfig_SendBufferSize, 1_MB);
+    SteamNetworkingUtils()->SetConnectionConfigValueInt32(connection, k_ESteamNetworkingConfig_RecvBufferSize, 1_MB);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+PollGroupId
+SteamTransport::CreatePollGroup()
+{
+    return this->netInterface->CreatePollGroup();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SteamTransport::DestroyPollGroup(PollGroupId group)
+{
+    this->netInterface->DestroyPollGroup(group);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+SteamTransport::SetConnectionPollGroup(ConnectionId connection, PollGroupId group)
+{
+    return this->netInterface->SetConnectionPollGroup(connection, group);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+ConnectionId
+SteamTransport::Connect(uint32_t ip, uint16_t port)
+{
+    SteamNetworkingIPAddr serverAddr;
+    serverAddr.Clear();
+    serverAddr.SetIPv4(ip, port);
+
+    char address[SteamNetworkingIPAddr::k_cchMaxString];
+    serverAddr.ToString(address, sizeof(address), true);
+    n_printf("Trying to connect to server at %s...\n", address);
+
+    SteamNetworkingConfigValue_t opt;
+    opt.SetPtr(k_ESteamNetworkingConfig_Callback_ConnectionStatusChanged, (void*)OnConnectionStatusChanged);
+    return this->netInterface->ConnectByIPAddress(serverAddr, 1, &opt);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SteamTransport::CloseConnection(ConnectionId connection, int reason, char const* debug, bool linger)
+{
+    this->netInterface->CloseConnection(connection, reason, debug, linger);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SteamTransport::Send(ConnectionId connection, void const* data, SizeT size, bool reliable)
+{
+    SteamNetworkingMessage_t* msg = SteamNetworkingUtils()->AllocateMessage(size);
+    Memory::Copy(data, msg->m_pData, size);
+    msg->m_conn = connection;
+    msg->m_nFlags = reliable ? k_nSteamNetworkingSend_Reliable : k_nSteamNetworkingSend_Unreliable;
+    this->outgoingMessages.Append(msg);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SteamTransport::Flush()
+{
+    if (this->outgoingMessages.IsEmpty())
+        return;
+    // GameNetworkingSockets takes ownership of the messages
+    this->netInterface->SendMessages(this->outgoingMessages.Size(), this->outgoingMessages.Begin(), nullptr);
+    this->outgoingMessages.Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+SteamTransport::ConvertMessages(int numMessages, TransportMessage* outMessages)
+{
+    for (int i = 0; i < numMessages; i++)
+    {
+        SteamNetworkingMessage_t* msg = this->incomingMessages[i];
+        outMessages[i].connection = msg->m_conn;
+        outMessages[i].data = (ubyte*)msg->m_pData;
+        outMessages[i].size = msg->m_cbSize;
+        outMessages[i].receiveTime = (Timing::Time)msg->m_usecTimeReceived * 1e-6;
+        outMessages[i].handle = msg;
+    }
+    return numMessages;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+SteamTransport::ReceiveMessagesOnPollGroup(PollGroupId group, TransportMessage* outMessages, SizeT maxMessages)
+{
+    this->incomingMessages.Resize(maxMessages);
+    int numMessages = this->netInterface->ReceiveMessagesOnPollGroup(group, this->incomingMessages.Begin(), maxMessages);
+    return numMessages > 0 ? this->ConvertMessages(numMessages, outMessages) : numMessages;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+SteamTransport::ReceiveMessagesOnConnection(ConnectionId connection, TransportMessage* outMessages, SizeT maxMessages)
+{
+    this->incomingMessages.Resize(maxMessages);
+    int numMessages = this->netInterface->ReceiveMessagesOnConnection(connection, this->incomingMessages.Begin(), maxMessages);
+    return numMessages > 0 ? this->ConvertMessages(numMessages, outMessages) : numMessages;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SteamTransport::ReleaseMessages(TransportMessage* messages, SizeT numMessages)
+{
+    for (IndexT i = 0; i < numMessages; i++)
+    {
+        ((SteamNetworkingMessage_t*)messages[i].handle)->Release();
+        messages[i].handle = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+SteamTransport::GetConnectionStats(ConnectionId connection, TransportConnectionStats& outStats)
+{
+    SteamNetConnectionRealTimeStatus_t status;
+    EResult res = this->netInterface->GetConnectionRealTimeStatus(connection, &status, 0, nullptr);
+    if (res != k_EResultOK)
+        return false;
+
+    outStats.pingMs = status.m_nPing;
+    outStats.outBytesPerSec = status.m_flOutBytesPerSec;
+    outStats.outPacketsPerSec = status.m_flOutPacketsPerSec;
+    outStats.inBytesPerSec = status.m_flInBytesPerSec;
+    outStats.inPacketsPerSec = status.m_flInPacketsPerSec;
+    outStats.sendRateBytesPerSec = status.m_nSendRateBytesPerSecond;
+    outStats.pendingReliable = status.m_cbPendingReliable;
+    outStats.pendingUnreliable = status.m_cbPendingUnreliable;
+    outStats.sentUnackedReliable = status.m_cbSentUnackedReliable;
+    outStats.queueTime = (Timing::Time)status.m_usecQueueTime * 1e-6;
+    outStats.qualityLocal = status.m_flConnectionQualityLocal;
+    outStats.qualityRemote = status.m_flConnectionQualityRemote;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SteamTransport::RunCallbacks(StatusChangedFunc const& func)
+{
+    statusChangedFunc = &func;
+    this->netInterface->RunCallbacks();
+    statusChangedFunc = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SteamTransport::OnConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info)
+{
+    if (statusChangedFunc == nullptr)
+        return;
+
+    TransportStatusChange change;
+    change.connection = info->m_hConn;
+    change.state = ConvertState(info->m_info.m_eState);
+    change.oldState = ConvertState(info->m_eOldState);
+    change.description = info->m_info.m_szConnectionDescription;
+    change.endReason = info->m_info.m_eEndReason;
+    change.endDebug = info->m_info.m_szEndDebug;
+    (*statusChangedFunc)(change);
+}
+
+} // namespace Multiplayer
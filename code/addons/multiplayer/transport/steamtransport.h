@@ -0,0 +1,65 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Multiplayer::SteamTransport
+
+    Transport on top of GameNetworkingSockets. GameNetworkingSockets_Init
+    must have been called before the transport is opened.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "transport.h"
+#include "util/array.h"
+#include "GameNetworkingSockets/steam/steamnetworkingtypes.h"
+
+class ISteamNetworkingSockets;
+
+namespace Multiplayer
+{
+
+class SteamTransport : public Transport
+{
+public:
+    /// constructor
+    SteamTransport();
+    /// destructor
+    ~SteamTransport() override;
+
+    bool Open() override;
+    void Close() override;
+
+    bool Listen(uint16_t port) override;
+    void StopListening() override;
+    bool AcceptConnection(ConnectionId connection) override;
+    PollGroupId CreatePollGroup() override;
+    void DestroyPollGroup(PollGroupId group) override;
+    bool SetConnectionPollGroup(ConnectionId connection, PollGroupId group) override;
+
+    ConnectionId Connect(uint32_t ip, uint16_t port) override;
+    void CloseConnection(ConnectionId connection, int reason, char const* debug, bool linger) override;
+
+    void Send(ConnectionId connection, void const* data, SizeT size, bool reliable) override;
+    void Flush() override;
+
+    int ReceiveMessagesOnPollGroup(PollGroupId group, TransportMessage* outMessages, SizeT maxMessages) override;
+    int ReceiveMessagesOnConnection(ConnectionId connection, TransportMessage* outMessages, SizeT maxMessages) override;
+    void ReleaseMessages(TransportMessage* messages, SizeT numMessages) override;
+
+    bool GetConnectionStats(ConnectionId connection, TransportConnectionStats& outStats) override;
+    void RunCallbacks(StatusChangedFunc const& func) override;
+
+private:
+    /// convert received messages
+    int ConvertMessages(int numMessages, TransportMessage* outMessages);
+    /// called by GameNetworkingSockets from RunCallbacks
+    static void OnConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info);
+
+    ISteamNetworkingSockets* netInterface;
+    HSteamListenSocket listenSock;
+    Util::Array<SteamNetworkingMessage_t*> outgoingMessages;
+    Util::Array<SteamNetworkingMessage_t*> incomingMessages;
+};
+
+} // namespace Multiplayer
@@ -0,0 +1,145 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Multiplayer::Transport
+
+    Interface between the multiplayer server/client and the network.
+
+    The interface follows the connection model of GameNetworkingSockets:
+    connections are handles, messages are datagrams which are either
+    reliable or unreliable, a server groups connections into poll groups,
+    and connection state changes are reported from RunCallbacks.
+
+    SteamTransport talks to the network through GameNetworkingSockets,
+    LoopbackTransport connects servers and clients within the process and
+    simulates latency, loss and bandwidth.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/types.h"
+#include "util/string.h"
+#include "timing/time.h"
+#include <functional>
+
+namespace Multiplayer
+{
+
+typedef uint32_t ConnectionId;
+typedef uint32_t PollGroupId;
+constexpr ConnectionId InvalidConnectionId = 0;
+constexpr PollGroupId InvalidPollGroupId = 0;
+
+//------------------------------------------------------------------------------
+/**
+*/
+enum class TransportConnectionState
+{
+    None = 0,
+    Connecting,
+    Connected,
+    ClosedByPeer,
+    ProblemDetectedLocally
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+struct TransportStatusChange
+{
+    ConnectionId connection;
+    TransportConnectionState state;
+    TransportConnectionState oldState;
+    Util::String description;
+    int endReason;
+    Util::String endDebug;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+struct TransportConnectionStats
+{
+    int pingMs = 0;
+    float outBytesPerSec = 0.0f;
+    float outPacketsPerSec = 0.0f;
+    float inBytesPerSec = 0.0f;
+    float inPacketsPerSec = 0.0f;
+    int sendRateBytesPerSec = 0;
+    int pendingReliable = 0;
+    int pendingUnreliable = 0;
+    int sentUnackedReliable = 0;
+    Timing::Time queueTime = 0.0;
+    float qualityLocal = 1.0f;
+    float qualityRemote = 1.0f;
+};
+
+//------------------------------------------------------------------------------
+/**
+    A received message, owned by the transport until it is released.
+*/
+struct TransportMessage
+{
+    ConnectionId connection;
+    ubyte* data;
+    SizeT size;
+    /// receive time in seconds
+    Timing::Time receiveTime;
+    /// transport specific
+    void* handle;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+class Transport
+{
+public:
+    typedef std::function<void(TransportStatusChange const&)> StatusChangedFunc;
+
+    /// destructor
+    virtual ~Transport() {};
+
+    /// open the transport
+    virtual bool Open() = 0;
+    /// close the transport
+    virtual void Close() = 0;
+
+    /// start accepting connections on a port
+    virtual bool Listen(uint16_t port) = 0;
+    /// stop accepting connections
+    virtual void StopListening() = 0;
+    /// accept a connection reported as connecting
+    virtual bool AcceptConnection(ConnectionId connection) = 0;
+    /// create a poll group
+    virtual PollGroupId CreatePollGroup() = 0;
+    /// destroy a poll group
+    virtual void DestroyPollGroup(PollGroupId group) = 0;
+    /// move a connection into a poll group
+    virtual bool SetConnectionPollGroup(ConnectionId connection, PollGroupId group) = 0;
+
+    /// connect to a server, returns InvalidConnectionId on immediate failure
+    virtual ConnectionId Connect(uint32_t ip, uint16_t port) = 0;
+    /// close a connection
+    virtual void CloseConnection(ConnectionId connection, int reason, char const* debug, bool linger) = 0;
+
+    /// queue a message, the data is copied
+    virtual void Send(ConnectionId connection, void const* data, SizeT size, bool reliable) = 0;
+    /// hand all queued messages to the network in one batch
+    virtual void Flush() = 0;
+
+    /// receive messages from all connections in a poll group, returns number of messages or -1 on error
+    virtual int ReceiveMessagesOnPollGroup(PollGroupId group, TransportMessage* outMessages, SizeT maxMessages) = 0;
+    /// receive messages from a single connection, returns number of messages or -1 on error
+    virtual int ReceiveMessagesOnConnection(ConnectionId connection, TransportMessage* outMessages, SizeT maxMessages) = 0;
+    /// release received messages
+    virtual void ReleaseMessages(TransportMessage* messages, SizeT numMessages) = 0;
+
+    /// get connection statistics, returns false if the connection is unknown
+    virtual bool GetConnectionStats(ConnectionId connection, TransportConnectionStats& outStats) = 0;
+    /// report connection state changes since the last call
+    virtual void RunCallbacks(StatusChangedFunc const& func) = 0;
+};
+
+} // namespace Multiplayer
@@ -5,7 +5,12 @@
 #include "application/stdneb.h"
 #include "navigationmanager.h"
 #include "game/gameserver.h"
-#include "components/navigation.h"
+#include "game/api.h"
+#include "resources/resourceserver.h"
+#include "basegamefeature/components/basegamefeature.h"
+#include "basegamefeature/components/position.h"
+#include "navagentcontext.h"
+#include "recast/tilebuilder.h"
 
 namespace NavigationFeature
 {
@@ -31,69 +36,89 @@ NavigationManager::~NavigationManager()
 //------------------------------------------------------------------------------
 /**
 */
-void NavigationManager::InitCreateAgentProcessor()
+void
+NavigationManager::InitAgent(Game::World* world, Game::Entity entity, NavigationAgent* agent)
 {
-#if 0
-    Game::FilterCreateInfo filterInfo;
-    filterInfo.inclusive[0] = Game::GetComponentId("Owner");
-    filterInfo.access[0] = Game::AccessMode::READ;
-    filterInfo.inclusive[1] = Game::GetComponentId("WorldTransform");
-    filterInfo.access[1] = Game::AccessMode::READ;
-    filterInfo.inclusive[2] = Game::GetComponentId("AgentKind");
-    filterInfo.access[2] = Game::AccessMode::READ;
-    filterInfo.numInclusive = 3;
-
-    filterInfo.exclusive[0] = this->pids.navigationActor;
-    filterInfo.numExclusive = 1;
-
-    Game::Filter filter = Game::CreateFilter(filterInfo);
-
-    Game::ProcessorCreateInfo processorInfo;
-    processorInfo.async = false;
-    processorInfo.filter = filter;
-    processorInfo.name = "NavigationManager.CreateAgents"_atm;
-    processorInfo.OnBeginFrame = [](Game::World* world, Game::Dataset data)
+    if (agent->agentId != 0xFFFFFFFF)
     {
-        Game::OpBuffer opBuffer = Game::CreateOpBuffer(world);
-        
-        for (int v = 0; v < data.numViews; v++)
-        {
-            Game::Dataset::EntityTableView const& view = data.views[v];
-            Game::Entity const* const owners = (Game::Entity*)view.buffers[0];
-            Math::mat4 const* const transforms = (Math::mat4*)view.buffers[1];
-            Util::String const* const kinds = (Util::String*)view.buffers[2];
-            
-            for (IndexT i = 0; i < view.numInstances; ++i)
-            {
-                Game::Entity const& entity = owners[i];
-                Math::mat4 const& trans = transforms[i];
-                Util::String const& kind = kinds[i];
-                /*
-
-                Resources::CreateResource(res, "PHYS",
-                    [world, trans, &opBuffer, entity, staticPID](Resources::ResourceId id)
-                    {
-                        bool const dynamic = !Game::HasProperty(world, entity, staticPID);
-                        Physics::ActorId actorid = Physics::CreateActorInstance(id, trans, dynamic, Ids::Id32(entity));
-                        
-                        Game::Op::RegisterProperty regOp;
-                        regOp.entity = entity;
-                        regOp.pid = PhysicsManager::Singleton->pids.physicsActor;
-                        regOp.value = &actorid;
-                        Game::AddOp(opBuffer, regOp);
-
-                    }, nullptr, true);
-
-                */
-            }
-        }
+        // Assumes the agent has been setup externally, just skip it.
+        return;
+    }
+    if (!agent->navMesh.IsValid())
+    {
+        n_warning("NavigationManager: entity has a NavigationAgent without a nav mesh\n");
+        return;
+    }
+
+    Resources::ResourceId const mesh = Resources::CreateResource(agent->navMesh, "NAV", nullptr, nullptr, true);
+    if (mesh == Resources::InvalidResourceId)
+    {
+        n_warning("NavigationManager: failed to load nav mesh '%s'\n", agent->navMesh.Value());
+        return;
+    }
+
+    Navigation::AgentContext::AgentParams params;
+    params.radius = agent->radius;
+    params.maxSpeed = agent->maxSpeed;
+    params.maxAcceleration = agent->maxAcceleration;
+    Math::point const position = world->GetComponent<Game::Position>(entity);
+    agent->agentId = Navigation::AgentContext::CreateAgent(mesh, position, params).id;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static Navigation::TileBuilder*
+GetTileBuilder(uint navMeshId)
+{
+    if (navMeshId == 0xFFFFFFFF)
+        return nullptr;
+    return Resources::GetStreamLoader<Navigation::StreamNavMeshCache>()->GetTileBuilder(Navigation::NavMeshId(Ids::Id32(navMeshId)));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+RemoveObstacle(NavigationObstacle& obstacle)
+{
+    Navigation::TileBuilder* const tiles = GetTileBuilder(obstacle.navMeshId);
+    if (tiles != nullptr && obstacle.obstacleId != 0xFFFFFFFF)
+        tiles->RemoveObstacle(obstacle.obstacleId);
+    obstacle.obstacleId = 0xFFFFFFFF;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NavigationManager::InitObstacle(Game::World* world, Game::Entity entity, NavigationObstacle* obstacle)
+{
+    if (obstacle->obstacleId != 0xFFFFFFFF)
+        return;
+    if (!obstacle->navMesh.IsValid())
+    {
+        n_warning("NavigationManager: entity has a NavigationObstacle without a nav mesh\n");
+        return;
+    }
+
+    Resources::ResourceId const mesh = Resources::CreateResource(obstacle->navMesh, "NAV", nullptr, nullptr, true);
+    if (mesh == Resources::InvalidResourceId)
+    {
+        n_warning("NavigationManager: failed to load nav mesh '%s'\n", obstacle->navMesh.Value());
+        return;
+    }
+    Navigation::NavMeshId const navMesh = mesh;
+    Navigation::TileBuilder* const tiles = Resources::GetStreamLoader<Navigation::StreamNavMeshCache>()->GetTileBuilder(navMesh);
+    if (tiles == nullptr)
+    {
+        n_warning("NavigationManager: nav mesh '%s' has no tile size, obstacles can't be cut out\n", obstacle->navMesh.Value());
+        return;
+    }
 
-        // execute ops
-        Game::Dispatch(opBuffer);
-    };
-    
-    Game::ProcessorHandle pHandle = Game::CreateProcessor(processorInfo);
-#endif
+    Math::point const position = world->GetComponent<Game::Position>(entity);
+    obstacle->navMeshId = navMesh.id;
+    obstacle->obstacleId = tiles->AddObstacle(Math::bbox(position, Math::vector(obstacle->halfExtents))).id;
 }
 
 //------------------------------------------------------------------------------
@@ -102,59 +127,108 @@ void NavigationManager::InitCreateAgentProcessor()
 void
 NavigationManager::OnDecay()
 {
-    /*
-    Game::PropertyDecayBuffer const decayBuffer = Game::GetDecayBuffer(Singleton->pids.physicsActor);
-    Physics::ActorId* data = (Physics::ActorId*)decayBuffer.buffer;
+    Game::World* world = Game::GetWorld(WORLD_DEFAULT);
+    Game::ComponentDecayBuffer const decayBuffer = world->GetDecayBuffer(Game::GetComponentId<NavigationAgent>());
+    NavigationAgent* data = (NavigationAgent*)decayBuffer.buffer;
     for (int i = 0; i < decayBuffer.size; i++)
     {
-        Physics::DestroyActorInstance(data[i]);
+        Navigation::AgentContext::DestroyAgent(data[i].agentId);
+    }
+
+    Game::ComponentDecayBuffer const obstacleBuffer = world->GetDecayBuffer(Game::GetComponentId<NavigationObstacle>());
+    NavigationObstacle* obstacles = (NavigationObstacle*)obstacleBuffer.buffer;
+    for (int i = 0; i < obstacleBuffer.size; i++)
+    {
+        RemoveObstacle(obstacles[i]);
     }
-    */
 }
 
 //------------------------------------------------------------------------------
 /**
+    Requests only go out when the target has moved, see AgentContext::SetTarget().
 */
-void NavigationManager::InitUpdateAgentTransformProcessor()
+void
+SetAgentTargets(Game::World* world, NavigationAgent const& agent, NavigationTarget const& target)
 {
-#if 0
-    Game::FilterCreateInfo filterInfo;
-    filterInfo.inclusive[0] = this->pids.navigationActor;
-    filterInfo.access[0] = Game::AccessMode::READ;
-    filterInfo.inclusive[1] = Game::GetComponentId("WorldTransform"_atm);
-    filterInfo.access[1] = Game::AccessMode::WRITE;
-    filterInfo.numInclusive = 2;
-
-    filterInfo.exclusive[0] = Game::GetComponentId("Static");
-    filterInfo.numExclusive = 1;
-
-    Game::Filter filter = Game::CreateFilter(filterInfo);
-
-    Game::ProcessorCreateInfo processorInfo;
-    processorInfo.async = false;
-    processorInfo.filter = filter;
-    processorInfo.name = "PhysicsManager.PollTransforms"_atm;
-    processorInfo.OnFrame = [](Game::World* world, Game::Dataset data)
+    if (Navigation::AgentContext::IsValid(agent.agentId))
     {
-        /*
-        for (int v = 0; v < data.numViews; v++)
-        {
-            Game::Dataset::CategoryTableView const& view = data.views[v];
-            Physics::ActorId const* const actorIdBuffer = (Physics::ActorId*)view.buffers[0];
-            Math::mat4* const transforms = (Math::mat4*)view.buffers[1];
-
-            for (IndexT i = 0; i < view.numInstances; ++i)
-            {
-                Physics::ActorId const actorid = actorIdBuffer[i];
-                Math::mat4& transform = transforms[i];
-                transform = Physics::ActorContext::GetTransform(actorid);
-            }
-        }
-        */
-    };
+        Navigation::AgentContext::SetTarget(agent.agentId, target.position);
+    }
+}
 
-    Game::ProcessorHandle pHandle = Game::CreateProcessor(processorInfo);
-#endif
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ClearAgentTargets(Game::World* world, NavigationAgent const& agent)
+{
+    if (Navigation::AgentContext::IsValid(agent.agentId))
+    {
+        Navigation::AgentContext::ClearTarget(agent.agentId);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ReadAgentPositions(Game::World* world, NavigationAgent const& agent, Game::Position& position)
+{
+    if (Navigation::AgentContext::IsValid(agent.agentId))
+    {
+        Math::point const pos = Navigation::AgentContext::GetPosition(agent.agentId);
+        position = Math::vec3(pos.x, pos.y, pos.z);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Tiny moves are ignored by the tile builder, so obstacles which only
+    jitter don't keep their tiles busy.
+*/
+void
+MoveObstacles(Game::World* world, NavigationObstacle const& obstacle, Game::Position const& position)
+{
+    Navigation::TileBuilder* const tiles = GetTileBuilder(obstacle.navMeshId);
+    if (tiles != nullptr && obstacle.obstacleId != 0xFFFFFFFF)
+    {
+        tiles->MoveObstacle(obstacle.obstacleId, Math::bbox(Math::point(position), Math::vector(obstacle.halfExtents)));
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    The agents are moved by the feature unit at the beginning of the frame,
+    so targets set by this frame's processors are picked up by the next move.
+*/
+void
+NavigationManager::OnActivate()
+{
+    Game::Manager::OnActivate();
+    Game::World* world = Game::GetWorld(WORLD_DEFAULT);
+
+    Game::ProcessorBuilder(world, "NavigationManager.SetAgentTargets"_atm)
+        .On("OnBeginFrame")
+        .Func(SetAgentTargets)
+        .Build();
+
+    Game::ProcessorBuilder(world, "NavigationManager.ClearAgentTargets"_atm)
+        .Excluding<NavigationTarget>()
+        .On("OnBeginFrame")
+        .Func(ClearAgentTargets)
+        .Build();
+
+    Game::ProcessorBuilder(world, "NavigationManager.ReadAgentPositions"_atm)
+        .Excluding<Game::Static>()
+        .On("OnFrame")
+        .Func(ReadAgentPositions)
+        .Build();
+
+    Game::ProcessorBuilder(world, "NavigationManager.MoveObstacles"_atm)
+        .Excluding<Game::Static>()
+        .On("OnFrame")
+        .Func(MoveObstacles)
+        .Build();
 }
 
 //------------------------------------------------------------------------------
@@ -163,31 +237,41 @@ void NavigationManager::InitUpdateAgentTransformProcessor()
 void
 NavigationManager::OnCleanup(Game::World* world)
 {
-#if 0
     n_assert(NavigationManager::HasInstance());
-    Game::FilterCreateInfo filterInfo;
-    filterInfo.inclusive[0] = Singleton->pids.navigationActor;
+    Game::FilterBuilder::FilterCreateInfo filterInfo;
+    filterInfo.inclusive[0] = Game::GetComponentId<NavigationAgent>();
     filterInfo.access[0] = Game::AccessMode::WRITE;
     filterInfo.numInclusive = 1;
 
-    Game::Filter filter = Game::CreateFilter(filterInfo);
-    Game::Dataset data = Game::Query(world, filter);
+    Game::Filter filter = Game::FilterBuilder::CreateFilter(filterInfo);
+    Game::Dataset data = world->Query(filter);
     for (int v = 0; v < data.numViews; v++)
     {
-        /*
-        Game::Dataset::CategoryTableView const& view = data.views[v];
-        Physics::ActorId* const actors = (Physics::ActorId*)view.buffers[0];
+        Game::Dataset::View const& view = data.views[v];
+        NavigationAgent* const agents = (NavigationAgent*)view.buffers[0];
+        for (IndexT i = 0; i < view.numInstances; ++i)
+        {
+            Navigation::AgentContext::DestroyAgent(agents[i].agentId);
+            agents[i].agentId = 0xFFFFFFFF;
+        }
+    }
+
+    Game::DestroyFilter(filter);
 
+    filterInfo.inclusive[0] = Game::GetComponentId<NavigationObstacle>();
+    filter = Game::FilterBuilder::CreateFilter(filterInfo);
+    data = world->Query(filter);
+    for (int v = 0; v < data.numViews; v++)
+    {
+        Game::Dataset::View const& view = data.views[v];
+        NavigationObstacle* const obstacles = (NavigationObstacle*)view.buffers[0];
         for (IndexT i = 0; i < view.numInstances; ++i)
         {
-            Physics::ActorId const& actorid = actors[i];
-            Physics::DestroyActorInstance(actorid);
+            RemoveObstacle(obstacles[i]);
         }
-        */
     }
 
     Game::DestroyFilter(filter);
-#endif
 }
 
-} // namespace PhysicsFeature
+} // namespace NavigationFeature
@@ -3,6 +3,11 @@
 /**
     @class  NavigationFeature::NavigationManager
 
+    Creates crowd agents for entities with a NavigationAgent, passes the
+    NavigationTarget of the entities on as path requests, and writes the
+    agent positions back. Entities with a NavigationObstacle are cut out of
+    their tiled nav mesh, the tiles around them are rebuilt when they move.
+
     @copyright
     (C) 2022 Individual contributors, see AUTHORS file
 */
@@ -11,6 +16,9 @@
 #include "core/singleton.h"
 #include "game/manager.h"
 #include "game/category.h"
+#include "game/entity.h"
+#include "game/world.h"
+#include "components/navigation.h"
 
 namespace NavigationFeature
 {
@@ -20,23 +28,19 @@ class NavigationManager : public Game::Manager
     __DeclareClass(NavigationManager)
     __DeclareSingleton(NavigationManager);
 public:
-    
-    struct Pids
-    {
-        Game::ComponentId navigationActor;
-    } pids;
-private:
     /// constructor
     NavigationManager();
     /// destructor
     ~NavigationManager();
 
-    void InitCreateAgentProcessor();
-    void InitUpdateAgentTransformProcessor();
-
+    void OnActivate() override;
     void OnDecay() override;
-
     void OnCleanup(Game::World* world) override;
+
+    /// create the crowd agent of an entity
+    static void InitAgent(Game::World* world, Game::Entity entity, NavigationAgent* agent);
+    /// add the obstacle of an entity to its nav mesh
+    static void InitObstacle(Game::World* world, Game::Entity entity, NavigationObstacle* obstacle);
 };
 
 } // namespace NavigationFeature
@@ -4,3 +4,981 @@
 //------------------------------------------------------------------------------
 #include "application/stdneb.h"
 #include "navagentcontext.h"
+#include "util/array.h"
+#include "util/fixedarray.h"
+#include "util/flathashtable.h"
+#include "math/scalar.h"
+#include "math/vec4.h"
+#include "jobs2/jobs2.h"
+#include "threading/event.h"
+#include "profiling/profiling.h"
+#include "resources/resourceserver.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+
+namespace Navigation
+{
+
+namespace
+{
+
+/// how far agents keep apart in addition to their radii
+const float SeparationMargin = 0.2f;
+/// strength of the separation force relative to the max speed
+const float SeparationWeight = 2.0f;
+/// agents slow down within this many radii of the end of their path
+const float SlowDownRadii = 2.0f;
+/// every query slot gets at least this many iterations per frame
+const int MinIterationsPerSlot = 32;
+/// search box around request positions when looking for the polygon they are on
+const float PolyExtents[3] = { 2.0f, 4.0f, 2.0f };
+/// padding of the sorted neighbour arrays, far enough away to never interact
+const float FarAway = 1.0e15f;
+
+/// a path search, captured on the main thread
+struct PathRequest
+{
+    CrowdAgentId agent;
+    uint serial;
+    NavMeshId mesh;
+    const dtNavMesh* navMesh;
+    float start[3];
+    float end[3];
+};
+
+/// outcome of a path search
+struct PathResult
+{
+    CrowdAgentId agent;
+    uint serial;
+    bool success;
+    SizeT numCorners;
+    float corners[AgentContext::MaxCorners * 3];
+};
+
+/// a corridor between two polygons
+struct Corridor
+{
+    NavMeshId mesh;
+    uint64_t key;
+    Util::Array<dtPolyRef> polys;
+};
+
+/// a query and the requests it works on, only ever touched by one job at a time
+struct QuerySlot
+{
+    dtNavMeshQuery* query = nullptr;
+    const dtNavMesh* navMesh = nullptr;
+    /// must outlive sliced searches
+    dtQueryFilter filter;
+    Util::Array<PathRequest> requests;
+    IndexT nextRequest = 0;
+
+    bool searching = false;
+    PathRequest current;
+    dtPolyRef startRef;
+    dtPolyRef endRef;
+    float startPos[3];
+    float endPos[3];
+    dtPolyRef polys[AgentContext::MaxCorridorPolys];
+
+    Util::Array<PathResult> results;
+    /// complete corridors found this frame, added to the cache on the main thread
+    Util::Array<Corridor> solved;
+};
+
+/// everything about an agent the separation pass doesn't look at
+struct Agent
+{
+    CrowdAgentId id;
+    NavMeshId mesh;
+    const dtNavMesh* navMesh;
+    Math::point target;
+    AgentContext::PathState state;
+    /// bumped by every request, results for older requests are dropped
+    uint serial;
+    /// set by the steering jobs when the corners ran out before the target
+    bool needsPath;
+    SizeT numCorners;
+    IndexT corner;
+    float corners[AgentContext::MaxCorners * 3];
+};
+
+struct
+{
+    Ids::IdGenerationPool idPool;
+    Util::Array<IndexT> agentIndices;
+    Util::Array<Agent> agents;
+
+    // steering state, one entry per agent
+    Util::Array<float> posX;
+    Util::Array<float> posY;
+    Util::Array<float> posZ;
+    Util::Array<float> velX;
+    Util::Array<float> velZ;
+    Util::Array<float> radius;
+    Util::Array<float> maxSpeed;
+    Util::Array<float> maxAcceleration;
+
+    // hashed grid, agents sorted by cell, sorted arrays are padded to a multiple of 4
+    float cellSize = 1.0f;
+    uint cellMask = 0;
+    Util::Array<uint> agentCells;
+    Util::Array<uint> cellStart;
+    Util::Array<uint> cellCursor;
+    Util::Array<float> sortedX;
+    Util::Array<float> sortedZ;
+    Util::Array<float> sortedRadius;
+
+    Util::FixedArray<QuerySlot> slots;
+    Util::Array<IndexT> busySlots;
+    SizeT maxIterationsPerFrame = 4096;
+
+    // corridors by start and end polygon, replaced in FIFO order
+    Util::FlatHashTable<uint64_t, IndexT> pathCacheIndex;
+    Util::Array<Corridor> pathCache;
+    IndexT nextCachedPath = 0;
+} crowd;
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+CorridorKey(dtPolyRef start, dtPolyRef end)
+{
+    return (uint64_t(start) << 32) | uint64_t(end);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint
+CellHash(int x, int z)
+{
+    return ((uint)x * 73856093u ^ (uint)z * 19349663u) & crowd.cellMask;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Only reads data which the main thread doesn't change while jobs run.
+*/
+inline bool
+IsCurrent(const PathRequest& request)
+{
+    return crowd.idPool.IsValid(request.agent.id)
+        && crowd.agents[crowd.agentIndices[request.agent.index]].serial == request.serial;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+RequestPath(IndexT i)
+{
+    Agent& agent = crowd.agents[i];
+    agent.serial++;
+    agent.state = AgentContext::Requested;
+    agent.needsPath = false;
+
+    PathRequest request;
+    request.agent = agent.id;
+    request.serial = agent.serial;
+    request.mesh = agent.mesh;
+    request.navMesh = agent.navMesh;
+    request.start[0] = crowd.posX[i];
+    request.start[1] = crowd.posY[i];
+    request.start[2] = crowd.posZ[i];
+    request.end[0] = agent.target.x;
+    request.end[1] = agent.target.y;
+    request.end[2] = agent.target.z;
+
+    // the slot with the shortest queue takes it
+    IndexT best = 0;
+    SizeT bestPending = INT_MAX;
+    for (IndexT s = 0; s < crowd.slots.Size(); s++)
+    {
+        SizeT const pending = crowd.slots[s].requests.Size() - crowd.slots[s].nextRequest;
+        if (pending < bestPending)
+        {
+            best = s;
+            bestPending = pending;
+        }
+    }
+    crowd.slots[best].requests.Append(request);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Turns the corridor in the slot into a straight path.
+*/
+void
+FinishPath(QuerySlot& slot, int numPolys)
+{
+    PathResult& result = slot.results.Emplace();
+    result.agent = slot.current.agent;
+    result.serial = slot.current.serial;
+    result.success = false;
+    result.numCorners = 0;
+    if (numPolys == 0)
+        return;
+
+    // a partial corridor ends at the polygon closest to the target
+    float end[3] = { slot.endPos[0], slot.endPos[1], slot.endPos[2] };
+    if (slot.polys[numPolys - 1] != slot.endRef)
+        slot.query->closestPointOnPoly(slot.polys[numPolys - 1], slot.endPos, end, nullptr);
+
+    int numCorners = 0;
+    dtStatus const status = slot.query->findStraightPath(
+        slot.startPos, end, slot.polys, numPolys,
+        result.corners, nullptr, nullptr, &numCorners, AgentContext::MaxCorners
+    );
+    if (dtStatusSucceed(status) && numCorners > 0)
+    {
+        result.success = true;
+        result.numCorners = numCorners;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Works through the requests of a slot until the iteration budget is spent.
+    A search which doesn't finish stays in the query and continues next frame.
+*/
+void
+SolvePaths(QuerySlot& slot, int budget)
+{
+    while (budget > 0)
+    {
+        if (!slot.searching)
+        {
+            if (slot.nextRequest == slot.requests.Size())
+                break;
+            slot.current = slot.requests[slot.nextRequest++];
+            if (!IsCurrent(slot.current))
+                continue;
+
+            if (slot.navMesh != slot.current.navMesh)
+            {
+                // only resets the node pool if it is big enough already
+                slot.query->init(slot.current.navMesh, MAX_NAV_NODES);
+                slot.navMesh = slot.current.navMesh;
+            }
+
+            budget--;
+            slot.startRef = 0;
+            slot.endRef = 0;
+            slot.query->findNearestPoly(slot.current.start, PolyExtents, &slot.filter, &slot.startRef, slot.startPos);
+            slot.query->findNearestPoly(slot.current.end, PolyExtents, &slot.filter, &slot.endRef, slot.endPos);
+            if (slot.startRef == 0 || slot.endRef == 0)
+            {
+                FinishPath(slot, 0);
+                continue;
+            }
+
+            // the cache is only written on the main thread after all searches are done
+            uint64_t const key = CorridorKey(slot.startRef, slot.endRef);
+            IndexT const cached = crowd.pathCacheIndex.FindIndex(key);
+            if (cached != InvalidIndex)
+            {
+                Corridor const& corridor = crowd.pathCache[crowd.pathCacheIndex.ValueAtIndex(key, cached)];
+                if (corridor.mesh == slot.current.mesh)
+                {
+                    Memory::Copy(corridor.polys.Begin(), slot.polys, corridor.polys.ByteSize());
+                    FinishPath(slot, corridor.polys.Size());
+                    continue;
+                }
+            }
+
+            slot.query->initSlicedFindPath(slot.startRef, slot.endRef, slot.startPos, slot.endPos, &slot.filter);
+            slot.searching = true;
+        }
+
+        int iterations = 0;
+        dtStatus const status = slot.query->updateSlicedFindPath(budget, &iterations);
+        budget -= Math::max(iterations, 1);
+        if (dtStatusInProgress(status))
+            break;
+        slot.searching = false;
+
+        int numPolys = 0;
+        if (dtStatusSucceed(status))
+            slot.query->finalizeSlicedFindPath(slot.polys, &numPolys, AgentContext::MaxCorridorPolys);
+
+        // partial corridors depend on how far the search got, don't keep them
+        if (numPolys > 0 && slot.polys[numPolys - 1] == slot.endRef)
+        {
+            Corridor& corridor = slot.solved.Emplace();
+            corridor.mesh = slot.current.mesh;
+            corridor.key = CorridorKey(slot.startRef, slot.endRef);
+            corridor.polys.Clear();
+            corridor.polys.AppendArray(slot.polys, numPolys);
+        }
+        FinishPath(slot, numPolys);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+CacheCorridor(Corridor& corridor)
+{
+    IndexT const existing = crowd.pathCacheIndex.FindIndex(corridor.key);
+    if (existing != InvalidIndex)
+    {
+        Corridor& cached = crowd.pathCache[crowd.pathCacheIndex.ValueAtIndex(corridor.key, existing)];
+        cached.mesh = corridor.mesh;
+        cached.polys = std::move(corridor.polys);
+        return;
+    }
+
+    Corridor& cached = crowd.pathCache[crowd.nextCachedPath];
+    if (cached.mesh != InvalidNavMeshId)
+        crowd.pathCacheIndex.Erase(cached.key);
+    cached.mesh = corridor.mesh;
+    cached.key = corridor.key;
+    cached.polys = std::move(corridor.polys);
+    crowd.pathCacheIndex.Add(cached.key, crowd.nextCachedPath);
+    crowd.nextCachedPath = (crowd.nextCachedPath + 1) % AgentContext::MaxCachedPaths;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Sorts the agents into a hashed grid. Cells are big enough that every
+    agent within separation reach is in one of the 3x3 cells around an agent.
+*/
+void
+BuildGrid()
+{
+    N_SCOPE(BuildAgentGrid, Navigation);
+    SizeT const numAgents = crowd.agents.Size();
+
+    float maxRadius = 0.0f;
+    for (IndexT i = 0; i < numAgents; i++)
+        maxRadius = Math::max(maxRadius, crowd.radius[i]);
+    crowd.cellSize = Math::max(maxRadius * 2.0f + SeparationMargin, 0.5f);
+
+    SizeT numCells = 64;
+    while (numCells < numAgents * 2)
+        numCells <<= 1;
+    crowd.cellMask = numCells - 1;
+
+    crowd.cellStart.Clear();
+    crowd.cellStart.Resize(numCells + 1, 0u);
+    crowd.agentCells.Resize(numAgents);
+    float const invCellSize = 1.0f / crowd.cellSize;
+    for (IndexT i = 0; i < numAgents; i++)
+    {
+        uint const cell = CellHash((int)Math::floor(crowd.posX[i] * invCellSize), (int)Math::floor(crowd.posZ[i] * invCellSize));
+        crowd.agentCells[i] = cell;
+        crowd.cellStart[cell + 1]++;
+    }
+    for (IndexT c = 0; c < numCells; c++)
+        crowd.cellStart[c + 1] += crowd.cellStart[c];
+
+    SizeT const paddedSize = (SizeT)Memory::align(numAgents, 4) + 4;
+    crowd.sortedX.Clear();
+    crowd.sortedX.Resize(paddedSize, FarAway);
+    crowd.sortedZ.Clear();
+    crowd.sortedZ.Resize(paddedSize, FarAway);
+    crowd.sortedRadius.Clear();
+    crowd.sortedRadius.Resize(paddedSize, 0.0f);
+    crowd.cellCursor = crowd.cellStart;
+    for (IndexT i = 0; i < numAgents; i++)
+    {
+        uint const slot = crowd.cellCursor[crowd.agentCells[i]]++;
+        crowd.sortedX[slot] = crowd.posX[i];
+        crowd.sortedZ[slot] = crowd.posZ[i];
+        crowd.sortedRadius[slot] = crowd.radius[i];
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Sums the separation force from all agents in the 3x3 cells around a
+    position, four candidates at a time. The agent itself is skipped by the
+    distance check.
+*/
+void
+Separation(float x, float z, float radius, float& outX, float& outZ)
+{
+    int const cellX = (int)Math::floor(x / crowd.cellSize);
+    int const cellZ = (int)Math::floor(z / crowd.cellSize);
+
+    Math::vec4 const posX(x);
+    Math::vec4 const posZ(z);
+    Math::vec4 const reach(radius + SeparationMargin);
+    Math::vec4 const epsilon(1.0e-6f);
+    Math::vec4 const zero(0.0f);
+    Math::vec4 const one(1.0f);
+    Math::vec4 forceX(0.0f);
+    Math::vec4 forceZ(0.0f);
+
+    // neighbouring cells can hash to the same bucket, which must only be visited once
+    uint visited[9];
+    SizeT numVisited = 0;
+    for (int dz = -1; dz <= 1; dz++)
+    {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            uint const cell = CellHash(cellX + dx, cellZ + dz);
+            bool seen = false;
+            for (IndexT v = 0; v < numVisited; v++)
+                seen |= visited[v] == cell;
+            if (seen)
+                continue;
+            visited[numVisited++] = cell;
+
+            uint const begin = crowd.cellStart[cell];
+            uint const end = crowd.cellStart[cell + 1];
+            Math::vec4 const last((float)end);
+            for (uint j = begin; j < end; j += 4)
+            {
+                Math::vec4 otherX, otherZ, otherRadius;
+                otherX.loadu(&crowd.sortedX[j]);
+                otherZ.loadu(&crowd.sortedZ[j]);
+                otherRadius.loadu(&crowd.sortedRadius[j]);
+
+                Math::vec4 const diffX = posX - otherX;
+                Math::vec4 const diffZ = posZ - otherZ;
+                Math::vec4 const distSq = Math::multiplyadd(diffZ, diffZ, diffX * diffX);
+
+                // lanes past the end of the cell belong to other cells
+                Math::vec4 const lane((float)j, (float)j + 1.0f, (float)j + 2.0f, (float)j + 3.0f);
+                Math::vec4 const valid = Math::less(lane, last) * Math::greater(distSq, epsilon);
+
+                Math::vec4 const safeDistSq = Math::maximize(distSq, epsilon);
+                Math::vec4 const invDist = _mm_rsqrt_ps(safeDistSq.vec);
+                Math::vec4 const dist = safeDistSq * invDist;
+                Math::vec4 const weight = Math::maximize(zero, one - dist * Math::reciprocal(reach + otherRadius)) * valid;
+                forceX = Math::multiplyadd(diffX * invDist, weight, forceX);
+                forceZ = Math::multiplyadd(diffZ * invDist, weight, forceZ);
+            }
+        }
+    }
+    outX = forceX.x + forceX.y + forceX.z + forceX.w;
+    outZ = forceZ.x + forceZ.y + forceZ.z + forceZ.w;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Steers an agent towards its next corner, away from its neighbours, and
+    moves it. Only writes state of this agent, neighbours are read from the
+    sorted copies.
+*/
+void
+Steer(IndexT i, float timeStep)
+{
+    Agent& agent = crowd.agents[i];
+    float const x = crowd.posX[i];
+    float const z = crowd.posZ[i];
+    float const radius = crowd.radius[i];
+    float const maxSpeed = crowd.maxSpeed[i];
+
+    float desiredX = 0.0f;
+    float desiredZ = 0.0f;
+    bool const walking = agent.state == AgentContext::Following || agent.state == AgentContext::Requested;
+    if (walking && agent.corner < agent.numCorners)
+    {
+        float const* corner = &agent.corners[agent.corner * 3];
+        float toX = corner[0] - x;
+        float toZ = corner[2] - z;
+        float dist = Math::sqrt(toX * toX + toZ * toZ);
+        bool last = agent.corner == agent.numCorners - 1;
+        if (!last && dist < Math::max(radius * 0.5f, 0.1f))
+        {
+            agent.corner++;
+            corner = &agent.corners[agent.corner * 3];
+            toX = corner[0] - x;
+            toZ = corner[2] - z;
+            dist = Math::sqrt(toX * toX + toZ * toZ);
+            last = agent.corner == agent.numCorners - 1;
+        }
+
+        if (last && dist < Math::max(radius * 0.25f, 0.05f))
+        {
+            // the corners may have run out before the target, otherwise this is as close as it gets
+            if (agent.numCorners == AgentContext::MaxCorners && agent.state == AgentContext::Following)
+                agent.needsPath = true;
+            else if (agent.state == AgentContext::Following)
+                agent.state = AgentContext::Arrived;
+        }
+        else
+        {
+            float const slowDown = last ? Math::min(dist / (radius * SlowDownRadii), 1.0f) : 1.0f;
+            float const speed = maxSpeed * slowDown / Math::max(dist, 0.0001f);
+            desiredX = toX * speed;
+            desiredZ = toZ * speed;
+
+            // there is no surface query here, follow the height of the corners
+            crowd.posY[i] += (corner[1] - crowd.posY[i]) * Math::min(maxSpeed * timeStep / Math::max(dist, 0.0001f), 1.0f);
+        }
+    }
+
+    float pushX, pushZ;
+    Separation(x, z, radius, pushX, pushZ);
+    desiredX += pushX * maxSpeed * SeparationWeight;
+    desiredZ += pushZ * maxSpeed * SeparationWeight;
+    float const desiredSpeed = Math::sqrt(desiredX * desiredX + desiredZ * desiredZ);
+    if (desiredSpeed > maxSpeed)
+    {
+        desiredX *= maxSpeed / desiredSpeed;
+        desiredZ *= maxSpeed / desiredSpeed;
+    }
+
+    float changeX = desiredX - crowd.velX[i];
+    float changeZ = desiredZ - crowd.velZ[i];
+    float const change = Math::sqrt(changeX * changeX + changeZ * changeZ);
+    float const maxChange = crowd.maxAcceleration[i] * timeStep;
+    if (change > maxChange)
+    {
+        changeX *= maxChange / change;
+        changeZ *= maxChange / change;
+    }
+    float const velX = crowd.velX[i] + changeX;
+    float const velZ = crowd.velZ[i] + changeZ;
+    crowd.velX[i] = velX;
+    crowd.velZ[i] = velZ;
+    crowd.posX[i] = x + velX * timeStep;
+    crowd.posZ[i] = z + velZ * timeStep;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MergeResults(QuerySlot& slot)
+{
+    for (PathResult const& result : slot.results)
+    {
+        if (!crowd.idPool.IsValid(result.agent.id))
+            continue;
+        Agent& agent = crowd.agents[crowd.agentIndices[result.agent.index]];
+        if (agent.serial != result.serial)
+            continue;
+
+        if (result.success)
+        {
+            Memory::Copy(result.corners, agent.corners, result.numCorners * 3 * sizeof(float));
+            agent.numCorners = result.numCorners;
+            // the first corner is where the agent stood when the path was requested
+            agent.corner = result.numCorners > 1 ? 1 : 0;
+            agent.state = AgentContext::Following;
+        }
+        else
+        {
+            agent.numCorners = 0;
+            agent.state = AgentContext::Failed;
+        }
+    }
+    slot.results.Clear();
+
+    for (Corridor& corridor : slot.solved)
+        CacheCorridor(corridor);
+    slot.solved.Clear();
+
+    if (slot.nextRequest == slot.requests.Size())
+    {
+        slot.requests.Reset();
+        slot.nextRequest = 0;
+    }
+    else if (slot.nextRequest > 0)
+    {
+        slot.requests.EraseRange(0, slot.nextRequest);
+        slot.nextRequest = 0;
+    }
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/**
+*/
+AgentContext::AgentContext()
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+AgentContext::~AgentContext()
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+    Creates one query slot per job thread.
+*/
+void
+AgentContext::Create()
+{
+    n_assert(crowd.slots.IsEmpty());
+    crowd.slots.Resize(Math::max(Jobs2::ctx.threads.Size(), 1));
+    for (QuerySlot& slot : crowd.slots)
+    {
+        slot.query = dtAllocNavMeshQuery();
+    }
+    crowd.pathCache.Resize(MaxCachedPaths);
+    crowd.pathCacheIndex.Reserve(MaxCachedPaths);
+    crowd.nextCachedPath = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AgentContext::Discard()
+{
+    for (QuerySlot& slot : crowd.slots)
+    {
+        dtFreeNavMeshQuery(slot.query);
+    }
+    crowd.slots.Clear();
+    crowd.pathCache.Clear();
+    crowd.pathCacheIndex.Clear();
+
+    for (Agent const& agent : crowd.agents)
+        crowd.idPool.Deallocate(agent.id.id);
+    crowd.agents.Clear();
+    crowd.posX.Clear();
+    crowd.posY.Clear();
+    crowd.posZ.Clear();
+    crowd.velX.Clear();
+    crowd.velZ.Clear();
+    crowd.radius.Clear();
+    crowd.maxSpeed.Clear();
+    crowd.maxAcceleration.Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+CrowdAgentId
+AgentContext::CreateAgent(const NavMeshId mesh, const Math::point& position, const AgentParams& params)
+{
+    dtNavMesh* navMesh = Resources::GetStreamLoader<StreamNavMeshCache>()->GetDetourMesh(mesh);
+    n_assert(navMesh != nullptr);
+
+    Ids::Id32 id;
+    crowd.idPool.Allocate(id);
+    CrowdAgentId const agentId = id;
+    if (agentId.index >= (uint)crowd.agentIndices.Size())
+        crowd.agentIndices.Resize(agentId.index + 1);
+    crowd.agentIndices[agentId.index] = crowd.agents.Size();
+
+    Agent agent;
+    agent.id = agentId;
+    agent.mesh = mesh;
+    agent.navMesh = navMesh;
+    agent.target = position;
+    agent.state = NoTarget;
+    agent.serial = 0;
+    agent.needsPath = false;
+    agent.numCorners = 0;
+    agent.corner = 0;
+    crowd.agents.Append(agent);
+
+    crowd.posX.Append(position.x);
+    crowd.posY.Append(position.y);
+    crowd.posZ.Append(position.z);
+    crowd.velX.Append(0.0f);
+    crowd.velZ.Append(0.0f);
+    crowd.radius.Append(params.radius);
+    crowd.maxSpeed.Append(params.maxSpeed);
+    crowd.maxAcceleration.Append(params.maxAcceleration);
+    return agentId;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Queued requests of the agent are dropped when they come up.
+*/
+void
+AgentContext::DestroyAgent(const CrowdAgentId id)
+{
+    if (!IsValid(id))
+        return;
+    IndexT const i = crowd.agentIndices[id.index];
+    crowd.agents.EraseIndexSwap(i);
+    crowd.posX.EraseIndexSwap(i);
+    crowd.posY.EraseIndexSwap(i);
+    crowd.posZ.EraseIndexSwap(i);
+    crowd.velX.EraseIndexSwap(i);
+    crowd.velZ.EraseIndexSwap(i);
+    crowd.radius.EraseIndexSwap(i);
+    crowd.maxSpeed.EraseIndexSwap(i);
+    crowd.maxAcceleration.EraseIndexSwap(i);
+    if (i < crowd.agents.Size())
+        crowd.agentIndices[crowd.agents[i].id.index] = i;
+    crowd.idPool.Deallocate(id.id);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+AgentContext::IsValid(const CrowdAgentId id)
+{
+    return id != InvalidCrowdAgentId && crowd.idPool.IsValid(id.id);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+AgentContext::GetNumAgents()
+{
+    return crowd.agents.Size();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Setting the same target again doesn't request a new path, so this can
+    be called every frame.
+*/
+void
+AgentContext::SetTarget(const CrowdAgentId id, const Math::point& target)
+{
+    n_assert(IsValid(id));
+    IndexT const i = crowd.agentIndices[id.index];
+    Agent& agent = crowd.agents[i];
+    float const dx = target.x - agent.target.x;
+    float const dy = target.y - agent.target.y;
+    float const dz = target.z - agent.target.z;
+    if (agent.state != NoTarget && dx * dx + dy * dy + dz * dz < 0.01f)
+        return;
+    agent.target = target;
+    RequestPath(i);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Math::point
+AgentContext::GetTarget(const CrowdAgentId id)
+{
+    n_assert(IsValid(id));
+    return crowd.agents[crowd.agentIndices[id.index]].target;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AgentContext::ClearTarget(const CrowdAgentId id)
+{
+    n_assert(IsValid(id));
+    Agent& agent = crowd.agents[crowd.agentIndices[id.index]];
+    if (agent.state == NoTarget)
+        return;
+    agent.serial++;
+    agent.state = NoTarget;
+    agent.needsPath = false;
+    agent.numCorners = 0;
+    agent.corner = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+AgentContext::PathState
+AgentContext::GetPathState(const CrowdAgentId id)
+{
+    n_assert(IsValid(id));
+    return crowd.agents[crowd.agentIndices[id.index]].state;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AgentContext::SetPosition(const CrowdAgentId id, const Math::point& position)
+{
+    n_assert(IsValid(id));
+    IndexT const i = crowd.agentIndices[id.index];
+    crowd.posX[i] = position.x;
+    crowd.posY[i] = position.y;
+    crowd.posZ[i] = position.z;
+    crowd.velX[i] = 0.0f;
+    crowd.velZ[i] = 0.0f;
+
+    AgentContext::PathState const state = crowd.agents[i].state;
+    if (state == Following || state == Requested)
+        RequestPath(i);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Math::point
+AgentContext::GetPosition(const CrowdAgentId id)
+{
+    n_assert(IsValid(id));
+    IndexT const i = crowd.agentIndices[id.index];
+    return Math::point(crowd.posX[i], crowd.posY[i], crowd.posZ[i]);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Math::vector
+AgentContext::GetVelocity(const CrowdAgentId id)
+{
+    n_assert(IsValid(id));
+    IndexT const i = crowd.agentIndices[id.index];
+    return Math::vector(crowd.velX[i], 0.0f, crowd.velZ[i]);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AgentContext::SetMaxIterationsPerFrame(SizeT num)
+{
+    n_assert(num > 0);
+    crowd.maxIterationsPerFrame = num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AgentContext::InvalidatePathCache(const NavMeshId mesh)
+{
+    for (Corridor& corridor : crowd.pathCache)
+    {
+        if (corridor.mesh == mesh)
+        {
+            crowd.pathCacheIndex.Erase(corridor.key);
+            corridor.mesh = InvalidNavMeshId;
+            corridor.polys.Clear();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Requests new paths for the agents on a mesh whose remaining path passes
+    through a box. Searches still running on the mesh are started over, they
+    may hold polygons of tiles which are gone.
+*/
+void
+AgentContext::RepathAgents(const NavMeshId mesh, const Math::bbox& box)
+{
+    for (IndexT i = 0; i < crowd.agents.Size(); i++)
+    {
+        Agent const& agent = crowd.agents[i];
+        if (agent.mesh != mesh)
+            continue;
+        if (agent.state == Requested)
+        {
+            RequestPath(i);
+            continue;
+        }
+        if (agent.state != Following)
+            continue;
+
+        // bounds of what's left to walk, from the agent over all remaining corners
+        Math::bbox path;
+        path.begin_extend();
+        path.extend(Math::vec3(crowd.posX[i], crowd.posY[i], crowd.posZ[i]));
+        for (IndexT c = agent.corner; c < agent.numCorners; c++)
+            path.extend(Math::vec3(agent.corners[c * 3], agent.corners[c * 3 + 1], agent.corners[c * 3 + 2]));
+        path.end_extend();
+        if (path.intersects(box))
+            RequestPath(i);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AgentContext::GetAgentPositions(const NavMeshId mesh, Util::Array<Math::vec3>& outPositions)
+{
+    for (IndexT i = 0; i < crowd.agents.Size(); i++)
+    {
+        if (crowd.agents[i].mesh == mesh)
+            outPositions.Append(Math::vec3(crowd.posX[i], crowd.posY[i], crowd.posZ[i]));
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Path searches and steering run in jobs side by side, they don't touch
+    the same data. Paths found this frame are handed to the agents at the
+    end, so they start walking them next frame.
+*/
+void
+AgentContext::Update(float timeStep)
+{
+    N_SCOPE(UpdateAgents, Navigation);
+
+    // agents which ran out of corners last frame
+    for (IndexT i = 0; i < crowd.agents.Size(); i++)
+    {
+        if (crowd.agents[i].needsPath)
+            RequestPath(i);
+    }
+
+    crowd.busySlots.Clear();
+    for (IndexT s = 0; s < crowd.slots.Size(); s++)
+    {
+        QuerySlot const& slot = crowd.slots[s];
+        if (slot.searching || slot.nextRequest < slot.requests.Size())
+            crowd.busySlots.Append(s);
+    }
+
+    Threading::Event pathsDone;
+    int const budget = Math::max((int)crowd.maxIterationsPerFrame / Math::max(crowd.busySlots.Size(), 1), MinIterationsPerSlot);
+    Jobs2::JobDispatch(
+        [budget](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+        {
+            N_SCOPE(SolvePaths, Navigation);
+            for (IndexT i = 0; i < groupSize; i++)
+            {
+                IndexT const index = i + invocationOffset;
+                if (index >= totalJobs)
+                    return;
+                SolvePaths(crowd.slots[crowd.busySlots[index]], budget);
+            }
+        },
+        crowd.busySlots.Size(),
+        1,
+        nullptr,
+        nullptr,
+        &pathsDone
+    );
+
+    BuildGrid();
+
+    Threading::Event steeringDone;
+    Jobs2::JobDispatch(
+        [timeStep](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+        {
+            N_SCOPE(SteerAgents, Navigation);
+            for (IndexT i = 0; i < groupSize; i++)
+            {
+                IndexT const index = i + invocationOffset;
+                if (index >= totalJobs)
+                    return;
+                Steer(index, timeStep);
+            }
+        },
+        crowd.agents.Size(),
+        256,
+        nullptr,
+        nullptr,
+        &steeringDone
+    );
+
+    steeringDone.Wait();
+    pathsDone.Wait();
+
+    for (QuerySlot& slot : crowd.slots)
+        MergeResults(slot);
+}
+
+} // namespace Navigation
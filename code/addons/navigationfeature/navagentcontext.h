@@ -1,25 +1,63 @@
 #pragma once
 //------------------------------------------------------------------------------
 /**
-    
+    @class Navigation::AgentContext
+
+    Moves crowds of agents over nav meshes.
+
+    Path requests are queued by SetTarget() and solved in batches during
+    Update(). The requests are spread over a number of query slots, one per
+    job thread, each with its own dtNavMeshQuery. Every slot runs sliced A*
+    searches until its share of the per frame iteration budget is used up,
+    so a burst of requests doesn't stall a frame, long searches simply carry
+    on in the next one. Solved polygon corridors are cached by start and end
+    polygon, agents walking between the same polygons only need the string
+    pulling step.
+
+    Agents follow the corners of their straight path and keep apart with a
+    separation force. Neighbours are found through a hashed grid which is
+    rebuilt every frame. Agents are sorted by grid cell, so the candidates
+    of a cell are contiguous and are tested four at a time. Steering runs in
+    jobs as well, alongside the path searches.
+
     @copyright
     (C) 2022 Individual contributors, see AUTHORS file
 */
 //------------------------------------------------------------------------------
-#include "resources/resourceid.h"
 #include "ids/id.h"
-#include "ids/idallocator.h"
+#include "ids/idgenerationpool.h"
+#include "math/point.h"
+#include "math/vector.h"
+#include "math/bbox.h"
+#include "util/array.h"
 #include "streamnavmeshcache.h"
 
 namespace Navigation
 {
 
-ID_32_24_8_NAMED_TYPE(CrowdAgentId, instance, navmeshId, generation, agentType);
+ID_24_8_TYPE(CrowdAgentId);
 
-class AgentContext 
+class AgentContext
 {
-
 public:
+    /// movement properties of an agent
+    struct AgentParams
+    {
+        float radius = 0.5f;
+        float maxSpeed = 3.5f;
+        float maxAcceleration = 8.0f;
+    };
+
+    /// where an agent is with its path
+    enum PathState
+    {
+        NoTarget,       // standing around
+        Requested,      // waiting for a path, keeps following the old one meanwhile
+        Following,      // walking along a path
+        Arrived,        // reached the target
+        Failed          // no path to the target
+    };
+
     /// constructor
     AgentContext();
     /// destructor
@@ -27,24 +65,52 @@ public:
 
     /// create context
     static void Create();
+    /// discard context
+    static void Discard();
+
+    /// create an agent standing on a nav mesh
+    static CrowdAgentId CreateAgent(const NavMeshId mesh, const Math::point& position, const AgentParams& params);
+    /// destroy an agent
+    static void DestroyAgent(const CrowdAgentId id);
+    /// returns true if the agent exists
+    static bool IsValid(const CrowdAgentId id);
+    /// get number of agents
+    static SizeT GetNumAgents();
 
-    /// set the target for an agent
-    static void SetTarget(const Navigation::CrowdAgentId id, const Math::point& target);
+    /// set the target for an agent, requests a path if the target has moved
+    static void SetTarget(const CrowdAgentId id, const Math::point& target);
+    /// get the target of an agent
+    static Math::point GetTarget(const CrowdAgentId id);
+    /// stop the agent where it is
+    static void ClearTarget(const CrowdAgentId id);
+    /// get the path state of an agent
+    static PathState GetPathState(const CrowdAgentId id);
 
-    /// set the transform for a model
-    static Math::point GetTarget(const Navigation::CrowdAgentId id);
+    /// move an agent without walking, the path is requested again
+    static void SetPosition(const CrowdAgentId id, const Math::point& position);
+    /// get the position of an agent
+    static Math::point GetPosition(const CrowdAgentId id);
+    /// get the velocity of an agent
+    static Math::vector GetVelocity(const CrowdAgentId id);
 
+    /// set how many A* iterations all path searches together may run per frame
+    static void SetMaxIterationsPerFrame(SizeT num);
+    /// forget all cached corridors of a nav mesh, call when the mesh has changed
+    static void InvalidatePathCache(const NavMeshId mesh);
+    /// request new paths for agents whose path crosses a box, call when tiles of the mesh were replaced
+    static void RepathAgents(const NavMeshId mesh, const Math::bbox& box);
+    /// append the positions of all agents on a mesh
+    static void GetAgentPositions(const NavMeshId mesh, Util::Array<Math::vec3>& outPositions);
 
-        
-private:
+    /// solve queued path requests and move the agents
+    static void Update(float timeStep);
 
-    typedef Ids::IdAllocator<
-        CrowdAgentId,
-        int,            // agentId in dtcrowds
-        NavMeshId,      // navmesh this agent is connected to
-        Math::point     // current target point
-    > AgentContextAllocator;
-    static AgentContextAllocator agentContextAllocator;
+    /// max number of corners of a straight path, agents request the rest when they reach the last one
+    static const SizeT MaxCorners = 32;
+    /// max number of polygons in a corridor
+    static const SizeT MaxCorridorPolys = 256;
+    /// max number of cached corridors
+    static const SizeT MaxCachedPaths = 4096;
 };
 
-} // namespace Models
+} // namespace Navigation
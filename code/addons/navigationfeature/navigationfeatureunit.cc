@@ -5,6 +5,11 @@
 #include "application/stdneb.h"
 #include "navigationfeatureunit.h"
 #include "streamnavmeshcache.h"
+#include "navagentcontext.h"
+#include "recast/tilebuilder.h"
+#include "managers/navigationmanager.h"
+#include "components/navigation.h"
+#include "basegamefeature/managers/timemanager.h"
 #include "debug/detourdebug.h"
 #include "game/api.h"
 #include "resources/resourceserver.h"
@@ -38,6 +43,17 @@ NavigationFeatureUnit::~NavigationFeatureUnit()
     __DestructSingleton;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NavigationFeatureUnit::OnAttach()
+{
+    this->RegisterComponentType<NavigationAgent>({ .decay = true, .OnInit = &NavigationManager::InitAgent });
+    this->RegisterComponentType<NavigationTarget>();
+    this->RegisterComponentType<NavigationObstacle>({ .decay = true, .OnInit = &NavigationManager::InitObstacle });
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -50,6 +66,9 @@ NavigationFeatureUnit::OnActivate()
     IO::AssignRegistry::Instance()->SetAssign(IO::Assign("nav", "export:navigation"));
 
     Navigation::navMeshCache = Resources::GetStreamLoader<Navigation::StreamNavMeshCache>();
+
+    Navigation::AgentContext::Create();
+    this->AttachManager(NavigationManager::Create());
 }
 
 //------------------------------------------------------------------------------
@@ -59,14 +78,39 @@ void
 NavigationFeatureUnit::OnDeactivate()
 {   
     FeatureUnit::OnDeactivate();    
+    Navigation::AgentContext::Discard();
 }
 
 //------------------------------------------------------------------------------
 /**
+    Rebuilt tiles are swapped in before the agents move, nothing searches
+    the nav meshes at that point. Agents whose paths cross swapped tiles
+    ask for new ones.
 */
 void 
 NavigationFeatureUnit::OnBeginFrame()
 {
+    FeatureUnit::OnBeginFrame();
+
+    Util::Array<Navigation::NavMeshId> const meshes = Navigation::navMeshCache->GetLoadedMeshes();
+    for (Navigation::NavMeshId id : meshes)
+    {
+        Navigation::TileBuilder* const tiles = Navigation::navMeshCache->GetTileBuilder(id);
+        if (tiles == nullptr)
+            continue;
+
+        this->focusPoints.Clear();
+        Navigation::AgentContext::GetAgentPositions(id, this->focusPoints);
+        Math::bbox changed;
+        if (tiles->Update(this->focusPoints, changed))
+        {
+            Navigation::AgentContext::InvalidatePathCache(id);
+            Navigation::AgentContext::RepathAgents(id, changed);
+        }
+    }
+
+    Game::TimeSource* const time = Game::Time::GetTimeSource(TIMESOURCE_GAMEPLAY);
+    Navigation::AgentContext::Update((float)time->frameTime);
 }
 
 //------------------------------------------------------------------------------
@@ -9,6 +9,8 @@
 */
 #include "game/featureunit.h"
 #include "graphics/graphicsentity.h"
+#include "util/array.h"
+#include "math/vec3.h"
 
 //------------------------------------------------------------------------------
 namespace NavigationFeature
@@ -26,19 +28,21 @@ public:
     /// destructor
     ~NavigationFeatureUnit();
 
+    /// register components
+    void OnAttach() override;
     /// Called upon activation of feature unit
     void OnActivate();
     /// Called upon deactivation of feature unit
     void OnDeactivate();
 
-    /// called on begin of frame
+    /// called on begin of frame, swaps in rebuilt nav mesh tiles and moves the crowd agents
     virtual void OnBeginFrame();
 
     /// called when game debug visualization is on
     virtual void OnRenderDebug();
 
 private:
-
+    Util::Array<Math::vec3> focusPoints;
 };
 
 /// render editor ui 
@@ -23,7 +23,7 @@ namespace Recast
 /**
 */
 static void 
-SetupConfig(NavMeshSettingsT const& settings, AgentT& kind, Math::vec3 const& bounds_center, Math::vec3 const& bounds_extents, rcConfig& config)
+SetupConfig(NavMeshSettingsT const& settings, AgentT const& kind, Math::vec3 const& bounds_center, Math::vec3 const& bounds_extents, rcConfig& config)
 {		
 	Memory::Clear(&config,sizeof(rcConfig));
     config.cs = settings.cell_size;
@@ -51,6 +51,135 @@ SetupConfig(NavMeshSettingsT const& settings, AgentT& kind, Math::vec3 const& bo
 
 }
 
+//------------------------------------------------------------------------------
+/**
+    Marks the area modifiers of the nav mesh in a compact heightfield
+*/
+static void
+MarkAreas(NavMeshT const& data, rcCompactHeightfield& chf, rcContext& ctx)
+{
+    for (auto const& area : data.area_modifiers)
+    {
+        float* points = (float*)Memory::Alloc(Memory::ScratchHeap, 3 * sizeof(float) * area->convex_area_points.size());
+
+        for (size_t i = 0, k = area->convex_area_points.size(); i < k; ++i)
+        {
+            vec3 p = area->convex_area_points[i];
+            points[i * 3] = p.x;
+            points[i * 3 + 1] = 0.0f;
+            points[i * 3 + 2] = p.z;
+        }
+        rcMarkConvexPolyArea(&ctx, points, (int)area->convex_area_points.size(), data.bounds_center.y - data.bounds_extents.y, data.bounds_center.y + data.bounds_extents.y, area->area_id, chf);
+        Memory::Free(Memory::ScratchHeap, (void*)points);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Update poly flags from areas
+*/
+static void
+SetPolyFlags(rcPolyMesh& pmesh)
+{
+    for (int i = 0; i < pmesh.npolys; ++i)
+    {
+        if (pmesh.areas[i] == RC_WALKABLE_AREA)
+        {
+            pmesh.areas[i] = 1;
+            pmesh.flags[i] = 1;
+        }
+        else
+        {
+            // custom area
+            int id = pmesh.areas[i];
+            pmesh.flags[i] = id & 255;
+            pmesh.areas[i] = id >> 8;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Loads all source meshes of a nav mesh and appends their triangles in
+    world space
+*/
+void
+LoadSourceGeometry(NavMeshT const& data, Util::Array<float>& vertices, Util::Array<int>& triangles)
+{
+    for (auto const& entry : data.sources)
+    {
+        IO::URI meshFile = entry->resource;
+        const Math::mat4& transform = entry->transform;
+        Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(meshFile);
+        stream->SetAccessMode(IO::Stream::ReadAccess);
+
+        Ptr<IO::StreamReader> nvx3Reader = IO::StreamReader::Create();
+        nvx3Reader->SetStream(stream);
+
+        if (nvx3Reader->Open())
+        {
+            n_assert(stream->CanBeMapped());
+
+            // map the stream to memory
+            void* mapPtr = stream->MemoryMap();
+            n_assert(nullptr != mapPtr);
+            char* basePtr = (char*)mapPtr;
+
+            auto header = (CoreGraphics::Nvx3Header*)mapPtr;
+            n_assert(header != nullptr);
+
+            if (header->magic != NEBULA_NVX_MAGICNUMBER)
+            {
+                // not a nvx3 file, break hard
+                n_error("MeshLoader: '%s' is not a nvx file!", stream->GetURI().AsString().AsCharPtr());
+            }
+            if (header->version != NEBULA_NVX_VERSION)
+            {
+                // exported with an older layout, break hard
+                n_error("MeshLoader: '%s' is a nvx file of version %d, expected %d, re-export it!", stream->GetURI().AsString().AsCharPtr(), header->version, NEBULA_NVX_VERSION);
+            }
+
+            n_assert(header->numMeshes > 0);
+
+            CoreGraphics::Nvx3Elements elements;
+            CoreGraphics::Nvx3::FillNvx3Elements((char*)mapPtr, header, elements);
+
+            const uint vertexStride = sizeof(CoreGraphics::BaseVertex);
+            const CoreGraphics::Nvx3Group* groups = (CoreGraphics::Nvx3Group*)(basePtr + elements.ranges[0].firstGroupOffset);
+            const ubyte* groupVertexBase = elements.vertexData + elements.ranges[0].baseVertexByteOffset;
+            CoreGraphics::BaseVertex* vertexBuffer = (CoreGraphics::BaseVertex*)groupVertexBase;
+            const uint vertexCount = (elements.ranges[0].attributesVertexByteOffset - elements.ranges[0].baseVertexByteOffset) / vertexStride;
+
+            const int baseVertex = vertices.Size() / 3;
+            vertices.Reserve(vertices.Size() + vertexCount * 3);
+            for (uint i = 0; i < vertexCount; ++i)
+            {
+                CoreGraphics::BaseVertex const& pos = vertexBuffer[i];
+                vec4 trans = transform * vec4(pos.position[0], pos.position[1], pos.position[2], 1);
+                vertices.Append(trans.x);
+                vertices.Append(trans.y);
+                vertices.Append(trans.z);
+            }
+            for (uint i = 0; i < elements.ranges[0].numGroups; i++)
+            {
+                for (uint j = 0; j < groups[i].numIndices; j++)
+                {
+                    int n = 0;
+                    switch (elements.ranges[0].indexType)
+                    {
+                        case CoreGraphics::IndexType::Index16:
+                            n = ((uint16_t*)(elements.indexData))[groups[i].firstIndex + j]; break;
+                        case CoreGraphics::IndexType::Index32:
+                            n = ((uint32_t*)(elements.indexData))[groups[i].firstIndex + j]; break;
+                        default: n_error("unhandled enum");
+                    }
+                    triangles.Append(baseVertex + n);
+                }
+            }
+            nvx3Reader->Close();
+        }
+    }
+}
 
 //------------------------------------------------------------------------------
 /**
@@ -85,100 +214,19 @@ GenerateNavMesh(NavMeshT const& data, Util::Blob& meshData)
 	n_assert(m_solid);
 	rcCreateHeightfield(&m_ctx, *m_solid, config.width, config.height, config.bmin, config.bmax, config.cs, config.ch);
 	
-	// loop through all the mesh files
-	for(auto const& entry : data.sources)
+	// load all the mesh files and rasterize them in one go
+	Util::Array<float> vertices;
+	Util::Array<int> triangles;
+	LoadSourceGeometry(data, vertices, triangles);
+	if (!triangles.IsEmpty())
 	{
-        IO::URI meshFile = entry->resource;
-        const Math::mat4& transform = entry->transform;
-		Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(meshFile);
-		stream->SetAccessMode(IO::Stream::ReadAccess);
-
-		Ptr<IO::StreamReader> nvx3Reader = IO::StreamReader::Create();
-		nvx3Reader->SetStream(stream);
-
-		if (nvx3Reader->Open())
-		{	
-			n_assert(stream->CanBeMapped());
-
-			void* mapPtr = nullptr;
-			n_assert(nullptr == mapPtr);
-			// map the stream to memory
-			mapPtr = stream->MemoryMap();
-			n_assert(nullptr != mapPtr);
-			char* basePtr = (char*)mapPtr;
-
-			auto header = (CoreGraphics::Nvx3Header*)mapPtr;
-
-			n_assert(header != nullptr);
-
-			if (header->magic != NEBULA_NVX_MAGICNUMBER)
-			{
-				// not a nvx3 file, break hard
-				n_error("MeshLoader: '%s' is not a nvx file!", stream->GetURI().AsString().AsCharPtr());
-			}
-
-			n_assert(header->numMeshes > 0);
-
-			CoreGraphics::Nvx3Elements elements;
-			CoreGraphics::Nvx3::FillNvx3Elements((char*)mapPtr, header, elements);
-
-			const uint vertexStride = sizeof(CoreGraphics::BaseVertex);
-			const CoreGraphics::Nvx3Group* groups = (CoreGraphics::Nvx3Group*)(basePtr + elements.ranges[0].firstGroupOffset);
-			const ubyte* groupVertexBase = elements.vertexData + elements.ranges[0].baseVertexByteOffset;
-			CoreGraphics::BaseVertex* vertexBuffer = (CoreGraphics::BaseVertex*)groupVertexBase;
-			const uint vertexCount = (elements.ranges[0].attributesVertexByteOffset - elements.ranges[0].baseVertexByteOffset) / vertexStride;
-
-			CoreGraphics::IndexType::SizeOf(elements.ranges[0].indexType);
-			
-            float* transformedData = (float*)Memory::Alloc(Memory::ScratchHeap, vertexCount * 3 * sizeof(float));
-			IndexT count = 0;
- 			for(int i = 0, k = vertexCount; i < k ; ++i)
- 			{
-				CoreGraphics::BaseVertex const& pos = vertexBuffer[i];
- 				vec4 v(pos.position[0], pos.position[1], pos.position[2], 1);
-                vec4 trans = transform * v;
- 				for(int j = 0; j < 3 ; j++)
- 				{
-                    transformedData[i * 3 + j] = trans[j];
- 				}
- 			}
-  			for(int i=0;i < elements.ranges[0].numGroups; i++)
-			{
-				int ntris = groups[i].numIndices / 3;
-                //int startingVertex = groups[i].
-                float* verts = transformedData;
-				//int nverts = groups[i].GetNumVertices();
-				
-				int* idxs = (int*)Memory::Alloc(Memory::ScratchHeap, groups[i].numIndices * sizeof(int));
-				
-				for (int j = 0; j < groups[i].numIndices; j++)
-				{
-					int n = 0;
-					switch (elements.ranges[0].indexType)
-					{
-						case CoreGraphics::IndexType::Index16:
-							n = ((uint16_t*)(elements.indexData))[groups[i].firstIndex + j]; break;
-						case CoreGraphics::IndexType::Index32:
-							n = ((uint32_t*)(elements.indexData))[groups[i].firstIndex + j]; break;
-						default: n_error("unhandled enum");
-					}
-					idxs[j] = n;
-				}
-				
-				//n_assert2(groups[i].GetPrimitiveTopology() == CoreGraphics::PrimitiveTopology::TriangleList,"Only triangle lists are supported");
-				
-				m_triareas = (unsigned char*)Memory::Alloc(Memory::ScratchHeap, ntris);
-				Memory::Clear(m_triareas,ntris * sizeof(unsigned char));		
-
-				rcMarkWalkableTriangles(&m_ctx, config.walkableSlopeAngle, verts, vertexCount, idxs, ntris, m_triareas);
-				rcRasterizeTriangles(&m_ctx, verts, vertexCount, idxs, m_triareas, ntris, *m_solid, config.walkableClimb);
-				Memory::Free(Memory::ScratchHeap, m_triareas);
-				Memory::Free(Memory::ScratchHeap, idxs);
-			}		
-			nvx3Reader->Close();
-
-            Memory::Free(Memory::ScratchHeap, (void*)transformedData);
-		}				
+		const int nverts = vertices.Size() / 3;
+		const int ntris = triangles.Size() / 3;
+		m_triareas = (unsigned char*)Memory::Alloc(Memory::ScratchHeap, ntris);
+		Memory::Clear(m_triareas, ntris * sizeof(unsigned char));
+		rcMarkWalkableTriangles(&m_ctx, config.walkableSlopeAngle, vertices.Begin(), nverts, triangles.Begin(), ntris, m_triareas);
+		rcRasterizeTriangles(&m_ctx, vertices.Begin(), nverts, triangles.Begin(), m_triareas, ntris, *m_solid, config.walkableClimb);
+		Memory::Free(Memory::ScratchHeap, m_triareas);
 	}
 	
 	//
@@ -213,21 +261,7 @@ GenerateNavMesh(NavMeshT const& data, Util::Blob& meshData)
 	// Erode the walkable area by agent radius.
 	rcErodeWalkableArea(&m_ctx, config.walkableRadius, *m_chf);
 	
-    // add area markers
-    for(auto const& area : data.area_modifiers)
-    {
-        float* points = (float*)Memory::Alloc(Memory::ScratchHeap, 3 * sizeof(float) * area->convex_area_points.size());
-
-        for (size_t i = 0, k = area->convex_area_points.size(); i < k; ++i)
-        {
-            vec3 p = area->convex_area_points[i];
-            points[i * 3] = p.x;
-            points[i * 3 + 1] = 0.0f;
-            points[i * 3 + 2] = p.z;
-        }
-        rcMarkConvexPolyArea(&m_ctx, points, (int)area->convex_area_points.size(), data.bounds_center.y - data.bounds_extents.y, data.bounds_center.y + data.bounds_extents.y, area->area_id, *m_chf);
-        Memory::Free(Memory::ScratchHeap, (void*)points);
-    }
+    MarkAreas(data, *m_chf, m_ctx);
 
 	// Prepare for region partitioning, by calculating distance field along the walkable surface.
 	rcBuildDistanceField(&m_ctx, *m_chf);
@@ -285,23 +319,7 @@ GenerateNavMesh(NavMeshT const& data, Util::Blob& meshData)
 	int navDataSize = 0;
 
 	
-	// Update poly flags from areas.
-	for (int i = 0; i < m_pmesh->npolys; ++i)
-	{
-		if (m_pmesh->areas[i] == RC_WALKABLE_AREA)
-		{
-			m_pmesh->areas[i] = 1;
-			m_pmesh->flags[i] = 1;
-		}
-		else
-		{
-			// custom area
-			int id = m_pmesh->areas[i];
-			m_pmesh->flags[i] = id & 255;
-			m_pmesh->areas[i] = id >> 8;
-		}
-		
-	}
+	SetPolyFlags(*m_pmesh);
 
 
 	dtNavMeshCreateParams params;
@@ -351,5 +369,171 @@ GenerateNavMesh(NavMeshT const& data, Util::Blob& meshData)
     return false;
 }
 
+
+//------------------------------------------------------------------------------
+/**
+    Computes the tile grid of a nav mesh with a tile size, returns false if
+    the nav mesh is baked into a single tile
+*/
+bool
+SetupTiledNavMesh(NavMeshT const& data, dtNavMeshParams& params, int& tilesX, int& tilesZ)
+{
+    const int tileSize = data.navmesh_settings->tile_size;
+    if (tileSize <= 0)
+        return false;
+
+    const float tileWorldSize = tileSize * data.navmesh_settings->cell_size;
+    const vec3 bmin = data.bounds_center - data.bounds_extents;
+    tilesX = Math::max(1, (int)ceilf(data.bounds_extents.x * 2.0f / tileWorldSize));
+    tilesZ = Math::max(1, (int)ceilf(data.bounds_extents.z * 2.0f / tileWorldSize));
+
+    // polygon refs are 32 bit wide in total, what the tiles don't need the polygons get
+    const int tileBits = Math::min((int)rcIlog2(rcNextPow2(tilesX * tilesZ)), 14);
+    const int polyBits = 22 - tileBits;
+
+    Memory::Clear(&params, sizeof(dtNavMeshParams));
+    params.orig[0] = bmin.x;
+    params.orig[1] = bmin.y;
+    params.orig[2] = bmin.z;
+    params.tileWidth = tileWorldSize;
+    params.tileHeight = tileWorldSize;
+    params.maxTiles = 1 << tileBits;
+    params.maxPolys = 1 << polyBits;
+    n_assert2(tilesX * tilesZ <= params.maxTiles, "Nav mesh has too many tiles, increase the tile size");
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Builds a single tile of a tiled nav mesh. Only works on the input and
+    its own Recast context, so any number of tiles can be built in parallel.
+    Returns true and no data if there is nothing walkable in the tile.
+*/
+bool
+BuildTile(NavMeshT const& data, TileBuildInput const& input, unsigned char*& navData, int& navDataSize)
+{
+    navData = nullptr;
+    navDataSize = 0;
+
+    rcConfig config;
+    SetupConfig(*data.navmesh_settings, *data.agent_kind, data.bounds_center, data.bounds_extents, config);
+
+    // grow the tile by a border so the polygons of neighbouring tiles line up
+    const float tileWorldSize = data.navmesh_settings->tile_size * config.cs;
+    config.tileSize = data.navmesh_settings->tile_size;
+    config.borderSize = config.walkableRadius + 3;
+    config.width = config.tileSize + config.borderSize * 2;
+    config.height = config.tileSize + config.borderSize * 2;
+    config.bmin[0] += input.tileX * tileWorldSize - config.borderSize * config.cs;
+    config.bmin[2] += input.tileZ * tileWorldSize - config.borderSize * config.cs;
+    config.bmax[0] = config.bmin[0] + config.width * config.cs;
+    config.bmax[2] = config.bmin[2] + config.height * config.cs;
+
+    if (input.triangles.IsEmpty())
+        return true;
+
+    // intermediate results, freed when leaving
+    struct Intermediates
+    {
+        ~Intermediates()
+        {
+            if (triAreas != nullptr) Memory::Free(Memory::ScratchHeap, triAreas);
+            rcFreeHeightField(solid);
+            rcFreeCompactHeightfield(chf);
+            rcFreeContourSet(cset);
+            rcFreePolyMesh(pmesh);
+            rcFreePolyMeshDetail(dmesh);
+        }
+        unsigned char* triAreas = nullptr;
+        rcHeightfield* solid = nullptr;
+        rcCompactHeightfield* chf = nullptr;
+        rcContourSet* cset = nullptr;
+        rcPolyMesh* pmesh = nullptr;
+        rcPolyMeshDetail* dmesh = nullptr;
+    } res;
+    rcContext ctx(false);
+
+    // rasterize
+    const int nverts = input.vertices.Size() / 3;
+    const int ntris = input.triangles.Size() / 3;
+    res.solid = rcAllocHeightfield();
+    if (!rcCreateHeightfield(&ctx, *res.solid, config.width, config.height, config.bmin, config.bmax, config.cs, config.ch))
+        return false;
+    res.triAreas = (unsigned char*)Memory::Alloc(Memory::ScratchHeap, ntris);
+    Memory::Clear(res.triAreas, ntris);
+    rcMarkWalkableTriangles(&ctx, config.walkableSlopeAngle, input.vertices.Begin(), nverts, input.triangles.Begin(), ntris, res.triAreas);
+    if (!rcRasterizeTriangles(&ctx, input.vertices.Begin(), nverts, input.triangles.Begin(), res.triAreas, ntris, *res.solid, config.walkableClimb))
+        return false;
+
+    // filter walkable surfaces
+    rcFilterLowHangingWalkableObstacles(&ctx, config.walkableClimb, *res.solid);
+    rcFilterLedgeSpans(&ctx, config.walkableHeight, config.walkableClimb, *res.solid);
+    rcFilterWalkableLowHeightSpans(&ctx, config.walkableHeight, *res.solid);
+
+    res.chf = rcAllocCompactHeightfield();
+    if (!rcBuildCompactHeightfield(&ctx, config.walkableHeight, config.walkableClimb, *res.solid, *res.chf))
+        return false;
+    rcErodeWalkableArea(&ctx, config.walkableRadius, *res.chf);
+
+    // cut out the obstacles, grown by the agent radius like everything else, then mark areas
+    const float radius = data.agent_kind->agent_radius;
+    for (Math::bbox const& box : input.obstacles)
+    {
+        const float bmin[3] = { box.pmin.x - radius, box.pmin.y, box.pmin.z - radius };
+        const float bmax[3] = { box.pmax.x + radius, box.pmax.y, box.pmax.z + radius };
+        rcMarkBoxArea(&ctx, bmin, bmax, RC_NULL_AREA, *res.chf);
+    }
+    MarkAreas(data, *res.chf, ctx);
+
+    // regions, contours and polygons
+    if (!rcBuildDistanceField(&ctx, *res.chf))
+        return false;
+    if (!rcBuildRegions(&ctx, *res.chf, config.borderSize, config.minRegionArea, config.mergeRegionArea))
+        return false;
+    res.cset = rcAllocContourSet();
+    if (!rcBuildContours(&ctx, *res.chf, config.maxSimplificationError, config.maxEdgeLen, *res.cset))
+        return false;
+    if (res.cset->nconts == 0)
+        return true;
+    res.pmesh = rcAllocPolyMesh();
+    if (!rcBuildPolyMesh(&ctx, *res.cset, config.maxVertsPerPoly, *res.pmesh))
+        return false;
+    res.dmesh = rcAllocPolyMeshDetail();
+    if (!rcBuildPolyMeshDetail(&ctx, *res.pmesh, *res.chf, config.detailSampleDist, config.detailSampleMaxError, *res.dmesh))
+        return false;
+    if (res.pmesh->npolys == 0)
+        return true;
+
+    SetPolyFlags(*res.pmesh);
+
+    dtNavMeshCreateParams params;
+    Memory::Clear(&params, sizeof(params));
+    params.verts = res.pmesh->verts;
+    params.vertCount = res.pmesh->nverts;
+    params.polys = res.pmesh->polys;
+    params.polyAreas = res.pmesh->areas;
+    params.polyFlags = res.pmesh->flags;
+    params.polyCount = res.pmesh->npolys;
+    params.nvp = res.pmesh->nvp;
+    params.detailMeshes = res.dmesh->meshes;
+    params.detailVerts = res.dmesh->verts;
+    params.detailVertsCount = res.dmesh->nverts;
+    params.detailTris = res.dmesh->tris;
+    params.detailTriCount = res.dmesh->ntris;
+    params.walkableHeight = data.agent_kind->agent_height;
+    params.walkableRadius = data.agent_kind->agent_radius;
+    params.walkableClimb = data.agent_kind->agent_max_climb;
+    params.tileX = input.tileX;
+    params.tileY = input.tileZ;
+    params.tileLayer = 0;
+    rcVcopy(params.bmin, res.pmesh->bmin);
+    rcVcopy(params.bmax, res.pmesh->bmax);
+    params.cs = config.cs;
+    params.ch = config.ch;
+    params.buildBvTree = true;
+
+    return dtCreateNavMeshData(&params, &navData, &navDataSize);
+}
+
 }
 }
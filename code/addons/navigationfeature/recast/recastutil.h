@@ -10,11 +10,14 @@
 #include "io/uri.h"
 #include "ids/id.h"
 #include "util/blob.h"
+#include "util/array.h"
 #include "math/bbox.h"
 #include "nflatbuffer/flatbufferinterface.h"
 #include "flat/navigation/navmesh.h"
 #include "flat/navigation/navmeshsettings.h"
 
+struct dtNavMeshParams;
+
 //------------------------------------------------------------------------------
 namespace Navigation
 {
@@ -27,5 +30,25 @@ namespace Recast
 */
 bool GenerateNavMesh(NavMeshT const& data, Util::Blob& generated);
 
+/// load the source meshes of a nav mesh as world space triangles
+void LoadSourceGeometry(NavMeshT const& data, Util::Array<float>& vertices, Util::Array<int>& triangles);
+
+/// everything needed to build a single tile, copied so the build can run on any thread
+struct TileBuildInput
+{
+    int tileX = 0;
+    int tileZ = 0;
+    /// world space triangles touching the tile
+    Util::Array<float> vertices;
+    Util::Array<int> triangles;
+    /// boxes carved out of the walkable area
+    Util::Array<Math::bbox> obstacles;
+};
+
+/// setup the params of a tiled nav mesh, returns false if the settings have no tile size
+bool SetupTiledNavMesh(NavMeshT const& data, dtNavMeshParams& params, int& tilesX, int& tilesZ);
+/// build a tile, navData is allocated with dtAlloc and is null if nothing is walkable
+bool BuildTile(NavMeshT const& data, TileBuildInput const& input, unsigned char*& navData, int& navDataSize);
+
 }
 }
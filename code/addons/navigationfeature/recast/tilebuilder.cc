@@ -0,0 +1,584 @@
+//------------------------------------------------------------------------------
+//  recast/tilebuilder.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "tilebuilder.h"
+#include "threading/thread.h"
+#include "profiling/profiling.h"
+#include "DetourNavMesh.h"
+#include "DetourAlloc.h"
+
+namespace Navigation
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+TileBuilder::TileBuilder() :
+    navMesh(nullptr),
+    tileWorldSize(1.0f),
+    borderSize(0.0f),
+    tilesX(0),
+    tilesZ(0),
+    maxConcurrentBuilds(1),
+    nodes(nullptr)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+TileBuilder::~TileBuilder()
+{
+    this->Discard();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+TileBuilder::Setup(dtNavMesh* mesh, NavMeshT const& meshInfo)
+{
+    n_assert(this->navMesh == nullptr);
+    n_assert(meshInfo.navmesh_settings != nullptr && meshInfo.agent_kind != nullptr);
+
+    dtNavMeshParams params;
+    if (!Recast::SetupTiledNavMesh(meshInfo, params, this->tilesX, this->tilesZ))
+        return false;
+    if (dtStatusFailed(mesh->init(&params)))
+        return false;
+
+    this->navMesh = mesh;
+    this->info = meshInfo;
+    this->origin = Math::vec3(params.orig[0], params.orig[1], params.orig[2]);
+    this->tileWorldSize = params.tileWidth;
+
+    // same border as the tile builds use, see Recast::BuildTile
+    const float cellSize = meshInfo.navmesh_settings->cell_size;
+    this->borderSize = (ceilf(meshInfo.agent_kind->agent_radius / cellSize) + 3) * cellSize;
+
+    this->tiles.Resize(this->tilesX * this->tilesZ);
+    this->builds.Resize(Math::max(Jobs2::ctx.threads.Size(), 1));
+    this->maxConcurrentBuilds = this->builds.Size();
+
+    // job nodes have no default constructor, they are set up in StartBuild
+    this->nodes = (Jobs2::JobNode*)Memory::Alloc(Memory::ObjectHeap, this->builds.Size() * sizeof(Jobs2::JobNode));
+    for (IndexT i = 0; i < this->builds.Size(); i++)
+        this->builds[i].node = &this->nodes[i];
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TileBuilder::Discard()
+{
+    for (Build& build : this->builds)
+    {
+        if (build.tile == InvalidIndex)
+            continue;
+        while (!IsDone(build))
+            Threading::Thread::YieldThread();
+        if (build.navData != nullptr)
+            dtFree(build.navData);
+        build.navData = nullptr;
+        build.tile = InvalidIndex;
+    }
+    this->builds.Clear();
+    if (this->nodes != nullptr)
+        Memory::Free(Memory::ObjectHeap, this->nodes);
+    this->nodes = nullptr;
+    this->tiles.Clear();
+    this->queue.Clear();
+    this->geometries.Clear();
+    this->obstacleIds.Clear();
+    this->obstacles.Clear();
+    this->navMesh = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Bins the triangles into all tiles they touch, borders included, so
+    gathering the input of a tile doesn't have to look at anything else.
+*/
+NavGeometryId
+TileBuilder::AddGeometry(const float* vertices, SizeT numVertices, const int* indices, SizeT numIndices, const Math::mat4& transform)
+{
+    n_assert(this->navMesh != nullptr);
+    n_assert(numIndices % 3 == 0);
+
+    Ids::Id32 id;
+    this->geometryPool.Allocate(id);
+    IndexT const index = Ids::Index(id);
+    if (index >= this->geometries.Size())
+        this->geometries.Resize(index + 1);
+
+    Geometry& geometry = this->geometries[index];
+    geometry.id = id;
+    geometry.vertices.Clear();
+    geometry.vertices.Reserve(numVertices * 3);
+    geometry.box.begin_extend();
+    for (IndexT i = 0; i < numVertices; i++)
+    {
+        Math::vec4 const p = transform * Math::vec4(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], 1.0f);
+        geometry.vertices.Append(p.x);
+        geometry.vertices.Append(p.y);
+        geometry.vertices.Append(p.z);
+        geometry.box.extend(Math::vec3(p.x, p.y, p.z));
+    }
+    geometry.box.end_extend();
+    geometry.indices.Clear();
+    geometry.indices.AppendArray(indices, numIndices);
+
+    for (IndexT i = 0; i < numIndices; i += 3)
+    {
+        Math::bbox triangle;
+        triangle.begin_extend();
+        for (IndexT j = 0; j < 3; j++)
+        {
+            const float* v = &geometry.vertices[geometry.indices[i + j] * 3];
+            triangle.extend(Math::vec3(v[0], v[1], v[2]));
+        }
+        triangle.end_extend();
+
+        int x0, z0, x1, z1;
+        if (!this->GetTileRange(triangle, this->borderSize, x0, z0, x1, z1))
+            continue;
+        for (int z = z0; z <= z1; z++)
+        {
+            for (int x = x0; x <= x1; x++)
+                this->tiles[x + z * this->tilesX].triangles.Append((uint64_t(index) << 32) | uint64_t(i));
+        }
+    }
+
+    this->MarkDirty(geometry.box, 0.0f);
+    return id;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TileBuilder::RemoveGeometry(NavGeometryId id)
+{
+    n_assert(this->geometryPool.IsValid(id.id));
+    IndexT const index = Ids::Index(id.id);
+    Geometry& geometry = this->geometries[index];
+
+    int x0, z0, x1, z1;
+    if (this->GetTileRange(geometry.box, this->borderSize, x0, z0, x1, z1))
+    {
+        for (int z = z0; z <= z1; z++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                Util::Array<uint64_t>& triangles = this->tiles[x + z * this->tilesX].triangles;
+                for (IndexT i = triangles.Size() - 1; i >= 0; i--)
+                {
+                    if (IndexT(triangles[i] >> 32) == index)
+                        triangles.EraseIndexSwap(i);
+                }
+            }
+        }
+    }
+    this->MarkDirty(geometry.box, 0.0f);
+
+    geometry.vertices.Clear();
+    geometry.indices.Clear();
+    this->geometryPool.Deallocate(id.id);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+NavObstacleId
+TileBuilder::AddObstacle(const Math::bbox& box)
+{
+    n_assert(this->navMesh != nullptr);
+    Ids::Id32 id;
+    this->obstaclePool.Allocate(id);
+    IndexT const index = Ids::Index(id);
+    if (index >= this->obstacles.Size())
+    {
+        this->obstacles.Resize(index + 1);
+        this->obstacleIds.Resize(index + 1);
+    }
+    this->obstacleIds[index] = id;
+    this->obstacles[index] = box;
+    this->MarkDirty(box, this->info.agent_kind->agent_radius);
+    return id;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Rebuilds the tiles around the old and the new place of the obstacle.
+*/
+void
+TileBuilder::MoveObstacle(NavObstacleId id, const Math::bbox& box)
+{
+    n_assert(this->obstaclePool.IsValid(id.id));
+    Math::bbox& obstacle = this->obstacles[Ids::Index(id.id)];
+
+    // moves below half a cell hardly change the voxels, wait until they add up
+    float const tolerance = this->info.navmesh_settings->cell_size * 0.5f;
+    if (Math::lengthsq(box.pmin - obstacle.pmin) < tolerance * tolerance
+        && Math::lengthsq(box.pmax - obstacle.pmax) < tolerance * tolerance)
+        return;
+
+    this->MarkDirty(obstacle, this->info.agent_kind->agent_radius);
+    this->MarkDirty(box, this->info.agent_kind->agent_radius);
+    obstacle = box;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TileBuilder::RemoveObstacle(NavObstacleId id)
+{
+    n_assert(this->obstaclePool.IsValid(id.id));
+    this->MarkDirty(this->obstacles[Ids::Index(id.id)], this->info.agent_kind->agent_radius);
+    this->obstaclePool.Deallocate(id.id);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TileBuilder::Invalidate(const Math::bbox& box)
+{
+    this->MarkDirty(box, 0.0f);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TileBuilder::InvalidateAll()
+{
+    for (IndexT i = 0; i < this->tiles.Size(); i++)
+        this->MarkDirty(i);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TileBuilder::SetMaxConcurrentBuilds(SizeT num)
+{
+    n_assert(num > 0);
+    this->maxConcurrentBuilds = Math::min(num, this->builds.Size());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+TileBuilder::GetNumPendingTiles() const
+{
+    SizeT num = this->queue.Size();
+    for (Build const& build : this->builds)
+    {
+        if (build.tile != InvalidIndex && !this->tiles[build.tile].queued)
+            num++;
+    }
+    return num;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Finished builds are picked up first, so their slots can be reused right
+    away. New builds pick the queued tile closest to any focus point, and
+    go in queue order if there are none.
+*/
+bool
+TileBuilder::Update(const Util::Array<Math::vec3>& focusPoints, Math::bbox& outChanged)
+{
+    N_SCOPE(UpdateNavMeshTiles, Navigation);
+    n_assert(this->navMesh != nullptr);
+
+    bool changed = false;
+    outChanged.begin_extend();
+    SizeT running = 0;
+    for (Build& build : this->builds)
+    {
+        if (build.tile == InvalidIndex)
+            continue;
+        if (IsDone(build))
+            changed |= this->FinishBuild(build, outChanged);
+        else
+            running++;
+    }
+    outChanged.end_extend();
+
+    if (this->queue.IsEmpty() || running >= this->maxConcurrentBuilds)
+        return changed;
+
+    // tiles the focus points are on, sorted and without duplicates
+    this->focusTiles.Clear();
+    for (Math::vec3 const& p : focusPoints)
+    {
+        int const x = (int)Math::floor((p.x - this->origin.x) / this->tileWorldSize);
+        int const z = (int)Math::floor((p.z - this->origin.z) / this->tileWorldSize);
+        if (x >= 0 && x < this->tilesX && z >= 0 && z < this->tilesZ)
+            this->focusTiles.Append(x + z * this->tilesX);
+    }
+    this->focusTiles.Sort();
+    IndexT unique = 0;
+    for (IndexT i = 0; i < this->focusTiles.Size(); i++)
+    {
+        if (unique == 0 || this->focusTiles[unique - 1] != this->focusTiles[i])
+            this->focusTiles[unique++] = this->focusTiles[i];
+    }
+    this->focusTiles.Resize(unique);
+
+    for (Build& build : this->builds)
+    {
+        if (running >= this->maxConcurrentBuilds)
+            break;
+        if (build.tile != InvalidIndex)
+            continue;
+
+        IndexT best = InvalidIndex;
+        int bestDistance = INT_MAX;
+        for (IndexT i = 0; i < this->queue.Size(); i++)
+        {
+            // tiles which changed while building wait for the running build to finish
+            if (this->tiles[this->queue[i]].building)
+                continue;
+            int const distance = this->GetFocusDistance(this->queue[i]);
+            if (distance < bestDistance)
+            {
+                best = i;
+                bestDistance = distance;
+                if (distance == 0)
+                    break;
+            }
+        }
+        if (best == InvalidIndex)
+            break;
+
+        IndexT const tile = this->queue[best];
+        this->queue.EraseIndex(best);
+        this->StartBuild(build, tile);
+        running++;
+    }
+    return changed;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TileBuilder::RunBuild(SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset, void* ctx)
+{
+    N_SCOPE(BuildNavMeshTile, Navigation);
+    Build* build = (Build*)ctx;
+    build->success = Recast::BuildTile(*build->info, build->input, build->navData, build->navDataSize);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+TileBuilder::IsDone(Build& build)
+{
+    // read with a barrier, the results are complete once the counter is 0
+    return Threading::Interlocked::CompareExchange(&build.counter, 0, 0) == 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+TileBuilder::GetTileRange(const Math::bbox& box, float padding, int& x0, int& z0, int& x1, int& z1) const
+{
+    x0 = (int)Math::floor((box.pmin.x - padding - this->origin.x) / this->tileWorldSize);
+    z0 = (int)Math::floor((box.pmin.z - padding - this->origin.z) / this->tileWorldSize);
+    x1 = (int)Math::floor((box.pmax.x + padding - this->origin.x) / this->tileWorldSize);
+    z1 = (int)Math::floor((box.pmax.z + padding - this->origin.z) / this->tileWorldSize);
+    if (x1 < 0 || z1 < 0 || x0 >= this->tilesX || z0 >= this->tilesZ)
+        return false;
+    x0 = Math::max(x0, 0);
+    z0 = Math::max(z0, 0);
+    x1 = Math::min(x1, this->tilesX - 1);
+    z1 = Math::min(z1, this->tilesZ - 1);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Math::bbox
+TileBuilder::GetTileBounds(IndexT tile) const
+{
+    Math::bbox box;
+    box.pmin = Math::point(
+        this->origin.x + (tile % this->tilesX) * this->tileWorldSize,
+        this->info.bounds_center.y - this->info.bounds_extents.y,
+        this->origin.z + (tile / this->tilesX) * this->tileWorldSize);
+    box.pmax = Math::point(
+        box.pmin.x + this->tileWorldSize,
+        this->info.bounds_center.y + this->info.bounds_extents.y,
+        box.pmin.z + this->tileWorldSize);
+    return box;
+}
+
+//------------------------------------------------------------------------------
+/**
+    A tile sees everything within its border, so changes that far outside
+    of it have to rebuild it too.
+*/
+void
+TileBuilder::MarkDirty(const Math::bbox& box, float padding)
+{
+    int x0, z0, x1, z1;
+    if (!this->GetTileRange(box, padding + this->borderSize, x0, z0, x1, z1))
+        return;
+    for (int z = z0; z <= z1; z++)
+    {
+        for (int x = x0; x <= x1; x++)
+            this->MarkDirty(x + z * this->tilesX);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TileBuilder::MarkDirty(IndexT tile)
+{
+    Tile& t = this->tiles[tile];
+    t.version++;
+    if (!t.queued)
+    {
+        t.queued = true;
+        this->queue.Append(tile);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TileBuilder::StartBuild(Build& build, IndexT tile)
+{
+    Tile& t = this->tiles[tile];
+    t.queued = false;
+    t.building = true;
+
+    build.tile = tile;
+    build.version = t.version;
+    build.navData = nullptr;
+    build.navDataSize = 0;
+    build.success = false;
+
+    // copy the triangles and obstacles the build can see
+    Recast::TileBuildInput& input = build.input;
+    input.tileX = tile % this->tilesX;
+    input.tileZ = tile / this->tilesX;
+    input.vertices.Clear();
+    input.triangles.Clear();
+    input.obstacles.Clear();
+    input.vertices.Reserve(t.triangles.Size() * 9);
+    input.triangles.Reserve(t.triangles.Size() * 3);
+    for (uint64_t ref : t.triangles)
+    {
+        Geometry const& geometry = this->geometries[IndexT(ref >> 32)];
+        IndexT const first = IndexT(ref & 0xFFFFFFFF);
+        for (IndexT j = 0; j < 3; j++)
+        {
+            input.triangles.Append(input.vertices.Size() / 3);
+            input.vertices.AppendArray(&geometry.vertices[geometry.indices[first + j] * 3], 3);
+        }
+    }
+
+    Math::bbox const bounds = this->GetTileBounds(tile);
+    float const reach = this->borderSize + this->info.agent_kind->agent_radius;
+    for (IndexT i = 0; i < this->obstacles.Size(); i++)
+    {
+        if (!this->obstaclePool.IsValid(this->obstacleIds[i]))
+            continue;
+        Math::bbox const& box = this->obstacles[i];
+        if (box.pmax.x + reach < bounds.pmin.x || box.pmin.x - reach > bounds.pmax.x
+            || box.pmax.z + reach < bounds.pmin.z || box.pmin.z - reach > bounds.pmax.z)
+            continue;
+        input.obstacles.Append(box);
+    }
+
+    build.info = &this->info;
+    build.counter = 1;
+
+    // without worker threads, build right away
+    if (Jobs2::ctx.threads.Size() == 0)
+    {
+        RunBuild(1, 1, 0, 0, &build);
+        build.counter = 0;
+        return;
+    }
+
+    Jobs2::JobEnqueue(build.node, RunBuild, 1, 1, &build, &build.counter);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Results of tiles which changed during the build are dropped, the tile
+    is in the queue again already. Failed builds keep the old tile.
+*/
+bool
+TileBuilder::FinishBuild(Build& build, Math::bbox& outChanged)
+{
+    IndexT const tile = build.tile;
+    build.tile = InvalidIndex;
+    Tile& t = this->tiles[tile];
+    t.building = false;
+
+    if (t.version != build.version || !build.success)
+    {
+        if (!build.success)
+            n_warning("TileBuilder: failed to build tile %d of nav mesh '%s'\n", tile, this->info.name.AsCharPtr());
+        if (build.navData != nullptr)
+            dtFree(build.navData);
+        build.navData = nullptr;
+        return false;
+    }
+
+    int const x = tile % this->tilesX;
+    int const z = tile / this->tilesX;
+    dtTileRef const old = this->navMesh->getTileRefAt(x, z, 0);
+    if (old != 0)
+        this->navMesh->removeTile(old, nullptr, nullptr);
+    if (build.navData != nullptr
+        && dtStatusFailed(this->navMesh->addTile(build.navData, build.navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
+    {
+        n_warning("TileBuilder: failed to add tile %d to nav mesh '%s'\n", tile, this->info.name.AsCharPtr());
+        dtFree(build.navData);
+    }
+    build.navData = nullptr;
+
+    outChanged.extend(this->GetTileBounds(tile));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+TileBuilder::GetFocusDistance(IndexT tile) const
+{
+    int const x = tile % this->tilesX;
+    int const z = tile / this->tilesX;
+    int distance = this->focusTiles.IsEmpty() ? 0 : INT_MAX;
+    for (IndexT focus : this->focusTiles)
+    {
+        int const dx = Math::abs(focus % this->tilesX - x);
+        int const dz = Math::abs(focus / this->tilesX - z);
+        distance = Math::min(distance, Math::max(dx, dz));
+    }
+    return distance;
+}
+
+} // namespace Navigation
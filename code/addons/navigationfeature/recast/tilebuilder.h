@@ -0,0 +1,160 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Navigation::TileBuilder
+
+    Rebuilds the tiles of a tiled nav mesh while the game is running.
+
+    The builder keeps the input triangles of the nav mesh in world space,
+    binned by the tiles they touch, and a set of obstacle boxes which are
+    cut out of the walkable area. Adding, moving or removing any of them
+    marks the tiles underneath as dirty.
+
+    Update() swaps finished tiles into the dtNavMesh and starts Recast
+    builds of dirty tiles as Jobs2 jobs, the tiles closest to the given
+    focus points (usually the agents) first. A build only works on a copy
+    of the triangles and obstacles around its tile, taken when it starts,
+    so the main thread never waits for a build. Tiles which change again
+    while they are being built are thrown away when done and built again.
+
+    Tiles are only swapped during Update(), so nothing else may search the
+    nav mesh at the same time.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "ids/id.h"
+#include "ids/idgenerationpool.h"
+#include "util/array.h"
+#include "util/fixedarray.h"
+#include "math/bbox.h"
+#include "math/mat4.h"
+#include "threading/interlocked.h"
+#include "jobs2/jobs2.h"
+#include "recastutil.h"
+
+class dtNavMesh;
+
+namespace Navigation
+{
+
+ID_24_8_TYPE(NavGeometryId);
+ID_24_8_TYPE(NavObstacleId);
+
+class TileBuilder
+{
+public:
+    /// constructor
+    TileBuilder();
+    /// destructor
+    ~TileBuilder();
+
+    /// initialize an empty nav mesh with the tile grid of the settings, returns false if the settings have no tile size
+    bool Setup(dtNavMesh* navMesh, NavMeshT const& info);
+    /// wait for running builds and forget all input
+    void Discard();
+
+    /// add triangles, indices are three per triangle
+    NavGeometryId AddGeometry(const float* vertices, SizeT numVertices, const int* indices, SizeT numIndices, const Math::mat4& transform);
+    /// remove triangles
+    void RemoveGeometry(NavGeometryId id);
+    /// add a box agents can't walk into
+    NavObstacleId AddObstacle(const Math::bbox& box);
+    /// move or resize an obstacle
+    void MoveObstacle(NavObstacleId id, const Math::bbox& box);
+    /// remove an obstacle
+    void RemoveObstacle(NavObstacleId id);
+    /// rebuild all tiles touching a box
+    void Invalidate(const Math::bbox& box);
+    /// rebuild all tiles
+    void InvalidateAll();
+
+    /// set how many tiles may be built at the same time
+    void SetMaxConcurrentBuilds(SizeT num);
+    /// get number of tiles waiting for a build or being built
+    SizeT GetNumPendingTiles() const;
+
+    /// swap in finished tiles and start new builds, returns true and the area of the swapped tiles if any were swapped
+    bool Update(const Util::Array<Math::vec3>& focusPoints, Math::bbox& outChanged);
+
+private:
+    /// triangles in world space
+    struct Geometry
+    {
+        Ids::Id32 id;
+        Util::Array<float> vertices;
+        Util::Array<int> indices;
+        Math::bbox box;
+    };
+
+    /// a cell of the tile grid
+    struct Tile
+    {
+        /// bumped by every change, builds of older versions are dropped
+        uint version = 0;
+        bool queued = false;
+        bool building = false;
+        /// triangles touching the tile or its border, geometry index in the upper and first index in the lower bits
+        Util::Array<uint64_t> triangles;
+    };
+
+    /// a tile build, running as long as the counter isn't zero
+    struct Build
+    {
+        /// builds may take several frames, so the node can't come from the per frame job memory
+        Jobs2::JobNode* node = nullptr;
+        Threading::AtomicCounter counter = 0;
+        const NavMeshT* info = nullptr;
+        IndexT tile = InvalidIndex;
+        uint version = 0;
+        Recast::TileBuildInput input;
+        unsigned char* navData = nullptr;
+        int navDataSize = 0;
+        bool success = false;
+    };
+
+    /// job function running a build
+    static void RunBuild(SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset, void* ctx);
+    /// returns true if a build has finished, with a barrier
+    static bool IsDone(Build& build);
+
+    /// get the range of tiles a box grown by padding touches, returns false if it's outside the grid
+    bool GetTileRange(const Math::bbox& box, float padding, int& x0, int& z0, int& x1, int& z1) const;
+    /// get the bounds of a tile
+    Math::bbox GetTileBounds(IndexT tile) const;
+    /// mark all tiles in a box dirty
+    void MarkDirty(const Math::bbox& box, float padding);
+    /// queue a tile for a build
+    void MarkDirty(IndexT tile);
+    /// copy the input of a tile and start building it
+    void StartBuild(Build& build, IndexT tile);
+    /// swap in the result of a build, returns true if the nav mesh has changed
+    bool FinishBuild(Build& build, Math::bbox& outChanged);
+    /// get the distance in tiles from a tile to the nearest focus tile
+    int GetFocusDistance(IndexT tile) const;
+
+    dtNavMesh* navMesh;
+    NavMeshT info;
+    Math::vec3 origin;
+    float tileWorldSize;
+    /// how far a tile build looks beyond the tile
+    float borderSize;
+    int tilesX;
+    int tilesZ;
+
+    Util::Array<Tile> tiles;
+    Util::Array<IndexT> queue;
+    Util::FixedArray<Build> builds;
+    Jobs2::JobNode* nodes;
+    SizeT maxConcurrentBuilds;
+    Util::Array<IndexT> focusTiles;
+
+    Ids::IdGenerationPool geometryPool;
+    Util::Array<Geometry> geometries;
+    Ids::IdGenerationPool obstaclePool;
+    Util::Array<Ids::Id32> obstacleIds;
+    Util::Array<Math::bbox> obstacles;
+};
+
+} // namespace Navigation
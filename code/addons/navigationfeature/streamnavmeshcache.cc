@@ -7,6 +7,7 @@
 #include "resources/resourceserver.h"
 #include "DetourNavMesh.h"
 #include "DetourNavMeshQuery.h"
+#include "recast/tilebuilder.h"
 
 namespace Navigation
 {
@@ -41,6 +42,15 @@ StreamNavMeshCache::GetDetourMesh(NavMeshId id)
 
 
 
+//------------------------------------------------------------------------------
+/**
+*/
+TileBuilder*
+StreamNavMeshCache::GetTileBuilder(NavMeshId id)
+{
+    return this->allocator.Get<Nav_Tiles>(id.resourceId);
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -88,6 +98,32 @@ StreamNavMeshCache::InitializeResource(const ResourceLoadJob& job, const Ptr<IO:
     stream->Unmap();
 
     this->allocator.Set<Nav_Name>(ret.resourceId, meshInfo.name);
+    this->allocator.Set<Nav_Tiles>(ret.resourceId, nullptr);
+
+    if (meshInfo.navmesh_settings != nullptr && meshInfo.navmesh_settings->tile_size > 0)
+    {
+        // tiled meshes are built from the source meshes at runtime, nearest tiles first
+        navMesh = dtAllocNavMesh();
+        navMeshQuery = dtAllocNavMeshQuery();
+        TileBuilder* builder = new TileBuilder;
+        if (builder->Setup(navMesh, meshInfo))
+        {
+            Util::Array<float> vertices;
+            Util::Array<int> triangles;
+            Recast::LoadSourceGeometry(meshInfo, vertices, triangles);
+            if (!triangles.IsEmpty())
+                builder->AddGeometry(vertices.Begin(), vertices.Size() / 3, triangles.Begin(), triangles.Size(), Math::mat4::identity);
+            navMeshQuery->init(navMesh, MAX_NAV_NODES);
+            this->allocator.Set<Nav_Tiles>(ret.resourceId, builder);
+            retVal.id = ret;
+        }
+        else
+        {
+            n_warning("StreamNavMeshCache: failed to setup tiled nav mesh '%s'\n", meshInfo.name.AsCharPtr());
+            delete builder;
+        }
+        return retVal;
+    }
 
     Ptr<IO::Stream> storedNavMesh = IO::IoServer::Instance()->CreateStream(meshInfo.file);
     if (storedNavMesh->Open())
@@ -116,6 +152,10 @@ StreamNavMeshCache::Unload(const Resources::ResourceId res)
 {
     dtNavMesh*& navMesh = this->allocator.Get<Nav_Mesh>(res.resourceId);
     dtNavMeshQuery*& navMeshQuery = this->allocator.Get<Nav_Query>(res.resourceId);
+    TileBuilder*& builder = this->allocator.Get<Nav_Tiles>(res.resourceId);
+    // running tile builds have to finish before the mesh goes away
+    delete builder;
+    builder = nullptr;
     dtFreeNavMesh(navMesh);
     dtFreeNavMeshQuery(navMeshQuery);
     this->allocator.Dealloc(res.resourceId);
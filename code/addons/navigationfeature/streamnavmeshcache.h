@@ -22,6 +22,8 @@ class dtNavMeshQuery;
 namespace Navigation
 {
 
+class TileBuilder;
+
 enum NavigationIdType
 {
     NavMeshIdType
@@ -43,6 +45,9 @@ public:
     ///
     dtNavMesh* GetDetourMesh(NavMeshId id);
 
+    /// get the tile builder of a nav mesh, null if the mesh was baked in a single tile
+    TileBuilder* GetTileBuilder(NavMeshId id);
+
     ///
     Util::Array<NavMeshId> GetLoadedMeshes();
 
@@ -58,13 +63,15 @@ private:
         Nav_Name,
         Nav_Mesh,
         Nav_Query,
-        Nav_MeshInfo
+        Nav_MeshInfo,
+        Nav_Tiles
     };
     Ids::IdAllocatorSafe<0xff,
         Util::StringAtom,
         dtNavMesh*,
         dtNavMeshQuery*,
-        NavMeshT> allocator;
+        NavMeshT,
+        TileBuilder*> allocator;
 };
 }
 
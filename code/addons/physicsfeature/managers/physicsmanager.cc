@@ -15,6 +15,9 @@
 #include "basegamefeature/components/orientation.h"
 #include "basegamefeature/components/scale.h"
 #include "basegamefeature/components/velocity.h"
+#include "game/editorstate.h"
+#include "jobs2/jobs2.h"
+#include "profiling/profiling.h"
 
 namespace PhysicsFeature
 {
@@ -92,18 +95,6 @@ PhysicsManager::OnDecay()
     }
 }
 
-//------------------------------------------------------------------------------
-/**
-*/
-void
-PollRigidbodyTransforms(Game::World* world, Game::Position& position, Game::Orientation& orientation, PhysicsFeature::PhysicsActor const& actor)
-{
-    if (actor.actorId != -1)
-    {
-        Physics::ActorContext::GetPositionOrientation(actor.actorId, position, orientation);
-    }
-}
-
 //------------------------------------------------------------------------------
 /**
 */
@@ -122,12 +113,6 @@ void
 PhysicsManager::InitPollTransformProcessor()
 {
     Game::World* world = Game::GetWorld(WORLD_DEFAULT);
-    Game::ProcessorBuilder(world, "PhysicsManager.PollRigidbodyTransforms"_atm)
-        .Excluding<Game::Static, IsKinematic>()
-        .On("OnFrame")
-        .Func(&PollRigidbodyTransforms)
-        .Build();
-
     Game::ProcessorBuilder(world, "PhysicsManager.PassKinematicTransforms"_atm)
         .Excluding<Game::Static>()
         .On("OnFrame")
@@ -136,6 +121,61 @@ PhysicsManager::InitPollTransformProcessor()
         .Build();
 }
 
+//------------------------------------------------------------------------------
+/**
+    Copies the transforms of all actors moved by the last simulation steps
+    straight into the position and orientation columns of their entities.
+    Only rows are written, never the table layout, so batches of actors can
+    be processed by jobs in parallel.
+*/
+void
+PhysicsManager::WriteBackTransforms(Game::World* world, IndexT scene)
+{
+#ifdef WITH_NEBULA_EDITOR
+    if (Game::EditorState::HasInstance())
+    {
+        Game::EditorState* editor = Game::EditorState::Instance();
+        if (editor->isRunning && !editor->isPlaying)
+            return;
+    }
+#endif
+
+    Util::Array<Physics::ActorTransform> const& transforms = Physics::GetActiveTransforms(scene);
+    if (transforms.IsEmpty())
+        return;
+
+    N_SCOPE(WriteBackTransforms, Physics);
+    Physics::ActorTransform const* data = transforms.Begin();
+    Threading::Event event;
+    Jobs2::JobDispatch(
+        [world, data](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+        {
+            for (IndexT i = 0; i < groupSize; i++)
+            {
+                IndexT const index = i + invocationOffset;
+                if (index >= totalJobs)
+                    return;
+
+                Game::Entity const entity = Game::Entity::FromId((Ids::Id64)data[index].userData);
+                if (!world->IsValid(entity) || !world->HasInstance(entity))
+                    continue;
+
+                Game::EntityMapping const mapping = world->GetEntityMapping(entity);
+                Game::Position* positions = (Game::Position*)world->GetColumnData(mapping.table, mapping.instance.partition, Game::Position::Traits::fixed_column_index);
+                Game::Orientation* orientations = (Game::Orientation*)world->GetColumnData(mapping.table, mapping.instance.partition, Game::Orientation::Traits::fixed_column_index);
+                positions[mapping.instance.index] = data[index].position;
+                orientations[mapping.instance.index] = data[index].orientation;
+            }
+        },
+        transforms.Size(),
+        256,
+        nullptr,
+        nullptr,
+        &event
+    );
+    event.Wait();
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -37,6 +37,8 @@ public:
     void OnCleanup(Game::World* world) override;
 
     static void InitPhysicsActor(Game::World*, Game::Entity, PhysicsFeature::PhysicsActor*);
+    /// write the transforms of the actors moved by the last simulation steps into the entities of a world
+    static void WriteBackTransforms(Game::World* world, IndexT scene);
 
 private:
     void InitPollTransformProcessor();
@@ -166,12 +166,20 @@ PhysicsFeatureUnit::OnBeginFrame()
 #if USE_SYNC_UPDATE > 0
     Game::TimeSource* const time = Game::Time::GetTimeSource(TIMESOURCE_PHYSICS);
     Physics::Update(time->frameTime);
+    for (auto const& scene : this->physicsWorlds)
+    {
+        PhysicsManager::WriteBackTransforms(scene.Key(), scene.Value());
+    }
 #else
+    // the step kicked off in OnDecay of the previous frame ran alongside everything in between
     if (!simulating) return;
 
     for (auto const& scene : this->physicsWorlds)
     {
-        Physics::EndSimulating(scene.Value());
+        if (Physics::EndSimulating(scene.Value()))
+        {
+            PhysicsManager::WriteBackTransforms(scene.Key(), scene.Value());
+        }
     }
     simulating = false;
 #endif
@@ -22,6 +22,7 @@
 #include "basegamefeature/basegamefeatureunit.h"
 #include "nflatbuffer/flatbufferinterface.h"
 #include "profiling/profiling.h"
+#include "profiling/trace.h"
 
 namespace App
 {
@@ -123,6 +124,15 @@ GameApplication::Open()
 
 #if NEBULA_ENABLE_PROFILING
         Profiling::ProfilingRegisterThread(15);
+
+        // capture a binary trace of the whole run with -trace <file>
+        const Util::CommandLineArgs& args = this->GetCmdLineArgs();
+        if (args.HasArg("-trace"))
+        {
+            Profiling::TraceCaptureInfo traceInfo;
+            traceInfo.path = args.GetString("-trace");
+            Profiling::ProfilingTraceStart(traceInfo);
+        }
 #endif
 
         // attach a log file console handler
@@ -183,6 +193,17 @@ GameApplication::Close()
 
     //_discard_timer(GameApplicationFrameTimeAll);
 
+#if NEBULA_ENABLE_PROFILING
+    // finish the trace capture, -tracejson <file> also converts it to Chrome trace event JSON
+    if (Profiling::ProfilingTraceIsCapturing())
+    {
+        Profiling::ProfilingTraceStop();
+        const Util::CommandLineArgs& args = this->GetCmdLineArgs();
+        if (args.HasArg("-tracejson"))
+            Profiling::ProfilingTraceConvertToJson(args.GetString("-trace"), args.GetString("-tracejson"));
+    }
+#endif
+
     // shutdown basic Nebula runtime
     this->gameServer->Stop();
     this->gameServer->CleanupWorld(Game::GetWorld(WORLD_DEFAULT));
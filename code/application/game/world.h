@@ -19,6 +19,7 @@
 #include "memory/arenaallocator.h"
 #include "frameevent.h"
 #include "util/fourcc.h"
+#include "util/flathashtable.h"
 
 namespace MemDb
 {
@@ -283,7 +284,7 @@ private:
     /// world id
     WorldId worldId;
     /// maps from blueprint to a table that has the same signature
-    Util::HashTable<BlueprintId, MemDb::TableId> blueprintToTableMap;
+    Util::FlatHashTable<BlueprintId, MemDb::TableId> blueprintToTableMap;
     /// Stores all deferred allocation commands
     Util::Queue<AllocateInstanceCommand> allocQueue;
     /// Stores all deferred deallocation commands
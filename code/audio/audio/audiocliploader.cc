@@ -0,0 +1,159 @@
+//------------------------------------------------------------------------------
+//  audiocliploader.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "audiocliploader.h"
+#include "audiodevice.h"
+#include "soloud.h"
+#include "soloud_wav.h"
+#include "soloud_wavstream.h"
+
+namespace Audio
+{
+
+__ImplementClass(Audio::AudioClipLoader, 'AUCL', Resources::ResourceLoader);
+
+//------------------------------------------------------------------------------
+/**
+*/
+AudioClipLoader::AudioClipLoader() :
+    streamingThreshold(1024 * 1024)
+{
+    this->async = true;
+    this->streamerThreadName = "Audio Clip Streamer Thread";
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+AudioClipLoader::~AudioClipLoader()
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SoLoud::AudioSource*
+AudioClipLoader::GetSource(const Resources::ResourceId id)
+{
+    __LockName(&this->allocator, lock, id.resourceId);
+    return this->allocator.Get<Clip_Source>(id.resourceId);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+float
+AudioClipLoader::GetLength(const Resources::ResourceId id)
+{
+    __LockName(&this->allocator, lock, id.resourceId);
+    return this->allocator.Get<Clip_Length>(id.resourceId);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+AudioClipLoader::IsStreamed(const Resources::ResourceId id)
+{
+    __LockName(&this->allocator, lock, id.resourceId);
+    return this->allocator.Get<Clip_Streamed>(id.resourceId);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Reads the whole file in one go. Short clips are decoded into a Wav and
+    the file data is thrown away, long clips keep the encoded data and
+    decode it in small chunks on the mixer thread.
+*/
+Resources::ResourceLoader::ResourceInitOutput
+AudioClipLoader::InitializeResource(const ResourceLoadJob& job, const Ptr<IO::Stream>& stream)
+{
+    Resources::ResourceLoader::ResourceInitOutput ret;
+    const SizeT size = (SizeT)stream->GetSize();
+    if (size == 0)
+    {
+        n_warning("AudioClipLoader: '%s' is empty\n", job.name.AsCharPtr());
+        return ret;
+    }
+
+    void* data = Memory::Alloc(Memory::ResourceHeap, size);
+    if (stream->Read(data, size) != size)
+    {
+        n_warning("AudioClipLoader: failed to read '%s'\n", job.name.AsCharPtr());
+        Memory::Free(Memory::ResourceHeap, data);
+        return ret;
+    }
+
+    SoLoud::AudioSource* source = nullptr;
+    double length = 0.0;
+    const bool streamed = size >= this->streamingThreshold;
+    SoLoud::result result;
+    if (streamed)
+    {
+        // the wav stream reads from our buffer for as long as it lives
+        SoLoud::WavStream* wavStream = new SoLoud::WavStream;
+        result = wavStream->loadMem((const unsigned char*)data, (unsigned int)size, false, false);
+        length = wavStream->getLength();
+        source = wavStream;
+    }
+    else
+    {
+        SoLoud::Wav* wav = new SoLoud::Wav;
+        result = wav->loadMem((const unsigned char*)data, (unsigned int)size, false, false);
+        length = wav->getLength();
+        source = wav;
+        Memory::Free(Memory::ResourceHeap, data);
+        data = nullptr;
+    }
+
+    if (result != SoLoud::SOLOUD_ERRORS::SO_NO_ERROR)
+    {
+        n_warning("AudioClipLoader: failed to decode '%s' (%d)\n", job.name.AsCharPtr(), result);
+        delete source;
+        if (data != nullptr)
+            Memory::Free(Memory::ResourceHeap, data);
+        return ret;
+    }
+    source->set3dAttenuation(SoLoud::AudioSource::ATTENUATION_MODELS::LINEAR_DISTANCE, 1.0f);
+
+    Ids::Id32 id = this->allocator.Alloc();
+    this->allocator.Set<Clip_Source>(id, source);
+    this->allocator.Set<Clip_EncodedData>(id, data);
+    this->allocator.Set<Clip_Length>(id, (float)length);
+    this->allocator.Set<Clip_Streamed>(id, streamed);
+    this->allocator.Release(id);
+
+    ret.id = id;
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AudioClipLoader::Unload(const Resources::ResourceId id)
+{
+    SoLoud::AudioSource* source;
+    void* data;
+    {
+        __LockName(&this->allocator, lock, id.resourceId);
+        source = this->allocator.Get<Clip_Source>(id.resourceId);
+        data = this->allocator.Get<Clip_EncodedData>(id.resourceId);
+        this->allocator.Set<Clip_Source>(id.resourceId, nullptr);
+        this->allocator.Set<Clip_EncodedData>(id.resourceId, nullptr);
+    }
+
+    // the source stops its voices on destruction, which it can't do once the device is gone
+    if (!AudioDevice::HasInstance())
+        source->mSoloud = nullptr;
+    delete source;
+    if (data != nullptr)
+        Memory::Free(Memory::ResourceHeap, data);
+
+    this->allocator.Dealloc(id.resourceId);
+}
+
+} // namespace Audio
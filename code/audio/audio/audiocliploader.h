@@ -0,0 +1,92 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Audio::AudioClipLoader
+
+    Resource loader for audio clips (wav, ogg, mp3 and flac).
+
+    Files are read through the IO::IoServer on the loader thread, so they
+    can live in archives and never block the main thread. Clips smaller than
+    the streaming threshold are decoded to PCM right away. Larger clips,
+    which are usually music or ambience, only keep their encoded file in
+    memory and are decoded while they play.
+
+    Clips are shared by name and unloaded once the last user discarded them.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "resources/resourceloader.h"
+#include "ids/idallocator.h"
+
+namespace SoLoud
+{
+class AudioSource;
+}
+
+namespace Audio
+{
+
+class AudioClipLoader : public Resources::ResourceLoader
+{
+    __DeclareClass(AudioClipLoader);
+public:
+    /// constructor
+    AudioClipLoader();
+    /// destructor
+    virtual ~AudioClipLoader();
+
+    /// get the playable source of a loaded clip
+    SoLoud::AudioSource* GetSource(const Resources::ResourceId id);
+    /// get the length of a loaded clip in seconds
+    float GetLength(const Resources::ResourceId id);
+    /// returns true if the clip is decoded while playing
+    bool IsStreamed(const Resources::ResourceId id);
+
+    /// set file size from which clips are streamed instead of decoded on load, must be called before loading
+    void SetStreamingThreshold(SizeT numBytes);
+    /// get streaming threshold
+    SizeT GetStreamingThreshold() const;
+
+private:
+    /// read and decode clip, called on the loader thread
+    ResourceLoader::ResourceInitOutput InitializeResource(const ResourceLoadJob& job, const Ptr<IO::Stream>& stream) override;
+    /// unload clip
+    void Unload(const Resources::ResourceId id) override;
+
+    enum
+    {
+        Clip_Source,
+        Clip_EncodedData,
+        Clip_Length,
+        Clip_Streamed
+    };
+    Ids::IdAllocatorSafe<0xFFFF,
+        SoLoud::AudioSource*,
+        void*,
+        float,
+        bool> allocator;
+
+    SizeT streamingThreshold;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+AudioClipLoader::SetStreamingThreshold(SizeT numBytes)
+{
+    this->streamingThreshold = numBytes;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+AudioClipLoader::GetStreamingThreshold() const
+{
+    return this->streamingThreshold;
+}
+
+} // namespace Audio
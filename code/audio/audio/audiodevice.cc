@@ -4,10 +4,9 @@
 //------------------------------------------------------------------------------
 #include "foundation/stdneb.h"
 #include "audiodevice.h"
+#include "audiocliploader.h"
 #include "soloud.h"
-#include "soloud_wav.h"
-
-#include "io/uri.h"
+#include "resources/resourceserver.h"
 
 namespace Audio
 {
@@ -37,11 +36,14 @@ AudioDevice::Open()
 {
     soloud = new SoLoud::Soloud;
     soloud->init(SoLoud::Soloud::CLIP_ROUNDOFF);
-    soloud->setMaxActiveVoiceCount(32);
+    // leave room for voices which are fading out after being demoted or stopped
+    soloud->setMaxActiveVoiceCount(MaxRealVoices * 2);
+    this->voices.Setup(soloud, MaxRealVoices);
     this->ResetListener();
 
     _setup_grouped_timer(AudioOnFrameTime, "Audio Subsystem");
     _setup_grouped_counter(AudioNumberOfSoundsPlaying, "Audio Subsystem");
+    _setup_grouped_counter(AudioNumberOfVirtualVoices, "Audio Subsystem");
 
     return true;
 }
@@ -52,12 +54,15 @@ AudioDevice::Open()
 bool
 AudioDevice::Close()
 {
+    this->voices.Discard();
     soloud->deinit();
     delete soloud;
 
     _discard_timer(AudioOnFrameTime);
     _end_counter(AudioNumberOfSoundsPlaying);
     _discard_counter(AudioNumberOfSoundsPlaying);
+    _end_counter(AudioNumberOfVirtualVoices);
+    _discard_counter(AudioNumberOfVirtualVoices);
 
     return true;
 }
@@ -70,50 +75,69 @@ AudioDevice::OnFrame()
 {
     _start_timer(AudioOnFrameTime);
 
+    Math::vec3 const listenerPosition(this->listener.position[0], this->listener.position[1], this->listener.position[2]);
+    this->voices.Update(listenerPosition);
     soloud->update3dAudio();
 
     _stop_timer(AudioOnFrameTime);
     _begin_counter(AudioNumberOfSoundsPlaying);
     _set_counter(AudioNumberOfSoundsPlaying, soloud->getActiveVoiceCount());
     _end_counter(AudioNumberOfSoundsPlaying);
+    _begin_counter(AudioNumberOfVirtualVoices);
+    _set_counter(AudioNumberOfVirtualVoices, this->voices.GetNumVoices() - this->voices.GetNumRealVoices());
+    _end_counter(AudioNumberOfVirtualVoices);
 }
 
 //------------------------------------------------------------------------------
 /**
+    Clips are shared by name. The clip id is valid right away, but the clip
+    can't be played until the loader thread has finished decoding it.
+    If the clip is already being loaded, immediate has no effect.
 */
 ClipId
-AudioDevice::LoadClip(Resources::ResourceName const& name)
+AudioDevice::LoadClip(Resources::ResourceName const& name, bool immediate)
 {
     if (!name.IsValid())
     {
         return ClipId::Invalid();
     }
 
-    ClipId clip;
-
-    // load resource if we haven't already.
+    // share the clip if it's already in use
     IndexT index = this->clipMap.FindIndex(name);
     if (index != InvalidIndex)
     {
-        clip = this->clipMap.ValueAtIndex(index);
+        ClipId clip = this->clipMap.ValueAtIndex(index);
+        this->clips.Get<ClipSlot::REFCOUNT>(clip.id)++;
+        return clip;
     }
-    else
+
+    ClipId clip = this->clips.Alloc();
+    this->clips.Get<ClipSlot::NAME>(clip.id) = name;
+    this->clips.Get<ClipSlot::SOURCE>(clip.id) = nullptr;
+    this->clips.Get<ClipSlot::REFCOUNT>(clip.id) = 1;
+    this->clipMap.Add(name, clip);
+
+    // runs on the main thread once the clip is loaded, or right away if it already is
+    auto onLoaded = [this, clip](const Resources::ResourceId id)
     {
-        clip = this->wavs.Alloc();
-        IO::URI uri(name.Value());
-        auto result = this->wavs.Get<WavAllocator::WAV>(clip.id).load(uri.LocalPath().AsCharPtr());
-        if (result != SoLoud::SOLOUD_ERRORS::SO_NO_ERROR)
-        {
-            this->wavs.Dealloc(clip.id);
-            return ClipId::Invalid();
-        }
-
-        this->clipMap.Add(name, clip);
-        this->wavs.Get<WavAllocator::REFCOUNT>(clip.id) = 0;
-    }
+        // the clip might have been unloaded while it was loading
+        Resources::ResourceId& resource = this->clips.Get<ClipSlot::RESOURCE>(clip.id);
+        if (resource.loaderInstanceId != id.loaderInstanceId || this->clips.Get<ClipSlot::REFCOUNT>(clip.id) == 0)
+            return;
+        resource = id;
+        AudioClipLoader* loader = Resources::GetStreamLoader<AudioClipLoader>();
+        this->clips.Get<ClipSlot::SOURCE>(clip.id) = loader->GetSource(id);
+        this->clips.Get<ClipSlot::LENGTH>(clip.id) = loader->GetLength(id);
+    };
+    auto onFailed = [name](const Resources::ResourceId id)
+    {
+        n_warning("AudioDevice: could not load audio clip '%s'\n", name.Value());
+    };
 
-    this->wavs.Get<WavAllocator::REFCOUNT>(clip.id)++;
-    this->wavs.Get<WavAllocator::WAV>(clip.id).set3dAttenuation(SoLoud::AudioSource::ATTENUATION_MODELS::LINEAR_DISTANCE, 1.0f);
+    // decoding happens on the loader thread, the listener picks up the source when it's done
+    Resources::ResourceId const resource = Resources::CreateResource(name, "audio"_atm, nullptr, nullptr, immediate, false);
+    this->clips.Get<ClipSlot::RESOURCE>(clip.id) = resource;
+    Resources::CreateResourceListener(resource, onLoaded, onFailed);
 
     return clip;
 }
@@ -127,52 +151,50 @@ AudioDevice::UnloadClip(ClipId const clip)
     if (clip == InvalidClipId)
         return;
 
-    uint& refCount = this->wavs.Get<WavAllocator::REFCOUNT>(clip.id);
+    uint& refCount = this->clips.Get<ClipSlot::REFCOUNT>(clip.id);
+    n_assert(refCount > 0);
     refCount--;
     if (refCount == 0)
     {
-        this->wavs.Get<WavAllocator::WAV>(clip.id).~Wav();
-        this->wavs.Dealloc(clip.id);
+        // stop playing before the loader is allowed to delete the source, this includes voices still fading out
+        this->voices.StopClip(clip);
+        SoLoud::AudioSource* source = this->clips.Get<ClipSlot::SOURCE>(clip.id);
+        if (source != nullptr)
+            soloud->stopAudioSource(*source);
+
+        Resources::DiscardResource(this->clips.Get<ClipSlot::RESOURCE>(clip.id));
+        this->clipMap.Erase(this->clips.Get<ClipSlot::NAME>(clip.id));
+        this->clips.Get<ClipSlot::SOURCE>(clip.id) = nullptr;
+        this->clips.Dealloc(clip.id);
     }
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+Resources::Resource::State
+AudioDevice::GetClipState(ClipId const clip) const
+{
+    if (clip == InvalidClipId)
+        return Resources::Resource::Failed;
+    if (this->clips.ConstGet<ClipSlot::SOURCE>(clip.id) != nullptr)
+        return Resources::Resource::Loaded;
+    return Resources::ResourceServer::Instance()->GetState(this->clips.ConstGet<ClipSlot::RESOURCE>(clip.id));
+}
+
 //------------------------------------------------------------------------------
 /**
 */
 AudioEmitterId
 AudioDevice::CreateAudioEmitter(Resources::ResourceName const& name)
 {
-    if (!name.IsValid())
+    ClipId clip = this->LoadClip(name);
+    if (clip == InvalidClipId)
     {
         return AudioEmitterId::Invalid();
     }
 
-    ClipId clip;
-
-    // first, load resource if we haven't already.
-    IndexT index = this->clipMap.FindIndex(name);
-    if (index != InvalidIndex)
-    {
-        clip = this->clipMap.ValueAtIndex(index);
-    }
-    else
-    {
-        clip = this->wavs.Alloc();
-        IO::URI uri(name.Value());
-        auto result = this->wavs.Get<WavAllocator::WAV>(clip.id).load(uri.LocalPath().AsCharPtr());
-        if (result != SoLoud::SOLOUD_ERRORS::SO_NO_ERROR)
-        {
-            this->wavs.Dealloc(clip.id);
-            return AudioEmitterId::Invalid();
-        }
-
-        this->clipMap.Add(name, clip);
-        this->wavs.Get<WavAllocator::REFCOUNT>(clip.id) = 0;
-    }
-
     AudioEmitterId aeid = this->emitterAllocator.Alloc();
-    this->wavs.Get<WavAllocator::REFCOUNT>(clip.id)++;
-    this->wavs.Get<WavAllocator::WAV>(clip.id).set3dAttenuation(SoLoud::AudioSource::ATTENUATION_MODELS::LINEAR_DISTANCE, 1.0f);
     this->emitterAllocator.Get<EmitterSlot::CLIPID>(aeid.id) = clip;
     this->emitterAllocator.Get<EmitterSlot::VOLUME>(aeid.id) = 1.0f;
     this->emitterAllocator.Get<EmitterSlot::MINDISTANCE>(aeid.id) = 1.0f;
@@ -180,6 +202,7 @@ AudioDevice::CreateAudioEmitter(Resources::ResourceName const& name)
     this->emitterAllocator.Get<EmitterSlot::PAN>(aeid.id) = 0.0f;
     this->emitterAllocator.Get<EmitterSlot::SPATIALIZE>(aeid.id) = true;
     this->emitterAllocator.Get<EmitterSlot::CLOCK>(aeid.id) = 0.0f;
+    this->emitterAllocator.Get<EmitterSlot::PRIORITY>(aeid.id) = 1.0f;
 
     return aeid;
 }
@@ -190,14 +213,7 @@ AudioDevice::CreateAudioEmitter(Resources::ResourceName const& name)
 void
 AudioDevice::DestroyAudioEmitter(AudioEmitterId const id)
 {
-    ClipId clip = this->emitterAllocator.Get<EmitterSlot::CLIPID>(id.id);
-    uint& refCount = this->wavs.Get<WavAllocator::REFCOUNT>(clip.id);
-    refCount--;
-    if (refCount == 0)
-    {
-        this->wavs.Dealloc(clip.id);
-    }
-
+    this->UnloadClip(this->emitterAllocator.Get<EmitterSlot::CLIPID>(id.id));
     this->emitterAllocator.Dealloc(id.id);
 }
 
@@ -205,22 +221,19 @@ AudioDevice::DestroyAudioEmitter(AudioEmitterId const id)
 /**
 */
 ClipInstanceId
-AudioDevice::Play(ClipId clip, float volume, float pan, bool loop, float clock)
+AudioDevice::Play(ClipId clip, float volume, float pan, bool loop, float clock, float priority)
 {
-    ClipInstanceId instance;
-    auto& wav = this->wavs.Get<WavAllocator::WAV>(clip.id);
-
-    if (clock == 0.0f)
-    {
-        instance.id = soloud->play(wav, volume, pan);
-    }
-    else
-    {
-        instance.id = soloud->playClocked(clock, wav, volume, pan);
-    }
-
-    soloud->setLooping(instance.id, loop);
-    return instance;
+    SoLoud::AudioSource* source = this->clips.Get<ClipSlot::SOURCE>(clip.id);
+    if (source == nullptr)
+        return ClipInstanceId::Invalid();
+
+    VoiceManager::VoiceParams params;
+    params.volume = volume;
+    params.pan = pan;
+    params.priority = priority;
+    params.loop = loop;
+    params.clock = clock;
+    return this->voices.Play(clip, source, this->clips.Get<ClipSlot::LENGTH>(clip.id), params);
 }
 
 //------------------------------------------------------------------------------
@@ -235,24 +248,26 @@ AudioDevice::PlaySpatial(
     float minDistance,
     float maxDistance,
     bool loop,
-    float clock
+    float clock,
+    float priority
 )
 {
-    ClipInstanceId instance;
-    auto& wav = this->wavs.Get<WavAllocator::WAV>(clip.id);
-
-    if (clock > 0)
-    {
-        instance.id = soloud->play3dClocked(clock, wav, pos.x, pos.y, pos.z, vel.x, vel.y, vel.z, volume);
-    }
-    else
-    {
-        instance.id = soloud->play3d(wav, pos.x, pos.y, pos.z, vel.x, vel.y, vel.z, volume);
-    }
-    soloud->set3dSourceMinMaxDistance(instance.id, minDistance, maxDistance);
-    soloud->setLooping(instance.id, loop);
+    SoLoud::AudioSource* source = this->clips.Get<ClipSlot::SOURCE>(clip.id);
+    if (source == nullptr)
+        return ClipInstanceId::Invalid();
+
+    VoiceManager::VoiceParams params;
+    params.volume = volume;
+    params.priority = priority;
+    params.spatial = true;
+    params.position = pos;
+    params.velocity = vel;
+    params.minDistance = minDistance;
+    params.maxDistance = maxDistance;
+    params.loop = loop;
+    params.clock = clock;
     // TODO: Attenuation model!
-    return instance;
+    return this->voices.Play(clip, source, this->clips.Get<ClipSlot::LENGTH>(clip.id), params);
 }
 
 //------------------------------------------------------------------------------
@@ -261,45 +276,25 @@ AudioDevice::PlaySpatial(
 ClipInstanceId
 AudioDevice::Play(AudioEmitterId id, bool loop)
 {
-    auto& clip = this->emitterAllocator.Get<EmitterSlot::CLIPID>(id.id);
-    auto& vol = this->emitterAllocator.Get<EmitterSlot::VOLUME>(id.id);
-    auto& spatialize = this->emitterAllocator.Get<EmitterSlot::SPATIALIZE>(id.id);
-    auto& clock = this->emitterAllocator.Get<EmitterSlot::CLOCK>(id.id);
-    auto& wav = this->wavs.Get<WavAllocator::WAV>(clip.id);
-
-    ClipInstanceId instance;
-    if (spatialize)
-    {
-        auto& pos = this->emitterAllocator.Get<EmitterSlot::POSITION>(id.id);
-        auto& vel = this->emitterAllocator.Get<EmitterSlot::VELOCITY>(id.id);
-        auto& min = this->emitterAllocator.Get<EmitterSlot::MINDISTANCE>(id.id);
-        auto& max = this->emitterAllocator.Get<EmitterSlot::MAXDISTANCE>(id.id);
-
-        if (clock > 0)
-        {
-            instance.id = soloud->play3dClocked(clock, wav, pos.x, pos.y, pos.z, vel.x, vel.y, vel.z, vol);
-        }
-        else
-        {
-            instance.id = soloud->play3d(wav, pos.x, pos.y, pos.z, vel.x, vel.y, vel.z, vol);
-        }
-        soloud->set3dSourceMinMaxDistance(instance.id, min, max);
-    }
-    else
-    {
-        auto& pan = this->emitterAllocator.Get<EmitterSlot::PAN>(id.id);
-        if (clock == 0.0f)
-        {
-            instance.id = soloud->play(wav, vol, pan);
-        }
-        else
-        {
-            instance.id = soloud->playClocked(clock, wav, vol, pan);
-        }
-    }
-
-    soloud->setLooping(instance.id, loop);
-    return instance;
+    ClipId const clip = this->emitterAllocator.Get<EmitterSlot::CLIPID>(id.id);
+    SoLoud::AudioSource* source = this->clips.Get<ClipSlot::SOURCE>(clip.id);
+    if (source == nullptr)
+        return ClipInstanceId::Invalid();
+
+    VoiceManager::VoiceParams params;
+    params.volume = this->emitterAllocator.Get<EmitterSlot::VOLUME>(id.id);
+    params.pan = this->emitterAllocator.Get<EmitterSlot::PAN>(id.id);
+    params.priority = this->emitterAllocator.Get<EmitterSlot::PRIORITY>(id.id);
+    params.spatial = this->emitterAllocator.Get<EmitterSlot::SPATIALIZE>(id.id);
+    Math::point const& pos = this->emitterAllocator.Get<EmitterSlot::POSITION>(id.id);
+    Math::vector const& vel = this->emitterAllocator.Get<EmitterSlot::VELOCITY>(id.id);
+    params.position = Math::vec3(pos.x, pos.y, pos.z);
+    params.velocity = Math::vec3(vel.x, vel.y, vel.z);
+    params.minDistance = this->emitterAllocator.Get<EmitterSlot::MINDISTANCE>(id.id);
+    params.maxDistance = this->emitterAllocator.Get<EmitterSlot::MAXDISTANCE>(id.id);
+    params.loop = loop;
+    params.clock = this->emitterAllocator.Get<EmitterSlot::CLOCK>(id.id);
+    return this->voices.Play(clip, source, this->clips.Get<ClipSlot::LENGTH>(clip.id), params);
 }
 
 //------------------------------------------------------------------------------
@@ -308,7 +303,7 @@ AudioDevice::Play(AudioEmitterId id, bool loop)
 void
 AudioDevice::StopInstance(ClipInstanceId id)
 {
-    soloud->stop(id.id);
+    this->voices.Stop(id);
 }
 
 //------------------------------------------------------------------------------
@@ -317,7 +312,35 @@ AudioDevice::StopInstance(ClipInstanceId id)
 void
 AudioDevice::Stop(ClipId id)
 {
-    soloud->stopAudioSource(this->wavs.Get<WavAllocator::WAV>(id.id));
+    this->voices.StopClip(id);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AudioDevice::SetMaxRealVoices(SizeT num)
+{
+    n_assert(num <= MaxRealVoices);
+    this->voices.SetMaxRealVoices(num);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+AudioDevice::GetNumVoices() const
+{
+    return this->voices.GetNumVoices();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+AudioDevice::GetNumRealVoices() const
+{
+    return this->voices.GetNumRealVoices();
 }
 
 //------------------------------------------------------------------------------
@@ -383,13 +406,22 @@ AudioDevice::SetPan(AudioEmitterId id, float value)
     this->emitterAllocator.Get<EmitterSlot::PAN>(id.id) = value;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AudioDevice::SetPriority(AudioEmitterId id, float value)
+{
+    this->emitterAllocator.Get<EmitterSlot::PRIORITY>(id.id) = value;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
 void
 AudioDevice::UpdatePosition(ClipInstanceId id, Math::point const& pos)
 {
-    soloud->set3dSourcePosition(id.id, pos.x, pos.y, pos.z);
+    this->voices.SetPosition(id, Math::vec3(pos.x, pos.y, pos.z));
 }
 
 //------------------------------------------------------------------------------
@@ -398,7 +430,7 @@ AudioDevice::UpdatePosition(ClipInstanceId id, Math::point const& pos)
 void
 AudioDevice::UpdateVelocity(ClipInstanceId id, Math::vector const& vel)
 {
-    soloud->set3dSourceVelocity(id.id, vel.x, vel.y, vel.z);
+    this->voices.SetVelocity(id, Math::vec3(vel.x, vel.y, vel.z));
 }
 
 //------------------------------------------------------------------------------
@@ -472,7 +504,7 @@ AudioDevice::ResetListener()
 bool
 AudioDevice::IsValid(ClipInstanceId id)
 {
-    return soloud->isValidVoiceHandle(id.id);
+    return this->voices.IsValid(id);
 }
 
 } // namespace Audio
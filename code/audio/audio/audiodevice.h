@@ -9,8 +9,15 @@
     Uses which ever audio backend that it is compiled with
     and that initializes properly.
 
-    Audio clips/resources are loaded and shared between audio emitters until
-    their reference count is 0, upon which they are unloaded.
+    Audio clips are loaded asynchronously through the AudioClipLoader and
+    shared between audio emitters until their reference count is 0, upon
+    which they are discarded. Playing a clip which is still loading does
+    nothing, use GetClipState() to find out when it can be played.
+
+    Clip instances are voices of the VoiceManager, which only mixes the most
+    audible ones and keeps the rest virtual. A ClipInstanceId stays valid
+    until the instance has finished or is stopped, whether it is audible or
+    not.
 
     @copyright
     (C) 2019-2020 Individual contributors, see AUTHORS file
@@ -19,8 +26,10 @@
 #include "core/refcounted.h"
 #include "core/singleton.h"
 #include "resources/resourceid.h"
+#include "resources/resource.h"
 #include "ids/idallocator.h"
 #include "audioclip.h"
+#include "voicemanager.h"
 #include "debug/debugtimer.h"
 #include "debug/debugcounter.h"
 #include "math/point.h"
@@ -29,7 +38,7 @@
 
 namespace SoLoud
 {
-class Wav;
+class AudioSource;
 }
 
 namespace Audio
@@ -54,13 +63,15 @@ public:
     /// Called per frame to update spatial positions
     void OnFrame();
 
-    /// Load a soundfile into memory
-    ClipId LoadClip(Resources::ResourceName const& name);
+    /// Start loading a soundfile, or block until it is loaded if immediate is set
+    ClipId LoadClip(Resources::ResourceName const& name, bool immediate = false);
     /// Unload a soundfile
     void UnloadClip(ClipId const id);
+    /// Get the load state of a clip, it can only be played once it's loaded
+    Resources::Resource::State GetClipState(ClipId const id) const;
 
     /// Play non-spatial audio clip. Returns the playing clip instance.
-    ClipInstanceId Play(ClipId clip, float volume, float pan, bool loop = false, float clock = 0.0f);
+    ClipInstanceId Play(ClipId clip, float volume, float pan, bool loop = false, float clock = 0.0f, float priority = 1.0f);
 
     /// Play spatial audio clip that accounts for spatial position when playing. Returns the playing clip instance.
     ClipInstanceId PlaySpatial(
@@ -71,16 +82,27 @@ public:
         float minDistance,
         float maxDistance,
         bool loop = false,
-        float clock = 0.0f
+        float clock = 0.0f,
+        float priority = 1.0f
     );
 
     /// Stop an instance of a clip
     void StopInstance(ClipInstanceId id);
     /// Stop all instances of a clip
     void Stop(ClipId id);
-    /// Check if an instance is valid
+    /// Check if an instance is still playing, audible or not
     bool IsValid(ClipInstanceId id);
 
+    /// Set how many voices are mixed at most, the least audible voices are virtualized
+    void SetMaxRealVoices(SizeT num);
+    /// Get number of playing clip instances
+    SizeT GetNumVoices() const;
+    /// Get number of clip instances which are mixed
+    SizeT GetNumRealVoices() const;
+
+    /// upper limit for SetMaxRealVoices()
+    static const SizeT MaxRealVoices = 32;
+
     /// Update the spatial position of a sound instance in world space.
     void UpdatePosition(ClipInstanceId id, Math::point const& pos);
     /// Update the spatial velocity of a sound instance
@@ -117,6 +139,8 @@ public:
     void SetClock(AudioEmitterId id, float value);
     /// Set 2D pan for non spatialized sounds. (L = -1.0, R = 1.0)
     void SetPan(AudioEmitterId id, float value);
+    /// Set priority, which scales audibility when voices compete for being mixed
+    void SetPriority(AudioEmitterId id, float value);
 
 private:
     enum EmitterSlot
@@ -130,20 +154,24 @@ private:
         PAN,         // 2D pan for non spatialized sounds. (L = -1.0, R = 1.0)
         SPATIALIZE,  // Set true if spatial position and velocity should be taken into account when playing sound
         CLOCK, // Set this to > 0 if you need to delay the start of sounds so that rapidly launched sounds don't all get clumped to the start of the next outgoing sound buffer.
+        PRIORITY, // Scales audibility when competing for real voices
     };
-    Ids::IdAllocator<ClipId, Math::point, Math::vector, float, float, float, float, bool, float> emitterAllocator;
+    Ids::IdAllocator<ClipId, Math::point, Math::vector, float, float, float, float, bool, float, float> emitterAllocator;
 
-    enum WavAllocator
+    enum ClipSlot
     {
-        WAV,
+        NAME,       // resource name the clip is shared by
+        RESOURCE,   // resource in the AudioClipLoader
+        SOURCE,     // playable source, null until the resource is loaded
+        LENGTH,     // length in seconds
         REFCOUNT
     };
     /**
-        Contains all wavs that are currently loaded.
-        refcount will automatically unload wav if it
-        is no longer in use by any emitters
+        Contains all clips that are currently in use.
+        refcount will automatically discard the clip resource
+        if it is no longer in use by any emitters
     */
-    Ids::IdAllocator<SoLoud::Wav, uint> wavs;
+    Ids::IdAllocator<Resources::ResourceName, Resources::ResourceId, SoLoud::AudioSource*, float, uint> clips;
 
     /// resource -> clipid table
     Util::Dictionary<Resources::ResourceName, ClipId> clipMap;
@@ -156,7 +184,9 @@ private:
         float velocity[3] = {0, 0, 0};
     } listener;
 
-    _declare_timer(AudioOnFrameTime) _declare_counter(AudioNumberOfSoundsPlaying)
+    VoiceManager voices;
+
+    _declare_timer(AudioOnFrameTime) _declare_counter(AudioNumberOfSoundsPlaying) _declare_counter(AudioNumberOfVirtualVoices)
 };
 
 } // namespace Audio
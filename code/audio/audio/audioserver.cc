@@ -5,6 +5,8 @@
 #include "foundation/stdneb.h"
 #include "audioserver.h"
 #include "audiodevice.h"
+#include "audiocliploader.h"
+#include "resources/resourceserver.h"
 
 namespace Audio
 {
@@ -36,6 +38,17 @@ bool
 AudioServer::Open()
 {
     n_assert(!this->IsOpen());
+
+    // the loader outlives the server, so only register it the first time we open
+    Resources::ResourceServer* resourceServer = Resources::ResourceServer::Instance();
+    if (!resourceServer->HasStreamLoader("wav"))
+    {
+        resourceServer->RegisterStreamLoader("wav", AudioClipLoader::RTTI);
+        resourceServer->AddStreamLoaderExtension("ogg", AudioClipLoader::RTTI);
+        resourceServer->AddStreamLoaderExtension("mp3", AudioClipLoader::RTTI);
+        resourceServer->AddStreamLoaderExtension("flac", AudioClipLoader::RTTI);
+    }
+
     this->device = AudioDevice::Create();
     this->device->Open();
     this->isOpen = true;
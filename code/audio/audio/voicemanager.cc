@@ -0,0 +1,467 @@
+//------------------------------------------------------------------------------
+//  voicemanager.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "voicemanager.h"
+#include "math/vec4.h"
+#include "math/scalar.h"
+#include "profiling/profiling.h"
+#include "soloud.h"
+#include <algorithm>
+
+namespace Audio
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+VoiceManager::VoiceManager() :
+    soloud(nullptr),
+    maxRealVoices(0),
+    numRealVoices(0),
+    cutoff(0.0f),
+    listenerPosition(0),
+    lastTime(0.0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+VoiceManager::~VoiceManager()
+{
+    n_assert(this->soloud == nullptr);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VoiceManager::Setup(SoLoud::Soloud* soloud, SizeT maxRealVoices)
+{
+    n_assert(this->soloud == nullptr);
+    n_assert(maxRealVoices > 0);
+    this->soloud = soloud;
+    this->maxRealVoices = maxRealVoices;
+    this->timer.Start();
+    this->lastTime = this->timer.GetTime();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VoiceManager::Discard()
+{
+    for (IndexT i = this->voices.Size() - 1; i >= 0; i--)
+    {
+        if (this->voices[i].real)
+            this->soloud->stop(this->voices[i].handle);
+        this->idPool.Deallocate(this->voices[i].id);
+    }
+    this->voices.Clear();
+    this->posX.Clear();
+    this->posY.Clear();
+    this->posZ.Clear();
+    this->minDistance.Clear();
+    this->invDistanceRange.Clear();
+    this->spatial.Clear();
+    this->gain.Clear();
+    this->audibility.Clear();
+    this->numRealVoices = 0;
+    this->timer.Stop();
+    this->soloud = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Lowering the budget demotes the surplus voices on the next Update().
+*/
+void
+VoiceManager::SetMaxRealVoices(SizeT num)
+{
+    n_assert(num > 0);
+    this->maxRealVoices = num;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The voice starts out real if there is room in the budget, or if it is
+    louder than the quietest real voice, which will then be demoted on the
+    next Update().
+*/
+ClipInstanceId
+VoiceManager::Play(ClipId clip, SoLoud::AudioSource* source, float length, VoiceParams const& params)
+{
+    n_assert(source != nullptr);
+    Ids::Id32 id;
+    this->idPool.Allocate(id);
+    if (Ids::Index(id) >= (uint)this->voiceIndices.Size())
+        this->voiceIndices.Resize(Ids::Index(id) + 1);
+
+    IndexT const i = this->voices.Size();
+    this->voiceIndices[Ids::Index(id)] = i;
+
+    Voice voice;
+    voice.id = id;
+    voice.clip = clip;
+    voice.source = source;
+    voice.handle = 0;
+    voice.velocity = params.velocity;
+    voice.volume = params.volume;
+    voice.pan = params.pan;
+    voice.minDistance = params.minDistance;
+    voice.maxDistance = params.maxDistance;
+    voice.length = length;
+    voice.playTime = 0.0;
+    voice.loop = params.loop;
+    voice.real = false;
+    this->voices.Append(voice);
+
+    this->posX.Append(params.position.x);
+    this->posY.Append(params.position.y);
+    this->posZ.Append(params.position.z);
+    this->minDistance.Append(params.minDistance);
+    this->invDistanceRange.Append(1.0f / Math::max(params.maxDistance - params.minDistance, 0.0001f));
+    this->spatial.Append(params.spatial ? 1.0f : 0.0f);
+    this->gain.Append(params.volume * params.priority);
+    this->audibility.Append(this->ComputeAudibility(i));
+
+    if (this->audibility[i] > 0.0f && (this->numRealVoices < this->maxRealVoices || this->audibility[i] > this->cutoff))
+    {
+        this->Promote(i, false, params.clock);
+    }
+    return id;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VoiceManager::Stop(ClipInstanceId id)
+{
+    if (this->IsValid(id))
+        this->Remove(this->voiceIndices[Ids::Index(id.id)]);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VoiceManager::StopClip(ClipId clip)
+{
+    for (IndexT i = this->voices.Size() - 1; i >= 0; i--)
+    {
+        if (this->voices[i].clip == clip)
+            this->Remove(i);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+VoiceManager::IsValid(ClipInstanceId id) const
+{
+    return id != InvalidClipInstanceId && this->idPool.IsValid(id.id);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+VoiceManager::IsReal(ClipInstanceId id) const
+{
+    return this->IsValid(id) && this->voices[this->voiceIndices[Ids::Index(id.id)]].real;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VoiceManager::SetPosition(ClipInstanceId id, Math::vec3 const& pos)
+{
+    if (!this->IsValid(id))
+        return;
+    IndexT const i = this->voiceIndices[Ids::Index(id.id)];
+    this->posX[i] = pos.x;
+    this->posY[i] = pos.y;
+    this->posZ[i] = pos.z;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VoiceManager::SetVelocity(ClipInstanceId id, Math::vec3 const& vel)
+{
+    if (!this->IsValid(id))
+        return;
+    this->voices[this->voiceIndices[Ids::Index(id.id)]].velocity = vel;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VoiceManager::Update(Math::vec3 const& listenerPosition)
+{
+    N_SCOPE(UpdateVoices, Audio);
+    Timing::Time const now = this->timer.GetTime();
+    double const timeDiff = now - this->lastTime;
+    this->lastTime = now;
+    this->listenerPosition = listenerPosition;
+
+    // advance play positions and retire voices which are done
+    for (IndexT i = this->voices.Size() - 1; i >= 0; i--)
+    {
+        Voice& voice = this->voices[i];
+        voice.playTime += timeDiff;
+        if (voice.real && !this->soloud->isValidVoiceHandle(voice.handle))
+        {
+            // reached the end, or was cut off by the engine
+            voice.real = false;
+            voice.handle = 0;
+            this->numRealVoices--;
+            if (!voice.loop)
+            {
+                this->Remove(i);
+                continue;
+            }
+        }
+        if (voice.playTime >= voice.length)
+        {
+            if (voice.loop && voice.length > 0.0f)
+            {
+                voice.playTime = Math::fmod((float)voice.playTime, voice.length);
+            }
+            else if (!voice.real)
+            {
+                this->Remove(i);
+                continue;
+            }
+        }
+    }
+
+    this->ComputeAudibilities();
+
+    // real voices get a bonus, so voices of about the same audibility don't keep swapping
+    SizeT const numVoices = this->voices.Size();
+    this->scores.Reset();
+    SizeT numAudible = 0;
+    for (IndexT i = 0; i < numVoices; i++)
+    {
+        float const score = this->voices[i].real ? this->audibility[i] * Hysteresis : this->audibility[i];
+        this->scores.Append(score);
+        numAudible += score > 0.0f ? 1 : 0;
+    }
+
+    // find the score of the quietest voice which still makes the budget
+    float threshold = 0.0f;
+    if (numAudible > this->maxRealVoices)
+    {
+        this->ranked = this->scores;
+        IndexT const last = this->maxRealVoices - 1;
+        std::nth_element(this->ranked.Begin(), this->ranked.Begin() + last, this->ranked.End(), std::greater<float>());
+        threshold = this->ranked[last];
+    }
+    this->cutoff = threshold;
+
+    // demote first so promotions have room, ties are settled by order
+    SizeT budget = this->maxRealVoices;
+    for (IndexT i = 0; i < numVoices; i++)
+    {
+        if (!this->voices[i].real)
+            continue;
+        bool const keep = this->scores[i] > 0.0f && this->scores[i] >= threshold && budget > 0;
+        if (keep)
+            budget--;
+        else
+            this->Demote(i);
+    }
+    for (IndexT i = 0; i < numVoices && budget > 0; i++)
+    {
+        if (this->voices[i].real)
+            continue;
+        if (this->scores[i] > 0.0f && this->scores[i] >= threshold)
+        {
+            this->Promote(i, true, 0.0f);
+            budget--;
+        }
+    }
+
+    // send 3D parameters of the real voices in one go
+    for (IndexT i = 0; i < numVoices; i++)
+    {
+        Voice const& voice = this->voices[i];
+        if (voice.real && this->spatial[i] != 0.0f)
+        {
+            this->soloud->set3dSourceParameters(
+                voice.handle,
+                this->posX[i], this->posY[i], this->posZ[i],
+                voice.velocity.x, voice.velocity.y, voice.velocity.z
+            );
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Linear distance attenuation clamped to [0, 1] like the attenuation model
+    of the clips, times volume and priority.
+*/
+float
+VoiceManager::ComputeAudibility(IndexT i) const
+{
+    float const dx = this->posX[i] - this->listenerPosition.x;
+    float const dy = this->posY[i] - this->listenerPosition.y;
+    float const dz = this->posZ[i] - this->listenerPosition.z;
+    float const distance = Math::sqrt(dx * dx + dy * dy + dz * dz);
+    float attenuation = Math::clamp(1.0f - (distance - this->minDistance[i]) * this->invDistanceRange[i], 0.0f, 1.0f);
+    attenuation = 1.0f - this->spatial[i] * (1.0f - attenuation);
+    return attenuation * this->gain[i];
+}
+
+//------------------------------------------------------------------------------
+/**
+    Same as ComputeAudibility(), four voices at a time.
+*/
+void
+VoiceManager::ComputeAudibilities()
+{
+    N_SCOPE(ComputeAudibilities, Audio);
+    SizeT const numVoices = this->voices.Size();
+    SizeT const numBatched = numVoices & ~3;
+
+    Math::vec4 const listenerX(this->listenerPosition.x);
+    Math::vec4 const listenerY(this->listenerPosition.y);
+    Math::vec4 const listenerZ(this->listenerPosition.z);
+    Math::vec4 const zero(0.0f);
+    Math::vec4 const one(1.0f);
+    for (IndexT i = 0; i < numBatched; i += 4)
+    {
+        Math::vec4 dx, dy, dz, minDist, invRange, spatialMask, voiceGain;
+        dx.loadu(&this->posX[i]);
+        dy.loadu(&this->posY[i]);
+        dz.loadu(&this->posZ[i]);
+        minDist.loadu(&this->minDistance[i]);
+        invRange.loadu(&this->invDistanceRange[i]);
+        spatialMask.loadu(&this->spatial[i]);
+        voiceGain.loadu(&this->gain[i]);
+
+        dx = dx - listenerX;
+        dy = dy - listenerY;
+        dz = dz - listenerZ;
+        Math::vec4 const distanceSq = Math::multiplyadd(dz, dz, Math::multiplyadd(dy, dy, dx * dx));
+        Math::vec4 const distance = _mm_sqrt_ps(distanceSq.vec);
+
+        Math::vec4 attenuation = Math::clamp(one - (distance - minDist) * invRange, zero, one);
+        attenuation = one - spatialMask * (one - attenuation);
+        (attenuation * voiceGain).storeu(&this->audibility[i]);
+    }
+    for (IndexT i = numBatched; i < numVoices; i++)
+    {
+        this->audibility[i] = this->ComputeAudibility(i);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Voices which have been playing virtually start paused and silent at
+    their play position, and fade in from there.
+*/
+void
+VoiceManager::Promote(IndexT i, bool fadeIn, float clock)
+{
+    Voice& voice = this->voices[i];
+    n_assert(!voice.real);
+    float const startVolume = fadeIn ? 0.0f : voice.volume;
+    unsigned int handle;
+    if (this->spatial[i] != 0.0f)
+    {
+        if (clock > 0.0f && !fadeIn)
+        {
+            handle = this->soloud->play3dClocked(clock, *voice.source, this->posX[i], this->posY[i], this->posZ[i], voice.velocity.x, voice.velocity.y, voice.velocity.z, startVolume);
+        }
+        else
+        {
+            handle = this->soloud->play3d(*voice.source, this->posX[i], this->posY[i], this->posZ[i], voice.velocity.x, voice.velocity.y, voice.velocity.z, startVolume, fadeIn);
+        }
+        this->soloud->set3dSourceMinMaxDistance(handle, voice.minDistance, voice.maxDistance);
+    }
+    else
+    {
+        if (clock > 0.0f && !fadeIn)
+        {
+            handle = this->soloud->playClocked(clock, *voice.source, startVolume, voice.pan);
+        }
+        else
+        {
+            handle = this->soloud->play(*voice.source, startVolume, voice.pan, fadeIn);
+        }
+    }
+    this->soloud->setLooping(handle, voice.loop);
+
+    if (fadeIn)
+    {
+        this->soloud->seek(handle, voice.playTime);
+        this->soloud->fadeVolume(handle, voice.volume, FadeTime);
+        this->soloud->setPause(handle, false);
+    }
+
+    voice.handle = handle;
+    voice.real = true;
+    this->numRealVoices++;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VoiceManager::Demote(IndexT i)
+{
+    Voice& voice = this->voices[i];
+    n_assert(voice.real);
+    if (this->soloud->isValidVoiceHandle(voice.handle))
+    {
+        // continue virtually from where the mixer is, our own estimate drifts
+        voice.playTime = this->soloud->getStreamPosition(voice.handle);
+        this->soloud->fadeVolume(voice.handle, 0.0f, FadeTime);
+        this->soloud->scheduleStop(voice.handle, FadeTime);
+    }
+    voice.handle = 0;
+    voice.real = false;
+    this->numRealVoices--;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VoiceManager::Remove(IndexT i)
+{
+    Voice const& voice = this->voices[i];
+    if (voice.real)
+    {
+        this->soloud->fadeVolume(voice.handle, 0.0f, FadeTime);
+        this->soloud->scheduleStop(voice.handle, FadeTime);
+        this->numRealVoices--;
+    }
+    this->idPool.Deallocate(voice.id);
+
+    this->voices.EraseIndexSwap(i);
+    this->posX.EraseIndexSwap(i);
+    this->posY.EraseIndexSwap(i);
+    this->posZ.EraseIndexSwap(i);
+    this->minDistance.EraseIndexSwap(i);
+    this->invDistanceRange.EraseIndexSwap(i);
+    this->spatial.EraseIndexSwap(i);
+    this->gain.EraseIndexSwap(i);
+    this->audibility.EraseIndexSwap(i);
+    if (i < this->voices.Size())
+        this->voiceIndices[Ids::Index(this->voices[i].id)] = i;
+}
+
+} // namespace Audio
@@ -0,0 +1,187 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Audio::VoiceManager
+
+    Keeps every playing clip instance as a voice, but only lets the most
+    audible ones play as real SoLoud voices. The others are virtual, they
+    only advance their play position until they either finish or become
+    audible enough to be promoted again.
+
+    Once per frame the audibility of all voices (distance attenuation x
+    volume x priority) is computed in one SIMD pass over tightly packed
+    arrays, and the voices are redistributed so that at most the budget of
+    real voices is playing. Voices fade in and out over a few milliseconds
+    when they change state, and are seeked to their virtual play position
+    when promoted, so nothing pops or starts over.
+
+    Positions and velocities are only written to the arrays when set, the
+    real voices get their 3D parameters in one batch during Update().
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "audioclip.h"
+#include "ids/idgenerationpool.h"
+#include "util/array.h"
+#include "math/vec3.h"
+#include "timing/timer.h"
+
+namespace SoLoud
+{
+class Soloud;
+class AudioSource;
+}
+
+namespace Audio
+{
+
+class VoiceManager
+{
+public:
+    /// playback parameters of a voice
+    struct VoiceParams
+    {
+        float volume = 1.0f;
+        float pan = 0.0f;
+        /// scales the audibility of the voice when competing for the budget
+        float priority = 1.0f;
+        bool spatial = false;
+        Math::vec3 position = Math::vec3(0);
+        Math::vec3 velocity = Math::vec3(0);
+        float minDistance = 1.0f;
+        float maxDistance = 1000000.0f;
+        bool loop = false;
+        /// delay start to the next mixer buffer tick, only applies if the voice starts out real
+        float clock = 0.0f;
+    };
+
+    /// constructor
+    VoiceManager();
+    /// destructor
+    ~VoiceManager();
+
+    /// setup with the engine and the maximum number of real voices
+    void Setup(SoLoud::Soloud* soloud, SizeT maxRealVoices);
+    /// stop all voices
+    void Discard();
+
+    /// set the maximum number of real voices
+    void SetMaxRealVoices(SizeT num);
+    /// get the maximum number of real voices
+    SizeT GetMaxRealVoices() const;
+    /// get the number of voices, real and virtual
+    SizeT GetNumVoices() const;
+    /// get the number of real voices
+    SizeT GetNumRealVoices() const;
+
+    /// start a voice, length is the length of the clip in seconds
+    ClipInstanceId Play(ClipId clip, SoLoud::AudioSource* source, float length, VoiceParams const& params);
+    /// stop a voice
+    void Stop(ClipInstanceId id);
+    /// stop all voices of a clip
+    void StopClip(ClipId clip);
+    /// returns true if the voice is still playing, real or virtual
+    bool IsValid(ClipInstanceId id) const;
+    /// returns true if the voice is currently mixed
+    bool IsReal(ClipInstanceId id) const;
+
+    /// set the world space position of a voice
+    void SetPosition(ClipInstanceId id, Math::vec3 const& pos);
+    /// set the velocity of a voice
+    void SetVelocity(ClipInstanceId id, Math::vec3 const& vel);
+
+    /// advance virtual voices, update audibility and promote/demote voices, call once per frame
+    void Update(Math::vec3 const& listenerPosition);
+
+    /// fade time when a voice is promoted, demoted or stopped
+    static constexpr float FadeTime = 0.05f;
+    /// real voices need to lose this much audibility against a virtual voice before they are swapped
+    static constexpr float Hysteresis = 1.25f;
+
+private:
+    /// everything about a voice which isn't needed for the audibility pass
+    struct Voice
+    {
+        Ids::Id32 id;
+        ClipId clip;
+        SoLoud::AudioSource* source;
+        unsigned int handle;
+        Math::vec3 velocity;
+        float volume;
+        float pan;
+        float minDistance;
+        float maxDistance;
+        float length;
+        double playTime;
+        bool loop;
+        bool real;
+    };
+
+    /// compute audibility of a single voice
+    float ComputeAudibility(IndexT i) const;
+    /// compute audibility of all voices
+    void ComputeAudibilities();
+    /// start the real voice, fading in if the voice has been playing virtually
+    void Promote(IndexT i, bool fadeIn, float clock);
+    /// fade out and stop the real voice, the voice keeps playing virtually
+    void Demote(IndexT i);
+    /// fade out the real voice if any and remove the voice
+    void Remove(IndexT i);
+
+    SoLoud::Soloud* soloud;
+    SizeT maxRealVoices;
+    SizeT numRealVoices;
+    /// score a voice needed to be real in the last update, 0 if everything audible fit into the budget
+    float cutoff;
+    Math::vec3 listenerPosition;
+
+    Ids::IdGenerationPool idPool;
+    Util::Array<IndexT> voiceIndices;
+
+    Util::Array<Voice> voices;
+    // audibility pass inputs and output, one entry per voice
+    Util::Array<float> posX;
+    Util::Array<float> posY;
+    Util::Array<float> posZ;
+    Util::Array<float> minDistance;
+    Util::Array<float> invDistanceRange;
+    Util::Array<float> spatial;
+    Util::Array<float> gain;
+    Util::Array<float> audibility;
+    Util::Array<float> scores;
+    Util::Array<float> ranked;
+
+    Timing::Timer timer;
+    Timing::Time lastTime;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+VoiceManager::GetMaxRealVoices() const
+{
+    return this->maxRealVoices;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+VoiceManager::GetNumVoices() const
+{
+    return this->voices.Size();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+VoiceManager::GetNumRealVoices() const
+{
+    return this->numRealVoices;
+}
+
+} // namespace Audio
@@ -60,13 +60,6 @@ static const int JobMaxSliceSize = 0xFFFF;
 #define NEBULA_MEMORY_ADVANCED_DEBUGGING (0)
 #endif
 
-// enable/disable thread-local StringAtom tables
-#if (__LINUX__)
-#define NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES (0)
-#else
-#define NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES (1)
-#endif
-
 // enable/disable growth of StringAtom buffer
 #define NEBULA_ENABLE_GLOBAL_STRINGBUFFER_GROWTH (1)
 
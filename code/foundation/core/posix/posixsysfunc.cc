@@ -13,7 +13,6 @@
 #include "debug/minidump.h"
 #include "threading/thread.h"
 #include "util/globalstringatomtable.h"
-#include "util/localstringatomtable.h"  
 #include "system/systeminfo.h"
 #include <errno.h>
 
@@ -26,9 +25,6 @@ const Core::ExitHandler* SysFunc::ExitHandlers = 0;
 System::SystemInfo SysFunc::systemInfo;
 
 Util::GlobalStringAtomTable* globalStringAtomTable = 0;
-#if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-    Util::LocalStringAtomTable* localStringAtomTable = 0;
-#endif
     
 //------------------------------------------------------------------------------
 /**
@@ -54,9 +50,6 @@ SysFunc::Setup()
         #endif   
 
         globalStringAtomTable = new Util::GlobalStringAtomTable;
-        #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-            localStringAtomTable = new Util::LocalStringAtomTable;
-        #endif    
 
     }
 }
@@ -72,11 +65,8 @@ SysFunc::Setup()
 void
 SysFunc::Exit(int exitCode)
 {
-    // delete string atom tables
+    // delete string atom table
     delete globalStringAtomTable;
-    #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-        delete localStringAtomTable;
-    #endif
     // first produce a RefCount leak report
     #if NEBULA_DEBUG
     Core::RefCounted::DumpRefCountingLeaks();
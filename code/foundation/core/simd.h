@@ -16,6 +16,7 @@
 typedef __m128 f32x4;
 typedef __m128i i32x4;
 typedef __m128i u32x4;
+typedef __m128i u8x16;
 
 f32x4 cast_i32x4_to_f32x4(i32x4 x);
 i32x4 set_i32x4(int32_t x, int32_t y, int32_t z, int32_t w);
@@ -391,11 +392,49 @@ convert_u32x4_to_f32x4(u32x4 a)
     return _mm_castsi128_ps(a);
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+__forceinline u8x16
+load_u8x16(const uint8_t* ptr)
+{
+    return _mm_loadu_si128((const __m128i*)ptr);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+__forceinline u8x16
+splat_u8x16(uint8_t x)
+{
+    return _mm_set1_epi8((char)x);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+__forceinline u8x16
+compare_equal_u8x16(u8x16 a, u8x16 b)
+{
+    return _mm_cmpeq_epi8(a, b);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Gather the top bit of each byte into a 16 bit mask
+*/
+__forceinline uint32_t
+movemask_u8x16(u8x16 a)
+{
+    return (uint32_t)_mm_movemask_epi8(a);
+}
+
 #elif NEBULA_SIMD_AARCH64
 #include <arm_neon.h>
 typedef float32x4_t f32x4;
 typedef int32x4_t i32x4;
 typedef uint32x4_t u32x4;
+typedef uint8x16_t u8x16;
 
 //------------------------------------------------------------------------------
 /**
@@ -813,4 +852,44 @@ convert_u32x4_to_f32x4(u32x4 a)
     return vcvtq_f32_u32(a);
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+__forceinline u8x16
+load_u8x16(const uint8_t* ptr)
+{
+    return vld1q_u8(ptr);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+__forceinline u8x16
+splat_u8x16(uint8_t x)
+{
+    return vdupq_n_u8(x);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+__forceinline u8x16
+compare_equal_u8x16(u8x16 a, u8x16 b)
+{
+    return vceqq_u8(a, b);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Gather the top bit of each byte into a 16 bit mask
+*/
+__forceinline uint32_t
+movemask_u8x16(u8x16 a)
+{
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t bits = vandq_u8(vshrq_n_u8(a, 7), vdupq_n_u8(1));
+    bits = vmulq_u8(bits, vld1q_u8(weights));
+    return (uint32_t)vaddv_u8(vget_low_u8(bits)) | ((uint32_t)vaddv_u8(vget_high_u8(bits)) << 8);
+}
+
 #endif
@@ -12,7 +12,6 @@
 #include "debug/minidump.h"
 #include "threading/thread.h"
 #include "util/globalstringatomtable.h"
-#include "util/localstringatomtable.h"  
 #include "system/systeminfo.h"
 #include "debug/win32/win32stacktrace.h"
 #include <io.h>
@@ -26,9 +25,6 @@ const Core::ExitHandler* SysFunc::ExitHandlers = 0;
 System::SystemInfo SysFunc::systemInfo;
 
 Util::GlobalStringAtomTable* globalStringAtomTable = 0;
-#if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-    Util::LocalStringAtomTable* localStringAtomTable = 0;
-#endif
 
 //------------------------------------------------------------------------------
 /**
@@ -55,9 +51,6 @@ SysFunc::Setup()
         #endif   
 
         globalStringAtomTable = new Util::GlobalStringAtomTable;
-        #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-            localStringAtomTable = new Util::LocalStringAtomTable;
-        #endif    
 
         // query simd support
         int CPUInfo[4] = { -1 };
@@ -103,11 +96,8 @@ SysFunc::Exit(int exitCode)
         exitHandler = exitHandler->Next();
     }
 
-    // delete string atom tables
+    // delete string atom table
     delete globalStringAtomTable;
-#if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-    delete localStringAtomTable;
-#endif
 
     // shutdown the C runtime, this cleans up static objects but doesn't shut 
     // down the process
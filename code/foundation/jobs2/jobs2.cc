@@ -174,10 +174,12 @@ next:
             // If we have a job counter, only signal the event when the counter reaches 0
             if (job->doneCounter != nullptr)
             {
+                // The owner of the node may reuse it as soon as the counter reaches 0, so don't touch it after the decrement
+                Threading::Event* signalEvent = job->signalEvent;
                 long numDispatchesLeft = Threading::Interlocked::Decrement(job->doneCounter);
 
-                if (job->signalEvent != nullptr && numDispatchesLeft == 0)
-                    job->signalEvent->Signal();
+                if (signalEvent != nullptr && numDispatchesLeft == 0)
+                    signalEvent->Signal();
             }
             else
             {
@@ -206,6 +208,8 @@ N_DECLARE_COUNTER(N_JOBS2_MEMORY_COUNTER, Jobs2RingBufferMemory)
 void
 JobSystemInit(const JobSystemInitInfo& info)
 {
+    ctx.initInfo = info;
+
     // Setup job system threads
     ctx.threads.Resize(info.numThreads);
     for (IndexT i = 0; i < info.numThreads; i++)
@@ -231,6 +235,8 @@ JobSystemInit(const JobSystemInitInfo& info)
     N_BUDGET_COUNTER_SETUP(N_JOBS2_MEMORY_COUNTER, info.scratchMemorySize);
     ctx.tail = nullptr;
     ctx.head = nullptr;
+
+    Memory::FrameAllocatorInit(info.frameAllocator);
 }
 
 //------------------------------------------------------------------------------
@@ -244,6 +250,17 @@ JobSystemUninit()
         thread->Stop();
     }
     ctx.threads.Clear();
+
+    for (IndexT i = 0; i < ctx.scratchMemory.Size(); i++)
+    {
+        Memory::Free(Memory::ObjectHeap, ctx.scratchMemory[i]);
+    }
+    ctx.scratchMemory.Clear();
+    ctx.tail = nullptr;
+    ctx.head = nullptr;
+
+    // threads are stopped, nothing can allocate from the frame allocator anymore
+    Memory::FrameAllocatorUninit();
 }
 
 //------------------------------------------------------------------------------
@@ -255,6 +272,7 @@ JobNewFrame()
     ctx.iterator = 0;
     ctx.activeBuffer = (ctx.activeBuffer + 1) % ctx.numBuffers;
     N_BUDGET_COUNTER_RESET(N_JOBS2_MEMORY_COUNTER);
+    Memory::FrameAllocatorNewFrame();
 }
 
 //------------------------------------------------------------------------------
@@ -273,6 +291,73 @@ JobAlloc(SizeT bytes)
     return ret;
 }
 
+//------------------------------------------------------------------------------
+/**
+    Unlike JobDispatch, the node is not allocated from the per frame scratch
+    memory, which makes this safe to call from threads other than the main
+    thread and for work which lives across frames. High priority nodes are
+    put in front of the queue so they are picked up before anything queued
+    so far.
+*/
+void
+JobEnqueue(JobNode* node, JobPriority priority)
+{
+    n_assert(node->job.remainingGroups > 0);
+    n_assert(node->sequence == nullptr);
+
+    ctx.jobLock.Enter();
+    if (priority == JobPriority::High)
+    {
+        node->next = ctx.head;
+        ctx.head = node;
+        if (ctx.tail == nullptr)
+            ctx.tail = node;
+    }
+    else
+    {
+        if (ctx.head == nullptr)
+            ctx.head = node;
+        node->next = nullptr;
+        if (ctx.tail != nullptr)
+            ctx.tail->next = node;
+        ctx.tail = node;
+    }
+    ctx.jobLock.Leave();
+
+    // Trigger threads to wake up and compete for jobs
+    for (Ptr<JobThread>& thread : ctx.threads)
+    {
+        thread->SignalWorkAvailable();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Fills in all job fields of the node, so callers which keep their nodes
+    around don't have to replicate the bookkeeping of JobDispatch.
+*/
+void
+JobEnqueue(JobNode* node, JobFunc func, SizeT numInvocations, SizeT groupSize, void* data, Threading::AtomicCounter* doneCounter, JobPriority priority)
+{
+    n_assert(numInvocations > 0 && groupSize > 0);
+    n_assert(doneCounter != nullptr ? *doneCounter > 0 : true);
+
+    SizeT numJobs = (numInvocations + groupSize - 1) / groupSize;
+    node->job.func = func;
+    node->job.l.callable = nullptr;
+    node->job.remainingGroups = numJobs;
+    node->job.groupCompletionCounter = numJobs;
+    node->job.numInvocations = numInvocations;
+    node->job.groupSize = groupSize;
+    node->job.data = data;
+    node->job.waitCounters = nullptr;
+    node->job.numWaitCounters = 0;
+    node->job.doneCounter = doneCounter;
+    node->job.signalEvent = nullptr;
+    node->sequence = nullptr;
+    JobEnqueue(node, priority);
+}
+
 //------------------------------------------------------------------------------
 /**
 */
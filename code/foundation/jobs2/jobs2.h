@@ -3,6 +3,7 @@
 #include "threading/event.h"
 #include "util/stringatom.h"
 #include "threading/interlocked.h"
+#include "memory/frameallocator.h"
 
 //------------------------------------------------------------------------------
 /**
@@ -100,6 +101,39 @@ struct JobNode
     JobNode* sequence; // set to nullptr for ordinary nodes
 };
 
+enum class JobPriority
+{
+    Normal,     // appended to the end of the queue
+    High        // put in front of the queue, for work some thread is blocked on
+};
+
+struct JobSystemInitInfo
+{
+    Util::StringAtom name;
+    SizeT numThreads;
+    uint affinity;
+    uint priority;
+
+    SizeT scratchMemorySize;
+    SizeT numBuffers;
+
+    bool enableIo;
+    bool enableProfiling;
+
+    /// the frame allocator lives and advances together with the job system
+    Memory::FrameAllocatorInitInfo frameAllocator;
+
+    JobSystemInitInfo()
+        : numThreads(1)
+        , affinity(0xFFFFFFFF)
+        , priority(UINT_MAX)
+        , scratchMemorySize(1_MB)
+        , numBuffers(1)
+        , enableIo(false)
+        , enableProfiling(true)
+    {};
+};
+
 struct Jobs2Context
 {
     Threading::CriticalSection jobLock;
@@ -113,6 +147,9 @@ struct Jobs2Context
     IndexT activeBuffer;
     Util::FixedArray<byte*> scratchMemory;
     SizeT scratchMemorySize;
+
+    /// the info the job system was last initialized with
+    JobSystemInitInfo initInfo;
 };
 
 extern Jobs2Context ctx;
@@ -143,30 +180,6 @@ private:
     Threading::Event wakeupEvent;
 };
 
-struct JobSystemInitInfo
-{
-    Util::StringAtom name;
-    SizeT numThreads;
-    uint affinity;
-    uint priority;
-
-    SizeT scratchMemorySize;
-    SizeT numBuffers;
-
-    bool enableIo;
-    bool enableProfiling;
-
-    JobSystemInitInfo()
-        : numThreads(1)
-        , affinity(0xFFFFFFFF)
-        , priority(UINT_MAX)
-        , scratchMemorySize(1_MB)
-        , numBuffers(1)
-        , enableIo(false)
-        , enableProfiling(true)
-    {};
-};
-
 /// Create a new job port
 void JobSystemInit(const JobSystemInitInfo& info);
 /// Destroy job port
@@ -178,6 +191,10 @@ template <typename T> T* JobAlloc(SizeT count);
 void* JobAlloc(SizeT bytes);
 /// Progress to new buffer
 void JobNewFrame();
+/// Queue a node owned by the caller, the node must stay valid until its done counter reaches 0, can be called from any thread
+void JobEnqueue(JobNode* node, JobPriority priority = JobPriority::Normal);
+/// Setup a node owned by the caller to run func over numInvocations and queue it, the node must stay valid until doneCounter reaches 0
+void JobEnqueue(JobNode* node, JobFunc func, SizeT numInvocations, SizeT groupSize, void* data, Threading::AtomicCounter* doneCounter, JobPriority priority = JobPriority::Normal);
 
 extern JobNode* sequenceNode;
 extern JobNode* sequenceTail;
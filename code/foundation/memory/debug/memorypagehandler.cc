@@ -62,6 +62,7 @@ MemoryPageHandler::HandleRequest(const Ptr<HttpRequest>& request)
         htmlWriter->LineBreak();
 
         // display overall stats
+        Memory::HeapStats totalStats = Memory::GetTotalHeapStats();
         Array<Heap::Stats> heapStats = Heap::GetAllHeapStats();
         long heapAllocCount = 0;
         long heapAllocSize = 0;
@@ -75,11 +76,11 @@ MemoryPageHandler::HandleRequest(const Ptr<HttpRequest>& request)
         htmlWriter->Begin(HtmlElement::Table);
             htmlWriter->Begin(HtmlElement::TableRow);
                 htmlWriter->Element(HtmlElement::TableData, "Nebula Global Heaps Alloc Count: ");
-                htmlWriter->Element(HtmlElement::TableData, String::FromLong(Memory::TotalAllocCount));
+                htmlWriter->Element(HtmlElement::TableData, String::FromLong(long(totalStats.allocCount)));
             htmlWriter->End(HtmlElement::TableRow);
             htmlWriter->Begin(HtmlElement::TableRow);
                 htmlWriter->Element(HtmlElement::TableData, "Nebula Global Heaps Alloc Size: ");
-                htmlWriter->Element(HtmlElement::TableData, String::FromSize(Memory::TotalAllocSize) + " bytes");
+                htmlWriter->Element(HtmlElement::TableData, String::FromSize(size_t(totalStats.allocSize)) + " bytes");
             htmlWriter->End(HtmlElement::TableRow);
             htmlWriter->Begin(HtmlElement::TableRow);
                 htmlWriter->Element(HtmlElement::TableData, "Nebula Local Heaps Alloc Count: ");
@@ -91,11 +92,11 @@ MemoryPageHandler::HandleRequest(const Ptr<HttpRequest>& request)
             htmlWriter->End(HtmlElement::TableRow);
             htmlWriter->Begin(HtmlElement::TableRow);
                 htmlWriter->Element(HtmlElement::TableData, "Nebula Overall Alloc Count: ");
-                htmlWriter->Element(HtmlElement::TableData, String::FromLong(heapAllocCount + Memory::TotalAllocCount));
+                htmlWriter->Element(HtmlElement::TableData, String::FromLong(heapAllocCount + long(totalStats.allocCount)));
             htmlWriter->End(HtmlElement::TableRow);
             htmlWriter->Begin(HtmlElement::TableRow);
                 htmlWriter->Element(HtmlElement::TableData, "Nebula Overall Alloc Size: ");
-                htmlWriter->Element(HtmlElement::TableData, String::FromSize(heapAllocSize + Memory::TotalAllocSize) + " bytes");
+                htmlWriter->Element(HtmlElement::TableData, String::FromSize(heapAllocSize + size_t(totalStats.allocSize)) + " bytes");
             htmlWriter->End(HtmlElement::TableRow);
         htmlWriter->End(HtmlElement::Table);
 
@@ -136,10 +137,11 @@ MemoryPageHandler::HandleRequest(const Ptr<HttpRequest>& request)
 
             for (i = 0; i < Memory::NumHeapTypes; i++)
             {
+                Memory::HeapStats stats = Memory::GetHeapStats((Memory::HeapType)i);
                 htmlWriter->Begin(HtmlElement::TableRow);
                     htmlWriter->Element(HtmlElement::TableData, Memory::GetHeapTypeName((Memory::HeapType)i));
-                    htmlWriter->Element(HtmlElement::TableData, String::FromLong(Memory::HeapTypeAllocCount[i]));
-                    htmlWriter->Element(HtmlElement::TableData, String::FromSize(Memory::HeapTypeAllocSize[i]));
+                    htmlWriter->Element(HtmlElement::TableData, String::FromLong(long(stats.allocCount)));
+                    htmlWriter->Element(HtmlElement::TableData, String::FromSize(size_t(stats.allocSize)));
                 htmlWriter->End(HtmlElement::TableRow);
             }
         htmlWriter->End(HtmlElement::Table);
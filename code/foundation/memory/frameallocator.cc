@@ -0,0 +1,208 @@
+//------------------------------------------------------------------------------
+//  frameallocator.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "memory/frameallocator.h"
+#include "threading/criticalsection.h"
+#include "profiling/profiling.h"
+
+namespace Memory
+{
+
+namespace
+{
+
+struct FrameSlot
+{
+    byte* memory;
+    int volatile nextBlock;
+    Util::Array<void*> overflowAllocs;
+};
+
+struct FrameAllocatorContext
+{
+    Util::FixedArray<FrameSlot> frames;
+    SizeT frameMemorySize;
+    SizeT blockSize;
+    SizeT numBlocks;
+    bool poison;
+
+    // only ever increases, also across Uninit() and Init(), so thread blocks
+    // which are zero initialized or survived a restart are never current
+    int volatile frameIndex;
+    IndexT activeFrame;
+
+    Threading::CriticalSection overflowLock;
+    int volatile overflowReported;
+    int volatile numOverflows;
+    SizeT usedBytes;
+    SizeT highWaterMark;
+} ctx;
+
+/// the block a thread currently allocates from
+struct FrameThreadBlock
+{
+    byte* cursor;
+    byte* end;
+    int frameIndex;
+};
+thread_local FrameThreadBlock LocalFrameBlock;
+
+} // namespace
+
+N_DECLARE_COUNTER(N_FRAME_ALLOCATOR_COUNTER, FrameAllocatorMemory)
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+FrameAllocatorInit(const FrameAllocatorInitInfo& info)
+{
+    n_assert(ctx.frames.IsEmpty());
+    n_assert(info.numFrames > 0);
+    n_assert(info.blockSize > 0 && (info.blockSize & 15) == 0);
+    n_assert(info.frameMemorySize >= info.blockSize);
+
+    ctx.blockSize = info.blockSize;
+    ctx.numBlocks = info.frameMemorySize / info.blockSize;
+    ctx.frameMemorySize = ctx.numBlocks * ctx.blockSize;
+    ctx.poison = info.poison;
+    ctx.frames.Resize(info.numFrames);
+    for (IndexT i = 0; i < ctx.frames.Size(); i++)
+    {
+        ctx.frames[i].memory = (byte*)Memory::Alloc(Memory::ScratchHeap, ctx.frameMemorySize);
+        ctx.frames[i].nextBlock = 0;
+        if (ctx.poison)
+            Memory::Fill(ctx.frames[i].memory, ctx.frameMemorySize, FrameAllocatorPoison);
+    }
+    Threading::Interlocked::Increment(&ctx.frameIndex);
+    ctx.activeFrame = 0;
+    ctx.overflowReported = 0;
+    ctx.numOverflows = 0;
+    ctx.usedBytes = 0;
+    ctx.highWaterMark = 0;
+    N_BUDGET_COUNTER_SETUP(N_FRAME_ALLOCATOR_COUNTER, ctx.frameMemorySize);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+FrameAllocatorUninit()
+{
+    for (IndexT i = 0; i < ctx.frames.Size(); i++)
+    {
+        FrameSlot& frame = ctx.frames[i];
+        for (void* ptr : frame.overflowAllocs)
+            Memory::Free(Memory::ScratchHeap, ptr);
+        Memory::Free(Memory::ScratchHeap, frame.memory);
+    }
+    ctx.frames.Clear();
+
+    // invalidate all thread blocks
+    Threading::Interlocked::Increment(&ctx.frameIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+FrameAllocatorNewFrame()
+{
+    n_assert(!ctx.frames.IsEmpty());
+
+    // record the usage of the frame we're leaving
+    FrameSlot& current = ctx.frames[ctx.activeFrame];
+    ctx.usedBytes = Math::min((SizeT)current.nextBlock, ctx.numBlocks) * ctx.blockSize;
+    ctx.highWaterMark = Math::max(ctx.highWaterMark, ctx.usedBytes);
+
+    // move on and release the oldest frame
+    ctx.activeFrame = (ctx.activeFrame + 1) % ctx.frames.Size();
+    FrameSlot& next = ctx.frames[ctx.activeFrame];
+    for (void* ptr : next.overflowAllocs)
+        Memory::Free(Memory::ScratchHeap, ptr);
+    next.overflowAllocs.Clear();
+    if (ctx.poison)
+        Memory::Fill(next.memory, Math::min((SizeT)next.nextBlock, ctx.numBlocks) * ctx.blockSize, FrameAllocatorPoison);
+    next.nextBlock = 0;
+    ctx.overflowReported = 0;
+
+    Threading::Interlocked::Increment(&ctx.frameIndex);
+    N_BUDGET_COUNTER_RESET(N_FRAME_ALLOCATOR_COUNTER);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+FrameAllocatorStats
+FrameAllocatorGetStats()
+{
+    FrameAllocatorStats stats;
+    stats.capacity = ctx.frameMemorySize;
+    stats.usedBytes = ctx.usedBytes;
+    stats.highWaterMark = ctx.highWaterMark;
+    stats.numOverflows = ctx.numOverflows;
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Frame is out of blocks, serve the allocation from the heap and release it
+    together with the frame.
+*/
+static void*
+FrameAllocOverflow(FrameSlot& frame, SizeT bytes, SizeT alignment)
+{
+    Threading::Interlocked::Increment(&ctx.numOverflows);
+    if (Threading::Interlocked::Exchange(&ctx.overflowReported, 1) == 0)
+    {
+        n_warning("FrameAlloc: frame memory of %d bytes exhausted, allocation of %d bytes falls back to the heap (high water mark of previous frames %d bytes)\n",
+            ctx.frameMemorySize, bytes, ctx.highWaterMark);
+    }
+
+    void* ret = Memory::Alloc(Memory::ScratchHeap, bytes, alignment);
+    ctx.overflowLock.Enter();
+    frame.overflowAllocs.Append(ret);
+    ctx.overflowLock.Leave();
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void*
+FrameAlloc(SizeT bytes, SizeT alignment)
+{
+    n_assert2(!ctx.frames.IsEmpty(), "FrameAlloc: frame allocator is not set up, call Jobs2::JobSystemInit() first");
+    n_assert((alignment & (alignment - 1)) == 0);
+
+    // fast path, bump allocate from the thread's block
+    FrameThreadBlock& block = LocalFrameBlock;
+    if (block.frameIndex == ctx.frameIndex)
+    {
+        byte* ret = (byte*)Memory::alignptr((uintptr_t)block.cursor, alignment);
+        if (ret + bytes <= block.end)
+        {
+            block.cursor = ret + bytes;
+            return ret;
+        }
+    }
+
+    // claim enough blocks to fit the allocation, the rest of the old block is wasted
+    FrameSlot& frame = ctx.frames[ctx.activeFrame];
+    SizeT numBlocks = Math::max((SizeT)1, (SizeT)((bytes + alignment - 1 + ctx.blockSize - 1) / ctx.blockSize));
+    SizeT first = Threading::Interlocked::Add(&frame.nextBlock, numBlocks);
+    if (first + numBlocks > ctx.numBlocks)
+        return FrameAllocOverflow(frame, bytes, alignment);
+
+    byte* mem = frame.memory + first * ctx.blockSize;
+    byte* ret = (byte*)Memory::alignptr((uintptr_t)mem, alignment);
+    block.cursor = ret + bytes;
+    block.end = mem + numBlocks * ctx.blockSize;
+    block.frameIndex = ctx.frameIndex;
+    N_BUDGET_COUNTER_INCR(N_FRAME_ALLOCATOR_COUNTER, numBlocks * ctx.blockSize);
+    return ret;
+}
+
+} // namespace Memory
@@ -0,0 +1,101 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file memory/frameallocator.h
+
+    Frame scoped linear allocator.
+
+    Memory returned by FrameAlloc() stays valid until numFrames calls to
+    FrameAllocatorNewFrame() have been made, so data produced in one frame can
+    safely be consumed by jobs which complete in the following frames. There
+    is no free, all allocations of a frame are released at once when its
+    memory is recycled.
+
+    Each frame owns a fixed pool of memory which is split into blocks. Threads
+    claim whole blocks with a single atomic add and then bump allocate from
+    their own block, so allocation never takes a lock. If a frame runs out of
+    blocks, the allocation falls back to the ScratchHeap, is released with the
+    frame, and a warning with the frame high water mark is emitted.
+
+    With poisoning enabled (default in debug builds), recycled frame memory is
+    filled with FrameAllocatorPoison to make use-after-lifetime bugs visible.
+
+    The frame allocator is owned by the job system. Jobs2::JobSystemInit()
+    sets it up with JobSystemInitInfo::frameAllocator, Jobs2::JobNewFrame()
+    advances it and Jobs2::JobSystemUninit() discards it, so every application
+    which runs jobs can use FrameAlloc(). FrameAllocatorNewFrame() must be
+    called while no thread is allocating.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/types.h"
+
+namespace Memory
+{
+
+/// byte pattern written to recycled frame memory when poisoning is enabled
+static const ubyte FrameAllocatorPoison = 0xFD;
+
+struct FrameAllocatorInitInfo
+{
+    /// size of memory pool for one frame
+    SizeT frameMemorySize;
+    /// number of frames an allocation lives
+    SizeT numFrames;
+    /// size of the blocks threads allocate from
+    SizeT blockSize;
+    /// fill recycled memory with a poison pattern
+    bool poison;
+
+    FrameAllocatorInitInfo()
+        : frameMemorySize(8_MB)
+        , numFrames(3)
+        , blockSize(64_KB)
+#if NEBULA_DEBUG
+        , poison(true)
+#else
+        , poison(false)
+#endif
+    {}
+};
+
+struct FrameAllocatorStats
+{
+    /// size of the memory pool of a frame
+    SizeT capacity;
+    /// bytes handed out in the previous frame, at block granularity
+    SizeT usedBytes;
+    /// highest usage of any frame so far
+    SizeT highWaterMark;
+    /// number of allocations which didn't fit and went to the heap
+    SizeT numOverflows;
+};
+
+/// setup frame allocator
+void FrameAllocatorInit(const FrameAllocatorInitInfo& info);
+/// discard frame allocator
+void FrameAllocatorUninit();
+/// progress to the next frame, releases the memory of the oldest frame
+void FrameAllocatorNewFrame();
+/// get usage statistics
+FrameAllocatorStats FrameAllocatorGetStats();
+
+/// allocate memory which lives for numFrames frames
+void* FrameAlloc(SizeT bytes, SizeT alignment = 16);
+/// allocate an uninitialized array of count elements
+template <typename TYPE> TYPE* FrameAlloc(SizeT count);
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename TYPE>
+inline TYPE*
+FrameAlloc(SizeT count)
+{
+    static_assert(std::is_trivially_destructible<TYPE>::value, "Frame allocations are never destroyed");
+    return (TYPE*)FrameAlloc(count * sizeof(TYPE), alignof(TYPE) > 16 ? alignof(TYPE) : 16);
+}
+
+} // namespace Memory
@@ -0,0 +1,277 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Memory::FrameArray
+
+    Growable array which lives in frame allocator memory.
+
+    Storage comes from Memory::FrameAlloc(), so the array and pointers into it
+    stay valid for the frame allocator lifetime and may be handed to jobs
+    running in the following frames. Growing allocates a new buffer and leaves
+    the old one to be recycled with its frame, so Reserve() up front when the
+    size is known. Elements are never destroyed, which limits the element type
+    to trivially destructible types. Resize() leaves new elements
+    uninitialized.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/types.h"
+#include "memory/frameallocator.h"
+
+namespace Memory
+{
+template <class TYPE>
+class FrameArray
+{
+    static_assert(std::is_trivially_destructible<TYPE>::value, "FrameArray never runs destructors");
+public:
+    /// define element iterator
+    typedef TYPE* Iterator;
+
+    /// constructor
+    FrameArray();
+    /// constructor with initial capacity
+    FrameArray(SizeT capacity);
+    /// arrays share their storage, don't copy
+    FrameArray(const FrameArray<TYPE>& rhs) = delete;
+    /// arrays share their storage, don't copy
+    void operator=(const FrameArray<TYPE>& rhs) = delete;
+
+    /// read/write [] operator
+    TYPE& operator[](IndexT index) const;
+    /// append element to end of array
+    void Append(const TYPE& elm);
+    /// reserve room for at least num elements
+    void Reserve(SizeT num);
+    /// set number of elements, new elements are uninitialized
+    void Resize(SizeT num);
+    /// remove all elements, keeps capacity
+    void Clear();
+    /// get number of elements
+    SizeT Size() const;
+    /// get capacity
+    SizeT Capacity() const;
+    /// return true if array is empty
+    bool IsEmpty() const;
+    /// return reference to last element
+    TYPE& Back() const;
+
+    /// get pointer to first element
+    TYPE* Begin() const;
+    /// get pointer to first element
+    const TYPE* ConstBegin() const;
+    /// get pointer past the last element
+    TYPE* End() const;
+    /// for range-based iteration
+    TYPE* begin() const;
+    /// for range-based iteration
+    TYPE* end() const;
+
+private:
+    /// move elements to a buffer with a new capacity
+    void Grow(SizeT newCapacity);
+
+    TYPE* elements;
+    SizeT count;
+    SizeT capacity;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline
+FrameArray<TYPE>::FrameArray() :
+    elements(nullptr),
+    count(0),
+    capacity(0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline
+FrameArray<TYPE>::FrameArray(SizeT capacity) :
+    elements(nullptr),
+    count(0),
+    capacity(0)
+{
+    this->Grow(capacity);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline TYPE&
+FrameArray<TYPE>::operator[](IndexT index) const
+{
+#if NEBULA_BOUNDSCHECKS
+    n_assert(index >= 0 && index < this->count);
+#endif
+    return this->elements[index];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline void
+FrameArray<TYPE>::Append(const TYPE& elm)
+{
+    if (this->count == this->capacity)
+    {
+        this->Grow(this->capacity == 0 ? 16 : this->capacity * 2);
+    }
+    this->elements[this->count++] = elm;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline void
+FrameArray<TYPE>::Reserve(SizeT num)
+{
+    if (num > this->capacity)
+    {
+        this->Grow(num);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline void
+FrameArray<TYPE>::Resize(SizeT num)
+{
+    this->Reserve(num);
+    this->count = num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline void
+FrameArray<TYPE>::Clear()
+{
+    this->count = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline SizeT
+FrameArray<TYPE>::Size() const
+{
+    return this->count;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline SizeT
+FrameArray<TYPE>::Capacity() const
+{
+    return this->capacity;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline bool
+FrameArray<TYPE>::IsEmpty() const
+{
+    return this->count == 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline TYPE&
+FrameArray<TYPE>::Back() const
+{
+    n_assert(this->count > 0);
+    return this->elements[this->count - 1];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline TYPE*
+FrameArray<TYPE>::Begin() const
+{
+    return this->elements;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline const TYPE*
+FrameArray<TYPE>::ConstBegin() const
+{
+    return this->elements;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline TYPE*
+FrameArray<TYPE>::End() const
+{
+    return this->elements + this->count;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline TYPE*
+FrameArray<TYPE>::begin() const
+{
+    return this->elements;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline TYPE*
+FrameArray<TYPE>::end() const
+{
+    return this->elements + this->count;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class TYPE>
+inline void
+FrameArray<TYPE>::Grow(SizeT newCapacity)
+{
+    if (newCapacity == 0)
+        return;
+    TYPE* newElements = FrameAlloc<TYPE>(newCapacity);
+    if (this->count > 0)
+    {
+        Memory::CopyElements(this->elements, newElements, this->count);
+    }
+    this->elements = newElements;
+    this->capacity = newCapacity;
+}
+
+} // namespace Memory
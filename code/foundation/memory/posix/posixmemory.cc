@@ -6,15 +6,159 @@
 #include "foundation/stdneb.h"
 #include "core/types.h"
 #include "memory/heap.h"
+#include <pthread.h>
+#include <sched.h>
 
 namespace Memory
 {
 void* volatile PosixProcessHeap = 0;
+
+#if NEBULA_POSIX_HEAP_STATS
+thread_local ThreadHeapStats LocalHeapStats;
+
+namespace
+{
+/// counters of exited threads, and threads which are being torn down
+int64_t volatile RetiredAllocCount[NumHeapTypes] = { 0 };
+int64_t volatile RetiredAllocSize[NumHeapTypes] = { 0 };
+/// list of all live thread counters, protected by StatsLock
+ThreadHeapStats* StatsThreads = nullptr;
+int volatile StatsLock = 0;
+pthread_once_t StatsOnce = PTHREAD_ONCE_INIT;
+pthread_key_t StatsKey;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LockStats()
+{
+    while (Threading::Interlocked::CompareExchange(&StatsLock, 1, 0) != 0)
+    {
+        sched_yield();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+UnlockStats()
+{
+    Threading::Interlocked::Exchange(&StatsLock, 0);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Fold the counters of an exiting thread into the retired counters.
+*/
+void
+ThreadStatsExit(void* data)
+{
+    ThreadHeapStats* stats = (ThreadHeapStats*)data;
+    LockStats();
+    ThreadHeapStats** link = &StatsThreads;
+    while (*link != stats)
+    {
+        link = &(*link)->next;
+    }
+    *link = stats->next;
+    for (IndexT i = 0; i < NumHeapTypes; i++)
+    {
+        Threading::Interlocked::Add(&RetiredAllocCount[i], stats->allocCount[i]);
+        Threading::Interlocked::Add(&RetiredAllocSize[i], stats->allocSize[i]);
+    }
+    stats->state = 2;
+    UnlockStats();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+StatsSetup()
+{
+    pthread_key_create(&StatsKey, ThreadStatsExit);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/**
+    Slow path of RecordAlloc(), registers the calling thread's counters on
+    first use. Threads which already went through their exit handler record
+    straight into the retired counters.
+*/
+void
+RecordThreadHeapStats(HeapType heapType, int64_t count, int64_t size)
+{
+    ThreadHeapStats& stats = LocalHeapStats;
+    if (stats.state == 0)
+    {
+        pthread_once(&StatsOnce, StatsSetup);
+        LockStats();
+        stats.next = StatsThreads;
+        StatsThreads = &stats;
+        stats.allocCount[heapType] = count;
+        stats.allocSize[heapType] = size;
+        stats.state = 1;
+        UnlockStats();
+        pthread_setspecific(StatsKey, &stats);
+    }
+    else
+    {
+        Threading::Interlocked::Add(&RetiredAllocCount[heapType], count);
+        Threading::Interlocked::Add(&RetiredAllocSize[heapType], size);
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+/**
+    Sum up the counters of all threads. Counts may be momentarily off by
+    the allocations which are in flight on other threads, and individual
+    thread counters can be negative when memory is freed by another thread
+    than the one which allocated it.
+*/
+HeapStats
+GetHeapStats(HeapType heapType)
+{
+    n_assert(heapType < NumHeapTypes);
+    HeapStats result;
+    #if NEBULA_POSIX_HEAP_STATS
+    LockStats();
+    result.allocCount = RetiredAllocCount[heapType];
+    result.allocSize = RetiredAllocSize[heapType];
+    for (ThreadHeapStats* stats = StatsThreads; stats != nullptr; stats = stats->next)
+    {
+        result.allocCount += stats->allocCount[heapType];
+        result.allocSize += stats->allocSize[heapType];
+    }
+    UnlockStats();
+    #else
+    result.allocCount = 0;
+    result.allocSize = 0;
+    #endif
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+HeapStats
+GetTotalHeapStats()
+{
+    HeapStats result = { 0, 0 };
+    for (IndexT i = 0; i < NumHeapTypes; i++)
+    {
+        HeapStats stats = GetHeapStats(HeapType(i));
+        result.allocCount += stats.allocCount;
+        result.allocSize += stats.allocSize;
+    }
+    return result;
+}
+
 #if NEBULA_MEMORY_STATS
-int volatile TotalAllocCount = 0;
-int volatile TotalAllocSize = 0;
-int volatile HeapTypeAllocCount[NumHeapTypes] = { 0 };
-int volatile HeapTypeAllocSize[NumHeapTypes] = { 0 };
 
 //------------------------------------------------------------------------------
 /**
@@ -102,6 +246,11 @@ operator delete(void* p) noexcept
 {
     Memory::Free(Memory::ObjectHeap, p);
 }
+void
+operator delete(void* p, std::align_val_t al) noexcept
+{
+    Memory::Free(Memory::ObjectHeap, p);
+}
 
 //------------------------------------------------------------------------------
 /**
@@ -109,6 +258,11 @@ operator delete(void* p) noexcept
 */
 void
 operator delete[](void* p) noexcept
+{
+    Memory::Free(Memory::ObjectArrayHeap, p);
+}
+void
+operator delete[](void* p, std::align_val_t al) noexcept
 {
     Memory::Free(Memory::ObjectArrayHeap, p);
 }
\ No newline at end of file
@@ -16,17 +16,42 @@
 #include "core/debug.h"
 #include "threading/interlocked.h"
 #include "memory/posix/posixmemoryconfig.h"
+#include "memory/posix/posixsizeclassheap.h"
 #include <string.h>
+#include <stdint.h>
 #include <sys/mman.h>
+#if __APPLE__
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
 
 namespace Memory
 {
-#if NEBULA_MEMORY_STATS
-extern int volatile TotalAllocCount;
-extern size_t volatile TotalAllocSize;
-extern int volatile HeapTypeAllocCount[NumHeapTypes];
-extern size_t volatile HeapTypeAllocSize[NumHeapTypes];
+/// allocation statistics of a heap type
+struct HeapStats
+{
+    int64_t allocCount;
+    int64_t allocSize;
+};
+
+#if NEBULA_POSIX_HEAP_STATS
+/// per thread allocation counters, only written by the owning thread
+struct ThreadHeapStats
+{
+    int64_t volatile allocCount[NumHeapTypes];
+    int64_t volatile allocSize[NumHeapTypes];
+    ThreadHeapStats* next;
+    int state;
+};
+extern thread_local ThreadHeapStats LocalHeapStats;
+/// register the calling thread's counters, or record into the global counters if the thread is exiting
+extern void RecordThreadHeapStats(HeapType heapType, int64_t count, int64_t size);
 #endif
+/// get the current allocation statistics for a heap type, aggregated over all threads, zero without NEBULA_POSIX_HEAP_STATS
+extern HeapStats GetHeapStats(HeapType heapType);
+/// get the current allocation statistics summed over all heap types
+extern HeapStats GetTotalHeapStats();
 
 #define StackAlloc(size) alloca(size);
 #define StackFree(ptr)
@@ -35,6 +60,53 @@ extern size_t volatile HeapTypeAllocSize[NumHeapTypes];
 #define explicit_bzero bzero;
 #endif
 
+#if NEBULA_POSIX_HEAP_STATS
+//------------------------------------------------------------------------------
+/**
+    Update the calling thread's allocation counters. Counters are plain
+    per thread values, so this doesn't need any atomic operations.
+*/
+__forceinline void
+RecordAlloc(HeapType heapType, int64_t count, int64_t size)
+{
+    ThreadHeapStats& stats = LocalHeapStats;
+    if (stats.state == 1)
+    {
+        stats.allocCount[heapType] = stats.allocCount[heapType] + count;
+        stats.allocSize[heapType] = stats.allocSize[heapType] + size;
+    }
+    else
+    {
+        RecordThreadHeapStats(heapType, count, size);
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+/**
+    Get the usable size of a block allocated from the system heap.
+*/
+__forceinline size_t
+SystemBlockSize(void* ptr)
+{
+#if __APPLE__
+    return malloc_size(ptr);
+#else
+    return malloc_usable_size(ptr);
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+    Returns true if small allocations of a heap type are served by the
+    thread caching size class heap.
+*/
+__forceinline bool
+UsesSizeClassHeap(HeapType heapType)
+{
+    return heapType == ObjectHeap || heapType == ObjectArrayHeap || heapType == StringDataHeap;
+}
+
 //------------------------------------------------------------------------------
 /**
     Allocate a block of memory from the process heap.
@@ -44,7 +116,16 @@ Alloc(HeapType heapType, size_t size, size_t align = 16)
 {
     n_assert(heapType < NumHeapTypes);
     n_assert(align != 0);
-    void* allocPtr = 0;
+    void* allocPtr = nullptr;
+    if (UsesSizeClassHeap(heapType) && align <= SizeClassAlignment && size <= SizeClassMaxSize)
+    {
+        allocPtr = SizeClassAlloc(size);
+        #if NEBULA_POSIX_HEAP_STATS
+        if (allocPtr != nullptr)
+            RecordAlloc(heapType, 1, int64_t(SizeClassSize(SizeClassIndex(size))));
+        #endif
+    }
+    if (allocPtr == nullptr)
     {
         align = std::max(align, sizeof(void*));
 
@@ -55,16 +136,12 @@ Alloc(HeapType heapType, size_t size, size_t align = 16)
         #endif
         int err = posix_memalign(&allocPtr, align, size);
         n_assert(err == 0);
-        #if NEBULA_DEBUG
-        explicit_bzero(allocPtr,size);
+        #if NEBULA_POSIX_HEAP_STATS
+        RecordAlloc(heapType, 1, int64_t(SystemBlockSize(allocPtr)));
         #endif
     }
-    #if NEBULA_MEMORY_STATS
-        SIZE_T s = HeapSize(Heaps[heapType], 0, allocPtr);
-        Threading::Interlocked::Increment(TotalAllocCount);
-        Threading::Interlocked::Add(TotalAllocSize, int(s));
-        Threading::Interlocked::Increment(HeapTypeAllocCount[heapType]);
-        Threading::Interlocked::Add(HeapTypeAllocSize[heapType], int(s));
+    #if NEBULA_DEBUG
+    explicit_bzero(allocPtr,size);
     #endif
     return allocPtr;
 }
@@ -77,16 +154,30 @@ __forceinline void*
 Realloc(HeapType heapType, void* ptr, size_t size)
 {
     n_assert(heapType < NumHeapTypes);
-    #if NEBULA_MEMORY_STATS
-        SIZE_T oldSize = HeapSize(Heaps[heapType], 0, ptr);
-    #endif
+    if (ptr != nullptr && SizeClassOwns(ptr))
+    {
+        // size class blocks can't grow in place, move them
+        size_t oldSize = SizeClassBlockSize(ptr);
+        if (size <= oldSize && SizeClassIndex(size) == SizeClassIndex(oldSize))
+        {
+            return ptr;
+        }
+        void* allocPtr = Alloc(heapType, size);
+        memcpy(allocPtr, ptr, std::min(oldSize, size));
+        SizeClassFree(ptr);
+        #if NEBULA_POSIX_HEAP_STATS
+        RecordAlloc(heapType, -1, -int64_t(oldSize));
+        #endif
+        return allocPtr;
+    }
+    #if NEBULA_POSIX_HEAP_STATS
+    int64_t oldSize = ptr != nullptr ? int64_t(SystemBlockSize(ptr)) : 0;
     void* allocPtr = realloc(ptr, size);
-    #if NEBULA_MEMORY_STATS
-        SIZE_T newSize = HeapSize(Heaps[heapType], 0, allocPtr);
-        Threading::Interlocked::Add(TotalAllocSize, int(newSize - oldSize));
-        Threading::Interlocked::Add(HeapTypeAllocSize[heapType], int(newSize - oldSize));
-    #endif
+    RecordAlloc(heapType, ptr != nullptr ? 0 : 1, int64_t(SystemBlockSize(allocPtr)) - oldSize);
     return allocPtr;
+    #else
+    return realloc(ptr, size);
+    #endif
 }
 
 //------------------------------------------------------------------------------
@@ -100,21 +191,21 @@ Free(HeapType heapType, void* ptr)
     if (0 != ptr)
     {
         n_assert(heapType < NumHeapTypes);
-        #if NEBULA_MEMORY_STATS
-            SIZE_T size = 0;
-        #endif    
+        if (SizeClassOwns(ptr))
+        {
+            #if NEBULA_POSIX_HEAP_STATS
+            RecordAlloc(heapType, -1, -int64_t(SizeClassFree(ptr)));
+            #else
+            SizeClassFree(ptr);
+            #endif
+        }
+        else
         {
-            #if NEBULA_MEMORY_STATS
-                size = HeapSize(Heaps[heapType], 0, ptr);
+            #if NEBULA_POSIX_HEAP_STATS
+            RecordAlloc(heapType, -1, -int64_t(SystemBlockSize(ptr)));
             #endif
             free(ptr);
         }
-        #if NEBULA_MEMORY_STATS
-            Threading::Interlocked::Add(TotalAllocSize, -int(size));
-            Threading::Interlocked::Decrement(TotalAllocCount);
-            Threading::Interlocked::Add(HeapTypeAllocSize[heapType], -int(size));
-            Threading::Interlocked::Decrement(HeapTypeAllocCount[heapType]);
-        #endif
     }
 }
 
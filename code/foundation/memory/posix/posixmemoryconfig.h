@@ -12,6 +12,14 @@
 */
 #include "core/config.h"
 
+// per thread allocation counters of the Posix heaps, independent of the Win32 style
+// heap bookkeeping behind NEBULA_MEMORY_STATS
+#if NEBULA_DEBUG
+#define NEBULA_POSIX_HEAP_STATS (1)
+#else
+#define NEBULA_POSIX_HEAP_STATS (0)
+#endif
+
 namespace Memory
 {
 
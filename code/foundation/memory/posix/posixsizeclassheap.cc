@@ -0,0 +1,376 @@
+//------------------------------------------------------------------------------
+//  posixsizeclassheap.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "memory/posix/posixsizeclassheap.h"
+#include "threading/interlocked.h"
+#include <sys/mman.h>
+#include <pthread.h>
+#include <sched.h>
+
+namespace Memory
+{
+char* volatile SizeClassArenaBase = nullptr;
+char* volatile SizeClassArenaEnd = nullptr;
+
+namespace
+{
+/// size of the reserved address range
+const size_t ArenaReserveSize = size_t(64) << 30;
+/// spans are the unit a size class gets memory in
+const size_t SpanShift = 16;
+const size_t SpanSize = size_t(1) << SpanShift;
+const size_t NumSpans = ArenaReserveSize >> SpanShift;
+/// the arena is committed in chunks of this size
+const size_t CommitChunkSize = size_t(2) << 20;
+/// amount of memory moved between a thread cache and the central lists at once
+const size_t TransferBytes = 16384;
+
+enum ThreadCacheState
+{
+    CacheUninitialized = 0,
+    CacheActive,
+    CacheDead
+};
+
+/// per thread free lists, must stay a POD so the thread_local needs no initializer
+struct ThreadCache
+{
+    void* heads[NumSizeClasses];
+    uint counts[NumSizeClasses];
+    int state;
+};
+
+/// central free list of one size class, padded to avoid false sharing
+struct alignas(64) CentralList
+{
+    int volatile lock;
+    void* freeList;
+    char* carveCursor;
+    char* carveEnd;
+};
+
+thread_local ThreadCache LocalCache;
+CentralList CentralLists[NumSizeClasses];
+ubyte SpanClasses[NumSpans];
+
+int volatile ArenaLock = 0;
+char* ArenaCommitted = nullptr;
+char* ArenaNextSpan = nullptr;
+pthread_once_t ArenaOnce = PTHREAD_ONCE_INIT;
+pthread_key_t CacheKey;
+int volatile ArenaInitialized = 0;
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Lock(int volatile* lock)
+{
+    while (Threading::Interlocked::CompareExchange(lock, 1, 0) != 0)
+    {
+        while (*lock != 0)
+        {
+            sched_yield();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Unlock(int volatile* lock)
+{
+    Threading::Interlocked::Exchange(lock, 0);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Number of blocks moved between thread and central lists at once.
+*/
+inline uint
+BatchSize(int sizeClass)
+{
+    size_t num = TransferBytes / SizeClassSize(sizeClass);
+    return uint(num < 4 ? 4 : (num > 64 ? 64 : num));
+}
+
+//------------------------------------------------------------------------------
+/**
+    Get a fresh span for a size class, commits memory as needed.
+*/
+char*
+AllocSpan(int sizeClass)
+{
+    char* span = nullptr;
+    Lock(&ArenaLock);
+    if (ArenaNextSpan + SpanSize > ArenaCommitted && ArenaCommitted + CommitChunkSize <= SizeClassArenaEnd)
+    {
+        if (mprotect(ArenaCommitted, CommitChunkSize, PROT_READ | PROT_WRITE) == 0)
+        {
+            ArenaCommitted += CommitChunkSize;
+        }
+    }
+    if (ArenaNextSpan + SpanSize <= ArenaCommitted)
+    {
+        span = ArenaNextSpan;
+        ArenaNextSpan += SpanSize;
+        SpanClasses[(span - SizeClassArenaBase) >> SpanShift] = ubyte(sizeClass);
+    }
+    Unlock(&ArenaLock);
+    return span;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Take up to num blocks from a central list, carving new spans as needed.
+    Returns the number of blocks linked into outHead.
+*/
+uint
+CentralFetch(int sizeClass, uint num, void** outHead)
+{
+    CentralList& list = CentralLists[sizeClass];
+    const size_t blockSize = SizeClassSize(sizeClass);
+    void* head = nullptr;
+    uint count = 0;
+
+    Lock(&list.lock);
+    while (count < num && list.freeList != nullptr)
+    {
+        void* block = list.freeList;
+        list.freeList = *(void**)block;
+        *(void**)block = head;
+        head = block;
+        count++;
+    }
+    while (count < num)
+    {
+        if (list.carveCursor + blockSize > list.carveEnd)
+        {
+            char* span = AllocSpan(sizeClass);
+            if (span == nullptr)
+            {
+                break;
+            }
+            list.carveCursor = span;
+            list.carveEnd = span + SpanSize;
+        }
+        void* block = list.carveCursor;
+        list.carveCursor += blockSize;
+        *(void**)block = head;
+        head = block;
+        count++;
+    }
+    Unlock(&list.lock);
+
+    *outHead = head;
+    return count;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Return a chain of blocks to a central list.
+*/
+void
+CentralRelease(int sizeClass, void* head, void* tail)
+{
+    CentralList& list = CentralLists[sizeClass];
+    Lock(&list.lock);
+    *(void**)tail = list.freeList;
+    list.freeList = head;
+    Unlock(&list.lock);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Move num blocks from the head of a thread list to the central list.
+*/
+void
+ReleaseBatch(ThreadCache& cache, int sizeClass, uint num)
+{
+    void* head = cache.heads[sizeClass];
+    void* tail = head;
+    for (uint i = 1; i < num; i++)
+    {
+        tail = *(void**)tail;
+    }
+    cache.heads[sizeClass] = *(void**)tail;
+    cache.counts[sizeClass] -= num;
+    CentralRelease(sizeClass, head, tail);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Flush a thread cache and mark it dead, called when a thread exits.
+    Frees after this point go straight to the central lists.
+*/
+void
+ThreadCacheExit(void* data)
+{
+    ThreadCache* cache = (ThreadCache*)data;
+    for (int i = 0; i < NumSizeClasses; i++)
+    {
+        if (cache->counts[i] > 0)
+        {
+            ReleaseBatch(*cache, i, cache->counts[i]);
+        }
+    }
+    cache->state = CacheDead;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Reserve the arena, runs exactly once.
+*/
+void
+ArenaSetup()
+{
+    void* base = mmap(nullptr, ArenaReserveSize, PROT_NONE, MAP_ANON | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        // leave the arena empty, all allocations fall back to the system heap
+        return;
+    }
+    pthread_key_create(&CacheKey, ThreadCacheExit);
+
+    ArenaCommitted = (char*)base;
+    ArenaNextSpan = (char*)base;
+    SizeClassArenaEnd = (char*)base + ArenaReserveSize;
+    SizeClassArenaBase = (char*)base;
+    Threading::Interlocked::Exchange(&ArenaInitialized, 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Make the calling thread's cache usable, returns false if the arena is not available.
+*/
+bool
+AttachThread(ThreadCache& cache)
+{
+    if (!ArenaInitialized)
+    {
+        pthread_once(&ArenaOnce, ArenaSetup);
+        if (!ArenaInitialized)
+        {
+            return false;
+        }
+    }
+    cache.state = CacheActive;
+    pthread_setspecific(CacheKey, &cache);
+    return true;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/**
+*/
+void*
+SizeClassAlloc(size_t size)
+{
+    n_assert(size <= SizeClassMaxSize);
+    const int sizeClass = SizeClassIndex(size);
+    ThreadCache& cache = LocalCache;
+    if (cache.state != CacheActive)
+    {
+        if (cache.state == CacheDead)
+        {
+            // thread is shutting down, bypass the cache
+            void* block = nullptr;
+            CentralFetch(sizeClass, 1, &block);
+            return block;
+        }
+        if (!AttachThread(cache))
+        {
+            return nullptr;
+        }
+    }
+
+    void* block = cache.heads[sizeClass];
+    if (block == nullptr)
+    {
+        uint num = CentralFetch(sizeClass, BatchSize(sizeClass), &block);
+        if (num == 0)
+        {
+            return nullptr;
+        }
+        cache.counts[sizeClass] = num;
+    }
+    cache.heads[sizeClass] = *(void**)block;
+    cache.counts[sizeClass]--;
+    return block;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t
+SizeClassFree(void* ptr)
+{
+    n_assert(SizeClassOwns(ptr));
+    const int sizeClass = SpanClasses[((char*)ptr - SizeClassArenaBase) >> SpanShift];
+    ThreadCache& cache = LocalCache;
+    if (cache.state != CacheActive && (cache.state == CacheDead || !AttachThread(cache)))
+    {
+        CentralRelease(sizeClass, ptr, ptr);
+        return SizeClassSize(sizeClass);
+    }
+
+    *(void**)ptr = cache.heads[sizeClass];
+    cache.heads[sizeClass] = ptr;
+    cache.counts[sizeClass]++;
+
+    // keep the thread list bounded, hand the oldest part back when it grows too long
+    const uint batch = BatchSize(sizeClass);
+    if (cache.counts[sizeClass] > batch * 2)
+    {
+        void* last = cache.heads[sizeClass];
+        for (uint i = 1; i < batch; i++)
+        {
+            last = *(void**)last;
+        }
+        void* releaseHead = *(void**)last;
+        void* releaseTail = releaseHead;
+        for (uint i = 1; i < cache.counts[sizeClass] - batch; i++)
+        {
+            releaseTail = *(void**)releaseTail;
+        }
+        *(void**)last = nullptr;
+        cache.counts[sizeClass] = batch;
+        CentralRelease(sizeClass, releaseHead, releaseTail);
+    }
+    return SizeClassSize(sizeClass);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t
+SizeClassBlockSize(const void* ptr)
+{
+    n_assert(SizeClassOwns(ptr));
+    return SizeClassSize(SpanClasses[((const char*)ptr - SizeClassArenaBase) >> SpanShift]);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SizeClassFlushThreadCache()
+{
+    ThreadCache& cache = LocalCache;
+    if (cache.state == CacheActive)
+    {
+        for (int i = 0; i < NumSizeClasses; i++)
+        {
+            if (cache.counts[i] > 0)
+            {
+                ReleaseBatch(cache, i, cache.counts[i]);
+            }
+        }
+    }
+}
+
+} // namespace Memory
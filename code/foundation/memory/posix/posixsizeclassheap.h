@@ -0,0 +1,90 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file memory/posix/posixsizeclassheap.h
+
+    Size class allocator backing the small object heaps on Posix.
+
+    Block sizes are rounded up to one of NumSizeClasses classes (16 byte
+    steps up to 128 bytes, then 4 classes per power of two up to
+    SizeClassMaxSize). Every thread owns a cache with one free list per class,
+    so the common alloc/free path is a thread local list push/pop without any
+    atomic operations. Threads refill from and return batches to central free
+    lists which are protected by a spin lock per class.
+
+    Blocks are carved from 64 KB spans inside a single reserved virtual address
+    range, which makes ownership tests a simple range check and lets free
+    look up the size class of a block through its span. Spans are committed
+    in 2 MB chunks on demand and never returned to the OS.
+
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include <stddef.h>
+
+namespace Memory
+{
+/// number of size classes
+static const int NumSizeClasses = 36;
+/// largest allocation served by the size class heap
+static const size_t SizeClassMaxSize = 16384;
+/// alignment guaranteed for all size class blocks
+static const size_t SizeClassAlignment = 16;
+
+/// start of the size class arena, null until the first allocation
+extern char* volatile SizeClassArenaBase;
+/// end of the reserved size class arena
+extern char* volatile SizeClassArenaEnd;
+
+/// allocate a block of at least size bytes, returns nullptr if the arena is exhausted
+extern void* SizeClassAlloc(size_t size);
+/// free a block owned by the size class heap, returns the block size
+extern size_t SizeClassFree(void* ptr);
+/// get the block size of a block owned by the size class heap
+extern size_t SizeClassBlockSize(const void* ptr);
+/// return all blocks cached by the calling thread to the central free lists
+extern void SizeClassFlushThreadCache();
+
+//------------------------------------------------------------------------------
+/**
+    Map an allocation size to its size class.
+*/
+inline int
+SizeClassIndex(size_t size)
+{
+    if (size <= 128)
+    {
+        return size == 0 ? 0 : int((size + 15) >> 4) - 1;
+    }
+    size_t s = size - 1;
+    int log2 = 63 - __builtin_clzll((unsigned long long)s);
+    return 8 + (log2 - 7) * 4 + int(s >> (log2 - 2)) - 4;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Get the block size of a size class.
+*/
+inline size_t
+SizeClassSize(int sizeClass)
+{
+    if (sizeClass < 8)
+    {
+        return size_t(sizeClass + 1) << 4;
+    }
+    int log2 = 7 + (sizeClass - 8) / 4;
+    int sub = (sizeClass - 8) % 4;
+    return (size_t(1) << log2) + (size_t(sub + 1) << (log2 - 2));
+}
+
+//------------------------------------------------------------------------------
+/**
+    Test if a pointer was allocated by the size class heap.
+*/
+inline bool
+SizeClassOwns(const void* ptr)
+{
+    return (const char*)ptr >= SizeClassArenaBase && (const char*)ptr < SizeClassArenaEnd;
+}
+
+} // namespace Memory
+//------------------------------------------------------------------------------
@@ -67,6 +67,35 @@ struct TotalMemoryStatus
 extern TotalMemoryStatus GetTotalMemoryStatus();
 extern void DumpTotalMemoryStatus();
 
+/// allocation statistics of a heap type
+struct HeapStats
+{
+    int64_t allocCount;
+    int64_t allocSize;
+};
+
+//------------------------------------------------------------------------------
+/**
+    Get the current allocation statistics for a heap type.
+*/
+inline HeapStats
+GetHeapStats(HeapType heapType)
+{
+    HeapStats result = { HeapTypeAllocCount[heapType], (int64_t)HeapTypeAllocSize[heapType] };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Get the current allocation statistics summed over all heap types.
+*/
+inline HeapStats
+GetTotalHeapStats()
+{
+    HeapStats result = { TotalAllocCount, (int64_t)TotalAllocSize };
+    return result;
+}
+
 //------------------------------------------------------------------------------
 /**
     Debug function which validates the process heap. This will NOT check
@@ -9,6 +9,7 @@
 #include <sys/errno.h>
 #include <fcntl.h>
 #include <netdb.h>
+#include <poll.h>
 
 namespace Posix
 {
@@ -316,7 +317,9 @@ PosixSocket::Listen()
     Accept an incoming connection to a server socket. This will spawn
     a new socket for the connection which will be returned in the provided
     pointer reference. The address of the returned socket will be set to
-    the address of the "connecting entity".
+    the address of the "connecting entity". On a non-blocking socket
+    Accept() returns false without an error message when no connection is
+    pending.
 */
 bool
 PosixSocket::Accept(Ptr<Net::Socket>& outSocket)
@@ -332,7 +335,10 @@ PosixSocket::Accept(Ptr<Net::Socket>& outSocket)
     if (INVALID_SOCKET == newSocket)
     {
         this->SetToLastSocketError();
-        n_printf("PosixSocket::Accept(): accept() failed with '%s'!\n", this->GetErrorString().AsCharPtr());
+        if (ErrorWouldBlock != this->error)
+        {
+            n_printf("PosixSocket::Accept(): accept() failed with '%s'!\n", this->GetErrorString().AsCharPtr());
+        }
         return false;
     }
     Net::IpAddress ipAddr;
@@ -395,26 +401,23 @@ PosixSocket::Connect()
 
 //------------------------------------------------------------------------------
 /**
-    This tests if the socket is actually connected by doing a select()
+    This tests if the socket is actually connected by doing a poll()
     on the socket to probe for writability. So the IsConnected() method
-    basically checks whether data can be sent through the socket.
+    basically checks whether data can be sent through the socket. Unlike
+    select() this also works for descriptors above FD_SETSIZE.
 */
 bool
 PosixSocket::IsConnected()
 {
     n_assert(this->IsOpen());
-    fd_set readSet;
-    FD_ZERO(&readSet);
-    FD_SET(this->sock, &readSet);
-    
-    timeval timeVal = { 0, 0 };
-    int res = select(this->sock + 1, 0, &readSet, 0, &timeVal); 
+    pollfd pollFd = { this->sock, POLLOUT, 0 };
+    int res = poll(&pollFd, 1, 0);
     if (SOCKET_ERROR == res)
     {
         this->SetToLastSocketError();
         return false;
     }
-    else if (0 == res)
+    else if ((0 == res) || (0 == (pollFd.revents & POLLOUT)))
     {
     return false;
     }
@@ -467,12 +470,8 @@ bool
 PosixSocket::HasRecvData()
 {
     n_assert(this->IsOpen());
-    fd_set readSet;
-    FD_ZERO(&readSet);
-    FD_SET(this->sock, &readSet);
-    
-    timeval timeVal = { 0, 0 };
-    int res = select(this->sock + 1, &readSet, 0, 0, &timeVal);
+    pollfd pollFd = { this->sock, POLLIN, 0 };
+    int res = poll(&pollFd, 1, 0);
     if (SOCKET_ERROR == res)
     {
         this->SetToLastSocketError();
@@ -0,0 +1,526 @@
+//------------------------------------------------------------------------------
+//  epolltcpclientconnection.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+
+#include "net/tcp/epolltcpclientconnection.h"
+#include "net/tcp/epolltcpserver.h"
+#include "math/scalar.h"
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <errno.h>
+
+namespace Net
+{
+__ImplementClass(Net::EpollTcpClientConnection, 'ETCC', Net::StdTcpClientConnection);
+
+using namespace IO;
+
+//------------------------------------------------------------------------------
+/**
+*/
+EpollTcpClientConnection::EpollTcpClientConnection() :
+    server(nullptr),
+    ioThread(InvalidIndex),
+    fd(-1),
+    peerClosed(false),
+    hasError(false),
+    readStalled(false),
+    isReady(false),
+    lastPoll(0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+EpollTcpClientConnection::~EpollTcpClientConnection()
+{
+    n_assert(nullptr == this->server);
+    this->recvRing.Discard();
+    this->sendRing.Discard();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpClientConnection::Attach(EpollTcpServer* srv, IndexT thread)
+{
+    n_assert(nullptr == this->server);
+    n_assert(this->socket.isvalid());
+    this->socket->SetBlocking(false);
+    this->fd = this->socket->GetSocketHandle();
+    this->server = srv;
+    this->ioThread = thread;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+EpollTcpClientConnection::IsConnected() const
+{
+    if (nullptr == this->server)
+    {
+        return StdTcpClientConnection::IsConnected();
+    }
+    this->critSect.Enter();
+    bool connected = this->socket.isvalid() && !this->hasError;
+    this->critSect.Leave();
+    return connected;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Data still in the send queue gets one last chance to go out, everything
+    else is dropped.
+*/
+void
+EpollTcpClientConnection::Shutdown()
+{
+    if (nullptr == this->server)
+    {
+        StdTcpClientConnection::Shutdown();
+        return;
+    }
+
+    this->critSect.Enter();
+    if (this->socket.isvalid())
+    {
+        if (!this->hasError && this->sendRing.Size() > 0)
+        {
+            this->FlushSendQueue(nullptr, 0);
+        }
+        this->server->UnregisterConnection(this);
+    }
+    StdTcpClientConnection::Shutdown();
+    this->fd = -1;
+    this->recvRing.Discard();
+    this->sendRing.Discard();
+    this->server = nullptr;
+    this->critSect.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+    If nothing is queued the stream is sent directly from its own memory.
+    Whatever the socket doesn't accept, and everything sent while older data
+    is still queued, is appended to the send ring buffer and flushed by the
+    I/O thread when the socket becomes writable again.
+*/
+Socket::Result
+EpollTcpClientConnection::Send(const Ptr<Stream>& stream)
+{
+    if (nullptr == this->server)
+    {
+        return StdTcpClientConnection::Send(stream);
+    }
+
+    n_assert(stream.isvalid());
+    if (stream->GetSize() == 0)
+    {
+        // nothing to send
+        return Socket::Success;
+    }
+
+    Socket::Result res = Socket::Success;
+    EpollTcpServer* failedServer = nullptr;
+    stream->SetAccessMode(Stream::ReadAccess);
+    if (stream->Open())
+    {
+        Stream::Size sendSize = stream->GetSize();
+        n_assert(sendSize < INT_MAX);
+        const ubyte* ptr = (const ubyte*)stream->Map();
+
+        this->critSect.Enter();
+        if (!this->socket.isvalid() || this->hasError)
+        {
+            res = Socket::Error;
+        }
+        else
+        {
+            SizeT bytesSent = 0;
+            if (this->sendRing.Size() == 0)
+            {
+                bytesSent = this->FlushSendQueue(ptr, (SizeT)sendSize);
+            }
+            if (!this->hasError && bytesSent < sendSize)
+            {
+                SizeT remaining = (SizeT)sendSize - bytesSent;
+                if (this->sendRing.Size() + remaining > MaxSendBufferSize)
+                {
+                    n_printf("EpollTcpClientConnection::Send(): send queue of client %s is full, dropping connection!\n",
+                        this->socket->GetAddress().GetHostAddr().AsCharPtr());
+                    this->hasError = true;
+                }
+                else
+                {
+                    this->sendRing.Write(ptr + bytesSent, remaining);
+                }
+            }
+            if (this->hasError)
+            {
+                res = Socket::Error;
+                failedServer = this->server;
+            }
+        }
+        this->critSect.Leave();
+
+        stream->Unmap();
+        stream->Close();
+    }
+
+    // let the server drop the connection on its next Recv()
+    if (nullptr != failedServer)
+    {
+        failedServer->SetConnectionReady(this);
+    }
+    return res;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Copies everything the I/O thread has received since the last call into
+    the recv stream. Returns Success if there was data, even if the peer
+    has closed the connection in the meantime, Closed or Error are returned
+    by the next call.
+*/
+Socket::Result
+EpollTcpClientConnection::Recv()
+{
+    if (nullptr == this->server)
+    {
+        return StdTcpClientConnection::Recv();
+    }
+
+    n_assert(this->recvStream.isvalid());
+    this->recvStream->SetAccessMode(Stream::WriteAccess);
+    this->recvStream->SetSize(0);
+
+    Socket::Result res = Socket::WouldBlock;
+    this->critSect.Enter();
+    SizeT numBytes = this->recvRing.Size();
+    if (numBytes > 0)
+    {
+        if (this->recvStream->Open())
+        {
+            iovec regions[2];
+            int numRegions = this->recvRing.GetFilledRegions(regions);
+            for (int i = 0; i < numRegions; i++)
+            {
+                this->recvStream->Write(regions[i].iov_base, (Stream::Size)regions[i].iov_len);
+            }
+            this->recvStream->Close();
+        }
+        this->recvRing.readPos = this->recvRing.writePos = 0;
+        res = Socket::Success;
+    }
+    else if (this->hasError)
+    {
+        res = Socket::Error;
+    }
+    else if (this->peerClosed)
+    {
+        res = Socket::Closed;
+    }
+
+    // reading stopped because the buffer was full, have the I/O thread continue
+    if (this->readStalled)
+    {
+        this->readStalled = false;
+        this->server->RearmConnection(this);
+    }
+    this->critSect.Leave();
+
+    this->recvStream->SetAccessMode(Stream::ReadAccess);
+    return res;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+EpollTcpClientConnection::GetNumQueuedSendBytes() const
+{
+    this->critSect.Enter();
+    SizeT size = this->sendRing.Size();
+    this->critSect.Leave();
+    return size;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Called by the I/O thread on EPOLLIN. Since the socket is edge-triggered
+    it has to be read until it would block, unless the receive buffer is
+    full, in which case reading continues once Recv() has drained it.
+*/
+bool
+EpollTcpClientConnection::OnReadable()
+{
+    const SizeT MinReadSize = 16 * 1024;
+    const SizeT GrowSize = 64 * 1024;
+
+    bool notify = false;
+    this->critSect.Enter();
+    while (this->socket.isvalid() && !this->peerClosed && !this->hasError)
+    {
+        SizeT size = this->recvRing.Size();
+        if (size >= MaxRecvBufferSize)
+        {
+            this->readStalled = true;
+            break;
+        }
+        if (this->recvRing.capacity - size < MinReadSize)
+        {
+            this->recvRing.Reserve(Math::min(MaxRecvBufferSize - size, GrowSize));
+        }
+
+        iovec regions[2];
+        int numRegions = this->recvRing.GetFreeRegions(regions);
+        size_t requested = 0;
+        for (int i = 0; i < numRegions; i++)
+        {
+            requested += regions[i].iov_len;
+        }
+
+        ssize_t res = readv(this->fd, regions, numRegions);
+        if (res > 0)
+        {
+            this->recvRing.writePos += res;
+            notify = true;
+
+            // a short read means the socket is empty, new data will trigger a new edge
+            if ((size_t)res < requested)
+            {
+                break;
+            }
+        }
+        else if (res == 0)
+        {
+            this->peerClosed = true;
+            notify = true;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        else
+        {
+            this->hasError = true;
+            notify = true;
+        }
+    }
+    this->critSect.Leave();
+    return notify;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Called by the I/O thread on EPOLLOUT.
+*/
+void
+EpollTcpClientConnection::OnWritable()
+{
+    this->critSect.Enter();
+    if (this->socket.isvalid() && !this->hasError && this->sendRing.Size() > 0)
+    {
+        this->FlushSendQueue(nullptr, 0);
+    }
+    this->critSect.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Sends the queued bytes and the given memory with one scatter/gather
+    call per round until everything is out or the socket would block. The
+    critical section must be held.
+*/
+SizeT
+EpollTcpClientConnection::FlushSendQueue(const ubyte* data, SizeT numBytes)
+{
+    SizeT dataSent = 0;
+    while (!this->hasError)
+    {
+        iovec regions[3];
+        int numRegions = this->sendRing.GetFilledRegions(regions);
+        if (dataSent < numBytes)
+        {
+            regions[numRegions].iov_base = (void*)(data + dataSent);
+            regions[numRegions].iov_len = numBytes - dataSent;
+            numRegions++;
+        }
+        if (numRegions == 0)
+        {
+            break;
+        }
+
+        msghdr msg = {};
+        msg.msg_iov = regions;
+        msg.msg_iovlen = numRegions;
+        ssize_t res = sendmsg(this->fd, &msg, MSG_NOSIGNAL);
+        if (res < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            else if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                this->hasError = true;
+            }
+            break;
+        }
+
+        SizeT fromQueue = Math::min((SizeT)res, this->sendRing.Size());
+        this->sendRing.readPos += fromQueue;
+        dataSent += (SizeT)res - fromQueue;
+    }
+    if (this->sendRing.Size() == 0)
+    {
+        this->sendRing.readPos = this->sendRing.writePos = 0;
+    }
+    return dataSent;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+EpollTcpClientConnection::RingBuffer::Size() const
+{
+    return (SizeT)(this->writePos - this->readPos);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Grows to the next power of two which fits the buffered and the new
+    bytes, the buffered bytes are moved to the start of the new buffer.
+*/
+void
+EpollTcpClientConnection::RingBuffer::Reserve(SizeT numBytes)
+{
+    SizeT size = this->Size();
+    if (this->capacity - size >= numBytes)
+    {
+        return;
+    }
+
+    SizeT newCapacity = Math::max(this->capacity, (SizeT)4096);
+    while (newCapacity - size < numBytes)
+    {
+        newCapacity *= 2;
+    }
+
+    ubyte* newBuffer = (ubyte*)Memory::Alloc(Memory::NetworkHeap, newCapacity);
+    if (size > 0)
+    {
+        iovec regions[2];
+        int numRegions = this->GetFilledRegions(regions);
+        ubyte* dst = newBuffer;
+        for (int i = 0; i < numRegions; i++)
+        {
+            Memory::Copy(regions[i].iov_base, dst, regions[i].iov_len);
+            dst += regions[i].iov_len;
+        }
+    }
+    if (nullptr != this->buffer)
+    {
+        Memory::Free(Memory::NetworkHeap, this->buffer);
+    }
+    this->buffer = newBuffer;
+    this->capacity = newCapacity;
+    this->readPos = 0;
+    this->writePos = size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpClientConnection::RingBuffer::Write(const void* data, SizeT numBytes)
+{
+    this->Reserve(numBytes);
+    iovec regions[2];
+    int numRegions = this->GetFreeRegions(regions);
+    const ubyte* src = (const ubyte*)data;
+    SizeT remaining = numBytes;
+    for (int i = 0; i < numRegions && remaining > 0; i++)
+    {
+        SizeT chunk = Math::min((SizeT)regions[i].iov_len, remaining);
+        Memory::Copy(src, regions[i].iov_base, chunk);
+        src += chunk;
+        remaining -= chunk;
+    }
+    this->writePos += numBytes;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+EpollTcpClientConnection::RingBuffer::GetFilledRegions(iovec* outRegions) const
+{
+    SizeT size = this->Size();
+    if (size == 0)
+    {
+        return 0;
+    }
+    SizeT start = (SizeT)(this->readPos & (this->capacity - 1));
+    SizeT first = Math::min(size, this->capacity - start);
+    outRegions[0].iov_base = this->buffer + start;
+    outRegions[0].iov_len = first;
+    if (first == size)
+    {
+        return 1;
+    }
+    outRegions[1].iov_base = this->buffer;
+    outRegions[1].iov_len = size - first;
+    return 2;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+EpollTcpClientConnection::RingBuffer::GetFreeRegions(iovec* outRegions) const
+{
+    SizeT free = this->capacity - this->Size();
+    if (free == 0)
+    {
+        return 0;
+    }
+    SizeT start = (SizeT)(this->writePos & (this->capacity - 1));
+    SizeT first = Math::min(free, this->capacity - start);
+    outRegions[0].iov_base = this->buffer + start;
+    outRegions[0].iov_len = first;
+    if (first == free)
+    {
+        return 1;
+    }
+    outRegions[1].iov_base = this->buffer;
+    outRegions[1].iov_len = free - first;
+    return 2;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpClientConnection::RingBuffer::Discard()
+{
+    if (nullptr != this->buffer)
+    {
+        Memory::Free(Memory::NetworkHeap, this->buffer);
+    }
+    this->buffer = nullptr;
+    this->capacity = 0;
+    this->readPos = this->writePos = 0;
+}
+
+} // namespace Net
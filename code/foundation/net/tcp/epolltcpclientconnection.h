@@ -0,0 +1,108 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Net::EpollTcpClientConnection
+
+    Server side connection of an EpollTcpServer. The socket is non-blocking
+    and registered edge-triggered with one of the I/O threads of the server.
+    The I/O thread drains the socket into a receive ring buffer whenever it
+    becomes readable and flushes the send ring buffer whenever it becomes
+    writable, so the main thread never touches the socket for reading.
+
+    Recv() moves everything received since the last call into the recv
+    stream. Send() writes the stream straight from its memory with a
+    scatter/gather send behind data which is still queued, only the part the
+    kernel does not take right away is copied into the send ring buffer.
+
+    Outside an EpollTcpServer (e.g. after a plain Connect()) the connection
+    behaves exactly like a StdTcpClientConnection.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "net/tcp/stdtcpclientconnection.h"
+#include "threading/criticalsection.h"
+
+struct iovec;
+
+//------------------------------------------------------------------------------
+namespace Net
+{
+class EpollTcpServer;
+
+class EpollTcpClientConnection : public StdTcpClientConnection
+{
+    __DeclareClass(EpollTcpClientConnection);
+public:
+    /// constructor
+    EpollTcpClientConnection();
+    /// destructor
+    virtual ~EpollTcpClientConnection();
+    /// get the connection status
+    virtual bool IsConnected() const;
+    /// shutdown the connection
+    virtual void Shutdown();
+    /// directly send a stream to the client, only the part which doesn't fit into the socket is copied
+    virtual Socket::Result Send(const Ptr<IO::Stream>& stream);
+    /// move data received by the I/O thread into the recv stream
+    virtual Socket::Result Recv();
+
+    /// bytes waiting in the send ring buffer
+    SizeT GetNumQueuedSendBytes() const;
+
+    /// maximum number of bytes buffered on the receive side before reading stalls
+    static const SizeT MaxRecvBufferSize = 4 * 1024 * 1024;
+    /// maximum number of bytes queued on the send side before Send() fails
+    static const SizeT MaxSendBufferSize = 16 * 1024 * 1024;
+
+private:
+    friend class EpollTcpServer;
+
+    /// byte ring buffer with a power of two capacity
+    struct RingBuffer
+    {
+        ubyte* buffer = nullptr;
+        SizeT capacity = 0;
+        uint64_t readPos = 0;
+        uint64_t writePos = 0;
+
+        /// number of bytes in the buffer
+        SizeT Size() const;
+        /// make room for at least the given number of bytes
+        void Reserve(SizeT numBytes);
+        /// append bytes
+        void Write(const void* data, SizeT numBytes);
+        /// get up to two regions holding the buffered bytes, returns number of regions
+        int GetFilledRegions(iovec* outRegions) const;
+        /// get up to two free regions, returns number of regions
+        int GetFreeRegions(iovec* outRegions) const;
+        /// free memory
+        void Discard();
+    };
+
+    /// register with an I/O thread of the server, called by the accepting thread
+    void Attach(EpollTcpServer* server, IndexT ioThread);
+    /// read until the socket would block, called by the I/O thread, returns true if the main thread should poll the connection
+    bool OnReadable();
+    /// flush the send ring buffer, called by the I/O thread
+    void OnWritable();
+    /// send queued data followed by the given memory, returns the number of bytes taken from data
+    SizeT FlushSendQueue(const ubyte* data, SizeT numBytes);
+
+    EpollTcpServer* server;
+    IndexT ioThread;
+    int fd;
+    mutable Threading::CriticalSection critSect;
+    RingBuffer recvRing;
+    RingBuffer sendRing;
+    bool peerClosed;
+    bool hasError;
+    bool readStalled;
+    /// true while in the ready list of the server, guarded by the server
+    bool isReady;
+    /// number of the last server poll which received on this connection, main thread only
+    uint64_t lastPoll;
+};
+
+} // namespace Net
+//------------------------------------------------------------------------------
@@ -0,0 +1,503 @@
+//------------------------------------------------------------------------------
+//  epolltcpserver.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+
+#include "net/tcp/epolltcpserver.h"
+#include "system/systeminfo.h"
+#include "math/scalar.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace Net
+{
+__ImplementClass(Net::EpollTcpServer, 'ETSV', Core::RefCounted);
+__ImplementClass(Net::EpollTcpServer::IoThread, 'etio', Threading::Thread);
+
+using namespace Util;
+using namespace Threading;
+using namespace IO;
+
+//------------------------------------------------------------------------------
+/**
+*/
+EpollTcpServer::EpollTcpServer() :
+    isOpen(false),
+    numIoThreads(Math::clamp(System::NumCpuCores / 4, 1, 4)),
+    nextIoThread(0),
+    pollCount(0)
+{
+    this->connectionClassRtti = &TcpClientConnection::RTTI;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+EpollTcpServer::~EpollTcpServer()
+{
+    n_assert(!this->IsOpen());
+}
+
+//------------------------------------------------------------------------------
+/**
+    Binds the listen socket right away, unlike StdTcpServer a port which is
+    already in use makes Open() fail.
+*/
+bool
+EpollTcpServer::Open()
+{
+    n_assert(!this->isOpen);
+    n_assert(this->ioThreads.IsEmpty());
+    n_assert(this->clientConnections.IsEmpty());
+    n_assert(this->connectionClassRtti->IsDerivedFrom(EpollTcpClientConnection::RTTI));
+
+    this->listenSocket = Socket::Create();
+    if (!this->listenSocket->Open(Socket::TCP))
+    {
+        this->listenSocket = nullptr;
+        return false;
+    }
+    this->listenSocket->SetAddress(this->ipAddress);
+    this->listenSocket->SetReUseAddr(true);
+    if (!this->listenSocket->Bind() || !this->listenSocket->Listen())
+    {
+        n_warning("EpollTcpServer::Open(): failed to listen on port %d!\n", this->ipAddress.GetPort());
+        this->listenSocket->Close();
+        this->listenSocket = nullptr;
+        return false;
+    }
+    this->listenSocket->SetBlocking(false);
+
+    // the first thread also accepts new connections
+    IndexT i;
+    for (i = 0; i < this->numIoThreads; i++)
+    {
+        Ptr<IoThread> thread = IoThread::Create();
+        thread->SetName("EpollTcpServer::IoThread");
+        if (!thread->Setup(this, i == 0 ? this->listenSocket : Ptr<Socket>()))
+        {
+            n_warning("EpollTcpServer::Open(): failed to create epoll set!\n");
+            thread->Discard();
+            break;
+        }
+        this->ioThreads.Append(thread);
+    }
+    if (this->ioThreads.Size() < this->numIoThreads)
+    {
+        for (i = 0; i < this->ioThreads.Size(); i++)
+        {
+            this->ioThreads[i]->Discard();
+        }
+        this->ioThreads.Clear();
+        this->listenSocket->Close();
+        this->listenSocket = nullptr;
+        return false;
+    }
+
+    for (i = 0; i < this->ioThreads.Size(); i++)
+    {
+        this->ioThreads[i]->Start();
+    }
+    this->nextIoThread = 0;
+    this->isOpen = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpServer::Close()
+{
+    n_assert(this->isOpen);
+
+    // stop the I/O threads first, nothing touches the connections after that
+    IndexT i;
+    for (i = 0; i < this->ioThreads.Size(); i++)
+    {
+        this->ioThreads[i]->Stop();
+    }
+
+    // disconnect client connections
+    this->connectionCritSect.Enter();
+    Array<Ptr<TcpClientConnection> > connections = std::move(this->clientConnections);
+    this->connectionCritSect.Leave();
+    for (i = 0; i < connections.Size(); i++)
+    {
+        connections[i]->Shutdown();
+    }
+    connections.Clear();
+
+    for (i = 0; i < this->ioThreads.Size(); i++)
+    {
+        this->ioThreads[i]->Discard();
+    }
+    this->ioThreads.Clear();
+    this->listenSocket->Close();
+    this->listenSocket = nullptr;
+
+    this->readyCritSect.Enter();
+    this->readyConnections.Clear();
+    this->readyCritSect.Leave();
+    this->pendingConnections.Clear();
+
+    this->isOpen = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpServer::AddClientConnection(const Ptr<TcpClientConnection>& conn)
+{
+    n_assert(conn.isvalid());
+    IndexT threadIndex = this->nextIoThread;
+    this->nextIoThread = (this->nextIoThread + 1) % this->ioThreads.Size();
+
+    conn->Attach(this, threadIndex);
+    this->connectionCritSect.Enter();
+    this->clientConnections.Append(conn);
+    this->connectionCritSect.Leave();
+
+    // registering reports data which arrived before already
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = static_cast<EpollTcpClientConnection*>(conn.get());
+    if (epoll_ctl(this->ioThreads[threadIndex]->epollFd, EPOLL_CTL_ADD, conn->fd, &event) != 0)
+    {
+        n_printf("EpollTcpServer: epoll_ctl(EPOLL_CTL_ADD) failed with '%s'!\n", strerror(errno));
+        conn->critSect.Enter();
+        conn->hasError = true;
+        conn->critSect.Leave();
+        this->SetConnectionReady(conn);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpServer::SetConnectionReady(EpollTcpClientConnection* conn)
+{
+    this->readyCritSect.Enter();
+    if (!conn->isReady)
+    {
+        conn->isReady = true;
+        this->readyConnections.Append(static_cast<TcpClientConnection*>(conn));
+    }
+    this->readyCritSect.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Modifying the registration makes epoll check the socket again, so the
+    stalled data triggers a new edge.
+*/
+void
+EpollTcpServer::RearmConnection(EpollTcpClientConnection* conn)
+{
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = conn;
+    epoll_ctl(this->ioThreads[conn->ioThread]->epollFd, EPOLL_CTL_MOD, conn->fd, &event);
+}
+
+//------------------------------------------------------------------------------
+/**
+    The I/O thread may still hold the connection from its current batch of
+    events, so the connection is kept alive by the thread until its next
+    epoll_wait().
+*/
+void
+EpollTcpServer::UnregisterConnection(EpollTcpClientConnection* conn)
+{
+    const Ptr<IoThread>& thread = this->ioThreads[conn->ioThread];
+    epoll_ctl(thread->epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    thread->Retire(static_cast<TcpClientConnection*>(conn));
+    this->SetConnectionReady(conn);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Array<Ptr<TcpClientConnection> >
+EpollTcpServer::Recv()
+{
+    Array<Ptr<TcpClientConnection> > clientsWithData;
+    this->Recv(clientsWithData);
+    return clientsWithData;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Only looks at connections the I/O threads have marked as ready and the
+    ones which had data in the last call, a connection which decodes
+    messages may have more of them queued.
+*/
+void
+EpollTcpServer::Recv(Array<Ptr<TcpClientConnection> >& clientsWithData)
+{
+    clientsWithData.Clear();
+    this->pollCount++;
+
+    this->readyCritSect.Enter();
+    IndexT i;
+    for (i = 0; i < this->readyConnections.Size(); i++)
+    {
+        this->readyConnections[i]->isReady = false;
+    }
+    this->pollConnections.AppendArray(this->readyConnections);
+    this->readyConnections.Clear();
+    this->readyCritSect.Leave();
+    this->pollConnections.AppendArray(this->pendingConnections);
+    this->pendingConnections.Clear();
+
+    for (i = 0; i < this->pollConnections.Size(); i++)
+    {
+        const Ptr<TcpClientConnection>& cur = this->pollConnections[i];
+        if (cur->lastPoll == this->pollCount)
+        {
+            continue;
+        }
+        cur->lastPoll = this->pollCount;
+
+        bool dropClient = false;
+        if (cur->IsConnected())
+        {
+            Socket::Result res = cur->Recv();
+            if (res == Socket::Success)
+            {
+                clientsWithData.Append(cur);
+                this->pendingConnections.Append(cur);
+            }
+            else if ((res == Socket::Error) || (res == Socket::Closed))
+            {
+                // some error occured, drop the connection
+                dropClient = true;
+            }
+        }
+        else
+        {
+            dropClient = true;
+        }
+        if (dropClient)
+        {
+            // connection has been closed, remove the client
+            cur->Shutdown();
+            this->connectionCritSect.Enter();
+            IndexT index = this->clientConnections.FindIndex(cur);
+            if (index != InvalidIndex)
+            {
+                this->clientConnections.EraseIndexSwap(index);
+            }
+            this->connectionCritSect.Leave();
+        }
+    }
+    this->pollConnections.Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+EpollTcpServer::Broadcast(const Ptr<Stream>& msg)
+{
+    bool result = true;
+    this->connectionCritSect.Enter();
+    IndexT i;
+    for (i = 0; i < this->clientConnections.Size(); i++)
+    {
+        if (Socket::Success != this->clientConnections[i]->Send(msg))
+        {
+            result = false;
+        }
+    }
+    this->connectionCritSect.Leave();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+EpollTcpServer::GetNumClientConnections() const
+{
+    this->connectionCritSect.Enter();
+    SizeT num = this->clientConnections.Size();
+    this->connectionCritSect.Leave();
+    return num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+EpollTcpServer::IoThread::IoThread() :
+    epollFd(-1),
+    tcpServer(nullptr),
+    wakeupFd(-1)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+EpollTcpServer::IoThread::Setup(EpollTcpServer* server, const Ptr<Socket>& socket)
+{
+    n_assert(nullptr != server);
+    this->tcpServer = server;
+    this->listenSocket = socket;
+    this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    this->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (this->epollFd < 0 || this->wakeupFd < 0)
+    {
+        return false;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = &this->wakeupFd;
+    if (epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->wakeupFd, &event) != 0)
+    {
+        return false;
+    }
+    if (this->listenSocket.isvalid())
+    {
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = this->listenSocket.get();
+        if (epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->listenSocket->GetSocketHandle(), &event) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpServer::IoThread::Discard()
+{
+    n_assert(!this->IsRunning());
+    if (this->epollFd >= 0)
+    {
+        close(this->epollFd);
+        this->epollFd = -1;
+    }
+    if (this->wakeupFd >= 0)
+    {
+        close(this->wakeupFd);
+        this->wakeupFd = -1;
+    }
+    this->listenSocket = nullptr;
+    this->retired.Clear();
+    this->tcpServer = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpServer::IoThread::Retire(const Ptr<TcpClientConnection>& conn)
+{
+    this->retiredCritSect.Enter();
+    this->retired.Append(conn);
+    this->retiredCritSect.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpServer::IoThread::DoWork()
+{
+    const int MaxEvents = 256;
+    epoll_event events[MaxEvents];
+    while (!this->ThreadStopRequested())
+    {
+        // connections retired before this point can't be in the next batch of events
+        this->retiredCritSect.Enter();
+        this->retired.Clear();
+        this->retiredCritSect.Leave();
+
+        int numEvents = epoll_wait(this->epollFd, events, MaxEvents, -1);
+        if (numEvents < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            n_warning("EpollTcpServer::IoThread: epoll_wait() failed with '%s'!\n", strerror(errno));
+            break;
+        }
+
+        int i;
+        for (i = 0; i < numEvents; i++)
+        {
+            void* ptr = events[i].data.ptr;
+            if (ptr == &this->wakeupFd)
+            {
+                uint64_t value;
+                while (read(this->wakeupFd, &value, sizeof(value)) > 0);
+            }
+            else if (this->listenSocket.isvalid() && ptr == this->listenSocket.get())
+            {
+                this->AcceptConnections();
+            }
+            else
+            {
+                EpollTcpClientConnection* conn = (EpollTcpClientConnection*)ptr;
+                uint32_t flags = events[i].events;
+                if (flags & EPOLLOUT)
+                {
+                    conn->OnWritable();
+                }
+                if ((flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && conn->OnReadable())
+                {
+                    this->tcpServer->SetConnectionReady(conn);
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    The listen socket is edge-triggered too, so accept until nothing is
+    pending anymore.
+*/
+void
+EpollTcpServer::IoThread::AcceptConnections()
+{
+    Ptr<Socket> newSocket;
+    while (this->listenSocket->Accept(newSocket))
+    {
+        // create a new connection object and add to connection array
+        Ptr<TcpClientConnection> newConnection = (TcpClientConnection*)this->tcpServer->connectionClassRtti->Create();
+        if (newConnection->Connect(newSocket))
+        {
+            this->tcpServer->AddClientConnection(newConnection);
+        }
+        else
+        {
+            newSocket->Close();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EpollTcpServer::IoThread::EmitWakeupSignal()
+{
+    uint64_t value = 1;
+    ssize_t res = write(this->wakeupFd, &value, sizeof(value));
+    (void)res;
+}
+
+} // namespace Net
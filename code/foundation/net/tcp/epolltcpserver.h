@@ -0,0 +1,194 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Net::EpollTcpServer
+
+    Event driven TcpServer for Linux. Has the same interface as StdTcpServer
+    but instead of one blocking listener thread and a select() per
+    connection and frame, a small fixed pool of I/O threads waits on
+    edge-triggered epoll sets. The first I/O thread also accepts new
+    connections, which are distributed round robin over the pool.
+
+    The I/O threads read incoming data into the ring buffer of the
+    connection and put the connection into a ready list. Recv() only visits
+    connections from that list (and those which returned data last time, so
+    message based connections can drain their queues), so an idle
+    connection costs nothing per frame.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "core/refcounted.h"
+#include "threading/thread.h"
+#include "threading/criticalsection.h"
+#include "util/array.h"
+#include "net/tcpclientconnection.h"
+#include "net/socket/socket.h"
+
+//------------------------------------------------------------------------------
+namespace Net
+{
+class EpollTcpServer : public Core::RefCounted
+{
+    __DeclareClass(EpollTcpServer);
+public:
+    /// constructor
+    EpollTcpServer();
+    /// destructor
+    virtual ~EpollTcpServer();
+    /// set address, hostname can be "any", "self" or "inetself"
+    void SetAddress(const IpAddress& addr);
+    /// get address
+    const IpAddress& GetAddress() const;
+    /// set client connection class
+    void SetClientConnectionClass(const Core::Rtti& type);
+    /// get client connection class
+    const Core::Rtti& GetClientConnectionClass();
+    /// set number of I/O threads, must be called before Open()
+    void SetNumIoThreads(SizeT num);
+    /// get number of I/O threads
+    SizeT GetNumIoThreads() const;
+    /// open the server
+    bool Open();
+    /// close the server
+    void Close();
+    /// return true if server is open
+    bool IsOpen() const;
+    /// poll clients connections for received data, call this frequently!
+    Util::Array<Ptr<TcpClientConnection> > Recv();
+    /// poll clients connections for received data into an existing array
+    void Recv(Util::Array<Ptr<TcpClientConnection> >& outClientsWithData);
+    /// broadcast a message to all clients
+    bool Broadcast(const Ptr<IO::Stream>& msg);
+    /// get number of open client connections
+    SizeT GetNumClientConnections() const;
+
+    /// upper limit for SetNumIoThreads()
+    static const SizeT MaxIoThreads = 16;
+
+private:
+    /// an I/O thread waiting on its own epoll set
+    class IoThread : public Threading::Thread
+    {
+        __DeclareClass(IoThread);
+    public:
+        /// constructor
+        IoThread();
+        /// setup epoll set and wakeup event
+        bool Setup(EpollTcpServer* tcpServer, const Ptr<Socket>& listenSocket);
+        /// close epoll set and wakeup event, thread must be stopped
+        void Discard();
+        /// keep a connection alive until the thread can't reference it anymore
+        void Retire(const Ptr<TcpClientConnection>& connection);
+
+        int epollFd;
+    private:
+        /// implements the event loop
+        virtual void DoWork();
+        /// send a wakeup signal
+        virtual void EmitWakeupSignal();
+        /// accept all pending connections
+        void AcceptConnections();
+
+        EpollTcpServer* tcpServer;
+        Ptr<Socket> listenSocket;
+        int wakeupFd;
+        Threading::CriticalSection retiredCritSect;
+        Util::Array<Ptr<TcpClientConnection> > retired;
+    };
+    friend class IoThread;
+    friend class EpollTcpClientConnection;
+
+    /// add a client connection and register it with an I/O thread (called by the accepting thread)
+    void AddClientConnection(const Ptr<TcpClientConnection>& connection);
+    /// put a connection into the ready list (called by I/O threads and on shutdown)
+    void SetConnectionReady(EpollTcpClientConnection* connection);
+    /// re-enable events of a connection after its receive buffer was drained
+    void RearmConnection(EpollTcpClientConnection* connection);
+    /// remove a connection from its epoll set, called on shutdown
+    void UnregisterConnection(EpollTcpClientConnection* connection);
+
+    IpAddress ipAddress;
+    bool isOpen;
+    SizeT numIoThreads;
+    IndexT nextIoThread;
+    Ptr<Socket> listenSocket;
+    Util::Array<Ptr<IoThread> > ioThreads;
+    Util::Array<Ptr<TcpClientConnection> > clientConnections;
+    mutable Threading::CriticalSection connectionCritSect;
+    Util::Array<Ptr<TcpClientConnection> > readyConnections;
+    Threading::CriticalSection readyCritSect;
+    /// connections polled by the last Recv() plus the ready list, main thread only
+    Util::Array<Ptr<TcpClientConnection> > pollConnections;
+    Util::Array<Ptr<TcpClientConnection> > pendingConnections;
+    uint64_t pollCount;
+    const Core::Rtti* connectionClassRtti;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+EpollTcpServer::IsOpen() const
+{
+    return this->isOpen;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+EpollTcpServer::SetAddress(const IpAddress& addr)
+{
+    this->ipAddress = addr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const IpAddress&
+EpollTcpServer::GetAddress() const
+{
+    return this->ipAddress;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+EpollTcpServer::SetClientConnectionClass(const Core::Rtti& type)
+{
+    this->connectionClassRtti = &type;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const Core::Rtti&
+EpollTcpServer::GetClientConnectionClass()
+{
+    return *this->connectionClassRtti;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+EpollTcpServer::SetNumIoThreads(SizeT num)
+{
+    n_assert(!this->isOpen);
+    n_assert(num > 0 && num <= MaxIoThreads);
+    this->numIoThreads = num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+EpollTcpServer::GetNumIoThreads() const
+{
+    return this->numIoThreads;
+}
+
+} // namespace Net
+//------------------------------------------------------------------------------
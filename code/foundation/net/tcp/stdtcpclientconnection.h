@@ -41,7 +41,7 @@ public:
     /// connect using provided socket
     virtual bool Connect(const Ptr<Socket>& s);
     /// get the connection status
-    bool IsConnected() const;
+    virtual bool IsConnected() const;
     /// shutdown the connection
     virtual void Shutdown();
     /// get the client's ip address
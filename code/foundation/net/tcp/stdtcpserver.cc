@@ -163,6 +163,18 @@ StdTcpServer::Broadcast(const Ptr<Stream>& msg)
     return result;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+StdTcpServer::GetNumClientConnections() const
+{
+    this->connectionCritSect.Enter();
+    SizeT num = this->clientConnections.Size();
+    this->connectionCritSect.Leave();
+    return num;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
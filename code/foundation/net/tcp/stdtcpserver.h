@@ -49,6 +49,8 @@ public:
     Util::Array<Ptr<TcpClientConnection> > Recv();
     /// broadcast a message to all clients
     bool Broadcast(const Ptr<IO::Stream>& msg);
+    /// get number of open client connections
+    SizeT GetNumClientConnections() const;
 
 private:
     /// a private listener thread class
@@ -81,7 +83,7 @@ private:
     Ptr<ListenerThread> listenerThread;
     bool isOpen;
     Util::Array<Ptr<TcpClientConnection> > clientConnections;
-    Threading::CriticalSection connectionCritSect;
+    mutable Threading::CriticalSection connectionCritSect;
     const Core::Rtti* connectionClassRtti;
 };
 
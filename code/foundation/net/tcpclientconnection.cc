@@ -8,7 +8,9 @@
 
 namespace Net
 {
-#if (__WIN32__ || __linux__)
+#if __linux__
+__ImplementClass(Net::TcpClientConnection, 'TPCC', Net::EpollTcpClientConnection);
+#elif __WIN32__
 __ImplementClass(Net::TcpClientConnection, 'TPCC', Net::StdTcpClientConnection);
 #else
 #error "Net::TcpClientConnection not implemented on this platform!"
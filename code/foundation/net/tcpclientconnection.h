@@ -3,14 +3,24 @@
 /**
     @class Net::TcpClientConnection
 
-    See StdTcpClientConnection for details!
+    See StdTcpClientConnection for details! On Linux connections derive
+    from EpollTcpClientConnection, which is what EpollTcpServer expects.
 
     @copyright
     (C) 2009 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
 #include "core/config.h"
-#if (__WIN32__ || __OSX__ || __APPLE__ || __linux__)
+#if __linux__
+#include "net/tcp/epolltcpclientconnection.h"
+namespace Net
+{
+class TcpClientConnection : public EpollTcpClientConnection
+{
+    __DeclareClass(TcpClientConnection);
+};
+}
+#elif (__WIN32__ || __OSX__ || __APPLE__)
 #include "net/tcp/stdtcpclientconnection.h"
 namespace Net
 {
@@ -8,7 +8,9 @@
 
 namespace Net
 {
-#if (__WIN32__ || __linux__)
+#if __linux__
+__ImplementClass(Net::TcpServer, 'TCPS', Net::EpollTcpServer);
+#elif __WIN32__
 __ImplementClass(Net::TcpServer, 'TCPS', Net::StdTcpServer);
 #else
 #error "Net::TcpServer not implemented on this platform!"
@@ -4,13 +4,23 @@
     @class Net::TcpServer
 
     Front-end wrapper class for StdTcpServer, see StdTcpServer for details!
+    On Linux the epoll based EpollTcpServer is used instead.
 
     @copyright
     (C) 2009 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
 #include "core/config.h"
-#if (__WIN32__ || __OSX__ || __APPLE__ || __linux__)
+#if __linux__
+#include "net/tcp/epolltcpserver.h"
+namespace Net
+{
+class TcpServer : public EpollTcpServer
+{
+    __DeclareClass(TcpServer);
+};
+}
+#elif (__WIN32__ || __OSX__ || __APPLE__)
 #include "net/tcp/stdtcpserver.h"
 namespace Net
 {
@@ -4,6 +4,7 @@
 //------------------------------------------------------------------------------
 
 #include "profiling/profiling.h"
+#include "profiling/trace.h"
 
 namespace Profiling
 {
@@ -16,13 +17,27 @@ Threading::CriticalSection categoryLock;
 Threading::AtomicCounter ProfilingContextCounter = 0;
 thread_local IndexT ProfilingContextIndex = InvalidIndex;
 
+// one bit per nesting level, set if the begin of the scope went to the trace
+thread_local uint64_t ProfilingTracedScopes = 0;
+thread_local uint ProfilingScopeDepth = 0;
+
 //------------------------------------------------------------------------------
 /**
+    Scopes on threads which aren't registered with ProfilingRegisterThread()
+    only go to a running trace capture.
 */
 void 
 ProfilingPushScope(const ProfilingScope& scope)
 {   
-    n_assert(ProfilingContextIndex != InvalidIndex);
+    if (ProfilingTraceIsCapturing() && ProfilingScopeDepth < 64)
+    {
+        if (ProfilingTraceBegin(scope.name, scope.category.Value()))
+            ProfilingTracedScopes |= 1ull << ProfilingScopeDepth;
+    }
+    ProfilingScopeDepth++;
+
+    if (ProfilingContextIndex == InvalidIndex)
+        return;
     contextMutexes[ProfilingContextIndex]->Enter();
 
     // get thread context
@@ -38,7 +53,16 @@ ProfilingPushScope(const ProfilingScope& scope)
 void
 ProfilingPopScope()
 {
-    n_assert(ProfilingContextIndex != InvalidIndex);
+    n_assert(ProfilingScopeDepth > 0);
+    ProfilingScopeDepth--;
+    if (ProfilingScopeDepth < 64 && (ProfilingTracedScopes & (1ull << ProfilingScopeDepth)))
+    {
+        ProfilingTracedScopes &= ~(1ull << ProfilingScopeDepth);
+        ProfilingTraceEnd();
+    }
+
+    if (ProfilingContextIndex == InvalidIndex)
+        return;
 
     // get thread context
     ProfilingContext& ctx = profilingContexts[ProfilingContextIndex];
@@ -84,6 +108,8 @@ ProfilingPopScope()
 void
 ProfilingNewFrame()
 {
+    ProfilingTraceFrame();
+
     // get thread context
     //ProfilingContext& ctx = profilingContexts[ProfilingContextIndex];
     //n_assert(ctx.threadName == "MainThread");
@@ -163,21 +189,68 @@ Threading::CriticalSection counterLock;
 Util::Dictionary<const char*, uint64_t> counters;
 Util::Dictionary<const char*, Util::Pair<uint64_t, uint64_t>> budgetCounters;
 
+/// counter deltas of one thread, only the owning thread adds counters
+struct ProfilingThreadCounters
+{
+    static const SizeT MaxCounters = 256;
+    const char* names[MaxCounters];
+    std::atomic<int64_t> deltas[MaxCounters];
+    std::atomic<SizeT> numCounters{ 0 };
+    Util::Dictionary<const char*, IndexT> slots;
+    ProfilingThreadCounters* next = nullptr;
+};
+std::atomic<ProfilingThreadCounters*> threadCounters{ nullptr };
+thread_local ProfilingThreadCounters* ProfilingLocalCounters = nullptr;
+
 //------------------------------------------------------------------------------
 /**
+    Counters are accumulated per thread like the trace events, so hitting a
+    counter never takes a lock. The blocks are kept until the process exits
+    and merged into the counter table by ProfilingGetCounters().
 */
-void 
-ProfilingIncreaseCounter(const char* id, uint64_t value)
+static void
+ProfilingAddCounterDelta(const char* id, int64_t delta)
 {
-    counterLock.Enter();
-    IndexT idx = counters.FindIndex(id);
-    if (idx == InvalidIndex)
-        counters.Add(id, value);
+    ProfilingThreadCounters* local = ProfilingLocalCounters;
+    if (local == nullptr)
+    {
+        local = new ProfilingThreadCounters;
+        local->next = threadCounters.load(std::memory_order_relaxed);
+        while (!threadCounters.compare_exchange_weak(local->next, local, std::memory_order_release, std::memory_order_relaxed));
+        ProfilingLocalCounters = local;
+    }
+
+    IndexT slot;
+    IndexT i = local->slots.FindIndex(id);
+    if (i != InvalidIndex)
+        slot = local->slots.ValueAtIndex(i);
     else
     {
-        counters.ValueAtIndex(idx) += value;
+        slot = local->numCounters.load(std::memory_order_relaxed);
+        if (slot == ProfilingThreadCounters::MaxCounters)
+        {
+            // out of slots, go to the table directly
+            counterLock.Enter();
+            counters.Emplace(id) += (uint64_t)delta;
+            counterLock.Leave();
+            return;
+        }
+        local->names[slot] = id;
+        local->deltas[slot].store(0, std::memory_order_relaxed);
+        local->slots.Add(id, slot);
+        local->numCounters.store(slot + 1, std::memory_order_release);
     }
-    counterLock.Leave();
+    local->deltas[slot].fetch_add(delta, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void 
+ProfilingIncreaseCounter(const char* id, uint64_t value)
+{
+    ProfilingTraceCounter(id, (int64_t)value);
+    ProfilingAddCounterDelta(id, (int64_t)value);
 }
 
 //------------------------------------------------------------------------------
@@ -186,19 +259,28 @@ ProfilingIncreaseCounter(const char* id, uint64_t value)
 void 
 ProfilingDecreaseCounter(const char* id, uint64_t value)
 {
-    counterLock.Enter();
-    IndexT idx = counters.FindIndex(id);
-    n_assert(idx != InvalidIndex);
-    counters.ValueAtIndex(idx) -= value;
-    counterLock.Leave();
+    ProfilingTraceCounter(id, -(int64_t)value);
+    ProfilingAddCounterDelta(id, -(int64_t)value);
 }
 
 //------------------------------------------------------------------------------
 /**
+    Collects the deltas all threads have accumulated since the last call.
 */
 const Util::Dictionary<const char*, uint64_t>&
 ProfilingGetCounters()
 {
+    counterLock.Enter();
+    for (ProfilingThreadCounters* block = threadCounters.load(std::memory_order_acquire); block != nullptr; block = block->next)
+    {
+        SizeT numCounters = block->numCounters.load(std::memory_order_acquire);
+        for (IndexT i = 0; i < numCounters; i++)
+        {
+            int64_t delta = block->deltas[i].exchange(0, std::memory_order_relaxed);
+            counters.Emplace(block->names[i]) += (uint64_t)delta;
+        }
+    }
+    counterLock.Leave();
     return counters;
 }
 
@@ -90,7 +90,7 @@ extern Threading::AtomicCounter ProfilingContextCounter;
 void ProfilingIncreaseCounter(const char* id, uint64_t value);
 /// decrement profiling counter
 void ProfilingDecreaseCounter(const char* id, uint64_t value);
-/// return table of counters
+/// merge the counter deltas of all threads and return table of counters
 const Util::Dictionary<const char*, uint64_t>& ProfilingGetCounters();
 
 /// Setup a profiling budget counter
@@ -0,0 +1,707 @@
+//------------------------------------------------------------------------------
+//  trace.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "profiling/trace.h"
+#include "threading/thread.h"
+#include "threading/event.h"
+#include "threading/criticalsection.h"
+#include "timing/timer.h"
+#include "io/fswrapper.h"
+#include "io/assignregistry.h"
+#include "util/flathashtable.h"
+#include <algorithm>
+#if __WIN32__
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace Profiling
+{
+
+std::atomic<bool> TraceCapturing{ false };
+
+//------------------------------------------------------------------------------
+/**
+    Binary file layout: a TraceFileHeader followed by chunks, each starting
+    with a TraceChunkHeader. Pointers in events are ids of string chunks.
+*/
+enum TraceEventType : uint32_t
+{
+    TraceEventBegin,
+    TraceEventEnd,
+    TraceEventCounter,
+    TraceEventFrame
+};
+
+enum TraceChunkType : uint32_t
+{
+    TraceChunkString = 1,       // uint64_t id, characters
+    TraceChunkThread,           // TraceThreadInfo, characters of the name
+    TraceChunkEvents,           // TraceEventsInfo, TraceEvent[numEvents]
+    TraceChunkCalibration       // TraceCalibration
+};
+
+static const uint32_t TraceMagic = 'NTRC';
+static const uint32_t TraceVersion = 1;
+
+struct TraceFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+};
+
+struct TraceChunkHeader
+{
+    uint32_t type;
+    uint32_t size;
+};
+
+struct TraceEvent
+{
+    uint64_t ticks;
+    /// name of scope or counter
+    uint64_t name;
+    /// category of a begin event, delta of a counter event
+    int64_t value;
+    uint32_t type;
+    uint32_t pad;
+};
+
+struct TraceThreadInfo
+{
+    uint32_t threadIndex;
+    uint32_t pad;
+    uint64_t threadId;
+};
+
+struct TraceEventsInfo
+{
+    uint32_t threadIndex;
+    uint32_t numEvents;
+    uint64_t numDropped;
+};
+
+struct TraceCalibration
+{
+    uint64_t ticks;
+    double seconds;
+};
+
+/// single producer, single consumer ring of events owned by one thread
+struct TraceThreadBuffer
+{
+    TraceEvent* events;
+    uint64_t mask;
+    uint32_t threadIndex;
+    Threading::ThreadId threadId;
+    Util::String threadName;
+
+    /// written by the owning thread
+    alignas(64) std::atomic<uint64_t> writePos;
+    std::atomic<uint64_t> numDropped;
+    /// number of begin events without end, their end events always fit
+    uint64_t openScopes;
+
+    /// written by the flusher
+    alignas(64) std::atomic<uint64_t> readPos;
+    uint64_t droppedReported;
+};
+
+class TraceFlushThread : public Threading::Thread
+{
+    __DeclareClass(TraceFlushThread);
+public:
+    /// drain ring buffers until stopped
+    void DoWork() override;
+    /// wake up to stop
+    void EmitWakeupSignal() override;
+
+    int flushIntervalMs = 10;
+    Threading::Event wakeupEvent;
+};
+__ImplementClass(Profiling::TraceFlushThread, 'TRFT', Threading::Thread);
+
+struct TraceContext
+{
+    Threading::CriticalSection registryLock;
+    Util::Array<TraceThreadBuffer*> buffers;
+    SizeT threadBufferEvents = 0;
+
+    // only touched by the flusher, or by start/stop while it isn't running
+    IO::FSWrapper::Handle file = 0;
+    Util::Array<TraceThreadBuffer*> flushBuffers;
+    SizeT numAnnouncedThreads = 0;
+    Util::FlatHashTable<uint64_t, bool> knownStrings;
+    Timing::Timer timer;
+    TraceStats stats = {};
+    Ptr<TraceFlushThread> flushThread;
+} traceContext;
+
+thread_local TraceThreadBuffer* LocalTraceBuffer = nullptr;
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+TraceTicks()
+{
+#if __WIN32__ || defined(__x86_64__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static TraceThreadBuffer*
+TraceCreateThreadBuffer()
+{
+    TraceThreadBuffer* buf = new TraceThreadBuffer;
+    SizeT numEvents = 64;
+    while (numEvents * 2 <= traceContext.threadBufferEvents)
+        numEvents *= 2;
+    buf->events = (TraceEvent*)Memory::Alloc(Memory::DefaultHeap, numEvents * sizeof(TraceEvent));
+    buf->mask = numEvents - 1;
+    buf->threadId = Threading::Thread::GetMyThreadId();
+    const char* name = Threading::Thread::GetMyThreadName();
+    buf->threadName = name != nullptr ? name : "";
+    buf->writePos = 0;
+    buf->numDropped = 0;
+    buf->openScopes = 0;
+    buf->readPos = 0;
+    buf->droppedReported = 0;
+
+    traceContext.registryLock.Enter();
+    buf->threadIndex = traceContext.buffers.Size();
+    traceContext.buffers.Append(buf);
+    traceContext.registryLock.Leave();
+
+    LocalTraceBuffer = buf;
+    return buf;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Room for the end events of all open scopes is kept free, so a begin
+    that made it into the buffer is always closed.
+*/
+static bool
+TraceWriteEvent(TraceEventType type, const char* name, int64_t value, uint64_t reserve)
+{
+    TraceThreadBuffer* buf = LocalTraceBuffer;
+    if (buf == nullptr)
+        buf = TraceCreateThreadBuffer();
+
+    const uint64_t write = buf->writePos.load(std::memory_order_relaxed);
+    const uint64_t read = buf->readPos.load(std::memory_order_acquire);
+    if (write - read + buf->openScopes + reserve > buf->mask + 1)
+    {
+        buf->numDropped.store(buf->numDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    TraceEvent& event = buf->events[write & buf->mask];
+    event.ticks = TraceTicks();
+    event.name = (uint64_t)(uintptr_t)name;
+    event.value = value;
+    event.type = type;
+    buf->writePos.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ProfilingTraceBegin(const char* name, const char* category)
+{
+    if (!ProfilingTraceIsCapturing())
+        return false;
+    if (!TraceWriteEvent(TraceEventBegin, name, (int64_t)(uintptr_t)category, 2))
+        return false;
+    LocalTraceBuffer->openScopes++;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Must only be called when ProfilingTraceBegin() returned true, even if the
+    capture stopped in between.
+*/
+void
+ProfilingTraceEnd()
+{
+    TraceThreadBuffer* buf = LocalTraceBuffer;
+    n_assert(buf != nullptr && buf->openScopes > 0);
+    buf->openScopes--;
+    TraceWriteEvent(TraceEventEnd, nullptr, 0, 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProfilingTraceCounter(const char* name, int64_t delta)
+{
+    if (ProfilingTraceIsCapturing())
+        TraceWriteEvent(TraceEventCounter, name, delta, 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProfilingTraceFrame()
+{
+    if (ProfilingTraceIsCapturing())
+        TraceWriteEvent(TraceEventFrame, nullptr, 0, 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+TraceWriteChunk(TraceChunkType type, const void* header, SizeT headerSize, const void* payload, SizeT payloadSize)
+{
+    TraceChunkHeader chunk;
+    chunk.type = type;
+    chunk.size = uint32_t(headerSize + payloadSize);
+    IO::FSWrapper::Write(traceContext.file, &chunk, sizeof(chunk));
+    IO::FSWrapper::Write(traceContext.file, header, headerSize);
+    if (payloadSize > 0)
+        IO::FSWrapper::Write(traceContext.file, payload, payloadSize);
+    traceContext.stats.bytesWritten += sizeof(chunk) + chunk.size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+TraceWriteCalibration()
+{
+    TraceCalibration calibration;
+    calibration.ticks = TraceTicks();
+    calibration.seconds = traceContext.timer.GetTime();
+    TraceWriteChunk(TraceChunkCalibration, &calibration, sizeof(calibration), nullptr, 0);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+TraceWriteString(uint64_t id)
+{
+    if (id == 0 || traceContext.knownStrings.Contains(id))
+        return;
+    traceContext.knownStrings.Add(id, true);
+    const char* str = (const char*)(uintptr_t)id;
+    TraceWriteChunk(TraceChunkString, &id, sizeof(id), str, (SizeT)strlen(str));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+TraceWriteEvents(TraceThreadBuffer* buf, const TraceEvent* events, SizeT numEvents)
+{
+    for (IndexT i = 0; i < numEvents; i++)
+    {
+        TraceWriteString(events[i].name);
+        if (events[i].type == TraceEventBegin)
+            TraceWriteString((uint64_t)events[i].value);
+    }
+
+    const uint64_t dropped = buf->numDropped.load(std::memory_order_relaxed);
+    TraceEventsInfo info;
+    info.threadIndex = buf->threadIndex;
+    info.numEvents = numEvents;
+    info.numDropped = dropped - buf->droppedReported;
+    buf->droppedReported = dropped;
+    TraceWriteChunk(TraceChunkEvents, &info, sizeof(info), events, numEvents * sizeof(TraceEvent));
+    traceContext.stats.numEvents += numEvents;
+    traceContext.stats.numDropped += info.numDropped;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Drain all thread buffers into the file. Only ever runs on one thread.
+*/
+static void
+TraceFlush()
+{
+    traceContext.registryLock.Enter();
+    traceContext.flushBuffers = traceContext.buffers;
+    traceContext.registryLock.Leave();
+
+    // announce threads which emitted their first events since the last flush
+    for (IndexT i = traceContext.numAnnouncedThreads; i < traceContext.flushBuffers.Size(); i++)
+    {
+        TraceThreadBuffer* buf = traceContext.flushBuffers[i];
+        TraceThreadInfo info;
+        info.threadIndex = buf->threadIndex;
+        info.pad = 0;
+        info.threadId = (uint64_t)buf->threadId;
+        TraceWriteChunk(TraceChunkThread, &info, sizeof(info), buf->threadName.AsCharPtr(), buf->threadName.Length());
+    }
+    traceContext.numAnnouncedThreads = traceContext.flushBuffers.Size();
+
+    for (TraceThreadBuffer* buf : traceContext.flushBuffers)
+    {
+        const uint64_t read = buf->readPos.load(std::memory_order_relaxed);
+        const uint64_t write = buf->writePos.load(std::memory_order_acquire);
+        if (read == write)
+            continue;
+
+        // the ring may wrap, write the two halves as separate chunks
+        const uint64_t first = read & buf->mask;
+        const uint64_t count = write - read;
+        const uint64_t untilEnd = count < buf->mask + 1 - first ? count : buf->mask + 1 - first;
+        TraceWriteEvents(buf, buf->events + first, (SizeT)untilEnd);
+        if (count > untilEnd)
+            TraceWriteEvents(buf, buf->events, (SizeT)(count - untilEnd));
+        buf->readPos.store(write, std::memory_order_release);
+    }
+
+    TraceWriteCalibration();
+    IO::FSWrapper::Flush(traceContext.file);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TraceFlushThread::DoWork()
+{
+    while (!this->ThreadStopRequested())
+    {
+        this->wakeupEvent.WaitTimeout(this->flushIntervalMs);
+        TraceFlush();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TraceFlushThread::EmitWakeupSignal()
+{
+    this->wakeupEvent.Signal();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static Util::String
+TraceResolvePath(const Util::String& path)
+{
+    if (IO::AssignRegistry::HasInstance())
+        return IO::AssignRegistry::Instance()->ResolveAssignsInString(path);
+    return path;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ProfilingTraceStart(const TraceCaptureInfo& info)
+{
+    n_assert(info.path.IsValid());
+    n_assert(info.flushIntervalMs > 0);
+    if (ProfilingTraceIsCapturing())
+    {
+        n_warning("ProfilingTraceStart: a capture is already running\n");
+        return false;
+    }
+
+    Util::String path = TraceResolvePath(info.path);
+    traceContext.file = IO::FSWrapper::OpenFile(path, IO::Stream::WriteAccess, IO::Stream::Sequential);
+    if (traceContext.file == 0)
+    {
+        n_warning("ProfilingTraceStart: failed to open '%s'\n", path.AsCharPtr());
+        return false;
+    }
+
+    traceContext.stats = {};
+    TraceFileHeader header;
+    header.magic = TraceMagic;
+    header.version = TraceVersion;
+    IO::FSWrapper::Write(traceContext.file, &header, sizeof(header));
+    traceContext.stats.bytesWritten = sizeof(header);
+
+    // events left over from a previous capture are skipped
+    traceContext.registryLock.Enter();
+    traceContext.threadBufferEvents = info.threadBufferSize / sizeof(TraceEvent);
+    for (TraceThreadBuffer* buf : traceContext.buffers)
+    {
+        buf->readPos.store(buf->writePos.load(std::memory_order_acquire), std::memory_order_release);
+        buf->droppedReported = buf->numDropped.load(std::memory_order_relaxed);
+    }
+    traceContext.registryLock.Leave();
+    traceContext.numAnnouncedThreads = 0;
+    traceContext.knownStrings.Clear();
+
+    traceContext.timer.Reset();
+    traceContext.timer.Start();
+    TraceWriteCalibration();
+
+    traceContext.flushThread = TraceFlushThread::Create();
+    traceContext.flushThread->flushIntervalMs = info.flushIntervalMs;
+    traceContext.flushThread->SetName("TraceFlushThread");
+    traceContext.flushThread->Start();
+
+    TraceCapturing.store(true, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProfilingTraceStop()
+{
+    if (!ProfilingTraceIsCapturing())
+        return;
+    TraceCapturing.store(false, std::memory_order_release);
+
+    traceContext.flushThread->Stop();
+    traceContext.flushThread = nullptr;
+
+    // pick up what was written since the last flush
+    TraceFlush();
+    IO::FSWrapper::CloseFile(traceContext.file);
+    traceContext.file = 0;
+    traceContext.timer.Stop();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+TraceStats
+ProfilingTraceGetStats()
+{
+    return traceContext.stats;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static Util::String
+TraceJsonEscape(const Util::String& str)
+{
+    Util::String ret;
+    for (IndexT i = 0; i < str.Length(); i++)
+    {
+        char c = str[i];
+        if (c == '"' || c == '\\')
+        {
+            ret.AppendChar('\\');
+            ret.AppendChar(c);
+        }
+        else if ((unsigned char)c < 0x20)
+            ret.Append(Util::String::Sprintf("\\u%04x", c));
+        else
+            ret.AppendChar(c);
+    }
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Events of each thread become B/E/i events with the thread index as tid,
+    counter deltas of all threads are merged by time into C events.
+*/
+bool
+ProfilingTraceConvertToJson(const Util::String& traceFile, const Util::String& jsonFile)
+{
+    Util::String tracePath = TraceResolvePath(traceFile);
+    Util::String jsonPath = TraceResolvePath(jsonFile);
+    IO::FSWrapper::Handle in = IO::FSWrapper::OpenFile(tracePath, IO::Stream::ReadAccess, IO::Stream::Sequential);
+    if (in == 0)
+    {
+        n_warning("ProfilingTraceConvertToJson: failed to open '%s'\n", tracePath.AsCharPtr());
+        return false;
+    }
+    SizeT fileSize = (SizeT)IO::FSWrapper::GetFileSize(in);
+    ubyte* data = (ubyte*)Memory::Alloc(Memory::ScratchHeap, Math::max(fileSize, 1));
+    SizeT bytesRead = (SizeT)IO::FSWrapper::Read(in, data, fileSize);
+    IO::FSWrapper::CloseFile(in);
+
+    const TraceFileHeader* header = (const TraceFileHeader*)data;
+    if (bytesRead < (SizeT)sizeof(TraceFileHeader) || header->magic != TraceMagic || header->version != TraceVersion)
+    {
+        n_warning("ProfilingTraceConvertToJson: '%s' is not a trace file\n", tracePath.AsCharPtr());
+        Memory::Free(Memory::ScratchHeap, data);
+        return false;
+    }
+
+    struct ThreadEvents
+    {
+        Util::String name;
+        Util::Array<TraceEvent> events;
+    };
+    Util::FlatHashTable<uint64_t, Util::String> strings;
+    Util::Array<ThreadEvents> threads;
+    Util::Array<TraceEvent> counters;
+    TraceCalibration firstCalibration = { 0, 0.0 }, lastCalibration = { 0, 0.0 };
+    bool hasCalibration = false;
+    uint64_t numDropped = 0;
+
+    // gather chunks, a truncated last chunk from a crashed process is ignored
+    SizeT offset = sizeof(TraceFileHeader);
+    while (offset + (SizeT)sizeof(TraceChunkHeader) <= bytesRead)
+    {
+        const TraceChunkHeader* chunk = (const TraceChunkHeader*)(data + offset);
+        const ubyte* payload = data + offset + sizeof(TraceChunkHeader);
+        if (offset + (SizeT)sizeof(TraceChunkHeader) + (SizeT)chunk->size > bytesRead)
+            break;
+        switch (chunk->type)
+        {
+            case TraceChunkString:
+            {
+                uint64_t id;
+                Memory::Copy(payload, &id, sizeof(id));
+                Util::String str;
+                str.Set((const char*)payload + sizeof(id), chunk->size - sizeof(id));
+                if (!strings.Contains(id))
+                    strings.Add(id, str);
+                break;
+            }
+            case TraceChunkThread:
+            {
+                TraceThreadInfo info;
+                Memory::Copy(payload, &info, sizeof(info));
+                if (threads.Size() <= (SizeT)info.threadIndex)
+                    threads.Resize(info.threadIndex + 1);
+                threads[info.threadIndex].name.Set((const char*)payload + sizeof(info), chunk->size - sizeof(info));
+                break;
+            }
+            case TraceChunkEvents:
+            {
+                TraceEventsInfo info;
+                Memory::Copy(payload, &info, sizeof(info));
+                if (threads.Size() <= (SizeT)info.threadIndex)
+                    threads.Resize(info.threadIndex + 1);
+                Util::Array<TraceEvent>& events = threads[info.threadIndex].events;
+                const TraceEvent* src = (const TraceEvent*)(payload + sizeof(info));
+                for (uint32_t i = 0; i < info.numEvents; i++)
+                {
+                    TraceEvent event;
+                    Memory::Copy(src + i, &event, sizeof(event));
+                    if (event.type == TraceEventCounter)
+                        counters.Append(event);
+                    else
+                        events.Append(event);
+                }
+                numDropped += info.numDropped;
+                break;
+            }
+            case TraceChunkCalibration:
+            {
+                Memory::Copy(payload, &lastCalibration, sizeof(lastCalibration));
+                if (!hasCalibration)
+                    firstCalibration = lastCalibration;
+                hasCalibration = true;
+                break;
+            }
+            default:
+                break;
+        }
+        offset += sizeof(TraceChunkHeader) + chunk->size;
+    }
+    Memory::Free(Memory::ScratchHeap, data);
+
+    // map ticks to microseconds since the start of the capture
+    double ticksPerSecond = 1e9;
+    if (lastCalibration.seconds > firstCalibration.seconds && lastCalibration.ticks > firstCalibration.ticks)
+        ticksPerSecond = double(lastCalibration.ticks - firstCalibration.ticks) / (lastCalibration.seconds - firstCalibration.seconds);
+    const uint64_t baseTicks = firstCalibration.ticks;
+    auto timestamp = [&](uint64_t ticks) -> double
+    {
+        return ((double)(int64_t)(ticks - baseTicks) / ticksPerSecond) * 1e6;
+    };
+    auto name = [&](uint64_t id) -> Util::String
+    {
+        IndexT i = strings.FindIndex(id);
+        return i != InvalidIndex ? TraceJsonEscape(strings.ValueAtIndex(id, i)) : Util::String("unknown");
+    };
+
+    IO::FSWrapper::Handle out = IO::FSWrapper::OpenFile(jsonPath, IO::Stream::WriteAccess, IO::Stream::Sequential);
+    if (out == 0)
+    {
+        n_warning("ProfilingTraceConvertToJson: failed to open '%s'\n", jsonPath.AsCharPtr());
+        return false;
+    }
+    Util::String json;
+    bool firstEvent = true;
+    auto emit = [&](const Util::String& event)
+    {
+        if (!firstEvent)
+            json.Append(",\n");
+        json.Append(event);
+        firstEvent = false;
+        if (json.Length() > 64 * 1024)
+        {
+            IO::FSWrapper::Write(out, json.AsCharPtr(), json.Length());
+            json.Clear();
+        }
+    };
+
+    json.Append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (IndexT t = 0; t < threads.Size(); t++)
+    {
+        emit(Util::String::Sprintf("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            t, TraceJsonEscape(threads[t].name).AsCharPtr()));
+
+        // ends whose begin happened before the capture started are skipped
+        int depth = 0;
+        for (const TraceEvent& event : threads[t].events)
+        {
+            switch (event.type)
+            {
+                case TraceEventBegin:
+                    emit(Util::String::Sprintf("{\"ph\":\"B\",\"name\":\"%s\",\"cat\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                        name(event.name).AsCharPtr(), name((uint64_t)event.value).AsCharPtr(), timestamp(event.ticks), t));
+                    depth++;
+                    break;
+                case TraceEventEnd:
+                    if (depth > 0)
+                    {
+                        emit(Util::String::Sprintf("{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}", timestamp(event.ticks), t));
+                        depth--;
+                    }
+                    break;
+                case TraceEventFrame:
+                    emit(Util::String::Sprintf("{\"ph\":\"i\",\"s\":\"g\",\"name\":\"Frame\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}", timestamp(event.ticks), t));
+                    break;
+            }
+        }
+    }
+
+    std::stable_sort(counters.Begin(), counters.End(), [](const TraceEvent& a, const TraceEvent& b) { return a.ticks < b.ticks; });
+    Util::FlatHashTable<uint64_t, int64_t> counterValues;
+    for (const TraceEvent& event : counters)
+    {
+        int64_t& value = counterValues.Emplace(event.name);
+        value += event.value;
+        emit(Util::String::Sprintf("{\"ph\":\"C\",\"name\":\"%s\",\"ts\":%.3f,\"pid\":1,\"args\":{\"value\":%lld}}",
+            name(event.name).AsCharPtr(), timestamp(event.ticks), (long long)value));
+    }
+    json.Append("\n]}\n");
+    IO::FSWrapper::Write(out, json.AsCharPtr(), json.Length());
+    IO::FSWrapper::CloseFile(out);
+
+    if (numDropped > 0)
+        n_warning("ProfilingTraceConvertToJson: %llu events were dropped during capture\n", (unsigned long long)numDropped);
+    return true;
+}
+
+} // namespace Profiling
@@ -0,0 +1,95 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file profiling/trace.h
+
+    Binary trace capture for the profiling markers.
+
+    While a capture is running, every N_SCOPE/N_MARKER begin and end, every
+    N_COUNTER_INCR/DECR and every frame start is written as a fixed size
+    event with a CPU timestamp into a ring buffer owned by the emitting
+    thread. Writing an event takes no lock and doesn't allocate. A background
+    thread drains the ring buffers every few milliseconds and appends them to
+    a binary trace file, together with the strings the events point to and
+    timestamp calibration records. If a thread produces events faster than
+    they are drained, new events are dropped and counted.
+
+    Names and categories are recorded by pointer and resolved by the flusher,
+    so like for the profiler UI they must outlive the capture.
+
+    Captures don't depend on the profiler UI or on threads being registered
+    with ProfilingRegisterThread(), so they work in headless processes.
+    Use ProfilingTraceConvertToJson() to turn a capture into Chrome trace
+    event JSON, which loads in chrome://tracing and ui.perfetto.dev.
+
+    Thread ring buffers are allocated the first time a thread emits an event
+    and kept until the process exits, threads which start later are picked
+    up automatically.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/types.h"
+#include "util/string.h"
+#include <atomic>
+
+namespace Profiling
+{
+
+struct TraceCaptureInfo
+{
+    /// path of the trace file, assigns are resolved
+    Util::String path;
+    /// ring buffer size per thread in bytes, used when a thread creates its buffer
+    SizeT threadBufferSize;
+    /// how often the ring buffers are drained
+    int flushIntervalMs;
+
+    TraceCaptureInfo()
+        : threadBufferSize(1_MB)
+        , flushIntervalMs(10)
+    {}
+};
+
+struct TraceStats
+{
+    /// events written to the file
+    uint64_t numEvents;
+    /// events lost because a ring buffer was full
+    uint64_t numDropped;
+    /// size of the trace file
+    uint64_t bytesWritten;
+};
+
+/// start capturing to a file, returns false if the file can't be opened or a capture is running
+bool ProfilingTraceStart(const TraceCaptureInfo& info);
+/// stop capturing, flushes all remaining events and closes the file
+void ProfilingTraceStop();
+/// get statistics of the running or last capture
+TraceStats ProfilingTraceGetStats();
+/// convert a binary trace to Chrome trace event JSON, assigns in both paths are resolved
+bool ProfilingTraceConvertToJson(const Util::String& tracePath, const Util::String& jsonPath);
+
+/// write a begin event, returns true if the matching end must be written
+bool ProfilingTraceBegin(const char* name, const char* category);
+/// write an end event
+void ProfilingTraceEnd();
+/// write a counter delta
+void ProfilingTraceCounter(const char* name, int64_t delta);
+/// write a frame marker
+void ProfilingTraceFrame();
+
+/// true while a capture is running
+extern std::atomic<bool> TraceCapturing;
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+ProfilingTraceIsCapturing()
+{
+    return TraceCapturing.load(std::memory_order_relaxed);
+}
+
+} // namespace Profiling
@@ -12,10 +12,6 @@
 #include <sys/prctl.h>
 #endif
 
-#if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-#include "util/localstringatomtable.h"
-#endif
-
 #if __ANDROID__
 #include "nvidia/nv_thread/nv_thread.h"
 #endif
@@ -176,21 +172,12 @@ LinuxThread::ThreadProc(void *self)
     n_assert(0 != self);
     n_dbgout("LinuxThread::ThreadProc(): thread started!\n");
 
-    #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-    // setup thread-local string atom table (will be discarded when thread terminates)
-    LocalStringAtomTable* localStringAtomTable = n_new(LocalStringAtomTable);
-    #endif
-
     LinuxThread* threadObj = static_cast<LinuxThread*>(self);
     LinuxThread::SetMyThreadName(threadObj->GetName());
     threadObj->threadState = Running;
     threadObj->threadStartedEvent.Signal();
     threadObj->DoWork();
     threadObj->threadState = Stopped;
-    // discard local string atom table
-    #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-    n_delete(localStringAtomTable);
-    #endif
     // tell memory system that a thread is ending
     // FIXME, currently not implemented or used
     // Memory::OnExitThread();
@@ -201,11 +201,6 @@ Win32Thread::ThreadProc(LPVOID self)
 {
     n_assert(0 != self);
     
-    #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-    // setup thread-local string atom table (will be discarded when thread terminates)
-    LocalStringAtomTable localStringAtomTable;
-    #endif
-
     Win32Thread* threadObj = (Win32Thread*) self;
     Win32Thread::SetMyThreadName(threadObj->GetName().AsCharPtr());
     threadObj->threadStartedEvent.Signal();
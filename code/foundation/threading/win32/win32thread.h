@@ -13,7 +13,6 @@
 #include "threading/win32/win32event.h"
 #include "threading/threadid.h"
 #include "system/cpu.h"
-#include "util/localstringatomtable.h"
 
 //------------------------------------------------------------------------------
 namespace Win32
@@ -0,0 +1,898 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Util::FlatHashTable
+
+    Open addressing hash table with the same interface as Util::HashTable.
+
+    Key/value pairs are stored in a single flat slot array next to an array of
+    one control byte per slot. A control byte is either empty, deleted, or
+    holds 7 bits of the key hash. Slots are grouped in runs of 16, and a
+    lookup compares the control bytes of a whole group against the hash with
+    one SIMD compare, so only slots with a matching hash fragment are ever
+    compared by key. Groups are probed quadratically until a group with an
+    empty slot is found.
+
+    Unlike HashTable, the table grows and rehashes itself when the load factor
+    exceeds 7/8, so it doesn't need a compile time table size and stays O(1)
+    with many thousands of keys.
+
+    Indices returned by Add(), FindIndex() etc. are slot indices, valid until
+    the next insertion. Adding elements invalidates iterators and references
+    into the table. Iteration order is unspecified.
+
+    The key class must implement operator== and either be integral, a pointer,
+    or provide a uint32_t HashCode() const method.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "core/types.h"
+#include "core/simd.h"
+#include "util/array.h"
+#include "util/keyvaluepair.h"
+#include "util/bit.h"
+#include <type_traits>
+
+//------------------------------------------------------------------------------
+namespace Util
+{
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE = 1> class FlatHashTable
+{
+public:
+    /// default constructor
+    FlatHashTable();
+    /// constructor with initial capacity
+    FlatHashTable(SizeT capacity);
+    /// copy constructor
+    FlatHashTable(const FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>& rhs);
+    /// move constructor
+    FlatHashTable(FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>&& rhs) noexcept;
+    /// destructor
+    ~FlatHashTable();
+    /// assignment operator
+    void operator=(const FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>& rhs);
+    /// move assignment operator
+    void operator=(FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>&& rhs) noexcept;
+    /// read/write [] operator, assertion if key not found
+    VALUETYPE& operator[](const KEYTYPE& key) const;
+    /// return current number of values in the hashtable
+    SizeT Size() const;
+    /// return number of slots in the hash table
+    SizeT Capacity() const;
+    /// make room for at least num elements without rehashing
+    void Reserve(SizeT num);
+    /// clear the hashtable
+    void Clear();
+    /// reset the hashtable to 0 size, but don't run destructor
+    void Reset();
+    /// return true if empty
+    bool IsEmpty() const;
+    /// begin bulk adding, only kept for interface compatibility with HashTable
+    void BeginBulkAdd();
+    /// returns true if currently bulk adding
+    const bool IsBulkAdd() const;
+    /// add a key/value pair object to the hash table, returns slot index where item is stored
+    IndexT Add(const KeyValuePair<KEYTYPE, VALUETYPE>& kvp);
+    /// add a key and associated value
+    IndexT Add(const KEYTYPE& key, const VALUETYPE& value);
+    /// adds element only if it doesn't exist, and return reference to it
+    VALUETYPE& Emplace(const KEYTYPE& key);
+    /// end bulk adding
+    void EndBulkAdd();
+    /// merge two tables
+    void Merge(const FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>& rhs);
+    /// erase an entry
+    void Erase(const KEYTYPE& key);
+    /// erase an entry with known index
+    void EraseIndex(const KEYTYPE& key, IndexT i);
+    /// return true if key exists in the table
+    bool Contains(const KEYTYPE& key) const;
+    /// find slot index of key, InvalidIndex if not found
+    IndexT FindIndex(const KEYTYPE& key) const;
+    /// get value from key and slot index
+    VALUETYPE& ValueAtIndex(const KEYTYPE& key, IndexT i) const;
+    /// return array of all key/value pairs in the table (slow)
+    StackArray<KeyValuePair<KEYTYPE, VALUETYPE>, STACK_SIZE> Content() const;
+    /// get all keys as an Util::Array (slow)
+    StackArray<KEYTYPE, STACK_SIZE> KeysAsArray() const;
+    /// get all values as an Util::Array (slow)
+    StackArray<VALUETYPE, STACK_SIZE> ValuesAsArray() const;
+
+    class Iterator
+    {
+    public:
+        /// progress to next item in the hash table
+        Iterator& operator++(int);
+        /// check if iterator is identical
+        const bool operator==(const Iterator& rhs) const;
+        /// check if iterator is identical
+        const bool operator!=(const Iterator& rhs) const;
+
+        /// the current value
+        VALUETYPE* val;
+        KEYTYPE const* key;
+    private:
+        friend class FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>;
+        /// point iterator at the first used slot at or after index
+        void Seek(IndexT index);
+
+        const FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>* table;
+        IndexT slot;
+    };
+
+    /// get iterator to first element
+    Iterator Begin();
+    /// get iterator past the last element
+    Iterator End();
+
+private:
+    /// number of slots probed together
+    static const SizeT GroupSize = 16;
+    /// control byte of an unused slot
+    static const ubyte Empty = 0x80;
+    /// control byte of an erased slot, probing continues past it
+    static const ubyte Deleted = 0xFE;
+
+    /// compute and mix hash of key
+    static uint32_t Hash(const KEYTYPE& key);
+    /// get mask of slots in group whose control byte equals value
+    uint32_t MatchGroup(IndexT group, ubyte value) const;
+    /// get mask of slots in group which are empty or deleted
+    uint32_t MatchFree(IndexT group) const;
+    /// find slot of key, or InvalidIndex
+    IndexT FindSlot(const KEYTYPE& key, uint32_t hash) const;
+    /// insert key/value pair into a free slot, table must have room
+    IndexT InsertSlot(uint32_t hash, const KeyValuePair<KEYTYPE, VALUETYPE>& kvp);
+    /// mark slot as free and destroy its contents
+    void FreeSlot(IndexT index);
+    /// rehash into a table with the given number of slots
+    void Rehash(SizeT newCapacity);
+    /// destroy all elements and release memory
+    void Release();
+    /// copy contents of other table, which must be empty
+    void Copy(const FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>& rhs);
+    /// number of elements a table with numSlots slots can hold
+    static SizeT MaxLoad(SizeT numSlots);
+
+    ubyte* ctrl;
+    KeyValuePair<KEYTYPE, VALUETYPE>* slots;
+    SizeT capacity;
+    SizeT size;
+    SizeT growthLeft;
+    bool inBulkAdd;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::FlatHashTable() :
+    ctrl(nullptr),
+    slots(nullptr),
+    capacity(0),
+    size(0),
+    growthLeft(0),
+    inBulkAdd(false)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::FlatHashTable(SizeT capacity) :
+    ctrl(nullptr),
+    slots(nullptr),
+    capacity(0),
+    size(0),
+    growthLeft(0),
+    inBulkAdd(false)
+{
+    this->Reserve(capacity);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::FlatHashTable(const FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>& rhs) :
+    ctrl(nullptr),
+    slots(nullptr),
+    capacity(0),
+    size(0),
+    growthLeft(0),
+    inBulkAdd(false)
+{
+    this->Copy(rhs);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::FlatHashTable(FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>&& rhs) noexcept :
+    ctrl(rhs.ctrl),
+    slots(rhs.slots),
+    capacity(rhs.capacity),
+    size(rhs.size),
+    growthLeft(rhs.growthLeft),
+    inBulkAdd(rhs.inBulkAdd)
+{
+    rhs.ctrl = nullptr;
+    rhs.slots = nullptr;
+    rhs.capacity = 0;
+    rhs.size = 0;
+    rhs.growthLeft = 0;
+    rhs.inBulkAdd = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::~FlatHashTable()
+{
+    this->Release();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::operator=(const FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>& rhs)
+{
+    if (this != &rhs)
+    {
+        this->Release();
+        this->Copy(rhs);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::operator=(FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        this->Release();
+        this->ctrl = rhs.ctrl;
+        this->slots = rhs.slots;
+        this->capacity = rhs.capacity;
+        this->size = rhs.size;
+        this->growthLeft = rhs.growthLeft;
+        this->inBulkAdd = rhs.inBulkAdd;
+        rhs.ctrl = nullptr;
+        rhs.slots = nullptr;
+        rhs.capacity = 0;
+        rhs.size = 0;
+        rhs.growthLeft = 0;
+        rhs.inBulkAdd = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline VALUETYPE&
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::operator[](const KEYTYPE& key) const
+{
+    IndexT index = this->FindSlot(key, Hash(key));
+    #if NEBULA_BOUNDSCHECKS
+    n_assert(InvalidIndex != index); // element with key doesn't exist
+    #endif
+    return this->slots[index].Value();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline SizeT
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Size() const
+{
+    return this->size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline SizeT
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Capacity() const
+{
+    return this->capacity;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Reserve(SizeT num)
+{
+    if (num > MaxLoad(this->capacity))
+    {
+        SizeT newCapacity = GroupSize;
+        while (MaxLoad(newCapacity) < num)
+            newCapacity *= 2;
+        this->Rehash(newCapacity);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Clear()
+{
+    if constexpr (!std::is_trivially_destructible<KeyValuePair<KEYTYPE, VALUETYPE>>::value)
+    {
+        for (IndexT i = 0; i < this->capacity; i++)
+        {
+            if (this->ctrl[i] < Empty)
+                this->slots[i].~KeyValuePair<KEYTYPE, VALUETYPE>();
+        }
+    }
+    this->Reset();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Reset()
+{
+    if (this->capacity > 0)
+        Memory::Fill(this->ctrl, this->capacity, Empty);
+    this->size = 0;
+    this->growthLeft = MaxLoad(this->capacity);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline bool
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::IsEmpty() const
+{
+    return (0 == this->size);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::BeginBulkAdd()
+{
+    n_assert(!this->inBulkAdd);
+    this->inBulkAdd = true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline const bool
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::IsBulkAdd() const
+{
+    return this->inBulkAdd;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::EndBulkAdd()
+{
+    n_assert(this->inBulkAdd);
+    this->inBulkAdd = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline IndexT
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Add(const KeyValuePair<KEYTYPE, VALUETYPE>& kvp)
+{
+    uint32_t hash = Hash(kvp.Key());
+#if NEBULA_BOUNDSCHECKS
+    n_assert(InvalidIndex == this->FindSlot(kvp.Key(), hash));
+#endif
+    if (this->growthLeft == 0)
+    {
+        // if more than half of the load is tombstones, rehashing at the same size is enough
+        if (this->capacity > 0 && this->size <= MaxLoad(this->capacity) / 2)
+            this->Rehash(this->capacity);
+        else
+            this->Rehash(this->capacity == 0 ? GroupSize : this->capacity * 2);
+    }
+    return this->InsertSlot(hash, kvp);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline IndexT
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Add(const KEYTYPE& key, const VALUETYPE& value)
+{
+    KeyValuePair<KEYTYPE, VALUETYPE> kvp(key, value);
+    return this->Add(kvp);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline VALUETYPE&
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Emplace(const KEYTYPE& key)
+{
+    IndexT index = this->FindSlot(key, Hash(key));
+    if (index == InvalidIndex)
+        index = this->Add(key, VALUETYPE());
+    return this->slots[index].Value();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Merge(const FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>& rhs)
+{
+    this->Reserve(this->size + rhs.size);
+    for (IndexT i = 0; i < rhs.capacity; i++)
+    {
+        if (rhs.ctrl[i] < Empty)
+            this->Add(rhs.slots[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Erase(const KEYTYPE& key)
+{
+    IndexT index = this->FindSlot(key, Hash(key));
+    #if NEBULA_BOUNDSCHECKS
+    n_assert(InvalidIndex != index); // key doesn't exist
+    #endif
+    this->FreeSlot(index);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::EraseIndex(const KEYTYPE& key, IndexT i)
+{
+    #if NEBULA_BOUNDSCHECKS
+    n_assert(i >= 0 && i < this->capacity && this->ctrl[i] < Empty);
+    n_assert(this->slots[i].Key() == key);
+    #endif
+    this->FreeSlot(i);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline bool
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Contains(const KEYTYPE& key) const
+{
+    return InvalidIndex != this->FindSlot(key, Hash(key));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline IndexT
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::FindIndex(const KEYTYPE& key) const
+{
+    return this->FindSlot(key, Hash(key));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline VALUETYPE&
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::ValueAtIndex(const KEYTYPE& key, IndexT i) const
+{
+    #if NEBULA_BOUNDSCHECKS
+    n_assert(i >= 0 && i < this->capacity && this->ctrl[i] < Empty);
+    #endif
+    return this->slots[i].Value();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+StackArray<KeyValuePair<KEYTYPE, VALUETYPE>, STACK_SIZE>
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Content() const
+{
+    StackArray<KeyValuePair<KEYTYPE, VALUETYPE>, STACK_SIZE> result;
+    result.Reserve(this->size);
+    for (IndexT i = 0; i < this->capacity; i++)
+    {
+        if (this->ctrl[i] < Empty)
+            result.Append(this->slots[i]);
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+StackArray<KEYTYPE, STACK_SIZE>
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::KeysAsArray() const
+{
+    StackArray<KEYTYPE, STACK_SIZE> keys;
+    keys.Reserve(this->size);
+    for (IndexT i = 0; i < this->capacity; i++)
+    {
+        if (this->ctrl[i] < Empty)
+            keys.Append(this->slots[i].Key());
+    }
+    return keys;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+StackArray<VALUETYPE, STACK_SIZE>
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::ValuesAsArray() const
+{
+    StackArray<VALUETYPE, STACK_SIZE> vals;
+    vals.Reserve(this->size);
+    for (IndexT i = 0; i < this->capacity; i++)
+    {
+        if (this->ctrl[i] < Empty)
+            vals.Append(this->slots[i].Value());
+    }
+    return vals;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline typename FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Iterator
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Begin()
+{
+    Iterator ret;
+    ret.table = this;
+    ret.Seek(0);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline typename FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Iterator
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::End()
+{
+    Iterator ret;
+    ret.table = this;
+    ret.Seek(this->capacity);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Integer keys are used as their own hash code by HashTable, which is fine
+    for a modulo but leaves the low bits poorly distributed for probing, so
+    all hash codes are run through a finalizer.
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline uint32_t
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Hash(const KEYTYPE& key)
+{
+    uint32_t h;
+    if constexpr (std::is_integral<KEYTYPE>::value || std::is_enum<KEYTYPE>::value)
+    {
+        uint64_t v = (uint64_t)key;
+        h = uint32_t(v ^ (v >> 32));
+    }
+    else if constexpr (std::is_pointer<KEYTYPE>::value)
+    {
+        uint64_t v = (uint64_t)(uintptr_t)key;
+        h = uint32_t(v ^ (v >> 32));
+    }
+    else
+    {
+        h = key.HashCode();
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline uint32_t
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::MatchGroup(IndexT group, ubyte value) const
+{
+    const ubyte* bytes = this->ctrl + group * GroupSize;
+#if NEBULA_SIMD_X64 || NEBULA_SIMD_AARCH64
+    return movemask_u8x16(compare_equal_u8x16(load_u8x16(bytes), splat_u8x16(value)));
+#else
+    uint32_t mask = 0;
+    for (IndexT i = 0; i < GroupSize; i++)
+        mask |= uint32_t(bytes[i] == value) << i;
+    return mask;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+    Both Empty and Deleted have the top bit set, full slots don't.
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline uint32_t
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::MatchFree(IndexT group) const
+{
+    const ubyte* bytes = this->ctrl + group * GroupSize;
+#if NEBULA_SIMD_X64 || NEBULA_SIMD_AARCH64
+    return movemask_u8x16(load_u8x16(bytes));
+#else
+    uint32_t mask = 0;
+    for (IndexT i = 0; i < GroupSize; i++)
+        mask |= uint32_t(bytes[i] >> 7) << i;
+    return mask;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline IndexT
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::FindSlot(const KEYTYPE& key, uint32_t hash) const
+{
+    if (this->size == 0)
+        return InvalidIndex;
+
+    const ubyte fragment = ubyte(hash & 0x7F);
+    const SizeT groupMask = this->capacity / GroupSize - 1;
+    IndexT group = (hash >> 7) & groupMask;
+    for (SizeT probe = 1; probe <= groupMask + 1; probe++)
+    {
+        uint32_t match = this->MatchGroup(group, fragment);
+        while (match != 0)
+        {
+            IndexT index = group * GroupSize + FirstBitSetIndex(match);
+            if (this->slots[index].Key() == key)
+                return index;
+            match &= match - 1;
+        }
+
+        // an empty slot ends the probe sequence
+        if (this->MatchGroup(group, Empty) != 0)
+            return InvalidIndex;
+        group = (group + probe) & groupMask;
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline IndexT
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::InsertSlot(uint32_t hash, const KeyValuePair<KEYTYPE, VALUETYPE>& kvp)
+{
+    const SizeT groupMask = this->capacity / GroupSize - 1;
+    IndexT group = (hash >> 7) & groupMask;
+    SizeT probe = 1;
+    uint32_t match = this->MatchFree(group);
+    while (match == 0)
+    {
+        group = (group + probe++) & groupMask;
+        match = this->MatchFree(group);
+    }
+
+    IndexT index = group * GroupSize + FirstBitSetIndex(match);
+    if (this->ctrl[index] == Empty)
+        this->growthLeft--;
+    this->ctrl[index] = ubyte(hash & 0x7F);
+    ::new(&this->slots[index]) KeyValuePair<KEYTYPE, VALUETYPE>(kvp);
+    this->size++;
+    return index;
+}
+
+//------------------------------------------------------------------------------
+/**
+    If the group still has an empty slot no probe sequence continues past it,
+    so the slot can become empty again, otherwise it has to be a tombstone.
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::FreeSlot(IndexT index)
+{
+    this->slots[index].~KeyValuePair<KEYTYPE, VALUETYPE>();
+    if (this->MatchGroup(index / GroupSize, Empty) != 0)
+    {
+        this->ctrl[index] = Empty;
+        this->growthLeft++;
+    }
+    else
+    {
+        this->ctrl[index] = Deleted;
+    }
+    this->size--;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Rehash(SizeT newCapacity)
+{
+    n_assert(newCapacity >= GroupSize && (newCapacity & (newCapacity - 1)) == 0);
+    ubyte* oldCtrl = this->ctrl;
+    KeyValuePair<KEYTYPE, VALUETYPE>* oldSlots = this->slots;
+    SizeT oldCapacity = this->capacity;
+
+    this->ctrl = (ubyte*)Memory::Alloc(Memory::ObjectArrayHeap, newCapacity);
+    this->slots = (KeyValuePair<KEYTYPE, VALUETYPE>*)Memory::Alloc(Memory::ObjectArrayHeap, newCapacity * sizeof(KeyValuePair<KEYTYPE, VALUETYPE>), alignof(KeyValuePair<KEYTYPE, VALUETYPE>) > 16 ? alignof(KeyValuePair<KEYTYPE, VALUETYPE>) : 16);
+    this->capacity = newCapacity;
+    this->Reset();
+
+    for (IndexT i = 0; i < oldCapacity; i++)
+    {
+        if (oldCtrl[i] < Empty)
+        {
+            this->InsertSlot(Hash(oldSlots[i].Key()), oldSlots[i]);
+            oldSlots[i].~KeyValuePair<KEYTYPE, VALUETYPE>();
+        }
+    }
+    if (oldCapacity > 0)
+    {
+        Memory::Free(Memory::ObjectArrayHeap, oldCtrl);
+        Memory::Free(Memory::ObjectArrayHeap, oldSlots);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Release()
+{
+    if (this->capacity > 0)
+    {
+        this->Clear();
+        Memory::Free(Memory::ObjectArrayHeap, this->ctrl);
+        Memory::Free(Memory::ObjectArrayHeap, this->slots);
+    }
+    this->ctrl = nullptr;
+    this->slots = nullptr;
+    this->capacity = 0;
+    this->size = 0;
+    this->growthLeft = 0;
+    this->inBulkAdd = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Copy(const FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>& rhs)
+{
+    n_assert(this->capacity == 0);
+    if (rhs.capacity > 0)
+    {
+        this->Rehash(rhs.capacity);
+        Memory::Copy(rhs.ctrl, this->ctrl, rhs.capacity);
+        for (IndexT i = 0; i < rhs.capacity; i++)
+        {
+            if (rhs.ctrl[i] < Empty)
+                ::new(&this->slots[i]) KeyValuePair<KEYTYPE, VALUETYPE>(rhs.slots[i]);
+        }
+        this->size = rhs.size;
+        this->growthLeft = rhs.growthLeft;
+    }
+    this->inBulkAdd = rhs.inBulkAdd;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Keep 1/8 of the slots free so probe sequences stay short.
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline SizeT
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::MaxLoad(SizeT numSlots)
+{
+    return numSlots - numSlots / 8;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Iterator::Seek(IndexT index)
+{
+    while (index < this->table->capacity && this->table->ctrl[index] >= Empty)
+        index++;
+    this->slot = index;
+    if (index < this->table->capacity)
+    {
+        this->val = &this->table->slots[index].Value();
+        this->key = &this->table->slots[index].Key();
+    }
+    else
+    {
+        this->val = nullptr;
+        this->key = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline typename FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Iterator&
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Iterator::operator++(int)
+{
+    if (this->slot < this->table->capacity)
+        this->Seek(this->slot + 1);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline const bool
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Iterator::operator==(const Iterator& rhs) const
+{
+    return (this->table == rhs.table) && (this->slot == rhs.slot);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, int STACK_SIZE>
+inline const bool
+FlatHashTable<KEYTYPE, VALUETYPE, STACK_SIZE>::Iterator::operator!=(const Iterator& rhs) const
+{
+    return !(*this == rhs);
+}
+
+} // namespace Util
+//------------------------------------------------------------------------------
@@ -5,6 +5,10 @@
 //------------------------------------------------------------------------------
 
 #include "util/globalstringatomtable.h"
+#include "util/stringatom.h"
+#include "threading/interlocked.h"
+
+#include <string.h>
 
 namespace Util
 {
@@ -16,9 +20,11 @@ __ImplementInterfaceSingleton(Util::GlobalStringAtomTable);
 GlobalStringAtomTable::GlobalStringAtomTable()
 {
     __ConstructInterfaceSingleton;
-    
-    // setup the global string buffer
-    this->stringBuffer.Setup(NEBULA_GLOBAL_STRINGBUFFER_CHUNKSIZE);
+    for (IndexT i = 0; i < NumShards; i++)
+    {
+        this->shards[i].table = nullptr;
+        this->shards[i].size = 0;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -26,44 +32,153 @@ GlobalStringAtomTable::GlobalStringAtomTable()
 */
 GlobalStringAtomTable::~GlobalStringAtomTable()
 {
-    this->critSect.Enter();
-    this->stringBuffer.Discard();
+    for (IndexT i = 0; i < NumShards; i++)
+    {
+        Shard& shard = this->shards[i];
+        shard.lock.Enter();
+        for (Table* table : shard.retiredTables)
+            Memory::Free(Memory::StringDataHeap, table);
+        if (shard.table != nullptr)
+            Memory::Free(Memory::StringDataHeap, shard.table);
+        shard.table = nullptr;
+        if (shard.stringBuffer.IsValid())
+            shard.stringBuffer.Discard();
+        shard.lock.Leave();
+    }
     __DestructInterfaceSingleton;
-    this->critSect.Leave();
 }
 
 //------------------------------------------------------------------------------
 /**
+    Top bits pick the shard, the low bits are used for the probe position.
 */
-void
-GlobalStringAtomTable::Lock()
+inline IndexT
+GlobalStringAtomTable::ShardIndex(uint32_t hash)
 {
-    this->critSect.Enter();
+    return hash >> (32 - NumShardBits);
+}
+
+//------------------------------------------------------------------------------
+/**
+    The string pointer of an entry is written after its hash, and the string
+    bytes behind it are written before the entry, so a reader which sees a
+    string pointer can rely on the string. A reader may see a stale, empty
+    entry, which only results in a false miss that Add() resolves under the
+    lock.
+*/
+const char*
+GlobalStringAtomTable::FindInTable(const Table* table, const char* str, SizeT length, uint32_t hash)
+{
+    const SizeT mask = table->capacity - 1;
+    IndexT i = hash & mask;
+    while (true)
+    {
+        const char* entryStr = ((const char* volatile*)&table->entries[i].str)[0];
+        if (entryStr == nullptr)
+            return nullptr;
+        if (table->entries[i].hash == hash)
+        {
+            const StringAtomHeader* header = ((const StringAtomHeader*)entryStr) - 1;
+            if (header->length == (uint32_t)length && memcmp(entryStr, str, length) == 0)
+                return entryStr;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+GlobalStringAtomTable::Table*
+GlobalStringAtomTable::AllocTable(SizeT capacity)
+{
+    size_t bytes = sizeof(Table) + (capacity - 1) * sizeof(Entry);
+    Table* table = (Table*)Memory::Alloc(Memory::StringDataHeap, bytes);
+    Memory::Clear(table, bytes);
+    table->capacity = capacity;
+    return table;
 }
 
 //------------------------------------------------------------------------------
 /**
 */
 void
-GlobalStringAtomTable::Unlock()
+GlobalStringAtomTable::InsertEntry(Table* table, const char* str, uint32_t hash)
 {
-    this->critSect.Leave();
+    const SizeT mask = table->capacity - 1;
+    IndexT i = hash & mask;
+    while (table->entries[i].str != nullptr)
+        i = (i + 1) & mask;
+    table->entries[i].hash = hash;
+    Threading::Interlocked::ExchangePointer((void* volatile*)&table->entries[i].str, (void*)str);
 }
 
 //------------------------------------------------------------------------------
 /**
-    This adds a new string to the atom table and the global string buffer,
-    and returns the pointer to the string in the string buffer.
+*/
+const char*
+GlobalStringAtomTable::Find(const char* str, SizeT length, uint32_t hash) const
+{
+    const Shard& shard = this->shards[ShardIndex(hash)];
+    const Table* table = shard.table;
+    if (table == nullptr)
+        return nullptr;
+    return FindInTable(table, str, length, hash);
+}
 
-    NOTE: you MUST call this method within Lock()/Unlock()!
+//------------------------------------------------------------------------------
+/**
+    This adds a string to the shard it belongs to, and returns the pointer to
+    the string in the shard's string buffer. If another thread has added the
+    same string in the meantime, that string is returned.
 */
 const char*
-GlobalStringAtomTable::Add(const char* str)
+GlobalStringAtomTable::Add(const char* str, SizeT length, uint32_t hash)
 {
-    StaticString sstr;
-    sstr.ptr = (char*)this->stringBuffer.AddString(str);
-    this->table.InsertSorted(sstr);
-    return sstr.ptr;
+    Shard& shard = this->shards[ShardIndex(hash)];
+    shard.lock.Enter();
+
+    // look again, someone else might have added the string since our lookup
+    Table* table = shard.table;
+    if (table != nullptr)
+    {
+        const char* existing = FindInTable(table, str, length, hash);
+        if (existing != nullptr)
+        {
+            shard.lock.Leave();
+            return existing;
+        }
+    }
+
+    if (!shard.stringBuffer.IsValid())
+        shard.stringBuffer.Setup(NEBULA_GLOBAL_STRINGBUFFER_CHUNKSIZE);
+
+    // keep the load below 1/2 so linear probe sequences stay short
+    if (table == nullptr || (shard.size + 1) * 2 > table->capacity)
+    {
+        Table* newTable = AllocTable(table == nullptr ? InitialTableSize : table->capacity * 2);
+        if (table != nullptr)
+        {
+            for (IndexT i = 0; i < table->capacity; i++)
+            {
+                if (table->entries[i].str != nullptr)
+                    InsertEntry(newTable, table->entries[i].str, table->entries[i].hash);
+            }
+            shard.retiredTables.Append(table);
+        }
+        Threading::Interlocked::ExchangePointer((void* volatile*)&shard.table, newTable);
+        table = newTable;
+    }
+
+    StringAtomHeader header;
+    header.hash = hash;
+    header.length = (uint32_t)length;
+    const char* ret = shard.stringBuffer.AddString(str, length, &header, sizeof(header));
+    InsertEntry(table, ret, hash);
+    shard.size++;
+
+    shard.lock.Leave();
+    return ret;
 }
 
 //------------------------------------------------------------------------------
@@ -73,24 +188,35 @@ GlobalStringAtomTable::Add(const char* str)
 GlobalStringAtomTable::DebugInfo
 GlobalStringAtomTable::GetDebugInfo() const
 {
-    this->critSect.Enter();
     DebugInfo debugInfo;
-    debugInfo.strings.Reserve(this->table.Size());
     debugInfo.chunkSize = NEBULA_GLOBAL_STRINGBUFFER_CHUNKSIZE;
-    debugInfo.numChunks = this->stringBuffer.GetNumChunks();
-    debugInfo.allocSize = debugInfo.chunkSize * debugInfo.numChunks;
+    debugInfo.numChunks = 0;
     debugInfo.usedSize  = 0;
     debugInfo.growthEnabled = NEBULA_ENABLE_GLOBAL_STRINGBUFFER_GROWTH;
 
-    IndexT i;
-    for (i = 0; i < table.Size(); i++)
-    {        
-        const char* str = this->table[i].ptr;
-        debugInfo.strings.Append(this->table[i].ptr);
-        debugInfo.usedSize += strlen(str) + 1;
+    for (IndexT i = 0; i < NumShards; i++)
+    {
+        const Shard& shard = this->shards[i];
+        shard.lock.Enter();
+        if (shard.stringBuffer.IsValid())
+            debugInfo.numChunks += shard.stringBuffer.GetNumChunks();
+        const Table* table = shard.table;
+        if (table != nullptr)
+        {
+            for (IndexT j = 0; j < table->capacity; j++)
+            {
+                const char* str = table->entries[j].str;
+                if (str != nullptr)
+                {
+                    debugInfo.strings.Append(str);
+                    debugInfo.usedSize += (((const StringAtomHeader*)str) - 1)->length + 1 + sizeof(StringAtomHeader);
+                }
+            }
+        }
+        shard.lock.Leave();
     }
-    this->critSect.Leave();
+    debugInfo.allocSize = debugInfo.chunkSize * debugInfo.numChunks;
     return debugInfo;
 }
 
-} // namespace Util
\ No newline at end of file
+} // namespace Util
@@ -2,26 +2,34 @@
 //------------------------------------------------------------------------------
 /**
     @class Util::GlobalStringAtomTable
-  
+
     Global string atom table. This is the definitive string atom table which
-    contains the string of all string atoms of all threads. Locking
-    is necessary to lookup or add a string (that's why thread-local
-    string atom tables exist as local cache to prevent too much locking of
-    the global table).
-    
+    contains the strings of all string atoms of all threads.
+
+    The table is split into shards selected by the string hash. Each shard
+    is an open addressing hash table of string pointers plus its own
+    append-only string buffer. Looking up a string never takes a lock: a
+    shard only ever gains entries, and a grown hash table is published with
+    a single pointer exchange after it has been filled, so readers either
+    see the old or the new table. Only adding a new string takes the lock of
+    its shard, so threads interning different strings rarely contend.
+
+    Every string is stored after a StringAtomHeader with its precomputed
+    hash and length.
+
     @copyright
     (C) 2009 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
-#include "util/stringatomtablebase.h"
 #include "core/singleton.h"
 #include "threading/criticalsection.h"
 #include "util/stringbuffer.h"
+#include "util/array.h"
 
 //------------------------------------------------------------------------------
 namespace Util
 {
-class GlobalStringAtomTable : public StringAtomTableBase
+class GlobalStringAtomTable
 {
     __DeclareInterfaceSingleton(GlobalStringAtomTable);
 public:
@@ -30,9 +38,6 @@ public:
     /// destructor
     ~GlobalStringAtomTable();
 
-    /// get pointer to global string buffer
-    StringBuffer* GetGlobalStringBuffer() const;
-
     /// debug functionality: DebugInfo struct
     struct DebugInfo
     {
@@ -43,24 +48,56 @@ public:
         size_t usedSize;
         bool growthEnabled;
     };
-    
+
     /// debug functionality: get copy of the string atom table
     DebugInfo GetDebugInfo() const;
 
 private:
     friend class StringAtom;
 
-    /// take the critical section
-    void Lock();
-    /// add a string pointer to the atom table and string buffer (must be called inside Lock())
-    const char* Add(const char* str);
-    /// release the critical section
-    void Unlock();
+    /// find an interned string, does not lock, returns nullptr if not found
+    const char* Find(const char* str, SizeT length, uint32_t hash) const;
+    /// find or add a string, locks the shard the string belongs to
+    const char* Add(const char* str, SizeT length, uint32_t hash);
+
+    struct Entry
+    {
+        const char* str;
+        uint32_t hash;
+    };
+
+    struct Table
+    {
+        SizeT capacity;
+        Entry entries[1];
+    };
 
-    Threading::CriticalSection critSect;
-    StringBuffer stringBuffer;
+    struct alignas(64) Shard
+    {
+        /// the current table, replaced when the shard grows
+        Table* volatile table;
+        SizeT size;
+        /// tables replaced by growing, readers may still be probing them
+        Util::Array<Table*> retiredTables;
+        StringBuffer stringBuffer;
+        Threading::CriticalSection lock;
+    };
+
+    /// probe a table for a string
+    static const char* FindInTable(const Table* table, const char* str, SizeT length, uint32_t hash);
+    /// allocate a cleared table
+    static Table* AllocTable(SizeT capacity);
+    /// insert an entry into a table which has room
+    static void InsertEntry(Table* table, const char* str, uint32_t hash);
+    /// get index of the shard for a hash
+    static IndexT ShardIndex(uint32_t hash);
+
+    static const SizeT NumShardBits = 6;
+    static const SizeT NumShards = 1 << NumShardBits;
+    static const SizeT InitialTableSize = 256;
+
+    Shard shards[NumShards];
 };
 
 } // namespace Util
 //------------------------------------------------------------------------------
-
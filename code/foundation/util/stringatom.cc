@@ -5,7 +5,6 @@
 //------------------------------------------------------------------------------
 
 #include "util/stringatom.h"
-#include "util/localstringatomtable.h"
 #include "util/globalstringatomtable.h"
 
 #include <string.h>
@@ -29,36 +28,24 @@ namespace Util
 void
 StringAtom::Setup(const char* str)
 {
-    #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-        // first check our thread-local string atom table whether the string
-        // is already registered there, this does not require any thread
-        // synchronisation
-        LocalStringAtomTable* localTable = LocalStringAtomTable::Instance();
-        this->content = localTable->Find(str);
-        if (0 != this->content)
-        {
-            // yep, the string is in the local table, we're done
-            return;
-        }
-    #endif
+    this->Setup(str, SizeT(strlen(str)));
+}
 
-    // the string wasn't in the local table (or thread-local tables are disabled), 
-    // so we need to check the global table, this involves thread synchronisation
+//------------------------------------------------------------------------------
+/**
+    The lookup doesn't lock, only a string which isn't interned yet takes
+    the lock of its shard in the global table.
+*/
+void
+StringAtom::Setup(const char* str, SizeT length)
+{
+    uint32_t hash = ComputeHash(str, length);
     GlobalStringAtomTable* globalTable = GlobalStringAtomTable::Instance();
-    globalTable->Lock();
-    this->content = globalTable->Find(str);
-    if (0 == this->content)
+    this->content = globalTable->Find(str, length, hash);
+    if (nullptr == this->content)
     {
-        // hrmpf, string isn't in global table either yet, so add it...
-        this->content = globalTable->Add(str);
+        this->content = globalTable->Add(str, length, hash);
     }
-    globalTable->Unlock();
-
-    #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
-        // finally, add the new string to our local table as well, so the
-        // next lookup from our thread of this string will be faster
-        localTable->Add(this->content);
-    #endif
 }
 
 //------------------------------------------------------------------------------
@@ -106,14 +93,14 @@ StringAtom::operator!=(const char* rhs) const
 
 //------------------------------------------------------------------------------
 /**
+    Persistent hash code of a string, the result must never change since
+    it ends up in serialized data.
 */
 uint32_t
-StringAtom::StringHashCode() const
+StringAtom::ComputeHash(const char* ptr, SizeT len)
 {
     uint32_t hash = 0;
-    const char* ptr = this->content;
-    size_t len = strlen(ptr);
-    uint32_t i;
+    IndexT i;
     for (i = 0; i < len; i++)
     {
         hash += ptr[i];
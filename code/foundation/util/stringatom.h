@@ -3,8 +3,13 @@
 /**
     @class Util::StringAtom
     
-    A StringAtom. See StringAtomTableBase for details about the
-    StringAtom system in N3.
+    A StringAtom. See GlobalStringAtomTable for details about the
+    StringAtom system.
+
+    The string of an atom lives in the global string buffer, preceded by a
+    StringAtomHeader holding its length and hash, so comparing atoms,
+    HashCode(), StringHashCode() and length() never look at the string
+    bytes.
 
     TODO: WARNING/STATISTICS for creation from char* or String and 
     converting back to String!
@@ -18,6 +23,14 @@
 //------------------------------------------------------------------------------
 namespace Util
 {
+
+/// stored directly in front of the characters of every interned string
+struct StringAtomHeader
+{
+    uint32_t hash;
+    uint32_t length;
+};
+
 class StringAtom
 {
 public:
@@ -80,10 +93,12 @@ public:
     /// get containted string as string object (SLOW!!!)
     String AsString() const;
 
-    /// calculate hash code for Util::HashTable (basically just the adress)
+    /// get hash code for Util::HashTable (precomputed)
     uint32_t HashCode() const;
-    /// calculate persistent hash code (based on string content)
+    /// get persistent hash code based on string content (precomputed)
     uint32_t StringHashCode() const;
+    /// compute the persistent hash code of a string
+    static uint32_t ComputeHash(const char* str, SizeT length);
 
     /// helpers to interface with libraries that expect std::string like apis
     const char* c_str() const;
@@ -93,6 +108,10 @@ public:
 private:
     /// setup the string atom from a string pointer
     void Setup(const char* str);
+    /// setup the string atom from a string pointer and length
+    void Setup(const char* str, SizeT length);
+    /// get header of the interned string
+    const StringAtomHeader* Header() const;
 
     const char* content;
 };
@@ -156,8 +175,7 @@ inline StringAtom::StringAtom(const char* str, size_t len)
 {
     if (nullptr != str)
     {
-        Util::String string(str, len);
-        this->Setup(string.AsCharPtr());
+        this->Setup(str, SizeT(len));
     }
     else
     {
@@ -377,10 +395,29 @@ StringAtom::AsString() const
 //------------------------------------------------------------------------------
 /**
 */
-inline uint32_t
+__forceinline const StringAtomHeader*
+StringAtom::Header() const
+{
+    return ((const StringAtomHeader*)this->content) - 1;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+__forceinline uint32_t
 StringAtom::HashCode() const
 {
-    return Math::pointerhash((void *)this->content);
+    return (nullptr != this->content) ? this->Header()->hash : 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+__forceinline uint32_t
+StringAtom::StringHashCode() const
+{
+    n_assert(nullptr != this->content);
+    return this->Header()->hash;
 }
 
 //------------------------------------------------------------------------------
@@ -398,7 +435,7 @@ StringAtom::c_str() const
 __forceinline size_t
 StringAtom::length() const
 {
-    return strlen(this->content);
+    return (nullptr != this->content) ? this->Header()->length : 0;
 }
 
 
@@ -106,4 +106,40 @@ StringBuffer::AddString(const char* str)
     return dstPointer;
 }
 
+//------------------------------------------------------------------------------
+/**
+    Copies a header and a string of known length, which doesn't need to be
+    0-terminated, to the end of the string buffer. The header is placed at a
+    4 byte aligned address directly in front of the returned string.
+*/
+const char*
+StringBuffer::AddString(const char* str, SizeT length, const void* header, SizeT headerSize)
+{
+    n_assert(0 != str);
+    n_assert(this->IsValid());
+    n_assert((headerSize & 3) == 0);
+
+    // header and string must fit in a chunk, including alignment padding
+    SizeT size = headerSize + length + 1;
+    n_assert(size + 3 < this->chunkSize);
+
+    char* dstPointer = (char*)Memory::alignptr((uintptr_t)this->curPointer, 4);
+    if ((dstPointer + size) >= (this->chunks.Back() + this->chunkSize))
+    {
+        #if NEBULA_ENABLE_GLOBAL_STRINGBUFFER_GROWTH
+        this->AllocNewChunk();
+        dstPointer = this->curPointer;
+        #else
+        n_error("String buffer full when adding string (string buffer growth is disabled)!\n");
+        #endif
+    }
+
+    Memory::Copy(header, dstPointer, headerSize);
+    dstPointer += headerSize;
+    Memory::Copy(str, dstPointer, length);
+    dstPointer[length] = 0;
+    this->curPointer = dstPointer + length + 1;
+    return dstPointer;
+}
+
 } // namespace Util
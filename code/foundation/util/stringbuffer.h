@@ -44,6 +44,8 @@ public:
 
     /// add a string to the end of the string buffer, return pointer to string
     const char* AddString(const char* str);
+    /// add a string of known length preceded by a 4 byte aligned header, return pointer to string
+    const char* AddString(const char* str, SizeT length, const void* header, SizeT headerSize);
     /// DEBUG: return next string in string buffer
     const char* NextString(const char* prev);
     /// DEBUG: get number of allocated chunks
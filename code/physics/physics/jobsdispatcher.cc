@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------------
+//  jobsdispatcher.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "physics/jobsdispatcher.h"
+#include "profiling/profiling.h"
+#include "threading/thread.h"
+
+namespace Physics
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+JobsCpuDispatcher::JobsCpuDispatcher() :
+    priority(Jobs2::JobPriority::High)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+JobsCpuDispatcher::~JobsCpuDispatcher()
+{
+    // the last task of a simulation step may still be finishing its job after fetchResults returned
+    for (TaskNode* node : this->usedNodes)
+    {
+        while (Threading::Interlocked::CompareExchange(&node->pending, 0, 0) != 0)
+        {
+            // without job threads a pending node would never finish, the job system must outlive the dispatcher
+            n_assert2(Jobs2::ctx.threads.Size() > 0, "JobsCpuDispatcher destroyed with pending tasks after the job system was shut down");
+            Threading::Thread::YieldThread();
+        }
+    }
+    for (TaskNode* block : this->blocks)
+    {
+        Memory::Free(Memory::PhysicsHeap, block);
+    }
+    this->blocks.Clear();
+    this->freeNodes.Clear();
+    this->usedNodes.Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+JobsCpuDispatcher::submitTask(physx::PxBaseTask& task)
+{
+    // without worker threads, run inline like PxDefaultCpuDispatcher does with 0 threads
+    if (Jobs2::ctx.threads.Size() == 0)
+    {
+        task.run();
+        task.release();
+        return;
+    }
+
+    TaskNode* node = this->AllocNode();
+    node->task = &task;
+
+    Jobs2::JobEnqueue(&node->node, RunTask, 1, 1, node, &node->pending, this->priority);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint32_t
+JobsCpuDispatcher::getWorkerCount() const
+{
+    return (uint32_t)Jobs2::ctx.threads.Size();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+JobsCpuDispatcher::TaskNode*
+JobsCpuDispatcher::AllocNode()
+{
+    this->nodeLock.Enter();
+    if (this->freeNodes.IsEmpty())
+    {
+        // take back all nodes whose job has finished
+        for (IndexT i = this->usedNodes.Size() - 1; i >= 0; i--)
+        {
+            // read with a barrier, the job thread is done with the node once it sees 0
+            if (Threading::Interlocked::CompareExchange(&this->usedNodes[i]->pending, 0, 0) == 0)
+            {
+                this->freeNodes.Append(this->usedNodes[i]);
+                this->usedNodes.EraseIndexSwap(i);
+            }
+        }
+    }
+    if (this->freeNodes.IsEmpty())
+    {
+        TaskNode* block = (TaskNode*)Memory::Alloc(Memory::PhysicsHeap, NodesPerBlock * sizeof(TaskNode));
+        this->blocks.Append(block);
+        for (IndexT i = 0; i < NodesPerBlock; i++)
+        {
+            block[i].pending = 0;
+            this->freeNodes.Append(&block[i]);
+        }
+    }
+    TaskNode* node = this->freeNodes.Back();
+    this->freeNodes.EraseBack();
+
+    // mark as pending before leaving the lock, or another thread could reclaim the node right away
+    node->pending = 1;
+    this->usedNodes.Append(node);
+    this->nodeLock.Leave();
+    return node;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+JobsCpuDispatcher::RunTask(SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset, void* ctx)
+{
+    N_SCOPE(PhysXTask, Physics);
+    TaskNode* node = (TaskNode*)ctx;
+    physx::PxBaseTask* task = node->task;
+    task->run();
+    task->release();
+}
+
+} // namespace Physics
@@ -0,0 +1,86 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Physics::JobsCpuDispatcher
+
+    PhysX CPU dispatcher running the tasks of the simulation on the Jobs2
+    worker threads, so physics and game jobs share one pool of threads
+    instead of competing with a second set of PhysX threads.
+
+    Every task is wrapped in a job node owned by the dispatcher. Nodes are
+    recycled once their job has finished, since PhysX submits tasks from
+    worker threads and the Jobs2 scratch memory is neither thread safe nor
+    valid for longer than a frame. Tasks are queued with high priority by
+    default because the thread which called fetchResults is blocked on them.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "jobs2/jobs2.h"
+#include "threading/criticalsection.h"
+#include "util/array.h"
+#include "PxPhysicsAPI.h"
+
+namespace Physics
+{
+
+class JobsCpuDispatcher : public physx::PxCpuDispatcher
+{
+public:
+    /// constructor
+    JobsCpuDispatcher();
+    /// destructor, waits for the jobs of submitted tasks to finish
+    virtual ~JobsCpuDispatcher();
+
+    /// set the priority tasks are queued with
+    void SetPriority(Jobs2::JobPriority priority);
+    /// get the priority tasks are queued with
+    Jobs2::JobPriority GetPriority() const;
+
+    /// implementation of PxCpuDispatcher, queue a task on the job system
+    void submitTask(physx::PxBaseTask& task) override;
+    /// implementation of PxCpuDispatcher, number of job system threads
+    uint32_t getWorkerCount() const override;
+
+private:
+    struct TaskNode
+    {
+        Jobs2::JobNode node;
+        Threading::AtomicCounter pending;
+        physx::PxBaseTask* task;
+    };
+
+    /// get a free node, allocates a new block of nodes if none is left
+    TaskNode* AllocNode();
+    /// job function running a single task
+    static void RunTask(SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset, void* ctx);
+
+    static const SizeT NodesPerBlock = 64;
+
+    Jobs2::JobPriority priority;
+    Threading::CriticalSection nodeLock;
+    Util::Array<TaskNode*> freeNodes;
+    Util::Array<TaskNode*> usedNodes;
+    Util::Array<TaskNode*> blocks;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+JobsCpuDispatcher::SetPriority(Jobs2::JobPriority priority)
+{
+    this->priority = priority;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Jobs2::JobPriority
+JobsCpuDispatcher::GetPriority() const
+{
+    return this->priority;
+}
+
+} // namespace Physics
@@ -23,7 +23,7 @@ namespace Physics
 //------------------------------------------------------------------------------
 /**
 */
-PhysxState::PhysxState() : foundation(nullptr), physics(nullptr), pvd(nullptr), transport(nullptr)
+PhysxState::PhysxState() : foundation(nullptr), physics(nullptr), pvd(nullptr), transport(nullptr), dispatcher(nullptr)
 {
     // empty
 }
@@ -47,6 +47,8 @@ PhysxState::Setup()
         n_error("PxInitExtensions failed!");
     }
 
+    this->dispatcher = new Physics::JobsCpuDispatcher();
+
     // preallocate actors
     ActorContext::actors.Reserve(1024);
 }
@@ -58,6 +60,8 @@ PhysxState::Setup()
 void PhysxState::Shutdown()
 {
    
+    delete this->dispatcher;
+    this->dispatcher = nullptr;
     PxCloseExtensions();
     this->physics->release();
     this->physics = nullptr;
@@ -273,6 +277,65 @@ CollectModified(Physics::Scene& scene)
     }
 }
 
+//------------------------------------------------------------------------------
+/**
+    Remember the actors moved by the step which was just fetched
+*/
+static void
+GatherSteppedActors(Physics::Scene& scene)
+{
+    uint32_t activeActorCount = 0;
+    PxActor** activeActors = scene.scene->getActiveActors(activeActorCount);
+    for (uint32_t i = 0; i < activeActorCount; i++)
+    {
+        scene.steppedActors.Append(activeActors[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Capture the poses of all actors moved since the last call into the back
+    buffer and flip it to the front. The previous front buffer is not touched,
+    so whoever consumes it doesn't have to finish before the next step is
+    kicked off. If there were no steps the new front buffer is empty.
+*/
+static void
+PublishActiveTransforms(Physics::Scene& scene, SizeT numSteps)
+{
+    IndexT const backBuffer = scene.activeTransformBuffer ^ 1;
+    Util::Array<ActorTransform>& transforms = scene.activeTransforms[backBuffer];
+    transforms.Reset();
+
+    // an actor can be active in several steps, only report it once
+    if (numSteps > 1 && scene.steppedActors.Size() > 1)
+    {
+        scene.steppedActors.Sort();
+    }
+    transforms.Reserve(scene.steppedActors.Size());
+    PxActor* previous = nullptr;
+    for (PxActor* actor : scene.steppedActors)
+    {
+        if (actor == previous)
+            continue;
+        previous = actor;
+
+        PxRigidDynamic* body = actor->is<PxRigidDynamic>();
+        if (body == nullptr || body->getRigidBodyFlags().isSet(PxRigidBodyFlag::eKINEMATIC))
+            continue;
+        ActorId const id = (Ids::Id32)(int64_t)actor->userData;
+        if (!ActorContext::IsValid(id))
+            continue;
+
+        PxTransform const pose = body->getGlobalPose();
+        ActorTransform& transform = transforms.Emplace();
+        transform.userData = ActorContext::GetActor(id).userData;
+        transform.position = Px2NebVec(pose.p);
+        transform.orientation = Px2NebQuat(pose.q);
+    }
+    scene.steppedActors.Reset();
+    scene.activeTransformBuffer = backBuffer;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -310,7 +373,7 @@ void
 PhysxState::Update(Timing::Time delta)
 {
     N_MARKER_BEGIN(Update, Physics);
-    if (Input::InputServer::Instance()->GetDefaultKeyboard()->KeyDown(Input::Key::F3))
+    if (Input::InputServer::HasInstance() && Input::InputServer::Instance()->GetDefaultKeyboard()->KeyDown(Input::Key::F3))
     {
         if (!this->pvd->isConnected()) this->ConnectPVD();
         else this->DisconnectPVD();
@@ -325,16 +388,20 @@ PhysxState::Update(Timing::Time delta)
         // we limit the simulation to 5 frames
         scene.time = Math::max(scene.time, -5.0 * PHYSICS_RATE);
         scene.eventBuffer.Reset();
+        SizeT numSteps = 0;
         while (scene.time < 0.0)
         {
             scene.scene->simulate(PHYSICS_RATE);
             scene.scene->fetchResults(true);
             scene.time += PHYSICS_RATE;
+            numSteps++;
+            GatherSteppedActors(scene);
             if (scene.updateFunction != nullptr)
             {
                 CollectModified(scene);
             }
         }
+        PublishActiveTransforms(scene, numSteps);
         PostSceneUpdates(scene);
     }
     N_MARKER_END();
@@ -348,7 +415,7 @@ PhysxState::BeginSimulating(Timing::Time delta, IndexT sceneId)
 {
     N_MARKER_BEGIN(BeginSimulation, Physics);
 #if NEBULA_DEBUG
-    if (Input::InputServer::Instance()->GetDefaultKeyboard()->KeyDown(Input::Key::F3))
+    if (Input::InputServer::HasInstance() && Input::InputServer::Instance()->GetDefaultKeyboard()->KeyDown(Input::Key::F3))
     {
         if (!this->pvd->isConnected()) this->ConnectPVD();
         else this->DisconnectPVD();
@@ -372,7 +439,7 @@ PhysxState::BeginSimulating(Timing::Time delta, IndexT sceneId)
 //------------------------------------------------------------------------------
 /**
 */
-void
+bool
 PhysxState::EndSimulating(IndexT sceneId)
 {
     n_assert(this->activeSceneIds.FindIndex(sceneId) != InvalidIndex);
@@ -380,12 +447,15 @@ PhysxState::EndSimulating(IndexT sceneId)
 
     if (!scene.isSimulating)
     {
-        return;
+        PublishActiveTransforms(scene, 0);
+        return false;
     }
 
     N_MARKER_BEGIN(EndSimulating, Physics);
     scene.scene->fetchResults(true);
     scene.time += PHYSICS_RATE;
+    SizeT numSteps = 1;
+    GatherSteppedActors(scene);
 
     if (scene.updateFunction != nullptr)
     {
@@ -401,10 +471,14 @@ PhysxState::EndSimulating(IndexT sceneId)
         scene.scene->fetchResults(true);
         CollectModified(scene);
         scene.time += PHYSICS_RATE;
+        numSteps++;
+        GatherSteppedActors(scene);
     }
+    PublishActiveTransforms(scene, numSteps);
     PostSceneUpdates(scene);    
     scene.isSimulating = false;
     N_MARKER_END();
+    return true;
 }
 
 //------------------------------------------------------------------------------
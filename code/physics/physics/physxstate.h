@@ -10,6 +10,7 @@
 
 #include "physicsinterface.h"
 #include "physics/callbacks.h"
+#include "physics/jobsdispatcher.h"
 #include "ids/idgenerationpool.h"
 #include "util/set.h"
 
@@ -28,6 +29,8 @@ public:
     physx::PxPhysics * physics;
     physx::PxPvd *pvd;
     physx::PxPvdTransport *transport;
+    /// shared by all scenes, runs PhysX tasks on the job system
+    Physics::JobsCpuDispatcher* dispatcher;
     Util::Delegate<void(ActorId*, SizeT)> onSleepCallback;
     Util::Delegate<void(ActorId*, SizeT)> onWakeCallback;
     Physics::Allocator allocator;
@@ -57,8 +60,8 @@ public:
 
     /// explicit call to simulate, will process async in the background
     void BeginSimulating(Timing::Time delta, IndexT scene);
-    /// explicit call to fetch the results of the simulation
-    void EndSimulating(IndexT scene);
+    /// explicit call to fetch the results of the simulation, returns false if no step was running
+    bool EndSimulating(IndexT scene);
 
     /// will block until a potential simulation step is done
     void FlushSimulation(IndexT scene);
@@ -203,6 +203,11 @@ CreateMeshFromResource(MeshTopology type, Util::StringAtom resource, int primGro
         // not a nvx3 file, break hard
         n_error("MeshLoader: '%s' is not a nvx file!", stream->GetURI().AsString().AsCharPtr());
     }
+    if (header->version != NEBULA_NVX_VERSION)
+    {
+        // exported with an older layout, break hard
+        n_error("MeshLoader: '%s' is a nvx file of version %d, expected %d, re-export it!", stream->GetURI().AsString().AsCharPtr(), header->version, NEBULA_NVX_VERSION);
+    }
 
     n_assert(header->numMeshes > 0);
 
@@ -343,6 +348,11 @@ AddMeshColliders(PhysicsResource::MeshColliderT* colliderNode, Math::transform c
         // not a nvx3 file, break hard
         n_error("MeshLoader: '%s' is not a nvx file!", stream->GetURI().AsString().AsCharPtr());
     }
+    if (header->version != NEBULA_NVX_VERSION)
+    {
+        // exported with an older layout, break hard
+        n_error("MeshLoader: '%s' is a nvx file of version %d, expected %d, re-export it!", stream->GetURI().AsString().AsCharPtr(), header->version, NEBULA_NVX_VERSION);
+    }
 
     n_assert(header->numMeshes > 0);
 
@@ -22,7 +22,6 @@
 #include "util/color.h"
 
 #define PHYSX_MEMORY_ALLOCATION_DEBUG false
-#define PHYSX_THREADS 4
 
 using namespace physx;
 using namespace Physics;
@@ -111,8 +110,7 @@ CreateScene()
     state.activeSceneIds.Append(idx);
     state.activeScenes.Append(Scene());
     Scene & scene = state.activeScenes[idx];
-    //scene.dispatcher = PxDefaultCpuDispatcherCreate(PHYSX_THREADS);
-    scene.dispatcher = PxDefaultCpuDispatcherCreate(0);
+    scene.dispatcher = state.dispatcher;
 
     PxSceneDesc sceneDesc(state.physics->getTolerancesScale());
     sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
@@ -168,7 +166,7 @@ DestroyScene(IndexT sceneId)
     }
     scene.controllerManager->release();
     scene.scene->release();
-    scene.dispatcher->release();
+    scene.dispatcher = nullptr;
     state.deadSceneIds.Append(sceneId);
     state.activeSceneIds.EraseIndex(activeIndex);
 }
@@ -369,10 +367,10 @@ BeginSimulating(Timing::Time delta, IndexT scene)
 //------------------------------------------------------------------------------
 /**
 */
-void
+bool
 EndSimulating(IndexT scene)
 {
-    state.EndSimulating(scene);
+    return state.EndSimulating(scene);
 }
 
 //------------------------------------------------------------------------------
@@ -384,6 +382,17 @@ FlushSimulation(IndexT scene)
     state.FlushSimulation(scene);
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+Util::Array<ActorTransform> const&
+GetActiveTransforms(IndexT scene)
+{
+    n_assert(state.activeSceneIds.FindIndex(scene) != InvalidIndex);
+    Physics::Scene const& physicsScene = state.activeScenes[scene];
+    return physicsScene.activeTransforms[physicsScene.activeTransformBuffer];
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -140,6 +140,14 @@ struct ContactEvent
 
 using EventCallbackType = void (*) (const Util::Array<ContactEvent>&);
 
+/// world transform of a dynamic actor after a simulation step
+struct ActorTransform
+{
+    uint64_t userData;
+    Math::vec3 position;
+    Math::quat orientation;
+};
+
 struct CharacterCreateInfo
 {
     struct CapsuleInfo
@@ -202,13 +210,18 @@ struct Scene
     physx::PxPhysics *physics;
     physx::PxScene *scene;
     physx::PxControllerManager *controllerManager;
-    physx::PxDefaultCpuDispatcher *dispatcher;
+    physx::PxCpuDispatcher *dispatcher;
     UpdateFunctionType updateFunction = nullptr;
     EventCallbackType eventCallback = nullptr;
     Timing::Time time;
     bool isSimulating = false;
     Util::Array<Physics::ContactEvent> eventBuffer;
     Util::Set<Ids::Id32> modifiedActors;
+    /// actors reported active by the steps since the last fetch
+    Util::Array<physx::PxActor*> steppedActors;
+    /// double buffered, the front buffer stays valid while the next step is simulated and captured
+    Util::Array<Physics::ActorTransform> activeTransforms[2];
+    IndexT activeTransformBuffer = 0;
 };
 
 /// initialize the physics subsystem and create a default scene
@@ -221,7 +234,10 @@ void Update(Timing::Time delta);
 
 /// explicit calls to simulate and fetch results. Do not mix with Update!
 void BeginSimulating(Timing::Time delta, IndexT scene);
-void EndSimulating(IndexT scene);
+bool EndSimulating(IndexT scene);
+
+/// transforms of the non-kinematic dynamic actors moved since the previous Update or EndSimulating
+Util::Array<ActorTransform> const& GetActiveTransforms(IndexT scene = 0);
 
 /// this will block until simulation has ended for cleanups e.g.
 void FlushSimulation(IndexT scene);
@@ -139,6 +139,7 @@ MeshLoader::StreamResource(const ResourceLoadJob& job)
     uint bitsToLoad = job.loadState.requestedBits & ~(pendingBits | loadedBits);
 
     n_assert(header->magic == NEBULA_NVX_MAGICNUMBER);
+    n_assert(header->version == NEBULA_NVX_VERSION);
     n_assert(header->numMeshes > 0);
     auto vertexRanges = (Nvx3VertexRange*)(basePtr + header->meshDataOffset);
     auto vertexData = (ubyte*)(basePtr + header->vertexDataOffset);
@@ -359,6 +360,11 @@ MeshLoader::SetupMeshFromNvx(const Ptr<IO::Stream>& stream, const ResourceLoadJo
             // not a nvx2 file, break hard
             n_error("MeshLoader: '%s' is not a nvx file!", stream->GetURI().AsString().AsCharPtr());
         }
+        if (header->version != NEBULA_NVX_VERSION)
+        {
+            // exported with an older layout, break hard
+            n_error("MeshLoader: '%s' is a nvx file of version %d, expected %d, re-export it!", stream->GetURI().AsString().AsCharPtr(), header->version, NEBULA_NVX_VERSION);
+        }
 
         n_assert(header->numMeshes > 0);
         auto vertexRanges = (Nvx3VertexRange*)(basePtr + header->meshDataOffset);
@@ -17,6 +17,9 @@ namespace CoreGraphics
 {
 
 #define NEBULA_NVX_MAGICNUMBER 'NVX3'
+// bump whenever the layout of the file changes, files with another version have to be re-exported
+// 2: header version, meshlet vertex count, bounds and normal cone
+#define NEBULA_NVX_VERSION 2
 
 #pragma pack(push, 1)
 
@@ -27,6 +30,7 @@ namespace CoreGraphics
 struct Nvx3Header
 {
     uint magic;
+    uint version;           // NEBULA_NVX_VERSION
     uint meshDataOffset;
     uint numMeshes;         // The number of Nvx3Mesh structs
     uint meshletDataOffset;
@@ -60,9 +64,15 @@ struct Nvx3Group
 
 struct Nvx3Meshlet
 {
-    uint indexOffset;
-    uint firstIndex;
-    uint numIndices;
+    uint indexOffset;               // Byte offset of the owning vertex range's index data
+    uint firstIndex;                // First index of the meshlet within the vertex range
+    uint numIndices;                // Number of indices in the meshlet
+    uint numVertices;               // Number of unique vertices referenced by the meshlet
+    float center[3];                // Bounding sphere center
+    float radius;                   // Bounding sphere radius
+    float coneApex[3];              // Normal cone apex
+    float coneAxis[3];              // Normal cone axis
+    float coneCutoff;               // Meshlet is backfacing if dot(normalize(coneApex - eye), coneAxis) >= coneCutoff
 };
 
 
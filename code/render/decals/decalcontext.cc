@@ -18,6 +18,12 @@
 #include "gpulang/render/system_shaders/decals_cluster.h"
 
 #include "frame/default.h"
+#include "jobs2/jobs2.h"
+#include "threading/event.h"
+#include "profiling/profiling.h"
+
+N_DECLARE_COUNTER(N_VISIBLE_DECALS, Visible Decals);
+N_DECLARE_COUNTER(N_CULLED_DECALS, Culled Decals);
 
 namespace Decals
 {
@@ -42,6 +48,10 @@ struct
     // these are used to update the light clustering
     DecalsCluster::PBRDecal pbrDecals[256];
     DecalsCluster::EmissiveDecal emissiveDecals[256];
+
+    // written by the culling jobs, one entry per decal
+    Util::Array<bool> visible;
+    SizeT numCulled = 0;
 } decalState;
 
 //------------------------------------------------------------------------------
@@ -98,6 +108,8 @@ DecalContext::Create()
     rwbInfo.usageFlags = CoreGraphics::BufferUsage::TransferSource;
     decalState.stagingClusterDecalsList.Create(rwbInfo);
 
+    N_BUDGET_COUNTER_SETUP(N_VISIBLE_DECALS, lengthof(decalState.pbrDecals) + lengthof(decalState.emissiveDecals));
+
     FrameScript_default::Bind_ClusterDecalList(decalState.clusterDecalsList);
     FrameScript_default::Bind_ClusterDecalIndexLists(decalState.clusterDecalIndexLists);
     FrameScript_default::RegisterSubgraph_DecalCopy_Compute([](const CoreGraphics::CmdBufferId cmdBuf, const CoreGraphics::QueueType queue, const Math::rectangle<int>& viewport, const IndexT frame, const IndexT bufferIndex)
@@ -156,10 +168,10 @@ DecalContext::SetupDecalPBR(
     Resources::SetMinLod(normal, 0.0f, false);
     Resources::SetMinLod(material, 0.0f, false);
 
-    genericDecalAllocator.Set<Decal_Transform>(cid.id, transform);
+    UpdateTransform(cid.id, transform);
     genericDecalAllocator.Set<Decal_Type>(cid.id, PBRDecal);
     genericDecalAllocator.Set<Decal_TypedId>(cid.id, decal);
-    genericDecalAllocator.Set<Decal_StageMask>(decal, stageMask);
+    genericDecalAllocator.Set<Decal_StageMask>(cid.id, stageMask);
 }
 
 //------------------------------------------------------------------------------
@@ -177,10 +189,10 @@ DecalContext::SetupDecalEmissive(
     Ids::Id32 decal = emissiveDecalAllocator.Alloc();
     emissiveDecalAllocator.Set<DecalEmissive_Emissive>(decal, emissive);
 
-    genericDecalAllocator.Set<Decal_Transform>(cid.id, transform);
+    UpdateTransform(cid.id, transform);
     genericDecalAllocator.Set<Decal_Type>(cid.id, EmissiveDecal);
     genericDecalAllocator.Set<Decal_TypedId>(cid.id, decal);
-    genericDecalAllocator.Set<Decal_StageMask>(decal, stageMask);
+    genericDecalAllocator.Set<Decal_StageMask>(cid.id, stageMask);
 }
 
 //------------------------------------------------------------------------------
@@ -253,7 +265,7 @@ DecalContext::SetTransform(const Graphics::GraphicsEntityId id, const Math::mat4
     if (ctxId == Graphics::ContextEntityId::Invalid())
         return;
 
-    genericDecalAllocator.Set<Decal_Transform>(ctxId.id, transform);
+    UpdateTransform(ctxId.id, transform);
 }
 
 //------------------------------------------------------------------------------
@@ -268,34 +280,78 @@ DecalContext::GetTransform(const Graphics::GraphicsEntityId id)
 
 //------------------------------------------------------------------------------
 /**
+    The culling jobs only read the cached bounds, the decals which pass are
+    packed into the cluster lists in order afterwards. Without a LOD camera
+    nothing is culled.
 */
 void
 DecalContext::UpdateDecals(const Graphics::FrameContext& ctx)
 {
+    N_SCOPE(UpdateDecals, Decals);
     using namespace CoreGraphics;
     const Util::Array<DecalType>& types = genericDecalAllocator.GetArray<Decal_Type>();
     const Util::Array<Ids::Id32>& typeIds = genericDecalAllocator.GetArray<Decal_TypedId>();
     const Util::Array<Math::mat4>& transforms = genericDecalAllocator.GetArray<Decal_Transform>();
+    const Util::Array<Math::mat4>& inverseTransforms = genericDecalAllocator.GetArray<Decal_InverseTransform>();
+    const Util::Array<Math::bbox>& boxes = genericDecalAllocator.GetArray<Decal_BoundingBox>();
     const Util::Array<Graphics::StageMask>& stageMasks = genericDecalAllocator.GetArray<Decal_StageMask>();
     SizeT numPbrDecals = 0;
     SizeT numEmissiveDecals = 0;
+    SizeT numCulled = 0;
+
+    decalState.visible.Resize(types.Size());
+    const Graphics::GraphicsEntityId camera = Graphics::CameraContext::GetLODCamera();
+    if (camera == Graphics::InvalidGraphicsEntityId)
+    {
+        decalState.visible.Fill(0, types.Size(), true);
+    }
+    else if (types.Size() > 0)
+    {
+        const Math::mat4 viewProjection = Graphics::CameraContext::GetViewProjection(camera);
+        Threading::Event cullDone;
+        Jobs2::JobDispatch(
+            [viewProjection, &boxes](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+            {
+                N_SCOPE(CullDecals, Decals);
+                for (IndexT i = 0; i < groupSize; i++)
+                {
+                    IndexT const index = i + invocationOffset;
+                    if (index >= totalJobs)
+                        return;
+                    decalState.visible[index] = boxes[index].clipstatus(viewProjection) != Math::ClipStatus::Outside;
+                }
+            },
+            types.Size(),
+            64,
+            nullptr,
+            nullptr,
+            &cullDone
+        );
+        cullDone.Wait();
+    }
 
     IndexT i;
     for (i = 0; i < types.Size(); i++)
     {
+        if (!decalState.visible[i])
+        {
+            numCulled++;
+            continue;
+        }
+
         switch (types[i])
         {
         case PBRDecal:
         {
+            if (numPbrDecals == lengthof(decalState.pbrDecals))
+                break;
             auto& pbrDecal = decalState.pbrDecals[numPbrDecals];
-            Math::bbox bbox(transforms[i]);
-            bbox.pmin.store(pbrDecal.bboxMin);
-            bbox.pmax.store(pbrDecal.bboxMax);
+            boxes[i].pmin.store(pbrDecal.bboxMin);
+            boxes[i].pmax.store(pbrDecal.bboxMax);
             pbrDecal.albedo = TextureGetBindlessHandle(pbrDecalAllocator.Get<DecalPBR_Albedo>(typeIds[i]));
             pbrDecal.normal = TextureGetBindlessHandle(pbrDecalAllocator.Get<DecalPBR_Normal>(typeIds[i]));
             pbrDecal.material = TextureGetBindlessHandle(pbrDecalAllocator.Get<DecalPBR_Material>(typeIds[i]));
-            Math::mat4 inverse = Math::inverse(transforms[i]);
-            inverse.store(&pbrDecal.invModel[0][0]);
+            inverseTransforms[i].store(&pbrDecal.invModel[0][0]);
             transforms[i].z_axis.store3(pbrDecal.direction);
             Math::vec4 tangent = normalize(-transforms[i].x_axis);
             tangent.store3(pbrDecal.tangent);
@@ -306,10 +362,11 @@ DecalContext::UpdateDecals(const Graphics::FrameContext& ctx)
 
         case EmissiveDecal:
         {
+            if (numEmissiveDecals == lengthof(decalState.emissiveDecals))
+                break;
             auto& emissiveDecal = decalState.emissiveDecals[numEmissiveDecals];
-            Math::bbox bbox(transforms[i]);
-            bbox.pmin.store(emissiveDecal.bboxMin);
-            bbox.pmax.store(emissiveDecal.bboxMax);
+            boxes[i].pmin.store(emissiveDecal.bboxMin);
+            boxes[i].pmax.store(emissiveDecal.bboxMax);
             transforms[i].z_axis.store3(emissiveDecal.direction);
             emissiveDecal.emissive = TextureGetBindlessHandle(emissiveDecalAllocator.Get<DecalEmissive_Emissive>(typeIds[i]));
             emissiveDecal.stageMask = stageMasks[i];
@@ -319,6 +376,12 @@ DecalContext::UpdateDecals(const Graphics::FrameContext& ctx)
         }
     }
 
+    N_BUDGET_COUNTER_RESET(N_VISIBLE_DECALS);
+    N_BUDGET_COUNTER_INCR(N_VISIBLE_DECALS, numPbrDecals + numEmissiveDecals);
+    N_COUNTER_DECR(N_CULLED_DECALS, decalState.numCulled);
+    N_COUNTER_INCR(N_CULLED_DECALS, numCulled);
+    decalState.numCulled = numCulled;
+
     // setup uniforms
     DecalsCluster::DecalUniforms::STRUCT decalUniforms;
     decalUniforms.NumDecalClusters = Clustering::ClusterContext::GetNumClusters();
@@ -394,6 +457,19 @@ DecalContext::OnRenderDebug(uint32_t flags)
     }
 }
 
+//------------------------------------------------------------------------------
+/**
+    Decals are culled and packed every frame, but only move now and then,
+    so everything derived from the transform is computed here.
+*/
+void
+DecalContext::UpdateTransform(const Ids::Id32 id, const Math::mat4& transform)
+{
+    genericDecalAllocator.Set<Decal_Transform>(id, transform);
+    genericDecalAllocator.Set<Decal_InverseTransform>(id, Math::inverse(transform));
+    genericDecalAllocator.Set<Decal_BoundingBox>(id, Math::bbox(transform));
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -56,7 +56,7 @@ public:
     /// get transform of decal
     static Math::mat4 GetTransform(const Graphics::GraphicsEntityId id);
 
-    /// update view dependent resources
+    /// cull decals against the LOD camera and fill the cluster lists with the visible ones
     static void UpdateDecals(const Graphics::FrameContext& ctx);
 
 #ifndef PUBLIC_BUILD
@@ -74,12 +74,16 @@ private:
     enum
     {
         Decal_Transform,
+        Decal_InverseTransform,
+        Decal_BoundingBox,
         Decal_Type,
         Decal_TypedId,
         Decal_StageMask
     };
     typedef Ids::IdAllocator<
         Math::mat4,
+        Math::mat4,                 // inverse transform, updated with the transform
+        Math::bbox,                 // world space bounds, updated with the transform
         DecalType,
         Ids::Id32,
         Graphics::StageMask
@@ -108,6 +112,9 @@ private:
     > EmissiveDecalAllocator;
     static EmissiveDecalAllocator emissiveDecalAllocator;
 
+    /// set transform and update inverse and bounds
+    static void UpdateTransform(const Ids::Id32 id, const Math::mat4& transform);
+
     /// allocate a new slice for this context
     static Graphics::ContextEntityId Alloc();
     /// deallocate a slice
@@ -27,9 +27,15 @@
 
 #include "frame/default.h"
 #include "frame/shadows.h"
+#include "jobs2/jobs2.h"
+#include "threading/event.h"
+#include "profiling/profiling.h"
 
 #define CLUSTERED_LIGHTING_DEBUG 0
 
+N_DECLARE_COUNTER(N_VISIBLE_LIGHTS, Visible Lights);
+N_DECLARE_COUNTER(N_CULLED_LIGHTS, Culled Lights);
+
 namespace Lighting
 {
 
@@ -78,6 +84,10 @@ struct
     alignas(16) LightsCluster::LightLists::STRUCT lightList;
     LightsCluster::LightUniforms::STRUCT consts;
 
+    // written by the culling jobs, one entry per light
+    Util::Array<bool> visible;
+    SizeT numCulled = 0;
+
 } clusterState;
 
 struct
@@ -130,6 +140,8 @@ LightContext::Create()
 #endif
     Graphics::GraphicsServer::Instance()->RegisterGraphicsContext(&__bundle, &__state);
 
+    N_BUDGET_COUNTER_SETUP(N_VISIBLE_LIGHTS, lengthof(clusterState.lightList.PointLights) + lengthof(clusterState.lightList.SpotLights) + lengthof(clusterState.lightList.AreaLights));
+
     lightServerState.shadowAtlasTileOctree.Setup(0x2000, 4096, 256);
 
     CoreGraphics::TextureCreateInfo shadowMapInfo;
@@ -1284,6 +1296,86 @@ LightContext::SetDirectionalLightTransform(const Graphics::ContextEntityId id, c
 
 //------------------------------------------------------------------------------
 /**
+    The scaled transform covering everything an area light reaches.
+*/
+Math::transform44
+LightContext::AreaLightReach(Math::transform44 trans, const AreaLightShape shape, const bool twoSided, const float range)
+{
+    Math::vec3 scale = trans.getscale();
+    float width = scale.x;
+    float height = shape == AreaLightShape::Tube ? 1.0f : scale.y;
+    trans.setscale(Math::vector(width * range, height * range, twoSided ? range * 2 : range));
+    return trans;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Bounds of the cone of a spot light, the box around the apex and the disc
+    capping the cone, clamped to the range. Spot lights shine along the
+    negative z axis of their transform, like the cluster culling and the
+    lighting shaders expect.
+*/
+Math::bbox
+LightContext::SpotLightBounds(const Math::mat4& transform, const float outerAngle, const float range)
+{
+    const Math::vec3 apex = xyz(transform.position);
+    const Math::vec3 forward = xyz(normalize(transform.z_axis));
+    Math::bbox box(transform.position, Math::vector(range));
+    if (outerAngle < N_PI * 0.5f)
+    {
+        // the cap disc, its extent along each axis shrinks with how much the axis points along the cone
+        const Math::vec3 capCenter = apex - forward * range;
+        const float capRadius = range * Math::tan(outerAngle);
+        const Math::vec3 capExtents = Math::vec3(
+            capRadius * Math::sqrt(Math::max(0.0f, 1.0f - forward.x * forward.x)),
+            capRadius * Math::sqrt(Math::max(0.0f, 1.0f - forward.y * forward.y)),
+            capRadius * Math::sqrt(Math::max(0.0f, 1.0f - forward.z * forward.z)));
+        const Math::vec3 coneMin = Math::minimize(apex, capCenter - capExtents);
+        const Math::vec3 coneMax = Math::maximize(apex, capCenter + capExtents);
+        box.pmin = Math::maximize(box.pmin, Math::point(coneMin));
+        box.pmax = Math::minimize(box.pmax, Math::point(coneMax));
+    }
+    return box;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Bounds of the lit volume of a local light.
+*/
+Math::bbox
+LightContext::LocalLightBounds(const LightType type, const Ids::Id32 typeId, const float range)
+{
+    switch (type)
+    {
+        case LightType::PointLightType:
+        {
+            Math::point pos = pointLightAllocator.Get<PointLight_Transform>(typeId).getposition();
+            return Math::bbox(pos, Math::vector(range));
+        }
+        case LightType::SpotLightType:
+        {
+            const Math::mat4 trans = spotLightAllocator.Get<SpotLight_Transform>(typeId).getmatrix();
+            const float angle = spotLightAllocator.Get<SpotLight_ConeAngles>(typeId)[1];
+            return SpotLightBounds(trans, angle, range);
+        }
+        case LightType::AreaLightType:
+        {
+            auto shape = areaLightAllocator.Get<AreaLight_Shape>(typeId);
+            bool twoSided = areaLightAllocator.Get<AreaLight_TwoSided>(typeId);
+            Math::transform44 trans = areaLightAllocator.Get<AreaLight_Transform>(typeId);
+            return Math::bbox(AreaLightReach(trans, shape, twoSided, range).getmatrix());
+        }
+        default:
+            return Math::bbox();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Local lights outside the view of the LOD camera are culled on the job
+    threads before the light lists are packed. The ray traced light grid
+    needs lights behind the camera as well, so nothing is culled when ray
+    tracing is supported, nor without a LOD camera.
 */
 void
 LightContext::UpdateLights(const Graphics::FrameContext& ctx)
@@ -1325,6 +1417,41 @@ LightContext::UpdateLights(const Graphics::FrameContext& ctx)
     SizeT numSpotLightsProjection = 0;
     SizeT numAreaLights = 0;
     SizeT numAreaLightShadows = 0;
+    SizeT numCulled = 0;
+
+    clusterState.visible.Resize(types.Size());
+    const Graphics::GraphicsEntityId camera = Graphics::CameraContext::GetLODCamera();
+    if (CoreGraphics::RayTracingSupported || camera == Graphics::InvalidGraphicsEntityId)
+    {
+        clusterState.visible.Fill(0, types.Size(), true);
+    }
+    else if (types.Size() > 0)
+    {
+        const Math::mat4 viewProjection = Graphics::CameraContext::GetViewProjection(camera);
+        Threading::Event cullDone;
+        Jobs2::JobDispatch(
+            [viewProjection, &types, &typeIds, &range](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+            {
+                N_SCOPE(CullLights, Lighting);
+                for (IndexT i = 0; i < groupSize; i++)
+                {
+                    IndexT const index = i + invocationOffset;
+                    if (index >= totalJobs)
+                        return;
+                    if (types[index] == LightType::DirectionalLightType)
+                        clusterState.visible[index] = true;
+                    else
+                        clusterState.visible[index] = LocalLightBounds(types[index], typeIds[index], range[index]).clipstatus(viewProjection) != Math::ClipStatus::Outside;
+                }
+            },
+            types.Size(),
+            64,
+            nullptr,
+            nullptr,
+            &cullDone
+        );
+        cullDone.Wait();
+    }
 
     IndexT i;
     for (i = 0; i < types.Size(); i++)
@@ -1332,10 +1459,18 @@ LightContext::UpdateLights(const Graphics::FrameContext& ctx)
         if (castShadow[i])
             lightServerState.shadowCastingLights.Append(i);
 
+        if (!clusterState.visible[i])
+        {
+            numCulled++;
+            continue;
+        }
+
         switch (types[i])
         {
             case LightType::DirectionalLightType:
             {
+                if (numDirectionalLights == lengthof(clusterState.lightList.DirectionalLights))
+                    break;
                 auto& directionalLight = clusterState.lightList.DirectionalLights[numDirectionalLights];
                 (genericLightAllocator.Get<Light_Color>(typeIds[i]) * genericLightAllocator.Get<Light_Intensity>(typeIds[i])).store(directionalLight.color);
                 directionalLightAllocator.Get<DirectionalLight_Direction>(typeIds[i]).store(directionalLight.direction);
@@ -1360,6 +1495,8 @@ LightContext::UpdateLights(const Graphics::FrameContext& ctx)
             break;
             case LightType::PointLightType:
             {
+                if (numPointLights == lengthof(clusterState.lightList.PointLights))
+                    break;
                 const Math::point& trans = pointLightAllocator.Get<PointLight_Transform>(typeIds[i]).getposition();
                 CoreGraphics::TextureId tex = pointLightAllocator.Get<PointLight_ProjectionTexture>(typeIds[i]);
                 auto& pointLight = clusterState.lightList.PointLights[numPointLights];
@@ -1402,6 +1539,8 @@ LightContext::UpdateLights(const Graphics::FrameContext& ctx)
 
             case LightType::SpotLightType:
             {
+                if (numSpotLights == lengthof(clusterState.lightList.SpotLights))
+                    break;
                 const Math::mat4 trans = spotLightAllocator.Get<SpotLight_Transform>(typeIds[i]).getmatrix();
                 CoreGraphics::TextureId tex = spotLightAllocator.Get<SpotLight_ProjectionTexture>(typeIds[i]);
                 auto angles = spotLightAllocator.Get<SpotLight_ConeAngles>(typeIds[i]);
@@ -1460,6 +1599,8 @@ LightContext::UpdateLights(const Graphics::FrameContext& ctx)
 
             case LightType::AreaLightType:
             {
+                if (numAreaLights == lengthof(clusterState.lightList.AreaLights))
+                    break;
                 Math::transform44 trans = areaLightAllocator.Get<AreaLight_Transform>(typeIds[i]);
                 bool twoSided = areaLightAllocator.Get<AreaLight_TwoSided>(typeIds[i]);
                 auto shape = areaLightAllocator.Get<AreaLight_Shape>(typeIds[i]);
@@ -1479,10 +1620,7 @@ LightContext::UpdateLights(const Graphics::FrameContext& ctx)
                 pos.store3(areaLight.position);
 
                 Math::vec3 scale = trans.getscale();
-                float width = scale.x;
-                float height = shape == AreaLightShape::Tube ? 1.0f : scale.y;
-                trans.setscale(Math::vector(width * range[i], height * range[i], twoSided ? range[i] * 2 : range[i]));
-                trans.setposition(trans.getposition() + Math::vector(0, 0, 0));
+                trans = AreaLightReach(trans, shape, twoSided, range[i]);
 
                 trans.getmatrix().position.store3(areaLight.position);
                 Math::bbox box = trans.getmatrix();
@@ -1536,6 +1674,12 @@ LightContext::UpdateLights(const Graphics::FrameContext& ctx)
         }
     }
 
+    N_BUDGET_COUNTER_RESET(N_VISIBLE_LIGHTS);
+    N_BUDGET_COUNTER_INCR(N_VISIBLE_LIGHTS, numPointLights + numSpotLights + numAreaLights);
+    N_COUNTER_DECR(N_CULLED_LIGHTS, clusterState.numCulled);
+    N_COUNTER_INCR(N_CULLED_LIGHTS, numCulled);
+    clusterState.numCulled = numCulled;
+
     IndexT bufferIndex = CoreGraphics::GetBufferedFrameIndex();
 
     // update list of point lights
@@ -143,6 +143,9 @@ public:
     /// get the light type
     static LightType GetType(const Graphics::GraphicsEntityId id);
 
+    /// get the bounds of a spot light cone, which points along the negative z axis of the transform
+    static Math::bbox SpotLightBounds(const Math::mat4& transform, const float outerAngle, const float range);
+
     /// get inner and outer angle for spotlights
     static void GetInnerOuterAngle(const Graphics::GraphicsEntityId id, float& inner, float& outer);
     /// set inner and outer angle for spotlights
@@ -176,6 +179,10 @@ private:
 
     /// Set global light transform
     static void SetDirectionalLightTransform(const Graphics::ContextEntityId id, const Math::mat4& transform, const Math::vector& direction);
+    /// scale an area light transform to cover everything the light reaches
+    static Math::transform44 AreaLightReach(Math::transform44 trans, const AreaLightShape shape, const bool twoSided, const float range);
+    /// get the bounds of the lit volume of a point, spot or area light
+    static Math::bbox LocalLightBounds(const LightType type, const Ids::Id32 typeId, const float range);
 
     enum
     {
@@ -13,6 +13,7 @@
 #include "graphics/cameracontext.h"
 #include "graphics/view.h"
 #include "threading/lockfreequeue.h"
+#include "memory/framearray.h"
 #include "materials/material.h"
 
 #include "gpulang/render/system_shaders/objects_shared.h"
@@ -823,16 +824,10 @@ ModelContext::UpdateTransforms(const Graphics::FrameContext& ctx)
     Util::Array<Math::mat4>& pending = modelContextAllocator.GetArray<Model_Transform>();
     Util::Array<bool>& hasPending = modelContextAllocator.GetArray<Model_Dirty>();
 
-    static Util::Array<CameraSettings> lodCameraSettings;
-    static Util::Array<Math::mat4> lodCameraViewTransforms;
-    static Util::Array<Graphics::StageMask> lodCameraStageMasks;
     const Util::Array<Graphics::GraphicsEntityId>& lodCameras = Graphics::CameraContext::GetLODCameras();
-    lodCameraSettings.Clear();
-    lodCameraSettings.Reserve(lodCameras.Size());
-    lodCameraViewTransforms.Clear();
-    lodCameraViewTransforms.Reserve(lodCameras.Size());
-    lodCameraStageMasks.Clear();
-    lodCameraStageMasks.Reserve(lodCameras.Size());
+    Memory::FrameArray<CameraSettings> lodCameraSettings(lodCameras.Size());
+    Memory::FrameArray<Math::mat4> lodCameraViewTransforms(lodCameras.Size());
+    Memory::FrameArray<Graphics::StageMask> lodCameraStageMasks(lodCameras.Size());
     for (auto& cam : lodCameras)
     {
         lodCameraSettings.Append(Graphics::CameraContext::GetSettings(cam));
@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------
+// instanceranges.cc
+// (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "instanceranges.h"
+
+namespace Raytracing
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InstanceRangeAppend(Util::Array<InstanceRange>& ranges, const uint index)
+{
+    if (!ranges.IsEmpty())
+    {
+        InstanceRange& last = ranges.Back();
+        if (index < last.first + last.num)
+            return;
+        if (index == last.first + last.num)
+        {
+            last.num++;
+            return;
+        }
+    }
+    ranges.Append(InstanceRange{ index, 1 });
+}
+
+//------------------------------------------------------------------------------
+/**
+    Changed instances are added or removed ones, their object bindings and
+    instances both have to be uploaded. Moved instances are dynamic ones
+    whose transform changed, only their instances are uploaded. On return
+    changed holds every changed instance once, in ascending order.
+*/
+void
+InstanceRangesCollect(Util::Array<uint>& changed, const Util::Array<bool>& moved, Util::Array<InstanceRange>& outObjectRanges, Util::Array<InstanceRange>& outInstanceRanges)
+{
+    outObjectRanges.Clear();
+    outInstanceRanges.Clear();
+
+    if (!changed.IsEmpty())
+    {
+        changed.Sort();
+        SizeT numUnique = 1;
+        for (IndexT i = 1; i < changed.Size(); i++)
+        {
+            if (changed[i] != changed[numUnique - 1])
+                changed[numUnique++] = changed[i];
+        }
+        changed.Resize(numUnique);
+    }
+
+    for (uint instance : changed)
+        InstanceRangeAppend(outObjectRanges, instance);
+
+    // merge the moved dynamic instances with the changed ones in ascending order
+    IndexT c = 0;
+    for (uint i = 0; i < (uint)moved.Size(); i++)
+    {
+        for (; c < changed.Size() && changed[c] < i; c++)
+            InstanceRangeAppend(outInstanceRanges, changed[c]);
+        if (moved[i])
+            InstanceRangeAppend(outInstanceRanges, i);
+    }
+    for (; c < changed.Size(); c++)
+        InstanceRangeAppend(outInstanceRanges, changed[c]);
+}
+
+} // namespace Raytracing
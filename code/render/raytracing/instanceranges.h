@@ -0,0 +1,32 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file raytracing/instanceranges.h
+
+    Bookkeeping of the ray tracing instance slots which have to be copied to
+    the device in a frame. Kept apart from the RaytracingContext so it can be
+    used and tested without a graphics device.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/types.h"
+#include "util/array.h"
+
+namespace Raytracing
+{
+
+/// a run of consecutive instances
+struct InstanceRange
+{
+    uint first, num;
+};
+
+/// add an instance to a list of ranges, extends the last range if the index follows it, indices must come in ascending order
+void InstanceRangeAppend(Util::Array<InstanceRange>& ranges, const uint index);
+
+/// sort and deduplicate the changed instances, and coalesce them into object ranges and together with the moved instances into instance ranges
+void InstanceRangesCollect(Util::Array<uint>& changed, const Util::Array<bool>& moved, Util::Array<InstanceRange>& outObjectRanges, Util::Array<InstanceRange>& outInstanceRanges);
+
+} // namespace Raytracing
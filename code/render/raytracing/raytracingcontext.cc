@@ -3,6 +3,7 @@
 // (C) 2023 Individual contributors, see AUTHORS file
 //------------------------------------------------------------------------------
 #include "raytracingcontext.h"
+#include "instanceranges.h"
 #include "models/modelcontext.h"
 #include "frame/framesubgraph.h"
 #include "models/nodes/primitivenode.h"
@@ -31,6 +32,7 @@ RaytracingContext::RaytracingAllocator RaytracingContext::raytracingContextAlloc
 __ImplementContext(RaytracingContext, raytracingContextAllocator);
 
 static const uint NUM_GRID_CELLS = 64;
+
 struct
 {
     Threading::CriticalSection blasLock;
@@ -39,7 +41,11 @@ struct
     Util::Array<CoreGraphics::BlasId> blasesToRebuild;
     Util::Array<CoreGraphics::BlasId> blases;
     CoreGraphics::TlasId toplevelAccelerationStructure;
-    Memory::RangeAllocator blasInstanceAllocator;
+    // dynamic instances come first and static ones after them, so the per frame work only covers the dynamic range
+    Memory::RangeAllocator dynamicInstanceAllocator;
+    Memory::RangeAllocator staticInstanceAllocator;
+    SizeT maxDynamicInstances = 0;
+    SizeT numDynamicSlots = 0;
     bool topLevelNeedsReconstruction, topLevelNeedsBuild, topLevelNeedsUpdate;
 
     Util::HashTable<CoreGraphics::MeshId, Util::Tuple<uint, Util::Array<CoreGraphics::BlasId>>> blasLookup;
@@ -51,6 +57,16 @@ struct
     CoreGraphics::BufferWithStaging objectBindingBuffer;
     Util::Array<Raytracetest::TlasInstance> objects;
 
+    // instances which were added or removed since the last upload
+    Util::Array<uint> changedInstances;
+    // context ids of dynamic models, their transforms as last written and which of them moved this frame
+    Util::Array<Ids::Id32> dynamicObjects;
+    Util::Array<Math::mat4> dynamicTransforms;
+    Util::Array<bool> movedInstances;
+    // instances and object bindings to copy from the host buffers this frame
+    Util::Array<InstanceRange> instanceUploads;
+    Util::Array<InstanceRange> objectUploads;
+
     CoreGraphics::BufferId gridBuffer;
     CoreGraphics::BufferId lightGridConstants;
     CoreGraphics::ShaderId lightGridShader;
@@ -68,6 +84,51 @@ struct
 } state;
 
 static uint MaterialPropertyMappings[(uint)MaterialTemplatesGPULang::MaterialProperties::Num];
+
+//------------------------------------------------------------------------------
+/**
+    Allocates instance slots in the range of the update type. New slots,
+    and any slots skipped to get to them, are queued for an upload so the
+    TLAS never sees garbage.
+
+    Assumes the blas lock is held.
+*/
+static Memory::RangeAllocation
+AllocInstances(const UpdateType type, const SizeT num)
+{
+    Memory::RangeAllocation alloc;
+    if (type == UpdateType::Dynamic)
+    {
+        alloc = state.dynamicInstanceAllocator.Alloc(num);
+        n_assert2(alloc.offset != Memory::RangeAllocation::OOM, "Out of dynamic ray tracing instances, raise RaytracingSetupSettings::maxNumAllowedDynamicInstances");
+        const SizeT oldSlots = state.numDynamicSlots;
+        state.numDynamicSlots = Math::max(state.numDynamicSlots, (SizeT)alloc.offset + num);
+        state.dynamicTransforms.Extend(state.numDynamicSlots);
+        state.movedInstances.Fill(oldSlots, state.numDynamicSlots - oldSlots, false);
+    }
+    else
+    {
+        alloc = state.staticInstanceAllocator.Alloc(num);
+        n_assert2(alloc.offset != Memory::RangeAllocation::OOM, "Out of static ray tracing instances");
+        alloc.offset += state.maxDynamicInstances;
+    }
+
+    const SizeT oldSize = state.blasInstances.Size();
+    const SizeT newSize = Math::max(oldSize, (SizeT)alloc.offset + num);
+    state.blasInstances.Extend(newSize);
+    state.blasInstanceMeshes.Extend(newSize);
+    state.objects.Extend(newSize);
+    for (IndexT i = oldSize; i < newSize; i++)
+    {
+        state.blasInstances[i] = CoreGraphics::InvalidBlasInstanceId;
+        state.blasInstanceMeshes[i] = CoreGraphics::InvalidMeshId;
+        state.changedInstances.Append(i);
+    }
+    for (IndexT i = (IndexT)alloc.offset; i < Math::min(oldSize, (SizeT)(alloc.offset + num)); i++)
+        state.changedInstances.Append(i);
+    return alloc;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -210,10 +271,22 @@ RaytracingContext::Create(const RaytracingSetupSettings& settings)
 
     FrameScript_default::RegisterSubgraph_RaytracingStructuresUpdate_Compute([](const CoreGraphics::CmdBufferId cmdBuf, const CoreGraphics::QueueType queue, const Math::rectangle<int>& viewport, const IndexT frame, const IndexT bufferIndex)
     {
-        if (!state.objects.IsEmpty())
-            state.objectBindingBuffer.Flush(cmdBuf, state.objects.ByteSize());
         state.blasLock.Enter();
 
+        // Copy changed object bindings
+        if (!state.objectUploads.IsEmpty())
+        {
+            const CoreGraphics::BufferId hostBuffer = state.objectBindingBuffer.HostBuffer();
+            const CoreGraphics::BufferId deviceBuffer = state.objectBindingBuffer.DeviceBuffer();
+            for (const InstanceRange& range : state.objectUploads)
+            {
+                CoreGraphics::BufferCopy copy;
+                copy.offset = range.first * sizeof(Raytracetest::TlasInstance);
+                CoreGraphics::CmdCopy(cmdBuf, hostBuffer, { copy }, deviceBuffer, { copy }, range.num * sizeof(Raytracetest::TlasInstance));
+            }
+            state.objectUploads.Clear();
+        }
+
         // Update bottom level acceleration structures
         if (state.blasesToRebuild.Size() > 0)
         {
@@ -248,12 +321,20 @@ RaytracingContext::Create(const RaytracingSetupSettings& settings)
             state.blasesToRebuild.Clear();
         }
 
-        // Copy instances from staging to host
-        if (state.numRegisteredInstances > 0)
+        // Copy moved and changed instances from staging to device
+        if (!state.instanceUploads.IsEmpty())
         {
             CoreGraphics::CmdBeginMarker(cmdBuf, NEBULA_MARKER_TRANSFER, "Bottom Level Instance Copy");
-            state.blasInstanceBuffer.Flush(cmdBuf, state.numRegisteredInstances * CoreGraphics::BlasInstanceGetSize());
+            const CoreGraphics::BufferId hostBuffer = state.blasInstanceBuffer.HostBuffer();
+            const SizeT instanceSize = CoreGraphics::BlasInstanceGetSize();
+            for (const InstanceRange& range : state.instanceUploads)
+            {
+                CoreGraphics::BufferCopy copy;
+                copy.offset = range.first * instanceSize;
+                CoreGraphics::CmdCopy(cmdBuf, hostBuffer, { copy }, state.blasInstanceBuffer.deviceBuffer, { copy }, range.num * instanceSize);
+            }
             CoreGraphics::CmdEndMarker(cmdBuf);
+            state.instanceUploads.Clear();
         }
 
         // Update top level acceleration
@@ -275,6 +356,8 @@ RaytracingContext::Create(const RaytracingSetupSettings& settings)
             CoreGraphics::TlasInitBuild(state.toplevelAccelerationStructure);
             CoreGraphics::CmdBuildTlas(cmdBuf, state.toplevelAccelerationStructure);
             CoreGraphics::CmdEndMarker(cmdBuf);
+            state.topLevelNeedsBuild = false;
+            state.topLevelNeedsUpdate = false;
 
             CoreGraphics::CmdBarrier(
                 cmdBuf,
@@ -306,6 +389,7 @@ RaytracingContext::Create(const RaytracingSetupSettings& settings)
             CoreGraphics::TlasInitUpdate(state.toplevelAccelerationStructure);
             CoreGraphics::CmdBuildTlas(cmdBuf, state.toplevelAccelerationStructure);
             CoreGraphics::CmdEndMarker(cmdBuf);
+            state.topLevelNeedsUpdate = false;
 
             CoreGraphics::CmdBarrier(
                 cmdBuf,
@@ -343,9 +427,12 @@ RaytracingContext::Create(const RaytracingSetupSettings& settings)
     });
 
 
+    n_assert(settings.maxNumAllowedDynamicInstances < settings.maxNumAllowedInstances);
     state.maxAllowedInstances = settings.maxNumAllowedInstances;
+    state.maxDynamicInstances = settings.maxNumAllowedDynamicInstances;
     state.topLevelNeedsReconstruction = true;
-    state.blasInstanceAllocator = Memory::RangeAllocator(0xFFFFF, settings.maxNumAllowedInstances);
+    state.dynamicInstanceAllocator = Memory::RangeAllocator(settings.maxNumAllowedDynamicInstances, settings.maxNumAllowedDynamicInstances);
+    state.staticInstanceAllocator = Memory::RangeAllocator(settings.maxNumAllowedInstances - settings.maxNumAllowedDynamicInstances, settings.maxNumAllowedInstances);
 }
 
 //------------------------------------------------------------------------------
@@ -362,7 +449,7 @@ RaytracingContext::Discard()
 /**
 */
 void
-RaytracingContext::SetupModel(const Graphics::GraphicsEntityId id, CoreGraphics::BlasInstanceFlags flags, uchar mask)
+RaytracingContext::SetupModel(const Graphics::GraphicsEntityId id, CoreGraphics::BlasInstanceFlags flags, uchar mask, const UpdateType objectType)
 {
     if (!CoreGraphics::RayTracingSupported)
         return;
@@ -370,11 +457,10 @@ RaytracingContext::SetupModel(const Graphics::GraphicsEntityId id, CoreGraphics:
     Graphics::ContextEntityId contextId = GetContextId(id);
     const Models::NodeInstanceRange& nodes = Models::ModelContext::GetModelRenderableRange(id);
     SizeT numObjects = nodes.end - nodes.begin;
-    n_assert((state.blasInstances.Size() + numObjects) < state.maxAllowedInstances);
-    Memory::RangeAllocation alloc = state.blasInstanceAllocator.Alloc(numObjects);
-    state.blasInstances.Extend((SizeT)alloc.offset + numObjects);
-    state.blasInstanceMeshes.Extend((SizeT)alloc.offset + numObjects);
-    state.objects.Extend((SizeT)alloc.offset + numObjects);
+    state.blasLock.Enter();
+    Memory::RangeAllocation alloc = AllocInstances(objectType, numObjects);
+    if (objectType == UpdateType::Dynamic)
+        state.dynamicObjects.Append(contextId.id);
 
     // Create bogus constants
     for (uint i = 0; i < numObjects; i++)
@@ -388,16 +474,17 @@ RaytracingContext::SetupModel(const Graphics::GraphicsEntityId id, CoreGraphics:
         constants.VertexLayout = (uint)CoreGraphics::VertexLayoutType::Normal;
         state.objects[(uint)alloc.offset + i] = constants;
     }
+    state.blasLock.Leave();
 
     raytracingContextAllocator.Set<Raytracing_Allocation>(contextId.id, alloc);
     raytracingContextAllocator.Set<Raytracing_NumStructures>(contextId.id, numObjects);
-    raytracingContextAllocator.Set<Raytracing_UpdateType>(contextId.id, UpdateType::Dynamic);
+    raytracingContextAllocator.Set<Raytracing_UpdateType>(contextId.id, objectType);
 
     IndexT instanceCounter = 0;
     for (IndexT i = nodes.begin; i < nodes.end; i++)
     {
         Models::PrimitiveNode* pNode = static_cast<Models::PrimitiveNode*>(Models::ModelContext::NodeInstances.renderable.nodes[i]);
-        const auto setupLambda = [flags, mask, offset = alloc.offset, instanceCounter, i, pNode](Resources::ResourceId id)
+        const auto setupLambda = [flags, mask, offset = alloc.offset, objectType, instanceCounter, i, pNode](Resources::ResourceId id)
         {
             Threading::CriticalScope _s(&state.blasLock);
             CoreGraphics::MeshResourceId meshRes = id;
@@ -488,6 +575,9 @@ RaytracingContext::SetupModel(const Graphics::GraphicsEntityId id, CoreGraphics:
             CoreGraphics::BlasIdLock _0(createIntInfo.blas);
             state.blasInstances[instanceIndex] = CoreGraphics::CreateBlasInstance(createIntInfo);
             state.blasInstanceMeshes[instanceIndex] = mesh;
+            if (objectType == UpdateType::Dynamic)
+                state.dynamicTransforms[instanceIndex] = createIntInfo.transform;
+            state.changedInstances.Append(instanceIndex);
 
             state.numRegisteredInstances++;
             state.topLevelNeedsReconstruction = true;
@@ -523,10 +613,7 @@ void RaytracingContext::SetupMesh(
     Graphics::ContextEntityId contextId = GetContextId(id);
 
     state.blasLock.Enter();
-    Memory::RangeAllocation alloc = state.blasInstanceAllocator.Alloc(transforms.Size());
-    state.blasInstances.Extend((uint)alloc.offset + transforms.Size());
-    state.blasInstanceMeshes.Extend((uint)alloc.offset + transforms.Size());
-    state.objects.Extend((uint)alloc.offset + transforms.Size());
+    Memory::RangeAllocation alloc = AllocInstances(objectType, transforms.Size());
 
     raytracingContextAllocator.Set<Raytracing_Allocation>(contextId.id, alloc);
     raytracingContextAllocator.Set<Raytracing_NumStructures>(contextId.id, transforms.Size());
@@ -563,10 +650,8 @@ void RaytracingContext::SetupMesh(
         instanceCreateInfo.transform = transforms[patchCounter];
         state.blasInstances[i] = CoreGraphics::CreateBlasInstance(instanceCreateInfo);
         state.blasInstanceMeshes[i] = CoreGraphics::InvalidMeshId;
-
-        // Update buffer
-        CoreGraphics::BlasInstanceIdLock _1(state.blasInstances[i]);
-        CoreGraphics::BlasInstanceUpdate(state.blasInstances[i], transforms[patchCounter], state.blasInstanceBuffer.HostBuffer(), i * CoreGraphics::BlasInstanceGetSize());
+        if (objectType == UpdateType::Dynamic)
+            state.dynamicTransforms[i] = transforms[patchCounter];
 
         CoreGraphics::BufferIdLock _2(CoreGraphics::GetVertexBuffer());
         CoreGraphics::BufferIdLock _3(CoreGraphics::GetIndexBuffer());
@@ -623,10 +708,6 @@ RaytracingContext::ReconstructTopLevelAcceleration(const Graphics::FrameContext&
         state.topLevelNeedsReconstruction = false;
         state.topLevelNeedsBuild = true;
     }
-    else if (state.toplevelAccelerationStructure != CoreGraphics::InvalidTlasId)
-    {
-        state.topLevelNeedsBuild = true;
-    }
 
     if (state.toplevelAccelerationStructure != CoreGraphics::InvalidTlasId)
     {
@@ -672,19 +753,17 @@ RaytracingContext::UpdateTransforms(const Graphics::FrameContext& ctx)
 
     const Util::Array<Graphics::GraphicsEntityId>& entities = RaytracingContext::__state.entities;
 
-    if (!entities.IsEmpty() && state.toplevelAccelerationStructure != CoreGraphics::InvalidTlasId)
+    if (!state.dynamicObjects.IsEmpty() && state.toplevelAccelerationStructure != CoreGraphics::InvalidTlasId)
     {
-        static Util::Array<uint32_t> nodes;
-        nodes.Clear();
-        nodes.Resize(entities.Size());
-
         static Threading::AtomicCounter idCounter;
         idCounter = 1;
+        state.movedInstances.Fill(0, state.movedInstances.Size(), false);
 
-        // Run job to collect model node ids
+        // Only dynamic models are visited, and only instances which have moved are written
         Jobs2::JobDispatch(
             [
-                ids = entities.Begin()
+                objects = state.dynamicObjects.Begin()
+                , ids = entities.Begin()
             ]
         (SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset) mutable
         {
@@ -696,50 +775,35 @@ RaytracingContext::UpdateTransforms(const Graphics::FrameContext& ctx)
                     return;
 
                 // Get node range and update ids buffer
-                Graphics::GraphicsEntityId gid = ids[index];
-                Graphics::ContextEntityId cid = GetContextId(gid);
-                const UpdateType type = raytracingContextAllocator.Get<Raytracing_UpdateType>(cid.id);
-                const Memory::RangeAllocation alloc = raytracingContextAllocator.Get<Raytracing_Allocation>(cid.id);
-                const SizeT numObjects = raytracingContextAllocator.Get<Raytracing_NumStructures>(cid.id);
+                const Ids::Id32 cid = objects[index];
+                Graphics::GraphicsEntityId gid = ids[cid];
+                const Memory::RangeAllocation alloc = raytracingContextAllocator.Get<Raytracing_Allocation>(cid);
+                const SizeT numObjects = raytracingContextAllocator.Get<Raytracing_NumStructures>(cid);
                 if (numObjects == 0)
                     continue;
 
-                if (type == UpdateType::Static)
-                {
-                    for (IndexT j = 0; j < numObjects; j++)
-                    {
-                        Math::mat4 transform;
-                        CoreGraphics::BlasInstanceIdLock _0(state.blasInstances[(uint)alloc.offset + j]);
-                        CoreGraphics::BlasInstanceUpdate(state.blasInstances[(uint)alloc.offset + j], state.blasInstanceBuffer.HostBuffer(), (alloc.offset + j) * CoreGraphics::BlasInstanceGetSize());
-                    }
-                }
-                else
-                {
-                    const Models::NodeInstanceRange& renderableRange = Models::ModelContext::GetModelRenderableRange(gid);
-                    const Models::NodeInstanceRange& transformableRange = Models::ModelContext::GetModelTransformableRange(gid);
+                const Models::NodeInstanceRange& renderableRange = Models::ModelContext::GetModelRenderableRange(gid);
+                const Models::NodeInstanceRange& transformableRange = Models::ModelContext::GetModelTransformableRange(gid);
 
-                    const Models::ModelContext::ModelInstance::Renderable& renderables = Models::ModelContext::GetModelRenderables();
-                    const Models::ModelContext::ModelInstance::Transformable& transformables = Models::ModelContext::GetModelTransformables();
+                const Models::ModelContext::ModelInstance::Renderable& renderables = Models::ModelContext::GetModelRenderables();
+                const Models::ModelContext::ModelInstance::Transformable& transformables = Models::ModelContext::GetModelTransformables();
 
-                    const uint numNodes = renderableRange.end - renderableRange.begin;
-                    uint counter = 0;
-                    for (IndexT j = renderableRange.begin; j < renderableRange.end; j++)
+                uint counter = 0;
+                for (IndexT j = renderableRange.begin; j < renderableRange.end; j++)
+                {
+                    const Math::mat4& transform = transformables.nodeTransforms[transformableRange.begin + renderables.nodeTransformIndex[j]];
+                    const uint instance = (uint)alloc.offset + counter;
+                    if (state.blasInstances[instance] != CoreGraphics::InvalidBlasInstanceId && state.dynamicTransforms[instance] != transform)
                     {
-                        const Math::mat4& transform = transformables.nodeTransforms[transformableRange.begin + renderables.nodeTransformIndex[j]];
-                        if (state.blasInstances[(uint)alloc.offset + counter] != CoreGraphics::InvalidBlasInstanceId)
-                        {
-                            CoreGraphics::BlasInstanceIdLock _0(state.blasInstances[(uint)alloc.offset + counter]);
-                            CoreGraphics::BlasInstanceUpdate(state.blasInstances[(uint)alloc.offset + counter], transform, state.blasInstanceBuffer.HostBuffer(), (alloc.offset + counter) * CoreGraphics::BlasInstanceGetSize());
-                        }
-                        counter++;
+                        CoreGraphics::BlasInstanceIdLock _0(state.blasInstances[instance]);
+                        CoreGraphics::BlasInstanceUpdate(state.blasInstances[instance], transform, state.blasInstanceBuffer.HostBuffer(), instance * CoreGraphics::BlasInstanceGetSize());
+                        state.dynamicTransforms[instance] = transform;
+                        state.movedInstances[instance] = true;
                     }
+                    counter++;
                 }
             }
-        }, entities.Size(), 1024, { &Models::ModelContext::TransformsUpdateCounter }, &idCounter, &state.jobWaitEvent);
-
-        // Copy over object bindings
-        CoreGraphics::BufferUpdate(state.objectBindingBuffer.HostBuffer(), state.objects.Begin(), state.objects.ByteSize());
-        state.topLevelNeedsUpdate = true;
+        }, state.dynamicObjects.Size(), 256, { &Models::ModelContext::TransformsUpdateCounter }, &idCounter, &state.jobWaitEvent);
     }
     else
     {
@@ -759,6 +823,45 @@ RaytracingContext::WaitForJobs(const Graphics::FrameContext& ctx)
     N_MARKER_BEGIN(WaitForRaytracingJobs, Graphics);
     state.jobWaitEvent.Wait();
     N_MARKER_END();
+
+    CollectUploads();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Writes added and removed instances to the staging buffers and merges
+    them with the instances the transform jobs have moved into ranges to
+    copy. Static instances cost nothing unless they change.
+*/
+void
+RaytracingContext::CollectUploads()
+{
+    N_SCOPE(CollectRaytracingUploads, Graphics);
+    Threading::CriticalScope _s(&state.blasLock);
+    Util::Array<uint>& changed = state.changedInstances;
+    InstanceRangesCollect(changed, state.movedInstances, state.objectUploads, state.instanceUploads);
+
+    const CoreGraphics::BufferId instanceBuffer = state.blasInstanceBuffer.HostBuffer();
+    const CoreGraphics::BufferId objectBuffer = state.objectBindingBuffer.HostBuffer();
+    const SizeT instanceSize = CoreGraphics::BlasInstanceGetSize();
+    for (uint instance : changed)
+    {
+        // removed and not yet set up instances are zeroed, which makes them inactive
+        if (state.blasInstances[instance] != CoreGraphics::InvalidBlasInstanceId)
+        {
+            CoreGraphics::BlasInstanceIdLock _0(state.blasInstances[instance]);
+            CoreGraphics::BlasInstanceUpdate(state.blasInstances[instance], instanceBuffer, instance * instanceSize);
+        }
+        else
+        {
+            memset((char*)CoreGraphics::BufferMap(instanceBuffer) + instance * instanceSize, 0, instanceSize);
+        }
+        CoreGraphics::BufferUpdate(objectBuffer, state.objects[instance], instance * sizeof(Raytracetest::TlasInstance));
+    }
+    changed.Clear();
+
+    if (!state.instanceUploads.IsEmpty() || !state.blasesToRebuild.IsEmpty())
+        state.topLevelNeedsUpdate = true;
 }
 
 //------------------------------------------------------------------------------
@@ -840,6 +943,8 @@ RaytracingContext::Dealloc(Graphics::ContextEntityId id)
     if (!CoreGraphics::RayTracingSupported)
         return;
 
+    Threading::CriticalScope _s(&state.blasLock);
+
     // clean up old stuff, but don't deallocate entity
     Memory::RangeAllocation range = raytracingContextAllocator.Get<Raytracing_Allocation>(id.id);
     SizeT numAllocs = raytracingContextAllocator.Get<Raytracing_NumStructures>(id.id);
@@ -877,11 +982,15 @@ RaytracingContext::Dealloc(Graphics::ContextEntityId id)
                 CoreGraphics::DestroyBlas(blases[j]);
             }
         }
-        for (SizeT j = 0; j < state.blasInstanceBuffer.hostBuffers.buffers.Size(); j++)
-        {
-            CoreGraphics::BlasInstanceUpdate(state.blasInstances[(uint)i], state.blasInstanceBuffer.hostBuffers.buffers[j], i * CoreGraphics::BlasInstanceGetSize());
-        }
         state.blasInstances[i] = CoreGraphics::InvalidBlasInstanceId;
+        state.changedInstances.Append(i);
+    }
+
+    if (raytracingContextAllocator.Get<Raytracing_UpdateType>(id.id) == UpdateType::Dynamic)
+    {
+        IndexT index = state.dynamicObjects.FindIndex(id.id);
+        if (index != InvalidIndex)
+            state.dynamicObjects.EraseIndexSwap(index);
     }
 
     raytracingContextAllocator.Dealloc(id.id);
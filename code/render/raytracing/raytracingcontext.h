@@ -19,6 +19,8 @@ namespace Raytracing
 struct RaytracingSetupSettings
 {
     SizeT maxNumAllowedInstances;
+    /// dynamic instances are kept in their own range at the start of the instance buffer
+    SizeT maxNumAllowedDynamicInstances = 0x1000;
 };
 
 enum ObjectType
@@ -49,8 +51,8 @@ public:
     ///
     static void Discard();
 
-    /// Setup a model entity for ray tracing, assumes model context registration
-    static void SetupModel(const Graphics::GraphicsEntityId id, CoreGraphics::BlasInstanceFlags flags, uchar mask);
+    /// Setup a model entity for ray tracing, assumes model context registration, static models never update their instances
+    static void SetupModel(const Graphics::GraphicsEntityId id, CoreGraphics::BlasInstanceFlags flags, uchar mask, const UpdateType objectType = UpdateType::Dynamic);
     /// Setup a terrain system for ray tracing
     static void SetupMesh(
         const Graphics::GraphicsEntityId id
@@ -99,6 +101,8 @@ private:
     static Graphics::ContextEntityId Alloc();
     /// deallocate a slice
     static void Dealloc(Graphics::ContextEntityId id);
+    /// write changed instances to the staging buffers and gather the ranges to upload
+    static void CollectUploads();
 
 
 
@@ -16,6 +16,7 @@
 
 #include "lighting/lightcontext.h"
 #include "raytracing/raytracingcontext.h"
+#include "terrainheightloader.h"
 
 #include "resources/resourceserver.h"
 #include "materials/materialloader.h"
@@ -182,6 +183,11 @@ TerrainContext::Create()
 #endif
     Graphics::GraphicsServer::Instance()->RegisterGraphicsContext(&__bundle, &__state);
 
+    // heightmaps are dds files, which the texture loader owns, so the CPU side loader is registered under its own extension and reached by type
+    Resources::ResourceServer* resourceServer = Resources::ResourceServer::Instance();
+    if (!resourceServer->HasStreamLoader("theight"))
+        resourceServer->RegisterStreamLoader("theight", TerrainHeightLoader::RTTI);
+
     terrainState.updateShadowMap = true;
     terrainState.cachedSunDirection = Math::vec4(0);
 
@@ -1550,6 +1556,14 @@ TerrainContext::SetupTerrain(
     }, nullptr, false, false);
     runtimeInfo.decisionMap = TextureId(runtimeInfo.decisionMapResource);
 
+    // CPU side copy of the heightmap for gameplay queries, read and built on the loader thread
+    TerrainHeightLoadInfo heightInfo{ createInfo.minHeight, createInfo.maxHeight, createInfo.width, createInfo.height };
+    TerrainHeightLoader* heightLoader = Resources::GetStreamLoader<TerrainHeightLoader>();
+    runtimeInfo.heightQueryResource = heightLoader->CreateResource(createInfo.heightMap, &heightInfo, sizeof(heightInfo), "terrain"_atm, [&runtimeInfo](Resources::ResourceId id)
+    {
+        runtimeInfo.heightQueryResource = id;
+    }, nullptr, false, false);
+
     runtimeInfo.heightMapResource = Resources::CreateResource(createInfo.heightMap, "terrain"_atm, [&runtimeInfo, numVertsX, numVertsY](Resources::ResourceId id)
     {
         Threading::CriticalScope scope(&terrainState.syncPoint);
@@ -2490,6 +2504,33 @@ TerrainContext::SetVisible(bool visible)
     terrainState.renderToggle = visible;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+const TerrainHeightQuery*
+TerrainContext::GetHeightQuery(const Graphics::GraphicsEntityId entity)
+{
+    const Graphics::ContextEntityId cid = GetContextId(entity);
+    const Resources::ResourceId res = terrainAllocator.Get<Terrain_RuntimeInfo>(cid.id).heightQueryResource;
+    TerrainHeightLoader* loader = Resources::GetStreamLoader<TerrainHeightLoader>();
+    if (res == Resources::InvalidResourceId || loader->GetState(res) != Resources::Resource::Loaded)
+        return nullptr;
+    return loader->GetHeightQuery(res);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Resources::Resource::State
+TerrainContext::GetHeightQueryState(const Graphics::GraphicsEntityId entity)
+{
+    const Graphics::ContextEntityId cid = GetContextId(entity);
+    const Resources::ResourceId res = terrainAllocator.Get<Terrain_RuntimeInfo>(cid.id).heightQueryResource;
+    if (res == Resources::InvalidResourceId)
+        return Resources::Resource::Unloaded;
+    return Resources::GetStreamLoader<TerrainHeightLoader>()->GetState(res);
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -2840,6 +2881,10 @@ TerrainContext::Alloc()
 void
 TerrainContext::Dealloc(Graphics::ContextEntityId id)
 {
+    TerrainRuntimeInfo& runtimeInfo = terrainAllocator.Get<Terrain_RuntimeInfo>(id.id);
+    if (runtimeInfo.heightQueryResource != Resources::InvalidResourceId)
+        Resources::DiscardResource(runtimeInfo.heightQueryResource);
+    runtimeInfo.heightQueryResource = Resources::InvalidResourceId;
     terrainAllocator.Dealloc(id.id);
 }
 
@@ -9,6 +9,7 @@
 //------------------------------------------------------------------------------
 #include "graphics/graphicscontext.h"
 #include "resources/resourceid.h"
+#include "resources/resource.h"
 #include "math/bbox.h"
 #include "coregraphics/primitivegroup.h"
 #include "coregraphics/texture.h"
@@ -17,6 +18,7 @@
 
 #include "occupancyquadtree.h"
 #include "texturetilecache.h"
+#include "terrainheightquery.h"
 
 #include "jobs/jobs.h"
 
@@ -294,6 +296,11 @@ public:
     /// 
     static bool GetVisible();
 
+    /// get the CPU height and ray queries of a terrain, nullptr until its heightmap is loaded
+    static const TerrainHeightQuery* GetHeightQuery(const Graphics::GraphicsEntityId entity);
+    /// get the load state of the CPU heightmap, Failed if it can't be read
+    static Resources::Resource::State GetHeightQueryState(const Graphics::GraphicsEntityId entity);
+
 #ifndef PUBLIC_DEBUG    
     /// debug rendering
     static void OnRenderDebug(uint32_t flags);
@@ -345,6 +352,7 @@ private:
         uint loadBits;
         uint lowresGenerated;
         bool enableRayTracing;
+        Resources::ResourceId heightQueryResource = Resources::InvalidResourceId;
 
         Util::FixedArray<CoreGraphics::ResourceTableId> patchTables;
         CoreGraphics::BufferId vbo;
@@ -0,0 +1,142 @@
+//------------------------------------------------------------------------------
+//  terrainheightloader.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "terrainheightloader.h"
+#include "coregraphics/load/glimltypes.h"
+
+namespace Terrain
+{
+
+__ImplementClass(Terrain::TerrainHeightLoader, 'TRHL', Resources::ResourceLoader);
+
+//------------------------------------------------------------------------------
+/**
+*/
+TerrainHeightLoader::TerrainHeightLoader()
+{
+    this->async = true;
+    this->streamerThreadName = "Terrain Height Streamer Thread";
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+TerrainHeightLoader::~TerrainHeightLoader()
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+const TerrainHeightQuery*
+TerrainHeightLoader::GetHeightQuery(const Resources::ResourceId id)
+{
+    __LockName(&this->allocator, lock, id.resourceId);
+    return this->allocator.Get<0>(id.resourceId);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Resources::ResourceLoader::ResourceInitOutput
+TerrainHeightLoader::InitializeResource(const ResourceLoadJob& job, const Ptr<IO::Stream>& stream)
+{
+    Resources::ResourceLoader::ResourceInitOutput ret;
+    if (job.metadata.data == nullptr || job.metadata.size != sizeof(TerrainHeightLoadInfo))
+    {
+        n_warning("TerrainHeightLoader: '%s' has to be loaded with a TerrainHeightLoadInfo\n", job.name.AsCharPtr());
+        return ret;
+    }
+    const TerrainHeightLoadInfo& info = *(const TerrainHeightLoadInfo*)job.metadata.data;
+
+    Util::Array<uint16_t> samples;
+    SizeT width, height;
+    if (!ReadSamples(stream, samples, width, height))
+    {
+        n_warning("TerrainHeightLoader: '%s' has to be an R16, R8 or R32F DDS of at least 2x2 texels\n", job.name.AsCharPtr());
+        return ret;
+    }
+
+    TerrainHeightQuery* query = new TerrainHeightQuery;
+    query->Setup(samples.Begin(), width, height, info.minHeight, info.maxHeight, info.worldWidth, info.worldHeight);
+
+    Ids::Id32 id = this->allocator.Alloc();
+    this->allocator.Set<0>(id, query);
+    this->allocator.Release(id);
+
+    ret.id = id;
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TerrainHeightLoader::Unload(const Resources::ResourceId id)
+{
+    TerrainHeightQuery* query;
+    {
+        __LockName(&this->allocator, lock, id.resourceId);
+        query = this->allocator.Get<0>(id.resourceId);
+        this->allocator.Set<0>(id.resourceId, nullptr);
+    }
+    delete query;
+
+    this->allocator.Dealloc(id.resourceId);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Samples of 8 bit and float heightmaps are scaled to the 16 bit range.
+    Returns false if the stream isn't a DDS, has another format or is
+    smaller than 2x2.
+*/
+bool
+TerrainHeightLoader::ReadSamples(const Ptr<IO::Stream>& stream, Util::Array<uint16_t>& outSamples, SizeT& outWidth, SizeT& outHeight)
+{
+    void* fileData = stream->MemoryMap();
+    gliml::context ctx;
+    if (fileData == nullptr || !ctx.load_dds(fileData, stream->GetSize()))
+    {
+        stream->MemoryUnmap();
+        return false;
+    }
+
+    outWidth = ctx.image_width(0, 0);
+    outHeight = ctx.image_height(0, 0);
+    const SizeT num = outWidth * outHeight;
+    outSamples.Clear();
+    outSamples.Reserve(num);
+    switch (CoreGraphics::Gliml::ToPixelFormat(ctx))
+    {
+        case CoreGraphics::PixelFormat::R16:
+        {
+            const uint16_t* src = (const uint16_t*)ctx.image_data(0, 0);
+            outSamples.AppendArray(src, num);
+            break;
+        }
+        case CoreGraphics::PixelFormat::R8:
+        {
+            const uint8_t* src = (const uint8_t*)ctx.image_data(0, 0);
+            for (IndexT i = 0; i < num; i++)
+                outSamples.Append(uint16_t(src[i] * 257));
+            break;
+        }
+        case CoreGraphics::PixelFormat::R32F:
+        {
+            const float* src = (const float*)ctx.image_data(0, 0);
+            for (IndexT i = 0; i < num; i++)
+                outSamples.Append(uint16_t(Math::clamp(src[i], 0.0f, 1.0f) * 65535.0f + 0.5f));
+            break;
+        }
+        default:
+            break;
+    }
+    stream->MemoryUnmap();
+
+    return outSamples.Size() == num && outWidth >= 2 && outHeight >= 2;
+}
+
+} // namespace Terrain
@@ -0,0 +1,59 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Terrain::TerrainHeightLoader
+
+    Resource loader for the CPU side heightmaps of terrains.
+
+    Reads an R16, R8 or R32F DDS heightmap on the loader thread and builds a
+    TerrainHeightQuery from it. The dds extension belongs to the texture
+    loader, so terrains reach this loader through GetStreamLoader() and pass
+    the terrain dimensions as a TerrainHeightLoadInfo. Samples of 8 bit and
+    float heightmaps are scaled to the 16 bit range, so every format maps to
+    the same min and max height.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "resources/resourceloader.h"
+#include "ids/idallocator.h"
+#include "terrainheightquery.h"
+
+namespace Terrain
+{
+
+/// dimensions of the terrain a heightmap is loaded for
+struct TerrainHeightLoadInfo
+{
+    float minHeight;
+    float maxHeight;
+    float worldWidth;
+    float worldHeight;
+};
+
+class TerrainHeightLoader : public Resources::ResourceLoader
+{
+    __DeclareClass(TerrainHeightLoader);
+public:
+    /// constructor
+    TerrainHeightLoader();
+    /// destructor
+    virtual ~TerrainHeightLoader();
+
+    /// get the query of a loaded heightmap
+    const TerrainHeightQuery* GetHeightQuery(const Resources::ResourceId id);
+
+    /// decode a DDS heightmap from an open stream into 16 bit samples, also used by the toolkit
+    static bool ReadSamples(const Ptr<IO::Stream>& stream, Util::Array<uint16_t>& outSamples, SizeT& outWidth, SizeT& outHeight);
+
+private:
+    /// read heightmap and build the query, called on the loader thread
+    ResourceLoader::ResourceInitOutput InitializeResource(const ResourceLoadJob& job, const Ptr<IO::Stream>& stream) override;
+    /// unload heightmap
+    void Unload(const Resources::ResourceId id) override;
+
+    Ids::IdAllocatorSafe<0xFF, TerrainHeightQuery*> allocator;
+};
+
+} // namespace Terrain
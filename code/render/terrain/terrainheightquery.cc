@@ -0,0 +1,573 @@
+//------------------------------------------------------------------------------
+//  terrainheightquery.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "terrainheightquery.h"
+#include "profiling/profiling.h"
+#include "threading/event.h"
+
+namespace Terrain
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+TerrainHeightQuery::TerrainHeightQuery() :
+    minHeight(0.0f),
+    heightScale(0.0f),
+    worldWidth(0.0f),
+    worldHeight(0.0f),
+    cellSizeX(0.0f),
+    cellSizeZ(0.0f),
+    originX(0.0f),
+    originZ(0.0f),
+    width(0),
+    height(0),
+    tilesX(0),
+    tilesZ(0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+TerrainHeightQuery::~TerrainHeightQuery()
+{
+    this->Discard();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TerrainHeightQuery::Setup(const uint16_t* samples, SizeT width, SizeT height, float minHeight, float maxHeight, float worldWidth, float worldHeight)
+{
+    N_SCOPE(TerrainHeightQueryBuild, Terrain);
+    n_assert(width > 1 && height > 1);
+
+    // the outermost samples are repeated once around the heightmap, so heights and rays between
+    // the terrain edge and the outermost sample centers see the clamped edge, like the shaders do
+    this->width = width + 2;
+    this->height = height + 2;
+    this->minHeight = minHeight;
+    this->heightScale = (maxHeight - minHeight) / 65535.0f;
+    this->worldWidth = worldWidth;
+    this->worldHeight = worldHeight;
+    this->cellSizeX = worldWidth / width;
+    this->cellSizeZ = worldHeight / height;
+    this->originX = -worldWidth * 0.5f - this->cellSizeX * 0.5f;
+    this->originZ = -worldHeight * 0.5f - this->cellSizeZ * 0.5f;
+
+    const int cellsX = this->width - 1;
+    const int cellsZ = this->height - 1;
+    this->tilesX = (cellsX + TileCells - 1) / TileCells;
+    this->tilesZ = (cellsZ + TileCells - 1) / TileCells;
+    this->tiles.Clear();
+    this->tiles.Reserve(this->tilesX * this->tilesZ);
+    this->data.Clear();
+
+    // compress every tile, samples past the edge of the heightmap repeat the outermost ones
+    uint16_t tileSamples[TileSamples * TileSamples];
+    for (int tz = 0; tz < this->tilesZ; tz++)
+    {
+        for (int tx = 0; tx < this->tilesX; tx++)
+        {
+            Tile tile;
+            tile.minHeight = 0xFFFF;
+            tile.maxHeight = 0;
+            for (int z = 0; z < TileSamples; z++)
+            {
+                const int sz = Math::clamp(tz * TileCells + z - 1, 0, (int)height - 1);
+                for (int x = 0; x < TileSamples; x++)
+                {
+                    const int sx = Math::clamp(tx * TileCells + x - 1, 0, (int)width - 1);
+                    const uint16_t sample = samples[sz * width + sx];
+                    tileSamples[z * TileSamples + x] = sample;
+                    tile.minHeight = Math::min(tile.minHeight, sample);
+                    tile.maxHeight = Math::max(tile.maxHeight, sample);
+                }
+            }
+
+            tile.wide = tile.maxHeight - tile.minHeight > 0xFF;
+            if (tile.wide)
+            {
+                // keep 16 bit tiles aligned
+                if (this->data.Size() & 1)
+                    this->data.Append(0);
+                tile.offset = this->data.Size();
+                this->data.Extend(this->data.Size() + TileSamples * TileSamples * sizeof(uint16_t));
+                uint16_t* dst = (uint16_t*)(this->data.Begin() + tile.offset);
+                for (IndexT i = 0; i < TileSamples * TileSamples; i++)
+                    dst[i] = tileSamples[i] - tile.minHeight;
+            }
+            else
+            {
+                tile.offset = this->data.Size();
+                for (IndexT i = 0; i < TileSamples * TileSamples; i++)
+                    this->data.Append(uint8_t(tileSamples[i] - tile.minHeight));
+            }
+            this->tiles.Append(tile);
+        }
+    }
+
+    // build the pyramid, level 0 is the tiles themselves
+    this->levels.Clear();
+    Level base;
+    base.sizeX = this->tilesX;
+    base.sizeZ = this->tilesZ;
+    for (const Tile& tile : this->tiles)
+    {
+        base.minHeights.Append(tile.minHeight);
+        base.maxHeights.Append(tile.maxHeight);
+    }
+    this->levels.Append(base);
+    while (this->levels.Back().sizeX > 1 || this->levels.Back().sizeZ > 1)
+    {
+        const Level& below = this->levels.Back();
+        Level level;
+        level.sizeX = (below.sizeX + 1) / 2;
+        level.sizeZ = (below.sizeZ + 1) / 2;
+        level.minHeights.Reserve(level.sizeX * level.sizeZ);
+        level.maxHeights.Reserve(level.sizeX * level.sizeZ);
+        for (int z = 0; z < level.sizeZ; z++)
+        {
+            for (int x = 0; x < level.sizeX; x++)
+            {
+                uint16_t lo = 0xFFFF, hi = 0;
+                for (int cz = z * 2; cz < Math::min(z * 2 + 2, below.sizeZ); cz++)
+                {
+                    for (int cx = x * 2; cx < Math::min(x * 2 + 2, below.sizeX); cx++)
+                    {
+                        lo = Math::min(lo, below.minHeights[cz * below.sizeX + cx]);
+                        hi = Math::max(hi, below.maxHeights[cz * below.sizeX + cx]);
+                    }
+                }
+                level.minHeights.Append(lo);
+                level.maxHeights.Append(hi);
+            }
+        }
+        this->levels.Append(level);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TerrainHeightQuery::Discard()
+{
+    this->tiles.Clear();
+    this->data.Clear();
+    this->levels.Clear();
+    this->width = this->height = 0;
+    this->tilesX = this->tilesZ = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+TerrainHeightQuery::IsReady() const
+{
+    return !this->levels.IsEmpty();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint
+TerrainHeightQuery::Sample(int x, int z) const
+{
+    const int tx = Math::min(x / TileCells, this->tilesX - 1);
+    const int tz = Math::min(z / TileCells, this->tilesZ - 1);
+    const Tile& tile = this->tiles[tz * this->tilesX + tx];
+    const IndexT i = (z - tz * TileCells) * TileSamples + (x - tx * TileCells);
+    if (tile.wide)
+        return tile.minHeight + ((const uint16_t*)(this->data.Begin() + tile.offset))[i];
+    else
+        return tile.minHeight + this->data[tile.offset + i];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TerrainHeightQuery::GetCell(int cellX, int cellZ, float& h00, float& h10, float& h01, float& h11) const
+{
+    h00 = this->minHeight + this->Sample(cellX, cellZ) * this->heightScale;
+    h10 = this->minHeight + this->Sample(cellX + 1, cellZ) * this->heightScale;
+    h01 = this->minHeight + this->Sample(cellX, cellZ + 1) * this->heightScale;
+    h11 = this->minHeight + this->Sample(cellX + 1, cellZ + 1) * this->heightScale;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+TerrainHeightQuery::GetHeight(float x, float z, float& outHeight) const
+{
+    Math::vector normal;
+    return this->GetHeight(x, z, outHeight, normal);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Positions between the terrain edge and the outermost sample centers
+    get the height of the edge, like clamped texture sampling.
+*/
+bool
+TerrainHeightQuery::GetHeight(float x, float z, float& outHeight, Math::vector& outNormal) const
+{
+    if (!this->IsReady())
+        return false;
+    if (x < -this->worldWidth * 0.5f || x > this->worldWidth * 0.5f || z < -this->worldHeight * 0.5f || z > this->worldHeight * 0.5f)
+        return false;
+
+    const float px = Math::clamp((x - this->originX) / this->cellSizeX, 0.0f, float(this->width - 1));
+    const float pz = Math::clamp((z - this->originZ) / this->cellSizeZ, 0.0f, float(this->height - 1));
+    const int cx = Math::min((int)px, this->width - 2);
+    const int cz = Math::min((int)pz, this->height - 2);
+    const float fx = px - cx;
+    const float fz = pz - cz;
+
+    float h00, h10, h01, h11;
+    this->GetCell(cx, cz, h00, h10, h01, h11);
+    const float f1 = h10 - h00;
+    const float g = h01 - h00;
+    const float k = h11 - h10 - h01 + h00;
+    outHeight = h00 + f1 * fx + g * fz + k * fx * fz;
+
+    const float dx = (f1 + k * fz) / this->cellSizeX;
+    const float dz = (g + k * fx) / this->cellSizeZ;
+    outNormal = Math::normalize(Math::vector(-dx, 1.0f, -dz));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TerrainHeightQuery::GetNodeBounds(int level, int x, int z, Math::vec3& outMin, Math::vec3& outMax) const
+{
+    const Level& l = this->levels[level];
+    const int cellX0 = (x << level) * TileCells;
+    const int cellZ0 = (z << level) * TileCells;
+    const int cellX1 = Math::min(((x + 1) << level) * TileCells, this->width - 1);
+    const int cellZ1 = Math::min(((z + 1) << level) * TileCells, this->height - 1);
+    const IndexT i = z * l.sizeX + x;
+    outMin = Math::vec3(this->originX + cellX0 * this->cellSizeX, this->minHeight + l.minHeights[i] * this->heightScale, this->originZ + cellZ0 * this->cellSizeZ);
+    outMax = Math::vec3(this->originX + cellX1 * this->cellSizeX, this->minHeight + l.maxHeights[i] * this->heightScale, this->originZ + cellZ1 * this->cellSizeZ);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static bool
+IntersectBox(const Math::vec3& origin, const Math::vec3& invDir, const Math::vec3& bmin, const Math::vec3& bmax, float tMin, float tMax, float& outT0, float& outT1)
+{
+    float t0 = tMin, t1 = tMax;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float a = (bmin[axis] - origin[axis]) * invDir[axis];
+        float b = (bmax[axis] - origin[axis]) * invDir[axis];
+        if (a > b)
+        {
+            float tmp = a;
+            a = b;
+            b = tmp;
+        }
+        t0 = Math::max(t0, a);
+        t1 = Math::min(t1, b);
+        if (t0 > t1)
+            return false;
+    }
+    outT0 = t0;
+    outT1 = t1;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Walks the cells the ray passes over and rejects a cell if the ray stays
+    above its highest corner. Otherwise the ray is put into the bilinear
+    patch of the cell,
+
+        H = h00 + f1 * fx + g * fz + k * fx * fz
+
+    with fx and fz linear in t, which leaves a quadratic in t.
+*/
+bool
+TerrainHeightQuery::RaycastTile(int tileX, int tileZ, const Math::vec3& origin, const Math::vec3& dir, float tStart, float tEnd, float& outT) const
+{
+    const int cellX0 = tileX * TileCells;
+    const int cellZ0 = tileZ * TileCells;
+    const int cellX1 = Math::min(cellX0 + TileCells, this->width - 1);
+    const int cellZ1 = Math::min(cellZ0 + TileCells, this->height - 1);
+
+    // find the cell the ray enters the tile in
+    const float enterX = origin.x + dir.x * tStart;
+    const float enterZ = origin.z + dir.z * tStart;
+    int cx = Math::clamp((int)Math::floor((enterX - this->originX) / this->cellSizeX), cellX0, cellX1 - 1);
+    int cz = Math::clamp((int)Math::floor((enterZ - this->originZ) / this->cellSizeZ), cellZ0, cellZ1 - 1);
+
+    const int stepX = dir.x >= 0.0f ? 1 : -1;
+    const int stepZ = dir.z >= 0.0f ? 1 : -1;
+    const float tDeltaX = dir.x != 0.0f ? this->cellSizeX / Math::abs(dir.x) : FLT_MAX;
+    const float tDeltaZ = dir.z != 0.0f ? this->cellSizeZ / Math::abs(dir.z) : FLT_MAX;
+    float tNextX = dir.x != 0.0f ? (this->originX + (cx + (stepX > 0 ? 1 : 0)) * this->cellSizeX - origin.x) / dir.x : FLT_MAX;
+    float tNextZ = dir.z != 0.0f ? (this->originZ + (cz + (stepZ > 0 ? 1 : 0)) * this->cellSizeZ - origin.z) / dir.z : FLT_MAX;
+
+    float t = tStart;
+    while (true)
+    {
+        const float tExit = Math::min(Math::min(tNextX, tNextZ), tEnd);
+
+        float h00, h10, h01, h11;
+        this->GetCell(cx, cz, h00, h10, h01, h11);
+        const float cellMax = Math::max(Math::max(h00, h10), Math::max(h01, h11));
+        const float y0 = origin.y + dir.y * t;
+        const float y1 = origin.y + dir.y * tExit;
+        if (Math::min(y0, y1) <= cellMax)
+        {
+            const float a = (origin.x - (this->originX + cx * this->cellSizeX)) / this->cellSizeX;
+            const float b = dir.x / this->cellSizeX;
+            const float c = (origin.z - (this->originZ + cz * this->cellSizeZ)) / this->cellSizeZ;
+            const float d = dir.z / this->cellSizeZ;
+            const float f1 = h10 - h00;
+            const float g = h01 - h00;
+            const float k = h11 - h10 - h01 + h00;
+
+            // ray height minus patch height, A t^2 + B t + C
+            const float A = -k * b * d;
+            const float B = dir.y - (f1 * b + g * d + k * (a * d + b * c));
+            const float C = origin.y - (h00 + f1 * a + g * c + k * a * c);
+
+            // already below the surface where the ray enters the cell
+            if ((A * t + B) * t + C <= 0.0f)
+            {
+                outT = t;
+                return true;
+            }
+
+            float root = FLT_MAX;
+            if (Math::abs(A) < 1e-9f)
+            {
+                if (B != 0.0f)
+                    root = -C / B;
+            }
+            else
+            {
+                const float disc = B * B - 4.0f * A * C;
+                if (disc >= 0.0f)
+                {
+                    const float sq = Math::sqrt(disc);
+                    float r0 = (-B - sq) / (2.0f * A);
+                    float r1 = (-B + sq) / (2.0f * A);
+                    if (r0 > r1)
+                    {
+                        float tmp = r0;
+                        r0 = r1;
+                        r1 = tmp;
+                    }
+                    root = r0 >= t ? r0 : r1;
+                }
+            }
+            if (root >= t && root <= tExit)
+            {
+                outT = root;
+                return true;
+            }
+        }
+
+        if (tExit >= tEnd)
+            break;
+        t = tExit;
+        if (tNextX < tNextZ)
+        {
+            cx += stepX;
+            tNextX += tDeltaX;
+            if (cx < cellX0 || cx >= cellX1)
+                break;
+        }
+        else
+        {
+            cz += stepZ;
+            tNextZ += tDeltaZ;
+            if (cz < cellZ0 || cz >= cellZ1)
+                break;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+TerrainHeightQuery::Raycast(const TerrainRay& ray, TerrainRayHit& outHit) const
+{
+    outHit.hit = false;
+    if (!this->IsReady())
+        return false;
+
+    const Math::vec3 origin = xyz(ray.origin);
+    const Math::vector direction = Math::normalize(ray.direction);
+    const Math::vec3 dir(direction.x, direction.y, direction.z);
+    Math::vec3 invDir;
+    for (int axis = 0; axis < 3; axis++)
+        invDir[axis] = 1.0f / (Math::abs(dir[axis]) > 1e-9f ? dir[axis] : (dir[axis] < 0.0f ? -1e-9f : 1e-9f));
+
+    struct Entry
+    {
+        int level, x, z;
+        float t0, t1;
+    };
+    Entry stack[64 * 3 + 1];
+    int top = 0;
+
+    float best = ray.maxDistance;
+    bool hit = false;
+    Math::vec3 bmin, bmax;
+    const int rootLevel = this->levels.Size() - 1;
+    this->GetNodeBounds(rootLevel, 0, 0, bmin, bmax);
+
+    // the repeated border samples reach half a cell past the terrain edge, which is cut off here
+    bmin.x = -this->worldWidth * 0.5f;
+    bmin.z = -this->worldHeight * 0.5f;
+    bmax.x = this->worldWidth * 0.5f;
+    bmax.z = this->worldHeight * 0.5f;
+    float t0, t1;
+    if (IntersectBox(origin, invDir, bmin, bmax, 0.0f, best, t0, t1))
+        stack[top++] = { rootLevel, 0, 0, t0, t1 };
+
+    while (top > 0)
+    {
+        const Entry e = stack[--top];
+        if (e.t0 > best)
+            continue;
+
+        if (e.level == 0)
+        {
+            float t;
+            if (this->RaycastTile(e.x, e.z, origin, dir, e.t0, Math::min(e.t1, best), t))
+            {
+                best = t;
+                hit = true;
+            }
+            continue;
+        }
+
+        // push the children far to near, so the nearest is searched first
+        Entry children[4];
+        int numChildren = 0;
+        const Level& below = this->levels[e.level - 1];
+        for (int cz = e.z * 2; cz < Math::min(e.z * 2 + 2, below.sizeZ); cz++)
+        {
+            for (int cx = e.x * 2; cx < Math::min(e.x * 2 + 2, below.sizeX); cx++)
+            {
+                this->GetNodeBounds(e.level - 1, cx, cz, bmin, bmax);
+                if (IntersectBox(origin, invDir, bmin, bmax, e.t0, Math::min(e.t1, best), t0, t1))
+                {
+                    Entry child = { e.level - 1, cx, cz, t0, t1 };
+                    int i = numChildren++;
+                    while (i > 0 && children[i - 1].t0 < child.t0)
+                    {
+                        children[i] = children[i - 1];
+                        i--;
+                    }
+                    children[i] = child;
+                }
+            }
+        }
+        for (int i = 0; i < numChildren; i++)
+            stack[top++] = children[i];
+    }
+
+    if (hit)
+    {
+        const Math::vec3 pos = origin + dir * best;
+        float h;
+        this->GetHeight(pos.x, pos.z, h, outHit.normal);
+        outHit.position = Math::point(pos.x, pos.y, pos.z);
+        outHit.distance = best;
+        outHit.hit = true;
+    }
+    return hit;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TerrainHeightQuery::GetHeights(const Math::vec2* positions, float* outHeights, SizeT num) const
+{
+    N_SCOPE(TerrainGetHeights, Terrain);
+    if (num <= (SizeT)BatchSize || Jobs2::ctx.threads.Size() == 0)
+    {
+        for (IndexT i = 0; i < num; i++)
+        {
+            if (!this->GetHeight(positions[i].x, positions[i].y, outHeights[i]))
+                outHeights[i] = this->minHeight;
+        }
+        return;
+    }
+
+    Threading::Event done;
+    Jobs2::JobDispatch(
+        [this, positions, outHeights](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+        {
+            N_SCOPE(TerrainGetHeightsJob, Terrain);
+            for (IndexT i = 0; i < groupSize; i++)
+            {
+                IndexT const index = i + invocationOffset;
+                if (index >= totalJobs)
+                    return;
+                if (!this->GetHeight(positions[index].x, positions[index].y, outHeights[index]))
+                    outHeights[index] = this->minHeight;
+            }
+        },
+        num,
+        BatchSize,
+        nullptr,
+        nullptr,
+        &done);
+    done.Wait();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TerrainHeightQuery::Raycast(const TerrainRay* rays, TerrainRayHit* outHits, SizeT num) const
+{
+    N_SCOPE(TerrainRaycasts, Terrain);
+    if (num <= (SizeT)BatchSize || Jobs2::ctx.threads.Size() == 0)
+    {
+        for (IndexT i = 0; i < num; i++)
+            this->Raycast(rays[i], outHits[i]);
+        return;
+    }
+
+    Threading::Event done;
+    Jobs2::JobDispatch(
+        [this, rays, outHits](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+        {
+            N_SCOPE(TerrainRaycastsJob, Terrain);
+            for (IndexT i = 0; i < groupSize; i++)
+            {
+                IndexT const index = i + invocationOffset;
+                if (index >= totalJobs)
+                    return;
+                this->Raycast(rays[index], outHits[index]);
+            }
+        },
+        num,
+        BatchSize,
+        nullptr,
+        nullptr,
+        &done);
+    done.Wait();
+}
+
+} // namespace Terrain
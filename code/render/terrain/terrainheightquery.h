@@ -0,0 +1,145 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Terrain::TerrainHeightQuery
+
+    Answers height and ray queries against a terrain on the CPU, without
+    touching the GPU heightmap.
+
+    The heightmap is split into tiles of TileCells x TileCells cells. Every
+    tile keeps its own samples, including the shared border row and column,
+    as offsets from the lowest sample of the tile, in 8 bits if the tile is
+    flat enough and in 16 bits otherwise, so the compression is lossless.
+    On top of the tiles sits a min/max pyramid, every level merging 2x2
+    nodes of the level below, up to a single root.
+
+    Heights are interpolated bilinearly between sample centers, the same way
+    the terrain shaders sample the heightmap. Rays descend the pyramid near
+    nodes first, skipping nodes they pass over, and walk the cells of the
+    tiles they enter, where the bilinear patch of a cell is intersected
+    exactly.
+
+    Setup() builds the tiles from samples in memory. Terrains get their
+    query from TerrainHeightLoader, which reads the heightmap and calls
+    Setup() on the resource loader thread. The batch functions spread big
+    batches over the job threads and wait for them.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/types.h"
+#include "util/array.h"
+#include "math/point.h"
+#include "math/vector.h"
+#include "math/vec2.h"
+#include "jobs2/jobs2.h"
+
+namespace Terrain
+{
+
+/// a ray to shoot at the terrain
+struct TerrainRay
+{
+    Math::point origin;
+    Math::vector direction;
+    float maxDistance = 1000.0f;
+};
+
+/// where a ray hit the terrain
+struct TerrainRayHit
+{
+    Math::point position;
+    Math::vector normal;
+    float distance = 0.0f;
+    bool hit = false;
+};
+
+class TerrainHeightQuery
+{
+public:
+    /// constructor
+    TerrainHeightQuery();
+    /// destructor
+    ~TerrainHeightQuery();
+
+    /// build the tiles from 16 bit samples, row by row along z
+    void Setup(const uint16_t* samples, SizeT width, SizeT height, float minHeight, float maxHeight, float worldWidth, float worldHeight);
+    /// free everything
+    void Discard();
+    /// returns true once the tiles are built
+    bool IsReady() const;
+
+    /// get the height at a position, returns false if outside the terrain or not ready
+    bool GetHeight(float x, float z, float& outHeight) const;
+    /// get the height and normal at a position, returns false if outside the terrain or not ready
+    bool GetHeight(float x, float z, float& outHeight, Math::vector& outNormal) const;
+    /// shoot a ray at the terrain, returns true if it hits within its max distance
+    bool Raycast(const TerrainRay& ray, TerrainRayHit& outHit) const;
+
+    /// get heights for many xz positions, positions outside the terrain get the lowest height
+    void GetHeights(const Math::vec2* positions, float* outHeights, SizeT num) const;
+    /// shoot many rays
+    void Raycast(const TerrainRay* rays, TerrainRayHit* outHits, SizeT num) const;
+
+    /// number of cells along each side of a tile
+    static const int TileCells = 32;
+    /// number of queries per job in the batch functions
+    static const SizeT BatchSize = 256;
+
+private:
+    /// samples along each side of a tile, the last ones are shared with the next tile
+    static const int TileSamples = TileCells + 1;
+
+    /// a compressed tile
+    struct Tile
+    {
+        /// byte offset of the samples in data
+        uint offset;
+        uint16_t minHeight;
+        uint16_t maxHeight;
+        /// samples are 16 bit offsets instead of 8
+        bool wide;
+    };
+
+    /// a level of the min/max pyramid, level 0 has one node per tile
+    struct Level
+    {
+        int sizeX;
+        int sizeZ;
+        Util::Array<uint16_t> minHeights;
+        Util::Array<uint16_t> maxHeights;
+    };
+
+    /// get a raw sample, coordinates must be within the heightmap
+    uint Sample(int x, int z) const;
+    /// get the heights at the four corners of a cell
+    void GetCell(int cellX, int cellZ, float& h00, float& h10, float& h01, float& h11) const;
+    /// get the world space bounds of a pyramid node
+    void GetNodeBounds(int level, int x, int z, Math::vec3& outMin, Math::vec3& outMax) const;
+    /// walk the cells of a tile between two ray distances, returns true and the nearest hit if any
+    bool RaycastTile(int tileX, int tileZ, const Math::vec3& origin, const Math::vec3& dir, float tStart, float tEnd, float& outT) const;
+
+    float minHeight;
+    /// world height of one sample step
+    float heightScale;
+    float worldWidth;
+    float worldHeight;
+    /// world distance between sample centers
+    float cellSizeX;
+    float cellSizeZ;
+    /// world position of the first sample center, which is a repeated border sample
+    float originX;
+    float originZ;
+    /// number of samples including the repeated border
+    int width;
+    int height;
+    int tilesX;
+    int tilesZ;
+
+    Util::Array<Tile> tiles;
+    Util::Array<uint8_t> data;
+    Util::Array<Level> levels;
+};
+
+} // namespace Terrain
@@ -6,6 +6,7 @@
 
 #include "graphics/graphicsserver.h"
 #include "vegetationcontext.h"
+#include "vegetationtileloader.h"
 #include "resources/resourceserver.h"
 #include "math/plane.h"
 #include "graphics/view.h"
@@ -16,6 +17,8 @@
 #include "models/nodes/modelnode.h"
 #include "models/nodes/transformnode.h"
 #include "models/nodes/primitivenode.h"
+#include "util/dictionary.h"
+#include "profiling/profiling.h"
 
 #include "gpulang/render/system_shaders/vegetation.h"
 
@@ -26,6 +29,18 @@ namespace Vegetation
 VegetationContext::VegetationAllocator VegetationContext::vegetationAllocator;
 __ImplementContext(VegetationContext, VegetationContext::vegetationAllocator);
 
+/// a baked tile which is loading or loaded
+struct StreamedTile
+{
+    Resources::ResourceId resource;
+    const VegetationTileInstance* instances = nullptr;
+    SizeT numInstances = 0;
+    Math::bbox box;
+    SizeT byteSize = 0;
+    IndexT lastUsedFrame = 0;
+    bool loaded = false;
+};
+
 struct
 {
     CoreGraphics::TextureId heightMap;
@@ -53,6 +68,7 @@ struct
     CoreGraphics::ShaderId vegetationBaseShader;
     CoreGraphics::ShaderProgramId vegetationClearShader;
     CoreGraphics::ShaderProgramId vegetationGenerateDrawsShader;
+    CoreGraphics::ShaderProgramId vegetationGenerateBakedDrawsShader;
     CoreGraphics::ShaderProgramId vegetationGrassZShader;
     CoreGraphics::ShaderProgramId vegetationGrassShader;
     CoreGraphics::ShaderProgramId vegetationMeshZShader;
@@ -90,10 +106,27 @@ struct
     Vegetation::VegetationMaterialUniforms::STRUCT materialUniforms;
     CoreGraphics::BufferId materialUniformsBuffer;
 
+    bool streaming = false;
+    VegetationStreamingSetup streamingSetup;
+    int numTilesX = 0, numTilesZ = 0;
+    Util::Dictionary<IndexT, StreamedTile> streamedTiles;
+    SizeT residentBytes = 0;
+    Util::Array<Util::KeyValuePair<float, IndexT>> tileRequests;
+    Util::Array<VegetationTileInstance> bakedInstances;
+    CoreGraphics::BufferId bakedInstanceBuffer;
+    uint numBakedInstances = 0;
+    uint bakedInstanceOffset = 0;
+    IndexT bakedFrameIndex = InvalidIndex;
+    bool bakedOverflowReported = false;
+
 } vegetationState;
 
 static const uint VegetationDistributionRadius = 128;
 static const uint MaxNumIndirectDraws = 8192;
+static_assert(Vegetation::MAX_MESH_DRAWS_PER_TYPE * Vegetation::MAX_MESH_INFOS <= MaxNumIndirectDraws, "Mesh instance arguments don't fit all mesh types");
+/// visible baked instances per frame, at most this many can become mesh draws anyway
+static const uint MaxNumBakedInstances = Vegetation::MAX_MESH_DRAWS_PER_TYPE * Vegetation::MAX_MESH_INFOS;
+static_assert(sizeof(VegetationTileInstance) == sizeof(Vegetation::BakedInstance), "Baked tile instances have to match the shader");
 
 struct GrassVertex
 {
@@ -118,6 +151,97 @@ struct CombinedMeshVertex
     Math::float3 binormal;
 };
 
+//------------------------------------------------------------------------------
+/**
+    Starts loading a tile, the listener fills in the instances once it's loaded
+*/
+static void
+RequestTile(IndexT key, IndexT frameIndex)
+{
+    const int x = key % vegetationState.numTilesX;
+    const int z = key / vegetationState.numTilesX;
+    const Util::String name = Util::String::Sprintf("%s/tile_%d_%d.vegt", vegetationState.streamingSetup.tileDirectory.AsCharPtr(), x, z);
+
+    StreamedTile tile;
+    tile.lastUsedFrame = frameIndex;
+    tile.byteSize = sizeof(VegetationTileHeader);
+    tile.resource = Resources::CreateResource(name, "Vegetation", nullptr, nullptr, false, false);
+    vegetationState.streamedTiles.Add(key, tile);
+    vegetationState.residentBytes += tile.byteSize;
+
+    auto onLoaded = [key](const Resources::ResourceId id)
+    {
+        // the tile might have been evicted while it was loading
+        IndexT i = vegetationState.streamedTiles.FindIndex(key);
+        if (i == InvalidIndex)
+            return;
+        StreamedTile& tile = vegetationState.streamedTiles.ValueAtIndex(i);
+        if (tile.resource.loaderInstanceId != id.loaderInstanceId)
+            return;
+        VegetationTileLoader* loader = Resources::GetStreamLoader<VegetationTileLoader>();
+        tile.resource = id;
+        tile.instances = loader->GetInstances(id, tile.numInstances);
+        tile.box = loader->GetBoundingBox(id);
+        tile.loaded = true;
+        tile.byteSize += tile.numInstances * sizeof(VegetationTileInstance);
+        vegetationState.residentBytes += tile.numInstances * sizeof(VegetationTileInstance);
+    };
+    auto onFailed = [key, name](const Resources::ResourceId id)
+    {
+        n_warning("VegetationContext: could not load vegetation tile '%s'\n", name.AsCharPtr());
+
+        // keep it as an empty tile, so it isn't requested again every frame
+        IndexT i = vegetationState.streamedTiles.FindIndex(key);
+        if (i != InvalidIndex)
+            vegetationState.streamedTiles.ValueAtIndex(i).loaded = true;
+    };
+    Resources::CreateResourceListener(tile.resource, onLoaded, onFailed);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Throws out the least recently used tiles until the tiles fit the budget.
+    Tiles used in this or the last frame stay, another view might need them.
+*/
+static void
+EvictTiles(IndexT frameIndex)
+{
+    if (vegetationState.residentBytes <= vegetationState.streamingSetup.memoryBudget)
+        return;
+
+    Util::Array<Util::KeyValuePair<IndexT, IndexT>> candidates;
+    for (IndexT i = 0; i < vegetationState.streamedTiles.Size(); i++)
+    {
+        const StreamedTile& tile = vegetationState.streamedTiles.ValueAtIndex(i);
+        if (tile.lastUsedFrame < frameIndex - 1)
+            candidates.Append(Util::KeyValuePair<IndexT, IndexT>(tile.lastUsedFrame, vegetationState.streamedTiles.KeyAtIndex(i)));
+    }
+    candidates.Sort();
+
+    for (IndexT i = 0; i < candidates.Size() && vegetationState.residentBytes > vegetationState.streamingSetup.memoryBudget; i++)
+    {
+        const IndexT key = candidates[i].Value();
+        const StreamedTile& tile = vegetationState.streamedTiles[key];
+        Resources::DiscardResource(tile.resource);
+        vegetationState.residentBytes -= tile.byteSize;
+        vegetationState.streamedTiles.Erase(key);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+DiscardStreamedTiles()
+{
+    for (IndexT i = 0; i < vegetationState.streamedTiles.Size(); i++)
+        Resources::DiscardResource(vegetationState.streamedTiles.ValueAtIndex(i).resource);
+    vegetationState.streamedTiles.Clear();
+    vegetationState.residentBytes = 0;
+    vegetationState.bakedInstances.Clear();
+    vegetationState.numBakedInstances = 0;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -143,6 +267,10 @@ VegetationContext::Create(const VegetationSetupSettings& settings)
 
     Graphics::GraphicsServer::Instance()->RegisterGraphicsContext(&__bundle, &__state);
 
+    Resources::ResourceServer* resourceServer = Resources::ResourceServer::Instance();
+    if (!resourceServer->HasStreamLoader("vegt"))
+        resourceServer->RegisterStreamLoader("vegt", VegetationTileLoader::RTTI);
+
     vegetationState.minHeight = settings.minHeight;
     vegetationState.maxHeight = settings.maxHeight;
     vegetationState.worldSize = settings.worldSize;
@@ -278,6 +406,16 @@ VegetationContext::Create(const VegetationSetupSettings& settings)
         vegetationState.indirectDrawCountBuffer[i] = CoreGraphics::CreateBuffer(indirectCountBufferInfo);
     }
 
+    // instances of the visible baked tiles, one range per buffered frame
+    CoreGraphics::BufferCreateInfo bakedInstanceInfo;
+    bakedInstanceInfo.name = "Vegetation Baked Instances";
+    bakedInstanceInfo.usageFlags = CoreGraphics::BufferUsage::ReadWrite;
+    bakedInstanceInfo.mode = CoreGraphics::HostCached;
+    bakedInstanceInfo.elementSize = sizeof(Vegetation::BakedInstance);
+    bakedInstanceInfo.size = MaxNumBakedInstances * CoreGraphics::GetNumBufferedFrames();
+    bakedInstanceInfo.queueSupport = CoreGraphics::ComputeQueueSupport | CoreGraphics::GraphicsQueueSupport;
+    vegetationState.bakedInstanceBuffer = CoreGraphics::CreateBuffer(bakedInstanceInfo);
+
     CoreGraphics::BufferCreateInfo materialUniformInfo;
     materialUniformInfo.name = "Vegetation Materials Buffer";
     materialUniformInfo.elementSize = sizeof(Vegetation::VegetationMaterialUniforms::STRUCT);
@@ -289,6 +427,7 @@ VegetationContext::Create(const VegetationSetupSettings& settings)
     vegetationState.vegetationBaseShader = CoreGraphics::ShaderGet("shd:vegetation.gplb");
     vegetationState.vegetationClearShader = CoreGraphics::ShaderGetProgram(vegetationState.vegetationBaseShader, ShaderFeatureMask("VegetationClear"));
     vegetationState.vegetationGenerateDrawsShader = CoreGraphics::ShaderGetProgram(vegetationState.vegetationBaseShader, ShaderFeatureMask("VegetationGenerateDraws"));
+    vegetationState.vegetationGenerateBakedDrawsShader = CoreGraphics::ShaderGetProgram(vegetationState.vegetationBaseShader, ShaderFeatureMask("VegetationGenerateBakedDraws"));
     vegetationState.vegetationGrassZShader = CoreGraphics::ShaderGetProgram(vegetationState.vegetationBaseShader, ShaderFeatureMask("VegetationGrassDrawZ"));
     vegetationState.vegetationGrassShader = CoreGraphics::ShaderGetProgram(vegetationState.vegetationBaseShader, ShaderFeatureMask("VegetationGrassDraw"));
     vegetationState.vegetationMeshZShader = CoreGraphics::ShaderGetProgram(vegetationState.vegetationBaseShader, ShaderFeatureMask("VegetationMeshDrawZ"));
@@ -352,6 +491,15 @@ VegetationContext::Create(const VegetationSetupSettings& settings)
             0
         });
 
+    ResourceTableSetRWBuffer(vegetationState.systemResourceTable,
+        {
+            vegetationState.bakedInstanceBuffer,
+            Vegetation::BakedInstances::BINDING,
+            0,
+            BufferGetByteSize(vegetationState.bakedInstanceBuffer),
+            0
+        });
+
     ResourceTableSetRWBuffer(vegetationState.systemResourceTable,
         {
             vegetationState.drawCountBuffer,
@@ -434,6 +582,14 @@ VegetationContext::Create(const VegetationSetupSettings& settings)
         CmdSetResourceTable(cmdBuf, vegetationState.argumentsTable, NEBULA_BATCH_GROUP, ComputePipeline, nullptr);
 
         CmdDispatch(cmdBuf, VegetationDistributionRadius / 64, VegetationDistributionRadius, 1);
+
+        if (vegetationState.numBakedInstances > 0)
+        {
+            CmdSetShaderProgram(cmdBuf, vegetationState.vegetationGenerateBakedDrawsShader, queue);
+            CmdSetResourceTable(cmdBuf, vegetationState.systemResourceTable, NEBULA_SYSTEM_GROUP, ComputePipeline, nullptr);
+            CmdSetResourceTable(cmdBuf, vegetationState.argumentsTable, NEBULA_BATCH_GROUP, ComputePipeline, nullptr);
+            CmdDispatch(cmdBuf, Math::divandroundup(vegetationState.numBakedInstances, 64), 1, 1);
+        }
     }, {
         { FrameScript_default::BufferIndex::VegetationGrassDrawsBuffer, CoreGraphics::PipelineStage::ComputeShaderWrite }
         , { FrameScript_default::BufferIndex::VegetationMeshDrawsBuffer, CoreGraphics::PipelineStage::ComputeShaderWrite }
@@ -519,7 +675,7 @@ VegetationContext::Create(const VegetationSetupSettings& settings)
                 CmdSetResourceTable(cmdBuf, vegetationState.indirectArgumentsTable[bufferIndex], NEBULA_BATCH_GROUP, GraphicsPipeline, nullptr);
 
                 // draw
-                CmdDrawIndirectIndexed(cmdBuf, vegetationState.indirectMeshDrawCallsBuffer[bufferIndex], i * MAX_MESH_INFOS, vegetationState.meshDrawsThisFrame[i], sizeof(Vegetation::DrawIndexedCommand));
+                CmdDrawIndirectIndexed(cmdBuf, vegetationState.indirectMeshDrawCallsBuffer[bufferIndex], i * MAX_MESH_DRAWS_PER_TYPE * sizeof(Vegetation::DrawIndexedCommand), vegetationState.meshDrawsThisFrame[i], sizeof(Vegetation::DrawIndexedCommand));
             }
         }
     }, {
@@ -572,7 +728,7 @@ VegetationContext::Create(const VegetationSetupSettings& settings)
                 CmdSetResourceTable(cmdBuf, vegetationState.indirectArgumentsTable[bufferIndex], NEBULA_BATCH_GROUP, GraphicsPipeline, nullptr);
 
                 // draw
-                CmdDrawIndirectIndexed(cmdBuf, vegetationState.indirectMeshDrawCallsBuffer[bufferIndex], i * MAX_MESH_INFOS, vegetationState.meshDrawsThisFrame[i], sizeof(Vegetation::DrawIndexedCommand));
+                CmdDrawIndirectIndexed(cmdBuf, vegetationState.indirectMeshDrawCallsBuffer[bufferIndex], i * MAX_MESH_DRAWS_PER_TYPE * sizeof(Vegetation::DrawIndexedCommand), vegetationState.meshDrawsThisFrame[i], sizeof(Vegetation::DrawIndexedCommand));
             }
         }
     }, {
@@ -601,6 +757,8 @@ VegetationContext::Create(const VegetationSetupSettings& settings)
 void
 VegetationContext::Discard()
 {
+    DiscardStreamedTiles();
+    vegetationState.streaming = false;
 }
 
 //------------------------------------------------------------------------------
@@ -901,6 +1059,24 @@ VegetationContext::SetupMesh(const Graphics::GraphicsEntityId id, const Vegetati
     CoreGraphics::BufferUpdate(vegetationState.materialUniformsBuffer, vegetationState.materialUniforms);
 }
 
+//------------------------------------------------------------------------------
+/**
+    Tile x, z is loaded from <tileDirectory>/tile_<x>_<z>.vegt, x and z count
+    from the -x, -z corner of the world. The mesh type of a baked instance is
+    the index of its mesh in the order SetupMesh() was called.
+*/
+void
+VegetationContext::SetupStreaming(const VegetationStreamingSetup& setup)
+{
+    n_assert(setup.tileSize > 0.0f);
+    DiscardStreamedTiles();
+    vegetationState.streamingSetup = setup;
+    vegetationState.bakedOverflowReported = false;
+    vegetationState.numTilesX = (int)Math::ceil(vegetationState.worldSize.x / setup.tileSize);
+    vegetationState.numTilesZ = (int)Math::ceil(vegetationState.worldSize.y / setup.tileSize);
+    vegetationState.streaming = true;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -953,6 +1129,20 @@ VegetationContext::UpdateViewResources(const Graphics::ViewId view, const Graphi
         }
     }
 
+    // with streaming, meshes are only placed from the baked tiles, which are picked for a single view,
+    // the LOD camera's or without one the first view of the frame, other views draw the same instances
+    if (vegetationState.streaming)
+    {
+        const Graphics::GraphicsEntityId lodCamera = Graphics::CameraContext::GetLODCamera();
+        const bool streamingView = lodCamera == Graphics::InvalidGraphicsEntityId || ViewGetCamera(view) == lodCamera;
+        if (streamingView && vegetationState.bakedFrameIndex != ctx.frameIndex)
+            UpdateStreaming(Graphics::CameraContext::GetViewProjection(ViewGetCamera(view)), cameraTransform.position, ctx);
+        uniforms.NumMeshTypes = 0;
+    }
+    uniforms.NumBakedInstances = vegetationState.numBakedInstances;
+    uniforms.BakedInstanceOffset = vegetationState.bakedInstanceOffset;
+    uniforms.BakedMaxRange = vegetationState.streamingSetup.drawDistance * vegetationState.streamingSetup.drawDistance;
+
     // update uniform buffer
     CoreGraphics::BufferUpdate(vegetationState.systemUniforms, uniforms);
 
@@ -969,11 +1159,94 @@ VegetationContext::UpdateViewResources(const Graphics::ViewId view, const Graphi
     // update draw counts
     vegetationState.grassDrawsThisFrame = counts->NumGrassDraws;
     for (IndexT i = 0; i < MAX_MESH_INFOS; i++)
-        vegetationState.meshDrawsThisFrame[i] = counts->NumMeshDraws[i/4][i%4];
+        vegetationState.meshDrawsThisFrame[i] = Math::min(counts->NumMeshDraws[i/4][i%4], (uint)MAX_MESH_DRAWS_PER_TYPE);
 
     CoreGraphics::BufferUnmap(vegetationState.indirectDrawCountBuffer[ctx.bufferIndex]);
 }
 
+//------------------------------------------------------------------------------
+/**
+    Picks the tiles within draw and prefetch distance of the camera. Missing
+    ones are requested closest first, loaded ones are marked as used and the
+    instances of those in draw distance and inside the frustum are copied to
+    this frame's range of the baked instance buffer.
+
+    The baked instance range is written once per frame, so this is only
+    called for one view per frame, see UpdateViewResources(). Instances beyond
+    MaxNumBakedInstances are dropped, which is reported once per setup.
+*/
+void
+VegetationContext::UpdateStreaming(const Math::mat4& viewProjection, const Math::point& cameraPosition, const Graphics::FrameContext& ctx)
+{
+    N_SCOPE(UpdateVegetationStreaming, Graphics);
+    n_assert(vegetationState.bakedFrameIndex != ctx.frameIndex);
+    vegetationState.bakedFrameIndex = ctx.frameIndex;
+    const VegetationStreamingSetup& setup = vegetationState.streamingSetup;
+    const float tileSize = setup.tileSize;
+    const float loadDistance = setup.drawDistance + setup.prefetchDistance;
+    const float halfX = vegetationState.worldSize.x * 0.5f;
+    const float halfZ = vegetationState.worldSize.y * 0.5f;
+
+    const int x0 = Math::max(0, (int)Math::floor((cameraPosition.x - loadDistance + halfX) / tileSize));
+    const int x1 = Math::min(vegetationState.numTilesX - 1, (int)Math::floor((cameraPosition.x + loadDistance + halfX) / tileSize));
+    const int z0 = Math::max(0, (int)Math::floor((cameraPosition.z - loadDistance + halfZ) / tileSize));
+    const int z1 = Math::min(vegetationState.numTilesZ - 1, (int)Math::floor((cameraPosition.z + loadDistance + halfZ) / tileSize));
+
+    vegetationState.tileRequests.Clear();
+    vegetationState.bakedInstances.Clear();
+    for (int z = z0; z <= z1; z++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            // distance from the camera to the tile rectangle
+            const float minX = -halfX + x * tileSize;
+            const float minZ = -halfZ + z * tileSize;
+            const float dx = Math::max(Math::max(minX - cameraPosition.x, cameraPosition.x - (minX + tileSize)), 0.0f);
+            const float dz = Math::max(Math::max(minZ - cameraPosition.z, cameraPosition.z - (minZ + tileSize)), 0.0f);
+            const float distanceSq = dx * dx + dz * dz;
+            if (distanceSq > loadDistance * loadDistance)
+                continue;
+
+            const IndexT key = x + z * vegetationState.numTilesX;
+            const IndexT index = vegetationState.streamedTiles.FindIndex(key);
+            if (index == InvalidIndex)
+            {
+                vegetationState.tileRequests.Append(Util::KeyValuePair<float, IndexT>(distanceSq, key));
+                continue;
+            }
+
+            StreamedTile& tile = vegetationState.streamedTiles.ValueAtIndex(index);
+            tile.lastUsedFrame = ctx.frameIndex;
+            if (!tile.loaded || tile.numInstances == 0 || distanceSq > setup.drawDistance * setup.drawDistance)
+                continue;
+            if (tile.box.clipstatus(viewProjection) == Math::ClipStatus::Outside)
+                continue;
+
+            const SizeT room = MaxNumBakedInstances - vegetationState.bakedInstances.Size();
+            if (tile.numInstances > room && !vegetationState.bakedOverflowReported)
+            {
+                n_warning("VegetationContext: more than %d baked instances visible, lower the density or draw distance\n", MaxNumBakedInstances);
+                vegetationState.bakedOverflowReported = true;
+            }
+            vegetationState.bakedInstances.AppendArray(tile.instances, Math::min(tile.numInstances, room));
+        }
+    }
+
+    vegetationState.tileRequests.Sort();
+    for (IndexT i = 0; i < vegetationState.tileRequests.Size() && i < setup.maxRequestsPerFrame; i++)
+        RequestTile(vegetationState.tileRequests[i].Value(), ctx.frameIndex);
+    EvictTiles(ctx.frameIndex);
+
+    vegetationState.numBakedInstances = vegetationState.bakedInstances.Size();
+    vegetationState.bakedInstanceOffset = ctx.bufferIndex * MaxNumBakedInstances;
+    if (vegetationState.numBakedInstances > 0)
+    {
+        const uint64_t offset = vegetationState.bakedInstanceOffset * sizeof(VegetationTileInstance);
+        CoreGraphics::BufferUpdateArray(vegetationState.bakedInstanceBuffer, vegetationState.bakedInstances.Begin(), vegetationState.numBakedInstances, offset);
+        CoreGraphics::BufferFlush(vegetationState.bakedInstanceBuffer, offset, vegetationState.bakedInstances.ByteSize());
+    }
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -10,6 +10,9 @@
 #include "graphics/graphicscontext.h"
 #include "resources/resource.h"
 #include "ids/idallocator.h"
+#include "util/string.h"
+#include "math/mat4.h"
+#include "math/point.h"
 
 namespace Vegetation
 {
@@ -43,6 +46,16 @@ struct VegetationMeshSetup
     float heightThreshold;                  // height threshold in percentage
 };
 
+struct VegetationStreamingSetup
+{
+    Util::String tileDirectory;             // folder with the baked tiles, named tile_<x>_<z>.vegt
+    float tileSize = 64.0f;                 // world size of a tile, has to match the bake
+    float drawDistance = 250.0f;            // baked meshes farther away are not drawn
+    float prefetchDistance = 64.0f;         // tiles are loaded this much before they come into draw distance
+    SizeT memoryBudget = 32 * 1024 * 1024;  // bytes of tile data kept in memory, least recently used tiles go first
+    SizeT maxRequestsPerFrame = 4;          // tile loads started per frame, closest tiles first
+};
+
 class VegetationContext : public Graphics::GraphicsContext
 {
     __DeclareContext();
@@ -65,6 +78,8 @@ public:
     static void SetupGrass(const Graphics::GraphicsEntityId id, const VegetationGrassSetup& setup);
     /// setup as mesh
     static void SetupMesh(const Graphics::GraphicsEntityId id, const VegetationMeshSetup& setup);
+    /// place meshes from baked tiles streamed around the camera instead of generating them
+    static void SetupStreaming(const VegetationStreamingSetup& setup);
 
     /// update resources
     static void UpdateViewResources(const Graphics::ViewId view, const Graphics::FrameContext& ctx);
@@ -74,6 +89,8 @@ private:
     static Graphics::ContextEntityId Alloc();
     /// deallocate a slice
     static void Dealloc(Graphics::ContextEntityId id);
+    /// load and evict tiles around a camera and gather the instances to draw
+    static void UpdateStreaming(const Math::mat4& viewProjection, const Math::point& cameraPosition, const Graphics::FrameContext& ctx);
 
     enum class VegetationType : uint8_t
     {
@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+//  vegetationtileloader.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "vegetationtileloader.h"
+
+namespace Vegetation
+{
+
+__ImplementClass(Vegetation::VegetationTileLoader, 'VGTL', Resources::ResourceLoader);
+
+//------------------------------------------------------------------------------
+/**
+*/
+VegetationTileLoader::VegetationTileLoader()
+{
+    this->async = true;
+    this->streamerThreadName = "Vegetation Tile Streamer Thread";
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+VegetationTileLoader::~VegetationTileLoader()
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+const VegetationTileInstance*
+VegetationTileLoader::GetInstances(const Resources::ResourceId id, SizeT& outNumInstances)
+{
+    __LockName(&this->allocator, lock, id.resourceId);
+    outNumInstances = this->allocator.Get<Tile_NumInstances>(id.resourceId);
+    return this->allocator.Get<Tile_Instances>(id.resourceId);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Math::bbox
+VegetationTileLoader::GetBoundingBox(const Resources::ResourceId id)
+{
+    __LockName(&this->allocator, lock, id.resourceId);
+    return this->allocator.Get<Tile_BoundingBox>(id.resourceId);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Resources::ResourceLoader::ResourceInitOutput
+VegetationTileLoader::InitializeResource(const ResourceLoadJob& job, const Ptr<IO::Stream>& stream)
+{
+    Resources::ResourceLoader::ResourceInitOutput ret;
+    const SizeT size = (SizeT)stream->GetSize();
+    VegetationTileHeader header;
+    if (size < sizeof(header) || stream->Read(&header, sizeof(header)) != sizeof(header))
+    {
+        n_warning("VegetationTileLoader: '%s' is too small\n", job.name.AsCharPtr());
+        return ret;
+    }
+    if (header.magic != VegetationTileHeader::Magic || header.version != VegetationTileHeader::Version)
+    {
+        n_warning("VegetationTileLoader: '%s' is not a vegetation tile or has an old version\n", job.name.AsCharPtr());
+        return ret;
+    }
+
+    const SizeT byteSize = header.numInstances * sizeof(VegetationTileInstance);
+    if (size - (SizeT)sizeof(header) < byteSize)
+    {
+        n_warning("VegetationTileLoader: '%s' is truncated\n", job.name.AsCharPtr());
+        return ret;
+    }
+
+    VegetationTileInstance* instances = nullptr;
+    if (header.numInstances > 0)
+    {
+        instances = (VegetationTileInstance*)Memory::Alloc(Memory::ResourceHeap, byteSize);
+        if (stream->Read(instances, byteSize) != byteSize)
+        {
+            n_warning("VegetationTileLoader: failed to read '%s'\n", job.name.AsCharPtr());
+            Memory::Free(Memory::ResourceHeap, instances);
+            return ret;
+        }
+    }
+
+    Math::bbox box;
+    box.pmin = Math::point(header.boxMin[0], header.boxMin[1], header.boxMin[2]);
+    box.pmax = Math::point(header.boxMax[0], header.boxMax[1], header.boxMax[2]);
+
+    Ids::Id32 id = this->allocator.Alloc();
+    this->allocator.Set<Tile_Instances>(id, instances);
+    this->allocator.Set<Tile_NumInstances>(id, (SizeT)header.numInstances);
+    this->allocator.Set<Tile_BoundingBox>(id, box);
+    this->allocator.Release(id);
+
+    ret.id = id;
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VegetationTileLoader::Unload(const Resources::ResourceId id)
+{
+    VegetationTileInstance* instances;
+    {
+        __LockName(&this->allocator, lock, id.resourceId);
+        instances = this->allocator.Get<Tile_Instances>(id.resourceId);
+        this->allocator.Set<Tile_Instances>(id.resourceId, nullptr);
+        this->allocator.Set<Tile_NumInstances>(id.resourceId, 0);
+    }
+    if (instances != nullptr)
+        Memory::Free(Memory::ResourceHeap, instances);
+
+    this->allocator.Dealloc(id.resourceId);
+}
+
+} // namespace Vegetation
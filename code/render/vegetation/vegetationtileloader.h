@@ -0,0 +1,79 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Vegetation::VegetationTileLoader
+
+    Resource loader for baked vegetation tiles (.vegt).
+
+    A tile holds the placed mesh instances of one square of the world, as
+    written by ToolkitUtil::VegetationBaker. Tiles are read on the loader
+    thread and kept in memory as they are in the file, the vegetation
+    context copies the instances of visible tiles to the GPU every frame.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "resources/resourceloader.h"
+#include "ids/idallocator.h"
+#include "math/bbox.h"
+
+namespace Vegetation
+{
+
+/// file header of a baked tile, followed by numInstances instances
+struct VegetationTileHeader
+{
+    static const uint Magic = 'VEGT';
+    static const uint Version = 1;
+
+    uint magic;
+    uint version;
+    uint numInstances;
+    float boxMin[3];
+    float boxMax[3];
+};
+
+/// a placed mesh, laid out like BakedInstance in vegetation.gpul
+struct VegetationTileInstance
+{
+    float position[3];
+    uint meshType;
+    float sincos[2];
+    float random;
+    uint pad;
+};
+
+class VegetationTileLoader : public Resources::ResourceLoader
+{
+    __DeclareClass(VegetationTileLoader);
+public:
+    /// constructor
+    VegetationTileLoader();
+    /// destructor
+    virtual ~VegetationTileLoader();
+
+    /// get the instances of a loaded tile
+    const VegetationTileInstance* GetInstances(const Resources::ResourceId id, SizeT& outNumInstances);
+    /// get the bounding box of a loaded tile
+    Math::bbox GetBoundingBox(const Resources::ResourceId id);
+
+private:
+    /// read tile, called on the loader thread
+    ResourceLoader::ResourceInitOutput InitializeResource(const ResourceLoadJob& job, const Ptr<IO::Stream>& stream) override;
+    /// unload tile
+    void Unload(const Resources::ResourceId id) override;
+
+    enum
+    {
+        Tile_Instances,
+        Tile_NumInstances,
+        Tile_BoundingBox
+    };
+    Ids::IdAllocatorSafe<0xFFFF,
+        VegetationTileInstance*,
+        SizeT,
+        Math::bbox> allocator;
+};
+
+} // namespace Vegetation
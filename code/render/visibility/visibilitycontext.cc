@@ -25,6 +25,7 @@
 #include "util/randomnumbertable.h"
 
 #include "jobs2/jobs2.h"
+#include "memory/framearray.h"
 
 #ifndef PUBLIC_BUILD
 #include "imgui.h"
@@ -78,8 +79,7 @@ ObserverContext::RunVisibilityTests(const Graphics::FrameContext& ctx)
     const Util::Array<VisibilityEntityType>& observerTypes = observerAllocator.GetArray<Observer_EntityType>();
     Util::Array<VisibilityResultArray>& observerResults = observerAllocator.GetArray<Observer_ResultArray>();
 
-    static Util::Array<Math::mat4> observerTransforms;
-    observerTransforms.Reset();
+    Memory::FrameArray<Math::mat4> observerTransforms;
     observerTransforms.Resize(observerAllocator.Size());
 
     IndexT i;
@@ -89,7 +89,10 @@ ObserverContext::RunVisibilityTests(const Graphics::FrameContext& ctx)
         const VisibilityEntityType type = observerTypes[i];
 
         if (id == Graphics::GraphicsEntityId::Invalid())
+        {
+            observerTransforms[i] = Math::mat4();
             continue;
+        }
 
         switch (type)
         {
@@ -127,13 +130,13 @@ ObserverContext::RunVisibilityTests(const Graphics::FrameContext& ctx)
 
     // setup observerable entities
     const Util::Array<Graphics::GraphicsEntityId>& ids = ObservableContext::observableAllocator.GetArray<ObservableContext::Observable_EntityId>();
-    static Util::Array<uint32_t> nodes;
-    nodes.Reset();
+    Memory::FrameArray<uint32_t> nodes;
     nodes.Resize(observerResults[0].Size());
+    Memory::Clear(nodes.Begin(), nodes.Size() * sizeof(uint32_t));
 
-    static Util::Array<Graphics::StageMask> stageMasks;
-    stageMasks.Reset();
+    Memory::FrameArray<Graphics::StageMask> stageMasks;
     stageMasks.Resize(observerResults[0].Size());
+    Memory::Clear(stageMasks.Begin(), stageMasks.Size() * sizeof(Graphics::StageMask));
 
     static Threading::AtomicCounter idCounter;
     idCounter = 1;
@@ -107,6 +107,21 @@ ResourceServer::RegisterStreamLoader(const Util::StringAtom& ext, const Core::Rt
     this->typeMap.Add(&loaderClass, this->loaders.Size() - 1);
 }
 
+//------------------------------------------------------------------------------
+/**
+    Lets one loader handle several file formats, such as the audio clip loader
+    which takes wav, ogg, mp3 and flac files.
+*/
+void
+ResourceServer::AddStreamLoaderExtension(const Util::StringAtom& ext, const Core::Rtti& loaderClass)
+{
+    n_assert(this->open);
+    n_assert(!this->extensionMap.Contains(ext));
+    IndexT i = this->typeMap.FindIndex(&loaderClass);
+    n_assert_fmt(i != InvalidIndex, "Stream loader '%s' has to be registered before adding extensions to it", loaderClass.GetName().AsCharPtr());
+    this->extensionMap.Add(ext, this->typeMap.ValueAtIndex(i));
+}
+
 //------------------------------------------------------------------------------
 /**
 */
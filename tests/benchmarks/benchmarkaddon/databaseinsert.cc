@@ -4,10 +4,10 @@
 //------------------------------------------------------------------------------
 #include "stdneb.h"
 #include "benchmarkaddon/databaseinsert.h"
-#include "addons/db/sqlite3/sqlite3factory.h"
+#include "db/sqlite3/sqlite3factory.h"
 #include "io/ioserver.h"
 #include "benchmarkaddon/dbattrs.h"
-#include "addons/db/dataset.h"
+#include "db/dataset.h"
 
 namespace Benchmarking
 {
@@ -69,9 +69,34 @@ DatabaseInsert::Run(Timer& timer)
     const URI uri("temp:dbinsertbenchmark.db3");
     this->PopulateStringTable();
 
+    // the last setup leaves the database for the DatabaseQuery benchmark
+    const Setup setups[] =
+    {
+        { "wal, write-behind", Sqlite3Database::WriteAheadLog, Sqlite3Database::SyncNormal, true },
+        { "wal", Sqlite3Database::WriteAheadLog, Sqlite3Database::SyncNormal, false },
+        { "rollback journal", Sqlite3Database::RollbackJournal, Sqlite3Database::SyncOff, false },
+    };
+
+    timer.Start();
+    for (const Setup& setup : setups)
+    {
+        this->RunSetup(uri, setup);
+    }
+    timer.Stop();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+DatabaseInsert::RunSetup(const URI& uri, const Setup& setup)
+{
+    n_printf("**** DatabaseInsert: %s\n", setup.name);
+    Timer timer;
     timer.Start();
+
     // prepare the database (open, create tables)
-    Ptr<Database> db = this->OpenDatabase(uri);
+    Ptr<Database> db = this->OpenDatabase(uri, setup);
 
     // create database table
     Ptr<Table> table = this->CreateTable(db);
@@ -79,9 +104,13 @@ DatabaseInsert::Run(Timer& timer)
     // populate the database with random data
     this->PopulateDatabase(db, table);
 
+    // lots of small commits
+    this->RunSmallCommits(db, table);
+
     // finally close it, this will commit the data back into the database
     this->CloseDatabase(db);
     timer.Stop();
+    n_printf("**** DatabaseInsert: %s total: %d ticks, %f seconds\n", setup.name, timer.GetTicks(), timer.GetTime());
 }
 
 //------------------------------------------------------------------------------
@@ -102,7 +131,7 @@ DatabaseInsert::CloseDatabase(Database* db)
 /**
 */
 Ptr<Database>
-DatabaseInsert::OpenDatabase(const URI& uri)
+DatabaseInsert::OpenDatabase(const URI& uri, const Setup& setup)
 {
     Timer timer;
     timer.Start();
@@ -118,6 +147,10 @@ DatabaseInsert::OpenDatabase(const URI& uri)
     Ptr<Database> db = Db::DbFactory::Instance()->CreateDatabase();
     db->SetURI(uri);
     db->SetAccessMode(Database::ReadWriteCreate);
+    Ptr<Sqlite3Database> sqliteDb = db.downcast<Sqlite3Database>();
+    sqliteDb->SetJournalMode(setup.journalMode);
+    sqliteDb->SetSynchronousLevel(setup.syncLevel);
+    sqliteDb->SetWriteBehind(setup.writeBehind);
     db->Open();
 
     timer.Stop();
@@ -477,5 +510,57 @@ DatabaseInsert::PopulateDatabase(Database* db, Table* table)
     n_printf("**** DatabaseInsert: close data set: %d ticks, %f seconds\n", timer.GetTicks(), timer.GetTime());
 }
 
+//------------------------------------------------------------------------------
+/**
+    Changes a few rows and commits them, over and over, like a game which
+    saves its state every frame.
+*/
+void
+DatabaseInsert::RunSmallCommits(Database* db, Table* table)
+{
+    n_assert(0 != db);
+
+    const SizeT numCommits = 500;
+    const SizeT numRowsPerCommit = 4;
+
+    Ptr<Dataset> dataSet = table->CreateDataset();
+    dataSet->AddColumn(Attr::Guid);
+    dataSet->AddColumn(Attr::MU);
+    dataSet->AddColumn(Attr::LE);
+    dataSet->AddColumn(Attr::Name);
+    dataSet->PerformQuery();
+    ValueTable* values = dataSet->Values();
+    n_assert(values->GetNumRows() > 0);
+
+    Timer timer;
+    timer.Start();
+    IndexT i;
+    for (i = 0; i < numCommits; i++)
+    {
+        IndexT j;
+        for (j = 0; j < numRowsPerCommit; j++)
+        {
+            IndexT rowIndex = rand() % values->GetNumRows();
+            values->SetInt(Attr::MU, rowIndex, this->GetRandomInt());
+            values->SetInt(Attr::LE, rowIndex, this->GetRandomInt());
+            values->SetString(Attr::Name, rowIndex, this->GetRandomString());
+        }
+        dataSet->CommitChanges();
+    }
+    timer.Stop();
+    n_printf("**** DatabaseInsert: %d commits of %d rows: %d ticks, %f seconds\n", 
+        numCommits,
+        numRowsPerCommit,
+        timer.GetTicks(), 
+        timer.GetTime());
+
+    // wait for anything written behind
+    timer.Reset();
+    timer.Start();
+    static_cast<Sqlite3Database*>(db)->Flush();
+    timer.Stop();
+    n_printf("**** DatabaseInsert: flush: %d ticks, %f seconds\n", timer.GetTicks(), timer.GetTime());
+}
+
 } // namespace Benchmarking
 
@@ -5,11 +5,16 @@
     @class Benchmarking::DatabaseInsert
     
     Measure database bulk insert performance.
+
+    Runs the same inserts and updates with the default rollback journal,
+    with write-ahead logging and with write-behind, and finishes with lots
+    of small commits like a game saving state every frame.
     
     (C) 2006 Radon Labs GmbH
 */
 #include "benchmarkbase/benchmark.h"
-#include "addons/db/database.h"
+#include "db/database.h"
+#include "db/sqlite3/sqlite3database.h"
 #include "util/fixedarray.h"
 
 //------------------------------------------------------------------------------
@@ -23,14 +28,27 @@ public:
     virtual void Run(Timing::Timer& timer);
 
 private:
+    /// a database setup to measure
+    struct Setup
+    {
+        const char* name;
+        Db::Sqlite3Database::JournalMode journalMode;
+        Db::Sqlite3Database::SyncLevel syncLevel;
+        bool writeBehind;
+    };
+
+    /// run all steps with one database setup
+    void RunSetup(const IO::URI& uri, const Setup& setup);
     /// open the database
-    Ptr<Db::Database> OpenDatabase(const IO::URI& uri);
+    Ptr<Db::Database> OpenDatabase(const IO::URI& uri, const Setup& setup);
     /// close the database
     void CloseDatabase(Db::Database* db);
     /// create a test table in the database
     Ptr<Db::Table> CreateTable(Db::Database* db);
     /// populate the database
     void PopulateDatabase(Db::Database* db, Db::Table* table);
+    /// commit a few changed rows at a time
+    void RunSmallCommits(Db::Database* db, Db::Table* table);
     /// return a pseudo random integer
     int GetRandomInt() const;
     /// return a pseudo random float
@@ -6,8 +6,9 @@
 #include "benchmarkaddon/databasequery.h"
 #include "benchmarkaddon/dbattrs.h"
 #include "io/ioserver.h"
-#include "addons/db/sqlite3/sqlite3factory.h"
-#include "addons/db/dataset.h"
+#include "db/sqlite3/sqlite3factory.h"
+#include "db/sqlite3/sqlite3database.h"
+#include "db/dataset.h"
 
 namespace Benchmarking
 {
@@ -40,9 +41,18 @@ DatabaseQuery::Run(Timer& timer)
     /// run some queries with different complexity
     this->RunIndexedQuery(db);
     this->RunNonIndexedQuery(db);
+    this->RunRepeatedQueries(db, "statement cache");
 
     // close the database
     db->Close();
+
+    // run the small queries again, compiling every statement
+    db->SetURI(uri);
+    db.downcast<Sqlite3Database>()->SetStatementCacheSize(0);
+    dbOpened = db->Open();
+    n_assert(dbOpened);
+    this->RunRepeatedQueries(db, "no statement cache");
+    db->Close();
     timer.Stop();
 }
 
@@ -101,4 +111,43 @@ DatabaseQuery::RunNonIndexedQuery(Database* db)
         timer.GetTime());
 }
 
-} // namespace Benchmarking
\ No newline at end of file
+//------------------------------------------------------------------------------
+/**
+    Looks up single rows through a new dataset each time, which is how
+    most game and tool code reads the database. Every query compiles the
+    same SQL, so this mostly measures the statement cache.
+*/
+void
+DatabaseQuery::RunRepeatedQueries(Database* db, const char* label)
+{
+    n_assert(0 != db);
+
+    const SizeT numQueries = 2000;
+    Ptr<Table> table = db->GetTableByName("MainTable");
+    SizeT numResultRows = 0;
+
+    Timer timer;
+    timer.Start();
+    IndexT i;
+    for (i = 0; i < numQueries; i++)
+    {
+        Ptr<Dataset> dataset = table->CreateDataset();
+        dataset->AddColumn(Attr::Guid);
+        dataset->AddColumn(Attr::Name);
+        dataset->AddColumn(Attr::MU);
+        Ptr<FilterSet> filter = dataset->Filter();
+        filter->AddEqualCheck(Attribute(Attr::Level, (i & 1) ? "Berlin" : "Radon"));
+        dataset->PerformQuery();
+        numResultRows += dataset->Values()->GetNumRows();
+    }
+    timer.Stop();
+
+    n_printf("**** DatabaseQuery::RunRepeatedQueries() (%s): %d queries, %d result rows in %d ticks, %f seconds\n",
+        label,
+        numQueries,
+        numResultRows,
+        timer.GetTicks(), 
+        timer.GetTime());
+}
+
+} // namespace Benchmarking
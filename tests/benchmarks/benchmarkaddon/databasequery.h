@@ -10,7 +10,7 @@
     (C) 2006 Radon Labs GmbH
 */
 #include "benchmarkbase/benchmark.h"
-#include "addons/db/database.h"
+#include "db/database.h"
 
 //------------------------------------------------------------------------------
 namespace Benchmarking
@@ -27,6 +27,8 @@ private:
     void RunIndexedQuery(Db::Database* db);
     /// run a simple query on a non-indexed column
     void RunNonIndexedQuery(Db::Database* db);
+    /// run many small queries, each through a new dataset
+    void RunRepeatedQueries(Db::Database* db, const char* label);
 };
 
 }
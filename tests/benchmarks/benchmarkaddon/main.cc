@@ -7,7 +7,7 @@
 #include "core/sysfunc.h"
 #include "benchmarkbase/benchmarkrunner.h"
 #include "io/ioserver.h"
-#include "io/filestream.h"
+#include "util/commandlineargs.h"
 
 #include "databaseinsert.h"
 #include "databasequery.h"
@@ -15,8 +15,8 @@
 using namespace Core;
 using namespace Benchmarking;
 
-void __cdecl
-main()
+int __cdecl
+main(int argc, const char** argv)
 {
     // create Nebula runtime
     Ptr<CoreServer> coreServer = CoreServer::Create();
@@ -27,14 +27,16 @@ main()
 
     // setup and run benchmarks
     Ptr<BenchmarkRunner> runner = BenchmarkRunner::Create();    
+    runner->ParseArgs(Util::CommandLineArgs(argc, argv));
     runner->AttachBenchmark(DatabaseInsert::Create());
     runner->AttachBenchmark(DatabaseQuery::Create());
-    runner->Run();
+    SizeT numRegressions = runner->Run();
     
     // shutdown Nebula runtime
-    runner = 0;
-    ioServer = 0;
+    runner = nullptr;
+    ioServer = nullptr;
     coreServer->Close();
-    coreServer = 0;
-    SysFunc::Exit(0);
+    coreServer = nullptr;
+    SysFunc::Exit(numRegressions > 0 ? 1 : 0);
+    return 0;
 }
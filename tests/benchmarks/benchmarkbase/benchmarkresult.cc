@@ -0,0 +1,60 @@
+//------------------------------------------------------------------------------
+//  benchmarkresult.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "benchmarkresult.h"
+
+namespace Benchmarking
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+BenchmarkResult::BenchmarkResult() :
+    numRuns(0),
+    min(0),
+    max(0),
+    mean(0),
+    median(0),
+    p95(0),
+    stddev(0)
+{
+    for (IndexT i = 0; i < PerfCounters::NumCounters; i++)
+    {
+        this->hasCounter[i] = false;
+        this->counters[i] = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    The median of an even number of samples is the mean of the two middle
+    samples, p95 uses the nearest rank.
+*/
+void
+BenchmarkResult::Compute(const Util::Array<Timing::Time>& samples)
+{
+    n_assert(!samples.IsEmpty());
+    Util::Array<Timing::Time> sorted = samples;
+    sorted.Sort();
+
+    const SizeT num = sorted.Size();
+    this->numRuns = num;
+    this->min = sorted[0];
+    this->max = sorted[num - 1];
+    this->median = (num & 1) ? sorted[num / 2] : (sorted[num / 2 - 1] + sorted[num / 2]) * 0.5;
+    this->p95 = sorted[(95 * num + 99) / 100 - 1];
+
+    Timing::Time sum = 0;
+    for (IndexT i = 0; i < num; i++)
+        sum += sorted[i];
+    this->mean = sum / num;
+
+    Timing::Time variance = 0;
+    for (IndexT i = 0; i < num; i++)
+        variance += (sorted[i] - this->mean) * (sorted[i] - this->mean);
+    this->stddev = num > 1 ? Math::sqrt(variance / (num - 1)) : 0;
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,42 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::BenchmarkResult
+
+    Statistics over the measured repetitions of one benchmark. Times are in
+    seconds, counter values are averages per repetition.
+
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "util/string.h"
+#include "util/array.h"
+#include "timing/time.h"
+#include "benchmarkbase/perfcounters.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class BenchmarkResult
+{
+public:
+    /// constructor
+    BenchmarkResult();
+
+    /// compute the time statistics from the measured repetitions
+    void Compute(const Util::Array<Timing::Time>& samples);
+
+    Util::String name;
+    SizeT numRuns;
+    Timing::Time min;
+    Timing::Time max;
+    Timing::Time mean;
+    Timing::Time median;
+    Timing::Time p95;
+    Timing::Time stddev;
+
+    bool hasCounter[PerfCounters::NumCounters];
+    uint64_t counters[PerfCounters::NumCounters];
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -1,10 +1,15 @@
 //------------------------------------------------------------------------------
 //  benchmarkrunner.cc
 //  (C) 2006 Radon Labs GmbH
+//  (C) 2024 Individual contributors, see AUTHORS file
 //------------------------------------------------------------------------------
 #include "stdneb.h"
 #include "benchmarkrunner.h"
 #include "timing/timer.h"
+#include "io/ioserver.h"
+#include "io/stream.h"
+#include "io/jsonreader.h"
+#include "io/jsonwriter.h"
 
 namespace Benchmarking
 {
@@ -13,6 +18,17 @@ __ImplementClass(Benchmarking::BenchmarkRunner, 'BNCR', Core::RefCounted);
 using namespace Util;
 using namespace Timing;
 
+//------------------------------------------------------------------------------
+/**
+*/
+BenchmarkRunner::BenchmarkRunner() :
+    numWarmupRuns(1),
+    numRuns(5),
+    regressionThreshold(0.1f)
+{
+    // empty
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -27,30 +43,233 @@ BenchmarkRunner::AttachBenchmark(Benchmark* b)
 /**
 */
 void
+BenchmarkRunner::ParseArgs(const CommandLineArgs& args)
+{
+    const int numWarmupRuns = args.GetInt("-warmup", this->numWarmupRuns);
+    if (numWarmupRuns < 0)
+        n_error("BenchmarkRunner: -warmup must not be negative, got %d\n", numWarmupRuns);
+    const int numRuns = args.GetInt("-runs", this->numRuns);
+    if (numRuns < 1)
+        n_error("BenchmarkRunner: -runs must be at least 1, got %d\n", numRuns);
+    this->SetWarmupRuns(numWarmupRuns);
+    this->SetRuns(numRuns);
+    this->SetFilter(args.GetString("-filter", this->filter));
+    this->SetRegressionThreshold(args.GetFloat("-threshold", this->regressionThreshold));
+    if (args.HasArg("-json"))
+        this->SetJsonOutput(args.GetString("-json"));
+    if (args.HasArg("-baseline"))
+        this->SetBaseline(args.GetString("-baseline"));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
 BenchmarkRunner::Run()
 {
+    PerfCounters perfCounters;
+    if (!perfCounters.Setup())
+        n_printf("Hardware performance counters not available, only reporting times\n");
+
+    this->results.Clear();
     n_printf("---------------------------------------------------------------\n");
-    uint overallTicks = 0;
+    n_printf("%d warmup runs, %d measured runs per benchmark\n", this->numWarmupRuns, this->numRuns);
     Time overallSeconds = 0.0;
     IndexT i;
     SizeT num = this->benchmarks.Size();
     for (i = 0; i < num; i++)
     {
         Benchmark* b = this->benchmarks[i];
-        Timer timer;
-        b->Run(timer);
-        uint ticks = timer.GetTicks();
-        Time seconds = timer.GetTime();
-
         Array<String> tokens = b->GetClassName().Tokenize(":");
         const String& className = tokens[tokens.Size() - 1];
+        if (this->filter.IsValid() && className.FindStringIndex(this->filter) == InvalidIndex)
+            continue;
+
+        IndexT run;
+        for (run = 0; run < this->numWarmupRuns; run++)
+        {
+            Timer timer;
+            b->Run(timer);
+        }
+
+        BenchmarkResult result;
+        result.name = className;
+        Array<Time> samples;
+        uint64_t counterSums[PerfCounters::NumCounters] = {};
+        for (run = 0; run < this->numRuns; run++)
+        {
+            Timer timer;
+            perfCounters.Start();
+            b->Run(timer);
+            perfCounters.Stop();
+            samples.Append(timer.GetTime());
+            for (IndexT c = 0; c < PerfCounters::NumCounters; c++)
+                counterSums[c] += perfCounters.GetValue((PerfCounters::Counter)c);
+        }
+        result.Compute(samples);
+        for (IndexT c = 0; c < PerfCounters::NumCounters; c++)
+        {
+            result.hasCounter[c] = perfCounters.IsValid((PerfCounters::Counter)c);
+            result.counters[c] = counterSums[c] / this->numRuns;
+        }
+
+        n_printf("> %s: median %f, p95 %f, min %f, max %f, stddev %f seconds\n",
+            className.AsCharPtr(), result.median, result.p95, result.min, result.max, result.stddev);
+        if (result.hasCounter[PerfCounters::Cycles] && result.hasCounter[PerfCounters::Instructions])
+        {
+            n_printf("  %llu cycles, %llu instructions, %llu cache misses, %llu branch misses per run on the main thread\n",
+                (unsigned long long)result.counters[PerfCounters::Cycles],
+                (unsigned long long)result.counters[PerfCounters::Instructions],
+                (unsigned long long)result.counters[PerfCounters::CacheMisses],
+                (unsigned long long)result.counters[PerfCounters::BranchMisses]);
+        }
+        overallSeconds += result.median;
+        this->results.Append(result);
+    }
+    perfCounters.Discard();
+    n_printf("---------------------------------------------------------------\n");
+    n_printf("* OVERALL: %f seconds (sum of medians)\n", overallSeconds);
+
+    if (!this->jsonUri.IsEmpty())
+    {
+        if (!this->WriteJson(this->jsonUri))
+            n_warning("BenchmarkRunner: failed to write '%s'\n", this->jsonUri.AsString().AsCharPtr());
+    }
+
+    SizeT numRegressions = 0;
+    if (!this->baselineUri.IsEmpty())
+        numRegressions = this->CompareToBaseline();
+    return numRegressions;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+BenchmarkRunner::WriteJson(const IO::URI& uri) const
+{
+    Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(uri);
+    Ptr<IO::JsonWriter> writer = IO::JsonWriter::Create();
+    writer->SetStream(stream);
+    if (!writer->Open())
+        return false;
+
+    // the hardware counters don't include job threads, see PerfCounters
+    writer->Add("mainThread", "counterScope");
+    writer->BeginArray("benchmarks");
+    for (const BenchmarkResult& result : this->results)
+    {
+        writer->BeginObject();
+        writer->Add(result.name, "name");
+        writer->Add(result.numRuns, "runs");
+        writer->Add(result.min, "min");
+        writer->Add(result.max, "max");
+        writer->Add(result.mean, "mean");
+        writer->Add(result.median, "median");
+        writer->Add(result.p95, "p95");
+        writer->Add(result.stddev, "stddev");
+        for (IndexT c = 0; c < PerfCounters::NumCounters; c++)
+        {
+            if (result.hasCounter[c])
+                writer->Add(result.counters[c], PerfCounters::GetName((PerfCounters::Counter)c));
+        }
+        writer->End();
+    }
+    writer->End();
+    writer->Close();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+BenchmarkRunner::ReadJson(const IO::URI& uri, Array<BenchmarkResult>& outResults)
+{
+    if (!IO::IoServer::Instance()->FileExists(uri))
+        return false;
+
+    Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(uri);
+    Ptr<IO::JsonReader> reader = IO::JsonReader::Create();
+    reader->SetStream(stream);
+    if (!reader->Open())
+        return false;
 
-        n_printf("> %s: %d ticks, %f seconds\n", className.AsCharPtr(), ticks, seconds);
-        overallTicks += ticks;
-        overallSeconds += seconds;
+    if (reader->SetToFirstChild("benchmarks") && reader->SetToFirstChild()) do
+    {
+        BenchmarkResult result;
+        result.name = reader->GetString("name");
+        result.numRuns = reader->GetInt("runs");
+        reader->Get(result.min, "min");
+        reader->Get(result.max, "max");
+        reader->Get(result.mean, "mean");
+        reader->Get(result.median, "median");
+        reader->Get(result.p95, "p95");
+        reader->Get(result.stddev, "stddev");
+        for (IndexT c = 0; c < PerfCounters::NumCounters; c++)
+        {
+            const char* counterName = PerfCounters::GetName((PerfCounters::Counter)c);
+            result.hasCounter[c] = reader->HasAttr(counterName);
+            if (result.hasCounter[c])
+                reader->Get(result.counters[c], counterName);
+        }
+        outResults.Append(result);
+    } while (reader->SetToNextChild());
+
+    reader->Close();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+BenchmarkRunner::CompareToBaseline() const
+{
+    Array<BenchmarkResult> baseline;
+    if (!ReadJson(this->baselineUri, baseline))
+    {
+        n_warning("BenchmarkRunner: failed to read baseline '%s'\n", this->baselineUri.AsString().AsCharPtr());
+        return 0;
     }
+
     n_printf("---------------------------------------------------------------\n");
-    n_printf("* OVERALL: %d ticks, %f seconds\n", overallTicks, overallSeconds);
+    n_printf("Comparing against baseline '%s', threshold %.1f%%\n", this->baselineUri.AsString().AsCharPtr(), this->regressionThreshold * 100.0f);
+    SizeT numRegressions = 0;
+    for (const BenchmarkResult& result : this->results)
+    {
+        const BenchmarkResult* base = nullptr;
+        for (const BenchmarkResult& candidate : baseline)
+        {
+            if (candidate.name == result.name)
+            {
+                base = &candidate;
+                break;
+            }
+        }
+        if (base == nullptr)
+        {
+            n_printf("  %s: not in baseline\n", result.name.AsCharPtr());
+            continue;
+        }
+
+        const Time diff = result.median - base->median;
+        const double relative = base->median > 0 ? diff / base->median : 0.0;
+        const Time noise = 2 * Math::max(result.stddev, base->stddev);
+        const char* verdict = "ok";
+        if (relative > this->regressionThreshold && diff > noise)
+        {
+            verdict = "REGRESSION";
+            numRegressions++;
+        }
+        else if (-relative > this->regressionThreshold && -diff > noise)
+        {
+            verdict = "improved";
+        }
+        n_printf("  %s: %f -> %f seconds (%+.1f%%) %s\n", result.name.AsCharPtr(), base->median, result.median, relative * 100.0, verdict);
+    }
+    n_printf("* %d regressions\n", numRegressions);
+    return numRegressions;
 }
 
 } // namespace Benchmark
@@ -5,13 +5,41 @@
     @class Benchmarking::BenchmarkRunner
 
     The benchmark runner class which runs all benchmarks.
-    
+
+    Every benchmark is run a number of warmup times which aren't measured,
+    followed by the measured repetitions. The runner reports min, median,
+    p95, max and standard deviation of the repetitions and, where the
+    platform allows it, hardware counters of the thread running the
+    benchmark (see PerfCounters).
+
+    The results can be written to a JSON file, and compared against the
+    JSON file of an earlier run. A benchmark regresses if its median is
+    slower than the baseline median by more than the threshold, and the
+    difference is bigger than twice the standard deviation of either run,
+    so that noisy benchmarks don't trip the check. Run() returns the number
+    of regressions, so a CI job can fail on it.
+
+    Command line arguments understood by ParseArgs():
+
+    -warmup N       unmeasured runs per benchmark (default 1)
+    -runs N         measured runs per benchmark, at least 1 (default 5)
+    -filter NAME    only run benchmarks whose class name contains NAME
+    -json URI       write the results to a JSON file
+    -baseline URI   compare the results against a JSON file
+    -threshold F    relative median slowdown counted as regression (default 0.1)
+
+    JSON and baseline files are accessed through the IoServer.
+
     (C) 2006 Radon Labs GmbH
+    (C) 2024 Individual contributors, see AUTHORS file
 */
 #include "core/refcounted.h"
 #include "core/ptr.h"
 #include "util/array.h"
+#include "util/commandlineargs.h"
+#include "io/uri.h"
 #include "benchmarkbase/benchmark.h"
+#include "benchmarkbase/benchmarkresult.h"
 
 //------------------------------------------------------------------------------
 namespace Benchmarking
@@ -20,17 +48,114 @@ class BenchmarkRunner : public Core::RefCounted
 {
     __DeclareClass(BenchmarkRunner);
 public:
+    /// constructor
+    BenchmarkRunner();
+
     /// attach a benchmark
     void AttachBenchmark(Benchmark* b);
-    /// run the benchmarks
-    void Run();
+    /// setup options from command line arguments
+    void ParseArgs(const Util::CommandLineArgs& args);
+
+    /// set number of unmeasured runs per benchmark
+    void SetWarmupRuns(SizeT num);
+    /// set number of measured runs per benchmark
+    void SetRuns(SizeT num);
+    /// only run benchmarks with a class name containing the filter
+    void SetFilter(const Util::String& filter);
+    /// write results to a JSON file
+    void SetJsonOutput(const IO::URI& uri);
+    /// compare results against a JSON file written by an earlier run
+    void SetBaseline(const IO::URI& uri);
+    /// set the relative median slowdown which counts as regression
+    void SetRegressionThreshold(float threshold);
+
+    /// run the benchmarks, returns the number of regressions against the baseline
+    SizeT Run();
+    /// get the results of the last run
+    const Util::Array<BenchmarkResult>& GetResults() const;
 
 private:
+    /// write results to the JSON file
+    bool WriteJson(const IO::URI& uri) const;
+    /// read results from a JSON file
+    static bool ReadJson(const IO::URI& uri, Util::Array<BenchmarkResult>& outResults);
+    /// compare results against the baseline, returns number of regressions
+    SizeT CompareToBaseline() const;
+
     Util::Array<Ptr<Benchmark>> benchmarks;
+    Util::Array<BenchmarkResult> results;
+    SizeT numWarmupRuns;
+    SizeT numRuns;
+    Util::String filter;
+    IO::URI jsonUri;
+    IO::URI baselineUri;
+    float regressionThreshold;
 };
 
-} // namespace Benchmark
 //------------------------------------------------------------------------------
-#endif
+/**
+*/
+inline void
+BenchmarkRunner::SetWarmupRuns(SizeT num)
+{
+    this->numWarmupRuns = num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+BenchmarkRunner::SetRuns(SizeT num)
+{
+    n_assert(num > 0);
+    this->numRuns = num;
+}
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+BenchmarkRunner::SetFilter(const Util::String& f)
+{
+    this->filter = f;
+}
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+BenchmarkRunner::SetJsonOutput(const IO::URI& uri)
+{
+    this->jsonUri = uri;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+BenchmarkRunner::SetBaseline(const IO::URI& uri)
+{
+    this->baselineUri = uri;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+BenchmarkRunner::SetRegressionThreshold(float threshold)
+{
+    this->regressionThreshold = threshold;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const Util::Array<BenchmarkResult>&
+BenchmarkRunner::GetResults() const
+{
+    return this->results;
+}
+
+} // namespace Benchmark
+//------------------------------------------------------------------------------
+#endif
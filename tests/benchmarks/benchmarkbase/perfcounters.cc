@@ -0,0 +1,146 @@
+//------------------------------------------------------------------------------
+//  perfcounters.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "perfcounters.h"
+
+#if __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+namespace Benchmarking
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+PerfCounters::PerfCounters()
+{
+    for (IndexT i = 0; i < NumCounters; i++)
+    {
+        this->fds[i] = -1;
+        this->values[i] = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+PerfCounters::~PerfCounters()
+{
+    this->Discard();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+PerfCounters::Setup()
+{
+    bool anyValid = false;
+#if __linux__
+    static const uint64_t configs[NumCounters] =
+    {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (IndexT i = 0; i < NumCounters; i++)
+    {
+        n_assert(this->fds[i] == -1);
+
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        // calling thread, any cpu
+        this->fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        anyValid |= this->fds[i] != -1;
+    }
+#endif
+    return anyValid;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PerfCounters::Discard()
+{
+#if __linux__
+    for (IndexT i = 0; i < NumCounters; i++)
+    {
+        if (this->fds[i] != -1)
+            close(this->fds[i]);
+        this->fds[i] = -1;
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PerfCounters::Start()
+{
+#if __linux__
+    for (IndexT i = 0; i < NumCounters; i++)
+    {
+        if (this->fds[i] != -1)
+        {
+            ioctl(this->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(this->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PerfCounters::Stop()
+{
+#if __linux__
+    for (IndexT i = 0; i < NumCounters; i++)
+    {
+        this->values[i] = 0;
+        if (this->fds[i] != -1)
+        {
+            ioctl(this->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t value;
+            if (read(this->fds[i], &value, sizeof(value)) == sizeof(value))
+                this->values[i] = value;
+        }
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+const char*
+PerfCounters::GetName(Counter counter)
+{
+    switch (counter)
+    {
+        case Cycles:        return "cycles";
+        case Instructions:  return "instructions";
+        case CacheMisses:   return "cacheMisses";
+        case BranchMisses:  return "branchMisses";
+        default:            n_error("PerfCounters::GetName(): invalid counter!"); return "";
+    }
+}
+
+} // namespace Benchmarking
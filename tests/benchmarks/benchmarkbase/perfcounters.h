@@ -0,0 +1,84 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::PerfCounters
+
+    Hardware performance counters of the calling thread. On Linux these are
+    read through perf_event_open(), on other platforms, or when the kernel
+    doesn't allow user space counting (see /proc/sys/kernel/perf_event_paranoid),
+    no counter is valid and the runner only reports times.
+
+    Counters which the CPU or a virtual machine doesn't provide are skipped
+    individually.
+
+    Only the thread which calls Setup() is counted. Work done on job threads
+    doesn't show up, so for benchmarks which go wide the counters describe
+    the main thread only, and the JSON output says so in "counterScope".
+
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "core/types.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class PerfCounters
+{
+public:
+    enum Counter
+    {
+        Cycles,
+        Instructions,
+        CacheMisses,
+        BranchMisses,
+
+        NumCounters
+    };
+
+    /// constructor
+    PerfCounters();
+    /// destructor
+    ~PerfCounters();
+
+    /// open the counters, returns false if none is available
+    bool Setup();
+    /// close the counters
+    void Discard();
+    /// return true if a counter could be opened
+    bool IsValid(Counter counter) const;
+
+    /// reset and start counting
+    void Start();
+    /// stop counting and read the values
+    void Stop();
+    /// get the value counted between the last Start() and Stop()
+    uint64_t GetValue(Counter counter) const;
+
+    /// get the name of a counter, as used in the JSON output
+    static const char* GetName(Counter counter);
+
+private:
+    int fds[NumCounters];
+    uint64_t values[NumCounters];
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+PerfCounters::IsValid(Counter counter) const
+{
+    return this->fds[counter] != -1;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+PerfCounters::GetValue(Counter counter) const
+{
+    return this->values[counter];
+}
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------
+//  animsampling.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "animsampling.h"
+#include "coreanimation/animation.h"
+#include "math/quat.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::AnimSampling, 'ANSB', Benchmarking::Benchmark);
+
+using namespace Timing;
+using namespace Math;
+using namespace CoreAnimation;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AnimSampling::Run(Timer& timer)
+{
+    const SizeT NumJoints = 96;
+    const SizeT NumKeys = 64;
+    const Tick KeyDuration = 33;
+    const SizeT NumCharacters = 1000;
+    const SizeT NumFrames = 10;
+
+    // translation, rotation and scale curve per joint, keys are stored as 4 floats
+    const SizeT numCurves = NumJoints * 3;
+    AnimClip clip;
+    clip.numCurves = numCurves;
+    clip.firstCurve = 0;
+    clip.duration = (NumKeys - 1) * KeyDuration;
+    Util::FixedArray<AnimCurve> curves(numCurves);
+    Util::FixedArray<AnimKeyBuffer::Interval> intervals(numCurves * (NumKeys - 1));
+    Util::FixedArray<float> keys(numCurves * NumKeys * 4);
+    Util::FixedArray<vec4> idleSamples(numCurves, vec4(0, 0, 0, 1));
+    for (IndexT c = 0; c < numCurves; c++)
+    {
+        AnimCurve& curve = curves[c];
+        curve.firstIntervalOffset = c * (NumKeys - 1);
+        curve.numIntervals = NumKeys - 1;
+        curve.preInfinityType = InfinityType::Cycle;
+        curve.postInfinityType = InfinityType::Cycle;
+        curve.curveType = (c % 3) == 0 ? CurveType::Translation : (c % 3) == 1 ? CurveType::Rotation : CurveType::Scale;
+
+        for (IndexT k = 0; k < NumKeys; k++)
+        {
+            float* key = &keys[(c * NumKeys + k) * 4];
+            if (curve.curveType == CurveType::Rotation)
+            {
+                quat q = rotationquataxis(vec3(0, 1, 0), k * 0.1f);
+                q.store(key);
+            }
+            else
+            {
+                key[0] = 1.0f + k * 0.01f;
+                key[1] = c * 0.01f;
+                key[2] = 1.0f;
+                key[3] = 0.0f;
+            }
+        }
+        for (IndexT k = 0; k < NumKeys - 1; k++)
+        {
+            AnimKeyBuffer::Interval& interval = intervals[curve.firstIntervalOffset + k];
+            interval.start = k * KeyDuration;
+            interval.end = (k + 1) * KeyDuration;
+            interval.key0 = (c * NumKeys + k) * 4;
+            interval.key1 = (c * NumKeys + k + 1) * 4;
+            interval.duration = 1.0f / KeyDuration;
+        }
+    }
+
+    // per character state, two clips are sampled and mixed
+    const SizeT numFloats = numCurves * 4;
+    Util::FixedArray<uint> lastIntervals(NumCharacters * numCurves * 2, 0);
+    Util::FixedArray<float> samples(NumCharacters * numFloats * 2);
+    Util::FixedArray<uchar> sampleCounts(NumCharacters * numCurves * 2);
+
+    Timer local;
+    local.Reset(); local.Start(); timer.Start();
+    for (IndexT frame = 0; frame < NumFrames; frame++)
+    {
+        for (IndexT i = 0; i < NumCharacters; i++)
+        {
+            const Tick time0 = (i * 17 + frame * 16) % clip.duration;
+            const Tick time1 = (i * 31 + frame * 16) % clip.duration;
+            float* out0 = &samples[i * numFloats * 2];
+            float* out1 = out0 + numFloats;
+            uchar* counts0 = &sampleCounts[i * numCurves * 2];
+            uchar* counts1 = counts0 + numCurves;
+            uint* last0 = &lastIntervals[i * numCurves * 2];
+            uint* last1 = last0 + numCurves;
+
+            AnimSampleLinear(clip, curves, time0, vec4(1), idleSamples, keys.Begin(), intervals.Begin(), last0, out0, counts0);
+            AnimSampleLinear(clip, curves, time1, vec4(1), idleSamples, keys.Begin(), intervals.Begin(), last1, out1, counts1);
+            AnimMix(clip, numCurves, nullptr, 0.5f, out0, out1, counts0, counts1, out0, counts0);
+        }
+    }
+    timer.Stop(); local.Stop();
+    n_printf("sample and mix %d joints for %d characters, %d frames: %f\n", NumJoints, NumCharacters, NumFrames, local.GetTime());
+}
+
+} // namespace Benchmarking
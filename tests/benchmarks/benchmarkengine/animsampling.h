@@ -0,0 +1,25 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::AnimSampling
+    
+    Benchmark sampling and mixing a synthetic skeletal animation clip for a
+    crowd of characters, like the character context does every frame.
+    
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class AnimSampling : public Benchmark
+{
+    __DeclareClass(AnimSampling);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -0,0 +1,56 @@
+//------------------------------------------------------------------------------
+//  main.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "core/coreserver.h"
+#include "core/sysfunc.h"
+#include "io/ioserver.h"
+#include "jobs2/jobs2.h"
+#include "system/systeminfo.h"
+#include "util/commandlineargs.h"
+#include "benchmarkbase/benchmarkrunner.h"
+
+#include "memdbbenchmark.h"
+#include "visibilityculling.h"
+#include "animsampling.h"
+#include "physicsstress.h"
+
+using namespace Core;
+using namespace Benchmarking;
+
+int __cdecl
+main(int argc, const char** argv)
+{
+    // create Nebula runtime
+    Ptr<CoreServer> coreServer = CoreServer::Create();
+    coreServer->SetAppName(Util::StringAtom("Nebula Engine Benchmark Runner"));
+    coreServer->Open();
+    Ptr<IO::IoServer> ioServer = IO::IoServer::Create();
+
+    Jobs2::JobSystemInitInfo jobSystemInit;
+    jobSystemInit.name = "JobSystem";
+    jobSystemInit.numThreads = System::NumCpuCores;
+    jobSystemInit.scratchMemorySize = 16_MB;
+    jobSystemInit.affinity = System::Cpu::All;
+    Jobs2::JobSystemInit(jobSystemInit);
+
+    // setup and run benchmarks
+    Ptr<BenchmarkRunner> runner = BenchmarkRunner::Create();
+    runner->ParseArgs(Util::CommandLineArgs(argc, argv));
+    runner->AttachBenchmark(MemDbQuery::Create());
+    runner->AttachBenchmark(MemDbMigrate::Create());
+    runner->AttachBenchmark(VisibilityCulling::Create());
+    runner->AttachBenchmark(AnimSampling::Create());
+    runner->AttachBenchmark(PhysicsStress::Create());
+    SizeT numRegressions = runner->Run();
+
+    // shutdown Nebula runtime
+    runner = nullptr;
+    Jobs2::JobSystemUninit();
+    ioServer = nullptr;
+    coreServer->Close();
+    coreServer = nullptr;
+    SysFunc::Exit(numRegressions > 0 ? 1 : 0);
+    return 0;
+}
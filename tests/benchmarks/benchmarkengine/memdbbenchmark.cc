@@ -0,0 +1,161 @@
+//------------------------------------------------------------------------------
+//  memdbbenchmark.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "memdbbenchmark.h"
+#include "memdb/database.h"
+#include "memdb/attributeregistry.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::MemDbQuery, 'MDQB', Benchmarking::Benchmark);
+__ImplementClass(Benchmarking::MemDbMigrate, 'MDMB', Benchmarking::Benchmark);
+
+using namespace Timing;
+using namespace MemDb;
+
+template <int N>
+struct BenchAttribute
+{
+    float value[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+};
+
+static const SizeT NumAttributes = 8;
+static AttributeId attributes[NumAttributes];
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+RegisterAttributes()
+{
+    static bool registered = false;
+    if (registered)
+        return;
+    attributes[0] = AttributeRegistry::Register<BenchAttribute<0>>("BenchAttribute0", BenchAttribute<0>());
+    attributes[1] = AttributeRegistry::Register<BenchAttribute<1>>("BenchAttribute1", BenchAttribute<1>());
+    attributes[2] = AttributeRegistry::Register<BenchAttribute<2>>("BenchAttribute2", BenchAttribute<2>());
+    attributes[3] = AttributeRegistry::Register<BenchAttribute<3>>("BenchAttribute3", BenchAttribute<3>());
+    attributes[4] = AttributeRegistry::Register<BenchAttribute<4>>("BenchAttribute4", BenchAttribute<4>());
+    attributes[5] = AttributeRegistry::Register<BenchAttribute<5>>("BenchAttribute5", BenchAttribute<5>());
+    attributes[6] = AttributeRegistry::Register<BenchAttribute<6>>("BenchAttribute6", BenchAttribute<6>());
+    attributes[7] = AttributeRegistry::Register<BenchAttribute<7>>("BenchAttribute7", BenchAttribute<7>());
+    registered = true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Creates a table for every combination of the attributes 1 to 7, all
+    tables have attribute 0.
+*/
+static Ptr<Database>
+CreateDatabase(SizeT rowsPerTable)
+{
+    RegisterAttributes();
+    Ptr<Database> db = Database::Create();
+    for (uint mask = 0; mask < (1 << (NumAttributes - 1)); mask++)
+    {
+        AttributeId ids[NumAttributes];
+        SizeT numIds = 0;
+        ids[numIds++] = attributes[0];
+        for (IndexT i = 1; i < NumAttributes; i++)
+        {
+            if (mask & (1 << (i - 1)))
+                ids[numIds++] = attributes[i];
+        }
+
+        TableCreateInfo info;
+        info.name = Util::String::Sprintf("BenchTable%d", mask);
+        info.attributeIds = ids;
+        info.numAttributes = numIds;
+        Table& table = db->GetTable(db->CreateTable(info));
+        for (IndexT row = 0; row < rowsPerTable; row++)
+            table.AddRow();
+    }
+    return db;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MemDbQuery::Run(Timer& timer)
+{
+    const SizeT RowsPerTable = 2048;
+    const SizeT NumQueries = 1000;
+    Ptr<Database> db = CreateDatabase(RowsPerTable);
+    Timer local;
+
+    // queries which match a quarter of the tables, like a typical system
+    FilterSet filter({ attributes[0], attributes[1], attributes[2] }, { attributes[7] });
+    SizeT numViews = 0;
+    local.Reset(); local.Start(); timer.Start();
+    for (IndexT i = 0; i < NumQueries; i++)
+    {
+        Dataset data = db->Query(filter);
+        numViews += data.tables.Size();
+    }
+    timer.Stop(); local.Stop();
+    n_printf("%d queries over %d tables, %d views: %f\n", NumQueries, db->GetNumTables(), numViews / NumQueries, local.GetTime());
+
+    // query and touch every matching row
+    float sum = 0.0f;
+    local.Reset(); local.Start(); timer.Start();
+    for (IndexT i = 0; i < 100; i++)
+    {
+        Dataset data = db->Query(filter);
+        for (const Dataset::View& view : data.tables)
+        {
+            BenchAttribute<0>* a = (BenchAttribute<0>*)view.buffers[0];
+            const BenchAttribute<1>* b = (const BenchAttribute<1>*)view.buffers[1];
+            for (IndexT row = 0; row < view.numInstances; row++)
+            {
+                a[row].value[0] += b[row].value[1];
+                sum += a[row].value[0];
+            }
+        }
+    }
+    timer.Stop(); local.Stop();
+    n_printf("100 query and update passes: %f (%f)\n", local.GetTime(), sum);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MemDbMigrate::Run(Timer& timer)
+{
+    const SizeT RowsPerTable = 64;
+    const SizeT NumRows = 50000;
+    Ptr<Database> db = CreateDatabase(RowsPerTable);
+    Timer local;
+
+    AttributeId srcIds[] = { attributes[0], attributes[1], attributes[2] };
+    AttributeId dstIds[] = { attributes[0], attributes[1], attributes[2], attributes[3] };
+    Table& src = db->GetTable(db->FindTable(TableSignature(srcIds, 3)));
+    Table& dst = db->GetTable(db->FindTable(TableSignature(dstIds, 4)));
+
+    Util::Array<RowId> rows;
+    rows.Reserve(NumRows);
+    for (IndexT i = 0; i < NumRows; i++)
+        rows.Append(src.AddRow());
+
+    // one row at a time, like adding a component to single entities
+    local.Reset(); local.Start(); timer.Start();
+    Util::Array<RowId> movedRows;
+    movedRows.Reserve(NumRows);
+    for (IndexT i = NumRows - 1; i >= 0; i--)
+        movedRows.Append(Table::MigrateInstance(src, rows[i], dst, false));
+    timer.Stop(); local.Stop();
+    n_printf("migrate %d rows one by one: %f\n", NumRows, local.GetTime());
+
+    // all rows back in one batch
+    Util::FixedArray<RowId> dstRows;
+    local.Reset(); local.Start(); timer.Start();
+    Table::MigrateInstances(dst, movedRows, src, dstRows);
+    timer.Stop(); local.Stop();
+    n_printf("migrate %d rows in a batch: %f\n", NumRows, local.GetTime());
+}
+
+} // namespace Benchmarking
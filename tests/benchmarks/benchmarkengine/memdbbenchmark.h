@@ -0,0 +1,38 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::MemDbQuery
+    
+    Benchmark MemDb queries over many tables and iteration over the
+    resulting dataset.
+
+    @class Benchmarking::MemDbMigrate
+
+    Benchmark moving rows between MemDb tables, like adding and removing
+    components from entities does.
+    
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class MemDbQuery : public Benchmark
+{
+    __DeclareClass(MemDbQuery);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+class MemDbMigrate : public Benchmark
+{
+    __DeclareClass(MemDbMigrate);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
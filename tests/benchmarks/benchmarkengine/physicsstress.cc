@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+//  physicsstress.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "physicsstress.h"
+#include "physics/physxstate.h"
+#include "jobs2/jobs2.h"
+#include "system/systeminfo.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::PhysicsStress, 'PHSB', Benchmarking::Benchmark);
+
+using namespace Timing;
+using namespace physx;
+
+//------------------------------------------------------------------------------
+/**
+    Restart the job system with the settings it was set up with, only
+    changing the number of job threads.
+*/
+static void
+RestartJobSystem(const Jobs2::JobSystemInitInfo& info, SizeT numThreads)
+{
+    Jobs2::JobSystemInitInfo jobSystemInit = info;
+    jobSystemInit.numThreads = numThreads;
+    Jobs2::JobSystemUninit();
+    Jobs2::JobSystemInit(jobSystemInit);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PhysicsStress::Run(Timer& timer)
+{
+    const SizeT PileSize = 20;
+    const SizeT PileHeight = 10;
+    const SizeT NumPiles = 4;
+    const SizeT NumFrames = 120;
+
+    Physics::PhysxState& state = Physics::state;
+    state.Setup();
+    PxMaterial* material = state.physics->createMaterial(0.5f, 0.5f, 0.1f);
+
+    // measure with an increasing number of job threads and restore the original job system afterwards
+    const SizeT numCores = System::NumCpuCores;
+    const Jobs2::JobSystemInitInfo originalInit = Jobs2::ctx.initInfo;
+    Util::Array<SizeT> threadCounts;
+    for (SizeT numThreads : { 1, 2, 4 })
+    {
+        if (numThreads < numCores)
+            threadCounts.Append(numThreads);
+    }
+    threadCounts.Append(numCores);
+
+    for (SizeT numThreads : threadCounts)
+    {
+        RestartJobSystem(originalInit, numThreads);
+
+        // every run steps an identical scene, piles of boxes which are slightly offset so they topple over
+        IndexT sceneId = Physics::CreateScene();
+        Physics::Scene& scene = Physics::GetScene(sceneId);
+        Util::Array<PxRigidActor*> actors;
+        actors.Reserve(PileSize * PileSize * PileHeight * NumPiles + 1);
+        PxRigidStatic* ground = PxCreatePlane(*state.physics, PxPlane(0.0f, 1.0f, 0.0f, 0.0f), *material);
+        scene.scene->addActor(*ground);
+        actors.Append(ground);
+        for (IndexT pile = 0; pile < NumPiles; pile++)
+        {
+            const float pileX = (pile % 2) * (PileSize + 4.0f);
+            const float pileZ = (pile / 2) * (PileSize + 4.0f);
+            for (IndexT y = 0; y < PileHeight; y++)
+            {
+                for (IndexT z = 0; z < PileSize; z++)
+                {
+                    for (IndexT x = 0; x < PileSize; x++)
+                    {
+                        PxTransform pose(PxVec3(pileX + x * 1.02f + y * 0.1f, 0.5f + y * 1.05f, pileZ + z * 1.02f));
+                        PxRigidDynamic* body = state.physics->createRigidDynamic(pose);
+                        PxRigidActorExt::createExclusiveShape(*body, PxBoxGeometry(0.5f, 0.5f, 0.5f), *material);
+                        PxRigidBodyExt::updateMassAndInertia(*body, 1.0f);
+                        scene.scene->addActor(*body);
+                        actors.Append(body);
+                    }
+                }
+            }
+        }
+
+        Timer local;
+        local.Reset(); local.Start(); timer.Start();
+        for (IndexT frame = 0; frame < NumFrames; frame++)
+        {
+            state.Update(PHYSICS_RATE);
+        }
+        timer.Stop(); local.Stop();
+        n_printf("step %d dynamic bodies for %d frames on %d job threads: %f (%.3f ms per frame)\n",
+            actors.Size() - 1, NumFrames, numThreads, local.GetTime(), local.GetTime() * 1000.0 / NumFrames);
+
+        for (PxRigidActor* actor : actors)
+        {
+            actor->release();
+        }
+        Physics::DestroyScene(sceneId);
+    }
+    RestartJobSystem(originalInit, originalInit.numThreads);
+
+    material->release();
+    state.Shutdown();
+}
+
+} // namespace Benchmarking
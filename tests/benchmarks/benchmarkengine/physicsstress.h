@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::PhysicsStress
+    
+    Benchmark stepping a physics scene with a few thousand dynamic boxes
+    falling onto a ground plane and piling up, with the PhysX tasks running
+    on different numbers of job system threads.
+    
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class PhysicsStress : public Benchmark
+{
+    __DeclareClass(PhysicsStress);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+//  visibilityculling.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "visibilityculling.h"
+#include "visibility/systems/bruteforcesystem.h"
+#include "math/clipstatus.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::VisibilityCulling, 'VCLB', Benchmarking::Benchmark);
+
+using namespace Timing;
+using namespace Math;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VisibilityCulling::Run(Timer& timer)
+{
+    const SizeT NumEntities = 200000;
+    const SizeT NumObservers = 4;
+    const SizeT NumFrames = 10;
+
+    // boxes on a grid, flags and stages set up like the model context does
+    Util::FixedArray<bbox> boxes(NumEntities);
+    Util::FixedArray<uint32_t> ids(NumEntities);
+    Util::FixedArray<uint32_t> flags(NumEntities, 0);
+    Util::FixedArray<Graphics::StageMask> stages(NumEntities, Graphics::PRIMARY_STAGE_MASK);
+    Util::FixedArray<Graphics::GraphicsEntityId> entities(NumEntities);
+    const SizeT gridSize = (SizeT)Math::sqrt((float)NumEntities);
+    for (IndexT i = 0; i < NumEntities; i++)
+    {
+        boxes[i] = bbox(point((i % gridSize) * 4.0f - gridSize * 2.0f, 0.0f, (i / gridSize) * 4.0f - gridSize * 2.0f), vector(1.0f));
+        ids[i] = i;
+        entities[i] = Graphics::GraphicsEntityId{ (Ids::Id32)i };
+    }
+
+    // observers looking into different directions from the center
+    Util::FixedArray<mat4> transforms(NumObservers);
+    Util::FixedArray<Graphics::StageMask> observerStages(NumObservers, Graphics::PRIMARY_STAGE_MASK);
+    bool orthoFlags[NumObservers] = {};
+    Util::FixedArray<Util::Array<ClipStatus::Type>> results(NumObservers);
+    const mat4 proj = perspfovrh(deg2rad(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    for (IndexT i = 0; i < NumObservers; i++)
+    {
+        float angle = i * N_PI * 2.0f / NumObservers;
+        const mat4 view = inverse(lookatrh(point(0, 10, 0), point(Math::cos(angle), 10, Math::sin(angle)), vector::upvec()));
+        transforms[i] = proj * view;
+        results[i].Resize(NumEntities);
+    }
+
+    Visibility::VisibilitySystem* system = new Visibility::BruteforceSystem;
+    system->PrepareObservers(transforms.Begin(), orthoFlags, observerStages.Begin(), results.Begin(), NumObservers);
+    system->PrepareEntities(boxes.Begin(), ids.Begin(), stages.Begin(), entities.Begin(), flags.Begin(), NumEntities);
+
+    Timer local;
+    local.Reset(); local.Start(); timer.Start();
+    for (IndexT frame = 0; frame < NumFrames; frame++)
+    {
+        Jobs2::JobNewFrame();
+        for (IndexT i = 0; i < NumObservers; i++)
+            results[i].Fill(0, NumEntities, ClipStatus::Outside);
+        system->Run(nullptr, nullptr);
+
+        const Threading::AtomicCounter* counters = system->GetCompletionCounters();
+        for (IndexT i = 0; i < NumObservers; i++)
+        {
+            while (counters[i] != 0)
+                Threading::Thread::YieldThread();
+        }
+    }
+    timer.Stop(); local.Stop();
+
+    SizeT numVisible = 0;
+    for (IndexT i = 0; i < NumObservers; i++)
+    {
+        for (IndexT j = 0; j < NumEntities; j++)
+            numVisible += results[i][j] != ClipStatus::Outside;
+    }
+    n_printf("cull %d boxes against %d observers for %d frames: %f (%d visible per frame)\n", NumEntities, NumObservers, NumFrames, local.GetTime(), numVisible);
+    delete system;
+}
+
+} // namespace Benchmarking
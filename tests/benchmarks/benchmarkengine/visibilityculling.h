@@ -0,0 +1,25 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::VisibilityCulling
+    
+    Benchmark frustum culling of a large number of bounding boxes against
+    several observers with the brute force visibility system on Jobs2.
+    
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class VisibilityCulling : public Benchmark
+{
+    __DeclareClass(VisibilityCulling);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
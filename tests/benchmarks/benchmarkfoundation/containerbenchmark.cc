@@ -7,9 +7,13 @@
 #include "util/queue.h"
 #include "util/arrayqueue.h"
 #include "util/list.h"
+#include "util/hashtable.h"
+#include "util/flathashtable.h"
+#include "util/dictionary.h"
 
 
 const int numObjects = 50000;
+const int numMapKeys = 20000;
 
 #define DECLARE_CB_TEST(name, ctype, dtype) ContainerBenchmark<ctype<dtype>, dtype> name;
 #define SETUP_CB_TEST(cb, data, addfunc, rmfunc ) cb.Setup(data, [](decltype(cb)::ctype& c, decltype(cb)::dtype d) { c.addfunc(d); },  [&](decltype(cb)::ctype& c) { return c.rmfunc(); } );
@@ -55,7 +59,40 @@ ContainerBench::Run(Timer& timer)
     RUN_CB_TEST(cbs, timer);    
     RUN_CB_TEST(cbqs, timer);
     RUN_CB_TEST(cbls, timer);
-    
+
+    // maps, keys are shuffled so sorted containers don't get an easy ride
+    Util::Array<int> intKeys, missingIntKeys;
+    Util::Array<Util::String> stringKeys, missingStringKeys;
+    uint seed = 12345;
+    for (int i = 0; i < numMapKeys; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        intKeys.Append(i * 2);
+        missingIntKeys.Append(i * 2 + 1);
+        stringKeys.Append(Util::String::Sprintf("key_%d", i * 2));
+        missingStringKeys.Append(Util::String::Sprintf("key_%d", i * 2 + 1));
+    }
+    for (int i = numMapKeys - 1; i > 0; i--)
+    {
+        seed = seed * 1664525 + 1013904223;
+        int j = (seed >> 8) % (i + 1);
+        int tmp = intKeys[i]; intKeys[i] = intKeys[j]; intKeys[j] = tmp;
+        Util::String stmp = stringKeys[i]; stringKeys[i] = stringKeys[j]; stringKeys[j] = stmp;
+    }
+
+    MapBenchmark<Util::HashTable<int, int>, int> mhi;
+    MapBenchmark<Util::FlatHashTable<int, int>, int> mfi;
+    MapBenchmark<Util::Dictionary<int, int>, int> mdi;
+    mhi.Run(timer, intKeys, missingIntKeys);
+    mfi.Run(timer, intKeys, missingIntKeys);
+    mdi.Run(timer, intKeys, missingIntKeys);
+
+    MapBenchmark<Util::HashTable<Util::String, int>, Util::String> mhs;
+    MapBenchmark<Util::FlatHashTable<Util::String, int>, Util::String> mfs;
+    MapBenchmark<Util::Dictionary<Util::String, int>, Util::String> mds;
+    mhs.Run(timer, stringKeys, missingStringKeys);
+    mfs.Run(timer, stringKeys, missingStringKeys);
+    mds.Run(timer, stringKeys, missingStringKeys);
 }
 
 } // namespace Benchmarking
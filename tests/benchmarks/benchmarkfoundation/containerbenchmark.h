@@ -104,6 +104,53 @@ public:
 };
 
 
+template<typename MAP, typename KEY>
+class MapBenchmark
+{
+public:
+    void Run(Timing::Timer& timer, const Util::Array<KEY>& keys, const Util::Array<KEY>& missingKeys)
+    {
+        n_printf("benchmarking map type: %s\n", typeid(MAP).name());
+        SizeT numKeys = keys.Size();
+        Timing::Time start = timer.GetTime();
+        MAP m;
+        for (IndexT i = 0; i < numKeys; i++)
+        {
+            m.Add(keys[i], i);
+        }
+        Timing::Time last = timer.GetTime();
+        n_printf("insert %d keys: %f\n", numKeys, last - start);
+
+        SizeT found = 0;
+        for (IndexT i = 0; i < numKeys; i++)
+        {
+            found += m.Contains(keys[i]) ? 1 : 0;
+        }
+        Timing::Time now = timer.GetTime();
+        n_printf("lookup %d existing keys: %f\n", numKeys, now - last);
+        last = now;
+
+        for (IndexT i = 0; i < missingKeys.Size(); i++)
+        {
+            found += m.Contains(missingKeys[i]) ? 1 : 0;
+        }
+        now = timer.GetTime();
+        n_printf("lookup %d missing keys: %f\n", missingKeys.Size(), now - last);
+        last = now;
+        n_assert(found == numKeys);
+
+        for (IndexT i = 0; i < numKeys; i++)
+        {
+            m.Erase(keys[i]);
+        }
+        now = timer.GetTime();
+        n_printf("erase %d keys: %f\n", numKeys, now - last);
+        last = now;
+
+        n_printf("Total time: %f\n", last - start);
+        n_printf("---------------------------------------------------------------\n");
+    }
+};
 
 class ContainerBench : public Benchmark
 {
@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------------
+//  jobs2dispatch.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "jobs2dispatch.h"
+#include "jobs2/jobs2.h"
+#include "threading/event.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::Jobs2Dispatch, 'J2DB', Benchmarking::Benchmark);
+
+using namespace Timing;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Jobs2Dispatch::Run(Timer& timer)
+{
+    n_assert(Jobs2::ctx.threads.Size() > 0);
+    Timer local;
+
+    // many tiny dispatches, measures queueing and wakeup cost
+    const SizeT NumTinyJobs = 4096;
+    Util::FixedArray<uint> tinyResults(NumTinyJobs, 0);
+    Jobs2::JobNewFrame();
+    {
+        Threading::AtomicCounter doneCounter = NumTinyJobs;
+        Threading::Event event;
+        local.Reset(); local.Start(); timer.Start();
+        for (IndexT i = 0; i < NumTinyJobs; i++)
+        {
+            Jobs2::JobDispatch([result = &tinyResults[i], i](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+            {
+                *result = i * 2654435761u;
+            }, 1, 1, nullptr, &doneCounter, &event);
+        }
+        event.Wait();
+        timer.Stop(); local.Stop();
+        n_printf("dispatch %d tiny jobs: %f\n", NumTinyJobs, local.GetTime());
+    }
+
+    // one large parallel loop, measures distribution over the threads
+    const SizeT NumElements = 4 * 1024 * 1024;
+    Util::FixedArray<float> values(NumElements, 1.0f);
+    Jobs2::JobNewFrame();
+    {
+        Threading::Event event;
+        local.Reset(); local.Start(); timer.Start();
+        Jobs2::JobDispatch([data = values.Begin()](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+        {
+            for (IndexT i = 0; i < groupSize; i++)
+            {
+                IndexT index = i + invocationOffset;
+                if (index >= totalJobs)
+                    return;
+                data[index] = data[index] * 1.0001f + 0.5f;
+            }
+        }, NumElements, 4096, nullptr, nullptr, &event);
+        event.Wait();
+        timer.Stop(); local.Stop();
+        n_printf("parallel loop over %d elements: %f\n", NumElements, local.GetTime());
+    }
+
+    // a chain of small jobs where each waits for the previous one, measures dependency latency
+    const SizeT NumSequenceJobs = 256;
+    Jobs2::JobNewFrame();
+    {
+        Threading::Event event;
+        local.Reset(); local.Start(); timer.Start();
+        Jobs2::JobBeginSequence();
+        for (IndexT i = 0; i < NumSequenceJobs; i++)
+        {
+            Jobs2::JobAppendSequence([data = values.Begin()](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+            {
+                for (IndexT i = 0; i < groupSize; i++)
+                {
+                    IndexT index = i + invocationOffset;
+                    if (index >= totalJobs)
+                        return;
+                    data[index] += 1.0f;
+                }
+            }, 256, 16);
+        }
+        Jobs2::JobEndSequence(&event);
+        event.Wait();
+        timer.Stop(); local.Stop();
+        n_printf("sequence of %d dependent jobs: %f\n", NumSequenceJobs, local.GetTime());
+    }
+}
+
+} // namespace Benchmarking
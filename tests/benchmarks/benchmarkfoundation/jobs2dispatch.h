@@ -0,0 +1,25 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::Jobs2Dispatch
+    
+    Benchmark Jobs2 dispatch overhead with many tiny jobs, throughput of a
+    large parallel loop and latency of a dependent job sequence.
+    
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class Jobs2Dispatch : public Benchmark
+{
+    __DeclareClass(Jobs2Dispatch);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
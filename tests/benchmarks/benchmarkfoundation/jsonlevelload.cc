@@ -0,0 +1,123 @@
+//------------------------------------------------------------------------------
+//  jsonlevelload.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "jsonlevelload.h"
+#include "io/memorystream.h"
+#include "io/jsonreader.h"
+#include "io/jsonwriter.h"
+#include "util/guid.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::JsonLevelLoad, 'JLLB', Benchmarking::Benchmark);
+
+using namespace Timing;
+using namespace Math;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+WriteLevel(const Ptr<IO::Stream>& stream, SizeT numEntities)
+{
+    Ptr<IO::JsonWriter> writer = IO::JsonWriter::Create();
+    writer->SetStream(stream);
+    n_assert(writer->Open());
+    writer->BeginObject("level");
+    writer->Add(100, "version");
+    writer->BeginObject("entities");
+    for (IndexT i = 0; i < numEntities; i++)
+    {
+        Util::Guid guid;
+        guid.Generate();
+        writer->BeginObject(guid.AsString().AsCharPtr());
+        writer->Add(Util::String::Sprintf("entity_%d", i), "name");
+        writer->BeginObject("components");
+        writer->Add(vec4(i * 2.0f, 0.0f, i * 0.5f, 1.0f), "WorldTransform");
+        writer->Add(vec4(0.0f, 0.0f, 0.0f, 1.0f), "Orientation");
+        writer->Add(vec3(1.0f, 1.0f, 1.0f), "Scale");
+        writer->Add(Util::String::Sprintf("mdl:environment/rock_%d.n3", i % 32), "ModelResource");
+        writer->BeginObject("PointLight");
+        writer->Add(vec4(1.0f, 0.8f, 0.6f, 1.0f), "color");
+        writer->Add(10.0f + i % 7, "range");
+        writer->Add((i & 1) == 0, "castShadows");
+        writer->End();
+        writer->End();
+        writer->End();
+    }
+    writer->End();
+    writer->End();
+    writer->Close();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Mirrors what LevelParser does per entity, without creating entities.
+*/
+static SizeT
+ReadLevel(const Ptr<IO::Stream>& stream)
+{
+    Ptr<IO::JsonReader> reader = IO::JsonReader::Create();
+    reader->SetStream(stream);
+    n_assert(reader->Open());
+
+    SizeT numComponents = 0;
+    float checksum = 0.0f;
+    reader->SetToRoot();
+    if (reader->SetToNode("/level"))
+    {
+        n_assert(reader->GetInt("version") == 100);
+        if (reader->SetToFirstChild("entities") && reader->SetToFirstChild()) do
+        {
+            Util::Guid guid = Util::Guid::FromString(reader->GetCurrentNodeName());
+            Util::String name = reader->GetOptString("name", "unnamed_entity");
+            if (reader->SetToFirstChild("components"))
+            {
+                SizeT numChildren = reader->CurrentSize();
+                for (IndexT childIndex = 0; childIndex < numChildren; childIndex++)
+                {
+                    Util::String componentName = reader->GetChildNodeName(childIndex);
+                    if (componentName == "WorldTransform")
+                        checksum += reader->GetVec4(componentName.AsCharPtr()).x;
+                    else if (componentName == "ModelResource")
+                        checksum += reader->GetString(componentName.AsCharPtr()).Length();
+                    else if (componentName == "PointLight")
+                    {
+                        reader->SetToFirstChild(componentName);
+                        checksum += reader->GetFloat("range") + reader->GetVec4("color").x + reader->GetBool("castShadows");
+                        reader->SetToParent();
+                    }
+                    numComponents++;
+                }
+                reader->SetToParent();
+            }
+        } while (reader->SetToNextChild());
+    }
+    reader->Close();
+    n_assert(checksum > 0.0f);
+    return numComponents;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+JsonLevelLoad::Run(Timer& timer)
+{
+    const SizeT sizes[] = { 1000, 20000 };
+    for (SizeT numEntities : sizes)
+    {
+        Ptr<IO::MemoryStream> stream = IO::MemoryStream::Create();
+        WriteLevel(stream.upcast<IO::Stream>(), numEntities);
+
+        Timer local;
+        local.Reset(); local.Start(); timer.Start();
+        SizeT numComponents = ReadLevel(stream.upcast<IO::Stream>());
+        timer.Stop(); local.Stop();
+        n_printf("load level with %d entities, %d components, %d bytes: %f\n", numEntities, numComponents, stream->GetSize(), local.GetTime());
+    }
+}
+
+} // namespace Benchmarking
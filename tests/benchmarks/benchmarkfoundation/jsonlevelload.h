@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::JsonLevelLoad
+    
+    Benchmark parsing a large level file in the layout read by
+    BaseGameFeature::LevelParser, and walking all of its entities and
+    components with the JsonReader.
+    
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class JsonLevelLoad : public Benchmark
+{
+    __DeclareClass(JsonLevelLoad);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -6,6 +6,10 @@
 #include "stdneb.h"
 #include "core/coreserver.h"
 #include "core/sysfunc.h"
+#include "io/ioserver.h"
+#include "jobs2/jobs2.h"
+#include "system/systeminfo.h"
+#include "util/commandlineargs.h"
 #include "benchmarkbase/benchmarkrunner.h"
 
 #include "createobjects.h"
@@ -17,20 +21,32 @@
 #include "mempoolbenchmark.h"
 #include "containerbenchmark.h"
 #include "delegates.h"
+#include "jobs2dispatch.h"
+#include "jsonlevelload.h"
+#include "tcpserverconnections.h"
 
 using namespace Core;
 using namespace Benchmarking;
 
 int __cdecl
-main(int argc, char** argv)
+main(int argc, const char** argv)
 {
     // create Nebula runtime
     Ptr<CoreServer> coreServer = CoreServer::Create();
     coreServer->SetAppName(Util::StringAtom("Nebula Benchmark Runner"));
     coreServer->Open();
+    Ptr<IO::IoServer> ioServer = IO::IoServer::Create();
+
+    Jobs2::JobSystemInitInfo jobSystemInit;
+    jobSystemInit.name = "JobSystem";
+    jobSystemInit.numThreads = System::NumCpuCores;
+    jobSystemInit.scratchMemorySize = 16_MB;
+    jobSystemInit.affinity = System::Cpu::All;
+    Jobs2::JobSystemInit(jobSystemInit);
 
     // setup and run benchmarks
     Ptr<BenchmarkRunner> runner = BenchmarkRunner::Create();    
+    runner->ParseArgs(Util::CommandLineArgs(argc, argv));
     runner->AttachBenchmark(Matrix44Multiply::Create());
     runner->AttachBenchmark(Matrix44Inverse::Create());
     runner->AttachBenchmark(Float4Math::Create());
@@ -40,12 +56,17 @@ main(int argc, char** argv)
     runner->AttachBenchmark(CreateObjectsByClassName::Create());
     runner->AttachBenchmark(ContainerBench::Create());
     runner->AttachBenchmark(DelegateBench::Create());
-    runner->Run();
+    runner->AttachBenchmark(Jobs2Dispatch::Create());
+    runner->AttachBenchmark(JsonLevelLoad::Create());
+    runner->AttachBenchmark(TcpServerConnections::Create());
+    SizeT numRegressions = runner->Run();
     
     // shutdown Nebula runtime
     runner = nullptr;
+    Jobs2::JobSystemUninit();
+    ioServer = nullptr;
     coreServer->Close();
     coreServer = nullptr;
-    SysFunc::Exit(0);
+    SysFunc::Exit(numRegressions > 0 ? 1 : 0);
     return 0;
 }
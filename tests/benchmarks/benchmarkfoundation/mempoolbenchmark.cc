@@ -10,6 +10,7 @@
 namespace Benchmarking
 {
 __ImplementClass(Benchmarking::MemPoolBenchmark, 'MPBM', Benchmarking::Benchmark);
+__ImplementClass(Benchmarking::MemAllocThread, 'MATH', Threading::Thread);
 
 using namespace Timing;
 using namespace Memory;
@@ -82,7 +83,75 @@ MemPoolBenchmark::Run(Timer& timer)
     }
 
     Memory::Free(Memory::DefaultHeap, ptrs);
+
+    // concurrent alloc / free on the object heap
+    const SizeT MaxThreads = 8;
+    SizeT numThreads;
+    for (numThreads = 1; numThreads <= MaxThreads; numThreads *= 2)
+    {
+        Util::Array<Ptr<MemAllocThread>> threads;
+        IndexT i;
+        for (i = 0; i < numThreads; i++)
+        {
+            Ptr<MemAllocThread> thread = MemAllocThread::Create();
+            thread->SetName(Util::String::Sprintf("MemAllocThread%d", i));
+            thread->SetSeed(uint(i + 1) * 2654435761u);
+            threads.Append(thread);
+        }
+
+        memPoolTimer.Reset();
+        memPoolTimer.Start();
+        for (i = 0; i < numThreads; i++)
+        {
+            threads[i]->Start();
+        }
+        for (i = 0; i < numThreads; i++)
+        {
+            threads[i]->Stop();
+        }
+        memPoolTimer.Stop();
+
+        double numOps = double(numThreads) * double(MemAllocThread::NumOperations);
+        n_printf("%d threads: %d alloc/free pairs per thread: %f (%.1f Mops/s)\n",
+            numThreads, MemAllocThread::NumOperations, memPoolTimer.GetTime(), numOps / memPoolTimer.GetTime() / 1000000.0);
+    }
+
     timer.Stop();
 }
 
+//------------------------------------------------------------------------------
+/**
+    Replace random slots of a ring of live allocations with blocks of
+    random size between 8 and 1024 bytes. This keeps the working set
+    constant and exercises the per thread caches of several size classes.
+*/
+void
+MemAllocThread::DoWork()
+{
+    void** slots = (void**)Memory::Alloc(Memory::DefaultHeap, NumSlots * sizeof(void*));
+    Memory::Clear(slots, NumSlots * sizeof(void*));
+
+    uint state = this->seed;
+    IndexT i;
+    for (i = 0; i < NumOperations; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        IndexT slot = (state >> 8) % NumSlots;
+        size_t size = 8 + ((state >> 20) & 1015);
+        if (slots[slot] != nullptr)
+        {
+            Memory::Free(Memory::ObjectHeap, slots[slot]);
+        }
+        slots[slot] = Memory::Alloc(Memory::ObjectHeap, size);
+    }
+    for (i = 0; i < NumSlots; i++)
+    {
+        if (slots[i] != nullptr)
+        {
+            Memory::Free(Memory::ObjectHeap, slots[i]);
+        }
+    }
+    Memory::Free(Memory::DefaultHeap, slots);
+}
+
 } // namespace Benchmarking
\ No newline at end of file
@@ -3,12 +3,14 @@
 /** 
     @class Benchmarking::MemPoolBenchmark
     
-    Test memory pool performance.
+    Test memory pool performance, and the scaling of the small object heaps
+    when several threads allocate and free concurrently.
     
     (C) 2009 Radon Labs GmbH
     (C) 2013-2018 Individual contributors, see AUTHORS file
 */
 #include "benchmarkbase/benchmark.h"
+#include "threading/thread.h"
 
 //------------------------------------------------------------------------------
 namespace Benchmarking
@@ -21,6 +23,39 @@ public:
     virtual void Run(Timing::Timer& timer);
 };        
 
+//------------------------------------------------------------------------------
+/**
+    Worker thread for the multithreaded part of MemPoolBenchmark, performs
+    a fixed number of mixed size alloc/free operations on the object heap.
+*/
+class MemAllocThread : public Threading::Thread
+{
+    __DeclareClass(MemAllocThread);
+public:
+    /// number of live allocations each thread keeps around
+    static const SizeT NumSlots = 4096;
+    /// number of alloc/free pairs per thread
+    static const SizeT NumOperations = 2000000;
+
+    /// set random seed of the size sequence
+    void SetSeed(uint s);
+
+protected:
+    /// run the alloc/free loop
+    virtual void DoWork();
+
+    uint seed = 0;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+MemAllocThread::SetSeed(uint s)
+{
+    this->seed = s;
+}
+
 } // namespace Benchmarking
 //------------------------------------------------------------------------------
 
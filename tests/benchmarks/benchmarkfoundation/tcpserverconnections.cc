@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+//  tcpserverconnections.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "tcpserverconnections.h"
+#include "net/tcpserver.h"
+#include "net/socket/socket.h"
+#include "core/sysfunc.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::TcpServerConnections, 'TCSB', Benchmarking::Benchmark);
+
+using namespace Timing;
+using namespace Net;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TcpServerConnections::Run(Timer& timer)
+{
+    const SizeT NumConnections = 1000;
+    const SizeT NumIdlePolls = 1000;
+    const SizeT NumRounds = 20;
+    const SizeT MessageSize = 64;
+    const ushort Port = 2103;
+
+    Ptr<TcpServer> server = TcpServer::Create();
+    server->SetAddress(IpAddress("127.0.0.1", Port));
+    if (!server->Open())
+    {
+        n_printf("TcpServerConnections: failed to open server on port %d\n", Port);
+        return;
+    }
+
+    // connect all clients and wait until the server knows them
+    Util::Array<Ptr<Socket>> clients;
+    clients.Reserve(NumConnections);
+    for (IndexT i = 0; i < NumConnections; i++)
+    {
+        Ptr<Socket> client = Socket::Create();
+        if (!client->Open(Socket::TCP))
+        {
+            break;
+        }
+        client->SetAddress(IpAddress("127.0.0.1", Port));
+        if (client->Connect() != Socket::Success)
+        {
+            client->Close();
+            break;
+        }
+        client->SetNoDelay(true);
+        clients.Append(client);
+    }
+    Util::Array<Ptr<TcpClientConnection>> ready;
+    Timer local;
+    local.Start();
+    while (server->GetNumClientConnections() < clients.Size() && local.GetTime() < 10.0)
+    {
+        server->Recv(ready);
+        Core::SysFunc::Sleep(0.001);
+    }
+    local.Stop();
+
+    if (clients.Size() < NumConnections || server->GetNumClientConnections() < NumConnections)
+    {
+        n_printf("TcpServerConnections: only %d of %d connections established, check the file descriptor limit\n",
+            server->GetNumClientConnections(), NumConnections);
+    }
+    else
+    {
+        // all connections idle, measures the per frame cost of the server
+        local.Reset(); local.Start(); timer.Start();
+        for (IndexT i = 0; i < NumIdlePolls; i++)
+        {
+            server->Recv(ready);
+        }
+        timer.Stop(); local.Stop();
+        n_printf("%d polls over %d idle connections: %f\n", NumIdlePolls, NumConnections, local.GetTime());
+
+        // every client sends a message, the server echoes it back
+        ubyte message[MessageSize];
+        Memory::Fill(message, MessageSize, 0x5a);
+        ubyte reply[MessageSize];
+        bool failed = false;
+        local.Reset(); local.Start(); timer.Start();
+        for (IndexT round = 0; round < NumRounds && !failed; round++)
+        {
+            IndexT i;
+            for (i = 0; i < clients.Size(); i++)
+            {
+                SizeT bytesSent = 0;
+                clients[i]->Send(message, MessageSize, bytesSent);
+            }
+
+            SizeT bytesEchoed = 0;
+            while (bytesEchoed < NumConnections * MessageSize && !failed)
+            {
+                // a connection was lost, don't wait forever
+                if (local.GetTime() > 30.0)
+                {
+                    failed = true;
+                }
+                server->Recv(ready);
+                for (i = 0; i < ready.Size(); i++)
+                {
+                    const Ptr<IO::Stream>& stream = ready[i]->GetRecvStream();
+                    bytesEchoed += (SizeT)stream->GetSize();
+                    if (ready[i]->Send(stream) != Socket::Success)
+                    {
+                        failed = true;
+                    }
+                }
+            }
+
+            for (i = 0; i < clients.Size() && !failed; i++)
+            {
+                SizeT bytesReceived = 0;
+                while (bytesReceived < MessageSize)
+                {
+                    SizeT received = 0;
+                    if (clients[i]->Recv(reply + bytesReceived, MessageSize - bytesReceived, received) != Socket::Success)
+                    {
+                        failed = true;
+                        break;
+                    }
+                    bytesReceived += received;
+                }
+            }
+        }
+        timer.Stop(); local.Stop();
+        if (failed)
+        {
+            n_printf("TcpServerConnections: echo failed\n");
+        }
+        n_printf("%d echo rounds over %d connections: %f (%.0f messages/s)\n",
+            NumRounds, NumConnections, local.GetTime(), (NumRounds * NumConnections) / local.GetTime());
+    }
+
+    for (IndexT i = 0; i < clients.Size(); i++)
+    {
+        clients[i]->Close();
+    }
+    server->Close();
+}
+
+} // namespace Benchmarking
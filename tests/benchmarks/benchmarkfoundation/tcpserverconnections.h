@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::TcpServerConnections
+    
+    Benchmark a TcpServer with 1000 concurrent local connections: cost of
+    polling while all of them are idle and round trips of small echo
+    messages from every client. Needs a file descriptor limit of more
+    than 2000 (ulimit -n) on Linux.
+    
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class TcpServerConnections : public Benchmark
+{
+    __DeclareClass(TcpServerConnections);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
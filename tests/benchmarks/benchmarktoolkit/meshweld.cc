@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------
+//  meshweld.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "meshweld.h"
+#include "model/meshutil/meshbuilder.h"
+#include "math/vec2.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::MeshWeld, 'MWLD', Benchmarking::Benchmark);
+
+using namespace Timing;
+using namespace Math;
+using namespace ToolkitUtil;
+
+//------------------------------------------------------------------------------
+/**
+    Build an inflated grid, every triangle has its own 3 vertices like a
+    freshly imported scan. With jitter, the copies of a vertex differ by a
+    tiny offset so that only an epsilon weld merges them.
+*/
+static void
+BuildGrid(MeshBuilder& mesh, SizeT size, float jitter)
+{
+    const MeshBuilderVertex::ComponentMask components = MeshBuilderVertex::Components::Position | MeshBuilderVertex::Components::Uvs | MeshBuilderVertex::Components::Normals | MeshBuilderVertex::Components::Tangents;
+    mesh.Clear();
+    mesh.SetComponents(components);
+    mesh.SetPrimitiveTopology(CoreGraphics::PrimitiveTopology::TriangleList);
+    mesh.NewMesh(size * size * 6, size * size * 2);
+
+    IndexT vertexIndex = 0;
+    auto addVertex = [&](IndexT x, IndexT y)
+    {
+        float offset = jitter * (vertexIndex % 3);
+        MeshBuilderVertex vtx;
+        vtx.SetComponents(components);
+        vtx.SetPosition(vec4(x + offset, sinf(x * 0.1f) * cosf(y * 0.1f), y, 1));
+        vtx.SetUv(vec2(x / float(size), y / float(size)));
+        vtx.SetNormal(vec3(0, 1, 0));
+        vtx.SetTangent(vec3(1, 0, 0));
+        mesh.AddVertex(vtx);
+        return vertexIndex++;
+    };
+    for (IndexT y = 0; y < size; y++)
+    {
+        for (IndexT x = 0; x < size; x++)
+        {
+            IndexT i0 = addVertex(x, y), i1 = addVertex(x + 1, y), i2 = addVertex(x, y + 1);
+            mesh.AddTriangle(MeshBuilderTriangle(i0, i1, i2));
+            IndexT i3 = addVertex(x + 1, y), i4 = addVertex(x + 1, y + 1), i5 = addVertex(x, y + 1);
+            mesh.AddTriangle(MeshBuilderTriangle(i3, i4, i5));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MeshWeld::Run(Timer& timer)
+{
+    const SizeT sizes[] = { 128, 512 };
+    for (SizeT size : sizes)
+    {
+        MeshBuilder mesh;
+        MeshBuilder::CollapseMap collapseMap;
+        MeshBuilder::WeldSettings settings;
+        Timer local;
+
+        BuildGrid(mesh, size, 0.0f);
+        SizeT numVertices = mesh.GetNumVertices();
+        settings.parallel = false;
+        local.Reset(); local.Start(); timer.Start();
+        mesh.Weld(settings, &collapseMap);
+        timer.Stop(); local.Stop();
+        n_printf("weld %d vertices, single threaded: %f (%d left)\n", numVertices, local.GetTime(), mesh.GetNumVertices());
+
+        BuildGrid(mesh, size, 0.0f);
+        settings.parallel = true;
+        local.Reset(); local.Start(); timer.Start();
+        mesh.Weld(settings, &collapseMap);
+        timer.Stop(); local.Stop();
+        n_printf("weld %d vertices, jobs: %f (%d left)\n", numVertices, local.GetTime(), mesh.GetNumVertices());
+
+        BuildGrid(mesh, size, 1e-5f);
+        settings.positionEpsilon = 1e-3f;
+        settings.attributeEpsilon = 1e-4f;
+        local.Reset(); local.Start(); timer.Start();
+        mesh.Weld(settings, &collapseMap);
+        timer.Stop(); local.Stop();
+        n_printf("weld %d jittered vertices with epsilon, jobs: %f (%d left)\n", numVertices, local.GetTime(), mesh.GetNumVertices());
+
+        // legacy interface, one array per vertex in the collapse map
+        Util::FixedArray<Util::Array<IndexT>> legacyCollapseMap;
+        BuildGrid(mesh, size, 0.0f);
+        local.Reset(); local.Start(); timer.Start();
+        mesh.Deflate(&legacyCollapseMap);
+        timer.Stop(); local.Stop();
+        n_printf("deflate %d vertices with legacy collapse map: %f (%d left)\n", numVertices, local.GetTime(), mesh.GetNumVertices());
+        n_printf("---------------------------------------------------------------\n");
+    }
+}
+
+} // namespace Benchmarking
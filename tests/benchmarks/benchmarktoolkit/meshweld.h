@@ -0,0 +1,24 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::MeshWeld
+    
+    Benchmark vertex welding of large synthetic meshes in MeshBuilder.
+    
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class MeshWeld : public Benchmark
+{
+    __DeclareClass(MeshWeld);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
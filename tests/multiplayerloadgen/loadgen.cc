@@ -0,0 +1,243 @@
+//------------------------------------------------------------------------------
+//  loadgen.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "loadgen.h"
+#include "math/scalar.h"
+#include "nflatbuffer/nebula_flat.h"
+#include "flat/addons/multiplayer/standardprotocol.h"
+#include "flatbuffers/flatbuffer_builder.h"
+
+using namespace Multiplayer;
+
+namespace Test
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+LoadGenServer::LoadGenServer() :
+    worldSize(0.0f),
+    interestRadius(0.0f),
+    bandwidthBudget(0),
+    randomState(1),
+    lastSnapshotTime(0.0),
+    numMessagesReceived(0)
+{
+    this->snapshotTimer.Start();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoadGenServer::SetupWorld(SizeT numEntities, float worldSize, uint32_t seed)
+{
+    n_assert(numEntities > 0);
+    this->worldSize = worldSize;
+    this->randomState = seed != 0 ? seed : 1;
+    this->positions.Clear();
+    this->velocities.Clear();
+    for (IndexT i = 0; i < numEntities; i++)
+    {
+        this->positions.Append(Math::vec3((this->Random() - 0.5f) * worldSize, 0.0f, (this->Random() - 0.5f) * worldSize));
+        this->velocities.Append(Math::vec3((this->Random() - 0.5f) * 8.0f, 0.0f, (this->Random() - 0.5f) * 8.0f));
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoadGenServer::SetClientSettings(float interestRadius, SizeT bandwidthBudget)
+{
+    this->interestRadius = interestRadius;
+    this->bandwidthBudget = bandwidthBudget;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Random walk, entities turn a little every step and bounce off the world
+    bounds. A quarter of them stand still, so the delta encoder has some
+    unchanged entities to skip.
+*/
+void
+LoadGenServer::Simulate(float deltaTime)
+{
+    float const halfSize = this->worldSize * 0.5f;
+    for (IndexT i = 0; i < this->positions.Size(); i++)
+    {
+        if ((i & 3) == 3)
+            continue;
+
+        Math::vec3& vel = this->velocities[i];
+        vel.x = Math::clamp(vel.x + (this->Random() - 0.5f) * deltaTime * 4.0f, -4.0f, 4.0f);
+        vel.z = Math::clamp(vel.z + (this->Random() - 0.5f) * deltaTime * 4.0f, -4.0f, 4.0f);
+
+        Math::vec3& pos = this->positions[i];
+        pos += vel * deltaTime;
+        if (pos.x < -halfSize || pos.x > halfSize)
+        {
+            vel.x = -vel.x;
+            pos.x = Math::clamp(pos.x, -halfSize, halfSize);
+        }
+        if (pos.z < -halfSize || pos.z > halfSize)
+        {
+            vel.z = -vel.z;
+            pos.z = Math::clamp(pos.z, -halfSize, halfSize);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+LoadGenServer::OnClientIsConnecting(ClientConnection* connection)
+{
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoadGenServer::OnClientConnected(ClientConnection* connection)
+{
+    connection->SetInterest(Math::vec3(0), this->interestRadius);
+    connection->SetBandwidthBudget(this->bandwidthBudget);
+    this->clients.Append(connection);
+    this->clientEntities.Append((this->clients.Size() * 7919) % this->positions.Size());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoadGenServer::OnClientDisconnected(ClientConnection* connection)
+{
+    IndexT const index = this->clients.FindIndex(connection);
+    if (index != InvalidIndex)
+    {
+        this->clients.EraseIndexSwap(index);
+        this->clientEntities.EraseIndexSwap(index);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoadGenServer::OnMessageReceived(ClientConnection* connection, Timing::Time recvTime, byte* data, size_t size)
+{
+    this->numMessagesReceived++;
+    StandardProtocol::Message const* protocolMessage = StandardProtocol::GetMessage(data);
+    if (protocolMessage->data_type() == StandardProtocol::MessageData_SnapshotAck)
+    {
+        this->AcknowledgeSnapshot(connection, protocolMessage->data_as_SnapshotAck()->sequence());
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoadGenServer::OnTick()
+{
+    this->snapshotTimer.Reset();
+
+    for (IndexT i = 0; i < this->clients.Size(); i++)
+    {
+        this->clients[i]->SetInterest(this->positions[this->clientEntities[i]], this->interestRadius);
+    }
+
+    this->BeginSnapshot();
+    for (IndexT i = 0; i < this->positions.Size(); i++)
+    {
+        this->AddSnapshotEntity(i + 1, this->positions[i], this->velocities[i]);
+    }
+    this->SendSnapshot();
+
+    this->lastSnapshotTime = this->snapshotTimer.GetTime();
+}
+
+//------------------------------------------------------------------------------
+/**
+    xorshift32
+*/
+float
+LoadGenServer::Random()
+{
+    uint32_t x = this->randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    this->randomState = x;
+    return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+LoadGenClient::LoadGenClient() :
+    numBytesReceived(0),
+    numMessagesReceived(0),
+    numCompleteSnapshots(0),
+    numRejectedFragments(0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoadGenClient::OnConnected()
+{
+    this->snapshotReceiver.Reset();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LoadGenClient::OnMessageReceived(Timing::Time recvTime, byte* data, size_t size)
+{
+    this->numBytesReceived += size;
+    this->numMessagesReceived++;
+
+    StandardProtocol::Message const* protocolMessage = StandardProtocol::GetMessage(data);
+    if (protocolMessage->data_type() != StandardProtocol::MessageData_Snapshot)
+        return;
+
+    StandardProtocol::MsgSnapshot const* msg = protocolMessage->data_as_Snapshot();
+    this->changedEntities.Clear();
+    this->removedEntities.Clear();
+    SnapshotReceiver::Result result = this->snapshotReceiver.ReceiveFragment(
+        msg->sequence(),
+        msg->baseline(),
+        msg->fragment(),
+        msg->num_fragments(),
+        msg->payload()->data(),
+        msg->payload()->size(),
+        this->changedEntities,
+        this->removedEntities
+    );
+
+    if (result == SnapshotReceiver::Rejected)
+    {
+        this->numRejectedFragments++;
+    }
+    else if (result == SnapshotReceiver::Complete)
+    {
+        this->numCompleteSnapshots++;
+        flatbuffers::FlatBufferBuilder builder(64);
+        auto ack = StandardProtocol::CreateMsgSnapshotAck(builder, msg->sequence());
+        auto message = StandardProtocol::CreateMessage(builder, StandardProtocol::MessageData_SnapshotAck, ack.Union());
+        builder.Finish(message);
+        this->Send(builder.GetBufferPointer(), builder.GetSize());
+    }
+}
+
+} // namespace Test
@@ -0,0 +1,165 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file loadgen.h
+
+    Server and client used by the multiplayer load generator. They replicate
+    a set of randomly walking entities through the snapshot path of the
+    multiplayer addon without a game world, and count what goes over the
+    wire.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "multiplayer/server/basemultiplayerserver.h"
+#include "multiplayer/client/basemultiplayerclient.h"
+#include "multiplayer/snapshot.h"
+
+namespace Test
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+class LoadGenServer : public Multiplayer::BaseMultiplayerServer
+{
+public:
+    /// constructor
+    LoadGenServer();
+
+    /// spawn entities at random positions within [-worldSize/2, worldSize/2] on x and z
+    void SetupWorld(SizeT numEntities, float worldSize, uint32_t seed);
+    /// interest radius and bandwidth budget of every client
+    void SetClientSettings(float interestRadius, SizeT bandwidthBudget);
+    /// move all entities
+    void Simulate(float deltaTime);
+
+    bool OnClientIsConnecting(Multiplayer::ClientConnection* connection) override;
+    void OnClientConnected(Multiplayer::ClientConnection* connection) override;
+    void OnClientDisconnected(Multiplayer::ClientConnection* connection) override;
+    void OnMessageReceived(Multiplayer::ClientConnection* connection, Timing::Time recvTime, byte* data, size_t size) override;
+    void OnTick() override;
+
+    /// number of connected clients
+    SizeT GetNumConnectedClients() const;
+    /// time spent building and sending the last snapshot
+    Timing::Time GetLastSnapshotTime() const;
+    /// number of messages received from clients
+    uint64_t GetNumMessagesReceived() const;
+
+private:
+    /// random number in [0..1)
+    float Random();
+
+    float worldSize;
+    float interestRadius;
+    SizeT bandwidthBudget;
+    uint32_t randomState;
+    Util::Array<Math::vec3> positions;
+    Util::Array<Math::vec3> velocities;
+    /// every client follows one of the entities
+    Util::Array<Multiplayer::ClientConnection*> clients;
+    Util::Array<IndexT> clientEntities;
+
+    Timing::Timer snapshotTimer;
+    Timing::Time lastSnapshotTime;
+    uint64_t numMessagesReceived;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+class LoadGenClient : public Multiplayer::BaseMultiplayerClient
+{
+public:
+    /// constructor
+    LoadGenClient();
+
+    void OnConnected() override;
+    void OnMessageReceived(Timing::Time recvTime, byte* data, size_t size) override;
+
+    /// bytes received from the server
+    uint64_t GetNumBytesReceived() const;
+    /// messages received from the server
+    uint64_t GetNumMessagesReceived() const;
+    /// snapshots received completely
+    uint64_t GetNumCompleteSnapshots() const;
+    /// fragments which could not be used
+    uint64_t GetNumRejectedFragments() const;
+
+private:
+    Multiplayer::SnapshotReceiver snapshotReceiver;
+    Util::Array<Multiplayer::SnapshotEntity> changedEntities;
+    Util::Array<uint32_t> removedEntities;
+
+    uint64_t numBytesReceived;
+    uint64_t numMessagesReceived;
+    uint64_t numCompleteSnapshots;
+    uint64_t numRejectedFragments;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+LoadGenServer::GetNumConnectedClients() const
+{
+    return this->clients.Size();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Timing::Time
+LoadGenServer::GetLastSnapshotTime() const
+{
+    return this->lastSnapshotTime;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+LoadGenServer::GetNumMessagesReceived() const
+{
+    return this->numMessagesReceived;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+LoadGenClient::GetNumBytesReceived() const
+{
+    return this->numBytesReceived;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+LoadGenClient::GetNumMessagesReceived() const
+{
+    return this->numMessagesReceived;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+LoadGenClient::GetNumCompleteSnapshots() const
+{
+    return this->numCompleteSnapshots;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+LoadGenClient::GetNumRejectedFragments() const
+{
+    return this->numRejectedFragments;
+}
+
+} // namespace Test
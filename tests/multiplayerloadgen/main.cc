@@ -0,0 +1,209 @@
+//------------------------------------------------------------------------------
+//  main.cc
+//
+//  Headless load generator for the multiplayer addon. Runs a server and a
+//  few hundred clients in one process, connected through a simulated
+//  network, and reports server tick times and traffic per client.
+//
+//  Arguments:
+//      -clients    number of clients (200)
+//      -entities   number of replicated entities (2000)
+//      -ticks      number of measured ticks (300)
+//      -tickrate   ticks per second (20)
+//      -worldsize  size of the square world (1000)
+//      -radius     interest radius of a client, 0 replicates everything (150)
+//      -budget     entity bytes per client and tick, 0 is unlimited (0)
+//      -latency    one way latency in ms (50)
+//      -jitter     maximum additional one way delay in ms (0)
+//      -loss       unreliable packet loss in percent (0)
+//      -bandwidth  bandwidth per client and direction in KB/s, 0 is unlimited (0)
+//
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "core/coreserver.h"
+#include "core/sysfunc.h"
+#include "math/scalar.h"
+#include "timing/timer.h"
+#include "util/commandlineargs.h"
+#include "multiplayer/transport/loopbacktransport.h"
+#include "loadgen.h"
+
+using namespace Core;
+using namespace Multiplayer;
+using namespace Test;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+PrintTimes(char const* name, Util::Array<Timing::Time>& times)
+{
+    if (times.IsEmpty())
+        return;
+
+    Timing::Time sum = 0.0;
+    for (Timing::Time t : times)
+        sum += t;
+    times.Sort();
+    n_printf("%-20s mean %8.3f ms   median %8.3f ms   p95 %8.3f ms   max %8.3f ms\n",
+        name,
+        sum / times.Size() * 1000.0,
+        times[times.Size() / 2] * 1000.0,
+        times[Math::min(times.Size() - 1, (times.Size() * 95) / 100)] * 1000.0,
+        times.Back() * 1000.0);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int __cdecl
+main(int argc, const char** argv)
+{
+    Ptr<CoreServer> coreServer = CoreServer::Create();
+    coreServer->SetAppName(Util::StringAtom("Nebula Multiplayer Load Generator"));
+    coreServer->Open();
+
+    Util::CommandLineArgs args(argc, argv);
+    SizeT const numClients = args.GetInt("-clients", 200);
+    SizeT const numEntities = args.GetInt("-entities", 2000);
+    SizeT const numTicks = args.GetInt("-ticks", 300);
+    int const tickRate = args.GetInt("-tickrate", 20);
+    float const worldSize = args.GetFloat("-worldsize", 1000.0f);
+    float const radius = args.GetFloat("-radius", 150.0f);
+    SizeT const budget = args.GetInt("-budget", 0);
+    n_assert(numClients > 0 && numEntities > 0 && numTicks > 0 && tickRate > 0);
+
+    LoopbackNetwork::Settings settings;
+    settings.latency = args.GetFloat("-latency", 50.0f) / 1000.0;
+    settings.jitter = args.GetFloat("-jitter", 0.0f) / 1000.0;
+    settings.loss = args.GetFloat("-loss", 0.0f) / 100.0f;
+    settings.bandwidth = args.GetInt("-bandwidth", 0) * 1024;
+
+    LoopbackNetwork network;
+    network.SetSettings(settings);
+    Timing::Time const tickInterval = 1.0 / tickRate;
+
+    // the simulation runs on network time, tick on every SyncAll and poll every group every time
+    LoopbackTransport serverTransport(&network);
+    LoadGenServer server;
+    server.SetTransport(&serverTransport);
+    server.SetTickInterval(0.0);
+    for (int i = 0; i < (int)ClientGroup::NumClientGroups; i++)
+        server.SetClientGroupPollInterval((ClientGroup)i, 0.0);
+    server.SetInterestCellSize(Math::max(radius, 16.0f));
+    server.SetupWorld(numEntities, worldSize, 4711);
+    server.SetClientSettings(radius, budget);
+    server.Open();
+
+    Util::Array<LoopbackTransport*> clientTransports;
+    Util::Array<LoadGenClient*> clients;
+    for (IndexT i = 0; i < numClients; i++)
+    {
+        LoopbackTransport* transport = new LoopbackTransport(&network);
+        LoadGenClient* client = new LoadGenClient();
+        client->SetTransport(transport);
+        client->Open();
+        client->TryConnect();
+        clientTransports.Append(transport);
+        clients.Append(client);
+    }
+
+    n_printf("Connecting %d clients, %d entities, latency %.0f ms, jitter %.0f ms, loss %.1f%%, bandwidth %d KB/s\n",
+        numClients, numEntities, settings.latency * 1000.0, settings.jitter * 1000.0, settings.loss * 100.0f, settings.bandwidth / 1024);
+
+    // a connection takes two callback rounds on the server and one on the client
+    for (IndexT i = 0; i < 16 && server.GetNumConnectedClients() < numClients; i++)
+    {
+        server.SyncAll();
+        for (LoadGenClient* client : clients)
+            client->SyncAll();
+    }
+    if (server.GetNumConnectedClients() < numClients)
+    {
+        n_printf("Only %d of %d clients connected\n", server.GetNumConnectedClients(), numClients);
+    }
+
+    // give the first full snapshots time to arrive before measuring
+    SizeT const numWarmupTicks = (SizeT)(settings.latency * 2.0 / tickInterval) + 2;
+    Util::Array<Timing::Time> tickTimes;
+    Util::Array<Timing::Time> snapshotTimes;
+    uint64_t bytesBefore = 0, messagesBefore = 0, snapshotsBefore = 0;
+    uint64_t serverMessagesBefore = 0;
+
+    Timing::Timer tickTimer;
+    tickTimer.Start();
+    for (IndexT tick = 0; tick < numWarmupTicks + numTicks; tick++)
+    {
+        if (tick == numWarmupTicks)
+        {
+            network.ResetCounters();
+            for (LoadGenClient* client : clients)
+            {
+                bytesBefore += client->GetNumBytesReceived();
+                messagesBefore += client->GetNumMessagesReceived();
+                snapshotsBefore += client->GetNumCompleteSnapshots();
+            }
+            serverMessagesBefore = server.GetNumMessagesReceived();
+        }
+
+        network.Advance(tickInterval);
+        server.Simulate((float)tickInterval);
+
+        tickTimer.Reset();
+        server.SyncAll();
+        Timing::Time const tickTime = tickTimer.GetTime();
+
+        for (LoadGenClient* client : clients)
+            client->SyncAll();
+
+        if (tick >= numWarmupTicks)
+        {
+            tickTimes.Append(tickTime);
+            snapshotTimes.Append(server.GetLastSnapshotTime());
+        }
+    }
+
+    uint64_t bytesReceived = 0, messagesReceived = 0, completeSnapshots = 0, rejectedFragments = 0;
+    for (LoadGenClient* client : clients)
+    {
+        bytesReceived += client->GetNumBytesReceived();
+        messagesReceived += client->GetNumMessagesReceived();
+        completeSnapshots += client->GetNumCompleteSnapshots();
+        rejectedFragments += client->GetNumRejectedFragments();
+    }
+    bytesReceived -= bytesBefore;
+    messagesReceived -= messagesBefore;
+    completeSnapshots -= snapshotsBefore;
+
+    double const clientTicks = (double)numClients * numTicks;
+    n_printf("\n%d ticks at %d Hz, %d clients connected\n", numTicks, tickRate, server.GetNumConnectedClients());
+    PrintTimes("Server tick", tickTimes);
+    PrintTimes("  Snapshot", snapshotTimes);
+    n_printf("Downstream per client: %.1f B/tick, %.2f msg/tick, %.1f KB/s\n",
+        bytesReceived / clientTicks,
+        messagesReceived / clientTicks,
+        bytesReceived / clientTicks * tickRate / 1024.0);
+    n_printf("Network: %.1f msg/tick sent, %.1f KB/tick, %llu dropped\n",
+        (double)network.GetNumMessagesSent() / numTicks,
+        (double)network.GetNumBytesSent() / numTicks / 1024.0,
+        (unsigned long long)network.GetNumMessagesDropped());
+    n_printf("Server received %.1f msg/tick\n", (double)(server.GetNumMessagesReceived() - serverMessagesBefore) / numTicks);
+    n_printf("Complete snapshots: %.1f%%, %llu rejected fragments\n",
+        completeSnapshots / clientTicks * 100.0,
+        (unsigned long long)rejectedFragments);
+
+    for (LoadGenClient* client : clients)
+    {
+        client->Close();
+        delete client;
+    }
+    for (LoopbackTransport* transport : clientTransports)
+        delete transport;
+    server.Close();
+
+    coreServer->Close();
+    coreServer = nullptr;
+    SysFunc::Exit(0);
+    return 0;
+}
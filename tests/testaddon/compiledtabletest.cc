@@ -0,0 +1,339 @@
+//------------------------------------------------------------------------------
+//  compiledtabletest.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "testaddon/compiledtabletest.h"
+#include "testaddon/dbattrs.h"
+#include "attr/compiledattributetable.h"
+#include "gamedata/compiledtablewriter.h"
+#include "toolkit-common/logger.h"
+#include "io/ioserver.h"
+
+namespace Test
+{
+__ImplementClass(Test::CompiledTableTest, 'CTBT', Test::TestCase);
+
+using namespace Attr;
+using namespace Util;
+
+static const SizeT NumSourceRows = 64;
+static const IndexT DeletedRow = 10;
+
+//------------------------------------------------------------------------------
+/**
+    Row index of a source row in the compiled table, which has no deleted rows.
+*/
+static IndexT
+CompiledRow(IndexT sourceRow)
+{
+    return sourceRow < DeletedRow ? sourceRow : sourceRow - 1;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+CompiledTableTest::Run()
+{
+    Ptr<IO::IoServer> ioServer = IO::IoServer::Create();
+    const IO::URI uri("temp:nebula-db-test/compiledtabletest.ncat");
+    ioServer->CreateDirectory("temp:nebula-db-test");
+    if (ioServer->FileExists(uri))
+    {
+        ioServer->DeleteFile(uri);
+        n_assert(!ioServer->FileExists(uri));
+    }
+
+    Ptr<AttributeTable> source = this->CreateSourceTable();
+    ToolkitUtil::Logger logger;
+    logger.SetVerbose(false);
+    ToolkitUtil::CompiledTableWriter writer;
+    writer.SetLogger(&logger);
+    writer.AddKeyColumn(Attr::GuidValue);
+    writer.AddKeyColumn(Attr::IntValue);
+    writer.AddKeyColumn(Attr::UIntValue);
+    writer.AddKeyColumn(Attr::Int64Value);
+    writer.AddKeyColumn(Attr::StringValue);
+    VERIFY(writer.Write(source, uri));
+    VERIFY(ioServer->FileExists(uri));
+
+    this->VerifyTable(source, uri);
+    this->VerifyCorruptFiles(uri);
+
+    // duplicate keys can't be indexed
+    source->SetInt(Attr::IntValue, 1, source->GetInt(Attr::IntValue, 0));
+    VERIFY(!writer.Write(source, "temp:nebula-db-test/compiledtabletest_duplicate.ncat"));
+}
+
+//------------------------------------------------------------------------------
+/**
+    Name and Age repeat their values, StringValue is unique except that one
+    row shares a string with Name, so the dictionary has to store it once.
+*/
+Ptr<AttributeTable>
+CompiledTableTest::CreateSourceTable()
+{
+    Ptr<AttributeTable> table = AttributeTable::Create();
+    table->AddColumn(Attr::GuidValue);
+    table->AddColumn(Attr::IntValue);
+    table->AddColumn(Attr::UIntValue);
+    table->AddColumn(Attr::Int64Value);
+    table->AddColumn(Attr::StringValue);
+    table->AddColumn(Attr::Name);
+    table->AddColumn(Attr::Age);
+    table->AddColumn(Attr::BoolValue);
+    table->AddColumn(Attr::FloatValue);
+    table->AddColumn(Attr::Float4Value);
+    table->AddColumn(Attr::Matrix44Value);
+    table->AddColumn(Attr::BlobValue);
+    const IndexT uintColumn = table->GetColumnIndex(Attr::UIntValue);
+    const IndexT vec4Column = table->GetColumnIndex(Attr::Float4Value);
+    const IndexT mat4Column = table->GetColumnIndex(Attr::Matrix44Value);
+    const IndexT blobColumn = table->GetColumnIndex(Attr::BlobValue);
+
+    this->guids.Clear();
+    IndexT i;
+    for (i = 0; i < NumSourceRows; i++)
+    {
+        Guid guid;
+        guid.Generate();
+        this->guids.Append(guid);
+
+        ubyte bytes[NumSourceRows];
+        IndexT j;
+        for (j = 0; j < i; j++)
+        {
+            bytes[j] = (ubyte)(i + j);
+        }
+
+        const float f = (float)i;
+        IndexT row = table->AddRow();
+        n_assert(row == i);
+        table->SetGuid(Attr::GuidValue, row, guid);
+        table->SetInt(Attr::IntValue, row, i * 7 - 100);
+        table->SetUInt(uintColumn, row, 0x80000000u + i * 3);
+        table->SetInt64(Attr::Int64Value, row, ((int64_t)i << 40) | i);
+        table->SetString(Attr::StringValue, row, (1 == i) ? String("name_1") : String::Sprintf("key_%d", i));
+        table->SetString(Attr::Name, row, String::Sprintf("name_%d", i % 5));
+        table->SetInt(Attr::Age, row, i / 2);
+        table->SetBool(Attr::BoolValue, row, 0 != (i & 1));
+        table->SetFloat(Attr::FloatValue, row, f * 0.25f);
+        table->SetVec4(vec4Column, row, Math::vec4(f, -f, f * 0.5f, 1.0f));
+        table->SetMat4(mat4Column, row, Math::mat4(
+            Math::vec4(1.0f, f, 0.0f, 0.0f),
+            Math::vec4(0.0f, 1.0f, f, 0.0f),
+            Math::vec4(0.0f, 0.0f, 1.0f, f),
+            Math::vec4(f, f * 2.0f, f * 3.0f, 1.0f)));
+        table->SetBlob(blobColumn, row, (0 == (i % 4)) ? Blob() : Blob(bytes, i));
+    }
+
+    this->deletedGuid = this->guids[DeletedRow];
+    table->DeleteRow(DeletedRow);
+    return table;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+CompiledTableTest::VerifyTable(const Ptr<AttributeTable>& source, const IO::URI& uri)
+{
+    Ptr<CompiledAttributeTable> table = CompiledAttributeTable::Create();
+    VERIFY(table->Open(uri));
+    if (!table->IsOpen())
+    {
+        return;
+    }
+
+    VERIFY(table->GetNumRows() == NumSourceRows - 1);
+    VERIFY(table->GetNumColumns() == source->GetNumColumns());
+    VERIFY(table->HasColumn(Attr::Matrix44Value));
+    VERIFY(!table->HasColumn(Attr::City));
+    VERIFY(table->IsKeyColumn(table->GetColumnIndex(Attr::GuidValue)));
+    VERIFY(table->IsKeyColumn(table->GetColumnIndex(Attr::IntValue)));
+    VERIFY(table->IsKeyColumn(table->GetColumnIndex(Attr::UIntValue)));
+    VERIFY(table->IsKeyColumn(table->GetColumnIndex(Attr::Int64Value)));
+    VERIFY(table->IsKeyColumn(table->GetColumnIndex(Attr::StringValue)));
+    VERIFY(!table->IsKeyColumn(table->GetColumnIndex(Attr::Name)));
+    VERIFY(!table->IsKeyColumn(table->GetColumnIndex(Attr::Age)));
+    VERIFY(table->GetColumnValueType(table->GetColumnIndex(Attr::BlobValue)) == BlobType);
+
+    // every value of every type, and every key finds its row
+    const IndexT srcUIntColumn = source->GetColumnIndex(Attr::UIntValue);
+    const IndexT srcVec4Column = source->GetColumnIndex(Attr::Float4Value);
+    const IndexT srcMat4Column = source->GetColumnIndex(Attr::Matrix44Value);
+    const IndexT srcBlobColumn = source->GetColumnIndex(Attr::BlobValue);
+    const IndexT uintColumn = table->GetColumnIndex(Attr::UIntValue);
+    const IndexT vec4Column = table->GetColumnIndex(Attr::Float4Value);
+    const IndexT mat4Column = table->GetColumnIndex(Attr::Matrix44Value);
+    const IndexT blobColumn = table->GetColumnIndex(Attr::BlobValue);
+    IndexT srcRow;
+    for (srcRow = 0; srcRow < NumSourceRows; srcRow++)
+    {
+        if (DeletedRow == srcRow)
+        {
+            continue;
+        }
+        const IndexT row = CompiledRow(srcRow);
+        VERIFY(table->GetGuid(Attr::GuidValue, row) == this->guids[srcRow]);
+        VERIFY(table->GetInt(Attr::IntValue, row) == source->GetInt(Attr::IntValue, srcRow));
+        VERIFY(table->GetUInt(uintColumn, row) == source->GetUInt(srcUIntColumn, srcRow));
+        VERIFY(table->GetInt64(Attr::Int64Value, row) == source->GetInt64(Attr::Int64Value, srcRow));
+        VERIFY(source->GetString(Attr::StringValue, srcRow) == table->GetString(Attr::StringValue, row));
+        VERIFY(source->GetString(Attr::Name, srcRow) == table->GetString(Attr::Name, row));
+        VERIFY(table->GetInt(Attr::Age, row) == srcRow / 2);
+        VERIFY(table->GetBool(Attr::BoolValue, row) == source->GetBool(Attr::BoolValue, srcRow));
+        VERIFY(table->GetFloat(Attr::FloatValue, row) == source->GetFloat(Attr::FloatValue, srcRow));
+        VERIFY(table->GetVec4(vec4Column, row) == source->GetVec4(srcVec4Column, srcRow));
+        VERIFY(table->GetMat4(mat4Column, row) == source->GetMat4(srcMat4Column, srcRow));
+
+        const Blob& srcBlob = source->GetBlob(srcBlobColumn, srcRow);
+        const SizeT srcBlobSize = srcBlob.IsValid() ? (SizeT)srcBlob.Size() : 0;
+        SizeT blobSize = -1;
+        const void* blob = table->GetBlob(blobColumn, row, blobSize);
+        VERIFY(blobSize == srcBlobSize);
+        VERIFY(0 == srcBlobSize || 0 == memcmp(blob, srcBlob.GetPtr(), srcBlobSize));
+
+        VERIFY(table->FindRowIndexByGuid(Attr::GuidValue, this->guids[srcRow]) == row);
+        VERIFY(table->FindRowIndexByInt(Attr::IntValue, srcRow * 7 - 100) == row);
+        VERIFY(table->FindRowIndexByString(Attr::StringValue, table->GetString(Attr::StringValue, row)) == row);
+        VERIFY(table->FindRowIndexByAttr(Attribute(UIntAttrId(Attr::UIntValue), table->GetUInt(uintColumn, row))) == row);
+        VERIFY(table->FindRowIndexByAttr(Attribute(Attr::Int64Value, ((int64_t)srcRow << 40) | srcRow)) == row);
+        VERIFY(table->FindRowIndexByAttr(Attribute(Attr::GuidValue, this->guids[srcRow])) == row);
+        VERIFY(table->GetAttr(row, table->GetColumnIndex(Attr::IntValue)) == source->GetInt(Attr::IntValue, srcRow));
+    }
+
+    // the string dictionary stores equal strings once, across columns
+    const IndexT nameColumn = table->GetColumnIndex(Attr::Name);
+    const IndexT stringColumn = table->GetColumnIndex(Attr::StringValue);
+    IndexT i;
+    for (i = 0; i < 5; i++)
+    {
+        VERIFY(table->GetStringIndex(nameColumn, i) == table->GetStringIndex(nameColumn, i + 5));
+        VERIFY(table->GetString(nameColumn, i) == table->GetString(nameColumn, CompiledRow(i + 15)));
+        VERIFY(table->GetStringIndex(nameColumn, i) != table->GetStringIndex(nameColumn, (i + 1) % 5));
+        VERIFY(String(table->GetDictionaryString(table->GetStringIndex(nameColumn, i))) == String::Sprintf("name_%d", i));
+    }
+    VERIFY(table->GetStringIndex(stringColumn, 1) == table->GetStringIndex(nameColumn, 1));
+    VERIFY(table->GetString(stringColumn, 1) == table->GetString(nameColumn, 6));
+
+    // lookups on non-key columns scan, and return the first row which matches
+    VERIFY(table->FindRowIndexByString(Attr::Name, "name_3") == 3);
+    VERIFY(table->FindRowIndexByInt(Attr::Age, 4) == 8);
+    VERIFY(table->FindRowIndexByInt(Attr::Age, 5) == CompiledRow(11));
+    VERIFY(table->FindRowIndexByAttr(Attribute(Attr::BoolValue, true)) == 1);
+    VERIFY(table->FindRowIndexByAttr(Attribute(Attr::FloatValue, 2.0f)) == 8);
+    VERIFY(table->FindRowIndexByAttr(Attribute(Vec4AttrId(Attr::Float4Value), Math::vec4(20.0f, -20.0f, 10.0f, 1.0f))) == CompiledRow(20));
+    VERIFY(table->FindRowIndexByAttr(Attribute(BlobAttrId(Attr::BlobValue), source->GetBlob(srcBlobColumn, 7))) == 7);
+    VERIFY(table->FindRowIndexByAttr(Attribute(BlobAttrId(Attr::BlobValue), Blob())) == 0);
+
+    // missing keys, including the ones of the deleted row
+    Guid unknownGuid;
+    unknownGuid.Generate();
+    VERIFY(table->FindRowIndexByGuid(Attr::GuidValue, this->deletedGuid) == InvalidIndex);
+    VERIFY(table->FindRowIndexByGuid(Attr::GuidValue, unknownGuid) == InvalidIndex);
+    VERIFY(table->FindRowIndexByInt(Attr::IntValue, DeletedRow * 7 - 100) == InvalidIndex);
+    VERIFY(table->FindRowIndexByInt(Attr::IntValue, 1) == InvalidIndex);
+    VERIFY(table->FindRowIndexByString(Attr::StringValue, "key_10") == InvalidIndex);
+    VERIFY(table->FindRowIndexByString(Attr::StringValue, "") == InvalidIndex);
+    VERIFY(table->FindRowIndexByAttr(Attribute(UIntAttrId(Attr::UIntValue), 5u)) == InvalidIndex);
+    VERIFY(table->FindRowIndexByAttr(Attribute(Attr::Int64Value, (int64_t)-1)) == InvalidIndex);
+    VERIFY(table->FindRowIndexByString(Attr::Name, "name_5") == InvalidIndex);
+    VERIFY(table->FindRowIndexByInt(Attr::Age, NumSourceRows) == InvalidIndex);
+    VERIFY(table->FindRowIndexByAttr(Attribute(Attr::FloatValue, -1.0f)) == InvalidIndex);
+    VERIFY(table->FindRowIndexByAttr(Attribute(Attr::City, String("Berlin"))) == InvalidIndex);
+
+    table->Close();
+    VERIFY(!table->IsOpen());
+}
+
+//------------------------------------------------------------------------------
+/**
+    Damages single values of a valid file which the reader uses as indices
+    or offsets, each of them has to make Open() fail instead of handing out
+    pointers outside of the file.
+*/
+void
+CompiledTableTest::VerifyCorruptFiles(const IO::URI& uri)
+{
+    Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(uri);
+    stream->SetAccessMode(IO::Stream::ReadAccess);
+    VERIFY(stream->Open());
+    if (!stream->IsOpen())
+    {
+        return;
+    }
+    Blob contents(stream->GetSize());
+    VERIFY(stream->Read(contents.GetPtr(), stream->GetSize()) == stream->GetSize());
+    stream->Close();
+
+    const ubyte* ptr = (const ubyte*)contents.GetPtr();
+    const CompiledTableHeader* header = (const CompiledTableHeader*)ptr;
+    const CompiledTableColumn* descs = (const CompiledTableColumn*)(ptr + sizeof(CompiledTableHeader));
+    const uint* stringOffsets = (const uint*)(ptr + header->stringOffsets);
+    const char* stringData = (const char*)(ptr + header->stringData);
+    auto findColumn = [&](const char* name) -> const CompiledTableColumn&
+    {
+        uint i;
+        for (i = 0; i < header->numColumns - 1; i++)
+        {
+            if (0 == strcmp(stringData + stringOffsets[descs[i].name], name))
+            {
+                break;
+            }
+        }
+        return descs[i];
+    };
+
+    // an unchanged copy still opens
+    VERIFY(this->OpensCorrupted(contents, 0, header->magic));
+
+    // a bucket pointing past the last row
+    const CompiledTableColumn& intColumn = findColumn("IntValue");
+    VERIFY(0 != intColumn.buckets);
+    uint bucket = 0;
+    while (bucket < intColumn.numBuckets - 1 && 0 == ((const uint*)(ptr + intColumn.buckets))[bucket])
+    {
+        bucket++;
+    }
+    VERIFY(!this->OpensCorrupted(contents, intColumn.buckets + bucket * sizeof(uint), header->numRows + 1));
+
+    // a string offset past the string data
+    VERIFY(!this->OpensCorrupted(contents, header->stringOffsets, (uint)(header->blobData - header->stringData)));
+
+    // a string cell past the dictionary
+    VERIFY(!this->OpensCorrupted(contents, findColumn("Name").values, header->numStrings));
+
+    // a blob cell past the blob data, the second row has a blob
+    const uint64_t blobCell = findColumn("BlobValue").values + sizeof(CompiledTableBlob);
+    VERIFY(!this->OpensCorrupted(contents, blobCell, (uint)(contents.Size() - header->blobData)));
+    VERIFY(!this->OpensCorrupted(contents, blobCell + offsetof(CompiledTableBlob, size), 0xffffffff));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+CompiledTableTest::OpensCorrupted(const Blob& contents, uint64_t offset, uint value)
+{
+    Blob copy(contents);
+    Memory::Copy(&value, (ubyte*)copy.GetPtr() + offset, sizeof(value));
+
+    const IO::URI uri("temp:nebula-db-test/compiledtabletest_corrupt.ncat");
+    Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(uri);
+    stream->SetAccessMode(IO::Stream::WriteAccess);
+    VERIFY(stream->Open());
+    stream->Write(copy.GetPtr(), (IO::Stream::Size)copy.Size());
+    stream->Close();
+
+    Ptr<CompiledAttributeTable> table = CompiledAttributeTable::Create();
+    const bool result = table->Open(uri);
+    if (result)
+    {
+        table->Close();
+    }
+    return result;
+}
+
+} // namespace Test
@@ -0,0 +1,42 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::CompiledTableTest
+
+    Test writing attribute tables with ToolkitUtil::CompiledTableWriter and
+    reading them back through Attr::CompiledAttributeTable.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+#include "attr/attributetable.h"
+#include "util/blob.h"
+#include "io/uri.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class CompiledTableTest : public TestCase
+{
+    __DeclareClass(CompiledTableTest);
+public:
+    /// run the test
+    virtual void Run();
+
+private:
+    /// fill a table with every supported value type and a deleted row
+    Ptr<Attr::AttributeTable> CreateSourceTable();
+    /// check values, the string dictionary and lookups of a compiled table against its source
+    void VerifyTable(const Ptr<Attr::AttributeTable>& source, const IO::URI& uri);
+    /// check that damaged copies of a compiled table are rejected
+    void VerifyCorruptFiles(const IO::URI& uri);
+    /// write a damaged copy of a file and return true if it can still be opened
+    bool OpensCorrupted(const Util::Blob& contents, uint64_t offset, uint value);
+
+    Util::Array<Util::Guid> guids;
+    Util::Guid deletedGuid;
+};
+
+}; // namespace Test
+//------------------------------------------------------------------------------
@@ -8,7 +8,9 @@
 #include "io/ioserver.h"
 #include "io/filestream.h"
 #include "db/database.h"
+#include "db/dataset.h"
 #include "db/sqlite3/sqlite3factory.h"
+#include "db/sqlite3/sqlite3database.h"
 
 namespace Test
 {
@@ -143,6 +145,263 @@ DatabaseTest::Run()
     VERIFY(table1->GetColumn(Attr::Float4Value).GetType() == Column::Indexed);
     VERIFY(table1->GetColumn(Attr::BlobValue).GetType() != Column::Indexed);
     db->Close();
+
+    this->TestStatementCache(dbFactory, URI("temp:nebula-db-test/statementcachetest.db3"));
+    this->TestBatchedWrites(dbFactory, URI("temp:nebula-db-test/batchedwritestest.db3"));
+    this->TestWriteBehind(dbFactory, URI("temp:nebula-db-test/writebehindtest.db3"));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+DatabaseTest::TestStatementCache(DbFactory* dbFactory, const URI& uri)
+{
+    if (IoServer::Instance()->FileExists(uri))
+    {
+        IoServer::Instance()->DeleteFile(uri);
+    }
+    Ptr<Database> db = dbFactory->CreateDatabase();
+    db->SetURI(uri);
+    db->SetAccessMode(Database::ReadWriteCreate);
+    Ptr<Sqlite3Database> sqliteDb = db.downcast<Sqlite3Database>();
+    sqliteDb->SetStatementCacheSize(2);
+    VERIFY(db->Open());
+
+    // a released statement is handed out again for the same SQL
+    const String sqlA("SELECT 1");
+    const String sqlB("SELECT 2");
+    const String sqlC("SELECT 3");
+    sqlite3_stmt* stmtA = sqliteDb->AcquireStatement(sqlA);
+    VERIFY(0 != stmtA);
+    sqliteDb->ReleaseStatement(sqlA, stmtA);
+    VERIFY(sqliteDb->AcquireStatement(sqlA) == stmtA);
+
+    // a statement in use isn't shared, the second one is compiled anew
+    sqlite3_stmt* stmtA2 = sqliteDb->AcquireStatement(sqlA);
+    VERIFY(0 != stmtA2);
+    VERIFY(stmtA2 != stmtA);
+    sqliteDb->ReleaseStatement(sqlA, stmtA);
+    sqliteDb->ReleaseStatement(sqlA, stmtA2);
+
+    // statements come back reset, so they can be stepped again
+    VERIFY(sqliteDb->AcquireStatement(sqlA) == stmtA);
+    VERIFY(SQLITE_ROW == sqlite3_step(stmtA));
+    VERIFY(1 == sqlite3_column_int(stmtA, 0));
+    sqliteDb->ReleaseStatement(sqlA, stmtA);
+    VERIFY(sqliteDb->AcquireStatement(sqlA) == stmtA);
+    VERIFY(SQLITE_ROW == sqlite3_step(stmtA));
+    VERIFY(1 == sqlite3_column_int(stmtA, 0));
+
+    // with a full cache the least recently released statement goes first
+    sqlite3_stmt* stmtB = sqliteDb->AcquireStatement(sqlB);
+    VERIFY(0 != stmtB);
+    sqliteDb->ReleaseStatement(sqlB, stmtB);
+    sqliteDb->ReleaseStatement(sqlA, stmtA);
+    sqlite3_stmt* stmtC = sqliteDb->AcquireStatement(sqlC);
+    VERIFY(0 != stmtC);
+    sqliteDb->ReleaseStatement(sqlC, stmtC);
+    VERIFY(sqliteDb->AcquireStatement(sqlA) == stmtA);
+    VERIFY(sqliteDb->AcquireStatement(sqlC) == stmtC);
+    sqliteDb->ReleaseStatement(sqlA, stmtA);
+    sqliteDb->ReleaseStatement(sqlC, stmtC);
+
+    // invalid SQL doesn't compile
+    VERIFY(0 == sqliteDb->AcquireStatement("SELECT FROM WHERE"));
+    db->Close();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Writes more rows than fit into one batched statement, so both the
+    multi-row statement and the single row remainder are used. Updating
+    the rows afterwards goes through the ON CONFLICT statements and must
+    neither duplicate nor lose rows.
+*/
+void
+DatabaseTest::TestBatchedWrites(DbFactory* dbFactory, const URI& uri)
+{
+    if (IoServer::Instance()->FileExists(uri))
+    {
+        IoServer::Instance()->DeleteFile(uri);
+    }
+    Ptr<Database> db = dbFactory->CreateDatabase();
+    db->SetURI(uri);
+    db->SetAccessMode(Database::ReadWriteCreate);
+    VERIFY(db->Open());
+
+    Ptr<Table> table = dbFactory->CreateTable();
+    table->SetName("Batched");
+    table->AddColumn(Column(Attr::GuidValue, Column::Primary));
+    table->AddColumn(Column(Attr::IntValue));
+    table->AddColumn(Column(Attr::StringValue));
+    db->AddTable(table);
+    table->CommitChanges();
+
+    const SizeT numRows = 2 * 64 + 5;
+    Ptr<Dataset> dataset = table->CreateDataset();
+    dataset->AddAllTableColumns();
+    Ptr<ValueTable> values = dataset->Values();
+    IndexT i;
+    for (i = 0; i < numRows; i++)
+    {
+        IndexT row = values->AddRow();
+        Guid guid;
+        guid.Generate();
+        values->SetGuid(Attr::GuidValue, row, guid);
+        values->SetInt(Attr::IntValue, row, i);
+        values->SetString(Attr::StringValue, row, String::Sprintf("row %d", i));
+    }
+    dataset->CommitChanges();
+    VERIFY(!values->HasNewRows());
+    VERIFY(!values->HasModifiedRows());
+
+    Ptr<Dataset> query = table->CreateDataset();
+    query->AddAllTableColumns();
+    query->PerformQuery();
+    Ptr<ValueTable> results = query->Values();
+    VERIFY(numRows == results->GetNumRows());
+    bool allMatch = true;
+    for (i = 0; i < results->GetNumRows(); i++)
+    {
+        allMatch &= results->GetString(Attr::StringValue, i) == String::Sprintf("row %d", results->GetInt(Attr::IntValue, i));
+    }
+    VERIFY(allMatch);
+
+    // update all rows, then only a few which all go into the single row statement
+    for (i = 0; i < numRows; i++)
+    {
+        values->SetInt(Attr::IntValue, i, i * 10);
+    }
+    dataset->CommitChanges();
+    for (i = 0; i < 3; i++)
+    {
+        values->SetString(Attr::StringValue, i, "changed");
+    }
+    dataset->CommitChanges();
+    VERIFY(!values->HasModifiedRows());
+
+    query->PerformQuery();
+    results = query->Values();
+    VERIFY(numRows == results->GetNumRows());
+    SizeT numChanged = 0;
+    allMatch = true;
+    for (i = 0; i < results->GetNumRows(); i++)
+    {
+        const int value = results->GetInt(Attr::IntValue, i);
+        allMatch &= (value % 10) == 0;
+        if (results->GetString(Attr::StringValue, i) == "changed")
+        {
+            allMatch &= value < 30;
+            numChanged++;
+        }
+        else
+        {
+            allMatch &= results->GetString(Attr::StringValue, i) == String::Sprintf("row %d", value / 10);
+        }
+    }
+    VERIFY(allMatch);
+    VERIFY(3 == numChanged);
+    db->Close();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+DatabaseTest::TestWriteBehind(DbFactory* dbFactory, const URI& uri)
+{
+    if (IoServer::Instance()->FileExists(uri))
+    {
+        IoServer::Instance()->DeleteFile(uri);
+    }
+
+    // write-behind needs a database on disk
+    Ptr<Sqlite3Database> memoryDb = dbFactory->CreateDatabase().downcast<Sqlite3Database>();
+    memoryDb->SetURI(uri);
+    memoryDb->SetInMemoryDatabase(true);
+    memoryDb->SetAccessMode(Database::ReadWriteCreate);
+    memoryDb->SetWriteBehind(true);
+    VERIFY(memoryDb->Open());
+    VERIFY(!memoryDb->IsWriteBehind());
+    memoryDb->Close();
+
+    Ptr<Sqlite3Database> db = dbFactory->CreateDatabase().downcast<Sqlite3Database>();
+    db->SetURI(uri);
+    db->SetAccessMode(Database::ReadWriteCreate);
+    db->SetJournalMode(Sqlite3Database::WriteAheadLog);
+    db->SetWriteBehind(true);
+    VERIFY(db->Open());
+    VERIFY(db->IsWriteBehind());
+
+    Ptr<Table> table = dbFactory->CreateTable();
+    table->SetName("WriteBehind");
+    table->AddColumn(Column(Attr::GuidValue, Column::Primary));
+    table->AddColumn(Column(Attr::IntValue));
+    db->AddTable(table);
+    table->CommitChanges();
+
+    const SizeT numRows = 100;
+    Ptr<Dataset> dataset = table->CreateDataset();
+    dataset->AddAllTableColumns();
+    Ptr<ValueTable> values = dataset->Values();
+    IndexT i;
+    for (i = 0; i < numRows; i++)
+    {
+        IndexT row = values->AddRow();
+        Guid guid;
+        guid.Generate();
+        values->SetGuid(Attr::GuidValue, row, guid);
+        values->SetInt(Attr::IntValue, row, 1);
+    }
+    dataset->CommitChanges();
+
+    // after a flush everything is in the file, another connection sees it
+    db->Flush();
+    VERIFY(!db->HasPendingWrites());
+    Ptr<Database> reader = dbFactory->CreateDatabase();
+    reader->SetURI(uri);
+    reader->SetAccessMode(Database::ReadOnly);
+    VERIFY(reader->Open());
+    VERIFY(reader->HasTable("WriteBehind"));
+    Ptr<Dataset> readerQuery = reader->GetTableByName("WriteBehind")->CreateDataset();
+    readerQuery->AddAllTableColumns();
+    readerQuery->PerformQuery();
+    VERIFY(numRows == readerQuery->Values()->GetNumRows());
+
+    // several commits are queued, a query on the writing database waits for them
+    for (i = 0; i < numRows; i++)
+    {
+        values->SetInt(Attr::IntValue, i, 2);
+        if ((i % 10) == 9)
+        {
+            dataset->CommitChanges();
+        }
+    }
+    Ptr<Dataset> query = table->CreateDataset();
+    query->AddAllTableColumns();
+    query->PerformQuery();
+    VERIFY(!db->HasPendingWrites());
+    VERIFY(numRows == query->Values()->GetNumRows());
+    bool allUpdated = true;
+    for (i = 0; i < query->Values()->GetNumRows(); i++)
+    {
+        allUpdated &= 2 == query->Values()->GetInt(Attr::IntValue, i);
+    }
+    VERIFY(allUpdated);
+
+    // deleted rows are written behind too
+    for (i = 0; i < 10; i++)
+    {
+        values->DeleteRow(i);
+    }
+    dataset->CommitChanges();
+    db->Flush();
+    readerQuery->PerformQuery();
+    VERIFY(numRows - 10 == readerQuery->Values()->GetNumRows());
+
+    reader->Close();
+    db->Close();
 }
 
 }
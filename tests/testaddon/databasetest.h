@@ -9,6 +9,8 @@
     (C) 2006 Radon Labs GmbH
 */
 #include "testbase/testcase.h"
+#include "db/dbfactory.h"
+#include "io/uri.h"
 
 //------------------------------------------------------------------------------
 namespace Test
@@ -19,6 +21,14 @@ class DatabaseTest : public TestCase
 public:
     /// run the test
     virtual void Run();
+
+private:
+    /// check reuse and least recently used eviction of cached statements
+    void TestStatementCache(Db::DbFactory* dbFactory, const IO::URI& uri);
+    /// write full and partial batches of new rows, then update them in place
+    void TestBatchedWrites(Db::DbFactory* dbFactory, const IO::URI& uri);
+    /// commit through the writer thread and read back through another connection
+    void TestWriteBehind(Db::DbFactory* dbFactory, const IO::URI& uri);
 };
 
 }; // namespace Test
@@ -11,6 +11,8 @@ namespace Attr
     DefineBool(BoolValue, 'bval', ReadWrite);
     DefineFloat(FloatValue, 'fval', ReadWrite);
     DefineInt(IntValue, 'ival',  ReadWrite);
+    DefineUInt(UIntValue, 'uval', ReadWrite);
+    DefineInt64(Int64Value, 'i64v', ReadWrite);
     DefineFloat4(Float4Value, 'v4vl', ReadWrite);
     DefineMatrix44(Matrix44Value, 'mxvl', ReadWrite);
     DefineString(StringValue, 'sval', ReadWrite);
@@ -17,6 +17,8 @@ namespace Attr
     DeclareBool(BoolValue, 'bval', ReadWrite);
     DeclareFloat(FloatValue, 'fval', ReadWrite);
     DeclareInt(IntValue, 'ival',  ReadWrite);
+    DeclareUInt(UIntValue, 'uval', ReadWrite);
+    DeclareInt64(Int64Value, 'i64v', ReadWrite);
     DeclareFloat4(Float4Value, 'v4vl', ReadWrite);
     DeclareMatrix44(Matrix44Value, 'mxvl', ReadWrite);
     DeclareString(StringValue, 'sval', ReadWrite);
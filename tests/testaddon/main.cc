@@ -10,9 +10,13 @@
 #include "testbase/testrunner.h"
 
 // tests
+#include "compiledtabletest.h"
 #include "databasetest.h"
 #include "datasettest.h"
 #include "dbattrs.h"
+#include "meshoptimizertest.h"
+#include "meshweldtest.h"
+#include "snapshottest.h"
 
 using namespace Core;
 using namespace Test;
@@ -32,6 +36,10 @@ __cdecl main()
     Ptr<TestRunner> testRunner = TestRunner::Create();
     testRunner->AttachTestCase(DatabaseTest::Create());
     testRunner->AttachTestCase(DatasetTest::Create());
+    testRunner->AttachTestCase(SnapshotTest::Create());
+    testRunner->AttachTestCase(CompiledTableTest::Create());
+    testRunner->AttachTestCase(MeshWeldTest::Create());
+    testRunner->AttachTestCase(MeshOptimizerTest::Create());
     bool result = testRunner->Run();
 
     coreServer->Close();
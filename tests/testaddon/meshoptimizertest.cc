@@ -0,0 +1,150 @@
+//------------------------------------------------------------------------------
+//  meshoptimizertest.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "testaddon/meshoptimizertest.h"
+#include "model/meshutil/meshbuilderoptimizer.h"
+#include "math/vec2.h"
+
+namespace Test
+{
+__ImplementClass(Test::MeshOptimizerTest, 'MOTE', Test::TestCase);
+
+using namespace Math;
+using namespace Util;
+using namespace ToolkitUtil;
+
+static const SizeT GridSize = 24;
+
+//------------------------------------------------------------------------------
+/**
+    Build an indexed grid in a single primitive group, with the triangles in
+    a scattered order so that every corner misses the vertex cache.
+*/
+static void
+BuildScatteredGrid(MeshBuilder& mesh)
+{
+    const MeshBuilderVertex::ComponentMask components = MeshBuilderVertex::Components::Position | MeshBuilderVertex::Components::Uvs;
+    const SizeT numTriangles = GridSize * GridSize * 2;
+    mesh.Clear();
+    mesh.SetComponents(components);
+    mesh.SetPrimitiveTopology(CoreGraphics::PrimitiveTopology::TriangleList);
+    mesh.NewMesh((GridSize + 1) * (GridSize + 1), numTriangles);
+    for (IndexT y = 0; y <= GridSize; y++)
+    {
+        for (IndexT x = 0; x <= GridSize; x++)
+        {
+            MeshBuilderVertex vtx;
+            vtx.SetComponents(components);
+            vtx.SetPosition(vec4(float(x), 0, float(y), 1));
+            vtx.SetUv(vec2(x / float(GridSize), y / float(GridSize)));
+            mesh.AddVertex(vtx);
+        }
+    }
+
+    Array<MeshBuilderTriangle> triangles;
+    for (IndexT y = 0; y < GridSize; y++)
+    {
+        for (IndexT x = 0; x < GridSize; x++)
+        {
+            const IndexT i = y * (GridSize + 1) + x;
+            triangles.Append(MeshBuilderTriangle(i, i + 1, i + GridSize + 1));
+            triangles.Append(MeshBuilderTriangle(i + 1, i + GridSize + 2, i + GridSize + 1));
+        }
+    }
+
+    // 7919 is prime, so stepping by it visits every triangle once
+    for (IndexT i = 0; i < numTriangles; i++)
+        mesh.AddTriangle(triangles[(i * 7919) % numTriangles]);
+
+    MeshBuilderGroup group;
+    group.SetFirstTriangleIndex(0);
+    group.SetNumTriangles(numTriangles);
+    mesh.SetPrimitiveGroups({ group });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MeshOptimizerTest::Run()
+{
+    // the scattered order misses every vertex, a cache optimized grid gets well below one miss per triangle
+    MeshBuilder mesh;
+    BuildScatteredGrid(mesh);
+    MeshBuilderOptimizer::Statistics input = MeshBuilderOptimizer::AnalyzeVertexCache(mesh);
+    VERIFY(input.acmr == 3.0f);
+
+    MeshBuilderOptimizer::Report report;
+    MeshBuilderOptimizer::Optimize(mesh, report);
+    VERIFY(report.before.acmr == input.acmr);
+    VERIFY(report.after.acmr < 0.8f);
+    VERIFY(report.after.atvr < report.before.atvr);
+    VERIFY(mesh.GetNumTriangles() == GridSize * GridSize * 2);
+    VERIFY(mesh.GetNumVertices() == (GridSize + 1) * (GridSize + 1));
+
+    // every vertex is still used by the same number of triangles
+    FixedArray<SizeT> valence(mesh.GetNumVertices(), 0);
+    for (IndexT i = 0; i < mesh.GetNumTriangles(); i++)
+        for (IndexT corner = 0; corner < 3; corner++)
+            valence[mesh.TriangleAt(i).GetVertexIndex(corner)]++;
+    SizeT numCorners = 0, numInnerVertices = 0;
+    for (IndexT i = 0; i < valence.Size(); i++)
+    {
+        numCorners += valence[i];
+        numInnerVertices += valence[i] == 6 ? 1 : 0;
+    }
+    VERIFY(numCorners == mesh.GetNumTriangles() * 3);
+    VERIFY(numInnerVertices == (GridSize - 1) * (GridSize - 1));
+
+    // meshlets with the default limits and with limits small enough that both of them are hit
+    SizeT numMeshlets = MeshBuilderOptimizer::BuildMeshlets(mesh);
+    VERIFY(numMeshlets >= SizeT(mesh.GetNumTriangles() / MeshBuilderOptimizer::MaxMeshletTriangles));
+    this->VerifyMeshlets(mesh, MeshBuilderOptimizer::MaxMeshletVertices, MeshBuilderOptimizer::MaxMeshletTriangles);
+
+    numMeshlets = MeshBuilderOptimizer::BuildMeshlets(mesh, 8, 4);
+    VERIFY(numMeshlets >= SizeT(mesh.GetNumTriangles() / 4));
+    this->VerifyMeshlets(mesh, 8, 4);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MeshOptimizerTest::VerifyMeshlets(MeshBuilder& mesh, SizeT maxVertices, SizeT maxTriangles)
+{
+    const Array<MeshBuilderMeshlet>& meshlets = mesh.GetMeshlets();
+    const MeshBuilderGroup& group = mesh.GetPrimitiveGroups()[0];
+    VERIFY(group.GetFirstMeshletIndex() == 0);
+    VERIFY(group.GetNumMeshlets() == meshlets.Size());
+
+    bool withinLimits = true;
+    bool contiguous = true;
+    bool vertexCountsMatch = true;
+    IndexT nextTriangle = group.GetFirstTriangleIndex();
+    for (const MeshBuilderMeshlet& meshlet : meshlets)
+    {
+        withinLimits &= meshlet.numTriangles > 0 && meshlet.numTriangles <= maxTriangles && meshlet.numVertices <= maxVertices;
+        contiguous &= meshlet.firstTriangleIndex == nextTriangle;
+        nextTriangle = meshlet.firstTriangleIndex + meshlet.numTriangles;
+
+        Array<IndexT> unique;
+        for (IndexT i = meshlet.firstTriangleIndex; i < meshlet.firstTriangleIndex + meshlet.numTriangles; i++)
+        {
+            for (IndexT corner = 0; corner < 3; corner++)
+            {
+                const IndexT vertexIndex = mesh.TriangleAt(i).GetVertexIndex(corner);
+                if (unique.FindIndex(vertexIndex) == InvalidIndex)
+                    unique.Append(vertexIndex);
+            }
+        }
+        vertexCountsMatch &= unique.Size() == meshlet.numVertices;
+    }
+    VERIFY(withinLimits);
+    VERIFY(contiguous);
+    VERIFY(nextTriangle == group.GetFirstTriangleIndex() + group.GetNumTriangles());
+    VERIFY(vertexCountsMatch);
+}
+
+} // namespace Test
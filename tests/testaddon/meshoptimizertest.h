@@ -0,0 +1,31 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::MeshOptimizerTest
+
+    Test the vertex cache optimization and meshlet generation of
+    ToolkitUtil::MeshBuilderOptimizer on a grid mesh.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+#include "model/meshutil/meshbuilder.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class MeshOptimizerTest : public TestCase
+{
+    __DeclareClass(MeshOptimizerTest);
+public:
+    /// run the test
+    virtual void Run();
+
+private:
+    /// check that meshlets cover their groups and stay within the limits
+    void VerifyMeshlets(ToolkitUtil::MeshBuilder& mesh, SizeT maxVertices, SizeT maxTriangles);
+};
+
+}; // namespace Test
+//------------------------------------------------------------------------------
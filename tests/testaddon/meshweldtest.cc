@@ -0,0 +1,196 @@
+//------------------------------------------------------------------------------
+//  meshweldtest.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "testaddon/meshweldtest.h"
+#include "model/meshutil/meshbuilder.h"
+#include "math/vec2.h"
+
+namespace Test
+{
+__ImplementClass(Test::MeshWeldTest, 'MWTE', Test::TestCase);
+
+using namespace Math;
+using namespace Util;
+using namespace ToolkitUtil;
+
+static const SizeT GridSize = 12;
+static const MeshBuilderVertex::ComponentMask GridComponents = MeshBuilderVertex::Components::Position | MeshBuilderVertex::Components::Uvs | MeshBuilderVertex::Components::Normals | MeshBuilderVertex::Components::Tangents;
+
+//------------------------------------------------------------------------------
+/**
+    Build an inflated grid where every triangle has its own 3 vertices. The
+    left half has a hard edge in every quad, so copies of a corner only
+    partly weld, and the copies on the x = 0 border alternate between
+    positive and negative zero.
+*/
+static void
+BuildGrid(MeshBuilder& mesh)
+{
+    mesh.Clear();
+    mesh.SetComponents(GridComponents);
+    mesh.SetPrimitiveTopology(CoreGraphics::PrimitiveTopology::TriangleList);
+    mesh.NewMesh(GridSize * GridSize * 6, GridSize * GridSize * 2);
+
+    IndexT vertexIndex = 0;
+    auto addVertex = [&](IndexT x, IndexT y, IndexT quadTriangle)
+    {
+        const bool hardEdge = x < GridSize / 2 && quadTriangle == 1;
+        float px = (x == 0 && quadTriangle == 1) ? -0.0f : float(x);
+        MeshBuilderVertex vtx;
+        vtx.SetComponents(GridComponents);
+        vtx.SetPosition(vec4(px, sinf(x * 0.3f) * cosf(y * 0.3f), float(y), 1));
+        vtx.SetUv(vec2(x / float(GridSize), y / float(GridSize)));
+        vtx.SetNormal(hardEdge ? vec3(0, 0, 1) : vec3(0, 1, 0));
+        vtx.SetTangent(vec3(1, 0, 0));
+        mesh.AddVertex(vtx);
+        return vertexIndex++;
+    };
+    for (IndexT y = 0; y < GridSize; y++)
+    {
+        for (IndexT x = 0; x < GridSize; x++)
+        {
+            IndexT i0 = addVertex(x, y, 0), i1 = addVertex(x + 1, y, 0), i2 = addVertex(x, y + 1, 0);
+            mesh.AddTriangle(MeshBuilderTriangle(i0, i1, i2));
+            IndexT i3 = addVertex(x + 1, y, 1), i4 = addVertex(x + 1, y + 1, 1), i5 = addVertex(x, y + 1, 1);
+            mesh.AddTriangle(MeshBuilderTriangle(i3, i4, i5));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Reference for the deduplication MeshBuilder did before welding, which
+    merged vertices for which MeshBuilderVertex::Compare() returns 0. Fills
+    the new index of every vertex and returns the number of unique vertices.
+*/
+static SizeT
+ReferenceWeld(const MeshBuilder& mesh, Array<IndexT>& remap)
+{
+    Array<IndexT> unique;
+    remap.Clear();
+    for (IndexT i = 0; i < mesh.GetNumVertices(); i++)
+    {
+        IndexT newIndex = InvalidIndex;
+        for (IndexT j = 0; j < unique.Size() && newIndex == InvalidIndex; j++)
+        {
+            if (mesh.VertexAt(unique[j]).Compare(mesh.VertexAt(i)) == 0)
+                newIndex = j;
+        }
+        if (newIndex == InvalidIndex)
+        {
+            newIndex = unique.Size();
+            unique.Append(i);
+        }
+        remap.Append(newIndex);
+    }
+    return unique.Size();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MeshWeldTest::Run()
+{
+    MeshBuilder source;
+    BuildGrid(source);
+    Array<IndexT> remap;
+    const SizeT numUnique = ReferenceWeld(source, remap);
+
+    // Cleanup() welds to the same vertex set as the reference, and every triangle keeps its vertices
+    {
+        MeshBuilder mesh;
+        BuildGrid(mesh);
+        Array<Array<int>> collapseMap;
+        collapseMap.Fill(0, mesh.GetNumVertices(), Array<int>());
+        mesh.Cleanup(&collapseMap);
+
+        VERIFY(mesh.GetNumVertices() == numUnique);
+        VERIFY(mesh.GetNumTriangles() == source.GetNumTriangles());
+        bool trianglesMatch = true;
+        for (IndexT t = 0; t < mesh.GetNumTriangles(); t++)
+        {
+            for (IndexT corner = 0; corner < 3; corner++)
+            {
+                const MeshBuilderVertex& welded = mesh.VertexAt(mesh.TriangleAt(t).GetVertexIndex(corner));
+                const MeshBuilderVertex& original = source.VertexAt(source.TriangleAt(t).GetVertexIndex(corner));
+                trianglesMatch &= welded.Compare(original) == 0;
+            }
+        }
+        VERIFY(trianglesMatch);
+
+        // every old vertex is collapsed into exactly one new vertex which is equal to it,
+        // and vertices the reference merged end up in the same new vertex
+        Array<IndexT> collapsedInto;
+        collapsedInto.Fill(0, source.GetNumVertices(), InvalidIndex);
+        bool collapseMatches = true;
+        for (IndexT i = 0; i < mesh.GetNumVertices(); i++)
+        {
+            for (int oldIndex : collapseMap[i])
+            {
+                collapseMatches &= collapsedInto[oldIndex] == InvalidIndex;
+                collapseMatches &= mesh.VertexAt(i).Compare(source.VertexAt(oldIndex)) == 0;
+                collapsedInto[oldIndex] = i;
+            }
+        }
+        Array<IndexT> referenceTarget;
+        referenceTarget.Fill(0, numUnique, InvalidIndex);
+        for (IndexT i = 0; i < source.GetNumVertices(); i++)
+        {
+            collapseMatches &= collapsedInto[i] != InvalidIndex;
+            if (referenceTarget[remap[i]] == InvalidIndex)
+                referenceTarget[remap[i]] = collapsedInto[i];
+            collapseMatches &= referenceTarget[remap[i]] == collapsedInto[i];
+        }
+        VERIFY(collapseMatches);
+    }
+
+    // Deflate() produces the same vertex count and collapse groups
+    {
+        MeshBuilder mesh;
+        BuildGrid(mesh);
+        FixedArray<Array<IndexT>> collapseMap;
+        mesh.Deflate(&collapseMap);
+
+        VERIFY(mesh.GetNumVertices() == numUnique);
+        SizeT numCollapsed = 0;
+        for (IndexT i = 0; i < mesh.GetNumVertices(); i++)
+        {
+            numCollapsed += collapseMap[i].Size();
+            VERIFY(collapseMap[i].Size() > 0);
+        }
+        VERIFY(numCollapsed == source.GetNumVertices());
+    }
+
+    // NaNs only weld with the same bit pattern, also with -ffast-math
+    {
+        float nan;
+        const uint nanBits = 0x7FC00000;
+        memcpy(&nan, &nanBits, sizeof(float));
+
+        MeshBuilder mesh;
+        mesh.SetComponents(MeshBuilderVertex::Components::Position | MeshBuilderVertex::Components::Uvs);
+        MeshBuilderVertex vtx;
+        vtx.SetComponents(MeshBuilderVertex::Components::Position | MeshBuilderVertex::Components::Uvs);
+        vtx.SetPosition(vec4(1, 2, 3, 1));
+        vtx.SetUv(vec2(nan, 0.5f));
+        mesh.AddVertex(vtx);
+        mesh.AddVertex(vtx);
+        vtx.SetUv(vec2(0.25f, 0.5f));
+        mesh.AddVertex(vtx);
+        mesh.AddTriangle(MeshBuilderTriangle(0, 1, 2));
+
+        MeshBuilder::WeldSettings settings;
+        settings.positionEpsilon = 0.001f;
+        settings.attributeEpsilon = 0.001f;
+        settings.parallel = false;
+        mesh.Weld(settings);
+        VERIFY(mesh.GetNumVertices() == 2);
+        VERIFY(mesh.TriangleAt(0).GetVertexIndex(0) == mesh.TriangleAt(0).GetVertexIndex(1));
+        VERIFY(mesh.TriangleAt(0).GetVertexIndex(0) != mesh.TriangleAt(0).GetVertexIndex(2));
+    }
+}
+
+} // namespace Test
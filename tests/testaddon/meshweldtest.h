@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::MeshWeldTest
+
+    Test the hash based vertex welding of ToolkitUtil::MeshBuilder against a
+    reference implementation of the previous compare based deduplication.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class MeshWeldTest : public TestCase
+{
+    __DeclareClass(MeshWeldTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+}; // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,254 @@
+//------------------------------------------------------------------------------
+//  snapshottest.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "testaddon/snapshottest.h"
+#include "multiplayer/snapshot.h"
+
+namespace Test
+{
+__ImplementClass(Test::SnapshotTest, 'SNPT', Test::TestCase);
+
+using namespace Multiplayer;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static SnapshotEntity
+MakeEntity(uint32_t networkId, float x, float y, float z, float vx)
+{
+    return SnapshotEntity::Quantize(networkId, Math::vec3(x, y, z), Math::vec3(vx, 0.0f, -vx));
+}
+
+//------------------------------------------------------------------------------
+/**
+    Apply decoded changes and removals to a copy of the baseline, like the
+    client does with its replicated entities.
+*/
+static Snapshot
+ApplyChanges(Snapshot const* baseline, Util::Array<SnapshotEntity> const& changed, Util::Array<uint32_t> const& removed)
+{
+    Snapshot result;
+    if (baseline != nullptr)
+        result.entities = baseline->entities;
+    for (SnapshotEntity const& entity : changed)
+    {
+        IndexT i;
+        for (i = 0; i < result.entities.Size(); i++)
+        {
+            if (result.entities[i].networkId == entity.networkId)
+                break;
+        }
+        if (i < result.entities.Size())
+            result.entities[i] = entity;
+        else
+            result.entities.Append(entity);
+    }
+    for (uint32_t id : removed)
+    {
+        for (IndexT i = 0; i < result.entities.Size(); i++)
+        {
+            if (result.entities[i].networkId == id)
+            {
+                result.entities.EraseIndex(i);
+                break;
+            }
+        }
+    }
+    result.Sort();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static bool
+SameEntities(Snapshot const& lhs, Snapshot const& rhs)
+{
+    if (lhs.entities.Size() != rhs.entities.Size())
+        return false;
+    for (IndexT i = 0; i < lhs.entities.Size(); i++)
+    {
+        if (!(lhs.entities[i] == rhs.entities[i]))
+            return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static SnapshotReceiver::Result
+Deliver(SnapshotReceiver& receiver, Snapshot const& snapshot, uint32_t baseline, SnapshotFragments const& fragments, IndexT fragment, Util::Array<SnapshotEntity>& outChanged, Util::Array<uint32_t>& outRemoved)
+{
+    return receiver.ReceiveFragment(snapshot.sequence, baseline, (uint16_t)fragment, (uint16_t)fragments.offsets.Size(),
+        fragments.data.Begin() + fragments.offsets[fragment], fragments.sizes[fragment], outChanged, outRemoved);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SnapshotTest::Run()
+{
+    Util::Array<SnapshotEntity> changed;
+    Util::Array<uint32_t> removed;
+    SnapshotFragments fragments;
+
+    // quantization
+    SnapshotEntity quantized = MakeEntity(7, 1.5f, -2.25f, 100.0f, 3.0f);
+    VERIFY(Math::nearequal(quantized.GetPosition(), Math::vec3(1.5f, -2.25f, 100.0f), SnapshotPositionPrecision));
+    VERIFY(Math::nearequal(quantized.GetVelocity(), Math::vec3(3.0f, 0.0f, -3.0f), SnapshotVelocityPrecision));
+
+    // baseline of 100 entities with ids 2, 4, ..., 200
+    Snapshot baseline;
+    baseline.sequence = 1;
+    for (uint32_t i = 1; i <= 100; i++)
+        baseline.entities.Append(MakeEntity(i * 2, i * 1.0f, 0.0f, -(i * 0.5f), 0.0f));
+    baseline.Sort();
+
+    // next tick: every fifth entity moves, id 50 despawns, id 301 spawns
+    Snapshot snapshot;
+    snapshot.sequence = 2;
+    for (SnapshotEntity const& base : baseline.entities)
+    {
+        if (base.networkId == 50)
+            continue;
+        SnapshotEntity entity = base;
+        if (base.networkId % 10 == 0)
+            entity = MakeEntity(base.networkId, base.GetPosition().x + 0.25f, 1.0f, base.GetPosition().z, -1.0f);
+        snapshot.entities.Append(entity);
+    }
+    snapshot.entities.Append(MakeEntity(301, -50.0f, 2.0f, 8.0f, 4.0f));
+    snapshot.Sort();
+
+    // delta round trip against the baseline only carries what changed
+    SnapshotEncodeDelta(snapshot, &baseline, fragments);
+    VERIFY(fragments.offsets.Size() == 1);
+    VERIFY(SnapshotDecodeFragment(fragments.data.Begin(), fragments.sizes[0], &baseline, changed, removed));
+    VERIFY(changed.Size() == 20);
+    VERIFY(removed.Size() == 1 && removed[0] == 50);
+    VERIFY(SameEntities(ApplyChanges(&baseline, changed, removed), snapshot));
+
+    // the same snapshot against no baseline carries everything
+    SnapshotFragments full;
+    SnapshotEncodeDelta(snapshot, nullptr, full);
+    VERIFY(full.data.Size() > fragments.data.Size());
+    changed.Clear();
+    removed.Clear();
+    for (IndexT f = 0; f < full.offsets.Size(); f++)
+        VERIFY(SnapshotDecodeFragment(full.data.Begin() + full.offsets[f], full.sizes[f], nullptr, changed, removed));
+    VERIFY(changed.Size() == snapshot.entities.Size());
+    VERIFY(removed.IsEmpty());
+    VERIFY(SameEntities(ApplyChanges(nullptr, changed, removed), snapshot));
+
+    // an unchanged snapshot still produces one empty fragment to acknowledge
+    SnapshotEncodeDelta(baseline, &baseline, fragments);
+    VERIFY(fragments.offsets.Size() == 1);
+    VERIFY(fragments.sizes[0] == 0);
+
+    // a truncated record is malformed
+    SnapshotEncodeDelta(snapshot, &baseline, fragments);
+    changed.Clear();
+    removed.Clear();
+    VERIFY(!SnapshotDecodeFragment(fragments.data.Begin(), fragments.sizes[0] - 1, &baseline, changed, removed));
+
+    // a large snapshot is split into fragments which decode on their own, in any order
+    Snapshot large;
+    large.sequence = 3;
+    for (uint32_t i = 0; i < 2000; i++)
+        large.entities.Append(MakeEntity(1000 + i * 3, i * 0.75f, -(i * 0.5f), i * 2.0f, i * 0.125f));
+    large.Sort();
+    SnapshotEncodeDelta(large, nullptr, fragments);
+    SizeT numFragments = fragments.offsets.Size();
+    VERIFY(numFragments > 1);
+    bool fragmentsFit = true;
+    for (IndexT f = 0; f < numFragments; f++)
+        fragmentsFit &= fragments.sizes[f] > 0 && fragments.sizes[f] <= SnapshotMaxFragmentSize;
+    VERIFY(fragmentsFit);
+    changed.Clear();
+    removed.Clear();
+    for (IndexT f = numFragments - 1; f >= 0; f--)
+        VERIFY(SnapshotDecodeFragment(fragments.data.Begin() + fragments.offsets[f], fragments.sizes[f], nullptr, changed, removed));
+    VERIFY(SameEntities(ApplyChanges(nullptr, changed, removed), large));
+
+    // the receiver completes a snapshot when all fragments arrived, in any order, once each
+    SnapshotReceiver receiver;
+    VERIFY(receiver.GetLastCompleteSequence() == SnapshotInvalidSequence);
+    changed.Clear();
+    removed.Clear();
+    for (IndexT f = numFragments - 1; f > 0; f--)
+        VERIFY(Deliver(receiver, large, SnapshotInvalidSequence, fragments, f, changed, removed) == SnapshotReceiver::Partial);
+    VERIFY(Deliver(receiver, large, SnapshotInvalidSequence, fragments, 1, changed, removed) == SnapshotReceiver::Rejected);
+    VERIFY(receiver.GetLastCompleteSequence() == SnapshotInvalidSequence);
+    VERIFY(Deliver(receiver, large, SnapshotInvalidSequence, fragments, 0, changed, removed) == SnapshotReceiver::Complete);
+    VERIFY(receiver.GetLastCompleteSequence() == large.sequence);
+    VERIFY(SameEntities(ApplyChanges(nullptr, changed, removed), large));
+
+    // fragments of an already complete snapshot are stale
+    VERIFY(Deliver(receiver, large, SnapshotInvalidSequence, fragments, 0, changed, removed) == SnapshotReceiver::Rejected);
+
+    // a snapshot which loses a fragment never completes, the next one replaces it
+    Snapshot moved = large;
+    moved.sequence = 4;
+    for (IndexT i = 0; i < moved.entities.Size(); i += 2)
+        moved.entities[i].pos[1] += 3;
+    SnapshotEncodeDelta(moved, &large, fragments);
+    VERIFY(fragments.offsets.Size() > 1);
+    VERIFY(Deliver(receiver, moved, large.sequence, fragments, 0, changed, removed) == SnapshotReceiver::Partial);
+    SnapshotFragments lostFragments = fragments;
+
+    Snapshot next = moved;
+    next.sequence = 5;
+    next.entities.EraseIndex(10);
+    SnapshotEncodeDelta(next, &large, fragments);
+    changed.Clear();
+    removed.Clear();
+    SnapshotReceiver::Result result = SnapshotReceiver::Rejected;
+    for (IndexT f = 0; f < fragments.offsets.Size(); f++)
+        result = Deliver(receiver, next, large.sequence, fragments, f, changed, removed);
+    VERIFY(result == SnapshotReceiver::Complete);
+    VERIFY(receiver.GetLastCompleteSequence() == next.sequence);
+    VERIFY(removed.Size() == 1 && removed[0] == large.entities[10].networkId);
+    VERIFY(SameEntities(ApplyChanges(&large, changed, removed), next));
+
+    // late fragments of the lost snapshot are rejected, and it can't be a baseline
+    VERIFY(Deliver(receiver, moved, large.sequence, lostFragments, 1, changed, removed) == SnapshotReceiver::Rejected);
+    Snapshot afterLost = next;
+    afterLost.sequence = 6;
+    SnapshotEncodeDelta(afterLost, &moved, fragments);
+    VERIFY(Deliver(receiver, afterLost, moved.sequence, fragments, 0, changed, removed) == SnapshotReceiver::Rejected);
+
+    // the server falls back to a full snapshot once the acknowledged baseline left its history
+    SnapshotHistory history;
+    history.Store(baseline);
+    VERIFY(history.Find(baseline.sequence) != nullptr);
+    VERIFY(history.Find(SnapshotInvalidSequence) == nullptr);
+    Snapshot filler;
+    for (uint32_t sequence = 2; sequence <= SnapshotHistorySize + 1; sequence++)
+    {
+        filler.sequence = sequence;
+        history.Store(filler);
+    }
+    VERIFY(history.Find(baseline.sequence) == nullptr);
+    VERIFY(history.Find(SnapshotHistorySize + 1) != nullptr);
+
+    SnapshotReceiver fresh;
+    Snapshot recovered = snapshot;
+    recovered.sequence = 7;
+    SnapshotEncodeDelta(recovered, history.Find(baseline.sequence), fragments);
+    changed.Clear();
+    removed.Clear();
+    VERIFY(Deliver(fresh, recovered, SnapshotInvalidSequence, fragments, 0, changed, removed) == SnapshotReceiver::Complete);
+    VERIFY(fresh.GetLastCompleteSequence() == recovered.sequence);
+    VERIFY(SameEntities(ApplyChanges(nullptr, changed, removed), recovered));
+
+    // after a reset every delta is rejected until a full snapshot arrives
+    fresh.Reset();
+    SnapshotEncodeDelta(afterLost, &recovered, fragments);
+    VERIFY(Deliver(fresh, afterLost, recovered.sequence, fragments, 0, changed, removed) == SnapshotReceiver::Rejected);
+    VERIFY(fresh.GetLastCompleteSequence() == SnapshotInvalidSequence);
+}
+
+} // namespace Test
@@ -0,0 +1,25 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::SnapshotTest
+
+    Test delta encoding, fragmentation and reassembly of multiplayer snapshots.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class SnapshotTest : public TestCase
+{
+    __DeclareClass(SnapshotTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+}; // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,194 @@
+//------------------------------------------------------------------------------
+//  flathashtabletest.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "flathashtabletest.h"
+#include "util/flathashtable.h"
+#include "util/stringatom.h"
+#include "ids/id.h"
+
+namespace Test
+{
+__ImplementClass(Test::FlatHashTableTest, 'FHTT', Test::TestCase);
+
+using namespace Util;
+
+ID_16_TYPE(FlatHashTestId16);
+ID_32_TYPE(FlatHashTestId32);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+FlatHashTableTest::Run()
+{
+    // empty table
+    FlatHashTable<int, int> table;
+    VERIFY(table.Size() == 0);
+    VERIFY(table.IsEmpty());
+    VERIFY(table.Capacity() == 0);
+    VERIFY(!table.Contains(1));
+    VERIFY(table.FindIndex(1) == InvalidIndex);
+
+    // rehash while growing, all keys and slot indices stay valid
+    const int numKeys = 5000;
+    IndexT i;
+    for (i = 0; i < numKeys; i++)
+    {
+        IndexT slot = table.Add(i, i * 3);
+        VERIFY(table.ValueAtIndex(i, slot) == i * 3);
+    }
+    VERIFY(table.Size() == numKeys);
+    VERIFY(table.Capacity() >= numKeys);
+    VERIFY((table.Capacity() & (table.Capacity() - 1)) == 0);
+    bool allFound = true;
+    for (i = 0; i < numKeys; i++)
+    {
+        IndexT slot = table.FindIndex(i);
+        allFound &= slot != InvalidIndex && table.ValueAtIndex(i, slot) == i * 3 && table[i] == i * 3;
+    }
+    VERIFY(allFound);
+    VERIFY(!table.Contains(numKeys));
+    VERIFY(!table.Contains(-1));
+
+    // lookup after erase, erased keys leave tombstones the probing has to skip
+    for (i = 0; i < numKeys; i += 2)
+    {
+        table.Erase(i);
+    }
+    VERIFY(table.Size() == numKeys / 2);
+    bool lookupsCorrect = true;
+    for (i = 0; i < numKeys; i++)
+    {
+        lookupsCorrect &= table.Contains(i) == ((i & 1) == 1);
+    }
+    VERIFY(lookupsCorrect);
+    IndexT slot = table.FindIndex(1);
+    table.EraseIndex(1, slot);
+    VERIFY(!table.Contains(1));
+    VERIFY(table.Size() == numKeys / 2 - 1);
+
+    // reinsert erased keys with new values
+    for (i = 0; i < numKeys; i += 2)
+    {
+        table.Add(i, -i);
+    }
+    table.Add(1, 100);
+    VERIFY(table.Size() == numKeys);
+    bool valuesCorrect = true;
+    for (i = 0; i < numKeys; i++)
+    {
+        valuesCorrect &= table[i] == ((i & 1) == 0 ? -i : (i == 1 ? 100 : i * 3));
+    }
+    VERIFY(valuesCorrect);
+
+    // iteration visits every element exactly once
+    Array<int> visited;
+    visited.Fill(0, numKeys, 0);
+    SizeT numVisited = 0;
+    auto it = table.Begin();
+    while (it != table.End())
+    {
+        visited[*it.key]++;
+        VERIFY(*it.val == table[*it.key]);
+        numVisited++;
+        it++;
+    }
+    VERIFY(numVisited == numKeys);
+    VERIFY(visited.FindIndex(0) == InvalidIndex);
+    VERIFY(visited.FindIndex(2) == InvalidIndex);
+    VERIFY(table.KeysAsArray().Size() == numKeys);
+    VERIFY(table.ValuesAsArray().Size() == numKeys);
+
+    // copy and clear
+    FlatHashTable<int, int> copy = table;
+    VERIFY(copy.Size() == numKeys);
+    VERIFY(copy[numKeys - 1] == table[numKeys - 1]);
+    table.Clear();
+    VERIFY(table.IsEmpty());
+    VERIFY(!table.Contains(3));
+    VERIFY(copy.Contains(3));
+
+    // insert/erase churn at a constant size is cleaned up by rehashing in place instead of growing
+    FlatHashTable<int, int> churn;
+    churn.Reserve(100);
+    SizeT churnCapacity = churn.Capacity();
+    for (i = 0; i < 20000; i++)
+    {
+        churn.Add(i, i);
+        if (i >= 50)
+            churn.Erase(i - 50);
+    }
+    VERIFY(churn.Size() == 50);
+    VERIFY(churn.Capacity() == churnCapacity);
+    bool churnCorrect = true;
+    for (i = 20000 - 50; i < 20000; i++)
+    {
+        churnCorrect &= churn.Contains(i) && churn[i] == i;
+    }
+    VERIFY(churnCorrect);
+    VERIFY(!churn.Contains(20000 - 51));
+
+    // emplace
+    FlatHashTable<int, int> emplaced;
+    emplaced.Emplace(5) = 10;
+    emplaced.Emplace(5) += 1;
+    VERIFY(emplaced.Size() == 1);
+    VERIFY(emplaced[5] == 11);
+
+    // 16 bit id keys, which hash to small consecutive values
+    FlatHashTable<FlatHashTestId16, IndexT> ids16;
+    for (i = 0; i < 1000; i++)
+    {
+        ids16.Add(FlatHashTestId16((Ids::Id16)i), i);
+    }
+    ids16.Erase(FlatHashTestId16(500));
+    VERIFY(ids16.Size() == 999);
+    VERIFY(!ids16.Contains(FlatHashTestId16(500)));
+    VERIFY(ids16[FlatHashTestId16(501)] == 501);
+    VERIFY(!ids16.Contains(InvalidFlatHashTestId16));
+
+    // 32 bit id keys spread over the whole range
+    FlatHashTable<FlatHashTestId32, IndexT> ids32;
+    for (i = 0; i < 1000; i++)
+    {
+        ids32.Add(FlatHashTestId32((Ids::Id32)i * 2654435761u), i);
+    }
+    bool idsFound = true;
+    for (i = 0; i < 1000; i++)
+    {
+        idsFound &= ids32[FlatHashTestId32((Ids::Id32)i * 2654435761u)] == i;
+    }
+    VERIFY(idsFound);
+    ids32.Erase(FlatHashTestId32(0));
+    VERIFY(!ids32.Contains(FlatHashTestId32(0)));
+    VERIFY(ids32.Size() == 999);
+
+    // string atom keys
+    Array<String> titles;
+    titles.Append("Nausicaä of the Valley of Wind");
+    titles.Append("Laputa: The Castle in the Sky");
+    titles.Append("My Neighbor Totoro");
+    titles.Append("Kiki's Delivery Service");
+    titles.Append("Porco Rosso");
+    titles.Append("Princess Mononoke");
+
+    FlatHashTable<StringAtom, IndexT> atoms;
+    for (i = 0; i < titles.Size(); i++)
+    {
+        atoms.Add(StringAtom(titles[i]), i);
+    }
+    VERIFY(atoms.Size() == titles.Size());
+    for (i = 0; i < titles.Size(); i++)
+    {
+        VERIFY(atoms[StringAtom(titles[i])] == i);
+    }
+    VERIFY(!atoms.Contains(StringAtom("Ein schöner Tag")));
+    atoms.Erase(StringAtom(titles[1]));
+    VERIFY(!atoms.Contains(StringAtom(titles[1])));
+    VERIFY(atoms.Contains(StringAtom(titles[2])));
+    VERIFY(atoms.Size() == titles.Size() - 1);
+}
+
+} // namespace Test
@@ -0,0 +1,25 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::FlatHashTableTest
+
+    Test FlatHashTable functionality.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class FlatHashTableTest : public TestCase
+{
+    __DeclareClass(FlatHashTableTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+}; // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,77 @@
+//------------------------------------------------------------------------------
+//  frameallocatortest.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "stdneb.h"
+#include "frameallocatortest.h"
+#include "memory/frameallocator.h"
+
+namespace Test
+{
+__ImplementClass(Test::FrameAllocatorTest, 'FRAT', Test::TestCase);
+
+using namespace Memory;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+FrameAllocatorTest::Run()
+{
+    FrameAllocatorInitInfo info;
+    info.frameMemorySize = 16_KB;
+    info.numFrames = 2;
+    info.blockSize = 1_KB;
+    info.poison = true;
+    FrameAllocatorInit(info);
+
+    // consecutive allocations bump allocate from the thread's block
+    byte* a = (byte*)FrameAlloc(16);
+    byte* b = (byte*)FrameAlloc(16);
+    VERIFY(a != nullptr);
+    VERIFY(b == a + 16);
+    byte* aligned = (byte*)FrameAlloc(3, 256);
+    VERIFY(((uintptr_t)aligned & 255) == 0);
+    Memory::Fill(a, 32, 0x11);
+
+    // a new frame claims fresh blocks, the previous frame stays intact
+    FrameAllocatorNewFrame();
+    VERIFY(FrameAllocatorGetStats().usedBytes == 1_KB);
+    byte* c = (byte*)FrameAlloc(16);
+    VERIFY(c != nullptr && c != b + 16);
+    VERIFY(a[0] == 0x11 && a[31] == 0x11);
+
+    // after numFrames new frames the memory is recycled and poisoned
+    FrameAllocatorNewFrame();
+    VERIFY(a[0] == FrameAllocatorPoison);
+
+    // allocations which don't fit go to the heap
+    const SizeT numOverflows = FrameAllocatorGetStats().numOverflows;
+    byte* big = (byte*)FrameAlloc(32_KB);
+    VERIFY(big != nullptr);
+    Memory::Fill(big, 32_KB, 0x22);
+    VERIFY(FrameAllocatorGetStats().numOverflows == numOverflows + 1);
+    FrameAllocatorNewFrame();
+    FrameAllocatorNewFrame();
+
+    // a block of this thread from before a restart must not be used after it,
+    // not even once the allocator got as many new frames as before the restart
+    FrameAllocatorUninit();
+    FrameAllocatorInit(info);
+    FrameAllocatorNewFrame();
+    VERIFY(FrameAlloc(16) != nullptr);
+    FrameAllocatorUninit();
+    FrameAllocatorInit(info);
+    FrameAllocatorNewFrame();
+    byte* d = (byte*)FrameAlloc(16);
+    VERIFY(d != nullptr);
+    FrameAllocatorNewFrame();
+    VERIFY(FrameAllocatorGetStats().usedBytes == 1_KB);
+    byte* e = (byte*)FrameAlloc(16);
+    VERIFY(e != nullptr);
+    VERIFY(e[16] == FrameAllocatorPoison);
+
+    FrameAllocatorUninit();
+}
+
+} // namespace Test
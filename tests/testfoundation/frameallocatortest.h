@@ -0,0 +1,25 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::FrameAllocatorTest
+
+    Test the frame allocator, including a restart on the same thread.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class FrameAllocatorTest : public TestCase
+{
+    __DeclareClass(FrameAllocatorTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+}; // namespace Test
+//------------------------------------------------------------------------------
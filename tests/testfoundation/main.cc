@@ -18,6 +18,7 @@
 #include "fixedarraytest.h"
 #include "fixedtabletest.h"
 #include "hashtabletest.h"
+#include "flathashtabletest.h"
 #include "queuetest.h"
 #include "arrayqueuetest.h"
 #include "memorystreamtest.h"
@@ -45,6 +46,7 @@
 #include "matrix44test.h"
 #include "threadtest.h"
 #include "memorypooltest.h"
+#include "frameallocatortest.h"
 #include "runlengthcodectest.h"
 #include "sizeclassificationallocatortest.h"
 #include "ringbuffertest.h"
@@ -93,6 +95,7 @@ __cdecl main()
     // FIXME 
     testRunner->AttachTestCase(SizeClassificationAllocatorTest::Create());
     testRunner->AttachTestCase(MemoryPoolTest::Create());
+    testRunner->AttachTestCase(FrameAllocatorTest::Create());
     testRunner->AttachTestCase(Matrix44Test::Create());
     testRunner->AttachTestCase(Float4Test::Create());
     testRunner->AttachTestCase(ZipFSTest::Create());
@@ -114,6 +117,7 @@ __cdecl main()
     testRunner->AttachTestCase(FixedArrayTest::Create());
     testRunner->AttachTestCase(FixedTableTest::Create());
     testRunner->AttachTestCase(HashTableTest::Create());
+    testRunner->AttachTestCase(FlatHashTableTest::Create());
     testRunner->AttachTestCase(QueueTest::Create());
     testRunner->AttachTestCase(ArrayQueueTest::Create());
     testRunner->AttachTestCase(MemoryStreamTest::Create());
@@ -6,7 +6,10 @@
 #include "profilingtest.h"
 #include "core/ptr.h"
 #include "profiling/profiling.h"
+#include "profiling/trace.h"
 #include "threading/thread.h"
+#include "io/fswrapper.h"
+#include "io/assignregistry.h"
 #include <functional>
 
 namespace Test
@@ -129,6 +132,77 @@ ProfilingTest::Run()
             RecursivePrintScopes(ctx.topLevelScopes[j], 0);
         }
     }
+
+    // counters hit from several threads are merged when read
+    static const char* counterName = "ProfilingTestCounter";
+    auto count = []()
+    {
+        for (IndexT j = 0; j < 1000; j++)
+            ProfilingIncreaseCounter(counterName, 3);
+        ProfilingDecreaseCounter(counterName, 1000);
+    };
+    Ptr<ProfilingThread> counterThread = ProfilingThread::Create();
+    counterThread->fn = count;
+    counterThread->SetName("ProfilingCounterThread");
+    counterThread->Start();
+    count();
+    counterThread->Stop();
+    VERIFY(ProfilingGetCounters()[counterName] == 4000);
+
+    // capture a trace and convert it to JSON
+    TraceCaptureInfo traceInfo;
+    traceInfo.path = "temp:profilingtest.ntrace";
+    VERIFY(ProfilingTraceStart(traceInfo));
+    VERIFY(ProfilingTraceIsCapturing());
+    {
+        N_SCOPE(TraceOuter, test);
+        {
+            N_SCOPE(TraceInner, test);
+            ProfilingIncreaseCounter(counterName, 7);
+            ProfilingDecreaseCounter(counterName, 2);
+        }
+    }
+    ProfilingNewFrame();
+    ProfilingTraceStop();
+    VERIFY(!ProfilingTraceIsCapturing());
+    VERIFY(ProfilingGetCounters()[counterName] == 4005);
+
+    // at least begin and end of both scopes, two counter deltas and the frame
+    TraceStats stats = ProfilingTraceGetStats();
+    VERIFY(stats.numEvents >= 7);
+    VERIFY(stats.numDropped == 0);
+    VERIFY(stats.bytesWritten > 0);
+
+    VERIFY(ProfilingTraceConvertToJson("temp:profilingtest.ntrace", "temp:profilingtest.json"));
+    Util::String jsonPath = IO::AssignRegistry::Instance()->ResolveAssignsInString("temp:profilingtest.json");
+    IO::FSWrapper::Handle file = IO::FSWrapper::OpenFile(jsonPath, IO::Stream::ReadAccess, IO::Stream::Sequential);
+    VERIFY(file != 0);
+    if (file != 0)
+    {
+        Util::Array<char> buffer;
+        buffer.Resize((SizeT)IO::FSWrapper::GetFileSize(file));
+        IO::FSWrapper::Read(file, buffer.Begin(), buffer.Size());
+        IO::FSWrapper::CloseFile(file);
+        Util::String json;
+        json.Set(buffer.Begin(), buffer.Size());
+
+        VERIFY(json.BeginsWithString("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+        IndexT outer = json.FindStringIndex("{\"ph\":\"B\",\"name\":\"TraceOuter\",\"cat\":\"test\"");
+        IndexT inner = json.FindStringIndex("{\"ph\":\"B\",\"name\":\"TraceInner\",\"cat\":\"test\"");
+        VERIFY(outer != InvalidIndex);
+        VERIFY(inner > outer);
+        IndexT firstEnd = json.FindStringIndex("{\"ph\":\"E\"", inner);
+        VERIFY(firstEnd != InvalidIndex);
+        VERIFY(json.FindStringIndex("{\"ph\":\"E\"", firstEnd + 1) != InvalidIndex);
+        VERIFY(json.FindStringIndex("\"name\":\"Frame\"") != InvalidIndex);
+
+        // counter events carry the running sum of the deltas in the capture
+        IndexT counter = json.FindStringIndex("{\"ph\":\"C\",\"name\":\"ProfilingTestCounter\"");
+        VERIFY(counter != InvalidIndex);
+        VERIFY(json.FindStringIndex("\"args\":{\"value\":7}", counter) != InvalidIndex);
+        VERIFY(json.FindStringIndex("\"args\":{\"value\":5}", counter) != InvalidIndex);
+        VERIFY(json.EndsWithString("]}\n"));
+    }
 }
 
 }; // namespace Test
@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+//  @file instancerangetest.cc
+//  @copyright (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "raytracing/instanceranges.h"
+#include "instancerangetest.h"
+namespace Test
+{
+
+__ImplementClass(InstanceRangeTest, 'IRTE', Test::TestCase);
+
+using namespace Raytracing;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static bool
+RangeEquals(const InstanceRange& range, uint first, uint num)
+{
+    return range.first == first && range.num == num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InstanceRangeTest::Run()
+{
+    Util::Array<uint> changed;
+    Util::Array<bool> moved;
+    Util::Array<InstanceRange> objects, instances;
+
+    // nothing changed, nothing to upload
+    InstanceRangesCollect(changed, moved, objects, instances);
+    VERIFY(objects.IsEmpty());
+    VERIFY(instances.IsEmpty());
+
+    // duplicates are dropped and consecutive indices merge, gaps split ranges
+    changed = { 7, 3, 4, 3, 5, 10, 7 };
+    InstanceRangesCollect(changed, moved, objects, instances);
+    VERIFY(changed.Size() == 5);
+    VERIFY(changed[0] == 3 && changed[1] == 4 && changed[2] == 5 && changed[3] == 7 && changed[4] == 10);
+    VERIFY(objects.Size() == 3);
+    VERIFY(RangeEquals(objects[0], 3, 3));
+    VERIFY(RangeEquals(objects[1], 7, 1));
+    VERIFY(RangeEquals(objects[2], 10, 1));
+    VERIFY(instances.Size() == 3);
+    VERIFY(RangeEquals(instances[0], 3, 3));
+    VERIFY(RangeEquals(instances[1], 7, 1));
+    VERIFY(RangeEquals(instances[2], 10, 1));
+
+    // moved instances only upload instances, not object bindings
+    changed.Clear();
+    moved = { false, true, true, false, true, false };
+    InstanceRangesCollect(changed, moved, objects, instances);
+    VERIFY(objects.IsEmpty());
+    VERIFY(instances.Size() == 2);
+    VERIFY(RangeEquals(instances[0], 1, 2));
+    VERIFY(RangeEquals(instances[1], 4, 1));
+
+    // the outputs are reset on every call
+    moved.Fill(0, moved.Size(), false);
+    InstanceRangesCollect(changed, moved, objects, instances);
+    VERIFY(objects.IsEmpty());
+    VERIFY(instances.IsEmpty());
+
+    // changed and moved instances merge, overlaps count once, changed static instances past the moved ones follow
+    changed = { 12, 0, 3, 2, 13 };
+    moved = { false, true, true, false, false, true };
+    InstanceRangesCollect(changed, moved, objects, instances);
+    VERIFY(objects.Size() == 3);
+    VERIFY(RangeEquals(objects[0], 0, 1));
+    VERIFY(RangeEquals(objects[1], 2, 2));
+    VERIFY(RangeEquals(objects[2], 12, 2));
+    VERIFY(instances.Size() == 3);
+    VERIFY(RangeEquals(instances[0], 0, 4));
+    VERIFY(RangeEquals(instances[1], 5, 1));
+    VERIFY(RangeEquals(instances[2], 12, 2));
+
+    // appending directly ignores indices already covered by the last range
+    Util::Array<InstanceRange> ranges;
+    InstanceRangeAppend(ranges, 4);
+    InstanceRangeAppend(ranges, 5);
+    InstanceRangeAppend(ranges, 5);
+    InstanceRangeAppend(ranges, 8);
+    VERIFY(ranges.Size() == 2);
+    VERIFY(RangeEquals(ranges[0], 4, 2));
+    VERIFY(RangeEquals(ranges[1], 8, 1));
+}
+
+} // namespace Test
@@ -0,0 +1,22 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    Test for the coalescing of ray tracing instance uploads
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "testbase/testcase.h"
+namespace Test
+{
+
+class InstanceRangeTest : public TestCase
+{
+    __DeclareClass(InstanceRangeTest);
+public:
+    /// run test
+    virtual void Run();
+};
+
+} // namespace Test
@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------
+//  @file lightboundstest.cc
+//  @copyright (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "lighting/lightcontext.h"
+#include "lightboundstest.h"
+namespace Test
+{
+
+__ImplementClass(LightBoundsTest, 'LBTE', Test::TestCase);
+
+using namespace Math;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LightBoundsTest::Run()
+{
+    const float range = 10.0f;
+    const float angle = deg2rad(30.0f);
+    const float capRadius = range * Math::tan(angle);
+
+    // identity rotation, the cone points along -z from the apex
+    mat4 trans = translation(1.0f, 2.0f, 3.0f);
+    bbox box = Lighting::LightContext::SpotLightBounds(trans, angle, range);
+    VERIFY(nearequal(xyz(box.pmin), vec3(1.0f - capRadius, 2.0f - capRadius, 3.0f - range), 0.001f));
+    VERIFY(nearequal(xyz(box.pmax), vec3(1.0f + capRadius, 2.0f + capRadius, 3.0f), 0.001f));
+    VERIFY(box.contains(vec3(1.0f, 2.0f, 3.0f - range * 0.5f)));
+    VERIFY(!box.contains(vec3(1.0f, 2.0f, 3.0f + range * 0.5f)));
+
+    // scale on the transform doesn't change the direction
+    trans = mat4(vec4(2.0f, 0.0f, 0.0f, 0.0f), vec4(0.0f, 2.0f, 0.0f, 0.0f), vec4(0.0f, 0.0f, 5.0f, 0.0f), vec4(1.0f, 2.0f, 3.0f, 1.0f));
+    box = Lighting::LightContext::SpotLightBounds(trans, angle, range);
+    VERIFY(nearequal(xyz(box.pmin), vec3(1.0f - capRadius, 2.0f - capRadius, 3.0f - range), 0.001f));
+    VERIFY(nearequal(xyz(box.pmax), vec3(1.0f + capRadius, 2.0f + capRadius, 3.0f), 0.001f));
+
+    // z axis along +x, the cone points along -x
+    trans = mat4(vec4(0.0f, 0.0f, -1.0f, 0.0f), vec4(0.0f, 1.0f, 0.0f, 0.0f), vec4(1.0f, 0.0f, 0.0f, 0.0f), vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    box = Lighting::LightContext::SpotLightBounds(trans, angle, range);
+    VERIFY(nearequal(xyz(box.pmin), vec3(-range, -capRadius, -capRadius), 0.001f));
+    VERIFY(nearequal(xyz(box.pmax), vec3(0.0f, capRadius, capRadius), 0.001f));
+    VERIFY(box.contains(vec3(-range * 0.5f, 0.0f, 0.0f)));
+    VERIFY(!box.contains(vec3(range * 0.5f, 0.0f, 0.0f)));
+
+    // cones of 90 degrees and wider are bound by the range
+    box = Lighting::LightContext::SpotLightBounds(translation(1.0f, 2.0f, 3.0f), N_PI * 0.5f, range);
+    VERIFY(nearequal(xyz(box.pmin), vec3(1.0f - range, 2.0f - range, 3.0f - range), 0.001f));
+    VERIFY(nearequal(xyz(box.pmax), vec3(1.0f + range, 2.0f + range, 3.0f + range), 0.001f));
+}
+
+} // namespace Test
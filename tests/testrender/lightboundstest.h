@@ -0,0 +1,22 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    Test for the bounds used to cull local lights
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "testbase/testcase.h"
+namespace Test
+{
+
+class LightBoundsTest : public TestCase
+{
+    __DeclareClass(LightBoundsTest);
+public:
+    /// run test
+    virtual void Run();
+};
+
+} // namespace Test
@@ -7,7 +7,10 @@
 #include "core/coreserver.h"
 #include "testbase/testrunner.h"
 #include "animtest.h"
+#include "instancerangetest.h"
+#include "lightboundstest.h"
 #include "rendertest.h"
+#include "terrainheightquerytest.h"
 
 using namespace Core;
 using namespace Test;
@@ -28,7 +31,10 @@ NebulaMain(const Util::CommandLineArgs& args)
     // setup and run test runner
     Ptr<TestRunner> testRunner = TestRunner::Create();
     testRunner->AttachTestCase(AnimTest::Create());
+    testRunner->AttachTestCase(InstanceRangeTest::Create());
+    testRunner->AttachTestCase(LightBoundsTest::Create());
     testRunner->AttachTestCase(RenderTest::Create());
+    testRunner->AttachTestCase(TerrainHeightQueryTest::Create());
     testRunner->Run();
     //testRunner->AttachTestCase(BXmlReaderTest::Create());
 
@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------
+//  @file terrainheightquerytest.cc
+//  @copyright (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "terrain/terrainheightquery.h"
+#include "terrainheightquerytest.h"
+namespace Test
+{
+
+__ImplementClass(TerrainHeightQueryTest, 'THQT', Test::TestCase);
+
+using namespace Terrain;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static bool
+Near(float a, float b, float eps = 0.01f)
+{
+    return Math::abs(a - b) <= eps;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TerrainHeightQueryTest::Run()
+{
+    // a ramp along x, 65 x 50 samples one unit apart, sample i along x is at x = i - 32 and has the height i
+    const SizeT width = 65, height = 50;
+    Util::FixedArray<uint16_t> ramp(width * height);
+    for (IndexT z = 0; z < height; z++)
+        for (IndexT x = 0; x < width; x++)
+            ramp[z * width + x] = uint16_t(x * 1000);
+
+    TerrainHeightQuery query;
+    float h;
+    Math::vector normal;
+    VERIFY(!query.IsReady());
+    VERIFY(!query.GetHeight(0.0f, 0.0f, h));
+
+    query.Setup(ramp.Begin(), width, height, 0.0f, 65.535f, 65.0f, 50.0f);
+    VERIFY(query.IsReady());
+
+    // heights are interpolated between the samples
+    VERIFY(query.GetHeight(0.0f, 0.0f, h, normal));
+    VERIFY(Near(h, 32.0f));
+    VERIFY(Near(normal.x, -0.7071f) && Near(normal.y, 0.7071f) && Near(normal.z, 0.0f));
+    VERIFY(query.GetHeight(10.25f, -3.0f, h));
+    VERIFY(Near(h, 42.25f));
+    VERIFY(query.GetHeight(-31.5f, 24.0f, h));
+    VERIFY(Near(h, 0.5f));
+
+    // between the last sample center and the edge the height is clamped, outside there is none
+    VERIFY(query.GetHeight(32.4f, 0.0f, h));
+    VERIFY(Near(h, 64.0f));
+    VERIFY(!query.GetHeight(33.0f, 0.0f, h));
+    VERIFY(!query.GetHeight(0.0f, -26.0f, h));
+
+    // straight down
+    TerrainRay ray;
+    TerrainRayHit hit;
+    ray.origin = Math::point(5.0f, 100.0f, 7.0f);
+    ray.direction = Math::vector(0.0f, -1.0f, 0.0f);
+    VERIFY(query.Raycast(ray, hit));
+    VERIFY(hit.hit);
+    VERIFY(Near(hit.position.y, 37.0f));
+    VERIFY(Near(hit.distance, 63.0f));
+    VERIFY(Near(hit.normal.x, -0.7071f) && Near(hit.normal.y, 0.7071f));
+
+    // rays see the clamped edge too
+    ray.origin = Math::point(32.4f, 100.0f, -24.8f);
+    VERIFY(query.Raycast(ray, hit));
+    VERIFY(Near(hit.position.y, 64.0f));
+    ray.origin = Math::point(32.6f, 100.0f, 0.0f);
+    VERIFY(!query.Raycast(ray, hit));
+    ray.origin = Math::point(5.0f, 100.0f, 7.0f);
+
+    // too short to reach the ground
+    ray.maxDistance = 50.0f;
+    VERIFY(!query.Raycast(ray, hit));
+    VERIFY(!hit.hit);
+    ray.maxDistance = 1000.0f;
+
+    // level with the ground, the ramp rises into the ray at x = -22
+    ray.origin = Math::point(-30.0f, 10.0f, 0.0f);
+    ray.direction = Math::vector(1.0f, 0.0f, 0.0f);
+    VERIFY(query.Raycast(ray, hit));
+    VERIFY(Near(hit.position.x, -22.0f));
+    VERIFY(Near(hit.distance, 8.0f));
+
+    // diagonal, crosses a tile border before it hits where the ground at x + 32 meets the ray at 28 - x
+    ray.origin = Math::point(-12.0f, 40.0f, -20.0f);
+    ray.direction = Math::vector(1.0f, -1.0f, 1.0f);
+    VERIFY(query.Raycast(ray, hit));
+    const float t = 20.0f / (1.0f / Math::sqrt(3.0f) + 1.0f / Math::sqrt(3.0f));
+    VERIFY(Near(hit.distance, t));
+    VERIFY(query.GetHeight(hit.position.x, hit.position.z, h));
+    VERIFY(Near(h, hit.position.y));
+
+    // away from the terrain and down the slope above it
+    ray.origin = Math::point(0.0f, 100.0f, 0.0f);
+    ray.direction = Math::vector(0.0f, 1.0f, 0.0f);
+    VERIFY(!query.Raycast(ray, hit));
+    ray.direction = Math::vector(-1.0f, 0.0f, 0.0f);
+    VERIFY(!query.Raycast(ray, hit));
+
+    // the batch functions match the single ones, positions outside get the lowest height
+    const SizeT numPositions = TerrainHeightQuery::BatchSize * 2 + 10;
+    Util::FixedArray<Math::vec2> positions(numPositions);
+    Util::FixedArray<float> heights(numPositions);
+    for (IndexT i = 0; i < numPositions; i++)
+        positions[i] = Math::vec2(-40.0f + i * 0.15f, (i % 50) - 24.5f);
+    query.GetHeights(positions.Begin(), heights.Begin(), numPositions);
+    bool heightsMatch = true;
+    for (IndexT i = 0; i < numPositions; i++)
+    {
+        if (!query.GetHeight(positions[i].x, positions[i].y, h))
+            h = 0.0f;
+        heightsMatch &= heights[i] == h;
+    }
+    VERIFY(heightsMatch);
+
+    Util::FixedArray<TerrainRay> rays(numPositions);
+    Util::FixedArray<TerrainRayHit> hits(numPositions);
+    for (IndexT i = 0; i < numPositions; i++)
+    {
+        rays[i].origin = Math::point(positions[i].x, 80.0f, positions[i].y);
+        rays[i].direction = Math::vector(0.0f, -1.0f, 0.0f);
+    }
+    query.Raycast(rays.Begin(), hits.Begin(), numPositions);
+    bool raysMatch = true;
+    for (IndexT i = 0; i < numPositions; i++)
+    {
+        const bool inside = query.GetHeight(positions[i].x, positions[i].y, h);
+        raysMatch &= hits[i].hit == inside;
+        if (inside)
+            raysMatch &= Near(hits[i].position.y, h);
+    }
+    VERIFY(raysMatch);
+
+    // flat ground with small bumps is stored in 8 bits
+    Util::FixedArray<uint16_t> flat(width * height);
+    for (IndexT i = 0; i < flat.Size(); i++)
+        flat[i] = uint16_t(30000 + (i % 7) * 10);
+    query.Setup(flat.Begin(), width, height, -100.0f, 100.0f, 130.0f, 100.0f);
+    ray.origin = Math::point(0.0f, 50.0f, 0.0f);
+    ray.direction = Math::vector(0.0f, -1.0f, 0.0f);
+    VERIFY(query.Raycast(ray, hit));
+    VERIFY(query.GetHeight(0.0f, 0.0f, h));
+    VERIFY(Near(hit.position.y, h));
+    VERIFY(h > -8.5f && h < -8.2f);
+
+    query.Discard();
+    VERIFY(!query.IsReady());
+    VERIFY(!query.Raycast(ray, hit));
+}
+
+} // namespace Test
@@ -0,0 +1,22 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    Test for the CPU terrain height and ray queries
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "testbase/testcase.h"
+namespace Test
+{
+
+class TerrainHeightQueryTest : public TestCase
+{
+    __DeclareClass(TerrainHeightQueryTest);
+public:
+    /// run test
+    virtual void Run();
+};
+
+} // namespace Test
@@ -28,6 +28,7 @@
 #include "renderutil/mayacamerautil.h"
 #include "debug/debuginterface.h"
 #include "profiling/profiling.h"
+#include "jobs2/jobs2.h"
 
 #include "dynui/imguicontext.h"
 #include "imgui.h"
@@ -69,6 +70,13 @@ VisibilityTest::Run()
     inputServer->Open();
     gfxServer->Open();
 
+    // visibility and model updates run as jobs and allocate from the frame allocator
+    Jobs2::JobSystemInitInfo jobSystemInfo;
+    jobSystemInfo.numThreads = 8;
+    jobSystemInfo.name = "JobSystem";
+    jobSystemInfo.scratchMemorySize = 8_MB;
+    Jobs2::JobSystemInit(jobSystemInfo);
+
     CoreGraphics::WindowCreateInfo wndInfo =
     {
         CoreGraphics::DisplayMode{ 100, 100, 1024, 768 },
@@ -184,6 +192,7 @@ VisibilityTest::Run()
         timer.Reset();
         timer.Start();
 
+        Jobs2::JobNewFrame();
         resMgr->Update(frameIndex);
         CameraContext::SetView(cam, Math::inverse(mayaCamera.GetCameraTransform()));
 
@@ -267,6 +276,7 @@ VisibilityTest::Run()
     gfxServer->DiscardView(view);
 
     gfxServer->Close();
+    Jobs2::JobSystemUninit();
     inputServer->Close();
     resMgr->Close();
     app.Close();
@@ -17,6 +17,7 @@
 #include "flat/physics/material.h"
 #include "jobs2/jobs2.h"
 #include "system/nebulasettings.h"
+#include "system/systeminfo.h"
 #include "toolkit-common/text.h"
 
 #ifdef WIN32
@@ -161,9 +162,12 @@ AssetBatcherApp::DoWork()
     ExporterBase::ExportFlag exportFlag = ExporterBase::All;
     Dictionary<String, String> sources;
 
+    // in parallel mode, the exporter runs independent assets on the job threads, so use all cores
+    bool parallel = this->args.GetBoolFlag("-parallel");
+
     Jobs2::JobSystemInitInfo systemInit;
     systemInit.name = "JobSystem";
-    systemInit.numThreads = 8;
+    systemInit.numThreads = parallel ? System::NumCpuCores : 8;
     systemInit.scratchMemorySize = 16_MB;
     systemInit.affinity = System::Cpu::All;
     systemInit.enableIo = true;
@@ -238,6 +242,7 @@ AssetBatcherApp::DoWork()
         if (modeFlags.Find("physics")) mode |= AssetExporter::Physics;
         if (modeFlags.Find("gltf")) mode |= AssetExporter::GLTF;
         if (modeFlags.Find("audio")) mode |= AssetExporter::Audio;
+        if (modeFlags.Find("vegetation")) mode |= AssetExporter::Vegetation;
     }
 
     AssignRegistry::Instance()->SetAssign(Assign("home","proj:"));
@@ -263,6 +268,7 @@ AssetBatcherApp::DoWork()
     exporter->SetExportMode(mode);
     exporter->SetForce(force);
     exporter->SetLogger(&this->logger);
+    exporter->SetParallel(parallel);
     if (force)
     {
         exporter->SetExportMode(AssetExporter::All | AssetExporter::ForceFBX | AssetExporter::ForceModels | AssetExporter::ForceSurfaces | AssetExporter::ForceParticles | AssetExporter::ForceGLTF | AssetExporter::ForceAudio);
@@ -382,8 +388,9 @@ AssetBatcherApp::ShowHelp()
              "-asset       -- asset name, implies source argument\n"
              "-source      -- select asset source from projectinfo, default all\n"
              "-work        -- batch a non-registered work folder into the project\n"
-             "-mode        -- batch only a type of resource, can be: fbx, model, surface, texture, physics, gltf, audio\n"
+             "-mode        -- batch only a type of resource, can be: fbx, model, surface, texture, physics, gltf, audio, vegetation\n"
              "-rawlog      -- log text is output without ASCII colors or text style\n" 
+             "-parallel    -- export independent assets concurrently on all cores\n"
              "-project     -- projectinfo override\n"
     );
 
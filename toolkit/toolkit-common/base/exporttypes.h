@@ -27,7 +27,9 @@ enum ExportFlags
     ImportSecondaryUVs = 1 << 4,
     CalcTangents = 1 << 5,
     CalcRigidSkin = 1 << 6,
-    All = (1 << 7) - 1,
+    OptimizeMesh = 1 << 7,
+    GenerateMeshlets = 1 << 8,
+    All = (1 << 9) - 1,
 
     NumMeshFlags
 };
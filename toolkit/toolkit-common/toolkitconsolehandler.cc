@@ -103,12 +103,14 @@ ToolkitConsoleHandler::DebugOut(const String& s)
 void
 ToolkitConsoleHandler::Clear()
 {
+    this->cs.Enter();
     Threading::ThreadId id = Threading::Thread::GetMyThreadId();
     if (this->log.Contains(id))
     {
         this->currentFlags[id] = 0;
         this->log[id].Clear();
     }   
+    this->cs.Leave();
 }
 
 //------------------------------------------------------------------------------
@@ -155,6 +157,30 @@ ToolkitConsoleHandler::GetLog()
     return this->log[Threading::Thread::GetMyThreadId()];
 }
 
+//------------------------------------------------------------------------------
+/**
+    Other threads may add their log while we copy ours, so this has to be done under 
+    the lock. Threads which haven't logged anything yet get an empty entry.
+*/
+ToolLogEntry
+ToolkitConsoleHandler::GetEntry(const Util::String& tool, const Util::String& source)
+{
+    ToolLogEntry entry;
+    entry.tool = tool;
+    entry.source = source;
+    entry.logLevels = 0;
+    this->cs.Enter();
+    Threading::ThreadId id = Threading::Thread::GetMyThreadId();
+    IndexT index = this->log.FindIndex(id);
+    if (index != InvalidIndex)
+    {
+        entry.logs = this->log.ValueAtIndex(index);
+        entry.logLevels = this->currentFlags[id];
+    }
+    this->cs.Leave();
+    return entry;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
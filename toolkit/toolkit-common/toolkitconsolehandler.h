@@ -19,6 +19,7 @@
 //------------------------------------------------------------------------------
 namespace ToolkitUtil
 {
+struct ToolLogEntry;
 class ToolkitConsoleHandler : public IO::ConsoleHandler
 {
     __DeclareClass(ToolkitConsoleHandler);
@@ -67,6 +68,8 @@ public:
     const Util::Array<LogEntry> & GetLog();
     /// what kinds of messages occurred since last clear
     unsigned char GetLevels() const;
+    /// copy the log of the calling thread into a tool log entry, safe to call from any thread
+    ToolLogEntry GetEntry(const Util::String& tool, const Util::String& source);
 
 private:    
     ///
@@ -103,8 +106,9 @@ struct ToolLog
 inline void
 ToolkitUtil::ToolLog::AddEntry(const Ptr<ToolkitUtil::ToolkitConsoleHandler> & console, const Util::String & tool, const Util::String & source)
 {
-    this->logLevels |= console->GetLevels();
-    this->logs.Append({ tool, source, console->GetLevels(), console->GetLog() });
+    ToolLogEntry entry = console->GetEntry(tool, source);
+    this->logLevels |= entry.logLevels;
+    this->logs.Append(entry);
 }
 
 ///------------------------------------------------------------------------------
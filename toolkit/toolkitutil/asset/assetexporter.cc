@@ -10,6 +10,9 @@
 #include "nflatbuffer/flatbufferinterface.h"
 #include "toolkit-common/text.h"
 #include "io/jsonreader.h"
+#include "jobs2/jobs2.h"
+#include "timing/timer.h"
+#include "toolkitutil/vegetation/vegetationbaker.h"
 
 using namespace Util;
 using namespace IO;
@@ -17,11 +20,176 @@ namespace ToolkitUtil
 {
 __ImplementClass(ToolkitUtil::AssetExporter, 'ASEX', Core::RefCounted);
 
+namespace
+{
+
+//------------------------------------------------------------------------------
+/**
+    Logger which records messages instead of printing them, so that the output 
+    of exports running on job threads can be replayed in a deterministic order.
+*/
+class BufferedLogger : public Logger
+{
+public:
+    enum LogLevel
+    {
+        LevelInfo,
+        LevelWarning,
+        LevelError
+    };
+
+    struct Entry
+    {
+        LogLevel level;
+        Util::String message;
+    };
+
+    /// constructor
+    BufferedLogger();
+
+    /// record a formatted error message
+    void Error(const char* msg, ...) override;
+    /// record a formatted warning message
+    void Warning(const char* msg, ...) override;
+    /// record a formatted message
+    void Print(const char* msg, ...) override;
+
+    /// output all recorded messages to another logger
+    void Replay(Logger* logger) const;
+
+private:
+    Util::Array<Entry> entries;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+BufferedLogger::BufferedLogger()
+{
+    this->verbose = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BufferedLogger::Error(const char* msg, ...)
+{
+    va_list argList;
+    va_start(argList, msg);
+    Entry entry{ LevelError };
+    entry.message.FormatArgList(msg, argList);
+    this->entries.Append(entry);
+    va_end(argList);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BufferedLogger::Warning(const char* msg, ...)
+{
+    va_list argList;
+    va_start(argList, msg);
+    Entry entry{ LevelWarning };
+    entry.message.FormatArgList(msg, argList);
+    this->entries.Append(entry);
+    va_end(argList);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BufferedLogger::Print(const char* msg, ...)
+{
+    va_list argList;
+    va_start(argList, msg);
+    Entry entry{ LevelInfo };
+    entry.message.FormatArgList(msg, argList);
+    this->entries.Append(entry);
+    va_end(argList);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BufferedLogger::Replay(Logger* logger) const
+{
+    for (const Entry& entry : this->entries)
+    {
+        switch (entry.level)
+        {
+            case LevelInfo:     logger->Print("%s", entry.message.AsCharPtr()); break;
+            case LevelWarning:  logger->Warning("%s", entry.message.AsCharPtr()); break;
+            case LevelError:    logger->Error("%s", entry.message.AsCharPtr()); break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Describes how a single asset type is scheduled in parallel mode.
+*/
+struct ExportStage
+{
+    enum Affinity
+    {
+        Exclusive,          // uses the job system itself, has to finish before anything else is dispatched
+        CallingThread,      // relies on thread local singletons such as the model database
+        Jobs                // safe to run on job threads using a worker exporter
+    };
+
+    unsigned int mode;
+    const char* title;
+    const char* tool;
+    Affinity affinity;
+    unsigned int dependencies;
+};
+
+const ExportStage Stages[] =
+{
+    { AssetExporter::GLTF,        "GLTFs",       "GLTF",        ExportStage::Exclusive,     0 },
+    { AssetExporter::FBX,         "FBXs",        "FBX",         ExportStage::CallingThread, 0 },
+    { AssetExporter::Models,      "Models",      "Model",       ExportStage::CallingThread, AssetExporter::GLTF | AssetExporter::FBX },
+    { AssetExporter::Physics,     "Physics",     "Physics",     ExportStage::CallingThread, 0 },
+    { AssetExporter::Textures,    "Textures",    "Texture",     ExportStage::Jobs,          0 },
+    { AssetExporter::Surfaces,    "Surfaces",    "Surface",     ExportStage::Jobs,          AssetExporter::Textures },
+    { AssetExporter::Particles,   "Particles",   "Particle",    ExportStage::Jobs,          0 },
+    { AssetExporter::Audio,       "Audio",       "Audio",       ExportStage::Jobs,          0 },
+    { AssetExporter::Vegetation,  "Vegetation",  "Vegetation",  ExportStage::Jobs,          AssetExporter::Textures },
+};
+const SizeT NumStages = sizeof(Stages) / sizeof(ExportStage);
+
+struct ExportTask
+{
+    Util::String file;
+    Util::String source;
+    BufferedLogger log;
+    ToolLogEntry entry;
+    Timing::Time begin;
+    Timing::Time end;
+};
+
+struct ExportStageState
+{
+    Util::FixedArray<ExportTask> tasks;
+    Threading::AtomicCounter doneCounter = 0;
+    Threading::AtomicCounter numCompleted = 0;
+    Threading::Event finishedEvent;
+    SizeT numReported = 0;
+};
+
+} // namespace
+
 //------------------------------------------------------------------------------
 /**
 */
 AssetExporter::AssetExporter() :
-    mode(All)
+    mode(All),
+    parallel(false),
+    textureTempDir("temp:textureconverter")
 {
     // empty
 }
@@ -55,6 +223,13 @@ AssetExporter::Open()
 void
 AssetExporter::Close()
 {
+    for (const Ptr<AssetExporter>& worker : this->workers)
+    {
+        worker->Close();
+    }
+    this->workers.Clear();
+    this->freeWorkers.Clear();
+
     this->surfaceExporter->Close();
     this->surfaceExporter = nullptr;
     this->particleExporter->Close();
@@ -77,6 +252,11 @@ AssetExporter::UpdateSource()
         this->textureAttrTable.Discard();
     this->textureAttrTable.Setup("src:assets/");
     this->textureExporter.SetTextureAttrTable(std::move(this->textureAttrTable));
+    for (const Ptr<AssetExporter>& worker : this->workers)
+    {
+        TextureAttrTable table = this->textureAttrTable;
+        worker->textureExporter.SetTextureAttrTable(std::move(table));
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -159,9 +339,9 @@ AssetExporter::ExportFile(const IO::URI& file)
         Util::String dstFile = Util::String::Sprintf("%s/%s", dstDir.AsCharPtr(), fileName.AsCharPtr());
         dstFile.StripFileExtension();
         if (ext == "cube")
-            this->textureExporter.ConvertCubemap(file.AsString(), dstFile, "temp:textureconverter");
+            this->textureExporter.ConvertCubemap(file.AsString(), dstFile, this->textureTempDir);
         else
-            this->textureExporter.ConvertTexture(file.AsString(), dstFile, "temp:textureconverter");
+            this->textureExporter.ConvertTexture(file.AsString(), dstFile, this->textureTempDir);
     }
     else if ((this->mode & ExportModes::Surfaces) && ext == "sur")
     {
@@ -210,6 +390,30 @@ AssetExporter::ExportFile(const IO::URI& file)
             this->logger->Print("Skipping %s\n", Text(file.AsString()).Color(TextColor::Blue).AsCharPtr());
         }
     }
+    else if ((this->mode & ExportModes::Vegetation) && ext == "veg")
+    {
+        String bakeName = fileName;
+        bakeName.StripFileExtension();
+        Util::String dstDir = Util::String::Sprintf("dst:vegetation/%s/%s", category.AsCharPtr(), bakeName.AsCharPtr());
+        Util::String firstTile = Util::String::Sprintf("%s/tile_0_0.vegt", dstDir.AsCharPtr());
+        if (this->force || (this->mode & ExportModes::ForceVegetation) || NeedsConversion(file.AsString(), firstTile))
+        {
+            this->logger->Print(
+                "%s -> %s\n",
+                Text(file.LocalPath()).Color(TextColor::Blue).AsCharPtr(),
+                Text(URI(dstDir).LocalPath()).Color(TextColor::Green).AsCharPtr()
+            );
+            ToolkitUtil::VegetationBaker baker;
+            baker.SetLogger(this->logger);
+            baker.SetDstDir(dstDir);
+            if (!baker.ReadDescription(file) || !baker.Bake())
+                this->SetHasErrors(true);
+        }
+        else
+        {
+            this->logger->Print("Skipping %s\n", Text(file.AsString()).Color(TextColor::Blue).AsCharPtr());
+        }
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -228,6 +432,12 @@ AssetExporter::ExportDir(const Util::String& category)
 void
 AssetExporter::ExportFolder(const Util::String& assetPath, const Util::String& category)
 {
+    if (this->parallel && Jobs2::ctx.threads.Size() > 0)
+    {
+        this->ExportFolderParallel(assetPath, category);
+        return;
+    }
+
     n_printf("\n----------------- Exporting asset directory %s -----------------\n", Text(URI(assetPath).LocalPath()).Color(TextColor::Blue).Style(FontMode::Bold).AsCharPtr());
     IoServer* ioServer = IoServer::Instance();
 
@@ -405,10 +615,365 @@ AssetExporter::ExportFolder(const Util::String& assetPath, const Util::String& c
             }
         }
     }
+    if (this->mode & ExportModes::Vegetation)
+    {
+        this->logger->Print("\nVegetation ----------\n");
+        Array<String> files = ioServer->ListFiles(assetPath, "*.veg");
+        if (files.IsEmpty())
+        {
+            this->logger->Print("Nothing to export\n");
+        }
+        else
+        {
+            for (fileIndex = 0; fileIndex < files.Size(); fileIndex++)
+            {
+                console->Clear();
+                this->ExportFile(assetPath + files[fileIndex]);
+                log.AddEntry(console, "Vegetation", files[fileIndex]);
+            }
+        }
+    }
     this->messages.Append(log);
     this->category = "";
 }
 
+//------------------------------------------------------------------------------
+/**
+    Exports a folder as a dependency graph over the asset types in Stages. Exclusive 
+    stages run first, then all jobified stages are dispatched with wait counters for 
+    their dependencies, while the calling thread works through its own stages.
+    Finally the buffered logs of the jobified exports are replayed in stage and file 
+    order, followed by a timing report per asset type.
+*/
+void
+AssetExporter::ExportFolderParallel(const Util::String& assetPath, const Util::String& category)
+{
+    n_printf("\n----------------- Exporting asset directory %s -----------------\n", Text(URI(assetPath).LocalPath()).Color(TextColor::Blue).Style(FontMode::Bold).AsCharPtr());
+    
+    ToolLog log(category);
+    Ptr<ToolkitUtil::ToolkitConsoleHandler> console = ToolkitUtil::ToolkitConsoleHandler::Instance();
+    this->category = category;
+    this->SetupWorkers();
+    for (const Ptr<AssetExporter>& worker : this->workers)
+    {
+        worker->SetCategory(category);
+        worker->SetForce(this->force);
+        worker->SetExportMode(this->mode);
+        worker->SetExportFlag(this->exportFlag);
+        worker->SetPlatform(this->platform);
+    }
+
+    ExportStageState states[NumStages];
+    Timing::Timer clock;
+    clock.Start();
+
+    // run a stage on the calling thread, logging directly to our logger
+    auto runLocal = [&](IndexT stageIndex)
+    {
+        const ExportStage& stage = Stages[stageIndex];
+        ExportStageState& state = states[stageIndex];
+        this->logger->Print("\n%s ------------\n", stage.title);
+        if (state.tasks.IsEmpty())
+        {
+            this->logger->Print("Nothing to export\n");
+        }
+        for (ExportTask& task : state.tasks)
+        {
+            task.begin = clock.GetTime();
+            console->Clear();
+            this->ExportFile(task.file);
+            task.entry = console->GetEntry(stage.tool, task.source);
+            task.end = clock.GetTime();
+        }
+    };
+
+    // exclusive stages first, since they dispatch jobs of their own and reset the job scratch memory
+    IndexT stageIndex;
+    for (stageIndex = 0; stageIndex < NumStages; stageIndex++)
+    {
+        const ExportStage& stage = Stages[stageIndex];
+        if ((this->mode & stage.mode) && stage.affinity == ExportStage::Exclusive)
+        {
+            Util::Array<Util::String> files = this->ListSourceFiles(assetPath, stage.mode);
+            states[stageIndex].tasks.Resize(files.Size());
+            for (IndexT i = 0; i < files.Size(); i++)
+            {
+                states[stageIndex].tasks[i].file = assetPath + files[i];
+                states[stageIndex].tasks[i].source = files[i];
+            }
+            runLocal(stageIndex);
+        }
+    }
+
+    // dispatch jobified stages, these start converting while we work on the calling thread stages
+    for (stageIndex = 0; stageIndex < NumStages; stageIndex++)
+    {
+        const ExportStage& stage = Stages[stageIndex];
+        ExportStageState& state = states[stageIndex];
+        if (!(this->mode & stage.mode) || stage.affinity != ExportStage::Jobs)
+            continue;
+
+        Util::Array<Util::String> files = this->ListSourceFiles(assetPath, stage.mode);
+        if (files.IsEmpty())
+            continue;
+        state.tasks.Resize(files.Size());
+        for (IndexT i = 0; i < files.Size(); i++)
+        {
+            state.tasks[i].file = assetPath + files[i];
+            state.tasks[i].source = files[i];
+        }
+
+        Util::Array<const Threading::AtomicCounter*> waitCounters;
+        for (IndexT dependency = 0; dependency < NumStages; dependency++)
+        {
+            if ((stage.dependencies & Stages[dependency].mode) && !states[dependency].tasks.IsEmpty())
+            {
+                // jobified stages can only wait for other jobs, or exclusive stages which are already done
+                n_assert(Stages[dependency].affinity != ExportStage::CallingThread);
+                if (Stages[dependency].affinity == ExportStage::Jobs)
+                    waitCounters.Append(&states[dependency].doneCounter);
+            }
+        }
+
+        state.doneCounter = 1;
+        Jobs2::JobDispatch(
+            [
+                self = this
+                , state = &state
+                , tool = stage.tool
+                , clock = &clock
+            ]
+        (SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+        {
+            Ptr<ToolkitUtil::ToolkitConsoleHandler> console = ToolkitUtil::ToolkitConsoleHandler::Instance();
+            AssetExporter* worker = self->AcquireWorker();
+            for (IndexT i = 0; i < groupSize; i++)
+            {
+                IndexT index = i + invocationOffset;
+                if (index >= totalJobs)
+                    break;
+
+                ExportTask& task = state->tasks[index];
+                task.begin = clock->GetTime();
+                console->Clear();
+                worker->SetLogger(&task.log);
+                worker->ExportFile(task.file);
+                task.entry = console->GetEntry(tool, task.source);
+                task.end = clock->GetTime();
+                Threading::Interlocked::Increment(&state->numCompleted);
+            }
+            self->ReleaseWorker(worker);
+        }, state.tasks.Size(), 1, waitCounters, &state.doneCounter, &state.finishedEvent);
+    }
+
+    // calling thread stages, ordered such that their dependencies have been exported before
+    for (stageIndex = 0; stageIndex < NumStages; stageIndex++)
+    {
+        const ExportStage& stage = Stages[stageIndex];
+        if ((this->mode & stage.mode) && stage.affinity == ExportStage::CallingThread)
+        {
+            // list files first now, since the stages we depend on might have produced them
+            Util::Array<Util::String> files = this->ListSourceFiles(assetPath, stage.mode);
+            states[stageIndex].tasks.Resize(files.Size());
+            for (IndexT i = 0; i < files.Size(); i++)
+            {
+                states[stageIndex].tasks[i].file = assetPath + files[i];
+                states[stageIndex].tasks[i].source = files[i];
+            }
+            runLocal(stageIndex);
+        }
+    }
+
+    // wait for jobs, reporting progress while we do
+    for (stageIndex = 0; stageIndex < NumStages; stageIndex++)
+    {
+        if (Stages[stageIndex].affinity != ExportStage::Jobs || states[stageIndex].tasks.IsEmpty())
+            continue;
+        while (!states[stageIndex].finishedEvent.WaitTimeout(500))
+        {
+            for (IndexT i = 0; i < NumStages; i++)
+            {
+                ExportStageState& state = states[i];
+                if (state.numCompleted != state.numReported && state.numCompleted != state.tasks.Size())
+                {
+                    state.numReported = state.numCompleted;
+                    n_printf("[%s %d/%d]\n", Stages[i].title, state.numReported, state.tasks.Size());
+                }
+            }
+        }
+    }
+    clock.Stop();
+
+    // the job scratch memory isn't needed anymore once all exports are done
+    Jobs2::JobNewFrame();
+
+    // replay logs of jobified stages in a fixed order
+    for (stageIndex = 0; stageIndex < NumStages; stageIndex++)
+    {
+        const ExportStage& stage = Stages[stageIndex];
+        if (!(this->mode & stage.mode) || stage.affinity != ExportStage::Jobs)
+            continue;
+        this->logger->Print("\n%s ------------\n", stage.title);
+        if (states[stageIndex].tasks.IsEmpty())
+        {
+            this->logger->Print("Nothing to export\n");
+        }
+        for (const ExportTask& task : states[stageIndex].tasks)
+        {
+            task.log.Replay(this->logger);
+        }
+    }
+
+    // collect tool logs and report timings per asset type
+    this->logger->Print("\nTimings -------------\n");
+    for (stageIndex = 0; stageIndex < NumStages; stageIndex++)
+    {
+        const ExportStage& stage = Stages[stageIndex];
+        const ExportStageState& state = states[stageIndex];
+        if (state.tasks.IsEmpty())
+            continue;
+
+        Timing::Time begin = state.tasks[0].begin;
+        Timing::Time end = state.tasks[0].end;
+        Timing::Time total = 0;
+        IndexT slowest = 0;
+        IndexT i;
+        for (i = 0; i < state.tasks.Size(); i++)
+        {
+            const ExportTask& task = state.tasks[i];
+            log.logs.Append(task.entry);
+            log.logLevels |= task.entry.logLevels;
+
+            begin = Math::min(begin, task.begin);
+            end = Math::max(end, task.end);
+            total += task.end - task.begin;
+            if (task.end - task.begin > state.tasks[slowest].end - state.tasks[slowest].begin)
+                slowest = i;
+        }
+        this->logger->Print("%-10s %5d files, %8.3fs wall, %8.3fs total, slowest %s (%.3fs)\n",
+            stage.title,
+            state.tasks.Size(),
+            end - begin,
+            total,
+            state.tasks[slowest].source.AsCharPtr(),
+            state.tasks[slowest].end - state.tasks[slowest].begin
+        );
+    }
+    this->logger->Print("%-10s %8.3fs\n", "Folder", clock.GetTime());
+
+    for (const Ptr<AssetExporter>& worker : this->workers)
+    {
+        if (worker->HasErrors())
+            this->SetHasErrors(true);
+    }
+    this->messages.Append(log);
+    this->category = "";
+}
+
+//------------------------------------------------------------------------------
+/**
+    Matches the file listing of the serial path in ExportFolder.
+*/
+Util::Array<Util::String>
+AssetExporter::ListSourceFiles(const Util::String& assetPath, unsigned int type) const
+{
+    IoServer* ioServer = IoServer::Instance();
+    Array<String> files;
+    switch (type)
+    {
+        case ExportModes::GLTF:
+            files = ioServer->ListFiles(assetPath, "*.gltf");
+            files.AppendArray(ioServer->ListFiles(assetPath, "*.glb"));
+            break;
+        case ExportModes::FBX:
+            files = ioServer->ListFiles(assetPath, "*.fbx");
+            break;
+        case ExportModes::Models:
+            files = ioServer->ListFiles(assetPath, "*.attributes");
+            break;
+        case ExportModes::Textures:
+            files = ioServer->ListFiles(assetPath, "*.tga");
+            files.AppendArray(ioServer->ListFiles(assetPath, "*.bmp"));
+            files.AppendArray(ioServer->ListFiles(assetPath, "*.dds"));
+            files.AppendArray(ioServer->ListFiles(assetPath, "*.png"));
+            files.AppendArray(ioServer->ListFiles(assetPath, "*.jpg"));
+            files.AppendArray(ioServer->ListFiles(assetPath, "*.exr"));
+            files.AppendArray(ioServer->ListFiles(assetPath, "*.tif"));
+            files.AppendArray(ioServer->ListDirectories(assetPath, "*.cube"));
+            break;
+        case ExportModes::Surfaces:
+            files = ioServer->ListFiles(assetPath, "*.sur");
+            break;
+        case ExportModes::Particles:
+            files = ioServer->ListFiles(assetPath, "*.par");
+            break;
+        case ExportModes::Audio:
+            files = ioServer->ListFiles(assetPath, "*.wav");
+            files.AppendArray(ioServer->ListFiles(assetPath, "*.mp3"));
+            files.AppendArray(ioServer->ListFiles(assetPath, "*.ogg"));
+            break;
+        case ExportModes::Physics:
+            files = ioServer->ListFiles(assetPath, "*.actor", true);
+            break;
+        case ExportModes::Vegetation:
+            files = ioServer->ListFiles(assetPath, "*.veg");
+            break;
+        default:
+            n_error("AssetExporter::ListSourceFiles: Invalid export type %d\n", type);
+    }
+    return files;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Every job thread might run an export at the same time, so we need one worker 
+    per thread. Workers convert textures in their own temporary directories.
+*/
+void
+AssetExporter::SetupWorkers()
+{
+    if (!this->workers.IsEmpty())
+        return;
+
+    SizeT numWorkers = Jobs2::ctx.threads.Size();
+    IndexT i;
+    for (i = 0; i < numWorkers; i++)
+    {
+        Ptr<AssetExporter> worker = AssetExporter::Create();
+        worker->textureTempDir = String::Sprintf("temp:textureconverter/worker%d", i);
+        worker->Open();
+        TextureAttrTable table = this->textureAttrTable;
+        worker->textureExporter.SetTextureAttrTable(std::move(table));
+        this->workers.Append(worker);
+        this->freeWorkers.Append(worker);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+AssetExporter*
+AssetExporter::AcquireWorker()
+{
+    this->workerLock.Enter();
+    n_assert(!this->freeWorkers.IsEmpty());
+    AssetExporter* worker = this->freeWorkers.Back();
+    this->freeWorkers.EraseBack();
+    this->workerLock.Leave();
+    return worker;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AssetExporter::ReleaseWorker(AssetExporter* worker)
+{
+    this->workerLock.Enter();
+    this->freeWorkers.Append(worker);
+    this->workerLock.Leave();
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -6,6 +6,12 @@
     The asset exporter takes a single directory and exports any models, textures and gfx-sources.
 
     This isn't based on an exporter class, because it has no need for incremental batching.
+
+    In parallel mode, each directory is exported as a small dependency graph over asset types.
+    Exports relying on thread local singletons (FBX, models, physics) or on the job system 
+    itself (GLTF) run on the calling thread, while textures, surfaces, particles, audio 
+    and vegetation are dispatched to Jobs2 using a pool of worker exporters. The logs of jobified exports 
+    are buffered per asset and replayed in a fixed order once the directory is done.
     
     (C) 2015-2016 Individual contributors, see AUTHORS file
 */
@@ -20,6 +26,7 @@
 #include "toolkit-common/toolkitconsolehandler.h"
 #include "toolkitutil/model/import/gltf/ngltfexporter.h"
 #include "toolkitutil/particle/particleexporter.h"
+#include "threading/criticalsection.h"
 
 namespace ToolkitUtil
 {
@@ -38,7 +45,8 @@ public:
         GLTF = 1 << 5,                                                // checking this will cause GLTFs to get exported
         Physics = 1 << 6,                                             // checking this will cause physics to get exported
         Audio = 1 << 7,
-        All = FBX | Models | Textures | Surfaces | Particles | GLTF | Physics | Audio,    // shortcut for exporting everything
+        Vegetation = 1 << 16,                                         // checking this will cause vegetation descriptions to get baked
+        All = FBX | Models | Textures | Surfaces | Particles | GLTF | Physics | Audio | Vegetation,    // shortcut for exporting everything
 
         ForceFBX = 1 << 8,              // will force the FBX batcher to update meshes and characters despite time stamps
         ForceModels = 1 << 9,           // will force the model builder to create models despite time stamps
@@ -48,7 +56,8 @@ public:
         ForceGLTF = 1 << 13,            // will force the gltf exporter to convert meshes, textures and characters despite time stamps
         ForcePhysics = 1 << 14,         // will force the physics exporter to export physics assets despite time stamps
         ForceAudio = 1 << 15,
-        ForceAll = ForceFBX | ForceModels | ForceTextures | ForceSurfaces | ForceParticles | ForceGLTF | ForcePhysics | ForceAudio
+        ForceVegetation = 1 << 17,      // will force the vegetation baker to bake tiles despite time stamps
+        ForceAll = ForceFBX | ForceModels | ForceTextures | ForceSurfaces | ForceParticles | ForceGLTF | ForcePhysics | ForceAudio | ForceVegetation
     };
 
 
@@ -81,11 +90,24 @@ public:
 
     /// set export mode flag
     void SetExportMode(unsigned int mode);
+    /// enable exporting independent assets in parallel using the job system
+    void SetParallel(bool b);
     
     /// get failed files (if any)
     const Util::Array<ToolkitUtil::ToolLog> & GetMessages() const;
 
 private:
+    /// export a folder using the job system, see class description
+    void ExportFolderParallel(const Util::String& folder, const Util::String& category);
+    /// list all source files for a single export mode in folder
+    Util::Array<Util::String> ListSourceFiles(const Util::String& folder, unsigned int type) const;
+    /// create worker exporters, one per job thread
+    void SetupWorkers();
+    /// grab a free worker exporter, called from job threads
+    AssetExporter* AcquireWorker();
+    /// return worker exporter to pool
+    void ReleaseWorker(AssetExporter* worker);
+
     Ptr<ToolkitUtil::NFbxExporter> fbxExporter;
     Ptr<ToolkitUtil::NglTFExporter> gltfExporter;
     ToolkitUtil::TextureConverter textureExporter;
@@ -95,6 +117,12 @@ private:
     ToolkitUtil::TextureAttrTable textureAttrTable;
     unsigned int mode;
     Util::Array<ToolLog> messages;
+
+    bool parallel;
+    Util::String textureTempDir;
+    Util::Array<Ptr<AssetExporter>> workers;
+    Util::Array<AssetExporter*> freeWorkers;
+    Threading::CriticalSection workerLock;
 };
 
 __ImplementEnumBitOperators(AssetExporter::ExportModes);
@@ -107,4 +135,14 @@ AssetExporter::GetMessages() const
 {
     return this->messages;
 }
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+AssetExporter::SetParallel(bool b)
+{
+    this->parallel = b;
+}
+
 } // namespace ToolkitUtil
\ No newline at end of file
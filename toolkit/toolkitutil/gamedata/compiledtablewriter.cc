@@ -0,0 +1,354 @@
+//------------------------------------------------------------------------------
+//  compiledtablewriter.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "compiledtablewriter.h"
+#include "attr/compiledattributetable.h"
+#include "db/dataset.h"
+#include "io/ioserver.h"
+
+using namespace Util;
+
+namespace ToolkitUtil
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+static uint64_t
+Align16(uint64_t offset)
+{
+    return (offset + 15) & ~15ull;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+WritePadding(const Ptr<IO::Stream>& stream, uint64_t& offset)
+{
+    static const ubyte zeros[16] = { 0 };
+    const uint64_t aligned = Align16(offset);
+    if (aligned != offset)
+    {
+        stream->Write(zeros, (IO::Stream::Size)(aligned - offset));
+        offset = aligned;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+WriteSection(const Ptr<IO::Stream>& stream, const void* data, uint64_t size, uint64_t& offset)
+{
+    if (size > 0)
+    {
+        stream->Write(data, (IO::Stream::Size)size);
+        offset += size;
+    }
+    WritePadding(stream, offset);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+CompiledTableWriter::CompiledTableWriter() :
+    logger(nullptr)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+CompiledTableWriter::~CompiledTableWriter()
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint
+CompiledTableWriter::AddString(const String& str)
+{
+    IndexT index = this->stringIndices.FindIndex(str);
+    if (InvalidIndex != index)
+    {
+        return this->stringIndices.ValueAtIndex(str, index);
+    }
+
+    const uint stringIndex = (uint)this->stringOffsets.Size();
+    this->stringOffsets.Append((uint)this->stringData.Size());
+    this->stringData.AppendArray(str.AsCharPtr(), str.Length() + 1);
+    this->stringIndices.Add(str, stringIndex);
+    return stringIndex;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Key values are compared by their encoded bytes, which works for strings
+    too since equal strings share one dictionary index.
+*/
+bool
+CompiledTableWriter::BuildIndex(const Ptr<Attr::AttributeTable>& table, IndexT colIndex, const Array<IndexT>& rows, const FixedArray<ubyte>& values, FixedArray<uint>& outBuckets)
+{
+    const Attr::ValueType type = table->GetColumnValueType(colIndex);
+    const SizeT valueSize = Attr::CompiledAttributeTable::GetValueTypeSize(type);
+    const SizeT numRows = rows.Size();
+
+    SizeT numBuckets = 1;
+    while (numBuckets < numRows * 2)
+    {
+        numBuckets <<= 1;
+    }
+    outBuckets.Resize(numBuckets);
+    outBuckets.Fill(0);
+    const uint mask = (uint)numBuckets - 1;
+
+    IndexT i;
+    for (i = 0; i < numRows; i++)
+    {
+        const ubyte* value = values.Begin() + i * valueSize;
+        uint hash = 0;
+        switch (type)
+        {
+        case Attr::IntType:
+            hash = Attr::CompiledTableHash((uint64_t)*(const uint*)value);
+            break;
+        case Attr::UIntType:
+            hash = Attr::CompiledTableHash((uint64_t)*(const uint*)value);
+            break;
+        case Attr::Int64Type:
+            hash = Attr::CompiledTableHash(*(const uint64_t*)value);
+            break;
+        case Attr::StringType:
+            {
+                const char* str = this->stringData.Begin() + this->stringOffsets[*(const uint*)value];
+                hash = Attr::CompiledTableHash(str, (SizeT)strlen(str));
+            }
+            break;
+        case Attr::GuidType:
+            hash = Attr::CompiledTableHash(value, 16);
+            break;
+        default:
+            this->logger->Error("CompiledTableWriter: key column '%s' has to be Int, UInt, Int64, String or Guid\n", table->GetColumnName(colIndex).AsCharPtr());
+            return false;
+        }
+
+        uint bucket = hash & mask;
+        while (0 != outBuckets[bucket])
+        {
+            const IndexT other = outBuckets[bucket] - 1;
+            if (0 == memcmp(values.Begin() + other * valueSize, value, valueSize))
+            {
+                this->logger->Error("CompiledTableWriter: duplicate key '%s' in column '%s'\n",
+                    table->GetAttr(rows[i], colIndex).ValueAsString().AsCharPtr(), table->GetColumnName(colIndex).AsCharPtr());
+                return false;
+            }
+            bucket = (bucket + 1) & mask;
+        }
+        outBuckets[bucket] = i + 1;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+CompiledTableWriter::Write(const Ptr<Attr::AttributeTable>& table, const IO::URI& dst)
+{
+    n_assert(this->logger != nullptr);
+    n_assert(table.isvalid());
+
+    this->stringIndices.Clear();
+    this->stringOffsets.Clear();
+    this->stringData.Clear();
+    this->blobData.Clear();
+
+    Array<IndexT> rows;
+    IndexT rowIndex;
+    for (rowIndex = 0; rowIndex < table->GetNumRows(); rowIndex++)
+    {
+        if (!table->IsRowDeleted(rowIndex))
+        {
+            rows.Append(rowIndex);
+        }
+    }
+    const SizeT numRows = rows.Size();
+    const SizeT numColumns = table->GetNumColumns();
+
+    for (const Attr::AttrId& key : this->keyColumns)
+    {
+        if (!table->HasColumn(key))
+        {
+            this->logger->Error("CompiledTableWriter: key column '%s' is missing in '%s'\n", key.GetName().AsCharPtr(), dst.AsString().AsCharPtr());
+            return false;
+        }
+    }
+
+    // encode the columns
+    FixedArray<Attr::CompiledTableColumn> descs(numColumns);
+    FixedArray<FixedArray<ubyte>> values(numColumns);
+    FixedArray<FixedArray<uint>> buckets(numColumns);
+    IndexT colIndex;
+    for (colIndex = 0; colIndex < numColumns; colIndex++)
+    {
+        const Attr::ValueType type = table->GetColumnValueType(colIndex);
+        const SizeT valueSize = Attr::CompiledAttributeTable::GetValueTypeSize(type);
+        if (0 == valueSize)
+        {
+            this->logger->Error("CompiledTableWriter: column '%s' has unsupported type '%s'\n",
+                table->GetColumnName(colIndex).AsCharPtr(), Attr::Attribute::ValueTypeToString(type).AsCharPtr());
+            return false;
+        }
+
+        Attr::CompiledTableColumn& desc = descs[colIndex];
+        Memory::Clear(&desc, sizeof(desc));
+        desc.name = this->AddString(table->GetColumnName(colIndex));
+        desc.valueType = (uint)type;
+
+        FixedArray<ubyte>& column = values[colIndex];
+        column.Resize(numRows * valueSize);
+        column.Fill(0);
+        IndexT i;
+        for (i = 0; i < numRows; i++)
+        {
+            void* value = column.Begin() + i * valueSize;
+            switch (type)
+            {
+            case Attr::IntType:     *(int*)value = table->GetInt(colIndex, rows[i]); break;
+            case Attr::UIntType:    *(uint*)value = table->GetUInt(colIndex, rows[i]); break;
+            case Attr::Int64Type:   *(int64_t*)value = table->GetInt64(colIndex, rows[i]); break;
+            case Attr::FloatType:   *(float*)value = table->GetFloat(colIndex, rows[i]); break;
+            case Attr::BoolType:    *(ubyte*)value = table->GetBool(colIndex, rows[i]) ? 1 : 0; break;
+            case Attr::Vec4Type:    table->GetVec4(colIndex, rows[i]).storeu((Math::scalar*)value); break;
+            case Attr::Mat4Type:    table->GetMat4(colIndex, rows[i]).storeu((Math::scalar*)value); break;
+            case Attr::StringType:  *(uint*)value = this->AddString(table->GetString(colIndex, rows[i])); break;
+            case Attr::GuidType:
+                {
+                    const unsigned char* bytes = nullptr;
+                    const SizeT numBytes = table->GetGuid(colIndex, rows[i]).AsBinary(bytes);
+                    n_assert(16 == numBytes);
+                    Memory::Copy(bytes, value, 16);
+                }
+                break;
+            case Attr::BlobType:
+                {
+                    const Blob& blob = table->GetBlob(colIndex, rows[i]);
+                    Attr::CompiledTableBlob* cell = (Attr::CompiledTableBlob*)value;
+                    cell->offset = this->blobData.Size();
+                    cell->size = blob.IsValid() ? blob.Size() : 0;
+                    if (cell->size > 0)
+                    {
+                        this->blobData.AppendArray((const ubyte*)blob.GetPtr(), (SizeT)cell->size);
+                        while (0 != (this->blobData.Size() & 15))
+                        {
+                            this->blobData.Append(0);
+                        }
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (InvalidIndex != this->keyColumns.FindIndex(table->GetColumnId(colIndex)))
+        {
+            if (!this->BuildIndex(table, colIndex, rows, column, buckets[colIndex]))
+            {
+                return false;
+            }
+            desc.numBuckets = (uint)buckets[colIndex].Size();
+        }
+    }
+
+    // lay out the sections
+    Attr::CompiledTableHeader header;
+    Memory::Clear(&header, sizeof(header));
+    header.magic = Attr::CompiledTableHeader::Magic;
+    header.version = Attr::CompiledTableHeader::Version;
+    header.numRows = (uint)numRows;
+    header.numColumns = (uint)numColumns;
+    header.numStrings = (uint)this->stringOffsets.Size();
+
+    uint64_t offset = Align16(sizeof(header) + numColumns * sizeof(Attr::CompiledTableColumn));
+    for (colIndex = 0; colIndex < numColumns; colIndex++)
+    {
+        descs[colIndex].values = offset;
+        offset = Align16(offset + values[colIndex].Size());
+    }
+    for (colIndex = 0; colIndex < numColumns; colIndex++)
+    {
+        if (descs[colIndex].numBuckets > 0)
+        {
+            descs[colIndex].buckets = offset;
+            offset = Align16(offset + buckets[colIndex].Size() * sizeof(uint));
+        }
+    }
+    header.stringOffsets = offset;
+    offset = Align16(offset + this->stringOffsets.ByteSize());
+    header.stringData = offset;
+    offset = Align16(offset + this->stringData.Size());
+    header.blobData = offset;
+
+    // and write them out in the same order
+    Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(dst);
+    stream->SetAccessMode(IO::Stream::WriteAccess);
+    if (!stream->Open())
+    {
+        this->logger->Error("CompiledTableWriter: could not write '%s'\n", dst.AsString().AsCharPtr());
+        return false;
+    }
+    offset = 0;
+    WriteSection(stream, &header, sizeof(header), offset);
+    WriteSection(stream, descs.Begin(), numColumns * sizeof(Attr::CompiledTableColumn), offset);
+    for (colIndex = 0; colIndex < numColumns; colIndex++)
+    {
+        n_assert(offset == descs[colIndex].values);
+        WriteSection(stream, values[colIndex].Begin(), values[colIndex].Size(), offset);
+    }
+    for (colIndex = 0; colIndex < numColumns; colIndex++)
+    {
+        if (descs[colIndex].numBuckets > 0)
+        {
+            n_assert(offset == descs[colIndex].buckets);
+            WriteSection(stream, buckets[colIndex].Begin(), buckets[colIndex].Size() * sizeof(uint), offset);
+        }
+    }
+    WriteSection(stream, this->stringOffsets.Begin(), this->stringOffsets.ByteSize(), offset);
+    WriteSection(stream, this->stringData.Begin(), this->stringData.Size(), offset);
+    WriteSection(stream, this->blobData.Begin(), this->blobData.Size(), offset);
+    n_assert(offset == Align16(header.blobData + this->blobData.Size()));
+    stream->Close();
+
+    this->logger->Print("Compiled %d rows, %d columns and %d strings into %s\n", numRows, numColumns, this->stringOffsets.Size(), dst.AsString().AsCharPtr());
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+CompiledTableWriter::WriteDbTable(const Ptr<Db::Table>& table, const IO::URI& dst)
+{
+    n_assert(table.isvalid());
+    Ptr<Db::Dataset> dataset = table->CreateDataset();
+    dataset->AddAllTableColumns();
+    dataset->PerformQuery();
+
+    const Array<Attr::AttrId> keys = this->keyColumns;
+    if (table->HasPrimaryColumn())
+    {
+        this->AddKeyColumn(table->GetPrimaryColumn().GetAttrId());
+    }
+    const bool result = this->Write(dataset->Values().upcast<Attr::AttributeTable>(), dst);
+    this->keyColumns = keys;
+    return result;
+}
+
+} // namespace ToolkitUtil
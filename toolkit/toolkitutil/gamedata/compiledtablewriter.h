@@ -0,0 +1,84 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class ToolkitUtil::CompiledTableWriter
+
+    Writes attribute tables in the compiled columnar format which
+    Attr::CompiledAttributeTable maps at runtime.
+
+    Values are written column by column, strings of all columns go into
+    one dictionary so repeated strings are stored once, and every key
+    column gets a hash index with at most half of its buckets in use.
+    Key values have to be unique, the writer fails otherwise. Rows which
+    are marked as deleted in the source table are skipped.
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "util/string.h"
+#include "util/array.h"
+#include "util/fixedarray.h"
+#include "util/hashtable.h"
+#include "io/uri.h"
+#include "attr/attributetable.h"
+#include "db/table.h"
+#include "toolkit-common/logger.h"
+
+namespace ToolkitUtil
+{
+
+class CompiledTableWriter
+{
+public:
+    /// constructor
+    CompiledTableWriter();
+    /// destructor
+    ~CompiledTableWriter();
+
+    /// set logger
+    void SetLogger(ToolkitUtil::Logger* logger);
+    /// add a column which gets a key index, must be Int, UInt, Int64, String or Guid
+    void AddKeyColumn(const Attr::AttrId& id);
+
+    /// write an attribute table
+    bool Write(const Ptr<Attr::AttributeTable>& table, const IO::URI& dst);
+    /// write all rows of a database table, its primary column becomes a key column
+    bool WriteDbTable(const Ptr<Db::Table>& table, const IO::URI& dst);
+
+private:
+    /// get index of a string in the dictionary, adds it if it's new
+    uint AddString(const Util::String& str);
+    /// build the hash index of a key column, fails on duplicate keys
+    bool BuildIndex(const Ptr<Attr::AttributeTable>& table, IndexT colIndex, const Util::Array<IndexT>& rows, const Util::FixedArray<ubyte>& values, Util::FixedArray<uint>& outBuckets);
+
+    ToolkitUtil::Logger* logger;
+    Util::Array<Attr::AttrId> keyColumns;
+    Util::HashTable<Util::String, uint, 4096> stringIndices;
+    Util::Array<uint> stringOffsets;
+    Util::Array<char> stringData;
+    Util::Array<ubyte> blobData;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+CompiledTableWriter::SetLogger(ToolkitUtil::Logger* logger)
+{
+    this->logger = logger;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+CompiledTableWriter::AddKeyColumn(const Attr::AttrId& id)
+{
+    if (InvalidIndex == this->keyColumns.FindIndex(id))
+    {
+        this->keyColumns.Append(id);
+    }
+}
+
+} // namespace ToolkitUtil
@@ -14,6 +14,7 @@
 
 #include "model/modelwriter.h"
 #include "model/meshutil/meshbuildersaver.h"
+#include "model/meshutil/meshbuilderoptimizer.h"
 
 #include "model/import/gltf/node/ngltfscene.h"
 #include "model/import/base/uniquestring.h"
@@ -116,6 +117,27 @@ ModelExporter::ExportFile(const IO::URI& file)
     Util::Array<MeshBuilder*> mergedMeshes;
     this->scene->OptimizeGraphics(this->logger, mergedMeshNodes, mergedCharacterNodes, mergedMeshes);
 
+    // Reorder triangles and vertices for the GPU and optionally split primitive groups into meshlets
+    for (IndexT i = 0; i < mergedMeshes.Size(); i++)
+    {
+        Timing::Timer optimizeTimer;
+        optimizeTimer.Start();
+        if (this->exportFlags & ToolkitUtil::OptimizeMesh)
+        {
+            MeshBuilderOptimizer::Report report;
+            MeshBuilderOptimizer::Optimize(*mergedMeshes[i], report);
+            this->logger->Print("Optimized mesh %d: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %d clusters\n", i, report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr, report.numClusters);
+        }
+        if (this->exportFlags & ToolkitUtil::GenerateMeshlets)
+        {
+            SizeT numMeshlets = MeshBuilderOptimizer::BuildMeshlets(*mergedMeshes[i]);
+            this->logger->Print("Generated %d meshlets for mesh %d\n", numMeshlets, i);
+        }
+        optimizeTimer.Stop();
+        if (this->exportFlags & (ToolkitUtil::OptimizeMesh | ToolkitUtil::GenerateMeshlets))
+            this->logger->Print("%s %s (%.2f ms)\n", "Optimizing...", Text("done").Color(TextColor::Green).AsCharPtr(), optimizeTimer.GetTime() * 1000.0f);
+    }
+
     Util::String physicsMeshExportName = String::Sprintf("msh:%s/%s_ph.nvx", this->category.AsCharPtr(), this->file.AsCharPtr());
     IO::URI destinationFiles[] =
     {
@@ -5,6 +5,7 @@
 //------------------------------------------------------------------------------
 #include "foundation/stdneb.h"
 #include "meshbuilder.h"
+#include "jobs2/jobs2.h"
 
 namespace ToolkitUtil
 {
@@ -178,6 +179,7 @@ MeshBuilder::Clear()
 {
     this->vertices.Clear();
     this->triangles.Clear();
+    this->meshlets.Clear();
 }
 
 //------------------------------------------------------------------------------
@@ -192,126 +194,345 @@ MeshBuilder::Transform(const mat4& m)
 
 //------------------------------------------------------------------------------
 /**
-    qsort() hook for Deflate() method.
+    Quantize a float for the weld key, appends two key words. With a zero
+    step the bits are used as they are, except for negative zero which has
+    to match positive zero, so that key equality is the same as
+    MeshBuilderVertex::Compare() == 0. NaNs and infinities are always keyed
+    by their bits, they are detected on the exponent bits since value != value
+    is folded away with -ffast-math.
+
+    With a step the grid cell is computed as a 64 bit integer, large
+    coordinates or fine steps don't fit into 32 bits. The cell is clamped
+    so that huge values don't overflow.
 */
-MeshBuilder* MeshBuilder::qsortData = 0;
-int
-__cdecl
-MeshBuilder::VertexSorter(const void* elm0, const void* elm1)
+static inline void
+WeldQuantize(float value, float invStep, uint* outKey, SizeT& size)
 {
-    MeshBuilder* meshBuilder = qsortData;
-    int i0 = *(int*)elm0;
-    int i1 = *(int*)elm1;
-    const MeshBuilderVertex& v0 = meshBuilder->VertexAt(i0);
-    const MeshBuilderVertex& v1 = meshBuilder->VertexAt(i1);
-    return v0.Compare(v1);
+    uint floatBits;
+    memcpy(&floatBits, &value, sizeof(uint));
+    const bool nonFinite = (floatBits & 0x7F800000) == 0x7F800000;
+
+    uint64_t bits;
+    if (invStep == 0.0f || nonFinite)
+    {
+        // fold negative zero into positive zero
+        if ((floatBits & 0x7FFFFFFF) == 0)
+            floatBits = 0;
+        bits = floatBits;
+    }
+    else
+    {
+        static const double MaxCell = 4611686018427387904.0; // 2^62
+        double cell = floor((double)value * (double)invStep + 0.5);
+        if (cell > MaxCell)
+            cell = MaxCell;
+        else if (cell < -MaxCell)
+            cell = -MaxCell;
+        bits = (uint64_t)(int64_t)cell;
+    }
+    outKey[size++] = (uint)bits;
+    outKey[size++] = (uint)(bits >> 32);
 }
 
 //------------------------------------------------------------------------------
 /**
-    Cleanup the mesh. This removes redundant vertices and optionally record
-    the collapse history into a client-provided collapsMap. The collaps map
-    contains at each new vertex index the 'old' vertex indices which have
-    been collapsed into the new vertex.
 */
-void
-MeshBuilder::Deflate(FixedArray<Array<IndexT>>* collapsMap)
+static inline uint64_t
+WeldHash(const uint* key, SizeT size)
 {
-    // generate a index remapping table and sorted vertex array
-    SizeT numVertices = this->GetNumVertices();
-    IndexT* indexMap = (IndexT*)Memory::Alloc(Memory::ScratchHeap, numVertices * sizeof(IndexT));
-    IndexT* sortMap = (IndexT*)Memory::Alloc(Memory::ScratchHeap, numVertices * sizeof(IndexT));
-    IndexT* shiftMap = (IndexT*)Memory::Alloc(Memory::ScratchHeap, numVertices * sizeof(IndexT));
-    IndexT i;
-    for (i = 0; i < numVertices; i++)
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (IndexT i = 0; i < size; i++)
+        hash = (hash ^ key[i]) * 0x100000001b3ull;
+
+    // finalizer, so that both the low bits (table slot) and the high bits (partition) are well mixed
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/// max number of weld key words, two per position, uv, normal, tangent, color, uv2 and skin weight component, one per skin index
+static const SizeT MaxWeldKeySize = (4 + 2 + 3 + 3 + 4 + 2 + 4) * 2 + 4;
+/// vertex count from which Weld() goes wide
+static const SizeT ParallelWeldThreshold = 65536;
+/// number of vertices hashed per job
+static const SizeT WeldHashBatchSize = 16384;
+/// number of hash partitions when going wide, in bits
+static const SizeT WeldPartitionBits = 6;
+
+//------------------------------------------------------------------------------
+/**
+    The key covers exactly the components MeshBuilderVertex::Compare() looks at.
+*/
+SizeT
+MeshBuilder::WeldKey(const MeshBuilderVertex& vtx, float invPositionStep, float invAttributeStep, uint* outKey)
+{
+    SizeT size = 0;
+    WeldQuantize(vtx.base.position.x, invPositionStep, outKey, size);
+    WeldQuantize(vtx.base.position.y, invPositionStep, outKey, size);
+    WeldQuantize(vtx.base.position.z, invPositionStep, outKey, size);
+    WeldQuantize(vtx.base.position.w, invPositionStep, outKey, size);
+    WeldQuantize(vtx.base.uv.x, invAttributeStep, outKey, size);
+    WeldQuantize(vtx.base.uv.y, invAttributeStep, outKey, size);
+
+    if (AllBits(vtx.componentMask, MeshBuilderVertex::Components::Normals))
     {
-        indexMap[i] = i;
-        sortMap[i] = i;
+        const MeshBuilderVertex::VertexAttributes::Normal& n = vtx.attributes.normal;
+        WeldQuantize(n.normal.x, invAttributeStep, outKey, size);
+        WeldQuantize(n.normal.y, invAttributeStep, outKey, size);
+        WeldQuantize(n.normal.z, invAttributeStep, outKey, size);
+        WeldQuantize(n.tangent.x, invAttributeStep, outKey, size);
+        WeldQuantize(n.tangent.y, invAttributeStep, outKey, size);
+        WeldQuantize(n.tangent.z, invAttributeStep, outKey, size);
     }
+    if (AllBits(vtx.componentMask, MeshBuilderVertex::Components::Color))
+    {
+        const vec4& c = vtx.attributes.color.color;
+        WeldQuantize(c.x, invAttributeStep, outKey, size);
+        WeldQuantize(c.y, invAttributeStep, outKey, size);
+        WeldQuantize(c.z, invAttributeStep, outKey, size);
+        WeldQuantize(c.w, invAttributeStep, outKey, size);
+    }
+    if (AllBits(vtx.componentMask, MeshBuilderVertex::Components::SecondUv))
+    {
+        WeldQuantize(vtx.attributes.secondUv.uv2.x, invAttributeStep, outKey, size);
+        WeldQuantize(vtx.attributes.secondUv.uv2.y, invAttributeStep, outKey, size);
+    }
+    if (AllBits(vtx.componentMask, MeshBuilderVertex::Components::SkinIndices | MeshBuilderVertex::Components::SkinWeights))
+    {
+        const MeshBuilderVertex::VertexAttributes::Skin& skin = vtx.attributes.skin;
+        WeldQuantize(skin.weights.x, invAttributeStep, outKey, size);
+        WeldQuantize(skin.weights.y, invAttributeStep, outKey, size);
+        WeldQuantize(skin.weights.z, invAttributeStep, outKey, size);
+        WeldQuantize(skin.weights.w, invAttributeStep, outKey, size);
+        outKey[size++] = skin.indices.x;
+        outKey[size++] = skin.indices.y;
+        outKey[size++] = skin.indices.z;
+        outKey[size++] = skin.indices.w;
+    }
+    n_assert(size <= MaxWeldKeySize);
+    return size;
+}
 
-    // generate a sorted index map (sort by X coordinate)
-    qsortData = this;
-    qsort(sortMap, numVertices, sizeof(IndexT), MeshBuilder::VertexSorter);
-
-    // search sorted array for redundant vertices
-    IndexT baseIndex = 0;
-    for (baseIndex = 0; baseIndex < (numVertices - 1);)
+//------------------------------------------------------------------------------
+/**
+    Remove redundant vertices in O(n) using hashing instead of sorting.
+
+    Every vertex gets a key built from its components, quantized by the
+    epsilons in the settings. With zero epsilons the key is the raw bit
+    pattern, which welds exactly the vertices MeshBuilderVertex::operator==
+    considers equal. With non-zero epsilons vertices are snapped to a grid,
+    so two vertices closer than epsilon but on different sides of a cell
+    border are kept apart.
+
+    The first vertex (lowest index) of each set of equal vertices survives and
+    the surviving vertices keep their relative order, so the result is
+    deterministic and independent of the number of threads.
+
+    For large meshes the vertices are hashed in batches, then split into
+    partitions by the upper hash bits, and each partition is welded with its
+    own hash table as a separate job.
+*/
+void
+MeshBuilder::Weld(const WeldSettings& settings, CollapseMap* collapseMap)
+{
+    const SizeT numVertices = this->vertices.Size();
+    const float invPositionStep = settings.positionEpsilon > 0.0f ? 1.0f / settings.positionEpsilon : 0.0f;
+    const float invAttributeStep = settings.attributeEpsilon > 0.0f ? 1.0f / settings.attributeEpsilon : 0.0f;
+    const bool parallel = settings.parallel && numVertices >= ParallelWeldThreshold && Jobs2::ctx.threads.Size() > 0;
+    const SizeT numPartitions = parallel ? (1 << WeldPartitionBits) : 1;
+    const uint partitionShift = 64 - WeldPartitionBits;
+
+    // hash all vertices
+    FixedArray<uint64_t> hashes(numVertices);
+    auto hashBatch = [this, &hashes, invPositionStep, invAttributeStep, numVertices](IndexT batch)
     {
-        IndexT nextIndex = baseIndex + 1;
-        while ((nextIndex < numVertices) &&
-            (this->vertices[sortMap[baseIndex]] == this->vertices[sortMap[nextIndex]]))
+        uint key[MaxWeldKeySize];
+        const IndexT end = Math::min((batch + 1) * WeldHashBatchSize, numVertices);
+        for (IndexT i = batch * WeldHashBatchSize; i < end; i++)
         {
-            // mark the vertex as invalid
-            this->vertices[sortMap[nextIndex]].SetFlag(MeshBuilderVertex::Redundant);
-
-            // put the new valid index into the index remapping table
-            indexMap[sortMap[nextIndex]] = sortMap[baseIndex];
-            nextIndex++;
+            SizeT keySize = WeldKey(this->vertices[i], invPositionStep, invAttributeStep, key);
+            hashes[i] = WeldHash(key, keySize);
         }
-        baseIndex = nextIndex;
+    };
+    const SizeT numBatches = (numVertices + WeldHashBatchSize - 1) / WeldHashBatchSize;
+    if (parallel)
+    {
+        Threading::Event event;
+        Jobs2::JobDispatch([&hashBatch](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+        {
+            for (IndexT i = 0; i < groupSize; i++)
+            {
+                if (invocationOffset + i >= totalJobs)
+                    return;
+                hashBatch(invocationOffset + i);
+            }
+        }, numBatches, 1, nullptr, nullptr, &event);
+        event.Wait();
+    }
+    else
+    {
+        for (IndexT i = 0; i < numBatches; i++)
+            hashBatch(i);
     }
 
-    // fill the shiftMap, this contains for each vertex index the number
-    // of invalid vertices in front of it
-    SizeT numInvalid = 0;
-    IndexT vertexIndex;
-    for (vertexIndex = 0; vertexIndex < numVertices; vertexIndex++)
+    // bucket vertices by partition, keeping them in ascending order within each partition
+    FixedArray<IndexT> partitionOffsets(numPartitions + 1, 0);
+    for (IndexT i = 0; i < numVertices; i++)
+        partitionOffsets[(numPartitions > 1 ? (hashes[i] >> partitionShift) : 0) + 1]++;
+    for (IndexT i = 0; i < numPartitions; i++)
+        partitionOffsets[i + 1] += partitionOffsets[i];
+    FixedArray<IndexT> partitioned(numVertices);
+    FixedArray<IndexT> fill(numPartitions);
+    for (IndexT i = 0; i < numPartitions; i++)
+        fill[i] = partitionOffsets[i];
+    for (IndexT i = 0; i < numVertices; i++)
+        partitioned[fill[numPartitions > 1 ? (hashes[i] >> partitionShift) : 0]++] = i;
+
+    // weld each partition with open addressing, remap points every vertex at its surviving vertex
+    FixedArray<IndexT> remap(numVertices);
+    auto weldPartition = [this, &hashes, &partitioned, &partitionOffsets, &remap, invPositionStep, invAttributeStep](IndexT partition)
     {
-        if (this->vertices[vertexIndex].CheckFlag(MeshBuilderVertex::Redundant))
+        const IndexT first = partitionOffsets[partition];
+        const SizeT count = partitionOffsets[partition + 1] - first;
+        if (count == 0)
+            return;
+
+        SizeT tableSize = 16;
+        while (tableSize < count * 2)
+            tableSize <<= 1;
+        const uint64_t mask = tableSize - 1;
+        FixedArray<IndexT> table(tableSize, InvalidIndex);
+        uint key[MaxWeldKeySize];
+        uint otherKey[MaxWeldKeySize];
+        for (IndexT i = first; i < first + count; i++)
         {
-            numInvalid++;
+            const IndexT vertexIndex = partitioned[i];
+            const uint64_t hash = hashes[vertexIndex];
+            SizeT keySize = InvalidIndex;
+            uint64_t slot = hash & mask;
+            while (true)
+            {
+                const IndexT candidate = table[slot];
+                if (candidate == InvalidIndex)
+                {
+                    table[slot] = vertexIndex;
+                    remap[vertexIndex] = vertexIndex;
+                    break;
+                }
+                if (hashes[candidate] == hash)
+                {
+                    // full compare on hash match
+                    if (keySize == InvalidIndex)
+                        keySize = WeldKey(this->vertices[vertexIndex], invPositionStep, invAttributeStep, key);
+                    SizeT otherKeySize = WeldKey(this->vertices[candidate], invPositionStep, invAttributeStep, otherKey);
+                    if (keySize == otherKeySize && memcmp(key, otherKey, keySize * sizeof(uint)) == 0)
+                    {
+                        remap[vertexIndex] = candidate;
+                        break;
+                    }
+                }
+                slot = (slot + 1) & mask;
+            }
         }
-        shiftMap[vertexIndex] = numInvalid;
+    };
+    if (parallel)
+    {
+        Threading::Event event;
+        Jobs2::JobDispatch([&weldPartition](SizeT totalJobs, SizeT groupSize, IndexT groupIndex, SizeT invocationOffset)
+        {
+            for (IndexT i = 0; i < groupSize; i++)
+            {
+                if (invocationOffset + i >= totalJobs)
+                    return;
+                weldPartition(invocationOffset + i);
+            }
+        }, numPartitions, 1, nullptr, nullptr, &event);
+        event.Wait();
+    }
+    else
+    {
+        weldPartition(0);
     }
 
-    // fix the triangle's vertex indices, first, remap the old index to a
-    // valid index from the indexMap, then decrement by the shiftMap entry
-    // at that index (which contains the number of invalid vertices in front
-    // of that index)
-    // fix vertex indices in triangles
-    SizeT numTriangles = this->triangles.Size();
-    IndexT curTriangle;
-    for (curTriangle = 0; curTriangle < numTriangles; curTriangle++)
+    // compact surviving vertices, preserving their order
+    SizeT numWelded = 0;
+    FixedArray<IndexT> newIndex(numVertices);
+    for (IndexT i = 0; i < numVertices; i++)
     {
-        MeshBuilderTriangle& t = this->triangles[curTriangle];
-        for (i = 0; i < 3; i++)
-        {
-            IndexT newIndex = indexMap[t.vertexIndex[i]];
-            t.vertexIndex[i] = newIndex - shiftMap[newIndex];
-        }
+        if (remap[i] == i)
+            newIndex[i] = numWelded++;
     }
+    for (IndexT i = 0; i < numVertices; i++)
+        remap[i] = newIndex[remap[i]];
 
-    // initialize the collapse map so that for each new (collapsed)
-    // index it contains a list of old vertex indices which have been
-    // collapsed into the new vertex 
-    if (collapsMap)
+    for (MeshBuilderTriangle& t : this->triangles)
     {
-        collapsMap->SetSize(numVertices);
-        for (i = 0; i < numVertices; i++)
+        for (IndexT i = 0; i < 3; i++)
+            t.vertexIndex[i] = remap[t.vertexIndex[i]];
+    }
+
+    if (numWelded != numVertices)
+    {
+        Array<MeshBuilderVertex> newArray;
+        newArray.Reserve(numWelded);
+        for (IndexT i = 0; i < numVertices; i++)
         {
-            IndexT newIndex = indexMap[i];
-            IndexT collapsedIndex = newIndex - shiftMap[newIndex];
-            (*collapsMap)[collapsedIndex].Append(i);
+            // duplicates always point at an earlier, already appended vertex
+            if (newArray.Size() == remap[i])
+                newArray.Append(this->vertices[i]);
         }
+        this->vertices = std::move(newArray);
     }
 
-    // finally, remove the redundant vertices
-    numVertices = this->vertices.Size();
-    Array<MeshBuilderVertex> newArray;
-    newArray.Reserve(numVertices);
-    for (vertexIndex = 0; vertexIndex < numVertices; vertexIndex++)
+    // old indices per new vertex, in ascending order
+    if (collapseMap)
     {
-        if (!this->vertices[vertexIndex].CheckFlag(MeshBuilderVertex::Redundant))
+        collapseMap->offsets.Clear();
+        collapseMap->offsets.Fill(0, numWelded + 1, 0);
+        for (IndexT i = 0; i < numVertices; i++)
+            collapseMap->offsets[remap[i] + 1]++;
+        for (IndexT i = 0; i < numWelded; i++)
+            collapseMap->offsets[i + 1] += collapseMap->offsets[i];
+
+        collapseMap->indices.Clear();
+        collapseMap->indices.Fill(0, numVertices, InvalidIndex);
+        FixedArray<IndexT> cursor(numWelded);
+        for (IndexT i = 0; i < numWelded; i++)
+            cursor[i] = collapseMap->offsets[i];
+        for (IndexT i = 0; i < numVertices; i++)
+            collapseMap->indices[cursor[remap[i]]++] = i;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Remove redundant vertices and optionally record the collapse history into
+    a client-provided collapse map. The collapse map contains at each new
+    vertex index the 'old' vertex indices which have been collapsed into the
+    new vertex. Prefer Weld() with a CollapseMap for large meshes, as this
+    allocates one array per vertex.
+*/
+void
+MeshBuilder::Deflate(FixedArray<Array<IndexT>>* collapsMap)
+{
+    SizeT numVertices = this->GetNumVertices();
+    CollapseMap map;
+
+    // exporters deflate from within jobs
+    WeldSettings settings;
+    settings.parallel = false;
+    this->Weld(settings, collapsMap ? &map : nullptr);
+
+    if (collapsMap)
+    {
+        collapsMap->SetSize(numVertices);
+        for (IndexT i = 0; i < map.offsets.Size() - 1; i++)
         {
-            newArray.Append(this->vertices[vertexIndex]);
+            for (IndexT j = map.offsets[i]; j < map.offsets[i + 1]; j++)
+                (*collapsMap)[i].Append(map.indices[j]);
         }
     }
-    this->vertices = newArray;
-
-    // cleanup
-    Memory::Free(Memory::ScratchHeap, indexMap);
-    Memory::Free(Memory::ScratchHeap, sortMap);
-    Memory::Free(Memory::ScratchHeap, shiftMap);
 }
 
 //------------------------------------------------------------------------------
@@ -363,112 +584,32 @@ MeshBuilder::FlipUvs()
     }
 }
 
-//-----------------------------------------------------------------------------------------------------------
-//  Cleanup the mesh
-//  This removes redundant vertices and optionally record the collapse history into a client-provided
-//   collapseMap
-//  The collaps map contains at each new vertex index the 'old' vertex indices which have been collapsed
-//   into the new vertex.
-//
-//  30-Jan-03 Floh Optimizations
-
-void MeshBuilder::Cleanup(Array<Array<int> >* collapseMap)
+//------------------------------------------------------------------------------
+/**
+    Cleanup the mesh. This removes redundant vertices and optionally records
+    the collapse history into a client-provided collapseMap, which has to be
+    sized to the number of vertices. The collapse map contains at each new
+    vertex index the 'old' vertex indices which have been collapsed into the
+    new vertex.
+*/
+void
+MeshBuilder::Cleanup(Array<Array<int> >* collapseMap)
 {
-    int numVertices = this->vertices.Size();
-
-    // generate a index remapping table and sorted vertex array
-    int* indexMap = new int[numVertices];
-    int* sortMap = new int[numVertices];
-    int* shiftMap = new int[numVertices];
+    CollapseMap map;
 
-    int i;
-    for (i = 0; i < numVertices; i++)
-    {
-        indexMap[i] = i;
-        sortMap[i] = i;
-    }
-
-    // generate a sorted index map (sort by X coordinate)
-    qsortData = this;
-    qsort(sortMap, numVertices, sizeof(int), MeshBuilder::VertexSorter);
-
-    // search sorted array for redundant vertices
-    int baseIndex = 0;
-    for (baseIndex = 0; baseIndex < (numVertices - 1);)
-    {
-        int nextIndex = baseIndex + 1;
-        while (nextIndex < numVertices &&
-            this->vertices[sortMap[baseIndex]] == this->vertices[sortMap[nextIndex]])
-        {
-            // mark the vertex as invalid
-            this->vertices[sortMap[nextIndex]].SetFlag(MeshBuilderVertex::Redundant);
+    // exporters clean up from within jobs
+    WeldSettings settings;
+    settings.parallel = false;
+    this->Weld(settings, collapseMap ? &map : nullptr);
 
-            // put the new valid index into the index remapping table
-            indexMap[sortMap[nextIndex]] = sortMap[baseIndex];
-            nextIndex++;
-        }
-
-        baseIndex = nextIndex;
-    }
-
-    // fill the shiftMap, this contains for each vertex index the number of invalid vertices in front of it
-    int numInvalid = 0;
-
-    int vertexIndex;
-    for (vertexIndex = 0; vertexIndex < numVertices; vertexIndex++)
-    {
-        if (this->vertices[vertexIndex].CheckFlag(MeshBuilderVertex::Redundant))
-            numInvalid++;
-
-        shiftMap[vertexIndex] = numInvalid;
-    }
-
-    // fix the triangle's vertex indices, first, remap the old index to a valid index from the indexMap,
-    //  then decrement by the shiftMap entry at that index, which contains the number of invalid vertices
-    //  in front of that index
-    //  fix vertex indices in triangles
-    int numTriangles = this->triangles.Size();
-
-    int curTriangle;
-    for (curTriangle = 0; curTriangle < numTriangles; curTriangle++)
-    {
-        MeshBuilderTriangle& t = this->triangles[curTriangle];
-        for (i = 0; i < 3; i++)
-        {
-            int newIndex = indexMap[t.vertexIndex[i]];
-            t.vertexIndex[i] = newIndex - shiftMap[newIndex];
-        }
-    }
-
-    // initialize the collaps map so that for each new (collapsed) index it contains a list of old vertex indices
-    //  which have been collapsed into the new vertex
     if (collapseMap)
     {
-        for (i = 0; i < numVertices; i++)
+        for (IndexT i = 0; i < map.offsets.Size() - 1; i++)
         {
-            int newIndex = indexMap[i];
-            int collapsedIndex = newIndex - shiftMap[newIndex];
-
-            (*collapseMap)[collapsedIndex].Append(i);
+            for (IndexT j = map.offsets[i]; j < map.offsets[i + 1]; j++)
+                (*collapseMap)[i].Append(map.indices[j]);
         }
     }
-
-    // finally, remove the redundant vertices
-    numVertices = this->vertices.Size();
-
-    Array<MeshBuilderVertex> newArray(numVertices, numVertices);
-    for (vertexIndex = 0; vertexIndex < numVertices; vertexIndex++)
-    {
-        if (!this->vertices[vertexIndex].CheckFlag(MeshBuilderVertex::Redundant))
-            newArray.Append(this->vertices[vertexIndex]);
-    }
-
-    this->vertices = newArray;
-
-    // cleanup
-    delete[] indexMap;
-    delete[] sortMap;
-    delete[] shiftMap;
 }
 
 //------------------------------------------------------------------------------
@@ -20,11 +20,44 @@
 //------------------------------------------------------------------------------
 namespace ToolkitUtil
 {
+
+/// a contiguous run of triangles within a primitive group, with culling data
+struct MeshBuilderMeshlet
+{
+    IndexT firstTriangleIndex;
+    SizeT numTriangles;
+    SizeT numVertices;
+    Math::vec3 center;
+    float radius;
+    Math::vec3 coneApex;
+    Math::vec3 coneAxis;
+    float coneCutoff;
+};
+
 class MeshBuilder
 {
     struct Mesh;
 public:
 
+    /// settings for Weld()
+    struct WeldSettings
+    {
+        /// quantization step for positions, 0 only welds bit-identical positions
+        float positionEpsilon = 0.0f;
+        /// quantization step for uvs, normals, tangents, colors and skin weights, 0 only welds bit-identical values
+        float attributeEpsilon = 0.0f;
+        /// split the work over the Jobs2 threads for large meshes, must not be used from within a job
+        bool parallel = true;
+    };
+
+    /// collapse map in compressed sparse row form
+    struct CollapseMap
+    {
+        /// old vertex indices collapsed into new vertex i are indices[offsets[i]] up to indices[offsets[i + 1]]
+        Util::Array<IndexT> offsets;
+        Util::Array<IndexT> indices;
+    };
+
     /// constructor
     MeshBuilder();
     
@@ -62,6 +95,9 @@ public:
     /// Clear primitive groups
     void ClearPrimitiveGroups();
 
+    /// get meshlets, only valid after MeshBuilderOptimizer::BuildMeshlets
+    const Util::Array<MeshBuilderMeshlet>& GetMeshlets() const;
+
     /// copy triangle with its vertices, do not generate redundant vertices
     void CopyTriangle(const MeshBuilder& srcMesh, IndexT triIndex, Util::FixedArray<IndexT>& indexMap);
     /// compute overall bounding box
@@ -75,6 +111,8 @@ public:
     void Transform(const Math::mat4& m);
     /// remove redundant vertices
     void Deflate(Util::FixedArray<Util::Array<IndexT> >* collapseMap);
+    /// remove redundant vertices using a hash table, optionally record a flat collapse map
+    void Weld(const WeldSettings& settings, CollapseMap* collapseMap = nullptr);
     /// inflate mesh to 3 unique vertices per triangles, created redundant vertices
     void Inflate();
     /// flip v texture coordinates
@@ -91,19 +129,20 @@ public:
     void CalculateTangents();
 
 private:
-    /// a qsort() hook for generating a sorted index array
-    static int __cdecl VertexSorter(const void* elm0, const void* elm1);
-    static MeshBuilder* qsortData;
+    /// build the weld key of a vertex, returns the number of key words
+    static SizeT WeldKey(const MeshBuilderVertex& vtx, float invPositionStep, float invAttributeStep, uint* outKey);
     friend class MeshBuilderSaver;
     friend class SkinPartitioner;
     friend class SkinFragment;
     friend class NFbxScene;
+    friend class MeshBuilderOptimizer;
 
     Util::Array<MeshBuilderTriangle> triangles;
     CoreGraphics::PrimitiveTopology::Code topology;
     MeshBuilderVertex::ComponentMask componentMask;
     Util::Array<MeshBuilderVertex> vertices;
     Util::Array<MeshBuilderGroup> groups;
+    Util::Array<MeshBuilderMeshlet> meshlets;
 };
 
 //------------------------------------------------------------------------------
@@ -160,6 +199,15 @@ MeshBuilder::TriangleAt(IndexT i) const
     return this->triangles[i];
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline const Util::Array<MeshBuilderMeshlet>&
+MeshBuilder::GetMeshlets() const
+{
+    return this->meshlets;
+}
+
 } // namespace ToolkitUtil
 //------------------------------------------------------------------------------
     
\ No newline at end of file
@@ -15,6 +15,8 @@ namespace ToolkitUtil
 MeshBuilderGroup::MeshBuilderGroup()
     : firstTriangleIndex(0)
     , numTriangles(0)
+    , firstMeshletIndex(0)
+    , numMeshlets(0)
 {
     // empty
 }
@@ -55,4 +57,40 @@ MeshBuilderGroup::GetNumTriangles() const
     return this->numTriangles;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MeshBuilderGroup::SetFirstMeshletIndex(IndexT i)
+{
+    this->firstMeshletIndex = i;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+IndexT
+MeshBuilderGroup::GetFirstMeshletIndex() const
+{
+    return this->firstMeshletIndex;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MeshBuilderGroup::SetNumMeshlets(SizeT n)
+{
+    this->numMeshlets = n;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+MeshBuilderGroup::GetNumMeshlets() const
+{
+    return this->numMeshlets;
+}
+
 } // namespace ToolkitUtil
@@ -26,10 +26,20 @@ public:
     void SetNumTriangles(SizeT n);
     /// get number of triangles in group
     SizeT GetNumTriangles() const;
+    /// set first meshlet index
+    void SetFirstMeshletIndex(IndexT i);
+    /// get first meshlet index
+    IndexT GetFirstMeshletIndex() const;
+    /// set number of meshlets in group
+    void SetNumMeshlets(SizeT n);
+    /// get number of meshlets in group
+    SizeT GetNumMeshlets() const;
 
 private:
     IndexT firstTriangleIndex;
     SizeT numTriangles;
+    IndexT firstMeshletIndex;
+    SizeT numMeshlets;
 };
 
 } // namespace ToolkitUtil
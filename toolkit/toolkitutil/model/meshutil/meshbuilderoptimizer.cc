@@ -0,0 +1,577 @@
+//------------------------------------------------------------------------------
+//  meshbuilderoptimizer.cc
+//  (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "meshbuilderoptimizer.h"
+#include <algorithm>
+
+namespace ToolkitUtil
+{
+using namespace Util;
+using namespace Math;
+
+//------------------------------------------------------------------------------
+/**
+    Forsyth vertex score, favours vertices recently used and vertices with
+    few remaining triangles, so that islands get finished before moving on.
+*/
+static float
+VertexScore(IndexT cachePosition, SizeT numRemaining)
+{
+    if (numRemaining == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // the last triangle's vertices get a fixed score, so that strips aren't favoured
+        if (cachePosition < 3)
+            score = 0.75f;
+        else
+        {
+            const float scaler = 1.0f / (MeshBuilderOptimizer::OptimizeCacheSize - 3);
+            score = powf(1.0f - (cachePosition - 3) * scaler, 1.5f);
+        }
+    }
+    score += 2.0f * powf((float)numRemaining, -0.5f);
+    return score;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MeshBuilderOptimizer::Optimize(MeshBuilder& mesh, Report& outReport)
+{
+    outReport.before = AnalyzeVertexCache(mesh);
+    outReport.numClusters = 0;
+    outReport.numMeshlets = mesh.meshlets.Size();
+
+    if (mesh.topology != CoreGraphics::PrimitiveTopology::TriangleList || mesh.triangles.IsEmpty())
+    {
+        outReport.after = outReport.before;
+        return;
+    }
+
+    // mesh center used as the reference point for the overdraw sort
+    vec3 center = vec3(0);
+    for (const MeshBuilderVertex& vtx : mesh.vertices)
+        center += xyz(vtx.base.position);
+    center *= 1.0f / Math::max(mesh.vertices.Size(), 1);
+
+    const Array<MeshBuilderGroup> ranges = GetTriangleRanges(mesh);
+    for (const MeshBuilderGroup& range : ranges)
+    {
+        OptimizeVertexCache(mesh, range.GetFirstTriangleIndex(), range.GetNumTriangles());
+        outReport.numClusters += OptimizeOverdraw(mesh, range.GetFirstTriangleIndex(), range.GetNumTriangles(), center);
+    }
+    OptimizeVertexFetch(mesh);
+
+    // triangle order changed, previous meshlets are stale
+    if (!mesh.meshlets.IsEmpty())
+        outReport.numMeshlets = BuildMeshlets(mesh);
+
+    outReport.after = AnalyzeVertexCache(mesh);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Splits each primitive group into meshlets. A meshlet is a contiguous run
+    of triangles within the group, so it can be drawn as a sub range of the
+    group's indices. Meshlets are closed whenever adding a triangle would
+    exceed either the vertex or the triangle limit.
+*/
+SizeT
+MeshBuilderOptimizer::BuildMeshlets(MeshBuilder& mesh, SizeT maxVertices, SizeT maxTriangles)
+{
+    n_assert(maxVertices >= 3 && maxTriangles >= 1);
+    mesh.meshlets.Clear();
+    if (mesh.topology != CoreGraphics::PrimitiveTopology::TriangleList)
+        return 0;
+
+    // last meshlet each vertex was seen in
+    FixedArray<IndexT> seen(mesh.vertices.Size(), InvalidIndex);
+    for (MeshBuilderGroup& group : mesh.groups)
+    {
+        group.SetFirstMeshletIndex(mesh.meshlets.Size());
+        group.SetNumMeshlets(0);
+
+        const IndexT first = group.GetFirstTriangleIndex();
+        const IndexT end = Math::min(first + group.GetNumTriangles(), mesh.triangles.Size());
+        MeshBuilderMeshlet* meshlet = nullptr;
+        for (IndexT triIndex = first; triIndex < end; triIndex++)
+        {
+            const MeshBuilderTriangle& tri = mesh.triangles[triIndex];
+
+            SizeT numNewVertices = 0;
+            if (meshlet != nullptr)
+            {
+                const IndexT meshletIndex = mesh.meshlets.Size() - 1;
+                for (IndexT corner = 0; corner < 3; corner++)
+                    numNewVertices += seen[tri.GetVertexIndex(corner)] != meshletIndex ? 1 : 0;
+            }
+
+            if (meshlet == nullptr
+                || meshlet->numVertices + numNewVertices > maxVertices
+                || meshlet->numTriangles == maxTriangles)
+            {
+                meshlet = &mesh.meshlets.Emplace();
+                meshlet->firstTriangleIndex = triIndex;
+                meshlet->numTriangles = 0;
+                meshlet->numVertices = 0;
+                group.SetNumMeshlets(group.GetNumMeshlets() + 1);
+            }
+
+            const IndexT meshletIndex = mesh.meshlets.Size() - 1;
+            for (IndexT corner = 0; corner < 3; corner++)
+            {
+                const IndexT vertexIndex = tri.GetVertexIndex(corner);
+                if (seen[vertexIndex] != meshletIndex)
+                {
+                    seen[vertexIndex] = meshletIndex;
+                    meshlet->numVertices++;
+                }
+            }
+            meshlet->numTriangles++;
+        }
+    }
+
+    for (MeshBuilderMeshlet& meshlet : mesh.meshlets)
+        ComputeMeshletBounds(mesh, meshlet);
+
+    return mesh.meshlets.Size();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Simulates a FIFO post-transform cache over the whole index buffer.
+*/
+MeshBuilderOptimizer::Statistics
+MeshBuilderOptimizer::AnalyzeVertexCache(const MeshBuilder& mesh, SizeT cacheSize)
+{
+    Statistics stats;
+    stats.acmr = 0.0f;
+    stats.atvr = 0.0f;
+    if (mesh.triangles.IsEmpty())
+        return stats;
+
+    FixedArray<bool> used(mesh.vertices.Size(), false);
+    SizeT numUsed = 0;
+    for (const MeshBuilderTriangle& tri : mesh.triangles)
+    {
+        for (IndexT corner = 0; corner < 3; corner++)
+        {
+            const IndexT vertexIndex = tri.GetVertexIndex(corner);
+            if (!used[vertexIndex])
+            {
+                used[vertexIndex] = true;
+                numUsed++;
+            }
+        }
+    }
+
+    const SizeT misses = CountCacheMisses(mesh, mesh.triangles.Begin(), mesh.triangles.Size(), cacheSize);
+    stats.acmr = misses / float(mesh.triangles.Size());
+    stats.atvr = misses / float(Math::max(numUsed, 1));
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Returns the primitive groups sorted by first triangle. Groups overlapping
+    a previous group or reaching out of the triangle array are skipped, since
+    reordering them would corrupt the other group. Meshes without groups are
+    treated as a single group.
+*/
+Array<MeshBuilderGroup>
+MeshBuilderOptimizer::GetTriangleRanges(const MeshBuilder& mesh)
+{
+    Array<MeshBuilderGroup> ranges;
+    if (mesh.groups.IsEmpty())
+    {
+        MeshBuilderGroup& range = ranges.Emplace();
+        range.SetFirstTriangleIndex(0);
+        range.SetNumTriangles(mesh.triangles.Size());
+        return ranges;
+    }
+
+    Array<MeshBuilderGroup> sorted = mesh.groups;
+    std::sort(sorted.begin(), sorted.end(), [](const MeshBuilderGroup& lhs, const MeshBuilderGroup& rhs)
+    {
+        return lhs.GetFirstTriangleIndex() < rhs.GetFirstTriangleIndex();
+    });
+
+    IndexT end = 0;
+    for (const MeshBuilderGroup& group : sorted)
+    {
+        if (group.GetFirstTriangleIndex() < end
+            || group.GetFirstTriangleIndex() + group.GetNumTriangles() > mesh.triangles.Size())
+            continue;
+        ranges.Append(group);
+        end = group.GetFirstTriangleIndex() + group.GetNumTriangles();
+    }
+    return ranges;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Tom Forsyth's linear-speed vertex cache optimisation. Greedily emits the
+    triangle with the highest score, where the score of a triangle is the sum
+    of its vertex scores, and only the triangles touching the modelled LRU
+    cache get rescored after each step.
+*/
+void
+MeshBuilderOptimizer::OptimizeVertexCache(MeshBuilder& mesh, IndexT firstTriangle, SizeT numTriangles)
+{
+    if (numTriangles < 2)
+        return;
+
+    const SizeT numVertices = mesh.vertices.Size();
+    const MeshBuilderTriangle* triangles = mesh.triangles.Begin() + firstTriangle;
+
+    // build triangle adjacency per vertex
+    FixedArray<SizeT> numRemaining(numVertices, 0);
+    for (IndexT i = 0; i < numTriangles; i++)
+        for (IndexT corner = 0; corner < 3; corner++)
+            numRemaining[triangles[i].GetVertexIndex(corner)]++;
+
+    FixedArray<IndexT> adjacencyOffsets(numVertices + 1, 0);
+    for (IndexT i = 0; i < numVertices; i++)
+        adjacencyOffsets[i + 1] = adjacencyOffsets[i] + numRemaining[i];
+
+    FixedArray<IndexT> adjacency(numTriangles * 3);
+    FixedArray<SizeT> fill(numVertices, 0);
+    for (IndexT i = 0; i < numTriangles; i++)
+    {
+        for (IndexT corner = 0; corner < 3; corner++)
+        {
+            const IndexT vertexIndex = triangles[i].GetVertexIndex(corner);
+            adjacency[adjacencyOffsets[vertexIndex] + fill[vertexIndex]++] = i;
+        }
+    }
+
+    FixedArray<IndexT> cachePosition(numVertices, InvalidIndex);
+    FixedArray<float> vertexScores(numVertices, 0.0f);
+    for (IndexT i = 0; i < numVertices; i++)
+        vertexScores[i] = VertexScore(InvalidIndex, numRemaining[i]);
+
+    FixedArray<float> triangleScores(numTriangles);
+    FixedArray<bool> emitted(numTriangles, false);
+    IndexT bestTriangle = 0;
+    for (IndexT i = 0; i < numTriangles; i++)
+    {
+        const MeshBuilderTriangle& tri = triangles[i];
+        triangleScores[i] = vertexScores[tri.GetVertexIndex(0)] + vertexScores[tri.GetVertexIndex(1)] + vertexScores[tri.GetVertexIndex(2)];
+        if (triangleScores[i] > triangleScores[bestTriangle])
+            bestTriangle = i;
+    }
+
+    IndexT cache[OptimizeCacheSize + 3];
+    IndexT newCache[OptimizeCacheSize + 3];
+    SizeT cacheSize = 0;
+    IndexT cursor = 0;
+
+    Array<MeshBuilderTriangle> ordered;
+    ordered.Reserve(numTriangles);
+    for (IndexT i = 0; i < numTriangles; i++)
+    {
+        // no candidate in cache, pick the next unemitted triangle in input order
+        if (bestTriangle == InvalidIndex)
+        {
+            while (emitted[cursor])
+                cursor++;
+            bestTriangle = cursor;
+        }
+
+        const MeshBuilderTriangle& tri = triangles[bestTriangle];
+        ordered.Append(tri);
+        emitted[bestTriangle] = true;
+
+        // put the triangle's vertices in front of the cache and drop it from their adjacency
+        SizeT newCacheSize = 0;
+        for (IndexT corner = 0; corner < 3; corner++)
+        {
+            const IndexT vertexIndex = tri.GetVertexIndex(corner);
+            newCache[newCacheSize++] = vertexIndex;
+
+            IndexT* begin = adjacency.Begin() + adjacencyOffsets[vertexIndex];
+            IndexT* end = begin + numRemaining[vertexIndex];
+            IndexT* it = std::find(begin, end, bestTriangle);
+            n_assert(it != end);
+            *it = *(end - 1);
+            numRemaining[vertexIndex]--;
+        }
+        for (IndexT j = 0; j < cacheSize; j++)
+        {
+            const IndexT vertexIndex = cache[j];
+            if (vertexIndex != tri.GetVertexIndex(0) && vertexIndex != tri.GetVertexIndex(1) && vertexIndex != tri.GetVertexIndex(2))
+                newCache[newCacheSize++] = vertexIndex;
+        }
+
+        // update positions and scores of all vertices touched, including the evicted ones
+        for (IndexT j = 0; j < newCacheSize; j++)
+        {
+            const IndexT vertexIndex = newCache[j];
+            cachePosition[vertexIndex] = j < OptimizeCacheSize ? j : InvalidIndex;
+            vertexScores[vertexIndex] = VertexScore(cachePosition[vertexIndex], numRemaining[vertexIndex]);
+        }
+
+        // rescore triangles touching the cache and find the next best
+        bestTriangle = InvalidIndex;
+        float bestScore = -1.0f;
+        for (IndexT j = 0; j < newCacheSize; j++)
+        {
+            const IndexT vertexIndex = newCache[j];
+            const IndexT* adjacent = adjacency.Begin() + adjacencyOffsets[vertexIndex];
+            for (IndexT k = 0; k < numRemaining[vertexIndex]; k++)
+            {
+                const IndexT triIndex = adjacent[k];
+                const MeshBuilderTriangle& candidate = triangles[triIndex];
+                float score = vertexScores[candidate.GetVertexIndex(0)] + vertexScores[candidate.GetVertexIndex(1)] + vertexScores[candidate.GetVertexIndex(2)];
+                triangleScores[triIndex] = score;
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = triIndex;
+                }
+            }
+        }
+
+        cacheSize = Math::min(newCacheSize, OptimizeCacheSize);
+        memcpy(cache, newCache, cacheSize * sizeof(IndexT));
+    }
+
+    for (IndexT i = 0; i < numTriangles; i++)
+        mesh.triangles[firstTriangle + i] = ordered[i];
+}
+
+//------------------------------------------------------------------------------
+/**
+    Splits the cache optimized range into clusters at the points where the
+    cache ordering restarts (a triangle misses all of its vertices), then
+    sorts the clusters so that those facing away from the mesh center are
+    drawn first, as they are the most likely to occlude the rest. The new
+    order is only kept if the ACMR doesn't grow past OverdrawThreshold.
+*/
+SizeT
+MeshBuilderOptimizer::OptimizeOverdraw(MeshBuilder& mesh, IndexT firstTriangle, SizeT numTriangles, const vec3& meshCenter)
+{
+    if (numTriangles < 2)
+        return numTriangles;
+
+    MeshBuilderTriangle* triangles = mesh.triangles.Begin() + firstTriangle;
+
+    struct Cluster
+    {
+        IndexT first;
+        SizeT num;
+        float sortKey;
+    };
+    Array<Cluster> clusters;
+
+    // find cluster boundaries with a FIFO cache simulation
+    FixedArray<IndexT> cacheTime(mesh.vertices.Size(), InvalidIndex);
+    IndexT time = 0;
+    for (IndexT i = 0; i < numTriangles; i++)
+    {
+        SizeT misses = 0;
+        for (IndexT corner = 0; corner < 3; corner++)
+        {
+            const IndexT vertexIndex = triangles[i].GetVertexIndex(corner);
+            if (cacheTime[vertexIndex] == InvalidIndex || time - cacheTime[vertexIndex] >= (IndexT)StatisticsCacheSize)
+            {
+                cacheTime[vertexIndex] = time++;
+                misses++;
+            }
+        }
+        if (clusters.IsEmpty() || misses == 3)
+            clusters.Append({ i, 0, 0.0f });
+        clusters.Back().num++;
+    }
+
+    if (clusters.Size() < 2)
+        return clusters.Size();
+
+    // sort key is how much the cluster faces away from the mesh center
+    for (Cluster& cluster : clusters)
+    {
+        vec3 centroid = vec3(0);
+        vec3 normal = vec3(0);
+        float area = 0.0f;
+        for (IndexT i = cluster.first; i < cluster.first + cluster.num; i++)
+        {
+            const vec3 p0 = xyz(mesh.vertices[triangles[i].GetVertexIndex(0)].base.position);
+            const vec3 p1 = xyz(mesh.vertices[triangles[i].GetVertexIndex(1)].base.position);
+            const vec3 p2 = xyz(mesh.vertices[triangles[i].GetVertexIndex(2)].base.position);
+            const vec3 n = cross(p1 - p0, p2 - p0);
+            const float triArea = length(n);
+            centroid += (p0 + p1 + p2) * (triArea / 3.0f);
+            normal += n;
+            area += triArea;
+        }
+        if (area > 0.0f && lengthsq(normal) > 0.0f)
+            cluster.sortKey = dot(centroid * (1.0f / area) - meshCenter, normalize(normal));
+    }
+
+    Array<IndexT> order;
+    order.Reserve(clusters.Size());
+    for (IndexT i = 0; i < clusters.Size(); i++)
+        order.Append(i);
+    std::stable_sort(order.begin(), order.end(), [&clusters](IndexT lhs, IndexT rhs)
+    {
+        return clusters[lhs].sortKey > clusters[rhs].sortKey;
+    });
+
+    Array<MeshBuilderTriangle> sorted;
+    sorted.Reserve(numTriangles);
+    for (IndexT clusterIndex : order)
+    {
+        const Cluster& cluster = clusters[clusterIndex];
+        for (IndexT i = cluster.first; i < cluster.first + cluster.num; i++)
+            sorted.Append(triangles[i]);
+    }
+
+    const SizeT missesBefore = CountCacheMisses(mesh, triangles, numTriangles, StatisticsCacheSize);
+    const SizeT missesAfter = CountCacheMisses(mesh, sorted.Begin(), numTriangles, StatisticsCacheSize);
+    if (missesAfter > missesBefore * OverdrawThreshold)
+        return 1;
+
+    for (IndexT i = 0; i < numTriangles; i++)
+        triangles[i] = sorted[i];
+    return clusters.Size();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Renumbers vertices in the order they are first referenced by the
+    triangles, so that vertex fetches walk the vertex buffer linearly.
+    Unreferenced vertices are kept at the end of the buffer.
+*/
+void
+MeshBuilderOptimizer::OptimizeVertexFetch(MeshBuilder& mesh)
+{
+    const SizeT numVertices = mesh.vertices.Size();
+    FixedArray<IndexT> remap(numVertices, InvalidIndex);
+    Array<MeshBuilderVertex> vertices;
+    vertices.Reserve(numVertices);
+
+    for (MeshBuilderTriangle& tri : mesh.triangles)
+    {
+        for (IndexT corner = 0; corner < 3; corner++)
+        {
+            const IndexT vertexIndex = tri.GetVertexIndex(corner);
+            if (remap[vertexIndex] == InvalidIndex)
+            {
+                remap[vertexIndex] = vertices.Size();
+                vertices.Append(mesh.vertices[vertexIndex]);
+            }
+            tri.SetVertexIndex(corner, remap[vertexIndex]);
+        }
+    }
+    for (IndexT i = 0; i < numVertices; i++)
+    {
+        if (remap[i] == InvalidIndex)
+            vertices.Append(mesh.vertices[i]);
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+MeshBuilderOptimizer::CountCacheMisses(const MeshBuilder& mesh, const MeshBuilderTriangle* triangles, SizeT numTriangles, SizeT cacheSize)
+{
+    // a vertex is in the FIFO if less than cacheSize vertices were inserted after it
+    FixedArray<IndexT> cacheTime(mesh.vertices.Size(), InvalidIndex);
+    IndexT time = 0;
+    for (IndexT i = 0; i < numTriangles; i++)
+    {
+        for (IndexT corner = 0; corner < 3; corner++)
+        {
+            const IndexT vertexIndex = triangles[i].GetVertexIndex(corner);
+            if (cacheTime[vertexIndex] == InvalidIndex || time - cacheTime[vertexIndex] >= (IndexT)cacheSize)
+                cacheTime[vertexIndex] = time++;
+        }
+    }
+    return time;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Computes a bounding sphere and a normal cone. The meshlet can be culled as
+    backfacing if dot(normalize(coneApex - eye), coneAxis) >= coneCutoff.
+    Meshlets with too wide a normal spread get a cutoff of 1, which never culls.
+*/
+void
+MeshBuilderOptimizer::ComputeMeshletBounds(const MeshBuilder& mesh, MeshBuilderMeshlet& meshlet)
+{
+    const IndexT first = meshlet.firstTriangleIndex;
+    const IndexT end = first + meshlet.numTriangles;
+
+    vec3 minPoint = vec3(FLT_MAX);
+    vec3 maxPoint = vec3(-FLT_MAX);
+    vec3 normalSum = vec3(0);
+    for (IndexT i = first; i < end; i++)
+    {
+        const MeshBuilderTriangle& tri = mesh.triangles[i];
+        const vec3 p0 = xyz(mesh.vertices[tri.GetVertexIndex(0)].base.position);
+        const vec3 p1 = xyz(mesh.vertices[tri.GetVertexIndex(1)].base.position);
+        const vec3 p2 = xyz(mesh.vertices[tri.GetVertexIndex(2)].base.position);
+        minPoint = minimize(minPoint, minimize(p0, minimize(p1, p2)));
+        maxPoint = maximize(maxPoint, maximize(p0, maximize(p1, p2)));
+
+        const vec3 n = cross(p1 - p0, p2 - p0);
+        if (lengthsq(n) > 0.0f)
+            normalSum += normalize(n);
+    }
+
+    meshlet.center = (minPoint + maxPoint) * 0.5f;
+    meshlet.radius = 0.0f;
+    for (IndexT i = first; i < end; i++)
+    {
+        const MeshBuilderTriangle& tri = mesh.triangles[i];
+        for (IndexT corner = 0; corner < 3; corner++)
+            meshlet.radius = Math::max(meshlet.radius, length(xyz(mesh.vertices[tri.GetVertexIndex(corner)].base.position) - meshlet.center));
+    }
+
+    meshlet.coneApex = meshlet.center;
+    meshlet.coneAxis = lengthsq(normalSum) > 0.0f ? normalize(normalSum) : vec3(0, 0, 1);
+    meshlet.coneCutoff = 1.0f;
+    if (lengthsq(normalSum) == 0.0f)
+        return;
+
+    // smallest cosine between the axis and any triangle normal
+    float minDot = 1.0f;
+    for (IndexT i = first; i < end; i++)
+    {
+        const MeshBuilderTriangle& tri = mesh.triangles[i];
+        const vec3 p0 = xyz(mesh.vertices[tri.GetVertexIndex(0)].base.position);
+        const vec3 n = cross(xyz(mesh.vertices[tri.GetVertexIndex(1)].base.position) - p0, xyz(mesh.vertices[tri.GetVertexIndex(2)].base.position) - p0);
+        if (lengthsq(n) > 0.0f)
+            minDot = Math::min(minDot, dot(meshlet.coneAxis, normalize(n)));
+    }
+
+    // normals spread over more than a hemisphere (with some slack), cone is useless
+    if (minDot <= 0.1f)
+        return;
+
+    // move the apex back along the axis so that it lies behind every triangle plane
+    float maxT = 0.0f;
+    for (IndexT i = first; i < end; i++)
+    {
+        const MeshBuilderTriangle& tri = mesh.triangles[i];
+        const vec3 p0 = xyz(mesh.vertices[tri.GetVertexIndex(0)].base.position);
+        vec3 n = cross(xyz(mesh.vertices[tri.GetVertexIndex(1)].base.position) - p0, xyz(mesh.vertices[tri.GetVertexIndex(2)].base.position) - p0);
+        if (lengthsq(n) == 0.0f)
+            continue;
+        n = normalize(n);
+        const float t = dot(meshlet.center - p0, n) / dot(meshlet.coneAxis, n);
+        maxT = Math::max(maxT, t);
+    }
+    meshlet.coneApex = meshlet.center - meshlet.coneAxis * maxT;
+    meshlet.coneCutoff = sqrtf(1.0f - minDot * minDot);
+}
+
+} // namespace ToolkitUtil
@@ -0,0 +1,84 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class ToolkitUtil::MeshBuilderOptimizer
+
+    Post-merge optimization stage for mesh builders.
+
+    Optimize() reorders the triangles of every primitive group for the
+    post-transform vertex cache (Forsyth's linear-speed algorithm), then
+    splits the cache-ordered groups into clusters which are sorted front to
+    back from the mesh center to reduce overdraw, as long as the cache
+    efficiency stays within a threshold. Finally the vertices are remapped
+    into first-use order to improve vertex fetch locality.
+
+    BuildMeshlets() splits each primitive group into contiguous runs of
+    triangles with a bounded number of unique vertices, and computes a
+    bounding sphere and a normal cone per meshlet for CPU/GPU cluster culling.
+
+    The optimizer only handles triangle lists, and only permutes triangles
+    within their primitive group, so group ranges stay valid.
+
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+#include "model/meshutil/meshbuilder.h"
+
+//------------------------------------------------------------------------------
+namespace ToolkitUtil
+{
+class MeshBuilderOptimizer
+{
+public:
+    /// vertex cache statistics
+    struct Statistics
+    {
+        /// average cache miss ratio, transformed vertices per triangle (0.5 is optimal, 3.0 is worst)
+        float acmr;
+        /// average transform to vertex ratio, transformed vertices per unique vertex (1.0 is optimal)
+        float atvr;
+    };
+
+    /// optimization report
+    struct Report
+    {
+        Statistics before;
+        Statistics after;
+        SizeT numClusters;
+        SizeT numMeshlets;
+    };
+
+    /// size of the simulated FIFO cache used for the statistics
+    static const SizeT StatisticsCacheSize = 16;
+    /// size of the LRU cache modelled by the triangle ordering
+    static const SizeT OptimizeCacheSize = 32;
+    /// max allowed ACMR increase when sorting clusters for overdraw
+    static constexpr float OverdrawThreshold = 1.05f;
+    /// default max unique vertices per meshlet
+    static const SizeT MaxMeshletVertices = 64;
+    /// default max triangles per meshlet
+    static const SizeT MaxMeshletTriangles = 124;
+
+    /// run vertex cache, overdraw and vertex fetch optimization
+    static void Optimize(MeshBuilder& mesh, Report& outReport);
+    /// generate meshlets for all primitive groups
+    static SizeT BuildMeshlets(MeshBuilder& mesh, SizeT maxVertices = MaxMeshletVertices, SizeT maxTriangles = MaxMeshletTriangles);
+    /// compute ACMR and ATVR using a FIFO cache simulation
+    static Statistics AnalyzeVertexCache(const MeshBuilder& mesh, SizeT cacheSize = StatisticsCacheSize);
+
+private:
+    /// get triangle ranges to optimize, sorted and free of overlaps
+    static Util::Array<MeshBuilderGroup> GetTriangleRanges(const MeshBuilder& mesh);
+    /// reorder triangles in range for vertex cache efficiency
+    static void OptimizeVertexCache(MeshBuilder& mesh, IndexT firstTriangle, SizeT numTriangles);
+    /// reorder cache optimized triangle clusters in range to reduce overdraw, returns number of clusters
+    static SizeT OptimizeOverdraw(MeshBuilder& mesh, IndexT firstTriangle, SizeT numTriangles, const Math::vec3& meshCenter);
+    /// reorder vertices in first-use order
+    static void OptimizeVertexFetch(MeshBuilder& mesh);
+    /// count FIFO cache misses for a triangle range
+    static SizeT CountCacheMisses(const MeshBuilder& mesh, const MeshBuilderTriangle* triangles, SizeT numTriangles, SizeT cacheSize);
+    /// compute bounds and cone for a meshlet
+    static void ComputeMeshletBounds(const MeshBuilder& mesh, MeshBuilderMeshlet& meshlet);
+};
+
+} // namespace ToolkitUtil
+//------------------------------------------------------------------------------
@@ -64,9 +64,12 @@ MeshBuilderSaver::WriteHeader(const Ptr<IO::Stream>& stream, const Util::Array<M
     SizeT vertexDataSize = 0;
     SizeT meshDataSize = meshes.Size() * sizeof(Nvx3VertexRange);
     SizeT meshletDataSize = 0;
+    SizeT numMeshlets = 0;
     for (IndexT i = 0; i < meshes.Size(); i++)
     {
         meshDataSize += meshes[i]->groups.Size() * sizeof(Nvx3Group);
+        numMeshlets += meshes[i]->meshlets.Size();
+        meshletDataSize += meshes[i]->meshlets.Size() * sizeof(Nvx3Meshlet);
         
         // The enum is the size of the type
         vertexDataSize += sizeof(CoreGraphics::BaseVertex) * meshes[i]->vertices.Size();
@@ -80,10 +83,11 @@ MeshBuilderSaver::WriteHeader(const Ptr<IO::Stream>& stream, const Util::Array<M
     // write header
     Nvx3Header nvx3Header;
     nvx3Header.magic = byteOrder.Convert<uint>(NEBULA_NVX_MAGICNUMBER);
+    nvx3Header.version = byteOrder.Convert<uint>(NEBULA_NVX_VERSION);
     nvx3Header.meshDataOffset = sizeof(Nvx3Header);
     nvx3Header.numMeshes = byteOrder.Convert<uint>(meshes.Size());
     nvx3Header.meshletDataOffset = sizeof(Nvx3Header) + meshDataSize;
-    nvx3Header.numMeshlets = 0; // TODO: Add meshlet support
+    nvx3Header.numMeshlets = byteOrder.Convert<uint>(numMeshlets);
     nvx3Header.vertexDataOffset = sizeof(Nvx3Header) + meshDataSize + meshletDataSize; 
     nvx3Header.vertexDataSize = vertexDataSize;
     nvx3Header.indexDataOffset = sizeof(Nvx3Header) + meshDataSize + meshletDataSize + vertexDataSize;
@@ -102,6 +106,7 @@ MeshBuilderSaver::WriteMeshes(const Ptr<IO::Stream>& stream, const Util::Array<M
     uint indexByteOffset = 0;
     uint vertexByteOffset = 0;
     uint groupByteOffset = sizeof(Nvx3Header) + meshes.Size() * sizeof(Nvx3VertexRange);
+    uint meshletOffset = 0;
 
     Util::Array<Nvx3Group, 32> groups;
     for (IndexT curMeshIndex = 0; curMeshIndex < meshes.Size(); curMeshIndex++)
@@ -131,12 +136,21 @@ MeshBuilderSaver::WriteMeshes(const Ptr<IO::Stream>& stream, const Util::Array<M
             nvx3Group.firstIndex = byteOrder.Convert<uint>(firstTriangle * 3);
             nvx3Group.numIndices = byteOrder.Convert<uint>(numTriangles * 3);
             nvx3Group.primType = PrimitiveTopology::TriangleList;
-            
-            // TODO: Add support for meshlets
-            nvx3Group.firstMeshlet = 0;
-            nvx3Group.numMeshlets = 0;
+
+            // Meshlets are indexed globally across all meshes in the file
+            if (mesh->meshlets.IsEmpty())
+            {
+                nvx3Group.firstMeshlet = 0;
+                nvx3Group.numMeshlets = 0;
+            }
+            else
+            {
+                nvx3Group.firstMeshlet = byteOrder.Convert<uint>(meshletOffset + group.GetFirstMeshletIndex());
+                nvx3Group.numMeshlets = byteOrder.Convert<uint>(group.GetNumMeshlets());
+            }
             groups.Append(nvx3Group);
         }
+        meshletOffset += mesh->meshlets.Size();
 
         groupByteOffset += mesh->groups.Size() * sizeof(Nvx3Group);
         indexByteOffset += mesh->triangles.Size() * 3 * IndexType::SizeOf(nvx3VertexRange.indexType);
@@ -331,6 +345,33 @@ MeshBuilderSaver::WriteTriangles(const Ptr<Stream>& stream, const Util::Array<Me
 void 
 MeshBuilderSaver::WriteMeshlets(const Ptr<IO::Stream>& stream, const Util::Array<MeshBuilder*>& meshes, const System::ByteOrder& byteOrder)
 {
+    uint indexByteOffset = 0;
+    for (auto& mesh : meshes)
+    {
+        for (const MeshBuilderMeshlet& meshlet : mesh->meshlets)
+        {
+            Nvx3Meshlet nvx3Meshlet;
+            nvx3Meshlet.indexOffset = byteOrder.Convert<uint>(indexByteOffset);
+            nvx3Meshlet.firstIndex = byteOrder.Convert<uint>(meshlet.firstTriangleIndex * 3);
+            nvx3Meshlet.numIndices = byteOrder.Convert<uint>(meshlet.numTriangles * 3);
+            nvx3Meshlet.numVertices = byteOrder.Convert<uint>(meshlet.numVertices);
+            nvx3Meshlet.center[0] = byteOrder.Convert<float>(meshlet.center.x);
+            nvx3Meshlet.center[1] = byteOrder.Convert<float>(meshlet.center.y);
+            nvx3Meshlet.center[2] = byteOrder.Convert<float>(meshlet.center.z);
+            nvx3Meshlet.radius = byteOrder.Convert<float>(meshlet.radius);
+            nvx3Meshlet.coneApex[0] = byteOrder.Convert<float>(meshlet.coneApex.x);
+            nvx3Meshlet.coneApex[1] = byteOrder.Convert<float>(meshlet.coneApex.y);
+            nvx3Meshlet.coneApex[2] = byteOrder.Convert<float>(meshlet.coneApex.z);
+            nvx3Meshlet.coneAxis[0] = byteOrder.Convert<float>(meshlet.coneAxis.x);
+            nvx3Meshlet.coneAxis[1] = byteOrder.Convert<float>(meshlet.coneAxis.y);
+            nvx3Meshlet.coneAxis[2] = byteOrder.Convert<float>(meshlet.coneAxis.z);
+            nvx3Meshlet.coneCutoff = byteOrder.Convert<float>(meshlet.coneCutoff);
+            stream->Write(&nvx3Meshlet, sizeof(Nvx3Meshlet));
+        }
+
+        CoreGraphics::IndexType::Code indexType = mesh->vertices.Size() > 0xFFFF ? CoreGraphics::IndexType::Index32 : CoreGraphics::IndexType::Index16;
+        indexByteOffset += mesh->triangles.Size() * 3 * CoreGraphics::IndexType::SizeOf(indexType);
+    }
 }
 
 } // namespace ToolkitUtil
@@ -95,6 +95,7 @@ public:
 private:
     friend class MeshBuilder;
     friend class MeshBuilderSaver;
+    friend class MeshBuilderOptimizer;
     friend class SkinPartitioner;
     friend class SkinFragment;
     friend class NFbxScene;
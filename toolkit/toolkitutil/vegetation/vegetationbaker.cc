@@ -0,0 +1,312 @@
+//------------------------------------------------------------------------------
+//  vegetationbaker.cc
+//  (C) 2025 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "vegetationbaker.h"
+#include "io/ioserver.h"
+#include "io/jsonreader.h"
+#include "coregraphics/load/glimltypes.h"
+#include "terrain/terrainheightloader.h"
+
+using namespace Util;
+
+namespace ToolkitUtil
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+static uint
+Hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Returns a number between 0 and 1 and advances the state
+*/
+static float
+Random(uint& state)
+{
+    state = Hash(state);
+    return (state & 0xFFFFFF) / float(0x1000000);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+VegetationBaker::VegetationBaker() :
+    logger(nullptr),
+    minHeight(0.0f),
+    maxHeight(1.0f),
+    worldSize(0.0f, 0.0f),
+    tileSize(64.0f),
+    seed(0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+VegetationBaker::~VegetationBaker()
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+    Optional values keep the defaults of VegetationBakeLayer.
+*/
+bool
+VegetationBaker::ReadDescription(const IO::URI& file)
+{
+    n_assert(this->logger != nullptr);
+    Ptr<IO::JsonReader> reader = IO::JsonReader::Create();
+    reader->SetStream(IO::IoServer::Instance()->CreateStream(file));
+    if (!reader->Open())
+    {
+        this->logger->Error("VegetationBaker: could not open '%s'\n", file.LocalPath().AsCharPtr());
+        return false;
+    }
+    if (!reader->HasAttr("heightmap") || !reader->HasAttr("worldSize"))
+    {
+        this->logger->Error("VegetationBaker: '%s' needs a heightmap and a worldSize\n", file.LocalPath().AsCharPtr());
+        reader->Close();
+        return false;
+    }
+
+    this->SetHeightMap(reader->GetString("heightmap"), reader->GetOptFloat("minHeight", 0.0f), reader->GetOptFloat("maxHeight", 1.0f), reader->GetVec2("worldSize"));
+    this->SetTileSize(reader->GetOptFloat("tileSize", 64.0f));
+    this->SetSeed((uint)reader->GetOptInt("seed", 0));
+
+    this->layers.Clear();
+    if (reader->SetToFirstChild("layers"))
+    {
+        if (reader->SetToFirstChild()) do
+        {
+            VegetationBakeLayer layer;
+            layer.mask = reader->GetOptString("mask", "");
+            layer.meshType = (uint)reader->GetOptInt("meshType", 0);
+            layer.density = reader->GetOptFloat("density", layer.density);
+            layer.slopeThreshold = reader->GetOptFloat("slope", layer.slopeThreshold);
+            layer.heightThreshold = reader->GetOptFloat("height", layer.heightThreshold);
+            layer.radius = reader->GetOptFloat("radius", layer.radius);
+            this->AddLayer(layer);
+        } while (reader->SetToNextChild());
+        reader->SetToParent();
+    }
+    reader->Close();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+VegetationBaker::Bake()
+{
+    n_assert(this->logger != nullptr);
+    n_assert(this->tileSize > 0.0f);
+
+    Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(IO::URI(this->heightMap));
+    stream->SetAccessMode(IO::Stream::ReadAccess);
+    Util::Array<uint16_t> samples;
+    SizeT width = 0, height = 0;
+    bool heightMapValid = false;
+    if (stream->Open())
+    {
+        heightMapValid = Terrain::TerrainHeightLoader::ReadSamples(stream, samples, width, height);
+        stream->Close();
+    }
+    if (!heightMapValid)
+    {
+        this->logger->Error("VegetationBaker: could not read heightmap '%s'\n", this->heightMap.AsCharPtr());
+        return false;
+    }
+
+    Terrain::TerrainHeightQuery terrain;
+    terrain.Setup(samples.Begin(), width, height, this->minHeight, this->maxHeight, this->worldSize.x, this->worldSize.y);
+
+    Util::Array<Mask> masks(this->layers.Size(), 0);
+    for (const VegetationBakeLayer& layer : this->layers)
+    {
+        Mask mask;
+        if (layer.mask.IsValid() && !this->ReadMask(layer.mask, mask))
+            return false;
+        masks.Append(mask);
+    }
+
+    if (!IO::IoServer::Instance()->DirectoryExists(this->dstDir))
+        IO::IoServer::Instance()->CreateDirectory(this->dstDir);
+
+    const int numTilesX = (int)Math::ceil(this->worldSize.x / this->tileSize);
+    const int numTilesZ = (int)Math::ceil(this->worldSize.y / this->tileSize);
+    const float halfX = this->worldSize.x * 0.5f;
+    const float halfZ = this->worldSize.y * 0.5f;
+    SizeT numInstances = 0;
+
+    Util::Array<Vegetation::VegetationTileInstance> instances;
+    for (int tileZ = 0; tileZ < numTilesZ; tileZ++)
+    {
+        for (int tileX = 0; tileX < numTilesX; tileX++)
+        {
+            instances.Clear();
+            float boxMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+            float boxMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+            const float tileMinX = -halfX + tileX * this->tileSize;
+            const float tileMinZ = -halfZ + tileZ * this->tileSize;
+
+            for (IndexT layerIndex = 0; layerIndex < this->layers.Size(); layerIndex++)
+            {
+                const VegetationBakeLayer& layer = this->layers[layerIndex];
+                const Mask& mask = masks[layerIndex];
+                if (layer.density <= 0.0f)
+                    continue;
+
+                // one candidate per grid cell, jittered within the cell
+                const float cellSize = 1.0f / Math::sqrt(layer.density);
+                const int numCells = (int)Math::ceil(this->tileSize / cellSize);
+                for (int cellZ = 0; cellZ < numCells; cellZ++)
+                {
+                    for (int cellX = 0; cellX < numCells; cellX++)
+                    {
+                        uint state = Hash(this->seed ^ Hash(tileX + numTilesX * tileZ) ^ Hash(layerIndex * 0x9E3779B9) ^ Hash(cellX + cellZ * numCells + 1));
+                        const float x = tileMinX + (cellX + Random(state)) * cellSize;
+                        const float z = tileMinZ + (cellZ + Random(state)) * cellSize;
+                        if (x >= tileMinX + this->tileSize || z >= tileMinZ + this->tileSize)
+                            continue;
+
+                        float height;
+                        Math::vector normal;
+                        if (!terrain.GetHeight(x, z, height, normal))
+                            continue;
+                        if (height >= layer.heightThreshold || normal.y <= layer.slopeThreshold)
+                            continue;
+
+                        const float chance = Random(state);
+                        if (mask.width > 0)
+                        {
+                            const SizeT u = Math::clamp((int)((x + halfX) / this->worldSize.x * mask.width), 0, mask.width - 1);
+                            const SizeT v = Math::clamp((int)((z + halfZ) / this->worldSize.y * mask.height), 0, mask.height - 1);
+                            if (chance >= mask.texels[u + v * mask.width] / 255.0f)
+                                continue;
+                        }
+
+                        const float angle = Random(state) * 2.0f * N_PI;
+                        Vegetation::VegetationTileInstance instance;
+                        instance.position[0] = x;
+                        instance.position[1] = height;
+                        instance.position[2] = z;
+                        instance.meshType = layer.meshType;
+                        instance.sincos[0] = Math::sin(angle);
+                        instance.sincos[1] = Math::cos(angle);
+                        instance.random = Random(state);
+                        instance.pad = 0;
+                        instances.Append(instance);
+
+                        boxMin[0] = Math::min(boxMin[0], x - layer.radius);
+                        boxMin[1] = Math::min(boxMin[1], height - layer.radius);
+                        boxMin[2] = Math::min(boxMin[2], z - layer.radius);
+                        boxMax[0] = Math::max(boxMax[0], x + layer.radius);
+                        boxMax[1] = Math::max(boxMax[1], height + layer.radius * 2.0f);
+                        boxMax[2] = Math::max(boxMax[2], z + layer.radius);
+                    }
+                }
+            }
+
+            if (instances.IsEmpty())
+            {
+                boxMin[0] = boxMin[1] = boxMin[2] = 0.0f;
+                boxMax[0] = boxMax[1] = boxMax[2] = 0.0f;
+            }
+            if (!this->WriteTile(tileX, tileZ, instances, boxMin, boxMax))
+                return false;
+            numInstances += instances.Size();
+        }
+    }
+
+    this->logger->Print("Baked %d vegetation instances into %d tiles in %s\n", numInstances, numTilesX * numTilesZ, this->dstDir.AsCharPtr());
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+VegetationBaker::ReadMask(const Util::String& file, Mask& outMask) const
+{
+    Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(IO::URI(file));
+    stream->SetAccessMode(IO::Stream::ReadAccess);
+    if (!stream->Open())
+    {
+        this->logger->Error("VegetationBaker: could not open mask '%s'\n", file.AsCharPtr());
+        return false;
+    }
+
+    bool success = false;
+    void* data = stream->MemoryMap();
+    gliml::context ctx;
+    if (data != nullptr && ctx.load_dds(data, stream->GetSize()))
+    {
+        if (CoreGraphics::Gliml::ToPixelFormat(ctx) == CoreGraphics::PixelFormat::R8)
+        {
+            outMask.width = ctx.image_width(0, 0);
+            outMask.height = ctx.image_height(0, 0);
+            outMask.texels.Clear();
+            outMask.texels.AppendArray((const uint8_t*)ctx.image_data(0, 0), outMask.width * outMask.height);
+            success = true;
+        }
+        else
+        {
+            this->logger->Error("VegetationBaker: mask '%s' has to be R8\n", file.AsCharPtr());
+        }
+    }
+    else
+    {
+        this->logger->Error("VegetationBaker: mask '%s' is not a valid DDS\n", file.AsCharPtr());
+    }
+    stream->MemoryUnmap();
+    stream->Close();
+    return success;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+VegetationBaker::WriteTile(int tileX, int tileZ, const Util::Array<Vegetation::VegetationTileInstance>& instances, const float boxMin[3], const float boxMax[3]) const
+{
+    const Util::String file = Util::String::Sprintf("%s/tile_%d_%d.vegt", this->dstDir.AsCharPtr(), tileX, tileZ);
+    Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(IO::URI(file));
+    stream->SetAccessMode(IO::Stream::WriteAccess);
+    if (!stream->Open())
+    {
+        this->logger->Error("VegetationBaker: could not write '%s'\n", file.AsCharPtr());
+        return false;
+    }
+
+    Vegetation::VegetationTileHeader header;
+    header.magic = Vegetation::VegetationTileHeader::Magic;
+    header.version = Vegetation::VegetationTileHeader::Version;
+    header.numInstances = instances.Size();
+    for (int i = 0; i < 3; i++)
+    {
+        header.boxMin[i] = boxMin[i];
+        header.boxMax[i] = boxMax[i];
+    }
+    stream->Write(&header, sizeof(header));
+    if (!instances.IsEmpty())
+        stream->Write(instances.Begin(), instances.ByteSize());
+    stream->Close();
+    return true;
+}
+
+} // namespace ToolkitUtil
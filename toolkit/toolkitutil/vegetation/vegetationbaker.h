@@ -0,0 +1,159 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class ToolkitUtil::VegetationBaker
+
+    Places vegetation meshes over a terrain heightmap and writes them out as
+    tiles for Vegetation::VegetationContext::SetupStreaming.
+
+    Every layer scatters one mesh type with a jittered grid of the given
+    density and keeps the instances which pass its mask, height and slope
+    rules, the same rules the runtime uses for generated vegetation. The
+    placement only depends on the seed, the tile and the layer, so baking
+    again gives the same result. A file is written for every tile, empty
+    ones included, so the runtime never asks for a tile that doesn't exist.
+
+    The asset exporter bakes every .veg file of a folder, a json description
+    of the heightmap and the layers:
+
+        {
+            "heightmap": "tex:terrain/height.dds",
+            "minHeight": 0, "maxHeight": 200, "worldSize": [2048, 2048],
+            "tileSize": 64, "seed": 1,
+            "layers": [ { "mask": "tex:terrain/rocks.dds", "meshType": 0, "density": 0.01,
+                          "slope": 0.7, "height": 150, "radius": 1.5 } ]
+        }
+
+    @copyright
+    (C) 2025 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "util/string.h"
+#include "util/array.h"
+#include "math/vec2.h"
+#include "io/uri.h"
+#include "toolkit-common/logger.h"
+#include "vegetation/vegetationtileloader.h"
+
+namespace ToolkitUtil
+{
+
+struct VegetationBakeLayer
+{
+    Util::String mask;                  // optional R8 texture, the chance of placing an instance
+    uint meshType = 0;                  // index of the mesh in the order VegetationContext::SetupMesh is called
+    float density = 0.01f;              // instances per square meter
+    float slopeThreshold = 0.5f;        // minimum y of the terrain normal
+    float heightThreshold = FLT_MAX;    // maximum terrain height
+    float radius = 1.0f;                // bounding radius of the mesh, grows the tile bounds
+};
+
+class VegetationBaker
+{
+public:
+    /// constructor
+    VegetationBaker();
+    /// destructor
+    ~VegetationBaker();
+
+    /// set logger
+    void SetLogger(ToolkitUtil::Logger* logger);
+    /// set folder the tiles are written to
+    void SetDstDir(const Util::String& dir);
+    /// set the terrain heightmap and its placement, same as for the terrain context
+    void SetHeightMap(const Util::String& file, float minHeight, float maxHeight, const Math::vec2& worldSize);
+    /// set world size of a tile
+    void SetTileSize(float size);
+    /// set seed for the placement
+    void SetSeed(uint seed);
+    /// add a layer of meshes
+    void AddLayer(const VegetationBakeLayer& layer);
+    /// set heightmap, tiles and layers from a json bake description
+    bool ReadDescription(const IO::URI& file);
+
+    /// place all layers and write the tiles
+    bool Bake();
+
+private:
+    /// a loaded layer mask
+    struct Mask
+    {
+        Util::Array<uint8_t> texels;
+        SizeT width = 0;
+        SizeT height = 0;
+    };
+
+    /// read an R8 mask texture
+    bool ReadMask(const Util::String& file, Mask& outMask) const;
+    /// write a tile file
+    bool WriteTile(int tileX, int tileZ, const Util::Array<Vegetation::VegetationTileInstance>& instances, const float boxMin[3], const float boxMax[3]) const;
+
+    ToolkitUtil::Logger* logger;
+    Util::String dstDir;
+    Util::String heightMap;
+    float minHeight;
+    float maxHeight;
+    Math::vec2 worldSize;
+    float tileSize;
+    uint seed;
+    Util::Array<VegetationBakeLayer> layers;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+VegetationBaker::SetLogger(ToolkitUtil::Logger* logger)
+{
+    this->logger = logger;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+VegetationBaker::SetDstDir(const Util::String& dir)
+{
+    this->dstDir = dir;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+VegetationBaker::SetHeightMap(const Util::String& file, float minHeight, float maxHeight, const Math::vec2& worldSize)
+{
+    this->heightMap = file;
+    this->minHeight = minHeight;
+    this->maxHeight = maxHeight;
+    this->worldSize = worldSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+VegetationBaker::SetTileSize(float size)
+{
+    this->tileSize = size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+VegetationBaker::SetSeed(uint seed)
+{
+    this->seed = seed;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+VegetationBaker::AddLayer(const VegetationBakeLayer& layer)
+{
+    this->layers.Append(layer);
+}
+
+} // namespace ToolkitUtil